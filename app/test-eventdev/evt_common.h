@@ -0,0 +1,199 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _EVT_COMMON_
+#define _EVT_COMMON_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_debug.h>
+#include <rte_lcore.h>
+#include <rte_eventdev.h>
+#include <rte_service.h>
+
+#define evt_err(fmt, args...) \
+	fprintf(stderr, "error: %s() " fmt "\n", __func__, ## args)
+
+#define evt_info(fmt, args...) \
+	fprintf(stdout, fmt "\n", ## args)
+
+#define EVT_STR_FMT 20
+
+#define evt_dump(str, fmt, val...) \
+	printf("\t%-*s : "fmt"\n", EVT_STR_FMT, str, ## val)
+
+#define evt_dump_begin(str) printf("\t%-*s : {", EVT_STR_FMT, str)
+
+#define evt_dump_end printf("\b}\n")
+
+#define EVT_MAX_STAGES 64
+#define EVT_MAX_PORTS 256
+#define EVT_MAX_QUEUES 256
+
+/* Stall time after which a test is considered as dead locked. */
+#define EVT_STALL_TIMEOUT_S 5
+
+static inline bool
+evt_has_distributed_sched(uint8_t dev_id)
+{
+	struct rte_event_dev_info dev_info;
+
+	rte_event_dev_info_get(dev_id, &dev_info);
+	return (dev_info.event_dev_cap & RTE_EVENT_DEV_CAP_DISTRIBUTED_SCHED) ?
+			true : false;
+}
+
+static inline bool
+evt_has_all_types_queue(uint8_t dev_id)
+{
+	struct rte_event_dev_info dev_info;
+
+	rte_event_dev_info_get(dev_id, &dev_info);
+	return (dev_info.event_dev_cap & RTE_EVENT_DEV_CAP_QUEUE_ALL_TYPES) ?
+			true : false;
+}
+
+static inline uint32_t
+evt_sched_type2queue_cfg(uint8_t sched_type)
+{
+	uint32_t ret;
+
+	switch (sched_type) {
+	case RTE_SCHED_TYPE_ATOMIC:
+		ret = RTE_EVENT_QUEUE_CFG_ATOMIC_ONLY;
+		break;
+	case RTE_SCHED_TYPE_ORDERED:
+		ret = RTE_EVENT_QUEUE_CFG_ORDERED_ONLY;
+		break;
+	case RTE_SCHED_TYPE_PARALLEL:
+		ret = RTE_EVENT_QUEUE_CFG_PARALLEL_ONLY;
+		break;
+	default:
+		rte_panic("Invalid sched_type %d\n", sched_type);
+	}
+	return ret;
+}
+
+static inline int
+evt_configure_eventdev(uint8_t dev_id, uint32_t nb_flows, uint8_t nb_queues,
+		uint8_t nb_ports)
+{
+	struct rte_event_dev_info info;
+	struct rte_event_dev_config config;
+
+	memset(&info, 0, sizeof(info));
+	if (rte_event_dev_info_get(dev_id, &info) < 0) {
+		evt_err("failed to get eventdev info %d", dev_id);
+		return -EINVAL;
+	}
+
+	memset(&config, 0, sizeof(config));
+	config.dequeue_timeout_ns = info.min_dequeue_timeout_ns;
+	config.nb_event_queues = nb_queues;
+	config.nb_event_ports = nb_ports;
+	config.nb_events_limit = info.max_num_events;
+	config.nb_event_queue_flows = RTE_MIN(nb_flows,
+			info.max_event_queue_flows);
+	config.nb_event_port_dequeue_depth = info.max_event_port_dequeue_depth;
+	config.nb_event_port_enqueue_depth = info.max_event_port_enqueue_depth;
+
+	return rte_event_dev_configure(dev_id, &config);
+}
+
+/*
+ * Map all the registered services (scheduler of a centralized event
+ * device, Rx adapter) to the service lcores, in a round robin fashion,
+ * and start them.
+ */
+static inline int
+evt_service_setup(const bool slcores[])
+{
+	uint32_t lcores[RTE_MAX_LCORE];
+	uint32_t nb_lcores = 0, nb_mapped = 0;
+	uint32_t lcore_id, id;
+	int ret;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (!slcores[lcore_id])
+			continue;
+		ret = rte_service_lcore_add(lcore_id);
+		if (ret < 0 && ret != -EALREADY) {
+			evt_err("cannot use lcore %u as service lcore",
+					lcore_id);
+			return ret;
+		}
+		lcores[nb_lcores++] = lcore_id;
+	}
+
+	for (id = 0; id < RTE_SERVICE_NUM_MAX; id++) {
+		if (rte_service_get_name(id) == NULL)
+			continue;
+		if (nb_lcores == 0) {
+			evt_err("no service lcore to run service %s",
+					rte_service_get_name(id));
+			return -ENOENT;
+		}
+		ret = rte_service_map_lcore_set(id,
+				lcores[nb_mapped++ % nb_lcores], 1);
+		if (ret == 0)
+			ret = rte_service_runstate_set(id, 1);
+		if (ret < 0) {
+			evt_err("failed to start service %s",
+					rte_service_get_name(id));
+			return ret;
+		}
+	}
+
+	for (id = 0; id < nb_lcores; id++) {
+		ret = rte_service_lcore_start(lcores[id]);
+		if (ret < 0 && ret != -EALREADY)
+			return ret;
+	}
+	return 0;
+}
+
+static inline void
+evt_service_stop(void)
+{
+	uint32_t id;
+
+	for (id = 0; id < RTE_SERVICE_NUM_MAX; id++)
+		if (rte_service_get_name(id) != NULL)
+			rte_service_runstate_set(id, 0);
+	rte_service_lcore_reset_all();
+}
+
+#endif /*  _EVT_COMMON_*/
@@ -0,0 +1,480 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <getopt.h>
+#include <errno.h>
+#include <ctype.h>
+
+#include <rte_common.h>
+#include <rte_eventdev.h>
+#include <rte_lcore.h>
+
+#include "evt_options.h"
+#include "evt_test.h"
+
+void
+evt_options_default(struct evt_options *opt)
+{
+	memset(opt, 0, sizeof(*opt));
+	opt->verbose_level = 1; /* Enable minimal prints */
+	opt->dev_id = 0;
+	strncpy(opt->test_name, "order_queue", EVT_TEST_NAME_MAX_LEN);
+	opt->nb_flows = 1024;
+	opt->socket_id = SOCKET_ID_ANY;
+	opt->pool_sz = 16 * 1024;
+	opt->wkr_deq_dep = 16;
+	opt->nb_pkts = (1ULL << 26); /* do ~64M packets */
+	opt->vector_tmo_ns = 100 * 1000; /* 100 us */
+	opt->prod_type = EVT_PROD_TYPE_SYNT;
+}
+
+typedef int (*option_parser_t)(struct evt_options *opt,
+		const char *arg);
+
+struct long_opt_parser {
+	const char *lgopt_name;
+	option_parser_t parser_fn;
+};
+
+static int
+parser_read_uint64(uint64_t *value, const char *p)
+{
+	char *next;
+	uint64_t val;
+
+	errno = 0;
+	val = strtoull(p, &next, 10);
+	if (errno != 0 || p == next || *next != '\0')
+		return -EINVAL;
+
+	*value = val;
+	return 0;
+}
+
+static int
+parser_read_uint32(uint32_t *value, const char *p)
+{
+	uint64_t val = 0;
+	int ret = parser_read_uint64(&val, p);
+
+	if (ret < 0)
+		return ret;
+	if (val > UINT32_MAX)
+		return -ERANGE;
+
+	*value = val;
+	return 0;
+}
+
+/* Parse a list of lcores such as "1,3-5" */
+static int
+parser_read_lcores(bool lcores[], const char *corelist)
+{
+	unsigned long idx, min = RTE_MAX_LCORE, max;
+	char *end = NULL;
+
+	memset(lcores, 0, RTE_MAX_LCORE * sizeof(lcores[0]));
+
+	while (isblank(*corelist))
+		corelist++;
+	if (*corelist == '\0')
+		return -EINVAL;
+
+	do {
+		while (isblank(*corelist))
+			corelist++;
+		if (!isdigit(*corelist))
+			return -EINVAL;
+
+		errno = 0;
+		idx = strtoul(corelist, &end, 10);
+		if (errno || end == NULL || idx >= RTE_MAX_LCORE)
+			return -EINVAL;
+		while (isblank(*end))
+			end++;
+
+		if (*end == '-') {
+			min = idx;
+		} else if (*end == ',' || *end == '\0') {
+			max = idx;
+			if (min == RTE_MAX_LCORE)
+				min = idx;
+			if (min > max)
+				return -EINVAL;
+			for (idx = min; idx <= max; idx++)
+				lcores[idx] = true;
+			min = RTE_MAX_LCORE;
+		} else {
+			return -EINVAL;
+		}
+		corelist = end + 1;
+	} while (*end != '\0');
+
+	return 0;
+}
+
+static int
+evt_parse_nb_flows(struct evt_options *opt, const char *arg)
+{
+	int ret;
+
+	ret = parser_read_uint32(&(opt->nb_flows), arg);
+	if (ret == 0 && opt->nb_flows == 0)
+		ret = -EINVAL;
+
+	return ret;
+}
+
+static int
+evt_parse_dev_id(struct evt_options *opt, const char *arg)
+{
+	uint32_t dev_id;
+	int ret;
+
+	ret = parser_read_uint32(&dev_id, arg);
+	if (ret == 0 && dev_id > UINT8_MAX)
+		ret = -ERANGE;
+	if (ret == 0)
+		opt->dev_id = dev_id;
+
+	return ret;
+}
+
+static int
+evt_parse_verbose(struct evt_options *opt, const char *arg)
+{
+	opt->verbose_level = atoi(arg);
+	return 0;
+}
+
+static int
+evt_parse_fwd_latency(struct evt_options *opt, const char *arg __rte_unused)
+{
+	opt->fwd_latency = 1;
+	return 0;
+}
+
+static int
+evt_parse_queue_priority(struct evt_options *opt,
+		const char *arg __rte_unused)
+{
+	opt->q_priority = 1;
+	return 0;
+}
+
+static int
+evt_parse_eth_prod_type(struct evt_options *opt, const char *arg __rte_unused)
+{
+	opt->prod_type = EVT_PROD_TYPE_ETH_RX_ADPTR;
+	return 0;
+}
+
+static int
+evt_parse_test_name(struct evt_options *opt, const char *arg)
+{
+	snprintf(opt->test_name, EVT_TEST_NAME_MAX_LEN, "%s", arg);
+	return 0;
+}
+
+static int
+evt_parse_socket_id(struct evt_options *opt, const char *arg)
+{
+	opt->socket_id = atoi(arg);
+	return 0;
+}
+
+static int
+evt_parse_wkr_deq_dep(struct evt_options *opt, const char *arg)
+{
+	uint32_t dep;
+	int ret;
+
+	ret = parser_read_uint32(&dep, arg);
+	if (ret == 0 && (dep == 0 || dep > UINT16_MAX))
+		ret = -ERANGE;
+	if (ret == 0)
+		opt->wkr_deq_dep = dep;
+
+	return ret;
+}
+
+static int
+evt_parse_nb_pkts(struct evt_options *opt, const char *arg)
+{
+	return parser_read_uint64(&(opt->nb_pkts), arg);
+}
+
+static int
+evt_parse_vector_size(struct evt_options *opt, const char *arg)
+{
+	uint32_t size;
+	int ret;
+
+	ret = parser_read_uint32(&size, arg);
+	if (ret == 0 && size > UINT16_MAX)
+		ret = -ERANGE;
+	if (ret == 0)
+		opt->vector_size = size;
+
+	return ret;
+}
+
+static int
+evt_parse_vector_tmo_ns(struct evt_options *opt, const char *arg)
+{
+	return parser_read_uint64(&(opt->vector_tmo_ns), arg);
+}
+
+static int
+evt_parse_pool_sz(struct evt_options *opt, const char *arg)
+{
+	opt->pool_sz = atoi(arg);
+
+	return opt->pool_sz > 0 ? 0 : -EINVAL;
+}
+
+/* Parse a list of sched types such as "o,a,p" */
+static int
+evt_parse_sched_type_list(struct evt_options *opt, const char *arg)
+{
+	int nb = 0;
+
+	for (; *arg != '\0'; arg++) {
+		if (*arg == ',' || *arg == '-' || isblank(*arg))
+			continue;
+		if (nb == EVT_MAX_STAGES)
+			return -E2BIG;
+
+		switch (tolower(*arg)) {
+		case 'o':
+			opt->sched_type_list[nb++] = RTE_SCHED_TYPE_ORDERED;
+			break;
+		case 'a':
+			opt->sched_type_list[nb++] = RTE_SCHED_TYPE_ATOMIC;
+			break;
+		case 'p':
+			opt->sched_type_list[nb++] = RTE_SCHED_TYPE_PARALLEL;
+			break;
+		default:
+			return -EINVAL;
+		}
+	}
+	opt->nb_stages = nb;
+
+	return nb != 0 ? 0 : -EINVAL;
+}
+
+static int
+evt_parse_plcores(struct evt_options *opt, const char *corelist)
+{
+	int ret;
+
+	ret = parser_read_lcores(opt->plcores, corelist);
+	if (ret == 0 && evt_lcores_has_overlap(opt->plcores,
+				rte_get_master_lcore()))
+		ret = -EINVAL;
+
+	return ret;
+}
+
+static int
+evt_parse_work_lcores(struct evt_options *opt, const char *corelist)
+{
+	int ret;
+
+	ret = parser_read_lcores(opt->wlcores, corelist);
+	if (ret == 0 && evt_lcores_has_overlap(opt->wlcores,
+				rte_get_master_lcore()))
+		ret = -EINVAL;
+
+	return ret;
+}
+
+static int
+evt_parse_service_lcores(struct evt_options *opt, const char *corelist)
+{
+	int ret;
+
+	ret = parser_read_lcores(opt->slcores, corelist);
+	if (ret == 0 && evt_lcores_has_overlap(opt->slcores,
+				rte_get_master_lcore()))
+		ret = -EINVAL;
+
+	return ret;
+}
+
+static void
+usage(char *program)
+{
+	printf("usage : %s [EAL options] -- [application options]\n", program);
+	printf("application options:\n");
+	printf("\t--verbose          : verbose level\n"
+		"\t--dev              : device id of the event device\n"
+		"\t--test             : name of the test application to run\n"
+		"\t--socket_id        : socket_id of application resources\n"
+		"\t--pool_sz          : pool size of the mempool\n"
+		"\t--plcores          : list of lcore ids for producers\n"
+		"\t--wlcores          : list of lcore ids for workers\n"
+		"\t--slcores          : list of lcore ids for the services\n"
+		"\t                     (scheduler, Rx adapter)\n"
+		"\t--stlist           : list of scheduled types of the stages\n"
+		"\t                     (o: ordered, a: atomic, p: parallel)\n"
+		"\t--nb_flows         : number of flows to produce\n"
+		"\t--nb_pkts          : number of packets to produce,\n"
+		"\t                     0 to run until interrupted\n"
+		"\t--worker_deq_depth : dequeue depth of the worker\n"
+		"\t--fwd_latency      : perform fwd latency measurement\n"
+		"\t--queue_priority   : enable queue priority\n"
+		"\t--prod_type_ethdev : use ethernet device as producer\n"
+		"\t--vector_size      : aggregate the packets in event vectors\n"
+		"\t                     of this size, 0 to disable\n"
+		"\t--vector_tmo_ns    : maximum time a packet waits in an\n"
+		"\t                     incomplete vector, with ethdev producers\n"
+		);
+	printf("available tests:\n");
+	evt_test_dump_names();
+}
+
+static struct option lgopts[] = {
+	{ EVT_NB_FLOWS,         1, 0, 0 },
+	{ EVT_DEVICE,           1, 0, 0 },
+	{ EVT_VERBOSE,          1, 0, 0 },
+	{ EVT_TEST,             1, 0, 0 },
+	{ EVT_PROD_LCORES,      1, 0, 0 },
+	{ EVT_WORK_LCORES,      1, 0, 0 },
+	{ EVT_SERVICE_LCORES,   1, 0, 0 },
+	{ EVT_SOCKET_ID,        1, 0, 0 },
+	{ EVT_POOL_SZ,          1, 0, 0 },
+	{ EVT_NB_PKTS,          1, 0, 0 },
+	{ EVT_WKR_DEQ_DEP,      1, 0, 0 },
+	{ EVT_SCHED_TYPE_LIST,  1, 0, 0 },
+	{ EVT_FWD_LATENCY,      0, 0, 0 },
+	{ EVT_QUEUE_PRIORITY,   0, 0, 0 },
+	{ EVT_PROD_ETHDEV,      0, 0, 0 },
+	{ EVT_VECTOR_SZ,        1, 0, 0 },
+	{ EVT_VECTOR_TMO,       1, 0, 0 },
+	{ EVT_HELP,             0, 0, 0 },
+	{ NULL,                 0, 0, 0 }
+};
+
+static int
+evt_opts_parse_long(int opt_idx, struct evt_options *opt)
+{
+	unsigned int i;
+
+	struct long_opt_parser parsermap[] = {
+		{ EVT_NB_FLOWS, evt_parse_nb_flows},
+		{ EVT_DEVICE, evt_parse_dev_id},
+		{ EVT_VERBOSE, evt_parse_verbose},
+		{ EVT_TEST, evt_parse_test_name},
+		{ EVT_PROD_LCORES, evt_parse_plcores},
+		{ EVT_WORK_LCORES, evt_parse_work_lcores},
+		{ EVT_SERVICE_LCORES, evt_parse_service_lcores},
+		{ EVT_SOCKET_ID, evt_parse_socket_id},
+		{ EVT_POOL_SZ, evt_parse_pool_sz},
+		{ EVT_NB_PKTS, evt_parse_nb_pkts},
+		{ EVT_WKR_DEQ_DEP, evt_parse_wkr_deq_dep},
+		{ EVT_SCHED_TYPE_LIST, evt_parse_sched_type_list},
+		{ EVT_FWD_LATENCY, evt_parse_fwd_latency},
+		{ EVT_QUEUE_PRIORITY, evt_parse_queue_priority},
+		{ EVT_PROD_ETHDEV, evt_parse_eth_prod_type},
+		{ EVT_VECTOR_SZ, evt_parse_vector_size},
+		{ EVT_VECTOR_TMO, evt_parse_vector_tmo_ns},
+	};
+
+	for (i = 0; i < RTE_DIM(parsermap); i++) {
+		if (strncmp(lgopts[opt_idx].name, parsermap[i].lgopt_name,
+				strlen(lgopts[opt_idx].name)) == 0)
+			return parsermap[i].parser_fn(opt, optarg);
+	}
+
+	return -EINVAL;
+}
+
+int
+evt_options_parse(struct evt_options *opt, int argc, char **argv)
+{
+	int opts, retval, opt_idx;
+
+	while ((opts = getopt_long(argc, argv, "", lgopts, &opt_idx)) != EOF) {
+		switch (opts) {
+		case 0: /* long options */
+			if (!strcmp(lgopts[opt_idx].name, "help")) {
+				usage(argv[0]);
+				exit(EXIT_SUCCESS);
+			}
+
+			retval = evt_opts_parse_long(opt_idx, opt);
+			if (retval != 0) {
+				evt_err("invalid --%s argument",
+						lgopts[opt_idx].name);
+				return retval;
+			}
+			break;
+		default:
+			usage(argv[0]);
+			return -EINVAL;
+		}
+	}
+	return 0;
+}
+
+void
+evt_options_dump(struct evt_options *opt)
+{
+	int lcore_id;
+	struct rte_event_dev_info dev_info;
+
+	rte_event_dev_info_get(opt->dev_id, &dev_info);
+	evt_dump("driver", "%s", dev_info.driver_name);
+	evt_dump("test", "%s", opt->test_name);
+	evt_dump("dev", "%d", opt->dev_id);
+	evt_dump("verbose_level", "%d", opt->verbose_level);
+	evt_dump("socket_id", "%d", opt->socket_id);
+	evt_dump("pool_sz", "%d", opt->pool_sz);
+	evt_dump("master lcore", "%d", rte_get_master_lcore());
+	evt_dump("nb_pkts", "%"PRIu64, opt->nb_pkts);
+	evt_dump_begin("available lcores");
+	RTE_LCORE_FOREACH(lcore_id)
+		printf("%d ", lcore_id);
+	evt_dump_end;
+	evt_dump_begin("service lcores");
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		if (opt->slcores[lcore_id])
+			printf("%d ", lcore_id);
+	evt_dump_end;
+}
@@ -0,0 +1,191 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test_perf_common.h"
+
+/* Each producer has its own all types queue, shared by its stages */
+static inline int
+perf_atq_nb_event_queues(struct evt_options *opt)
+{
+	return perf_nb_producers(opt);
+}
+
+static int
+perf_atq_worker(void *arg)
+{
+	PERF_WORKER_INIT;
+	struct rte_event ev[BURST_SIZE];
+	void *done_objs[BURST_SIZE];
+	struct rte_event_vector *done_vecs[BURST_SIZE];
+	uint16_t i, nb_rx, nb_done, nb_vecs;
+	uint64_t now = 0;
+
+	while (t->done == false) {
+		nb_rx = rte_event_dequeue_burst(dev, port, ev, deq_depth, 0);
+		if (nb_rx == 0) {
+			rte_pause();
+			continue;
+		}
+
+		if (fwd_latency)
+			now = rte_get_timer_cycles();
+
+		nb_done = 0;
+		nb_vecs = 0;
+		for (i = 0; i < nb_rx; i++) {
+			const uint8_t stage = ev[i].sub_event_type;
+
+			if (fwd_latency)
+				perf_stage_latency(w, &ev[i], stage, now);
+
+			if (stage == laststage) {
+				/* last stage: the event leaves the pipeline */
+				if (ev[i].event_type & RTE_EVENT_TYPE_VECTOR)
+					done_vecs[nb_vecs++] = ev[i].vec;
+				else
+					done_objs[nb_done++] = ev[i].event_ptr;
+				ev[i].op = RTE_EVENT_OP_RELEASE;
+			} else {
+				ev[i].sub_event_type++;
+				ev[i].sched_type = sched_type_list[stage + 1];
+				ev[i].op = RTE_EVENT_OP_FORWARD;
+				ev[i].event_type = RTE_EVENT_TYPE_CPU |
+					(ev[i].event_type &
+					 RTE_EVENT_TYPE_VECTOR);
+			}
+		}
+		perf_enqueue_burst(t, dev, port, ev, nb_rx);
+		perf_free_payloads(pool, done_objs, nb_done, synt);
+		w->processed_pkts += nb_done + perf_free_vectors(pool,
+				vector_pool, done_vecs, nb_vecs, synt);
+	}
+
+	return 0;
+}
+
+static int
+perf_atq_launch_lcores(struct evt_test *test, struct evt_options *opt)
+{
+	return perf_launch_lcores(test, opt, perf_atq_worker);
+}
+
+static int
+perf_atq_eventdev_setup(struct evt_test *test, struct evt_options *opt)
+{
+	uint8_t queue;
+	int ret;
+
+	const int nb_queues = perf_atq_nb_event_queues(opt);
+
+	ret = evt_configure_eventdev(opt->dev_id, opt->nb_flows, nb_queues,
+			perf_nb_event_ports(opt));
+	if (ret) {
+		evt_err("failed to configure eventdev %d", opt->dev_id);
+		return ret;
+	}
+
+	/* queue configurations */
+	const struct rte_event_queue_conf q_conf = {
+			.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+			.event_queue_cfg = RTE_EVENT_QUEUE_CFG_ALL_TYPES,
+			.nb_atomic_flows = opt->nb_flows,
+			.nb_atomic_order_sequences = opt->nb_flows,
+	};
+	for (queue = 0; queue < nb_queues; queue++) {
+		ret = rte_event_queue_setup(opt->dev_id, queue, &q_conf);
+		if (ret) {
+			evt_err("failed to setup queue=%d", queue);
+			return ret;
+		}
+	}
+
+	ret = perf_event_dev_port_setup(test, opt, 1 /* stride */, nb_queues);
+	if (ret)
+		return ret;
+
+	return perf_event_dev_start(test, opt);
+}
+
+static void
+perf_atq_opt_dump(struct evt_options *opt)
+{
+	perf_opt_dump(opt, perf_atq_nb_event_queues(opt));
+}
+
+static int
+perf_atq_opt_check(struct evt_options *opt)
+{
+	if (opt->q_priority) {
+		evt_err("queue_priority needs a queue per stage");
+		return -1;
+	}
+	return perf_opt_check(opt, perf_atq_nb_event_queues(opt));
+}
+
+static bool
+perf_atq_capability_check(struct evt_options *opt)
+{
+	struct rte_event_dev_info dev_info;
+
+	rte_event_dev_info_get(opt->dev_id, &dev_info);
+	if (dev_info.max_event_queues < perf_atq_nb_event_queues(opt) ||
+			dev_info.max_event_ports < perf_nb_event_ports(opt)) {
+		evt_err("not enough eventdev queues=%d/%d or ports=%d/%d",
+			perf_atq_nb_event_queues(opt),
+			dev_info.max_event_queues,
+			perf_nb_event_ports(opt), dev_info.max_event_ports);
+		return false;
+	}
+	if (!evt_has_all_types_queue(opt->dev_id))
+		return false;
+
+	return true;
+}
+
+static const struct evt_test_ops perf_atq =  {
+	.cap_check          = perf_atq_capability_check,
+	.opt_check          = perf_atq_opt_check,
+	.opt_dump           = perf_atq_opt_dump,
+	.test_setup         = perf_test_setup,
+	.mempool_setup      = perf_mempool_setup,
+	.ethdev_setup       = perf_ethdev_setup,
+	.eventdev_setup     = perf_atq_eventdev_setup,
+	.launch_lcores      = perf_atq_launch_lcores,
+	.eventdev_destroy   = perf_eventdev_destroy,
+	.ethdev_destroy     = perf_ethdev_destroy,
+	.mempool_destroy    = perf_mempool_destroy,
+	.test_result        = perf_test_result,
+	.test_destroy       = perf_test_destroy,
+};
+
+EVT_TEST_REGISTER(perf_atq);
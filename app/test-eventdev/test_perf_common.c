@@ -0,0 +1,833 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <inttypes.h>
+
+#include "test_perf_common.h"
+
+#define PERF_RX_ADAPTER_ID 0
+#define PERF_NB_RXD 512
+#define PERF_NB_TXD 512
+
+int
+perf_test_result(struct evt_test *test, struct evt_options *opt)
+{
+	RTE_SET_USED(opt);
+	struct test_perf *t = evt_test_priv(test);
+
+	return t->result;
+}
+
+static int
+perf_producer(void *arg)
+{
+	struct prod_data *p  = arg;
+	struct test_perf *t = p->t;
+	struct evt_options *opt = t->opt;
+	const uint8_t dev_id = p->dev_id;
+	const uint8_t port = p->port_id;
+	struct rte_mempool *const pool = t->pool;
+	const uint64_t nb_pkts = t->nb_pkts;
+	const uint32_t nb_flows = t->nb_flows;
+	uint32_t flow_counter = 0;
+	uint64_t count = 0;
+	struct perf_elt *m[BURST_SIZE];
+	struct rte_event ev[BURST_SIZE];
+	uint16_t i, enq;
+
+	if (opt->verbose_level > 1)
+		printf("%s(): lcore %d dev_id %d port=%d queue %d\n", __func__,
+				rte_lcore_id(), dev_id, port, p->queue_id);
+
+	memset(ev, 0, sizeof(ev));
+	for (i = 0; i < BURST_SIZE; i++) {
+		ev[i].op = RTE_EVENT_OP_NEW;
+		ev[i].queue_id = p->queue_id;
+		ev[i].sched_type = t->sched_type_list[0];
+		ev[i].priority = RTE_EVENT_DEV_PRIORITY_NORMAL;
+		ev[i].event_type =  RTE_EVENT_TYPE_CPU;
+		ev[i].sub_event_type = 0; /* stage 0 */
+	}
+
+	while ((nb_pkts == 0 || count < nb_pkts) && t->done == false) {
+		if (rte_mempool_get_bulk(pool, (void **)m, BURST_SIZE) < 0) {
+			rte_pause();
+			continue;
+		}
+
+		const uint64_t now = opt->fwd_latency ?
+				rte_get_timer_cycles() : 0;
+
+		for (i = 0; i < BURST_SIZE; i++) {
+			ev[i].flow_id = flow_counter++ % nb_flows;
+			ev[i].event_ptr = m[i];
+			m[i]->timestamp = now;
+		}
+
+		enq = rte_event_enqueue_burst(dev_id, port, ev, BURST_SIZE);
+		while (enq < BURST_SIZE && t->done == false) {
+			rte_pause();
+			enq += rte_event_enqueue_burst(dev_id, port, ev + enq,
+					BURST_SIZE - enq);
+		}
+		if (enq < BURST_SIZE)
+			rte_mempool_put_bulk(pool, (void **)&m[enq],
+					BURST_SIZE - enq);
+		count += BURST_SIZE;
+	}
+
+	return 0;
+}
+
+/*
+ * Producer of event vectors: each event carries vector_size payloads of
+ * the same flow.
+ */
+static int
+perf_producer_vector(void *arg)
+{
+	struct prod_data *p  = arg;
+	struct test_perf *t = p->t;
+	struct evt_options *opt = t->opt;
+	const uint8_t dev_id = p->dev_id;
+	const uint8_t port = p->port_id;
+	struct rte_mempool *const pool = t->pool;
+	struct rte_mempool *const vector_pool = t->vector_pool;
+	const uint16_t vector_size = opt->vector_size;
+	const uint64_t nb_pkts = t->nb_pkts;
+	const uint32_t nb_flows = t->nb_flows;
+	uint32_t flow_counter = 0;
+	uint64_t count = 0;
+	struct rte_event_vector *vec[BURST_SIZE];
+	struct rte_event ev[BURST_SIZE];
+	uint16_t i, enq;
+
+	if (opt->verbose_level > 1)
+		printf("%s(): lcore %d dev_id %d port=%d queue %d\n", __func__,
+				rte_lcore_id(), dev_id, port, p->queue_id);
+
+	memset(ev, 0, sizeof(ev));
+	for (i = 0; i < BURST_SIZE; i++) {
+		ev[i].op = RTE_EVENT_OP_NEW;
+		ev[i].queue_id = p->queue_id;
+		ev[i].sched_type = t->sched_type_list[0];
+		ev[i].priority = RTE_EVENT_DEV_PRIORITY_NORMAL;
+		ev[i].event_type = RTE_EVENT_TYPE_CPU_VECTOR;
+		ev[i].sub_event_type = 0; /* stage 0 */
+	}
+
+	while ((nb_pkts == 0 || count < nb_pkts) && t->done == false) {
+		if (rte_mempool_get_bulk(vector_pool, (void **)vec,
+				BURST_SIZE) < 0) {
+			rte_pause();
+			continue;
+		}
+		for (i = 0; i < BURST_SIZE; i++) {
+			if (rte_mempool_get_bulk(pool, vec[i]->ptrs,
+					vector_size) < 0)
+				break;
+			vec[i]->nb_elem = vector_size;
+		}
+		if (i < BURST_SIZE) {
+			while (i-- > 0)
+				rte_mempool_put_bulk(pool, vec[i]->ptrs,
+						vector_size);
+			rte_mempool_put_bulk(vector_pool, (void **)vec,
+					BURST_SIZE);
+			rte_pause();
+			continue;
+		}
+
+		for (i = 0; i < BURST_SIZE; i++) {
+			ev[i].flow_id = flow_counter++ % nb_flows;
+			ev[i].vec = vec[i];
+		}
+
+		enq = rte_event_enqueue_burst(dev_id, port, ev, BURST_SIZE);
+		while (enq < BURST_SIZE && t->done == false) {
+			rte_pause();
+			enq += rte_event_enqueue_burst(dev_id, port, ev + enq,
+					BURST_SIZE - enq);
+		}
+		if (enq < BURST_SIZE)
+			perf_free_vectors(pool, vector_pool, &vec[enq],
+					BURST_SIZE - enq, true);
+		count += BURST_SIZE * vector_size;
+	}
+
+	return 0;
+}
+
+static inline uint64_t
+processed_pkts(struct test_perf *t)
+{
+	uint8_t i;
+	uint64_t total = 0;
+
+	rte_smp_rmb();
+	for (i = 0; i < t->nb_workers; i++)
+		total += t->worker[i].processed_pkts;
+
+	return total;
+}
+
+static void
+perf_latency_dump(struct test_perf *t, struct evt_options *opt)
+{
+	const double ns_per_cycle = 1E9 / rte_get_timer_hz();
+	uint64_t latency, nb;
+	int stage;
+	uint8_t i;
+
+	printf("forward latency per stage:\n");
+	for (stage = 0; stage < opt->nb_stages; stage++) {
+		latency = 0;
+		nb = 0;
+		for (i = 0; i < t->nb_workers; i++) {
+			latency += t->worker[i].latency[stage];
+			nb += t->worker[i].nb_latency[stage];
+		}
+		if (nb == 0) {
+			printf("\tstage %d (%s): no event\n", stage,
+				evt_sched_type_2_str(opt->sched_type_list[stage]));
+			continue;
+		}
+		printf("\tstage %d (%s): %.1f cycles, %.1f ns\n", stage,
+			evt_sched_type_2_str(opt->sched_type_list[stage]),
+			(double)latency / nb, (double)latency / nb * ns_per_cycle);
+	}
+}
+
+int
+perf_launch_lcores(struct evt_test *test, struct evt_options *opt,
+		int (*worker)(void *))
+{
+	int ret, lcore_id;
+	struct test_perf *t = evt_test_priv(test);
+
+	int port_idx = 0;
+	/* launch workers */
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (!(opt->wlcores[lcore_id]))
+			continue;
+
+		ret = rte_eal_remote_launch(worker,
+				 &t->worker[port_idx], lcore_id);
+		if (ret) {
+			evt_err("failed to launch worker %d", lcore_id);
+			return ret;
+		}
+		port_idx++;
+	}
+
+	/* launch producers */
+	int prod_idx = 0;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (!(opt->plcores[lcore_id]))
+			continue;
+
+		ret = rte_eal_remote_launch(opt->vector_size != 0 ?
+					perf_producer_vector : perf_producer,
+					&t->prod[prod_idx], lcore_id);
+		if (ret) {
+			evt_err("failed to launch perf_producer %d", lcore_id);
+			return ret;
+		}
+		prod_idx++;
+	}
+
+	const uint64_t total_pkts = opt->nb_pkts;
+	const uint64_t hz = rte_get_timer_hz();
+	const uint64_t start_cycles = rte_get_timer_cycles();
+	uint64_t perf_cycles = start_cycles;
+	uint64_t prev_processed = 0, processed = 0, end_cycles;
+	unsigned int stalled = 0;
+
+	t->result = EVT_TEST_SUCCESS;
+	while (t->done == false) {
+		const uint64_t new_cycles = rte_get_timer_cycles();
+
+		processed = processed_pkts(t);
+		if (total_pkts != 0 && processed >= total_pkts)
+			break;
+
+		if (new_cycles - perf_cycles < hz) {
+			rte_pause();
+			continue;
+		}
+
+		const double mpps = (double)(processed - prev_processed) *
+				hz / (new_cycles - perf_cycles) / 1E6;
+		const double avg = (double)processed * hz /
+				(new_cycles - start_cycles) / 1E6;
+
+		printf("\r%.3f mpps avg %.3f mpps", mpps, avg);
+		fflush(stdout);
+
+		if (processed == prev_processed) {
+			if (++stalled == EVT_STALL_TIMEOUT_S) {
+				printf("\n");
+				rte_event_dev_dump(opt->dev_id, stdout);
+				evt_err("No schedules for seconds, deadlock");
+				t->result = EVT_TEST_FAILED;
+				break;
+			}
+		} else {
+			stalled = 0;
+		}
+		prev_processed = processed;
+		perf_cycles = new_cycles;
+	}
+	end_cycles = rte_get_timer_cycles();
+
+	/* stop the producers and the workers */
+	t->done = true;
+	rte_smp_wmb();
+	rte_eal_mp_wait_lcore();
+
+	processed = processed_pkts(t);
+	printf("\r%"PRIu64" packets processed in %.3f s: %.3f mpps\n",
+			processed, (double)(end_cycles - start_cycles) / hz,
+			(double)processed * hz / (end_cycles - start_cycles) /
+			1E6);
+	if (opt->fwd_latency)
+		perf_latency_dump(t, opt);
+
+	if (processed == 0)
+		t->result = EVT_TEST_FAILED;
+
+	return 0;
+}
+
+static int
+perf_rx_adapter_conf_cb(uint8_t id, uint8_t dev_id,
+		struct rte_event_eth_rx_adapter_conf *conf, void *arg)
+{
+	RTE_SET_USED(id);
+	RTE_SET_USED(dev_id);
+
+	/* the port is set up with the others */
+	conf->event_port_id = (uintptr_t)arg;
+	conf->max_nb_rx = 0;
+
+	return 0;
+}
+
+static int
+perf_rx_adapter_setup(struct test_perf *t, struct evt_options *opt,
+		uint8_t port, uint8_t stride)
+{
+	struct rte_event_eth_rx_adapter_queue_conf queue_conf;
+	uint8_t prod;
+	int ret;
+
+	ret = rte_event_eth_rx_adapter_create_ext(PERF_RX_ADAPTER_ID,
+			opt->dev_id, perf_rx_adapter_conf_cb,
+			(void *)(uintptr_t)port);
+	if (ret) {
+		evt_err("failed to create rx adapter");
+		return ret;
+	}
+
+	memset(&queue_conf, 0, sizeof(queue_conf));
+	queue_conf.ev.sched_type = opt->sched_type_list[0];
+	queue_conf.ev.priority = RTE_EVENT_DEV_PRIORITY_NORMAL;
+	if (opt->vector_size != 0) {
+		queue_conf.rx_queue_flags |=
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR;
+		queue_conf.vector_sz = opt->vector_size;
+		queue_conf.vector_timeout_ns = opt->vector_tmo_ns;
+		queue_conf.vector_mp = t->vector_pool;
+	}
+	for (prod = 0; prod < rte_eth_dev_count(); prod++) {
+		/* each ethdev port feeds its own pipeline */
+		queue_conf.ev.queue_id = prod * stride;
+		ret = rte_event_eth_rx_adapter_queue_add(PERF_RX_ADAPTER_ID,
+				prod, -1, &queue_conf);
+		if (ret) {
+			evt_err("failed to add rx queues of port %d", prod);
+			return ret;
+		}
+	}
+
+	return 0;
+}
+
+int
+perf_event_dev_port_setup(struct evt_test *test, struct evt_options *opt,
+				uint8_t stride, uint8_t nb_queues)
+{
+	struct test_perf *t = evt_test_priv(test);
+	struct rte_event_dev_info dev_info;
+	uint8_t port, prod;
+	int ret = -1;
+
+	memset(&dev_info, 0, sizeof(struct rte_event_dev_info));
+	ret = rte_event_dev_info_get(opt->dev_id, &dev_info);
+	if (ret) {
+		evt_err("failed to get eventdev info %d", opt->dev_id);
+		return ret;
+	}
+
+	if (opt->wkr_deq_dep > dev_info.max_event_port_dequeue_depth)
+		opt->wkr_deq_dep = dev_info.max_event_port_dequeue_depth;
+
+	/* port configuration */
+	const struct rte_event_port_conf wkr_p_conf = {
+			.dequeue_depth = opt->wkr_deq_dep,
+			.enqueue_depth = dev_info.max_event_port_enqueue_depth,
+			.new_event_threshold = dev_info.max_num_events,
+	};
+
+	/* setup one port per worker, linking to all queues */
+	for (port = 0; port < evt_nr_active_lcores(opt->wlcores); port++) {
+		struct worker_data *w = &t->worker[port];
+
+		w->dev_id = opt->dev_id;
+		w->port_id = port;
+		w->tx_queue = port;
+		w->t = t;
+		w->processed_pkts = 0;
+
+		ret = rte_event_port_setup(opt->dev_id, port, &wkr_p_conf);
+		if (ret) {
+			evt_err("failed to setup port %d", port);
+			return ret;
+		}
+
+		ret = rte_event_port_link(opt->dev_id, port, NULL, NULL, 0);
+		if (ret != nb_queues) {
+			evt_err("failed to link all queues to port %d", port);
+			return -EINVAL;
+		}
+	}
+
+	/*
+	 * The producers only inject new events: leave half of the event
+	 * credits to the workers, for the events they forward.
+	 */
+	const struct rte_event_port_conf prod_conf = {
+			.dequeue_depth = dev_info.max_event_port_dequeue_depth,
+			.enqueue_depth = dev_info.max_event_port_enqueue_depth,
+			.new_event_threshold = dev_info.max_num_events / 2,
+	};
+
+	if (opt->prod_type == EVT_PROD_TYPE_ETH_RX_ADPTR) {
+		ret = rte_event_port_setup(opt->dev_id, port, &prod_conf);
+		if (ret) {
+			evt_err("failed to setup rx adapter port %d", port);
+			return ret;
+		}
+		return perf_rx_adapter_setup(t, opt, port, stride);
+	}
+
+	/* port for producers, no links */
+	for (prod = 0; prod < perf_nb_producers(opt); prod++, port++) {
+		struct prod_data *p = &t->prod[prod];
+
+		p->dev_id = opt->dev_id;
+		p->port_id = port;
+		p->queue_id = prod * stride;
+		p->t = t;
+
+		ret = rte_event_port_setup(opt->dev_id, port, &prod_conf);
+		if (ret) {
+			evt_err("failed to setup producer port %d", port);
+			return ret;
+		}
+	}
+
+	return ret;
+}
+
+int
+perf_event_dev_start(struct evt_test *test, struct evt_options *opt)
+{
+	int ret;
+
+	RTE_SET_USED(test);
+
+	ret = rte_event_dev_start(opt->dev_id);
+	if (ret) {
+		evt_err("failed to start eventdev %d", opt->dev_id);
+		return ret;
+	}
+
+	if (opt->prod_type == EVT_PROD_TYPE_ETH_RX_ADPTR) {
+		ret = rte_event_eth_rx_adapter_start(PERF_RX_ADAPTER_ID);
+		if (ret) {
+			evt_err("failed to start rx adapter");
+			goto stop;
+		}
+	}
+
+	if (evt_has_active_lcore(opt->slcores)) {
+		ret = evt_service_setup(opt->slcores);
+		if (ret) {
+			evt_err("failed to start the services");
+			goto stop;
+		}
+	}
+
+	return 0;
+stop:
+	if (opt->prod_type == EVT_PROD_TYPE_ETH_RX_ADPTR)
+		rte_event_eth_rx_adapter_stop(PERF_RX_ADAPTER_ID);
+	rte_event_dev_stop(opt->dev_id);
+	return ret;
+}
+
+int
+perf_opt_check(struct evt_options *opt, uint64_t nb_queues)
+{
+	unsigned int lcores;
+	bool need_slcore;
+
+	if (opt->prod_type == EVT_PROD_TYPE_ETH_RX_ADPTR) {
+		if (rte_eth_dev_count() == 0) {
+			evt_err("no ethdev port to produce the events");
+			return -1;
+		}
+		if (evt_has_active_lcore(opt->plcores)) {
+			evt_err("no producer lcore with ethdev producers");
+			return -1;
+		}
+		if (opt->fwd_latency) {
+			evt_err("fwd_latency needs synthetic producers");
+			return -1;
+		}
+		/* N workers + 1 master */
+		lcores = 2;
+		/* the Rx adapter runs as a service */
+		need_slcore = true;
+	} else {
+		/* N producer + N workers + 1 master */
+		lcores = 3;
+		need_slcore = !evt_has_distributed_sched(opt->dev_id);
+	}
+
+	if (rte_lcore_count() < lcores) {
+		evt_err("test need minimum %d lcores", lcores);
+		return -1;
+	}
+
+	/* Validate worker lcores */
+	if (evt_lcores_has_overlap(opt->wlcores, rte_get_master_lcore())) {
+		evt_err("worker lcores overlaps with master lcore");
+		return -1;
+	}
+	if (evt_lcores_has_overlap_multi(opt->wlcores, opt->plcores)) {
+		evt_err("worker lcores overlaps producer lcores");
+		return -1;
+	}
+	if (evt_lcores_has_overlap_multi(opt->slcores, opt->wlcores) ||
+			evt_lcores_has_overlap_multi(opt->slcores,
+				opt->plcores)) {
+		evt_err("service lcores overlaps producer or worker lcores");
+		return -1;
+	}
+	if (evt_has_disabled_lcore(opt->wlcores)) {
+		evt_err("one or more workers lcores are not enabled");
+		return -1;
+	}
+	if (!evt_has_active_lcore(opt->wlcores)) {
+		evt_err("minimum one worker is required");
+		return -1;
+	}
+
+	/* Validate producer lcores */
+	if (opt->prod_type == EVT_PROD_TYPE_SYNT) {
+		if (evt_lcores_has_overlap(opt->plcores,
+					rte_get_master_lcore())) {
+			evt_err("producer lcores overlaps with master lcore");
+			return -1;
+		}
+		if (evt_has_disabled_lcore(opt->plcores)) {
+			evt_err("one or more producer lcores are not enabled");
+			return -1;
+		}
+		if (!evt_has_active_lcore(opt->plcores)) {
+			evt_err("minimum one producer is required");
+			return -1;
+		}
+	}
+
+	if (need_slcore && !evt_has_active_lcore(opt->slcores)) {
+		evt_err("a service lcore is needed, check --slcores");
+		return -1;
+	}
+
+	if (evt_has_invalid_stage(opt))
+		return -1;
+
+	if (evt_has_invalid_sched_type(opt))
+		return -1;
+
+	if (opt->vector_size != 0 && opt->fwd_latency) {
+		evt_err("fwd_latency is not supported with event vectors");
+		return -1;
+	}
+	if (opt->prod_type == EVT_PROD_TYPE_SYNT &&
+			(uint64_t)opt->vector_size * BURST_SIZE *
+			evt_nr_active_lcores(opt->plcores) >
+			(uint64_t)opt->pool_sz / 2) {
+		evt_err("pool_sz too small for the vectors of the producers");
+		return -1;
+	}
+
+	if (nb_queues > EVT_MAX_QUEUES) {
+		evt_err("number of queues exceeds %d", EVT_MAX_QUEUES);
+		return -1;
+	}
+	if (perf_nb_event_ports(opt) > EVT_MAX_PORTS) {
+		evt_err("number of ports exceeds %d", EVT_MAX_PORTS);
+		return -1;
+	}
+
+	/* Fixups */
+	if (opt->nb_stages == 1 && opt->fwd_latency) {
+		evt_info("fwd_latency is meaningless with a single stage, disabled");
+		opt->fwd_latency = 0;
+	}
+
+	return 0;
+}
+
+void
+perf_opt_dump(struct evt_options *opt, uint8_t nb_queues)
+{
+	evt_dump("nb_prod_lcores", "%d", evt_nr_active_lcores(opt->plcores));
+	evt_dump_producer_lcores(opt);
+	evt_dump("nb_worker_lcores", "%d", evt_nr_active_lcores(opt->wlcores));
+	evt_dump_worker_lcores(opt);
+	evt_dump_nb_stages(opt);
+	evt_dump("nb_evdev_ports", "%d", perf_nb_event_ports(opt));
+	evt_dump("nb_evdev_queues", "%d", nb_queues);
+	evt_dump_queue_priority(opt);
+	evt_dump_sched_type_list(opt);
+	evt_dump("producer", "%s",
+		opt->prod_type == EVT_PROD_TYPE_ETH_RX_ADPTR ?
+		"ethdev rx adapter" : "synthetic");
+	evt_dump_vector(opt);
+	evt_dump_fwd_latency(opt);
+	evt_dump_worker_dequeue_depth(opt);
+}
+
+void
+perf_eventdev_destroy(struct evt_test *test, struct evt_options *opt)
+{
+	uint8_t prod;
+
+	RTE_SET_USED(test);
+
+	evt_service_stop();
+	if (opt->prod_type == EVT_PROD_TYPE_ETH_RX_ADPTR) {
+		rte_event_eth_rx_adapter_stop(PERF_RX_ADAPTER_ID);
+		for (prod = 0; prod < rte_eth_dev_count(); prod++)
+			rte_event_eth_rx_adapter_queue_del(PERF_RX_ADAPTER_ID,
+					prod, -1);
+		rte_event_eth_rx_adapter_free(PERF_RX_ADAPTER_ID);
+	}
+	rte_event_dev_stop(opt->dev_id);
+	rte_event_dev_close(opt->dev_id);
+}
+
+int
+perf_ethdev_setup(struct evt_test *test, struct evt_options *opt)
+{
+	struct test_perf *t = evt_test_priv(test);
+	const uint16_t nb_tx_queues = evt_nr_active_lcores(opt->wlcores);
+	struct rte_eth_dev_info dev_info;
+	struct rte_eth_conf port_conf;
+	uint8_t i;
+	uint16_t q;
+	int ret;
+
+	if (opt->prod_type != EVT_PROD_TYPE_ETH_RX_ADPTR)
+		return 0;
+
+	for (i = 0; i < rte_eth_dev_count(); i++) {
+		memset(&port_conf, 0, sizeof(port_conf));
+		rte_eth_dev_info_get(i, &dev_info);
+		/* the rx adapter uses the RSS hash as flow id */
+		if (dev_info.flow_type_rss_offloads & ETH_RSS_IP) {
+			port_conf.rxmode.mq_mode = ETH_MQ_RX_RSS;
+			port_conf.rx_adv_conf.rss_conf.rss_hf = ETH_RSS_IP;
+		}
+
+		/* one tx queue per worker, for the pipeline tests */
+		ret = rte_eth_dev_configure(i, 1, nb_tx_queues, &port_conf);
+		if (ret) {
+			evt_err("failed to configure ethdev port %d", i);
+			return ret;
+		}
+
+		ret = rte_eth_rx_queue_setup(i, 0, PERF_NB_RXD,
+				rte_eth_dev_socket_id(i), NULL, t->pool);
+		if (ret) {
+			evt_err("failed to setup rx queue of port %d", i);
+			return ret;
+		}
+
+		for (q = 0; q < nb_tx_queues; q++) {
+			ret = rte_eth_tx_queue_setup(i, q, PERF_NB_TXD,
+					rte_eth_dev_socket_id(i), NULL);
+			if (ret) {
+				evt_err("failed to setup tx queue %d of port %d",
+						q, i);
+				return ret;
+			}
+		}
+
+		ret = rte_eth_dev_start(i);
+		if (ret) {
+			evt_err("failed to start ethdev port %d", i);
+			return ret;
+		}
+		rte_eth_promiscuous_enable(i);
+	}
+
+	return 0;
+}
+
+void
+perf_ethdev_destroy(struct evt_test *test, struct evt_options *opt)
+{
+	uint8_t i;
+
+	RTE_SET_USED(test);
+
+	if (opt->prod_type != EVT_PROD_TYPE_ETH_RX_ADPTR)
+		return;
+
+	for (i = 0; i < rte_eth_dev_count(); i++)
+		rte_eth_dev_stop(i);
+}
+
+int
+perf_mempool_setup(struct evt_test *test, struct evt_options *opt)
+{
+	struct test_perf *t = evt_test_priv(test);
+
+	if (opt->prod_type == EVT_PROD_TYPE_SYNT) {
+		t->pool = rte_mempool_create(test->name, /* mempool name */
+				opt->pool_sz, /* number of elements*/
+				sizeof(struct perf_elt), /* element size*/
+				512, /* cache size*/
+				0, NULL, NULL,
+				NULL, /* obj constructor */
+				NULL, opt->socket_id, 0); /* flags */
+	} else {
+		t->pool = rte_pktmbuf_pool_create(test->name, /* mempool name */
+				opt->pool_sz, /* number of elements*/
+				512, /* cache size*/
+				0,
+				RTE_MBUF_DEFAULT_BUF_SIZE,
+				opt->socket_id); /* flags */
+	}
+
+	if (t->pool == NULL) {
+		evt_err("failed to create mempool");
+		return -ENOMEM;
+	}
+
+	if (opt->vector_size != 0) {
+		char name[RTE_MEMPOOL_NAMESIZE];
+
+		/* an incomplete vector holds at least one payload */
+		snprintf(name, sizeof(name), "%s_vec", test->name);
+		t->vector_pool = rte_event_vector_pool_create(name,
+				opt->pool_sz, 64, opt->vector_size,
+				opt->socket_id);
+		if (t->vector_pool == NULL) {
+			evt_err("failed to create vector mempool");
+			rte_mempool_free(t->pool);
+			t->pool = NULL;
+			return -ENOMEM;
+		}
+	}
+
+	return 0;
+}
+
+void
+perf_mempool_destroy(struct evt_test *test, struct evt_options *opt)
+{
+	RTE_SET_USED(opt);
+	struct test_perf *t = evt_test_priv(test);
+
+	rte_mempool_free(t->vector_pool);
+	rte_mempool_free(t->pool);
+}
+
+int
+perf_test_setup(struct evt_test *test, struct evt_options *opt)
+{
+	void *test_perf;
+	int nb_prod;
+
+	test_perf = rte_zmalloc_socket(test->name, sizeof(struct test_perf),
+				RTE_CACHE_LINE_SIZE, opt->socket_id);
+	if (test_perf  == NULL) {
+		evt_err("failed to allocate test_perf memory");
+		goto nomem;
+	}
+	test->test_priv = test_perf;
+
+	struct test_perf *t = evt_test_priv(test);
+
+	nb_prod = perf_nb_producers(opt);
+	t->outstand_pkts = opt->nb_pkts;
+	t->nb_workers = evt_nr_active_lcores(opt->wlcores);
+	t->done = false;
+	/* packets per producer, in full bursts */
+	t->nb_pkts = RTE_ALIGN_CEIL((opt->nb_pkts + nb_prod - 1) / nb_prod,
+			BURST_SIZE);
+	t->nb_flows = opt->nb_flows;
+	t->result = EVT_TEST_FAILED;
+	t->opt = opt;
+	memcpy(t->sched_type_list, opt->sched_type_list,
+			sizeof(opt->sched_type_list));
+	return 0;
+nomem:
+	return -ENOMEM;
+}
+
+void
+perf_test_destroy(struct evt_test *test, struct evt_options *opt)
+{
+	RTE_SET_USED(opt);
+
+	rte_free(test->test_priv);
+	test->test_priv = NULL;
+}
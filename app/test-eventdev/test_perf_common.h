@@ -0,0 +1,229 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _TEST_PERF_COMMON_
+#define _TEST_PERF_COMMON_
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include <rte_cycles.h>
+#include <rte_ethdev.h>
+#include <rte_eventdev.h>
+#include <rte_event_eth_rx_adapter.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_prefetch.h>
+
+#include "evt_common.h"
+#include "evt_options.h"
+#include "evt_test.h"
+
+#define BURST_SIZE 16
+
+struct test_perf;
+
+struct worker_data {
+	uint64_t processed_pkts;
+	/* Cycles spent by the events to reach each stage, and their count */
+	uint64_t latency[EVT_MAX_STAGES];
+	uint64_t nb_latency[EVT_MAX_STAGES];
+	uint8_t dev_id;
+	uint8_t port_id;
+	/* Tx queue of the worker on every ethdev port */
+	uint16_t tx_queue;
+	struct test_perf *t;
+} __rte_cache_aligned;
+
+struct prod_data {
+	uint8_t dev_id;
+	uint8_t port_id;
+	uint8_t queue_id;
+	struct test_perf *t;
+} __rte_cache_aligned;
+
+struct test_perf {
+	/* Don't change the offset of "done". Signal handler use this memory
+	 * to terminate all lcores work.
+	 */
+	int done;
+	uint64_t outstand_pkts;
+	uint8_t nb_workers;
+	enum evt_test_result result;
+	uint32_t nb_flows;
+	uint64_t nb_pkts;
+	struct rte_mempool *pool;
+	/* event vectors, when enabled */
+	struct rte_mempool *vector_pool;
+	struct prod_data prod[EVT_MAX_PORTS];
+	struct worker_data worker[EVT_MAX_PORTS];
+	struct evt_options *opt;
+	uint8_t sched_type_list[EVT_MAX_STAGES] __rte_cache_aligned;
+} __rte_cache_aligned;
+
+/* Payload of the events of the synthetic producers */
+struct perf_elt {
+	uint64_t timestamp;
+} __rte_cache_aligned;
+
+#define PERF_WORKER_INIT\
+	struct worker_data *w  = arg;\
+	struct test_perf *t = w->t;\
+	struct evt_options *opt = t->opt;\
+	const uint8_t dev = w->dev_id;\
+	const uint8_t port = w->port_id;\
+	const uint8_t nb_stages = t->opt->nb_stages;\
+	const uint8_t laststage = nb_stages - 1;\
+	uint8_t *const sched_type_list = &t->sched_type_list[0];\
+	struct rte_mempool *const pool = t->pool;\
+	struct rte_mempool *const vector_pool = t->vector_pool;\
+	const bool fwd_latency = opt->fwd_latency;\
+	const bool synt = opt->prod_type == EVT_PROD_TYPE_SYNT;\
+	const uint16_t deq_depth = RTE_MIN(opt->wkr_deq_dep, BURST_SIZE);\
+	if (opt->verbose_level > 1)\
+		printf("%s(): lcore %d dev_id %d port=%d\n", __func__,\
+				rte_lcore_id(), dev, port)
+
+/*
+ * Account the time taken by a synthetic event to reach the stage, since
+ * it was produced or forwarded by the previous stage.
+ */
+static inline __attribute__((always_inline)) void
+perf_stage_latency(struct worker_data *const w, struct rte_event *const ev,
+		const uint8_t stage, const uint64_t now)
+{
+	struct perf_elt *const m = ev->event_ptr;
+
+	w->latency[stage] += now - m->timestamp;
+	w->nb_latency[stage]++;
+	m->timestamp = now;
+}
+
+/*
+ * Free the payloads of the events which completed the last stage: back
+ * in the pool for a synthetic producer, or as packets.
+ */
+static inline __attribute__((always_inline)) void
+perf_free_payloads(struct rte_mempool *const pool, void **const objs,
+		const uint16_t nb, const bool synt)
+{
+	uint16_t i;
+
+	if (nb == 0)
+		return;
+	if (synt) {
+		rte_mempool_put_bulk(pool, objs, nb);
+	} else {
+		for (i = 0; i < nb; i++)
+			rte_pktmbuf_free(objs[i]);
+	}
+}
+
+/*
+ * Free the vectors of the events which completed the last stage, with
+ * their payloads, and return the number of payloads.
+ */
+static inline __attribute__((always_inline)) uint64_t
+perf_free_vectors(struct rte_mempool *const pool,
+		struct rte_mempool *const vector_pool,
+		struct rte_event_vector **const vecs, const uint16_t nb,
+		const bool synt)
+{
+	uint64_t nb_elem = 0;
+	uint16_t i;
+
+	if (nb == 0)
+		return 0;
+	for (i = 0; i < nb; i++) {
+		perf_free_payloads(pool, vecs[i]->ptrs, vecs[i]->nb_elem, synt);
+		nb_elem += vecs[i]->nb_elem;
+	}
+	rte_mempool_put_bulk(vector_pool, (void **)vecs, nb);
+
+	return nb_elem;
+}
+
+/* Enqueue a burst of forwarded or released events, until done */
+static inline __attribute__((always_inline)) void
+perf_enqueue_burst(struct test_perf *const t, const uint8_t dev,
+		const uint8_t port, struct rte_event *const ev,
+		const uint16_t nb)
+{
+	uint16_t enq;
+
+	enq = rte_event_enqueue_burst(dev, port, ev, nb);
+	while (enq < nb && !t->done) {
+		rte_pause();
+		enq += rte_event_enqueue_burst(dev, port, ev + enq, nb - enq);
+	}
+}
+
+/* Number of producers: producer lcores, or ethdev ports */
+static inline int
+perf_nb_producers(struct evt_options *opt)
+{
+	if (opt->prod_type == EVT_PROD_TYPE_ETH_RX_ADPTR)
+		return rte_eth_dev_count();
+	return evt_nr_active_lcores(opt->plcores);
+}
+
+/* One port per worker, plus one per producer lcore or for the Rx adapter */
+static inline int
+perf_nb_event_ports(struct evt_options *opt)
+{
+	if (opt->prod_type == EVT_PROD_TYPE_ETH_RX_ADPTR)
+		return evt_nr_active_lcores(opt->wlcores) + 1;
+	return evt_nr_active_lcores(opt->wlcores) +
+			evt_nr_active_lcores(opt->plcores);
+}
+
+int perf_test_result(struct evt_test *test, struct evt_options *opt);
+int perf_opt_check(struct evt_options *opt, uint64_t nb_queues);
+int perf_test_setup(struct evt_test *test, struct evt_options *opt);
+int perf_mempool_setup(struct evt_test *test, struct evt_options *opt);
+int perf_ethdev_setup(struct evt_test *test, struct evt_options *opt);
+int perf_event_dev_port_setup(struct evt_test *test, struct evt_options *opt,
+				uint8_t stride, uint8_t nb_queues);
+int perf_event_dev_start(struct evt_test *test, struct evt_options *opt);
+int perf_launch_lcores(struct evt_test *test, struct evt_options *opt,
+		int (*worker)(void *));
+void perf_opt_dump(struct evt_options *opt, uint8_t nb_queues);
+void perf_test_destroy(struct evt_test *test, struct evt_options *opt);
+void perf_eventdev_destroy(struct evt_test *test, struct evt_options *opt);
+void perf_ethdev_destroy(struct evt_test *test, struct evt_options *opt);
+void perf_mempool_destroy(struct evt_test *test, struct evt_options *opt);
+
+#endif /* _TEST_PERF_COMMON_ */
@@ -0,0 +1,219 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "test_perf_common.h"
+
+/*
+ * Packet pipeline: the packets received by the ethdev ports are injected
+ * by the Rx adapter in a chain of nb_stages queues per port, and sent back
+ * on their port by the worker which processes their last stage. Each
+ * worker has its own Tx queue on every port.
+ */
+
+static inline int
+pipeline_queue_nb_event_queues(struct evt_options *opt)
+{
+	return perf_nb_producers(opt) * opt->nb_stages;
+}
+
+/* Send the packets, grouped by port; free the ones which are not sent */
+static inline __attribute__((always_inline)) void
+pipeline_tx_burst(struct worker_data *const w, struct rte_mbuf **const pkts,
+		const uint16_t nb)
+{
+	uint16_t i, start, sent;
+
+	for (start = 0; start < nb; start = i) {
+		const uint8_t eth_port = pkts[start]->port;
+
+		for (i = start + 1; i < nb && pkts[i]->port == eth_port; i++)
+			;
+		sent = rte_eth_tx_burst(eth_port, w->tx_queue, &pkts[start],
+				i - start);
+		for (sent += start; sent < i; sent++)
+			rte_pktmbuf_free(pkts[sent]);
+	}
+}
+
+static int
+pipeline_queue_worker(void *arg)
+{
+	PERF_WORKER_INIT;
+	struct rte_event ev[BURST_SIZE];
+	struct rte_mbuf *tx_pkts[BURST_SIZE];
+	struct rte_event_vector *tx_vecs[BURST_SIZE];
+	uint16_t i, nb_rx, nb_tx, nb_vecs;
+
+	RTE_SET_USED(pool);
+	RTE_SET_USED(fwd_latency);
+	RTE_SET_USED(synt);
+
+	while (t->done == false) {
+		nb_rx = rte_event_dequeue_burst(dev, port, ev, deq_depth, 0);
+		if (nb_rx == 0) {
+			rte_pause();
+			continue;
+		}
+
+		nb_tx = 0;
+		nb_vecs = 0;
+		for (i = 0; i < nb_rx; i++) {
+			const uint8_t stage = ev[i].queue_id % nb_stages;
+
+			if (stage == laststage) {
+				/* last stage: the packets are sent */
+				if (ev[i].event_type & RTE_EVENT_TYPE_VECTOR)
+					tx_vecs[nb_vecs++] = ev[i].vec;
+				else
+					tx_pkts[nb_tx++] = ev[i].mbuf;
+				ev[i].op = RTE_EVENT_OP_RELEASE;
+			} else {
+				ev[i].queue_id++;
+				ev[i].sched_type = sched_type_list[stage + 1];
+				ev[i].op = RTE_EVENT_OP_FORWARD;
+			}
+		}
+		perf_enqueue_burst(t, dev, port, ev, nb_rx);
+		if (nb_tx != 0)
+			pipeline_tx_burst(w, tx_pkts, nb_tx);
+		w->processed_pkts += nb_tx;
+		for (i = 0; i < nb_vecs; i++) {
+			pipeline_tx_burst(w, tx_vecs[i]->mbufs,
+					tx_vecs[i]->nb_elem);
+			w->processed_pkts += tx_vecs[i]->nb_elem;
+		}
+		if (nb_vecs != 0)
+			rte_mempool_put_bulk(vector_pool, (void **)tx_vecs,
+					nb_vecs);
+	}
+
+	return 0;
+}
+
+static int
+pipeline_queue_launch_lcores(struct evt_test *test, struct evt_options *opt)
+{
+	return perf_launch_lcores(test, opt, pipeline_queue_worker);
+}
+
+static int
+pipeline_queue_eventdev_setup(struct evt_test *test, struct evt_options *opt)
+{
+	const int nb_stages = opt->nb_stages;
+	const int nb_queues = pipeline_queue_nb_event_queues(opt);
+	uint8_t queue;
+	int ret;
+
+	ret = evt_configure_eventdev(opt->dev_id, opt->nb_flows, nb_queues,
+			perf_nb_event_ports(opt));
+	if (ret) {
+		evt_err("failed to configure eventdev %d", opt->dev_id);
+		return ret;
+	}
+
+	struct rte_event_queue_conf q_conf = {
+			.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+			.nb_atomic_flows = opt->nb_flows,
+			.nb_atomic_order_sequences = opt->nb_flows,
+	};
+	for (queue = 0; queue < nb_queues; queue++) {
+		q_conf.event_queue_cfg = evt_sched_type2queue_cfg
+				(opt->sched_type_list[(queue % nb_stages)]);
+		ret = rte_event_queue_setup(opt->dev_id, queue, &q_conf);
+		if (ret) {
+			evt_err("failed to setup queue=%d", queue);
+			return ret;
+		}
+	}
+
+	ret = perf_event_dev_port_setup(test, opt, nb_stages /* stride */,
+			nb_queues);
+	if (ret)
+		return ret;
+
+	return perf_event_dev_start(test, opt);
+}
+
+static void
+pipeline_queue_opt_dump(struct evt_options *opt)
+{
+	perf_opt_dump(opt, pipeline_queue_nb_event_queues(opt));
+}
+
+static int
+pipeline_queue_opt_check(struct evt_options *opt)
+{
+	/* the packets are always received from the ethdev ports */
+	opt->prod_type = EVT_PROD_TYPE_ETH_RX_ADPTR;
+	if (opt->q_priority) {
+		evt_err("queue_priority is not supported by this test");
+		return -1;
+	}
+	return perf_opt_check(opt, pipeline_queue_nb_event_queues(opt));
+}
+
+static bool
+pipeline_queue_capability_check(struct evt_options *opt)
+{
+	struct rte_event_dev_info dev_info;
+
+	rte_event_dev_info_get(opt->dev_id, &dev_info);
+	if (dev_info.max_event_queues < pipeline_queue_nb_event_queues(opt) ||
+			dev_info.max_event_ports < perf_nb_event_ports(opt)) {
+		evt_err("not enough eventdev queues=%d/%d or ports=%d/%d",
+			pipeline_queue_nb_event_queues(opt),
+			dev_info.max_event_queues,
+			perf_nb_event_ports(opt), dev_info.max_event_ports);
+		return false;
+	}
+
+	return true;
+}
+
+static const struct evt_test_ops pipeline_queue =  {
+	.cap_check          = pipeline_queue_capability_check,
+	.opt_check          = pipeline_queue_opt_check,
+	.opt_dump           = pipeline_queue_opt_dump,
+	.test_setup         = perf_test_setup,
+	.mempool_setup      = perf_mempool_setup,
+	.ethdev_setup       = perf_ethdev_setup,
+	.eventdev_setup     = pipeline_queue_eventdev_setup,
+	.launch_lcores      = pipeline_queue_launch_lcores,
+	.eventdev_destroy   = perf_eventdev_destroy,
+	.ethdev_destroy     = perf_ethdev_destroy,
+	.mempool_destroy    = perf_mempool_destroy,
+	.test_result        = perf_test_result,
+	.test_destroy       = perf_test_destroy,
+};
+
+EVT_TEST_REGISTER(pipeline_queue);
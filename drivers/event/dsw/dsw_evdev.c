@@ -0,0 +1,481 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_vdev.h>
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_ring.h>
+
+#include "dsw_evdev.h"
+
+#define EVENTDEV_NAME_DSW_PMD event_dsw
+
+static void
+dsw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info)
+{
+	RTE_SET_USED(dev);
+
+	static const struct rte_event_dev_info evdev_dsw_info = {
+			.driver_name = DSW_PMD_NAME,
+			.max_event_queues = DSW_MAX_QUEUES,
+			.max_event_queue_flows = DSW_MAX_FLOWS,
+			.max_event_queue_priority_levels = 1,
+			.max_event_priority_levels = 1,
+			.max_event_ports = DSW_MAX_PORTS,
+			.max_event_port_dequeue_depth =
+				DSW_MAX_PORT_DEQUEUE_DEPTH,
+			.max_event_port_enqueue_depth =
+				DSW_MAX_PORT_ENQUEUE_DEPTH,
+			.max_num_events = DSW_MAX_EVENTS,
+			.event_dev_cap = RTE_EVENT_DEV_CAP_DISTRIBUTED_SCHED,
+	};
+
+	*info = evdev_dsw_info;
+}
+
+static int
+dsw_dev_configure(const struct rte_eventdev *dev)
+{
+	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+	const struct rte_event_dev_config *conf = &dev->data->dev_conf;
+	uint16_t i;
+
+	if (conf->event_dev_cfg & RTE_EVENT_DEV_CFG_PER_DEQUEUE_TIMEOUT)
+		return -ENOTSUP;
+
+	dsw->num_ports = conf->nb_event_ports;
+	dsw->num_queues = conf->nb_event_queues;
+	dsw->max_inflight = conf->nb_events_limit;
+
+	/* the credit accounting restarts from scratch */
+	rte_atomic32_set(&dsw->credits_on_loan, 0);
+	for (i = 0; i < DSW_MAX_PORTS; i++) {
+		dsw->ports[i].inflight_credits = 0;
+		dsw->ports[i].pending_releases = 0;
+	}
+
+	dsw->load_update_interval =
+		rte_get_timer_hz() * DSW_LOAD_UPDATE_INTERVAL_US / US_PER_S;
+	dsw->migration_interval =
+		rte_get_timer_hz() * DSW_MIGRATION_INTERVAL_US / US_PER_S;
+
+	return 0;
+}
+
+static void
+dsw_port_release(void *p)
+{
+	struct dsw_port *port = p;
+
+	if (port == NULL || port->dsw == NULL)
+		return;
+
+	rte_atomic32_sub(&port->dsw->credits_on_loan,
+			port->inflight_credits);
+	dsw_ring_free(port->in_ring);
+	rte_ring_free(port->ctl_in_ring);
+	rte_free(port->in_buffer);
+	rte_free(port->paused_events);
+	memset(port, 0, sizeof(*port));
+}
+
+static int
+dsw_port_setup(struct rte_eventdev *dev, uint8_t port_id,
+		const struct rte_event_port_conf *conf)
+{
+	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+	struct dsw_port *port = &dsw->ports[port_id];
+	const int socket_id = dev->data->socket_id;
+	char name[RTE_RING_NAMESIZE];
+
+	if (port->in_ring != NULL)
+		dsw_port_release(port);
+
+	port->id = port_id;
+	port->dsw = dsw;
+	port->new_event_threshold = conf->new_event_threshold;
+	port->dequeue_depth = conf->dequeue_depth;
+
+	/* the ring takes all the events of the instance, so that forwarding
+	 * an event never fails
+	 */
+	snprintf(name, sizeof(name), "dsw%d_p%u_in", dev->data->dev_id,
+			port_id);
+	port->in_ring = dsw_ring_create(name, DSW_MAX_EVENTS, socket_id);
+
+	snprintf(name, sizeof(name), "dsw%d_p%u_ctl", dev->data->dev_id,
+			port_id);
+	port->ctl_in_ring = rte_ring_create(name, DSW_CTL_RING_SIZE,
+			socket_id, RING_F_SC_DEQ);
+
+	port->in_buffer = rte_zmalloc_socket(NULL,
+			DSW_MAX_EVENTS * sizeof(port->in_buffer[0]),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	port->paused_events = rte_zmalloc_socket(NULL,
+			DSW_MAX_EVENTS * sizeof(port->paused_events[0]),
+			RTE_CACHE_LINE_SIZE, socket_id);
+
+	if (port->in_ring == NULL || port->ctl_in_ring == NULL ||
+			port->in_buffer == NULL ||
+			port->paused_events == NULL) {
+		DSW_LOG_ERR("Error allocating the rings of port %u", port_id);
+		dsw_port_release(port);
+		return -ENOMEM;
+	}
+
+	dev->data->ports[port_id] = port;
+
+	return 0;
+}
+
+static void
+dsw_port_def_conf(struct rte_eventdev *dev, uint8_t port_id,
+		struct rte_event_port_conf *port_conf)
+{
+	RTE_SET_USED(dev);
+	RTE_SET_USED(port_id);
+
+	port_conf->new_event_threshold = 1024;
+	port_conf->dequeue_depth = 16;
+	port_conf->enqueue_depth = 16;
+}
+
+static int
+dsw_queue_setup(struct rte_eventdev *dev, uint8_t queue_id,
+		const struct rte_event_queue_conf *conf)
+{
+	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+	struct dsw_queue *queue = &dsw->queues[queue_id];
+
+	/* a single-link queue keeps the order of the events without the
+	 * flow tracking of the atomic queues
+	 */
+	if (conf->event_queue_cfg & RTE_EVENT_QUEUE_CFG_SINGLE_LINK) {
+		queue->schedule_type = RTE_SCHED_TYPE_PARALLEL;
+		queue->single_link = 1;
+	} else {
+		switch (conf->event_queue_cfg) {
+		case RTE_EVENT_QUEUE_CFG_ATOMIC_ONLY:
+			queue->schedule_type = RTE_SCHED_TYPE_ATOMIC;
+			break;
+		case RTE_EVENT_QUEUE_CFG_PARALLEL_ONLY:
+			queue->schedule_type = RTE_SCHED_TYPE_PARALLEL;
+			break;
+		case RTE_EVENT_QUEUE_CFG_ORDERED_ONLY:
+			DSW_LOG_ERR("Ordered queues not supported");
+			return -ENOTSUP;
+		case RTE_EVENT_QUEUE_CFG_ALL_TYPES:
+			DSW_LOG_ERR("QUEUE_CFG_ALL_TYPES not supported");
+			return -ENOTSUP;
+		default:
+			DSW_LOG_ERR("Unknown queue type %d requested",
+					conf->event_queue_cfg);
+			return -EINVAL;
+		}
+		queue->single_link = 0;
+	}
+	queue->configured = 1;
+
+	return 0;
+}
+
+static void
+dsw_queue_def_conf(struct rte_eventdev *dev, uint8_t queue_id,
+		struct rte_event_queue_conf *conf)
+{
+	RTE_SET_USED(dev);
+	RTE_SET_USED(queue_id);
+
+	static const struct rte_event_queue_conf default_conf = {
+		.nb_atomic_flows = DSW_MAX_FLOWS,
+		.nb_atomic_order_sequences = 1,
+		.event_queue_cfg = RTE_EVENT_QUEUE_CFG_ATOMIC_ONLY,
+		.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+	};
+
+	*conf = default_conf;
+}
+
+static void
+dsw_queue_release(struct rte_eventdev *dev, uint8_t queue_id)
+{
+	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+
+	memset(&dsw->queues[queue_id], 0, sizeof(dsw->queues[queue_id]));
+}
+
+static int
+dsw_queue_is_linked(const struct dsw_queue *queue, uint8_t port_id)
+{
+	uint8_t i;
+
+	for (i = 0; i < queue->num_serving_ports; i++)
+		if (queue->serving_ports[i] == port_id)
+			return 1;
+	return 0;
+}
+
+static int
+dsw_port_link(struct rte_eventdev *dev, void *p, const uint8_t queues[],
+		const uint8_t priorities[], uint16_t num)
+{
+	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+	struct dsw_port *port = p;
+	uint16_t i;
+
+	RTE_SET_USED(priorities);
+
+	/* the ports build their flow tables on start */
+	if (dev->data->dev_started) {
+		rte_errno = -EBUSY;
+		return 0;
+	}
+
+	for (i = 0; i < num; i++) {
+		struct dsw_queue *queue = &dsw->queues[queues[i]];
+
+		if (dsw_queue_is_linked(queue, port->id))
+			continue;
+		if (queue->single_link && queue->num_serving_ports > 0) {
+			rte_errno = -EDQUOT;
+			break;
+		}
+		queue->serving_ports[queue->num_serving_ports++] = port->id;
+	}
+
+	return i;
+}
+
+static int
+dsw_port_unlink(struct rte_eventdev *dev, void *p, uint8_t queues[],
+		uint16_t num)
+{
+	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+	struct dsw_port *port = p;
+	uint16_t i, j;
+	int unlinked = 0;
+
+	if (dev->data->dev_started) {
+		rte_errno = -EBUSY;
+		return 0;
+	}
+
+	for (i = 0; i < num; i++) {
+		struct dsw_queue *queue = &dsw->queues[queues[i]];
+
+		for (j = 0; j < queue->num_serving_ports; j++) {
+			if (queue->serving_ports[j] == port->id) {
+				queue->serving_ports[j] = queue->serving_ports[
+					--queue->num_serving_ports];
+				unlinked++;
+				break;
+			}
+		}
+	}
+
+	return unlinked;
+}
+
+static int
+dsw_start(struct rte_eventdev *dev)
+{
+	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+	uint16_t i;
+
+	for (i = 0; i < dsw->num_ports; i++)
+		if (dsw->ports[i].in_ring == NULL) {
+			DSW_LOG_ERR("Port %u not configured", i);
+			return -ESTALE;
+		}
+
+	for (i = 0; i < dsw->num_queues; i++)
+		if (!dsw->queues[i].configured ||
+				dsw->queues[i].num_serving_ports == 0) {
+			DSW_LOG_ERR("Queue %u not configured or not linked",
+					i);
+			return -ENOLINK;
+		}
+
+	for (i = 0; i < dsw->num_ports; i++)
+		dsw_port_start(dsw, &dsw->ports[i]);
+
+	return 0;
+}
+
+static void
+dsw_stop(struct rte_eventdev *dev)
+{
+	RTE_SET_USED(dev);
+}
+
+static int
+dsw_close(struct rte_eventdev *dev)
+{
+	struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+	uint16_t i;
+
+	for (i = 0; i < dsw->num_queues; i++)
+		dsw_queue_release(dev, i);
+	dsw->num_queues = 0;
+
+	for (i = 0; i < dsw->num_ports; i++)
+		dsw_port_release(&dsw->ports[i]);
+	dsw->num_ports = 0;
+
+	return 0;
+}
+
+static void
+dsw_dump(struct rte_eventdev *dev, FILE *f)
+{
+	static const char * const type_str[] = {
+		[RTE_SCHED_TYPE_ORDERED] = "ordered",
+		[RTE_SCHED_TYPE_ATOMIC] = "atomic",
+		[RTE_SCHED_TYPE_PARALLEL] = "parallel",
+	};
+	const struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+	uint16_t i, j;
+
+	fprintf(f, "EventDev %s: ports %u, queues %u\n", dev->data->name,
+			dsw->num_ports, dsw->num_queues);
+	fprintf(f, "\tinflight %d, max %d\n",
+			rte_atomic32_read(&dsw->credits_on_loan),
+			dsw->max_inflight);
+
+	for (i = 0; i < dsw->num_ports; i++) {
+		const struct dsw_port *port = &dsw->ports[i];
+
+		fprintf(f, "  Port %u\n", i);
+		fprintf(f, "\tnew %"PRIu64"\tforward %"PRIu64
+				"\trelease %"PRIu64"\tdrop %"PRIu64"\n",
+				port->new_enqueued, port->forward_enqueued,
+				port->release_enqueued, port->dropped);
+		fprintf(f, "\tdequeued %"PRIu64"\tin ring %u\tin buffer %u\n",
+				port->dequeued, dsw_ring_count(port->in_ring),
+				port->in_buffer_len);
+		fprintf(f, "\tload %d%%\temigrations %"PRIu64
+				"\timmigrations %"PRIu64"\n", port->load,
+				port->emigrations, port->immigrations);
+		fprintf(f, "\tcredits %d\tpending releases %u\tpaused flows %u (%u events)\n",
+				port->inflight_credits, port->pending_releases,
+				port->paused_flows_len,
+				port->paused_events_len);
+	}
+
+	for (i = 0; i < dsw->num_queues; i++) {
+		const struct dsw_queue *queue = &dsw->queues[i];
+
+		fprintf(f, "  Queue %u (%s%s)\n\tports:", i,
+				type_str[queue->schedule_type],
+				queue->single_link ? ", single-link" : "");
+		for (j = 0; j < queue->num_serving_ports; j++)
+			fprintf(f, " %u", queue->serving_ports[j]);
+		fprintf(f, "\n");
+	}
+}
+
+static int
+dsw_probe(struct rte_vdev_device *vdev)
+{
+	static const struct rte_eventdev_ops evdev_dsw_ops = {
+			.dev_configure = dsw_dev_configure,
+			.dev_infos_get = dsw_info_get,
+			.dev_close = dsw_close,
+			.dev_start = dsw_start,
+			.dev_stop = dsw_stop,
+			.dump = dsw_dump,
+
+			.queue_def_conf = dsw_queue_def_conf,
+			.queue_setup = dsw_queue_setup,
+			.queue_release = dsw_queue_release,
+			.port_def_conf = dsw_port_def_conf,
+			.port_setup = dsw_port_setup,
+			.port_release = dsw_port_release,
+			.port_link = dsw_port_link,
+			.port_unlink = dsw_port_unlink,
+
+			.xstats_get = dsw_xstats_get,
+			.xstats_get_names = dsw_xstats_get_names,
+			.xstats_get_by_name = dsw_xstats_get_by_name,
+	};
+	const char *name;
+	struct rte_eventdev *dev;
+	struct dsw_evdev *dsw;
+
+	name = rte_vdev_device_name(vdev);
+
+	dev = rte_event_pmd_vdev_init(name, sizeof(struct dsw_evdev),
+			rte_socket_id());
+	if (dev == NULL) {
+		DSW_LOG_ERR("eventdev vdev init() failed");
+		return -EFAULT;
+	}
+	dev->dev_ops = &evdev_dsw_ops;
+	dev->enqueue = dsw_event_enqueue;
+	dev->enqueue_burst = dsw_event_enqueue_burst;
+	dev->dequeue = dsw_event_dequeue;
+	dev->dequeue_burst = dsw_event_dequeue_burst;
+	/* scheduling happens in the enqueue and dequeue calls */
+	dev->schedule = NULL;
+
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY)
+		return 0;
+
+	dsw = dev->data->dev_private;
+	dsw->data = dev->data;
+
+	return 0;
+}
+
+static int
+dsw_remove(struct rte_vdev_device *vdev)
+{
+	const char *name;
+
+	name = rte_vdev_device_name(vdev);
+	if (name == NULL)
+		return -EINVAL;
+
+	return rte_event_pmd_vdev_uninit(name);
+}
+
+static struct rte_vdev_driver evdev_dsw_pmd_drv = {
+	.probe = dsw_probe,
+	.remove = dsw_remove
+};
+
+RTE_PMD_REGISTER_VDEV(EVENTDEV_NAME_DSW_PMD, evdev_dsw_pmd_drv);
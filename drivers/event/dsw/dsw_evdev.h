@@ -0,0 +1,236 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _DSW_EVDEV_H_
+#define _DSW_EVDEV_H_
+
+#include <rte_eventdev.h>
+#include <rte_eventdev_pmd.h>
+#include <rte_atomic.h>
+#include <rte_ring.h>
+
+#include "dsw_ring.h"
+
+#define DSW_PMD_NAME RTE_STR(event_dsw)
+
+#define DSW_MAX_PORTS 64
+#define DSW_MAX_QUEUES 16
+#define DSW_MAX_EVENTS 4096
+#define DSW_MAX_PORT_DEQUEUE_DEPTH 128
+#define DSW_MAX_PORT_ENQUEUE_DEPTH 128
+
+/* the flow ids of an atomic queue are hashed into DSW_MAX_FLOWS flows,
+ * which are the unit of migration between ports
+ */
+#define DSW_MAX_FLOWS_BITS 10
+#define DSW_MAX_FLOWS (1 << DSW_MAX_FLOWS_BITS)
+#define DSW_MAX_FLOWS_MASK (DSW_MAX_FLOWS - 1)
+
+/* events buffered per destination port before enqueuing to its ring */
+#define DSW_MAX_PORT_OUT_BUFFER 32
+
+/* credits taken from, and kept back from, the instance at a time */
+#define DSW_PORT_CREDITS_CHUNK 32
+
+/* the flows of the last dequeued events, from which the flow to migrate
+ * is picked
+ */
+#define DSW_MAX_EVENTS_RECORDED 128
+
+/* port load, in percent of the cycles spent processing events */
+#define DSW_MAX_LOAD 100
+#define DSW_LOAD_UPDATE_INTERVAL_US 250
+/* weight of the previous load in the new estimation, as 1/n */
+#define DSW_LOAD_AGING 4
+
+/* a port only sheds a flow when loaded above this, to a port loaded at
+ * least DSW_MIN_LOAD_DIFF less
+ */
+#define DSW_MIN_SOURCE_LOAD_FOR_MIGRATION 70
+#define DSW_MIN_LOAD_DIFF 25
+#define DSW_MIGRATION_INTERVAL_US 1000
+
+/* Control messages pending on a port are at most a request and a
+ * confirmation from each of the other ports.
+ */
+#define DSW_CTL_RING_SIZE 256
+
+#define DSW_LOG_ERR(fmt, args...) \
+	RTE_LOG(ERR, EVENTDEV, "[%s] %s() line %u: " fmt "\n", \
+			DSW_PMD_NAME, \
+			__func__, __LINE__, ## args)
+
+#ifdef RTE_LIBRTE_PMD_DSW_EVENTDEV_DEBUG
+#define DSW_LOG_DBG(fmt, args...) \
+	RTE_LOG(DEBUG, EVENTDEV, "[%s] %s() line %u: " fmt "\n", \
+			DSW_PMD_NAME, \
+			__func__, __LINE__, ## args)
+#else
+#define DSW_LOG_DBG(fmt, args...)
+#endif
+
+enum dsw_migration_state {
+	DSW_MIGRATION_STATE_IDLE,
+	/* waiting for the other ports to pause the flow */
+	DSW_MIGRATION_STATE_PAUSING,
+	/* waiting for the other ports to send the flow to its new port */
+	DSW_MIGRATION_STATE_UNPAUSING,
+};
+
+struct dsw_queue_flow {
+	uint8_t queue_id;
+	uint16_t flow_hash;
+};
+
+struct dsw_evdev;
+
+struct dsw_port {
+	uint16_t id;
+	struct dsw_evdev *dsw;
+
+	/* credits taken from the instance and not used by new events yet */
+	int32_t inflight_credits;
+	int32_t new_event_threshold;
+	uint16_t dequeue_depth;
+	/* dequeued events not forwarded or released yet */
+	uint16_t pending_releases;
+
+	/* the port of the next event to each parallel queue, as an index
+	 * in its serving ports
+	 */
+	uint8_t parallel_next[DSW_MAX_QUEUES];
+
+	/* this port's view of the port serving each atomic flow */
+	uint8_t flow2port[DSW_MAX_QUEUES][DSW_MAX_FLOWS];
+
+	uint16_t out_buffer_len[DSW_MAX_PORTS];
+	struct rte_event out_buffer[DSW_MAX_PORTS][DSW_MAX_PORT_OUT_BUFFER];
+
+	/* events taken from the in ring but not dequeued yet, by a flow
+	 * migration; they are dequeued before the ring
+	 */
+	uint16_t in_buffer_start;
+	uint16_t in_buffer_len;
+	struct rte_event *in_buffer;
+
+	/* flows being migrated by other ports, and the events enqueued to
+	 * them meanwhile
+	 */
+	uint16_t paused_flows_len;
+	struct dsw_queue_flow paused_flows[DSW_MAX_PORTS];
+	uint16_t paused_events_len;
+	struct rte_event *paused_events;
+
+	/* load estimation */
+	uint64_t measurement_start;
+	uint64_t busy_start;
+	uint64_t busy_cycles;
+	uint64_t next_load_update;
+	volatile int16_t load;
+
+	/* migration of a flow from this port */
+	enum dsw_migration_state migration_state;
+	uint64_t next_migration;
+	struct dsw_queue_flow emigration_flow;
+	uint8_t emigration_target;
+	uint16_t cfm_cnt;
+
+	uint16_t seen_events_len;
+	uint16_t seen_events_idx;
+	struct dsw_queue_flow seen_events[DSW_MAX_EVENTS_RECORDED];
+
+	/* statistics */
+	uint64_t new_enqueued;
+	uint64_t forward_enqueued;
+	uint64_t release_enqueued;
+	uint64_t dequeued;
+	uint64_t dropped;
+	uint64_t emigrations;
+	uint64_t immigrations;
+
+	/* events sent to this port by all the ports */
+	struct dsw_ring *in_ring;
+	/* control messages sent to this port */
+	struct rte_ring *ctl_in_ring;
+} __rte_cache_aligned;
+
+struct dsw_queue {
+	uint8_t configured;
+	uint8_t schedule_type;
+	uint8_t single_link;
+	uint8_t num_serving_ports;
+	uint8_t serving_ports[DSW_MAX_PORTS];
+};
+
+struct dsw_evdev {
+	struct rte_eventdev_data *data;
+
+	struct dsw_port ports[DSW_MAX_PORTS];
+	uint16_t num_ports;
+	struct dsw_queue queues[DSW_MAX_QUEUES];
+	uint8_t num_queues;
+	int32_t max_inflight;
+
+	uint64_t load_update_interval;
+	uint64_t migration_interval;
+
+	rte_atomic32_t credits_on_loan __rte_cache_aligned;
+};
+
+static inline struct dsw_evdev *
+dsw_pmd_priv(const struct rte_eventdev *eventdev)
+{
+	return eventdev->data->dev_private;
+}
+
+/* dsw_event.c */
+uint16_t dsw_event_enqueue(void *port, const struct rte_event *ev);
+uint16_t dsw_event_enqueue_burst(void *port, const struct rte_event ev[],
+		uint16_t num);
+uint16_t dsw_event_dequeue(void *port, struct rte_event *ev, uint64_t wait);
+uint16_t dsw_event_dequeue_burst(void *port, struct rte_event *ev,
+		uint16_t num, uint64_t wait);
+void dsw_port_start(struct dsw_evdev *dsw, struct dsw_port *port);
+
+/* dsw_xstats.c */
+int dsw_xstats_get_names(const struct rte_eventdev *dev,
+		enum rte_event_dev_xstats_mode mode, uint8_t queue_port_id,
+		struct rte_event_dev_xstats_name *xstats_names,
+		unsigned int *ids, unsigned int size);
+int dsw_xstats_get(const struct rte_eventdev *dev,
+		enum rte_event_dev_xstats_mode mode, uint8_t queue_port_id,
+		const unsigned int ids[], uint64_t values[], unsigned int n);
+uint64_t dsw_xstats_get_by_name(const struct rte_eventdev *dev,
+		const char *name, unsigned int *id);
+
+#endif /* _DSW_EVDEV_H_ */
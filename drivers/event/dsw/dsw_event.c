@@ -0,0 +1,793 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_ring.h>
+
+#include "dsw_evdev.h"
+
+/*
+ * There is no scheduler: the port enqueuing an event picks the port which
+ * will dequeue it, and puts it in the in ring of that port.
+ *
+ * The events of a parallel queue are sent in turn to the ports linked to
+ * it. The flows of an atomic queue are each served by one port at a time,
+ * per the flow2port table of the sending port. The ports keep their own
+ * copy of this table, and move flows from a loaded port to a less loaded
+ * one with a control message protocol:
+ *  1. the port serving the flow (the source) asks all the other ports to
+ *     pause it; each of them flushes the events it buffered, then keeps
+ *     the events it enqueues to the flow aside, and confirms;
+ *  2. when all have confirmed, and the source holds no event dequeued and
+ *     not released, it moves the events of the flow waiting in its in ring
+ *     to the target port, and updates its table;
+ *  3. the source asks the other ports to unpause the flow; each of them
+ *     updates its table, sends the events it kept aside to the target port,
+ *     and confirms.
+ * The events of the flow thus stay in order, and are never held by two
+ * ports at once.
+ */
+
+enum dsw_ctl_type {
+	DSW_CTL_PAUSE_REQ,
+	DSW_CTL_UNPAUSE_REQ,
+	DSW_CTL_CFM,
+};
+
+/* A control message fits a pointer, as passed by the rte_ring:
+ * type (2 bits), source port (6), queue (8), flow hash (10) and
+ * target port (6).
+ */
+#define DSW_CTL_TYPE_SHIFT 0
+#define DSW_CTL_SOURCE_SHIFT 2
+#define DSW_CTL_QUEUE_SHIFT 8
+#define DSW_CTL_FLOW_SHIFT 16
+#define DSW_CTL_TARGET_SHIFT (DSW_CTL_FLOW_SHIFT + DSW_MAX_FLOWS_BITS)
+
+struct dsw_ctl_msg {
+	uint8_t type;
+	uint8_t source_port_id;
+	struct dsw_queue_flow qf;
+	uint8_t target_port_id;
+};
+
+static inline void *
+dsw_ctl_encode(const struct dsw_ctl_msg *msg)
+{
+	return (void *)(uintptr_t)
+		((uint32_t)msg->type << DSW_CTL_TYPE_SHIFT |
+		 (uint32_t)msg->source_port_id << DSW_CTL_SOURCE_SHIFT |
+		 (uint32_t)msg->qf.queue_id << DSW_CTL_QUEUE_SHIFT |
+		 (uint32_t)msg->qf.flow_hash << DSW_CTL_FLOW_SHIFT |
+		 (uint32_t)msg->target_port_id << DSW_CTL_TARGET_SHIFT);
+}
+
+static inline void
+dsw_ctl_decode(void *obj, struct dsw_ctl_msg *msg)
+{
+	const uint32_t v = (uint32_t)(uintptr_t)obj;
+
+	msg->type = (v >> DSW_CTL_TYPE_SHIFT) & 0x3;
+	msg->source_port_id = (v >> DSW_CTL_SOURCE_SHIFT) & 0x3f;
+	msg->qf.queue_id = (v >> DSW_CTL_QUEUE_SHIFT) & 0xff;
+	msg->qf.flow_hash = (v >> DSW_CTL_FLOW_SHIFT) & DSW_MAX_FLOWS_MASK;
+	msg->target_port_id = (v >> DSW_CTL_TARGET_SHIFT) & 0x3f;
+}
+
+static inline uint16_t
+dsw_flow_hash(uint32_t flow_id)
+{
+	/* fold the 20 bits of the flow id */
+	return (flow_id ^ (flow_id >> DSW_MAX_FLOWS_BITS)) & DSW_MAX_FLOWS_MASK;
+}
+
+static inline int
+dsw_acquire_credits(struct dsw_evdev *dsw, struct dsw_port *port,
+		int32_t credits)
+{
+	const int32_t limit = RTE_MIN(dsw->max_inflight,
+			port->new_event_threshold);
+	int32_t missing = credits - port->inflight_credits;
+	int32_t acquired;
+
+	if (likely(missing <= 0))
+		return 1;
+
+	acquired = RTE_MAX(missing, DSW_PORT_CREDITS_CHUNK);
+	if (rte_atomic32_add_return(&dsw->credits_on_loan, acquired) >
+			limit) {
+		rte_atomic32_sub(&dsw->credits_on_loan, acquired);
+		if (acquired == missing)
+			return 0;
+		/* retry without the spare credits */
+		acquired = missing;
+		if (rte_atomic32_add_return(&dsw->credits_on_loan,
+					acquired) > limit) {
+			rte_atomic32_sub(&dsw->credits_on_loan, acquired);
+			return 0;
+		}
+	}
+
+	port->inflight_credits += acquired;
+	return 1;
+}
+
+/* Return the credits of the released events, keeping a chunk for the new
+ * events to come, or all of them when the port is idle.
+ */
+static inline void
+dsw_return_credits(struct dsw_evdev *dsw, struct dsw_port *port, int idle)
+{
+	int32_t keep, returned;
+
+	if (idle) {
+		if (port->inflight_credits == 0)
+			return;
+		keep = 0;
+	} else {
+		if (likely(port->inflight_credits <
+					2 * DSW_PORT_CREDITS_CHUNK))
+			return;
+		keep = DSW_PORT_CREDITS_CHUNK;
+	}
+
+	returned = port->inflight_credits - keep;
+	port->inflight_credits = keep;
+	rte_atomic32_sub(&dsw->credits_on_loan, returned);
+}
+
+static void
+dsw_port_ctl_send(struct dsw_evdev *dsw, uint8_t port_id,
+		const struct dsw_ctl_msg *msg)
+{
+	struct dsw_port *port = &dsw->ports[port_id];
+
+	/* the ring is sized for all the messages which may be pending on a
+	 * port, so this does not loop
+	 */
+	while (rte_ring_enqueue(port->ctl_in_ring, dsw_ctl_encode(msg)) != 0)
+		rte_pause();
+}
+
+/* Send a message to all ports but the sender, the one given last. */
+static void
+dsw_port_ctl_broadcast(struct dsw_evdev *dsw, struct dsw_port *source_port,
+		const struct dsw_ctl_msg *msg, uint8_t last_port_id)
+{
+	uint16_t port_id;
+
+	for (port_id = 0; port_id < dsw->num_ports; port_id++)
+		if (port_id != source_port->id && port_id != last_port_id)
+			dsw_port_ctl_send(dsw, port_id, msg);
+	if (last_port_id != source_port->id)
+		dsw_port_ctl_send(dsw, last_port_id, msg);
+}
+
+static void
+dsw_port_flush_out_buffer(struct dsw_evdev *dsw, struct dsw_port *port,
+		uint8_t dest_port_id)
+{
+	struct rte_event *buffer = port->out_buffer[dest_port_id];
+	const uint16_t len = port->out_buffer_len[dest_port_id];
+	uint16_t enqueued;
+
+	if (len == 0)
+		return;
+
+	enqueued = dsw_ring_mp_enqueue_burst(dsw->ports[dest_port_id].in_ring,
+			buffer, len);
+	if (unlikely(enqueued < len))
+		memmove(buffer, &buffer[enqueued],
+				(len - enqueued) * sizeof(buffer[0]));
+	port->out_buffer_len[dest_port_id] = len - enqueued;
+}
+
+static void
+dsw_port_flush_out_buffers(struct dsw_evdev *dsw, struct dsw_port *port)
+{
+	uint16_t dest_port_id;
+
+	for (dest_port_id = 0; dest_port_id < dsw->num_ports; dest_port_id++)
+		dsw_port_flush_out_buffer(dsw, port, dest_port_id);
+}
+
+static inline int
+dsw_port_buffer_non_paused(struct dsw_evdev *dsw, struct dsw_port *port,
+		uint8_t dest_port_id, const struct rte_event *event)
+{
+	uint16_t *len = &port->out_buffer_len[dest_port_id];
+
+	if (unlikely(*len == DSW_MAX_PORT_OUT_BUFFER)) {
+		dsw_port_flush_out_buffer(dsw, port, dest_port_id);
+		if (*len == DSW_MAX_PORT_OUT_BUFFER)
+			return 0;
+	}
+
+	port->out_buffer[dest_port_id][(*len)++] = *event;
+	if (*len == DSW_MAX_PORT_OUT_BUFFER)
+		dsw_port_flush_out_buffer(dsw, port, dest_port_id);
+
+	return 1;
+}
+
+static inline int
+dsw_port_is_flow_paused(const struct dsw_port *port, uint8_t queue_id,
+		uint16_t flow_hash)
+{
+	uint16_t i;
+
+	for (i = 0; i < port->paused_flows_len; i++)
+		if (port->paused_flows[i].queue_id == queue_id &&
+				port->paused_flows[i].flow_hash == flow_hash)
+			return 1;
+	return 0;
+}
+
+/* Pick the destination port of an event and buffer it. */
+static inline int
+dsw_port_buffer_event(struct dsw_evdev *dsw, struct dsw_port *port,
+		const struct rte_event *event)
+{
+	const uint8_t queue_id = event->queue_id;
+	struct dsw_queue *queue = &dsw->queues[queue_id];
+	uint8_t dest_port_id;
+
+	if (queue->schedule_type == RTE_SCHED_TYPE_ATOMIC) {
+		const uint16_t flow_hash = dsw_flow_hash(event->flow_id);
+
+		if (unlikely(port->paused_flows_len > 0) &&
+				dsw_port_is_flow_paused(port, queue_id,
+					flow_hash)) {
+			if (port->paused_events_len == DSW_MAX_EVENTS)
+				return 0;
+			port->paused_events[port->paused_events_len++] = *event;
+			return 1;
+		}
+		dest_port_id = port->flow2port[queue_id][flow_hash];
+	} else {
+		uint8_t next = port->parallel_next[queue_id];
+
+		dest_port_id = queue->serving_ports[next];
+		if (++next == queue->num_serving_ports)
+			next = 0;
+		port->parallel_next[queue_id] = next;
+	}
+
+	return dsw_port_buffer_non_paused(dsw, port, dest_port_id, event);
+}
+
+static void
+dsw_port_add_paused_flow(struct dsw_port *port,
+		const struct dsw_queue_flow *qf)
+{
+	port->paused_flows[port->paused_flows_len++] = *qf;
+}
+
+static void
+dsw_port_remove_paused_flow(struct dsw_port *port,
+		const struct dsw_queue_flow *qf)
+{
+	uint16_t i;
+
+	for (i = 0; i < port->paused_flows_len; i++) {
+		if (port->paused_flows[i].queue_id == qf->queue_id &&
+				port->paused_flows[i].flow_hash ==
+				qf->flow_hash) {
+			port->paused_flows[i] =
+				port->paused_flows[--port->paused_flows_len];
+			return;
+		}
+	}
+}
+
+/* Send the events kept aside for a flow to its new port, in order. */
+static void
+dsw_port_flush_paused_events(struct dsw_evdev *dsw, struct dsw_port *port,
+		const struct dsw_queue_flow *qf, uint8_t dest_port_id)
+{
+	uint16_t i, left = 0;
+
+	for (i = 0; i < port->paused_events_len; i++) {
+		const struct rte_event *event = &port->paused_events[i];
+
+		if (event->queue_id == qf->queue_id &&
+				dsw_flow_hash(event->flow_id) == qf->flow_hash &&
+				dsw_port_buffer_non_paused(dsw, port,
+					dest_port_id, event))
+			continue;
+		port->paused_events[left++] = *event;
+	}
+	port->paused_events_len = left;
+
+	dsw_port_flush_out_buffer(dsw, port, dest_port_id);
+}
+
+static void
+dsw_port_handle_pause_req(struct dsw_evdev *dsw, struct dsw_port *port,
+		const struct dsw_ctl_msg *msg)
+{
+	const struct dsw_ctl_msg cfm = {
+		.type = DSW_CTL_CFM,
+		.source_port_id = port->id,
+	};
+
+	/* the events already sent to the flow go to its current port */
+	dsw_port_flush_out_buffers(dsw, port);
+	dsw_port_add_paused_flow(port, &msg->qf);
+
+	dsw_port_ctl_send(dsw, msg->source_port_id, &cfm);
+}
+
+static void
+dsw_port_handle_unpause_req(struct dsw_evdev *dsw, struct dsw_port *port,
+		const struct dsw_ctl_msg *msg)
+{
+	const struct dsw_ctl_msg cfm = {
+		.type = DSW_CTL_CFM,
+		.source_port_id = port->id,
+	};
+
+	port->flow2port[msg->qf.queue_id][msg->qf.flow_hash] =
+		msg->target_port_id;
+	dsw_port_remove_paused_flow(port, &msg->qf);
+	dsw_port_flush_paused_events(dsw, port, &msg->qf,
+			msg->target_port_id);
+	if (msg->target_port_id == port->id)
+		port->immigrations++;
+
+	dsw_port_ctl_send(dsw, msg->source_port_id, &cfm);
+}
+
+static void
+dsw_port_handle_cfm(struct dsw_evdev *dsw, struct dsw_port *port)
+{
+	port->cfm_cnt++;
+
+	if (port->migration_state == DSW_MIGRATION_STATE_UNPAUSING &&
+			port->cfm_cnt == dsw->num_ports - 1) {
+		port->migration_state = DSW_MIGRATION_STATE_IDLE;
+		DSW_LOG_DBG("Port %u migrated flow %u:%u to port %u",
+				port->id, port->emigration_flow.queue_id,
+				port->emigration_flow.flow_hash,
+				port->emigration_target);
+	}
+}
+
+static void
+dsw_port_ctl_process(struct dsw_evdev *dsw, struct dsw_port *port)
+{
+	void *objs[DSW_MAX_PORTS];
+	unsigned int i, n;
+
+	n = rte_ring_dequeue_burst(port->ctl_in_ring, objs, RTE_DIM(objs),
+			NULL);
+	for (i = 0; i < n; i++) {
+		struct dsw_ctl_msg msg;
+
+		dsw_ctl_decode(objs[i], &msg);
+		switch (msg.type) {
+		case DSW_CTL_PAUSE_REQ:
+			dsw_port_handle_pause_req(dsw, port, &msg);
+			break;
+		case DSW_CTL_UNPAUSE_REQ:
+			dsw_port_handle_unpause_req(dsw, port, &msg);
+			break;
+		case DSW_CTL_CFM:
+			dsw_port_handle_cfm(dsw, port);
+			break;
+		}
+	}
+}
+
+/* With the flow paused by all the other ports and no event of it held by
+ * the application, move its events waiting in this port to the target,
+ * and ask the other ports to send it there from now on.
+ */
+static void
+dsw_port_move_emigrating_flow(struct dsw_evdev *dsw, struct dsw_port *port)
+{
+	const struct dsw_queue_flow *qf = &port->emigration_flow;
+	const uint8_t target = port->emigration_target;
+	const struct dsw_ctl_msg unpause = {
+		.type = DSW_CTL_UNPAUSE_REQ,
+		.source_port_id = port->id,
+		.qf = *qf,
+		.target_port_id = target,
+	};
+	uint16_t i, left = 0;
+
+	/* the events this port sent itself go through its ring too */
+	dsw_port_flush_out_buffers(dsw, port);
+
+	if (port->in_buffer_start > 0) {
+		memmove(port->in_buffer,
+				&port->in_buffer[port->in_buffer_start],
+				port->in_buffer_len *
+				sizeof(port->in_buffer[0]));
+		port->in_buffer_start = 0;
+	}
+	port->in_buffer_len += dsw_ring_sc_dequeue_burst(port->in_ring,
+			&port->in_buffer[port->in_buffer_len],
+			DSW_MAX_EVENTS - port->in_buffer_len);
+
+	for (i = 0; i < port->in_buffer_len; i++) {
+		const struct rte_event *event = &port->in_buffer[i];
+
+		if (event->queue_id == qf->queue_id &&
+				dsw_flow_hash(event->flow_id) == qf->flow_hash &&
+				dsw_port_buffer_non_paused(dsw, port, target,
+					event))
+			continue;
+		port->in_buffer[left++] = *event;
+	}
+	port->in_buffer_len = left;
+	dsw_port_flush_out_buffer(dsw, port, target);
+
+	port->flow2port[qf->queue_id][qf->flow_hash] = target;
+	/* the target last, for the other ports to know of the new port
+	 * before the target can migrate the flow again
+	 */
+	port->cfm_cnt = 0;
+	port->migration_state = DSW_MIGRATION_STATE_UNPAUSING;
+	dsw_port_ctl_broadcast(dsw, port, &unpause, target);
+
+	port->seen_events_len = 0;
+	port->seen_events_idx = 0;
+}
+
+/* Choose the flow to shed, among the flows of the last dequeued events,
+ * and the port to move it to.
+ */
+static int
+dsw_port_select_emigration(struct dsw_evdev *dsw, struct dsw_port *port,
+		struct dsw_queue_flow *qf, uint8_t *target)
+{
+	struct dsw_queue_flow flows[DSW_MAX_EVENTS_RECORDED];
+	uint16_t counts[DSW_MAX_EVENTS_RECORDED];
+	const int16_t load = port->load;
+	uint16_t num_flows = 0, i, j;
+	int16_t best_flow_load = 0;
+
+	for (i = 0; i < port->seen_events_len; i++) {
+		const struct dsw_queue_flow *seen = &port->seen_events[i];
+
+		for (j = 0; j < num_flows; j++)
+			if (flows[j].queue_id == seen->queue_id &&
+					flows[j].flow_hash == seen->flow_hash)
+				break;
+		if (j == num_flows) {
+			flows[num_flows] = *seen;
+			counts[num_flows++] = 0;
+		}
+		counts[j]++;
+	}
+
+	for (i = 0; i < num_flows; i++) {
+		const struct dsw_queue *queue = &dsw->queues[flows[i].queue_id];
+		const int16_t flow_load =
+			load * counts[i] / port->seen_events_len;
+		int16_t target_load = DSW_MAX_LOAD + 1;
+		uint8_t target_id = port->id;
+
+		/* moving all of the load would not help */
+		if (counts[i] == port->seen_events_len ||
+				flow_load <= best_flow_load)
+			continue;
+		if (port->flow2port[flows[i].queue_id][flows[i].flow_hash] !=
+				port->id)
+			continue;
+
+		for (j = 0; j < queue->num_serving_ports; j++) {
+			const struct dsw_port *candidate =
+				&dsw->ports[queue->serving_ports[j]];
+
+			if (candidate != port && candidate->load < target_load) {
+				target_load = candidate->load;
+				target_id = candidate->id;
+			}
+		}
+
+		if (target_id == port->id ||
+				load - target_load < DSW_MIN_LOAD_DIFF ||
+				target_load + flow_load >= load - flow_load)
+			continue;
+
+		*qf = flows[i];
+		*target = target_id;
+		best_flow_load = flow_load;
+	}
+
+	return best_flow_load > 0;
+}
+
+static void
+dsw_port_consider_migration(struct dsw_evdev *dsw, struct dsw_port *port,
+		uint64_t now)
+{
+	struct dsw_ctl_msg pause = {
+		.type = DSW_CTL_PAUSE_REQ,
+		.source_port_id = port->id,
+	};
+
+	port->next_migration = now + dsw->migration_interval;
+
+	if (dsw->num_ports == 1 ||
+			port->migration_state != DSW_MIGRATION_STATE_IDLE ||
+			port->load < DSW_MIN_SOURCE_LOAD_FOR_MIGRATION)
+		return;
+
+	if (!dsw_port_select_emigration(dsw, port, &port->emigration_flow,
+				&port->emigration_target))
+		return;
+
+	pause.qf = port->emigration_flow;
+	port->cfm_cnt = 0;
+	port->migration_state = DSW_MIGRATION_STATE_PAUSING;
+	port->emigrations++;
+	dsw_port_ctl_broadcast(dsw, port, &pause, port->id);
+}
+
+static void
+dsw_port_update_load(struct dsw_evdev *dsw, struct dsw_port *port,
+		uint64_t now)
+{
+	const uint64_t elapsed = now - port->measurement_start;
+	uint64_t busy = port->busy_cycles;
+	int16_t new_load;
+
+	if (port->busy_start != 0) {
+		busy += now - port->busy_start;
+		port->busy_start = now;
+	}
+	new_load = elapsed > 0 ? busy * DSW_MAX_LOAD / elapsed : 0;
+	port->load = (port->load * (DSW_LOAD_AGING - 1) + new_load) /
+		DSW_LOAD_AGING;
+
+	port->measurement_start = now;
+	port->busy_cycles = 0;
+	port->next_load_update = now + dsw->load_update_interval;
+}
+
+static inline void
+dsw_port_bg_process(struct dsw_evdev *dsw, struct dsw_port *port)
+{
+	uint64_t now;
+
+	dsw_port_ctl_process(dsw, port);
+
+	if (unlikely(port->migration_state == DSW_MIGRATION_STATE_PAUSING) &&
+			port->cfm_cnt == dsw->num_ports - 1 &&
+			port->pending_releases == 0)
+		dsw_port_move_emigrating_flow(dsw, port);
+
+	now = rte_get_timer_cycles();
+	if (unlikely(now >= port->next_load_update)) {
+		dsw_port_update_load(dsw, port, now);
+		/* events left by a full ring */
+		dsw_port_flush_out_buffers(dsw, port);
+		if (now >= port->next_migration)
+			dsw_port_consider_migration(dsw, port, now);
+	}
+}
+
+uint16_t
+dsw_event_enqueue_burst(void *port_arg, const struct rte_event ev[],
+		uint16_t num)
+{
+	struct dsw_port *port = port_arg;
+	struct dsw_evdev *dsw = port->dsw;
+	int32_t num_new = 0;
+	uint16_t i;
+
+	dsw_port_bg_process(dsw, port);
+
+	if (num > DSW_MAX_PORT_ENQUEUE_DEPTH)
+		num = DSW_MAX_PORT_ENQUEUE_DEPTH;
+
+	for (i = 0; i < num; i++)
+		num_new += (ev[i].op == RTE_EVENT_OP_NEW);
+	if (num_new > 0 && !dsw_acquire_credits(dsw, port, num_new))
+		return 0;
+
+	for (i = 0; i < num; i++) {
+		const struct rte_event *event = &ev[i];
+		const int outstanding = port->pending_releases > 0;
+
+		if (event->op == RTE_EVENT_OP_RELEASE) {
+			port->pending_releases -= outstanding;
+			port->inflight_credits += outstanding;
+			port->release_enqueued++;
+			continue;
+		}
+
+		if (unlikely(event->queue_id >= dsw->num_queues)) {
+			/* dropped: the event no longer needs its credit */
+			if (event->op == RTE_EVENT_OP_FORWARD) {
+				port->pending_releases -= outstanding;
+				port->inflight_credits++;
+			}
+			port->dropped++;
+			continue;
+		}
+
+		if (unlikely(!dsw_port_buffer_event(dsw, port, event)))
+			break;
+
+		if (event->op == RTE_EVENT_OP_NEW) {
+			port->inflight_credits--;
+			port->new_enqueued++;
+		} else {
+			port->pending_releases -= outstanding;
+			port->forward_enqueued++;
+		}
+	}
+
+	dsw_port_flush_out_buffers(dsw, port);
+
+	return i;
+}
+
+uint16_t
+dsw_event_enqueue(void *port, const struct rte_event *ev)
+{
+	return dsw_event_enqueue_burst(port, ev, 1);
+}
+
+static inline uint16_t
+dsw_port_dequeue(struct dsw_port *port, struct rte_event *ev, uint16_t num)
+{
+	if (unlikely(port->in_buffer_len > 0)) {
+		if (num > port->in_buffer_len)
+			num = port->in_buffer_len;
+		memcpy(ev, &port->in_buffer[port->in_buffer_start],
+				num * sizeof(ev[0]));
+		port->in_buffer_start += num;
+		port->in_buffer_len -= num;
+		if (port->in_buffer_len == 0)
+			port->in_buffer_start = 0;
+		return num;
+	}
+
+	return dsw_ring_sc_dequeue_burst(port->in_ring, ev, num);
+}
+
+static inline void
+dsw_port_record_seen_events(struct dsw_evdev *dsw, struct dsw_port *port,
+		const struct rte_event *ev, uint16_t num)
+{
+	uint16_t i;
+
+	for (i = 0; i < num; i++) {
+		struct dsw_queue_flow *seen;
+
+		if (dsw->queues[ev[i].queue_id].schedule_type !=
+				RTE_SCHED_TYPE_ATOMIC)
+			continue;
+
+		seen = &port->seen_events[port->seen_events_idx];
+		seen->queue_id = ev[i].queue_id;
+		seen->flow_hash = dsw_flow_hash(ev[i].flow_id);
+		if (++port->seen_events_idx == DSW_MAX_EVENTS_RECORDED)
+			port->seen_events_idx = 0;
+		if (port->seen_events_len < DSW_MAX_EVENTS_RECORDED)
+			port->seen_events_len++;
+	}
+}
+
+uint16_t
+dsw_event_dequeue_burst(void *port_arg, struct rte_event *ev, uint16_t num,
+		uint64_t wait)
+{
+	struct dsw_port *port = port_arg;
+	struct dsw_evdev *dsw = port->dsw;
+	uint16_t dequeued;
+
+	RTE_SET_USED(wait);
+
+	/* the events of the previous dequeue are released */
+	port->inflight_credits += port->pending_releases;
+	port->pending_releases = 0;
+
+	if (port->busy_start != 0) {
+		port->busy_cycles += rte_get_timer_cycles() - port->busy_start;
+		port->busy_start = 0;
+	}
+
+	dsw_port_bg_process(dsw, port);
+
+	if (num > port->dequeue_depth)
+		num = port->dequeue_depth;
+
+	dequeued = dsw_port_dequeue(port, ev, num);
+	if (dequeued > 0) {
+		port->pending_releases = dequeued;
+		port->dequeued += dequeued;
+		port->busy_start = rte_get_timer_cycles();
+		dsw_port_record_seen_events(dsw, port, ev, dequeued);
+	}
+
+	dsw_return_credits(dsw, port, dequeued == 0);
+
+	return dequeued;
+}
+
+uint16_t
+dsw_event_dequeue(void *port, struct rte_event *ev, uint64_t wait)
+{
+	return dsw_event_dequeue_burst(port, ev, 1, wait);
+}
+
+/* Reset the flows and the load of a port when the device starts. */
+void
+dsw_port_start(struct dsw_evdev *dsw, struct dsw_port *port)
+{
+	const uint64_t now = rte_get_timer_cycles();
+	uint16_t queue_id, flow_hash, i;
+
+	for (queue_id = 0; queue_id < dsw->num_queues; queue_id++) {
+		const struct dsw_queue *queue = &dsw->queues[queue_id];
+
+		port->parallel_next[queue_id] =
+			port->id % queue->num_serving_ports;
+		for (flow_hash = 0; flow_hash < DSW_MAX_FLOWS; flow_hash++)
+			port->flow2port[queue_id][flow_hash] =
+				queue->serving_ports[flow_hash %
+				queue->num_serving_ports];
+	}
+
+	port->migration_state = DSW_MIGRATION_STATE_IDLE;
+	port->cfm_cnt = 0;
+	port->seen_events_len = 0;
+	port->seen_events_idx = 0;
+	port->load = 0;
+	port->busy_start = 0;
+	port->busy_cycles = 0;
+	port->measurement_start = now;
+	port->next_load_update = now + dsw->load_update_interval;
+	port->next_migration = now + dsw->migration_interval;
+
+	/* the migrations were abandoned on stop: send the events kept
+	 * aside to the ports now serving their flows
+	 */
+	port->paused_flows_len = 0;
+	for (i = 0; i < port->paused_events_len; i++) {
+		const struct rte_event *event = &port->paused_events[i];
+
+		dsw_port_buffer_event(dsw, port, event);
+	}
+	port->paused_events_len = 0;
+	dsw_port_flush_out_buffers(dsw, port);
+}
@@ -0,0 +1,149 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Ring of events, multi-producer and single-consumer.
+ *
+ * Each port of the distributed software eventdev has one, in which all the
+ * ports enqueue the events scheduled to it. The producers reserve their
+ * slots with a compare-and-set on the head, copy their events and publish
+ * them in the order of their reservations; there is no lock.
+ */
+
+#ifndef _DSW_RING_H_
+#define _DSW_RING_H_
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_atomic.h>
+#include <rte_branch_prediction.h>
+#include <rte_malloc.h>
+#include <rte_eventdev.h>
+
+#define DSW_RING_NAMESIZE 32
+
+struct dsw_ring {
+	char name[DSW_RING_NAMESIZE] __rte_cache_aligned;
+	uint32_t size; /* number of events, a power of 2 */
+	uint32_t mask;
+	volatile uint32_t prod_head __rte_cache_aligned;
+	volatile uint32_t prod_tail;
+	volatile uint32_t cons_tail __rte_cache_aligned;
+
+	struct rte_event ring[0] __rte_cache_aligned;
+};
+
+static inline struct dsw_ring *
+dsw_ring_create(const char *name, unsigned int size, unsigned int socket_id)
+{
+	struct dsw_ring *r;
+	const uint32_t ring_size = rte_align32pow2(size);
+
+	r = rte_zmalloc_socket(NULL, sizeof(*r) +
+			ring_size * sizeof(r->ring[0]),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (r == NULL)
+		return NULL;
+
+	snprintf(r->name, sizeof(r->name), "%s", name);
+	r->size = ring_size;
+	r->mask = ring_size - 1;
+
+	return r;
+}
+
+static inline void
+dsw_ring_free(struct dsw_ring *r)
+{
+	rte_free(r);
+}
+
+static inline uint32_t
+dsw_ring_count(const struct dsw_ring *r)
+{
+	return r->prod_tail - r->cons_tail;
+}
+
+static inline uint16_t
+dsw_ring_mp_enqueue_burst(struct dsw_ring *r, const struct rte_event *ev,
+		uint16_t n)
+{
+	uint32_t head, free_entries, i;
+
+	do {
+		head = r->prod_head;
+		/* read the consumer tail after the head */
+		rte_smp_rmb();
+		free_entries = r->size - (head - r->cons_tail);
+		if (unlikely(n > free_entries))
+			n = free_entries;
+		if (unlikely(n == 0))
+			return 0;
+	} while (unlikely(rte_atomic32_cmpset(&r->prod_head, head,
+				head + n) == 0));
+
+	for (i = 0; i < n; i++)
+		r->ring[(head + i) & r->mask] = ev[i];
+	rte_smp_wmb();
+
+	/* publish after the producers which reserved before */
+	while (unlikely(r->prod_tail != head))
+		rte_pause();
+	r->prod_tail = head + n;
+
+	return n;
+}
+
+static inline uint16_t
+dsw_ring_sc_dequeue_burst(struct dsw_ring *r, struct rte_event *ev,
+		uint16_t n)
+{
+	const uint32_t tail = r->cons_tail;
+	uint32_t avail, i;
+
+	avail = r->prod_tail - tail;
+	rte_smp_rmb();
+	if (n > avail)
+		n = avail;
+
+	for (i = 0; i < n; i++)
+		ev[i] = r->ring[(tail + i) & r->mask];
+	rte_smp_rmb();
+	r->cons_tail = tail + n;
+
+	return n;
+}
+
+#endif /* _DSW_RING_H_ */
@@ -0,0 +1,230 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "dsw_evdev.h"
+
+/*
+ * The ids of the statistics are the device ones, then those of each port
+ * in turn. The queues have no statistics.
+ */
+
+typedef uint64_t (*dsw_xstats_dev_fn)(const struct dsw_evdev *dsw);
+typedef uint64_t (*dsw_xstats_port_fn)(const struct dsw_port *port);
+
+struct dsw_xstats_dev {
+	const char *name;
+	dsw_xstats_dev_fn fn;
+};
+
+struct dsw_xstats_port {
+	const char *name;
+	dsw_xstats_port_fn fn;
+};
+
+static uint64_t
+dsw_xstats_dev_credits_on_loan(const struct dsw_evdev *dsw)
+{
+	return rte_atomic32_read(&dsw->credits_on_loan);
+}
+
+static const struct dsw_xstats_dev dsw_dev_xstats[] = {
+	{ "dev_credits_on_loan", dsw_xstats_dev_credits_on_loan },
+};
+
+#define DSW_GEN_PORT_STAT_FN(_stat)					\
+	static uint64_t							\
+	dsw_xstats_port_ ## _stat(const struct dsw_port *port)		\
+	{								\
+		return port->_stat;					\
+	}
+
+DSW_GEN_PORT_STAT_FN(new_enqueued)
+DSW_GEN_PORT_STAT_FN(forward_enqueued)
+DSW_GEN_PORT_STAT_FN(release_enqueued)
+DSW_GEN_PORT_STAT_FN(dequeued)
+DSW_GEN_PORT_STAT_FN(dropped)
+DSW_GEN_PORT_STAT_FN(emigrations)
+DSW_GEN_PORT_STAT_FN(immigrations)
+DSW_GEN_PORT_STAT_FN(load)
+DSW_GEN_PORT_STAT_FN(inflight_credits)
+DSW_GEN_PORT_STAT_FN(pending_releases)
+DSW_GEN_PORT_STAT_FN(paused_events_len)
+
+static uint64_t
+dsw_xstats_port_in_ring_used(const struct dsw_port *port)
+{
+	return dsw_ring_count(port->in_ring) + port->in_buffer_len;
+}
+
+static const struct dsw_xstats_port dsw_port_xstats[] = {
+	{ "new_enqueued", dsw_xstats_port_new_enqueued },
+	{ "forward_enqueued", dsw_xstats_port_forward_enqueued },
+	{ "release_enqueued", dsw_xstats_port_release_enqueued },
+	{ "dequeued", dsw_xstats_port_dequeued },
+	{ "dropped", dsw_xstats_port_dropped },
+	{ "emigrations", dsw_xstats_port_emigrations },
+	{ "immigrations", dsw_xstats_port_immigrations },
+	{ "load", dsw_xstats_port_load },
+	{ "inflight_credits", dsw_xstats_port_inflight_credits },
+	{ "pending_releases", dsw_xstats_port_pending_releases },
+	{ "in_ring_used", dsw_xstats_port_in_ring_used },
+	{ "paused_events", dsw_xstats_port_paused_events_len },
+};
+
+#define DSW_DEV_XSTATS_NUM RTE_DIM(dsw_dev_xstats)
+#define DSW_PORT_XSTATS_NUM RTE_DIM(dsw_port_xstats)
+
+static inline unsigned int
+dsw_xstats_port_id(uint8_t port_id, unsigned int stat)
+{
+	return DSW_DEV_XSTATS_NUM + port_id * DSW_PORT_XSTATS_NUM + stat;
+}
+
+int
+dsw_xstats_get_names(const struct rte_eventdev *dev,
+		enum rte_event_dev_xstats_mode mode, uint8_t queue_port_id,
+		struct rte_event_dev_xstats_name *xstats_names,
+		unsigned int *ids, unsigned int size)
+{
+	const struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+	unsigned int i, count;
+
+	switch (mode) {
+	case RTE_EVENT_DEV_XSTATS_DEVICE:
+		count = DSW_DEV_XSTATS_NUM;
+		break;
+	case RTE_EVENT_DEV_XSTATS_PORT:
+		if (queue_port_id >= dsw->num_ports)
+			return -EINVAL;
+		count = DSW_PORT_XSTATS_NUM;
+		break;
+	case RTE_EVENT_DEV_XSTATS_QUEUE:
+		return 0;
+	default:
+		DSW_LOG_ERR("Invalid mode received in dsw_xstats_get_names()");
+		return -EINVAL;
+	}
+
+	if (count > size || ids == NULL || xstats_names == NULL)
+		return count;
+
+	for (i = 0; i < count; i++) {
+		if (mode == RTE_EVENT_DEV_XSTATS_DEVICE) {
+			snprintf(xstats_names[i].name,
+					sizeof(xstats_names[i].name), "%s",
+					dsw_dev_xstats[i].name);
+			ids[i] = i;
+		} else {
+			snprintf(xstats_names[i].name,
+					sizeof(xstats_names[i].name),
+					"port_%u_%s", queue_port_id,
+					dsw_port_xstats[i].name);
+			ids[i] = dsw_xstats_port_id(queue_port_id, i);
+		}
+	}
+
+	return count;
+}
+
+static int
+dsw_xstats_get_one(const struct dsw_evdev *dsw, unsigned int id,
+		uint64_t *value)
+{
+	uint8_t port_id;
+
+	if (id < DSW_DEV_XSTATS_NUM) {
+		*value = dsw_dev_xstats[id].fn(dsw);
+		return 0;
+	}
+
+	id -= DSW_DEV_XSTATS_NUM;
+	port_id = id / DSW_PORT_XSTATS_NUM;
+	if (port_id >= dsw->num_ports)
+		return -EINVAL;
+	*value = dsw_port_xstats[id % DSW_PORT_XSTATS_NUM].fn(
+			&dsw->ports[port_id]);
+	return 0;
+}
+
+int
+dsw_xstats_get(const struct rte_eventdev *dev,
+		enum rte_event_dev_xstats_mode mode, uint8_t queue_port_id,
+		const unsigned int ids[], uint64_t values[], unsigned int n)
+{
+	const struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+	unsigned int i;
+
+	RTE_SET_USED(mode);
+	RTE_SET_USED(queue_port_id);
+
+	for (i = 0; i < n; i++)
+		if (dsw_xstats_get_one(dsw, ids[i], &values[i]) < 0)
+			break;
+
+	return i;
+}
+
+uint64_t
+dsw_xstats_get_by_name(const struct rte_eventdev *dev,
+		const char *name, unsigned int *id)
+{
+	const struct dsw_evdev *dsw = dsw_pmd_priv(dev);
+	char port_name[RTE_EVENT_DEV_XSTATS_NAME_SIZE];
+	unsigned int i, port_id;
+
+	for (i = 0; i < DSW_DEV_XSTATS_NUM; i++) {
+		if (strcmp(name, dsw_dev_xstats[i].name) == 0) {
+			if (id != NULL)
+				*id = i;
+			return dsw_dev_xstats[i].fn(dsw);
+		}
+	}
+
+	if (sscanf(name, "port_%u_%63s", &port_id, port_name) == 2 &&
+			port_id < dsw->num_ports) {
+		for (i = 0; i < DSW_PORT_XSTATS_NUM; i++) {
+			if (strcmp(port_name, dsw_port_xstats[i].name) != 0)
+				continue;
+			if (id != NULL)
+				*id = dsw_xstats_port_id(port_id, i);
+			return dsw_port_xstats[i].fn(&dsw->ports[port_id]);
+		}
+	}
+
+	if (id != NULL)
+		*id = (uint32_t)-1;
+	return (uint64_t)-1;
+}
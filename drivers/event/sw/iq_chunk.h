@@ -0,0 +1,241 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2016-2017 Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * IQ storage of the SW eventdev implementation: each IQ is a linked list of
+ * fixed-size chunks, taken from and returned to a free list owned by the
+ * scheduler of the QID. These are designed for single-core use only.
+ */
+#ifndef _IQ_CHUNK_H_
+#define _IQ_CHUNK_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_branch_prediction.h>
+#include <rte_eventdev.h>
+
+#include "sw_evdev.h"
+
+#ifndef force_inline
+#define force_inline inline __attribute__((always_inline))
+#endif
+
+/*
+ * Number of chunks a scheduler needs so that its IQs never run out of
+ * space: an IQ holding n events spans at most n / SW_EVS_PER_Q_CHUNK + 2
+ * chunks, and the events of all the IQs are bounded by nb_events_limit.
+ */
+static inline uint32_t
+iq_chunks_needed(uint32_t nb_events_limit, uint32_t nb_qids)
+{
+	return nb_events_limit / SW_EVS_PER_Q_CHUNK + 1 +
+			nb_qids * SW_IQS_MAX * 2;
+}
+
+static force_inline struct sw_queue_chunk *
+iq_alloc_chunk(struct sw_scheduler *sched)
+{
+	struct sw_queue_chunk *chunk = sched->chunk_list_head;
+
+	sched->chunk_list_head = chunk->next;
+	chunk->next = NULL;
+	return chunk;
+}
+
+static force_inline void
+iq_free_chunk(struct sw_scheduler *sched, struct sw_queue_chunk *chunk)
+{
+	chunk->next = sched->chunk_list_head;
+	sched->chunk_list_head = chunk;
+}
+
+static inline void
+iq_init(struct sw_scheduler *sched, struct sw_iq *iq)
+{
+	iq->head = iq_alloc_chunk(sched);
+	iq->tail = iq->head;
+	iq->head_idx = 0;
+	iq->tail_idx = 0;
+	iq->count = 0;
+}
+
+/* return all the chunks of the IQ to the free list, dropping its events */
+static inline void
+iq_release(struct sw_scheduler *sched, struct sw_iq *iq)
+{
+	struct sw_queue_chunk *chunk = iq->head;
+
+	while (chunk != NULL) {
+		struct sw_queue_chunk *next = chunk->next;
+
+		iq_free_chunk(sched, chunk);
+		chunk = next;
+	}
+	memset(iq, 0, sizeof(*iq));
+}
+
+static force_inline uint32_t
+iq_count(const struct sw_iq *iq)
+{
+	return iq->count;
+}
+
+/*
+ * Check if an event cannot be enqueued to the IQ. With the free list sized
+ * by iq_chunks_needed() this only happens if the application forwards more
+ * events than it dequeued.
+ */
+static force_inline int
+iq_full(const struct sw_scheduler *sched, const struct sw_iq *iq)
+{
+	return unlikely(iq->tail_idx == SW_EVS_PER_Q_CHUNK - 1 &&
+			sched->chunk_list_head == NULL);
+}
+
+/* assumes !iq_full(), a new tail is linked as soon as the tail fills up */
+static force_inline void
+iq_enqueue(struct sw_scheduler *sched, struct sw_iq *iq,
+		const struct rte_event *qe)
+{
+	iq->tail->events[iq->tail_idx++] = *qe;
+	iq->count++;
+
+	if (unlikely(iq->tail_idx == SW_EVS_PER_Q_CHUNK)) {
+		struct sw_queue_chunk *chunk = iq_alloc_chunk(sched);
+
+		iq->tail->next = chunk;
+		iq->tail = chunk;
+		iq->tail_idx = 0;
+	}
+}
+
+static force_inline uint32_t
+iq_dequeue_burst(struct sw_scheduler *sched, struct sw_iq *iq,
+		struct rte_event *qes, uint32_t nb_qes)
+{
+	struct sw_queue_chunk *chunk = iq->head;
+	uint32_t idx = iq->head_idx;
+	uint32_t i;
+
+	if (nb_qes > iq->count)
+		nb_qes = iq->count;
+
+	for (i = 0; i < nb_qes; i++) {
+		qes[i] = chunk->events[idx++];
+		if (unlikely(idx == SW_EVS_PER_Q_CHUNK)) {
+			struct sw_queue_chunk *next = chunk->next;
+
+			iq_free_chunk(sched, chunk);
+			chunk = next;
+			idx = 0;
+		}
+	}
+
+	iq->head = chunk;
+	iq->head_idx = idx;
+	iq->count -= nb_qes;
+
+	return nb_qes;
+}
+
+/*
+ * Put back at the head events from a previous dequeue_burst. At most one
+ * chunk is needed, as nb_qes <= SW_EVS_PER_Q_CHUNK, and the dequeue freed
+ * it if the head had moved to the next chunk.
+ */
+static force_inline void
+iq_put_back(struct sw_scheduler *sched, struct sw_iq *iq,
+		const struct rte_event *qes, uint32_t nb_qes)
+{
+	uint32_t i;
+
+	if (nb_qes == 0)
+		return;
+
+	if (nb_qes > iq->head_idx) {
+		const uint32_t nb_head = iq->head_idx;
+		struct sw_queue_chunk *chunk = iq_alloc_chunk(sched);
+
+		/* the last events fill the current head from its start */
+		for (i = 0; i < nb_head; i++)
+			iq->head->events[i] = qes[nb_qes - nb_head + i];
+
+		chunk->next = iq->head;
+		iq->head = chunk;
+		iq->head_idx = SW_EVS_PER_Q_CHUNK;
+		nb_qes -= nb_head;
+		iq->count += nb_head;
+	}
+
+	iq->head_idx -= nb_qes;
+	for (i = 0; i < nb_qes; i++)
+		iq->head->events[iq->head_idx + i] = qes[i];
+	iq->count += nb_qes;
+}
+
+static force_inline const struct rte_event *
+iq_peek(const struct sw_iq *iq)
+{
+	return &iq->head->events[iq->head_idx];
+}
+
+static force_inline void
+iq_pop(struct sw_scheduler *sched, struct sw_iq *iq)
+{
+	iq->count--;
+	if (unlikely(++iq->head_idx == SW_EVS_PER_Q_CHUNK)) {
+		struct sw_queue_chunk *next = iq->head->next;
+
+		iq_free_chunk(sched, iq->head);
+		iq->head = next;
+		iq->head_idx = 0;
+	}
+}
+
+/* move the IQ and its events to the chunks of another scheduler */
+static inline void
+iq_move(struct sw_scheduler *from, struct sw_scheduler *to,
+		struct sw_iq *iq)
+{
+	struct sw_iq old = *iq;
+
+	iq_init(to, iq);
+	while (iq_count(&old) != 0) {
+		iq_enqueue(to, iq, iq_peek(&old));
+		iq_pop(from, &old);
+	}
+	iq_release(from, &old);
+}
+
+#endif /* _IQ_CHUNK_H_ */
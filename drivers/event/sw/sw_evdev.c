@@ -39,13 +39,14 @@
 #include <rte_errno.h>
 
 #include "sw_evdev.h"
-#include "iq_ring.h"
+#include "iq_chunk.h"
 #include "event_ring.h"
 
 #define EVENTDEV_NAME_SW_PMD event_sw
 #define NUMA_NODE_ARG "numa_node"
 #define SCHED_QUANTA_ARG "sched_quanta"
 #define CREDIT_QUANTA_ARG "credit_quanta"
+#define SCHED_CORES_ARG "sched_cores"
 
 static void
 sw_info_get(struct rte_eventdev *dev, struct rte_event_dev_info *info);
@@ -214,17 +215,23 @@ qid_init(struct sw_evdev *sw, unsigned int idx, int type,
 	unsigned int i;
 	int dev_id = sw->data->dev_id;
 	int socket_id = sw->data->socket_id;
-	char buf[IQ_RING_NAMESIZE];
+	char buf[RTE_RING_NAMESIZE];
 	struct sw_qid *qid = &sw->qids[idx];
+	struct sw_scheduler *sched = &sw->schedulers[sw->qid_scheduler[idx]];
 
+	if (sched->chunks == NULL) {
+		SW_LOG_DBG("device not configured\n");
+		return -EINVAL;
+	}
+
+	/* the IQs take their chunks from the scheduler owning the QID, it
+	 * is only reassigned at start once the links are known
+	 */
 	for (i = 0; i < SW_IQS_MAX; i++) {
-		snprintf(buf, sizeof(buf), "q_%u_iq_%d", idx, i);
-		qid->iq[i] = iq_ring_create(buf, socket_id);
-		if (!qid->iq[i]) {
-			SW_LOG_DBG("ring create failed");
-			goto cleanup;
-		}
+		iq_release(sched, &qid->iq[i]);
+		iq_init(sched, &qid->iq[i]);
 	}
+	qid->iq_pkt_mask = 0;
 
 	/* Initialize the FID structures to no pinning (-1), and zero packets */
 	const struct sw_fid_t fid = {.cq = -1, .pcount = 0};
@@ -303,10 +310,8 @@ qid_init(struct sw_evdev *sw, unsigned int idx, int type,
 	return 0;
 
 cleanup:
-	for (i = 0; i < SW_IQS_MAX; i++) {
-		if (qid->iq[i])
-			iq_ring_destroy(qid->iq[i]);
-	}
+	for (i = 0; i < SW_IQS_MAX; i++)
+		iq_release(sched, &qid->iq[i]);
 
 	if (qid->reorder_buffer) {
 		rte_free(qid->reorder_buffer);
@@ -360,10 +365,11 @@ sw_queue_release(struct rte_eventdev *dev, uint8_t id)
 {
 	struct sw_evdev *sw = sw_pmd_priv(dev);
 	struct sw_qid *qid = &sw->qids[id];
+	struct sw_scheduler *sched = &sw->schedulers[sw->qid_scheduler[id]];
 	uint32_t i;
 
 	for (i = 0; i < SW_IQS_MAX; i++)
-		iq_ring_destroy(qid->iq[i]);
+		iq_release(sched, &qid->iq[i]);
 
 	if (qid->type == RTE_SCHED_TYPE_ORDERED) {
 		rte_free(qid->reorder_buffer);
@@ -407,6 +413,7 @@ sw_dev_configure(const struct rte_eventdev *dev)
 	struct sw_evdev *sw = sw_pmd_priv(dev);
 	const struct rte_eventdev_data *data = dev->data;
 	const struct rte_event_dev_config *conf = &data->dev_conf;
+	uint32_t i, j;
 
 	sw->qid_count = conf->nb_event_queues;
 	sw->port_count = conf->nb_event_ports;
@@ -416,6 +423,43 @@ sw_dev_configure(const struct rte_eventdev *dev)
 	if (conf->event_dev_cfg & RTE_EVENT_DEV_CFG_PER_DEQUEUE_TIMEOUT)
 		return -ENOTSUP;
 
+	/* Size the IQ storage of each scheduler for all the QIDs, as the
+	 * QIDs linked to common ports all go to the same scheduler, so that
+	 * an IQ can hold up to nb_events_limit events.
+	 */
+	for (i = 0; i < sw->scheduler_count; i++) {
+		struct sw_scheduler *sched = &sw->schedulers[i];
+		const uint32_t nb_chunks = iq_chunks_needed(sw->nb_events_limit,
+				sw->qid_count);
+
+		rte_free(sched->chunks);
+		sched->chunk_list_head = NULL;
+		sched->chunks = rte_malloc_socket(NULL,
+				nb_chunks * sizeof(sched->chunks[0]),
+				RTE_CACHE_LINE_SIZE, data->socket_id);
+		if (sched->chunks == NULL) {
+			SW_LOG_ERR("Error allocating IQ chunks\n");
+			return -ENOMEM;
+		}
+		for (j = 0; j < nb_chunks; j++)
+			iq_free_chunk(sched, &sched->chunks[j]);
+	}
+
+	/* the IQs of the queues kept from a previous configuration used the
+	 * chunks just freed: reinitialize them empty
+	 */
+	for (i = 0; i < sw->qid_count; i++) {
+		struct sw_qid *qid = &sw->qids[i];
+
+		if (!qid->initialized)
+			continue;
+		memset(qid->iq, 0, sizeof(qid->iq));
+		for (j = 0; j < SW_IQS_MAX; j++)
+			iq_init(&sw->schedulers[sw->qid_scheduler[i]],
+					&qid->iq[j]);
+		qid->iq_pkt_mask = 0;
+	}
+
 	return 0;
 }
 
@@ -453,12 +497,23 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 	fprintf(f, "EventDev %s: ports %d, qids %d\n", "todo-fix-name",
 			sw->port_count, sw->qid_count);
 
-	fprintf(f, "\trx   %"PRIu64"\n\tdrop %"PRIu64"\n\ttx   %"PRIu64"\n",
-		sw->stats.rx_pkts, sw->stats.rx_dropped, sw->stats.tx_pkts);
-	fprintf(f, "\tsched calls: %"PRIu64"\n", sw->sched_called);
-	fprintf(f, "\tsched cq/qid call: %"PRIu64"\n", sw->sched_cq_qid_called);
-	fprintf(f, "\tsched no IQ enq: %"PRIu64"\n", sw->sched_no_iq_enqueues);
-	fprintf(f, "\tsched no CQ enq: %"PRIu64"\n", sw->sched_no_cq_enqueues);
+	for (i = 0; i < sw->scheduler_count; i++) {
+		const struct sw_scheduler *sched = &sw->schedulers[i];
+
+		if (sw->scheduler_count > 1)
+			fprintf(f, "  Scheduler %u: ports %u, qids %u\n", i,
+				sched->port_count, sched->qid_count);
+		fprintf(f, "\trx   %"PRIu64"\n\tdrop %"PRIu64"\n\ttx   %"PRIu64"\n",
+			sched->stats.rx_pkts, sched->stats.rx_dropped,
+			sched->stats.tx_pkts);
+		fprintf(f, "\tsched calls: %"PRIu64"\n", sched->sched_called);
+		fprintf(f, "\tsched cq/qid call: %"PRIu64"\n",
+			sched->sched_cq_qid_called);
+		fprintf(f, "\tsched no IQ enq: %"PRIu64"\n",
+			sched->sched_no_iq_enqueues);
+		fprintf(f, "\tsched no CQ enq: %"PRIu64"\n",
+			sched->sched_no_cq_enqueues);
+	}
 	uint32_t inflights = rte_atomic32_read(&sw->inflights);
 	uint32_t credits = sw->nb_events_limit - inflights;
 	fprintf(f, "\tinflight %d, credits: %d\n", inflights, credits);
@@ -476,6 +531,8 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 		}
 		fprintf(f, "  Port %d %s\n", i,
 			p->is_directed ? " (SingleCons)" : "");
+		if (sw->scheduler_count > 1)
+			fprintf(f, "\tScheduler %u\n", p->scheduler);
 		fprintf(f, "\trx   %"PRIu64"\tdrop %"PRIu64"\ttx   %"PRIu64
 			"\t%sinflight %d%s\n", sw->ports[i].stats.rx_pkts,
 			sw->ports[i].stats.rx_dropped,
@@ -569,17 +626,14 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 		uint32_t iq;
 		uint32_t iq_printed = 0;
 		for (iq = 0; iq < SW_IQS_MAX; iq++) {
-			if (!qid->iq[iq]) {
+			if (!qid->iq[iq].head) {
 				fprintf(f, "\tiq %d is not initialized.\n", iq);
 				iq_printed = 1;
 				continue;
 			}
-			uint32_t used = iq_ring_count(qid->iq[iq]);
-			uint32_t free = iq_ring_free_count(qid->iq[iq]);
-			const char *col = (free == 0) ? COL_RED : COL_RESET;
+			uint32_t used = iq_count(&qid->iq[iq]);
 			if (used > 0) {
-				fprintf(f, "\t%siq %d: Used %d\tFree %d"
-					COL_RESET"\n", col, iq, used, free);
+				fprintf(f, "\tiq %d: Used %d\n", iq, used);
 				iq_printed = 1;
 			}
 		}
@@ -588,11 +642,219 @@ sw_dump(struct rte_eventdev *dev, FILE *f)
 	}
 }
 
+/* Find the first QID of the group of a QID, compressing the path. */
+static uint32_t
+sw_qid_group(uint8_t *group, uint32_t qid)
+{
+	while (group[qid] != qid)
+		qid = group[qid] = group[group[qid]];
+	return qid;
+}
+
+/*
+ * Assign the QIDs to the schedulers. A port is fed by a single scheduler,
+ * so the QIDs linked to a common port form a group kept on one scheduler.
+ * The groups are assigned in turn, the largest first, to the scheduler
+ * owning the fewest QIDs.
+ */
+static void
+sw_qids_assign(struct sw_evdev *sw, uint8_t *qid_sched)
+{
+	uint8_t group[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	uint32_t group_size[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	uint8_t group_sched[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	uint32_t sched_qids[SW_SCHEDULERS_MAX] = {0};
+	int port_qid[SW_PORTS_MAX];
+	uint32_t i, j, nb_groups = 0;
+
+	for (i = 0; i < sw->qid_count; i++) {
+		group[i] = i;
+		group_size[i] = 0;
+	}
+	for (i = 0; i < sw->port_count; i++)
+		port_qid[i] = -1;
+
+	for (i = 0; i < sw->qid_count; i++) {
+		const struct sw_qid *qid = &sw->qids[i];
+
+		for (j = 0; j < qid->cq_num_mapped_cqs; j++) {
+			const uint32_t cq = qid->cq_map[j];
+			uint32_t first, other;
+
+			if (port_qid[cq] < 0) {
+				port_qid[cq] = i;
+				continue;
+			}
+			first = sw_qid_group(group, port_qid[cq]);
+			other = sw_qid_group(group, i);
+			if (first == other)
+				continue;
+			if (sw->scheduler_count > 1)
+				SW_LOG_NOTICE("port %u is linked to queues %d and %u, keeping them on the same scheduler",
+						cq, port_qid[cq], i);
+			group[other] = first;
+		}
+	}
+
+	for (i = 0; i < sw->qid_count; i++)
+		group_size[sw_qid_group(group, i)]++;
+
+	for (;;) {
+		uint32_t largest = 0, size = 0, sched_id = 0;
+
+		for (i = 0; i < sw->qid_count; i++)
+			if (group_size[i] > size) {
+				largest = i;
+				size = group_size[i];
+			}
+		if (size == 0)
+			break;
+		for (i = 1; i < sw->scheduler_count; i++)
+			if (sched_qids[i] < sched_qids[sched_id])
+				sched_id = i;
+		group_sched[largest] = sched_id;
+		sched_qids[sched_id] += size;
+		group_size[largest] = 0;
+		nb_groups++;
+	}
+
+	for (i = 0; i < sw->qid_count; i++)
+		qid_sched[i] = group_sched[sw_qid_group(group, i)];
+
+	if (nb_groups < sw->scheduler_count)
+		SW_LOG_NOTICE("%u of the %u schedulers own queues, the queues being linked to common ports",
+				nb_groups, sw->scheduler_count);
+}
+
+/* Push an event passed between schedulers into the IQ of its QID. */
+static void
+sw_xfer_drain_event(struct sw_evdev *sw, const struct rte_event *qe)
+{
+	struct sw_qid *qid = &sw->qids[qe->queue_id];
+	const uint32_t iq_num = PRIO_TO_IQ(qe->priority);
+
+	iq_enqueue(&sw->schedulers[sw->qid_scheduler[qe->queue_id]],
+			&qid->iq[iq_num], qe);
+	qid->iq_pkt_mask |= (1 << iq_num);
+	qid->iq_pkt_count[iq_num]++;
+	qid->stats.rx_pkts++;
+}
+
+/*
+ * Put the events left between the schedulers at the last stop into the
+ * IQs of their QIDs, before the QIDs move to other schedulers.
+ */
+static void
+sw_xfer_drain(struct sw_evdev *sw)
+{
+	uint32_t dst, src, i, n;
+
+	for (dst = 0; dst < sw->scheduler_count; dst++) {
+		struct sw_scheduler *sched = &sw->schedulers[dst];
+
+		for (src = 0; src < sw->scheduler_count; src++) {
+			struct sw_xfer_buf *in = &sched->xfer_in[src];
+			struct sw_xfer_buf *out =
+				&sw->schedulers[src].xfer_out[dst];
+
+			if (src == dst)
+				continue;
+			for (i = in->start; i < in->start + in->count; i++)
+				sw_xfer_drain_event(sw, &in->buf[i]);
+			in->start = 0;
+			in->count = 0;
+			while (sched->xfer_ring[src] != NULL &&
+					(n = qe_ring_dequeue_burst(
+						sched->xfer_ring[src], in->buf,
+						RTE_DIM(in->buf))) != 0)
+				for (i = 0; i < n; i++)
+					sw_xfer_drain_event(sw, &in->buf[i]);
+			for (i = 0; i < out->count; i++)
+				sw_xfer_drain_event(sw, &out->buf[i]);
+			out->count = 0;
+		}
+	}
+}
+
+/*
+ * Assign the QIDs to the schedulers, moving the events of the QIDs which
+ * change of scheduler, and each port to the scheduler of the QIDs it is
+ * linked to, and create the rings between the schedulers.
+ */
+static int
+sw_schedulers_init(struct sw_evdev *sw)
+{
+	uint8_t qid_sched[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	int port_sched[SW_PORTS_MAX];
+	char buf[QE_RING_NAMESIZE];
+	uint32_t i, j;
+
+	for (i = 0; i < sw->scheduler_count; i++) {
+		sw->schedulers[i].qid_count = 0;
+		sw->schedulers[i].ordered_qid_count = 0;
+		memset(sw->schedulers[i].qid_active, 0,
+				sizeof(sw->schedulers[i].qid_active));
+		sw->schedulers[i].port_count = 0;
+	}
+	for (i = 0; i < sw->port_count; i++)
+		port_sched[i] = -1;
+
+	sw_qids_assign(sw, qid_sched);
+	if (sw->scheduler_count > 1)
+		sw_xfer_drain(sw);
+	for (i = 0; i < sw->qid_count; i++) {
+		struct sw_qid *qid = &sw->qids[i];
+		const uint8_t sched_id = qid_sched[i];
+
+		if (sched_id != sw->qid_scheduler[i]) {
+			for (j = 0; j < SW_IQS_MAX; j++)
+				iq_move(&sw->schedulers[sw->qid_scheduler[i]],
+						&sw->schedulers[sched_id],
+						&qid->iq[j]);
+			sw->qid_scheduler[i] = sched_id;
+		}
+		for (j = 0; j < qid->cq_num_mapped_cqs; j++)
+			port_sched[qid->cq_map[j]] = sched_id;
+	}
+
+	for (i = 0; i < sw->port_count; i++) {
+		struct sw_scheduler *sched;
+
+		/* ports only enqueuing are spread over the schedulers */
+		if (port_sched[i] == -1)
+			port_sched[i] = i % sw->scheduler_count;
+		sched = &sw->schedulers[port_sched[i]];
+		sched->port_ids[sched->port_count++] = i;
+		sw->ports[i].scheduler = port_sched[i];
+	}
+
+	for (i = 0; i < sw->scheduler_count; i++) {
+		for (j = 0; j < sw->scheduler_count; j++) {
+			struct sw_scheduler *sched = &sw->schedulers[i];
+
+			if (j == i || sched->xfer_ring[j] != NULL)
+				continue;
+			snprintf(buf, sizeof(buf), "sw%d_xfer_%u_%u",
+					sw->data->dev_id, j, i);
+			sched->xfer_ring[j] = qe_ring_create(buf,
+					SW_XFER_RING_SIZE, sw->data->socket_id);
+			if (sched->xfer_ring[j] == NULL) {
+				SW_LOG_ERR("Error creating scheduler ring %s\n",
+						buf);
+				return -ENOMEM;
+			}
+		}
+	}
+
+	return 0;
+}
+
 static int
 sw_start(struct rte_eventdev *dev)
 {
 	unsigned int i, j;
 	struct sw_evdev *sw = sw_pmd_priv(dev);
+	int ret;
 	/* check all ports are set up */
 	for (i = 0; i < sw->port_count; i++)
 		if (sw->ports[i].rx_worker_ring == NULL) {
@@ -602,25 +864,41 @@ sw_start(struct rte_eventdev *dev)
 
 	/* check all queues are configured and mapped to ports*/
 	for (i = 0; i < sw->qid_count; i++)
-		if (sw->qids[i].iq[0] == NULL ||
+		if (!sw->qids[i].initialized ||
 				sw->qids[i].cq_num_mapped_cqs == 0) {
 			SW_LOG_ERR("Queue %d not configured\n", i);
 			return -ENOLINK;
 		}
 
+	ret = sw_schedulers_init(sw);
+	if (ret < 0)
+		return ret;
+
 	/* build up our prioritized array of qids */
 	/* We don't use qsort here, as if all/multiple entries have the same
 	 * priority, the result is non-deterministic. From "man 3 qsort":
 	 * "If two members compare as equal, their order in the sorted
 	 * array is undefined."
 	 */
-	uint32_t qidx = 0;
 	for (j = 0; j <= RTE_EVENT_DEV_PRIORITY_LOWEST; j++) {
 		for (i = 0; i < sw->qid_count; i++) {
-			if (sw->qids[i].priority == j) {
-				sw->qids_prioritized[qidx] = &sw->qids[i];
-				qidx++;
-			}
+			struct sw_qid *qid = &sw->qids[i];
+			struct sw_scheduler *sched;
+			uint32_t idx;
+
+			if (qid->priority != j)
+				continue;
+			sched = &sw->schedulers[sw->qid_scheduler[i]];
+			idx = sched->qid_count++;
+			sched->qids_prioritized[idx] = qid;
+			qid->prio_idx = idx;
+			/* events may be left in the IQs since the last stop */
+			if (qid->iq_pkt_mask)
+				sched->qid_active[idx / 64] |=
+					1ULL << (idx % 64);
+			if (qid->type == RTE_SCHED_TYPE_ORDERED)
+				sched->ordered_qids[
+					sched->ordered_qid_count++] = qid;
 		}
 	}
 
@@ -630,6 +908,10 @@ sw_start(struct rte_eventdev *dev)
 	rte_smp_wmb();
 	sw->started = 1;
 
+	for (i = 0; i < sw->scheduler_count; i++)
+		rte_service_component_runstate_set(
+				sw->schedulers[i].service_id, 1);
+
 	return 0;
 }
 
@@ -637,6 +919,18 @@ static void
 sw_stop(struct rte_eventdev *dev)
 {
 	struct sw_evdev *sw = sw_pmd_priv(dev);
+
+	uint32_t i;
+
+	/* let the service cores leave the schedulers before tearing down */
+	for (i = 0; i < sw->scheduler_count; i++)
+		rte_service_component_runstate_set(
+				sw->schedulers[i].service_id, 0);
+	for (i = 0; i < sw->scheduler_count; i++)
+		while (rte_service_may_be_active(
+				sw->schedulers[i].service_id) == 1)
+			rte_pause();
+
 	sw_xstats_uninit(sw);
 	sw->started = 0;
 	rte_smp_wmb();
@@ -646,7 +940,7 @@ static int
 sw_close(struct rte_eventdev *dev)
 {
 	struct sw_evdev *sw = sw_pmd_priv(dev);
-	uint32_t i;
+	uint32_t i, j;
 
 	for (i = 0; i < sw->qid_count; i++)
 		sw_queue_release(dev, i);
@@ -656,11 +950,24 @@ sw_close(struct rte_eventdev *dev)
 		sw_port_release(&sw->ports[i]);
 	sw->port_count = 0;
 
-	memset(&sw->stats, 0, sizeof(sw->stats));
-	sw->sched_called = 0;
-	sw->sched_no_iq_enqueues = 0;
-	sw->sched_no_cq_enqueues = 0;
-	sw->sched_cq_qid_called = 0;
+	for (i = 0; i < sw->scheduler_count; i++) {
+		struct sw_scheduler *sched = &sw->schedulers[i];
+
+		for (j = 0; j < sw->scheduler_count; j++) {
+			qe_ring_destroy(sched->xfer_ring[j]);
+			sched->xfer_ring[j] = NULL;
+			sched->xfer_in[j].count = 0;
+			sched->xfer_out[j].count = 0;
+		}
+		rte_free(sched->chunks);
+		sched->chunks = NULL;
+		sched->chunk_list_head = NULL;
+		memset(&sched->stats, 0, sizeof(sched->stats));
+		sched->sched_called = 0;
+		sched->sched_no_iq_enqueues = 0;
+		sched->sched_no_cq_enqueues = 0;
+		sched->sched_cq_qid_called = 0;
+	}
 
 	return 0;
 }
@@ -695,6 +1002,25 @@ set_credit_quanta(const char *key __rte_unused, const char *value, void *opaque)
 	return 0;
 }
 
+static int
+set_sched_cores(const char *key __rte_unused, const char *value, void *opaque)
+{
+	int *sched_cores = opaque;
+	*sched_cores = atoi(value);
+	if (*sched_cores < 1 || *sched_cores > SW_SCHEDULERS_MAX)
+		return -1;
+	return 0;
+}
+
+static int32_t
+sw_sched_service_func(void *args)
+{
+	struct sw_scheduler *sched = args;
+
+	sw_scheduler_run(sched->sw, sched);
+	return 0;
+}
+
 static int
 sw_probe(struct rte_vdev_device *vdev)
 {
@@ -725,6 +1051,7 @@ sw_probe(struct rte_vdev_device *vdev)
 		NUMA_NODE_ARG,
 		SCHED_QUANTA_ARG,
 		CREDIT_QUANTA_ARG,
+		SCHED_CORES_ARG,
 		NULL
 	};
 	const char *name;
@@ -734,6 +1061,8 @@ sw_probe(struct rte_vdev_device *vdev)
 	int socket_id = rte_socket_id();
 	int sched_quanta  = SW_DEFAULT_SCHED_QUANTA;
 	int credit_quanta = SW_DEFAULT_CREDIT_QUANTA;
+	int sched_cores = 1;
+	uint32_t i;
 
 	name = rte_vdev_device_name(vdev);
 	params = rte_vdev_device_args(vdev);
@@ -775,13 +1104,24 @@ sw_probe(struct rte_vdev_device *vdev)
 				return ret;
 			}
 
+			ret = rte_kvargs_process(kvlist, SCHED_CORES_ARG,
+					set_sched_cores, &sched_cores);
+			if (ret != 0) {
+				SW_LOG_ERR(
+					"%s: Error parsing sched cores parameter",
+					name);
+				rte_kvargs_free(kvlist);
+				return ret;
+			}
+
 			rte_kvargs_free(kvlist);
 		}
 	}
 
 	SW_LOG_INFO(
-			"Creating eventdev sw device %s, numa_node=%d, sched_quanta=%d, credit_quanta=%d\n",
-			name, socket_id, sched_quanta, credit_quanta);
+			"Creating eventdev sw device %s, numa_node=%d, sched_quanta=%d, credit_quanta=%d, sched_cores=%d\n",
+			name, socket_id, sched_quanta, credit_quanta,
+			sched_cores);
 
 	dev = rte_event_pmd_vdev_init(name,
 			sizeof(struct sw_evdev), socket_id);
@@ -805,6 +1145,42 @@ sw_probe(struct rte_vdev_device *vdev)
 	/* copy values passed from vdev command line to instance */
 	sw->credit_update_quanta = credit_quanta;
 	sw->sched_quanta = sched_quanta;
+	sw->scheduler_count = sched_cores;
+
+	/* register the schedulers as services, so that the application
+	 * can run them on service cores instead of calling
+	 * rte_event_schedule(). With several schedulers, the services are
+	 * named <name>_service_<scheduler id>.
+	 */
+	for (i = 0; i < sw->scheduler_count; i++) {
+		struct sw_scheduler *sched = &sw->schedulers[i];
+		struct rte_service_spec service;
+		int32_t ret;
+
+		sched->sw = sw;
+		sched->id = i;
+		memset(&service, 0, sizeof(service));
+		if (sw->scheduler_count == 1)
+			snprintf(service.name, sizeof(service.name),
+					"%s_service", name);
+		else
+			snprintf(service.name, sizeof(service.name),
+					"%s_service_%u", name, i);
+		service.socket_id = socket_id;
+		service.callback = sw_sched_service_func;
+		service.callback_userdata = sched;
+
+		ret = rte_service_component_register(&service,
+				&sched->service_id);
+		if (ret) {
+			SW_LOG_ERR("service register() failed");
+			while (i-- > 0)
+				rte_service_component_unregister(
+					sw->schedulers[i].service_id);
+			rte_event_pmd_vdev_uninit(name);
+			return -ENOEXEC;
+		}
+	}
 
 	return 0;
 }
@@ -820,6 +1196,19 @@ sw_remove(struct rte_vdev_device *vdev)
 
 	SW_LOG_INFO("Closing eventdev sw device %s\n", name);
 
+	if (rte_eal_process_type() == RTE_PROC_PRIMARY) {
+		struct rte_eventdev *dev = rte_event_pmd_get_named_dev(name);
+
+		if (dev != NULL) {
+			struct sw_evdev *sw = sw_pmd_priv(dev);
+			uint32_t i;
+
+			for (i = 0; i < sw->scheduler_count; i++)
+				rte_service_component_unregister(
+					sw->schedulers[i].service_id);
+		}
+	}
+
 	return rte_event_pmd_vdev_uninit(name);
 }
 
@@ -830,4 +1219,5 @@ static struct rte_vdev_driver evdev_sw_pmd_drv = {
 
 RTE_PMD_REGISTER_VDEV(EVENTDEV_NAME_SW_PMD, evdev_sw_pmd_drv);
 RTE_PMD_REGISTER_PARAM_STRING(event_sw, NUMA_NODE_ARG "=<int> "
-		SCHED_QUANTA_ARG "=<int>" CREDIT_QUANTA_ARG "=<int>");
+		SCHED_QUANTA_ARG "=<int>" CREDIT_QUANTA_ARG "=<int>"
+		SCHED_CORES_ARG "=<int>");
@@ -36,11 +36,16 @@
 #include <rte_eventdev.h>
 #include <rte_eventdev_pmd.h>
 #include <rte_atomic.h>
+#include <rte_service_component.h>
 
 #define SW_DEFAULT_CREDIT_QUANTA 32
 #define SW_DEFAULT_SCHED_QUANTA 128
 #define SW_QID_NUM_FIDS 16384
 #define SW_IQS_MAX 4
+#if SW_IQS_MAX != 4
+#error Misconfigured PRIO_TO_IQ caused by SW_IQS_MAX value change
+#endif
+#define PRIO_TO_IQ(prio) (prio >> 6)
 #define SW_Q_PRIORITY_MAX 255
 #define SW_PORTS_MAX 64
 #define MAX_SW_CONS_Q_DEPTH 128
@@ -48,6 +53,14 @@
 /* allow for lots of over-provisioning */
 #define MAX_SW_PROD_Q_DEPTH 4096
 #define SW_FRAGMENTS_MAX 16
+/* max number of schedulers sharing the queues of an instance */
+#define SW_SCHEDULERS_MAX 8
+/* size of the rings passing events between two schedulers */
+#define SW_XFER_RING_SIZE 1024
+/* events per chunk of IQ storage, a chunk fills 4 KB with its link */
+#define SW_EVS_PER_Q_CHUNK 255
+/* words of the bitmap of QIDs with events in their IQs */
+#define SW_QID_BMP_WORDS ((RTE_EVENT_MAX_QUEUES_PER_DEV + 63) / 64)
 
 /* report dequeue burst sizes in buckets */
 #define SW_DEQ_STAT_BUCKET_SHIFT 2
@@ -107,6 +120,9 @@ static const uint8_t sw_qe_flag_map[] = {
 			SW_PMD_NAME, \
 			__func__, __LINE__, ## args)
 
+#define SW_LOG_NOTICE(fmt, args...) \
+	RTE_LOG(NOTICE, EVENTDEV, "[%s] " fmt "\n", SW_PMD_NAME, ## args)
+
 /* Records basic event stats at a given point. Used in port and qid structs */
 struct sw_point_stats {
 	uint64_t rx_pkts;
@@ -129,6 +145,21 @@ struct reorder_buffer_entry {
 	struct rte_event fragments[SW_FRAGMENTS_MAX];
 };
 
+/* a chunk of IQ storage, chained to the next one of the IQ or free list */
+struct sw_queue_chunk {
+	struct rte_event events[SW_EVS_PER_Q_CHUNK];
+	struct sw_queue_chunk *next;
+} __rte_cache_aligned;
+
+/* an IQ: a linked list of chunks, dequeued at head and enqueued at tail */
+struct sw_iq {
+	struct sw_queue_chunk *head;
+	struct sw_queue_chunk *tail;
+	uint16_t head_idx;
+	uint16_t tail_idx;
+	uint32_t count;
+};
+
 struct sw_qid {
 	/* set when the QID has been initialized */
 	uint8_t initialized;
@@ -140,9 +171,11 @@ struct sw_qid {
 	uint32_t id;
 	struct sw_point_stats stats;
 
-	/* Internal priority rings for packets */
-	struct iq_ring *iq[SW_IQS_MAX];
+	/* Internal priority queues for packets */
+	struct sw_iq iq[SW_IQS_MAX];
 	uint32_t iq_pkt_mask; /* A mask to indicate packets in an IQ */
+	/* position in qids_prioritized, and bit in qid_active, of the QID */
+	uint32_t prio_idx;
 	uint64_t iq_pkt_count[SW_IQS_MAX];
 
 	/* Information on what CQs are polling this IQ */
@@ -225,8 +258,64 @@ struct sw_port {
 	struct rte_event cq_buf[MAX_SW_CONS_Q_DEPTH];
 
 	uint8_t num_qids_mapped;
+
+	/* scheduler pulling this port and feeding its CQ */
+	uint8_t scheduler;
 };
 
+/* events passed from one scheduler to another */
+struct sw_xfer_buf {
+	uint16_t start;
+	uint16_t count;
+	struct rte_event buf[SCHED_DEQUEUE_BURST_SIZE];
+};
+
+/*
+ * A scheduler owns a subset of the QIDs and the ports linked to them: it
+ * pulls the events enqueued to its ports, and schedules the events of its
+ * QIDs to its CQs. An event enqueued to a QID of another scheduler is
+ * passed to it through a ring.
+ */
+struct sw_scheduler {
+	struct sw_evdev *sw;
+	uint8_t id;
+
+	/* owned load-balanced and directed QIDs sorted by priority level */
+	uint32_t qid_count;
+	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	/* bitmap of the qids_prioritized with events in an IQ */
+	uint64_t qid_active[SW_QID_BMP_WORDS];
+	/* owned ordered QIDs, the only ones to scan for reordering */
+	uint32_t ordered_qid_count;
+	struct sw_qid *ordered_qids[RTE_EVENT_MAX_QUEUES_PER_DEV];
+
+	/* free chunks for the IQs of the owned QIDs */
+	struct sw_queue_chunk *chunk_list_head;
+	struct sw_queue_chunk *chunks;
+
+	/* owned ports */
+	uint32_t port_count;
+	uint8_t port_ids[SW_PORTS_MAX];
+
+	/* rings from the other schedulers, and the events dequeued from
+	 * them not yet in an IQ
+	 */
+	struct qe_ring *xfer_ring[SW_SCHEDULERS_MAX];
+	struct sw_xfer_buf xfer_in[SW_SCHEDULERS_MAX];
+	/* events for the other schedulers, not yet in their ring */
+	struct sw_xfer_buf xfer_out[SW_SCHEDULERS_MAX];
+
+	/* Stats */
+	struct sw_point_stats stats __rte_cache_aligned;
+	uint64_t sched_called;
+	uint64_t sched_no_iq_enqueues;
+	uint64_t sched_no_cq_enqueues;
+	uint64_t sched_cq_qid_called;
+
+	/* service running this scheduler, see rte_service.h */
+	uint32_t service_id;
+} __rte_cache_aligned;
+
 struct sw_evdev {
 	struct rte_eventdev_data *data;
 
@@ -255,20 +344,16 @@ struct sw_evdev {
 	/* Cache how many packets are in each cq */
 	uint16_t cq_ring_space[SW_PORTS_MAX] __rte_cache_aligned;
 
-	/* Array of pointers to load-balanced QIDs sorted by priority level */
-	struct sw_qid *qids_prioritized[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	/* scheduler owning each QID */
+	uint8_t qid_scheduler[RTE_EVENT_MAX_QUEUES_PER_DEV];
 
-	/* Stats */
-	struct sw_point_stats stats __rte_cache_aligned;
-	uint64_t sched_called;
 	int32_t sched_quanta;
-	uint64_t sched_no_iq_enqueues;
-	uint64_t sched_no_cq_enqueues;
-	uint64_t sched_cq_qid_called;
-
 	uint8_t started;
 	uint32_t credit_update_quanta;
 
+	uint32_t scheduler_count;
+	struct sw_scheduler schedulers[SW_SCHEDULERS_MAX];
+
 	/* store num stats and offset of the stats for each port */
 	uint16_t xstats_count_per_port[SW_PORTS_MAX];
 	uint16_t xstats_offset_for_port[SW_PORTS_MAX];
@@ -297,6 +382,7 @@ uint16_t sw_event_dequeue(void *port, struct rte_event *ev, uint64_t wait);
 uint16_t sw_event_dequeue_burst(void *port, struct rte_event *ev, uint16_t num,
 			uint64_t wait);
 void sw_event_schedule(struct rte_eventdev *dev);
+void sw_scheduler_run(struct sw_evdev *sw, struct sw_scheduler *sched);
 int sw_xstats_init(struct sw_evdev *dev);
 int sw_xstats_uninit(struct sw_evdev *dev);
 int sw_xstats_get_names(const struct rte_eventdev *dev,
@@ -30,10 +30,12 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <string.h>
+
 #include <rte_ring.h>
 #include <rte_hash_crc.h>
 #include "sw_evdev.h"
-#include "iq_ring.h"
+#include "iq_chunk.h"
 #include "event_ring.h"
 
 #define SW_IQS_MASK (SW_IQS_MAX-1)
@@ -44,19 +46,102 @@
 #define PKT_MASK_TO_IQ(pkts) \
 	(__builtin_ctz(pkts | (1 << SW_IQS_MAX)))
 
-#if SW_IQS_MAX != 4
-#error Misconfigured PRIO_TO_IQ caused by SW_IQS_MAX value change
-#endif
-#define PRIO_TO_IQ(prio) (prio >> 6)
-
 #define MAX_PER_IQ_DEQUEUE 48
 #define FLOWID_MASK (SW_QID_NUM_FIDS-1)
 /* use cheap bit mixing, we only need to lose a few bits */
 #define SW_HASH_FLOWID(f) (((f) ^ (f >> 10)) & FLOWID_MASK)
 
+static inline void
+sw_xfer_flush(struct sw_evdev *sw, struct sw_scheduler *sched, uint32_t dst)
+{
+	struct sw_xfer_buf *out = &sched->xfer_out[dst];
+	struct qe_ring *ring = sw->schedulers[dst].xfer_ring[sched->id];
+	uint16_t free_count;
+	uint32_t n;
+
+	if (out->count == 0)
+		return;
+	n = qe_ring_enqueue_burst(ring, out->buf, out->count, &free_count);
+	if (n != out->count)
+		memmove(out->buf, &out->buf[n],
+			(out->count - n) * sizeof(out->buf[0]));
+	out->count -= n;
+}
+
+/* Check if an event can be passed to the scheduler dst. */
+static inline int
+sw_xfer_full(struct sw_evdev *sw, struct sw_scheduler *sched, uint32_t dst)
+{
+	struct sw_xfer_buf *out = &sched->xfer_out[dst];
+
+	if (out->count < RTE_DIM(out->buf))
+		return 0;
+	sw_xfer_flush(sw, sched, dst);
+	return out->count == RTE_DIM(out->buf);
+}
+
+static inline void
+sw_xfer_enqueue(struct sw_scheduler *sched, uint32_t dst,
+		const struct rte_event *qe)
+{
+	struct sw_xfer_buf *out = &sched->xfer_out[dst];
+
+	out->buf[out->count++] = *qe;
+}
+
+/* Push an event into an IQ of a QID owned by the scheduler. */
+static inline void
+sw_qid_enqueue(struct sw_scheduler *sched, struct sw_qid *qid,
+		uint32_t iq_num, const struct rte_event *qe)
+{
+	iq_enqueue(sched, &qid->iq[iq_num], qe);
+	qid->iq_pkt_mask |= (1 << (iq_num));
+	qid->iq_pkt_count[iq_num]++;
+	qid->stats.rx_pkts++;
+	sched->qid_active[qid->prio_idx / 64] |= 1ULL << (qid->prio_idx % 64);
+}
+
+/* Move the events passed by the other schedulers into the IQs. */
+static uint32_t
+sw_schedule_pull_xfer(struct sw_evdev *sw, struct sw_scheduler *sched)
+{
+	uint32_t pkts_iter = 0;
+	uint32_t src;
+
+	for (src = 0; src < sw->scheduler_count; src++) {
+		struct sw_xfer_buf *in = &sched->xfer_in[src];
+
+		if (src == sched->id)
+			continue;
+		if (in->count == 0) {
+			in->start = 0;
+			in->count = qe_ring_dequeue_burst(
+					sched->xfer_ring[src], in->buf,
+					RTE_DIM(in->buf));
+		}
+
+		while (in->count) {
+			const struct rte_event *qe = &in->buf[in->start];
+			uint32_t iq_num = PRIO_TO_IQ(qe->priority);
+			struct sw_qid *qid = &sw->qids[qe->queue_id];
+
+			if (iq_full(sched, &qid->iq[iq_num]))
+				break;
+
+			sw_qid_enqueue(sched, qid, iq_num, qe);
+			pkts_iter++;
+
+			in->start++;
+			in->count--;
+		}
+	}
+
+	return pkts_iter;
+}
+
 static inline uint32_t
-sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
-		uint32_t iq_num, unsigned int count)
+sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_scheduler *sched,
+		struct sw_qid * const qid, uint32_t iq_num, unsigned int count)
 {
 	struct rte_event qes[MAX_PER_IQ_DEQUEUE]; /* count <= MAX */
 	struct rte_event blocked_qes[MAX_PER_IQ_DEQUEUE];
@@ -71,7 +156,7 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 	 */
 	uint32_t qid_id = qid->id;
 
-	iq_ring_dequeue_burst(qid->iq[iq_num], qes, count);
+	iq_dequeue_burst(sched, &qid->iq[iq_num], qes, count);
 	for (i = 0; i < count; i++) {
 		const struct rte_event *qe = &qes[i];
 		const uint16_t flow_id = SW_HASH_FLOWID(qes[i].flow_id);
@@ -129,14 +214,15 @@ sw_schedule_atomic_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 			p->cq_buf_count = 0;
 		}
 	}
-	iq_ring_put_back(qid->iq[iq_num], blocked_qes, nb_blocked);
+	iq_put_back(sched, &qid->iq[iq_num], blocked_qes, nb_blocked);
 
 	return count - nb_blocked;
 }
 
 static inline uint32_t
-sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
-		uint32_t iq_num, unsigned int count, int keep_order)
+sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_scheduler *sched,
+		struct sw_qid * const qid, uint32_t iq_num, unsigned int count,
+		int keep_order)
 {
 	uint32_t i;
 	uint32_t cq_idx = qid->cq_next_tx;
@@ -155,7 +241,7 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 				rte_ring_count(qid->reorder_buffer_freelist));
 
 	for (i = 0; i < count; i++) {
-		const struct rte_event *qe = iq_ring_peek(qid->iq[iq_num]);
+		const struct rte_event *qe = iq_peek(&qid->iq[iq_num]);
 		uint32_t cq_check_count = 0;
 		uint32_t cq;
 
@@ -191,7 +277,7 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 					(void *)&p->hist_list[head].rob_entry);
 
 		sw->ports[cq].cq_buf[sw->ports[cq].cq_buf_count++] = *qe;
-		iq_ring_pop(qid->iq[iq_num]);
+		iq_pop(sched, &qid->iq[iq_num]);
 
 		rte_compiler_barrier();
 		p->inflights++;
@@ -204,8 +290,9 @@ sw_schedule_parallel_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 }
 
 static uint32_t
-sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
-		uint32_t iq_num, unsigned int count __rte_unused)
+sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_scheduler *sched,
+		struct sw_qid * const qid, uint32_t iq_num,
+		unsigned int count __rte_unused)
 {
 	uint32_t cq_id = qid->cq_map[0];
 	struct sw_port *port = &sw->ports[cq_id];
@@ -215,9 +302,8 @@ sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 	if (count_free == 0)
 		return 0;
 
-	/* burst dequeue from the QID IQ ring */
-	struct iq_ring *ring = qid->iq[iq_num];
-	uint32_t ret = iq_ring_dequeue_burst(ring,
+	/* burst dequeue from the QID IQ */
+	uint32_t ret = iq_dequeue_burst(sched, &qid->iq[iq_num],
 			&port->cq_buf[port->cq_buf_count], count_free);
 	port->cq_buf_count += ret;
 
@@ -231,70 +317,86 @@ sw_schedule_dir_to_cq(struct sw_evdev *sw, struct sw_qid * const qid,
 	return ret;
 }
 
+static inline uint32_t
+sw_schedule_iq_to_cq(struct sw_evdev *sw, struct sw_scheduler *sched,
+		struct sw_qid * const qid, uint32_t iq_num, unsigned int count)
+{
+	int type = qid->type;
+
+	if (type == SW_SCHED_TYPE_DIRECT)
+		return sw_schedule_dir_to_cq(sw, sched, qid, iq_num, count);
+	else if (type == RTE_SCHED_TYPE_ATOMIC)
+		return sw_schedule_atomic_to_cq(sw, sched, qid, iq_num, count);
+	else
+		return sw_schedule_parallel_to_cq(sw, sched, qid, iq_num, count,
+				type == RTE_SCHED_TYPE_ORDERED);
+}
+
 static uint32_t
-sw_schedule_qid_to_cq(struct sw_evdev *sw)
+sw_schedule_qid_to_cq(struct sw_evdev *sw, struct sw_scheduler *sched)
 {
 	uint32_t pkts = 0;
-	uint32_t qid_idx;
+	uint32_t w;
 
-	sw->sched_cq_qid_called++;
+	sched->sched_cq_qid_called++;
 
-	for (qid_idx = 0; qid_idx < sw->qid_count; qid_idx++) {
-		struct sw_qid *qid = sw->qids_prioritized[qid_idx];
+	/* only visit the QIDs with events, in priority order */
+	for (w = 0; w < SW_QID_BMP_WORDS; w++) {
+		uint64_t active = sched->qid_active[w];
 
-		int type = qid->type;
-		int iq_num = PKT_MASK_TO_IQ(qid->iq_pkt_mask);
+		while (active) {
+			const uint32_t bit = __builtin_ctzll(active);
+			struct sw_qid *qid =
+				sched->qids_prioritized[w * 64 + bit];
 
-		/* zero mapped CQs indicates directed */
-		if (iq_num >= SW_IQS_MAX)
-			continue;
+			active &= active - 1;
 
-		uint32_t pkts_done = 0;
-		uint32_t count = iq_ring_count(qid->iq[iq_num]);
-
-		if (count > 0) {
-			if (type == SW_SCHED_TYPE_DIRECT)
-				pkts_done += sw_schedule_dir_to_cq(sw, qid,
-						iq_num, count);
-			else if (type == RTE_SCHED_TYPE_ATOMIC)
-				pkts_done += sw_schedule_atomic_to_cq(sw, qid,
-						iq_num, count);
-			else
-				pkts_done += sw_schedule_parallel_to_cq(sw, qid,
-						iq_num, count,
-						type == RTE_SCHED_TYPE_ORDERED);
-		}
+			int iq_num = PKT_MASK_TO_IQ(qid->iq_pkt_mask);
 
-		/* Check if the IQ that was polled is now empty, and unset it
-		 * in the IQ mask if its empty.
-		 */
-		int all_done = (pkts_done == count);
+			if (iq_num >= SW_IQS_MAX) {
+				sched->qid_active[w] &= ~(1ULL << bit);
+				continue;
+			}
 
-		qid->iq_pkt_mask &= ~(all_done << (iq_num));
-		pkts += pkts_done;
+			uint32_t pkts_done = 0;
+			uint32_t count = iq_count(&qid->iq[iq_num]);
+
+			if (count > 0)
+				pkts_done = sw_schedule_iq_to_cq(sw, sched,
+						qid, iq_num, count);
+
+			/* Check if the IQ that was polled is now empty, and
+			 * unset it in the IQ mask if its empty, and the QID
+			 * in the active bitmap once all its IQs are.
+			 */
+			int all_done = (pkts_done == count);
+
+			qid->iq_pkt_mask &= ~(all_done << (iq_num));
+			if (qid->iq_pkt_mask == 0)
+				sched->qid_active[w] &= ~(1ULL << bit);
+			pkts += pkts_done;
+		}
 	}
 
 	return pkts;
 }
 
 /* This function will perform re-ordering of packets, and injecting into
- * the appropriate QID IQ. As LB and DIR QIDs are in the same array, but *NOT*
- * contiguous in that array, this function accepts a "range" of QIDs to scan.
+ * the appropriate QID IQ, for the QIDs owned by the scheduler. Packets for
+ * the QIDs of another scheduler are passed to it.
  */
 static uint16_t
-sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
+sw_schedule_reorder(struct sw_evdev *sw, struct sw_scheduler *sched)
 {
 	/* Perform egress reordering */
 	struct rte_event *qe;
 	uint32_t pkts_iter = 0;
+	uint32_t qid_idx;
 
-	for (; qid_start < qid_end; qid_start++) {
-		struct sw_qid *qid = &sw->qids[qid_start];
+	for (qid_idx = 0; qid_idx < sched->ordered_qid_count; qid_idx++) {
+		struct sw_qid *qid = sched->ordered_qids[qid_idx];
 		int i, num_entries_in_use;
 
-		if (qid->type != RTE_SCHED_TYPE_ORDERED)
-			continue;
-
 		num_entries_in_use = rte_ring_free_count(
 					qid->reorder_buffer_freelist);
 
@@ -318,29 +420,25 @@ sw_schedule_reorder(struct sw_evdev *sw, int qid_start, int qid_end)
 				dest_iq  = PRIO_TO_IQ(qe->priority);
 
 				if (dest_qid >= sw->qid_count) {
-					sw->stats.rx_dropped++;
+					sched->stats.rx_dropped++;
 					continue;
 				}
 
-				struct sw_qid *dest_qid_ptr =
-					&sw->qids[dest_qid];
-				const struct iq_ring *dest_iq_ptr =
-					dest_qid_ptr->iq[dest_iq];
-				if (iq_ring_free_count(dest_iq_ptr) == 0)
-					break;
-
-				pkts_iter++;
+				uint32_t dest_sched = sw->qid_scheduler[dest_qid];
+				if (dest_sched != sched->id) {
+					if (sw_xfer_full(sw, sched, dest_sched))
+						break;
+					sw_xfer_enqueue(sched, dest_sched, qe);
+					continue;
+				}
 
 				struct sw_qid *q = &sw->qids[dest_qid];
-				struct iq_ring *r = q->iq[dest_iq];
 
-				/* we checked for space above, so enqueue must
-				 * succeed
-				 */
-				iq_ring_enqueue(r, qe);
-				q->iq_pkt_mask |= (1 << (dest_iq));
-				q->iq_pkt_count[dest_iq]++;
-				q->stats.rx_pkts++;
+				if (iq_full(sched, &q->iq[dest_iq]))
+					break;
+
+				pkts_iter++;
+				sw_qid_enqueue(sched, q, dest_iq, qe);
 			}
 
 			entry->ready = (j != entry->num_fragments);
@@ -373,7 +471,8 @@ sw_refill_pp_buf(struct sw_evdev *sw, struct sw_port *port)
 }
 
 static inline uint32_t __attribute__((always_inline))
-__pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
+__pull_port_lb(struct sw_evdev *sw, struct sw_scheduler *sched,
+		uint32_t port_id, int allow_reorder)
 {
 	static struct reorder_buffer_entry dummy_rob;
 	uint32_t pkts_iter = 0;
@@ -394,17 +493,23 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 			flags = QE_FLAG_VALID;
 
 		/*
-		 * if we don't have space for this packet in an IQ,
-		 * then move on to next queue. Technically, for a
-		 * packet that needs reordering, we don't need to check
-		 * here, but it simplifies things not to special-case
+		 * if we can't pass this packet to another scheduler, or
+		 * (only if misused) store it in an IQ, then move on to
+		 * next queue. Technically, for a packet that needs
+		 * reordering, we don't need to check here, but it
+		 * simplifies things not to special-case
 		 */
 		uint32_t iq_num = PRIO_TO_IQ(qe->priority);
 		struct sw_qid *qid = &sw->qids[qe->queue_id];
+		uint32_t dest_sched = sw->qid_scheduler[qe->queue_id];
 
-		if ((flags & QE_FLAG_VALID) &&
-				iq_ring_free_count(qid->iq[iq_num]) == 0)
-			break;
+		if (flags & QE_FLAG_VALID) {
+			if (dest_sched != sched->id) {
+				if (sw_xfer_full(sw, sched, dest_sched))
+					break;
+			} else if (iq_full(sched, &qid->iq[iq_num]))
+				break;
+		}
 
 		/* now process based on flags. Note that for directed
 		 * queues, the enqueue_flush masks off all but the
@@ -456,7 +561,7 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 				 */
 				int num_frag = rob_entry->num_fragments;
 				if (num_frag == SW_FRAGMENTS_MAX)
-					sw->stats.rx_dropped++;
+					sched->stats.rx_dropped++;
 				else {
 					int idx = rob_entry->num_fragments++;
 					rob_entry->fragments[idx] = *qe;
@@ -464,14 +569,15 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 				goto end_qe;
 			}
 
+			if (dest_sched != sched->id) {
+				sw_xfer_enqueue(sched, dest_sched, qe);
+				goto end_qe;
+			}
+
 			/* Use the iq_num from above to push the QE
 			 * into the qid at the right priority
 			 */
-
-			qid->iq_pkt_mask |= (1 << (iq_num));
-			iq_ring_enqueue(qid->iq[iq_num], qe);
-			qid->iq_pkt_count[iq_num]++;
-			qid->stats.rx_pkts++;
+			sw_qid_enqueue(sched, qid, iq_num, qe);
 			pkts_iter++;
 		}
 
@@ -484,19 +590,22 @@ __pull_port_lb(struct sw_evdev *sw, uint32_t port_id, int allow_reorder)
 }
 
 static uint32_t
-sw_schedule_pull_port_lb(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_lb(struct sw_evdev *sw, struct sw_scheduler *sched,
+		uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 1);
+	return __pull_port_lb(sw, sched, port_id, 1);
 }
 
 static uint32_t
-sw_schedule_pull_port_no_reorder(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_no_reorder(struct sw_evdev *sw,
+		struct sw_scheduler *sched, uint32_t port_id)
 {
-	return __pull_port_lb(sw, port_id, 0);
+	return __pull_port_lb(sw, sched, port_id, 0);
 }
 
 static uint32_t
-sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
+sw_schedule_pull_port_dir(struct sw_evdev *sw, struct sw_scheduler *sched,
+		uint32_t port_id)
 {
 	uint32_t pkts_iter = 0;
 	struct sw_port *port = &sw->ports[port_id];
@@ -514,9 +623,17 @@ sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
 
 		uint32_t iq_num = PRIO_TO_IQ(qe->priority);
 		struct sw_qid *qid = &sw->qids[qe->queue_id];
-		struct iq_ring *iq_ring = qid->iq[iq_num];
+		uint32_t dest_sched = sw->qid_scheduler[qe->queue_id];
+
+		if (dest_sched != sched->id) {
+			if (sw_xfer_full(sw, sched, dest_sched))
+				break; /* move to next port */
+			port->stats.rx_pkts++;
+			sw_xfer_enqueue(sched, dest_sched, qe);
+			goto end_qe;
+		}
 
-		if (iq_ring_free_count(iq_ring) == 0)
+		if (iq_full(sched, &qid->iq[iq_num]))
 			break; /* move to next port */
 
 		port->stats.rx_pkts++;
@@ -524,10 +641,7 @@ sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
 		/* Use the iq_num from above to push the QE
 		 * into the qid at the right priority
 		 */
-		qid->iq_pkt_mask |= (1 << (iq_num));
-		iq_ring_enqueue(iq_ring, qe);
-		qid->iq_pkt_count[iq_num]++;
-		qid->stats.rx_pkts++;
+		sw_qid_enqueue(sched, qid, iq_num, qe);
 		pkts_iter++;
 
 end_qe:
@@ -539,15 +653,14 @@ sw_schedule_pull_port_dir(struct sw_evdev *sw, uint32_t port_id)
 }
 
 void
-sw_event_schedule(struct rte_eventdev *dev)
+sw_scheduler_run(struct sw_evdev *sw, struct sw_scheduler *sched)
 {
-	struct sw_evdev *sw = sw_pmd_priv(dev);
 	uint32_t in_pkts, out_pkts;
 	uint32_t out_pkts_total = 0, in_pkts_total = 0;
 	int32_t sched_quanta = sw->sched_quanta;
 	uint32_t i;
 
-	sw->sched_called++;
+	sched->sched_called++;
 	if (!sw->started)
 		return;
 
@@ -557,23 +670,36 @@ sw_event_schedule(struct rte_eventdev *dev)
 		/* Pull from rx_ring for ports */
 		do {
 			in_pkts = 0;
-			for (i = 0; i < sw->port_count; i++)
-				if (sw->ports[i].is_directed)
-					in_pkts += sw_schedule_pull_port_dir(sw, i);
-				else if (sw->ports[i].num_ordered_qids > 0)
-					in_pkts += sw_schedule_pull_port_lb(sw, i);
+			if (sw->scheduler_count > 1)
+				in_pkts += sw_schedule_pull_xfer(sw, sched);
+			for (i = 0; i < sched->port_count; i++) {
+				const uint32_t port_id = sched->port_ids[i];
+				const struct sw_port *port = &sw->ports[port_id];
+
+				if (port->is_directed)
+					in_pkts += sw_schedule_pull_port_dir(sw,
+							sched, port_id);
+				else if (port->num_ordered_qids > 0)
+					in_pkts += sw_schedule_pull_port_lb(sw,
+							sched, port_id);
 				else
-					in_pkts += sw_schedule_pull_port_no_reorder(sw, i);
+					in_pkts += sw_schedule_pull_port_no_reorder(
+							sw, sched, port_id);
+			}
 
 			/* QID scan for re-ordered */
-			in_pkts += sw_schedule_reorder(sw, 0,
-					sw->qid_count);
+			in_pkts += sw_schedule_reorder(sw, sched);
 			in_pkts_this_iteration += in_pkts;
 		} while (in_pkts > 4 &&
 				(int)in_pkts_this_iteration < sched_quanta);
 
+		/* pass the events for the other schedulers */
+		for (i = 0; i < sw->scheduler_count; i++)
+			if (i != sched->id)
+				sw_xfer_flush(sw, sched, i);
+
 		out_pkts = 0;
-		out_pkts += sw_schedule_qid_to_cq(sw);
+		out_pkts += sw_schedule_qid_to_cq(sw, sched);
 		out_pkts_total += out_pkts;
 		in_pkts_total += in_pkts_this_iteration;
 
@@ -584,18 +710,30 @@ sw_event_schedule(struct rte_eventdev *dev)
 	/* push all the internal buffered QEs in port->cq_ring to the
 	 * worker cores: aka, do the ring transfers batched.
 	 */
-	for (i = 0; i < sw->port_count; i++) {
-		struct qe_ring *worker = sw->ports[i].cq_worker_ring;
-		qe_ring_enqueue_burst(worker, sw->ports[i].cq_buf,
-				sw->ports[i].cq_buf_count,
-				&sw->cq_ring_space[i]);
-		sw->ports[i].cq_buf_count = 0;
+	for (i = 0; i < sched->port_count; i++) {
+		const uint32_t port_id = sched->port_ids[i];
+		struct sw_port *port = &sw->ports[port_id];
+
+		qe_ring_enqueue_burst(port->cq_worker_ring, port->cq_buf,
+				port->cq_buf_count,
+				&sw->cq_ring_space[port_id]);
+		port->cq_buf_count = 0;
 	}
 
-	sw->stats.tx_pkts += out_pkts_total;
-	sw->stats.rx_pkts += in_pkts_total;
+	sched->stats.tx_pkts += out_pkts_total;
+	sched->stats.rx_pkts += in_pkts_total;
+
+	sched->sched_no_iq_enqueues += (in_pkts_total == 0);
+	sched->sched_no_cq_enqueues += (out_pkts_total == 0);
+}
 
-	sw->sched_no_iq_enqueues += (in_pkts_total == 0);
-	sw->sched_no_cq_enqueues += (out_pkts_total == 0);
+void
+sw_event_schedule(struct rte_eventdev *dev)
+{
+	struct sw_evdev *sw = sw_pmd_priv(dev);
+	uint32_t i;
 
+	/* run the schedulers in turn */
+	for (i = 0; i < sw->scheduler_count; i++)
+		sw_scheduler_run(sw, &sw->schedulers[i]);
 }
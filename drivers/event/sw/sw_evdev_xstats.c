@@ -31,7 +31,7 @@
  */
 
 #include "sw_evdev.h"
-#include "iq_ring.h"
+#include "iq_chunk.h"
 #include "event_ring.h"
 
 enum xstats_type {
@@ -75,20 +75,37 @@ struct sw_xstats_entry {
 };
 
 static uint64_t
-get_dev_stat(const struct sw_evdev *sw, uint16_t obj_idx __rte_unused,
-		enum xstats_type type, int extra_arg __rte_unused)
+get_sched_stat(const struct sw_scheduler *sched, enum xstats_type type)
 {
 	switch (type) {
-	case rx: return sw->stats.rx_pkts;
-	case tx: return sw->stats.tx_pkts;
-	case dropped: return sw->stats.rx_dropped;
-	case calls: return sw->sched_called;
-	case no_iq_enq: return sw->sched_no_iq_enqueues;
-	case no_cq_enq: return sw->sched_no_cq_enqueues;
+	case rx: return sched->stats.rx_pkts;
+	case tx: return sched->stats.tx_pkts;
+	case dropped: return sched->stats.rx_dropped;
+	case calls: return sched->sched_called;
+	case no_iq_enq: return sched->sched_no_iq_enqueues;
+	case no_cq_enq: return sched->sched_no_cq_enqueues;
 	default: return -1;
 	}
 }
 
+/* the device stats are the sums of the stats of the schedulers */
+static uint64_t
+get_dev_stat(const struct sw_evdev *sw, uint16_t obj_idx __rte_unused,
+		enum xstats_type type, int extra_arg __rte_unused)
+{
+	uint64_t val = 0;
+	uint32_t i;
+
+	for (i = 0; i < sw->scheduler_count; i++) {
+		uint64_t v = get_sched_stat(&sw->schedulers[i], type);
+
+		if (v == (uint64_t)-1)
+			return v;
+		val += v;
+	}
+	return val;
+}
+
 static uint64_t
 get_port_stat(const struct sw_evdev *sw, uint16_t obj_idx,
 		enum xstats_type type, int extra_arg __rte_unused)
@@ -143,7 +160,7 @@ get_qid_stat(const struct sw_evdev *sw, uint16_t obj_idx,
 			return infl;
 		} while (0);
 		break;
-	case iq_size: return RTE_DIM(qid->iq[0]->ring);
+	case iq_size: return sw->nb_events_limit;
 	default: return -1;
 	}
 }
@@ -156,7 +173,7 @@ get_qid_iq_stat(const struct sw_evdev *sw, uint16_t obj_idx,
 	const int iq_idx = extra_arg;
 
 	switch (type) {
-	case iq_used: return iq_ring_count(qid->iq[iq_idx]);
+	case iq_used: return iq_count(&qid->iq[iq_idx]);
 	default: return -1;
 	}
 }
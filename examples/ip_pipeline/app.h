@@ -187,6 +187,16 @@ struct app_pktq_tap_params {
 	uint32_t mempool_id; /* Position in the app->mempool_params */
 };
 
+struct app_pktq_evq_params {
+	char *name;
+	uint32_t parsed;
+	uint32_t sched_type; /* RTE_SCHED_TYPE_ATOMIC/ORDERED/PARALLEL */
+	uint32_t burst_read;
+	uint32_t burst_write;
+	uint32_t dropless;
+	uint64_t n_retries;
+};
+
 struct app_pktq_source_params {
 	char *name;
 	uint32_t parsed;
@@ -217,6 +227,7 @@ enum app_pktq_in_type {
 	APP_PKTQ_IN_TAP,
 	APP_PKTQ_IN_KNI,
 	APP_PKTQ_IN_SOURCE,
+	APP_PKTQ_IN_EVQ,
 };
 
 struct app_pktq_in_params {
@@ -231,6 +242,7 @@ enum app_pktq_out_type {
 	APP_PKTQ_OUT_TAP,
 	APP_PKTQ_OUT_KNI,
 	APP_PKTQ_OUT_SINK,
+	APP_PKTQ_OUT_EVQ,
 };
 
 struct app_pktq_out_params {
@@ -343,6 +355,9 @@ struct app_eal_params {
 	/* Map lcore set to physical cpu set */
 	char *coremap;
 
+	/* Service cores, e.g. running the event device scheduler */
+	char *service_coremask;
+
 	/* Core ID that is used as master */
 	uint32_t master_lcore_present;
 	uint32_t master_lcore;
@@ -459,6 +474,10 @@ struct app_eal_params {
 
 #define APP_MAX_PKTQ_KNI                         APP_MAX_LINKS
 
+#ifndef APP_MAX_PKTQ_EVQ
+#define APP_MAX_PKTQ_EVQ                         64
+#endif
+
 #ifndef APP_MAX_PKTQ_SOURCE
 #define APP_MAX_PKTQ_SOURCE                      64
 #endif
@@ -515,6 +534,7 @@ struct app_params {
 	struct app_pktq_tm_params tm_params[APP_MAX_PKTQ_TM];
 	struct app_pktq_tap_params tap_params[APP_MAX_PKTQ_TAP];
 	struct app_pktq_kni_params kni_params[APP_MAX_PKTQ_KNI];
+	struct app_pktq_evq_params evq_params[APP_MAX_PKTQ_EVQ];
 	struct app_pktq_source_params source_params[APP_MAX_PKTQ_SOURCE];
 	struct app_pktq_sink_params sink_params[APP_MAX_PKTQ_SINK];
 	struct app_msgq_params msgq_params[APP_MAX_MSGQ];
@@ -528,6 +548,7 @@ struct app_params {
 	uint32_t n_pktq_tm;
 	uint32_t n_pktq_tap;
 	uint32_t n_pktq_kni;
+	uint32_t n_pktq_evq;
 	uint32_t n_pktq_source;
 	uint32_t n_pktq_sink;
 	uint32_t n_msgq;
@@ -545,6 +566,9 @@ struct app_params {
 #ifdef RTE_LIBRTE_KNI
 	struct rte_kni *kni[APP_MAX_PKTQ_KNI];
 #endif /* RTE_LIBRTE_KNI */
+	/* event port of each EVQ reader and writer, on event device 0 */
+	uint8_t evq_port_in[APP_MAX_PIPELINES][APP_MAX_PIPELINE_PKTQ_IN];
+	uint8_t evq_port_out[APP_MAX_PIPELINES][APP_MAX_PIPELINE_PKTQ_OUT];
 	struct rte_ring *msgq[APP_MAX_MSGQ];
 	struct pipeline_type pipeline_type[APP_MAX_PIPELINE_TYPES];
 	struct app_pipeline_data pipeline_data[APP_MAX_PIPELINES];
@@ -927,6 +951,31 @@ app_kni_get_reader(struct app_params *app,
 	return reader;
 }
 
+static inline uint32_t
+app_evq_get_readers(struct app_params *app, struct app_pktq_evq_params *evq)
+{
+	uint32_t pos = evq - app->evq_params;
+	uint32_t n_pipelines = RTE_MIN(app->n_pipelines,
+		RTE_DIM(app->pipeline_params));
+	uint32_t n_readers = 0, i;
+
+	for (i = 0; i < n_pipelines; i++) {
+		struct app_pipeline_params *p = &app->pipeline_params[i];
+		uint32_t n_pktq_in = RTE_MIN(p->n_pktq_in, RTE_DIM(p->pktq_in));
+		uint32_t j;
+
+		for (j = 0; j < n_pktq_in; j++) {
+			struct app_pktq_in_params *pktq = &p->pktq_in[j];
+
+			if ((pktq->type == APP_PKTQ_IN_EVQ) &&
+				(pktq->id == pos))
+				n_readers++;
+		}
+	}
+
+	return n_readers;
+}
+
 static inline uint32_t
 app_source_get_readers(struct app_params *app,
 struct app_pktq_source_params *source)
@@ -1248,6 +1297,32 @@ app_kni_get_writer(struct app_params *app,
 	return writer;
 }
 
+static inline uint32_t
+app_evq_get_writers(struct app_params *app, struct app_pktq_evq_params *evq)
+{
+	uint32_t pos = evq - app->evq_params;
+	uint32_t n_pipelines = RTE_MIN(app->n_pipelines,
+		RTE_DIM(app->pipeline_params));
+	uint32_t n_writers = 0, i;
+
+	for (i = 0; i < n_pipelines; i++) {
+		struct app_pipeline_params *p = &app->pipeline_params[i];
+		uint32_t n_pktq_out = RTE_MIN(p->n_pktq_out,
+			RTE_DIM(p->pktq_out));
+		uint32_t j;
+
+		for (j = 0; j < n_pktq_out; j++) {
+			struct app_pktq_out_params *pktq = &p->pktq_out[j];
+
+			if ((pktq->type == APP_PKTQ_OUT_EVQ) &&
+				(pktq->id == pos))
+				n_writers++;
+		}
+	}
+
+	return n_writers;
+}
+
 static inline uint32_t
 app_sink_get_writers(struct app_params *app, struct app_pktq_sink_params *sink)
 {
@@ -34,6 +34,7 @@
 #include <stdio.h>
 
 #include <rte_ip.h>
+#include <rte_port.h>
 
 #include "app.h"
 
@@ -368,6 +369,46 @@ check_knis(struct app_params *app) {
 	}
 }
 
+static void
+check_evqs(struct app_params *app)
+{
+	uint32_t i;
+
+	for (i = 0; i < app->n_pktq_evq; i++) {
+		struct app_pktq_evq_params *p = &app->evq_params[i];
+		uint32_t n_readers = app_evq_get_readers(app, p);
+		uint32_t n_writers = app_evq_get_writers(app, p);
+
+		APP_CHECK((p->burst_read > 0),
+			"%s read burst size is 0\n", p->name);
+
+		APP_CHECK((p->burst_read <= RTE_PORT_IN_BURST_SIZE_MAX),
+			"%s read burst size is bigger than %u\n",
+			p->name, RTE_PORT_IN_BURST_SIZE_MAX);
+
+		APP_CHECK((p->burst_write > 0),
+			"%s write burst size is 0\n", p->name);
+
+		APP_CHECK((p->burst_write <= RTE_PORT_IN_BURST_SIZE_MAX),
+			"%s write burst size is bigger than %u\n",
+			p->name, RTE_PORT_IN_BURST_SIZE_MAX);
+
+		APP_CHECK((n_readers != 0),
+			"%s has no reader\n", p->name);
+
+		if (n_readers > 1)
+			APP_LOG(app, LOW, "%s has more than one reader",
+				p->name);
+
+		APP_CHECK((n_writers != 0),
+			"%s has no writer\n", p->name);
+
+		if (n_writers > 1)
+			APP_LOG(app, LOW, "%s has more than one writer",
+				p->name);
+	}
+}
+
 static void
 check_sources(struct app_params *app)
 {
@@ -508,6 +549,7 @@ app_config_check(struct app_params *app)
 	check_tms(app);
 	check_taps(app);
 	check_knis(app);
+	check_evqs(app);
 	check_sources(app);
 	check_sinks(app);
 	check_msgqs(app);
@@ -45,6 +45,7 @@
 
 #include <rte_errno.h>
 #include <rte_cfgfile.h>
+#include <rte_eventdev.h>
 #include <rte_string_fns.h>
 
 #include "app.h"
@@ -198,6 +199,15 @@ struct app_pktq_tap_params default_tap_params = {
 	.mempool_id = 0,
 };
 
+struct app_pktq_evq_params default_evq_params = {
+	.parsed = 0,
+	.sched_type = RTE_SCHED_TYPE_ATOMIC,
+	.burst_read = 32,
+	.burst_write = 32,
+	.dropless = 0,
+	.n_retries = 0,
+};
+
 struct app_pktq_kni_params default_kni_params = {
 	.parsed = 0,
 	.socket_id = 0,
@@ -476,6 +486,16 @@ parse_eal(struct app_params *app,
 			continue;
 		}
 
+		/* service coremask */
+		if (strcmp(entry->name, "s") == 0) {
+			PARSE_ERROR_DUPLICATE((p->service_coremask == NULL),
+				section_name,
+				entry->name);
+			p->service_coremask = strdup(entry->value);
+			PARSE_ERROR_MALLOC(p->service_coremask);
+			continue;
+		}
+
 		/* master_lcore */
 		if (strcmp(entry->name, "master_lcore") == 0) {
 			int status;
@@ -871,6 +891,9 @@ parse_pipeline_pktq_in(struct app_params *app,
 		} else if (validate_name(name, "SOURCE", 1) == 0) {
 			type = APP_PKTQ_IN_SOURCE;
 			id = APP_PARAM_ADD(app->source_params, name);
+		} else if (validate_name(name, "EVQ", 1) == 0) {
+			type = APP_PKTQ_IN_EVQ;
+			id = APP_PARAM_ADD(app->evq_params, name);
 		} else
 			PARSE_ERROR_INVALID_ELEMENT(0,
 				p->name, "pktq_in", name);
@@ -923,6 +946,9 @@ parse_pipeline_pktq_out(struct app_params *app,
 		} else if (validate_name(name, "SINK", 1) == 0) {
 			type = APP_PKTQ_OUT_SINK;
 			id = APP_PARAM_ADD(app->sink_params, name);
+		} else if (validate_name(name, "EVQ", 1) == 0) {
+			type = APP_PKTQ_OUT_EVQ;
+			id = APP_PARAM_ADD(app->evq_params, name);
 		} else
 			PARSE_ERROR_INVALID_ELEMENT(0,
 				p->name, "pktq_out", name);
@@ -1992,6 +2018,86 @@ parse_tap(struct app_params *app,
 	free(entries);
 }
 
+static void
+parse_evq(struct app_params *app,
+	const char *section_name,
+	struct rte_cfgfile *cfg)
+{
+	struct app_pktq_evq_params *param;
+	struct rte_cfgfile_entry *entries;
+	int n_entries, i;
+	ssize_t param_idx;
+
+	n_entries = rte_cfgfile_section_num_entries(cfg, section_name);
+	PARSE_ERROR_SECTION_NO_ENTRIES((n_entries > 0), section_name);
+
+	entries = malloc(n_entries * sizeof(struct rte_cfgfile_entry));
+	PARSE_ERROR_MALLOC(entries != NULL);
+
+	rte_cfgfile_section_entries(cfg, section_name, entries, n_entries);
+
+	param_idx = APP_PARAM_ADD(app->evq_params, section_name);
+	param = &app->evq_params[param_idx];
+	PARSE_CHECK_DUPLICATE_SECTION(param);
+
+	for (i = 0; i < n_entries; i++) {
+		struct rte_cfgfile_entry *ent = &entries[i];
+
+		if (strcmp(ent->name, "sched_type") == 0) {
+			if (strcmp(ent->value, "atomic") == 0)
+				param->sched_type = RTE_SCHED_TYPE_ATOMIC;
+			else if (strcmp(ent->value, "ordered") == 0)
+				param->sched_type = RTE_SCHED_TYPE_ORDERED;
+			else if (strcmp(ent->value, "parallel") == 0)
+				param->sched_type = RTE_SCHED_TYPE_PARALLEL;
+			else
+				PARSE_ERROR(0, section_name, ent->name);
+			continue;
+		}
+
+		if (strcmp(ent->name, "burst_read") == 0) {
+			int status = parser_read_uint32(
+				&param->burst_read, ent->value);
+
+			PARSE_ERROR((status == 0), section_name,
+				ent->name);
+			continue;
+		}
+
+		if (strcmp(ent->name, "burst_write") == 0) {
+			int status = parser_read_uint32(
+				&param->burst_write, ent->value);
+
+			PARSE_ERROR((status == 0), section_name,
+				ent->name);
+			continue;
+		}
+
+		if (strcmp(ent->name, "dropless") == 0) {
+			int status = parser_read_arg_bool(ent->value);
+
+			PARSE_ERROR((status != -EINVAL), section_name,
+				ent->name);
+			param->dropless = status;
+			continue;
+		}
+
+		if (strcmp(ent->name, "n_retries") == 0) {
+			int status = parser_read_uint64(&param->n_retries,
+				ent->value);
+
+			PARSE_ERROR((status == 0), section_name,
+				ent->name);
+			continue;
+		}
+
+		/* unrecognized */
+		PARSE_ERROR_INVALID(0, section_name, ent->name);
+	}
+
+	free(entries);
+}
+
 static void
 parse_kni(struct app_params *app,
 		  const char *section_name,
@@ -2384,6 +2490,7 @@ static const struct config_section cfg_file_scheme[] = {
 	{"SWQ", 1, parse_swq},
 	{"TM", 1, parse_tm},
 	{"TAP", 1, parse_tap},
+	{"EVQ", 1, parse_evq},
 	{"KNI", 1, parse_kni},
 	{"SOURCE", 1, parse_source},
 	{"SINK", 1, parse_sink},
@@ -2525,6 +2632,7 @@ app_config_parse(struct app_params *app, const char *file_name)
 	APP_PARAM_COUNT(app->tm_params, app->n_pktq_tm);
 	APP_PARAM_COUNT(app->tap_params, app->n_pktq_tap);
 	APP_PARAM_COUNT(app->kni_params, app->n_pktq_kni);
+	APP_PARAM_COUNT(app->evq_params, app->n_pktq_evq);
 	APP_PARAM_COUNT(app->source_params, app->n_pktq_source);
 	APP_PARAM_COUNT(app->sink_params, app->n_pktq_sink);
 	APP_PARAM_COUNT(app->msgq_params, app->n_msgq);
@@ -2553,6 +2661,9 @@ save_eal_params(struct app_params *app, FILE *f)
 	if (p->coremap)
 		fprintf(f, "%s = %s\n", "lcores", p->coremap);
 
+	if (p->service_coremask)
+		fprintf(f, "%s = %s\n", "s", p->service_coremask);
+
 	if (p->master_lcore_present)
 		fprintf(f, "%s = %" PRIu32 "\n",
 			"master_lcore", p->master_lcore);
@@ -2911,6 +3022,42 @@ save_tap_params(struct app_params *app, FILE *f)
 	}
 }
 
+static void
+save_evq_params(struct app_params *app, FILE *f)
+{
+	struct app_pktq_evq_params *p;
+	size_t i, count;
+
+	count = RTE_DIM(app->evq_params);
+	for (i = 0; i < count; i++) {
+		const char *sched_type;
+
+		p = &app->evq_params[i];
+		if (!APP_PARAM_VALID(p))
+			continue;
+
+		switch (p->sched_type) {
+		case RTE_SCHED_TYPE_ORDERED:
+			sched_type = "ordered";
+			break;
+		case RTE_SCHED_TYPE_PARALLEL:
+			sched_type = "parallel";
+			break;
+		default:
+			sched_type = "atomic";
+		}
+
+		fprintf(f, "[%s]\n", p->name);
+		fprintf(f, "%s = %s\n", "sched_type", sched_type);
+		fprintf(f, "%s = %" PRIu32 "\n", "burst_read", p->burst_read);
+		fprintf(f, "%s = %" PRIu32 "\n", "burst_write", p->burst_write);
+		fprintf(f, "%s = %s\n", "dropless", p->dropless ? "yes" : "no");
+		fprintf(f, "%s = %" PRIu64 "\n", "n_retries", p->n_retries);
+
+		fputc('\n', f);
+	}
+}
+
 static void
 save_kni_params(struct app_params *app, FILE *f)
 {
@@ -3074,6 +3221,9 @@ save_pipeline_params(struct app_params *app, FILE *f)
 				case APP_PKTQ_IN_SOURCE:
 					name = app->source_params[pp->id].name;
 					break;
+				case APP_PKTQ_IN_EVQ:
+					name = app->evq_params[pp->id].name;
+					break;
 				default:
 					APP_CHECK(0, "System error "
 						"occurred while saving "
@@ -3114,6 +3264,9 @@ save_pipeline_params(struct app_params *app, FILE *f)
 				case APP_PKTQ_OUT_SINK:
 					name = app->sink_params[pp->id].name;
 					break;
+				case APP_PKTQ_OUT_EVQ:
+					name = app->evq_params[pp->id].name;
+					break;
 				default:
 					APP_CHECK(0, "System error "
 						"occurred while saving "
@@ -3198,6 +3351,7 @@ app_config_save(struct app_params *app, const char *file_name)
 	save_tm_params(app, file);
 	save_tap_params(app, file);
 	save_kni_params(app, file);
+	save_evq_params(app, file);
 	save_source_params(app, file);
 	save_sink_params(app, file);
 	save_msgq_params(app, file);
@@ -3253,6 +3407,11 @@ app_config_init(struct app_params *app)
 			   &default_kni_params,
 			   sizeof(default_kni_params));
 
+	for (i = 0; i < RTE_DIM(app->evq_params); i++)
+		memcpy(&app->evq_params[i],
+			&default_evq_params,
+			sizeof(default_evq_params));
+
 	for (i = 0; i < RTE_DIM(app->source_params); i++)
 		memcpy(&app->source_params[i],
 			&default_source_params,
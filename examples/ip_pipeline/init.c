@@ -49,6 +49,10 @@
 #include <rte_ip.h>
 #include <rte_eal.h>
 #include <rte_malloc.h>
+#ifdef RTE_LIBRTE_EVENTDEV
+#include <rte_eventdev.h>
+#include <rte_service.h>
+#endif
 
 #include "app.h"
 #include "pipeline.h"
@@ -128,6 +132,11 @@ app_init_eal(struct app_params *app)
 		app->eal_argv[n_args++] = strdup(buffer);
 	}
 
+	if (p->service_coremask) {
+		snprintf(buffer, sizeof(buffer), "-s%s", p->service_coremask);
+		app->eal_argv[n_args++] = strdup(buffer);
+	}
+
 	if (p->master_lcore_present) {
 		snprintf(buffer,
 			sizeof(buffer),
@@ -1311,6 +1320,175 @@ app_init_kni(struct app_params *app) {
 }
 #endif /* RTE_LIBRTE_KNI */
 
+#ifndef RTE_LIBRTE_EVENTDEV
+static void
+app_init_evq(struct app_params *app)
+{
+	if (app->n_pktq_evq == 0)
+		return;
+
+	rte_panic("Can not init EVQ without librte_eventdev support.\n");
+}
+#else
+static void
+app_init_evq(struct app_params *app)
+{
+	struct rte_event_dev_info info;
+	struct rte_event_dev_config dev_conf;
+	uint32_t n_ports = 0, i, j;
+	int status;
+
+	if (app->n_pktq_evq == 0)
+		return;
+
+	APP_LOG(app, HIGH, "Initializing event device 0 ...");
+
+	if (rte_event_dev_count() == 0)
+		rte_panic("No event device found (EVQ requires e.g. "
+			"\"vdev = event_sw0\" in the EAL section)\n");
+
+	status = rte_event_dev_info_get(0, &info);
+	if (status < 0)
+		rte_panic("Event device 0 info get error (%d)\n", status);
+
+	/* Each EVQ reader and writer gets an event port of its own */
+	for (i = 0; i < app->n_pipelines; i++) {
+		struct app_pipeline_params *p = &app->pipeline_params[i];
+
+		for (j = 0; j < p->n_pktq_in; j++)
+			if (p->pktq_in[j].type == APP_PKTQ_IN_EVQ)
+				app->evq_port_in[i][j] = n_ports++;
+
+		for (j = 0; j < p->n_pktq_out; j++)
+			if (p->pktq_out[j].type == APP_PKTQ_OUT_EVQ)
+				app->evq_port_out[i][j] = n_ports++;
+	}
+
+	if ((app->n_pktq_evq > info.max_event_queues) ||
+		(n_ports > info.max_event_ports))
+		rte_panic("Event device 0 supports up to %" PRIu32
+			" queues and %" PRIu32 " ports (%" PRIu32
+			" queues and %" PRIu32 " ports required)\n",
+			(uint32_t) info.max_event_queues,
+			(uint32_t) info.max_event_ports,
+			app->n_pktq_evq,
+			n_ports);
+
+	memset(&dev_conf, 0, sizeof(dev_conf));
+	dev_conf.dequeue_timeout_ns = info.min_dequeue_timeout_ns;
+	dev_conf.nb_events_limit = info.max_num_events;
+	dev_conf.nb_event_queues = app->n_pktq_evq;
+	dev_conf.nb_event_ports = n_ports;
+	dev_conf.nb_event_queue_flows = info.max_event_queue_flows;
+	dev_conf.nb_event_port_dequeue_depth =
+		info.max_event_port_dequeue_depth;
+	dev_conf.nb_event_port_enqueue_depth =
+		info.max_event_port_enqueue_depth;
+
+	status = rte_event_dev_configure(0, &dev_conf);
+	if (status < 0)
+		rte_panic("Event device 0 configure error (%d)\n", status);
+
+	/* Queues */
+	for (i = 0; i < app->n_pktq_evq; i++) {
+		struct app_pktq_evq_params *p_evq = &app->evq_params[i];
+		struct rte_event_queue_conf queue_conf;
+
+		APP_LOG(app, HIGH, "Initializing %s ...", p_evq->name);
+
+		rte_event_queue_default_conf_get(0, i, &queue_conf);
+		switch (p_evq->sched_type) {
+		case RTE_SCHED_TYPE_ORDERED:
+			queue_conf.event_queue_cfg =
+				RTE_EVENT_QUEUE_CFG_ORDERED_ONLY;
+			break;
+		case RTE_SCHED_TYPE_PARALLEL:
+			queue_conf.event_queue_cfg =
+				RTE_EVENT_QUEUE_CFG_PARALLEL_ONLY;
+			break;
+		default:
+			queue_conf.event_queue_cfg =
+				RTE_EVENT_QUEUE_CFG_ATOMIC_ONLY;
+		}
+
+		status = rte_event_queue_setup(0, i, &queue_conf);
+		if (status < 0)
+			rte_panic("%s init error (%d)\n", p_evq->name, status);
+	}
+
+	/* Ports: readers are linked to their EVQ, writers to nothing */
+	for (i = 0; i < app->n_pipelines; i++) {
+		struct app_pipeline_params *p = &app->pipeline_params[i];
+
+		for (j = 0; j < p->n_pktq_in; j++) {
+			struct app_pktq_evq_params *p_evq;
+			struct rte_event_port_conf port_conf;
+			uint8_t port_id = app->evq_port_in[i][j];
+			uint8_t queue_id;
+
+			if (p->pktq_in[j].type != APP_PKTQ_IN_EVQ)
+				continue;
+
+			queue_id = p->pktq_in[j].id;
+			p_evq = &app->evq_params[queue_id];
+
+			rte_event_port_default_conf_get(0, port_id, &port_conf);
+			port_conf.dequeue_depth = RTE_MIN(p_evq->burst_read,
+				info.max_event_port_dequeue_depth);
+
+			status = rte_event_port_setup(0, port_id, &port_conf);
+			if (status < 0)
+				rte_panic("%s (%s) event port %" PRIu32
+					" init error (%d)\n",
+					p->name, p_evq->name,
+					(uint32_t) port_id, status);
+
+			status = rte_event_port_link(0, port_id,
+				&queue_id, NULL, 1);
+			if (status != 1)
+				rte_panic("%s (%s) event port %" PRIu32
+					" link error\n",
+					p->name, p_evq->name,
+					(uint32_t) port_id);
+		}
+
+		for (j = 0; j < p->n_pktq_out; j++) {
+			struct app_pktq_evq_params *p_evq;
+			struct rte_event_port_conf port_conf;
+			uint8_t port_id = app->evq_port_out[i][j];
+
+			if (p->pktq_out[j].type != APP_PKTQ_OUT_EVQ)
+				continue;
+
+			p_evq = &app->evq_params[p->pktq_out[j].id];
+
+			rte_event_port_default_conf_get(0, port_id, &port_conf);
+			port_conf.enqueue_depth = RTE_MIN(p_evq->burst_write,
+				info.max_event_port_enqueue_depth);
+
+			status = rte_event_port_setup(0, port_id, &port_conf);
+			if (status < 0)
+				rte_panic("%s (%s) event port %" PRIu32
+					" init error (%d)\n",
+					p->name, p_evq->name,
+					(uint32_t) port_id, status);
+		}
+	}
+
+	status = rte_event_dev_start(0);
+	if (status < 0)
+		rte_panic("Event device 0 start error (%d)\n", status);
+
+	/* Software event devices are scheduled by the EAL service cores */
+	if (rte_service_lcore_count() > 0) {
+		status = rte_service_start_with_defaults();
+		if (status < 0)
+			rte_panic("Service cores start error (%d)\n",
+				status);
+	}
+}
+#endif /* RTE_LIBRTE_EVENTDEV */
+
 static void
 app_init_msgq(struct app_params *app)
 {
@@ -1335,6 +1513,7 @@ void app_pipeline_params_get(struct app_params *app,
 	struct app_pipeline_params *p_in,
 	struct pipeline_params *p_out)
 {
+	uint32_t pipeline_id = p_in - app->pipeline_params;
 	uint32_t i;
 
 	snprintf(p_out->name, PIPELINE_NAME_SIZE, "%s", p_in->name);
@@ -1463,6 +1642,17 @@ void app_pipeline_params_get(struct app_params *app,
 				app->source_params[in->id].n_bytes_per_pkt;
 			break;
 		}
+#ifdef RTE_LIBRTE_EVENTDEV
+		case APP_PKTQ_IN_EVQ:
+		{
+			out->type = PIPELINE_PORT_IN_EVENTDEV_READER;
+			out->params.eventdev.eventdev_id = 0;
+			out->params.eventdev.port_id =
+				app->evq_port_in[pipeline_id][i];
+			out->burst_size = app->evq_params[in->id].burst_read;
+			break;
+		}
+#endif /* RTE_LIBRTE_EVENTDEV */
 		default:
 			break;
 		}
@@ -1636,6 +1826,44 @@ void app_pipeline_params_get(struct app_params *app,
 
 			break;
 		}
+#ifdef RTE_LIBRTE_EVENTDEV
+		case APP_PKTQ_OUT_EVQ:
+		{
+			struct app_pktq_evq_params *p_evq =
+				&app->evq_params[in->id];
+
+			if (p_evq->dropless == 0) {
+				struct rte_port_eventdev_writer_params *params =
+					&out->params.eventdev;
+
+				out->type = PIPELINE_PORT_OUT_EVENTDEV_WRITER;
+				params->eventdev_id = 0;
+				params->port_id =
+					app->evq_port_out[pipeline_id][i];
+				params->queue_id = in->id;
+				params->sched_type = p_evq->sched_type;
+				params->evt_op = RTE_EVENT_OP_NEW;
+				params->flow_id_rss = 1;
+				params->enq_burst_sz = p_evq->burst_write;
+			} else {
+				struct rte_port_eventdev_writer_nodrop_params
+					*params = &out->params.eventdev_nodrop;
+
+				out->type =
+					PIPELINE_PORT_OUT_EVENTDEV_WRITER_NODROP;
+				params->eventdev_id = 0;
+				params->port_id =
+					app->evq_port_out[pipeline_id][i];
+				params->queue_id = in->id;
+				params->sched_type = p_evq->sched_type;
+				params->evt_op = RTE_EVENT_OP_NEW;
+				params->flow_id_rss = 1;
+				params->enq_burst_sz = p_evq->burst_write;
+				params->n_retries = p_evq->n_retries;
+			}
+			break;
+		}
+#endif /* RTE_LIBRTE_EVENTDEV */
 		default:
 			break;
 		}
@@ -1815,6 +2043,7 @@ int app_init(struct app_params *app)
 	app_init_tm(app);
 	app_init_tap(app);
 	app_init_kni(app);
+	app_init_evq(app);
 	app_init_msgq(app);
 
 	app_pipeline_common_cmd_push(app);
@@ -44,6 +44,9 @@
 #ifdef RTE_LIBRTE_KNI
 #include <rte_port_kni.h>
 #endif
+#ifdef RTE_LIBRTE_EVENTDEV
+#include <rte_port_eventdev.h>
+#endif
 #include <rte_pipeline.h>
 
 enum pipeline_port_in_type {
@@ -56,6 +59,7 @@ enum pipeline_port_in_type {
 	PIPELINE_PORT_IN_FD_READER,
 	PIPELINE_PORT_IN_KNI_READER,
 	PIPELINE_PORT_IN_SOURCE,
+	PIPELINE_PORT_IN_EVENTDEV_READER,
 };
 
 struct pipeline_port_in_params {
@@ -72,6 +76,9 @@ struct pipeline_port_in_params {
 		struct rte_port_kni_reader_params kni;
 #endif
 		struct rte_port_source_params source;
+#ifdef RTE_LIBRTE_EVENTDEV
+		struct rte_port_eventdev_reader_params eventdev;
+#endif
 	} params;
 	uint32_t burst_size;
 };
@@ -100,6 +107,10 @@ pipeline_port_in_params_convert(struct pipeline_port_in_params  *p)
 #endif
 	case PIPELINE_PORT_IN_SOURCE:
 		return (void *) &p->params.source;
+#ifdef RTE_LIBRTE_EVENTDEV
+	case PIPELINE_PORT_IN_EVENTDEV_READER:
+		return (void *) &p->params.eventdev;
+#endif
 	default:
 		return NULL;
 	}
@@ -129,6 +140,10 @@ pipeline_port_in_params_get_ops(struct pipeline_port_in_params  *p)
 #endif
 	case PIPELINE_PORT_IN_SOURCE:
 		return &rte_port_source_ops;
+#ifdef RTE_LIBRTE_EVENTDEV
+	case PIPELINE_PORT_IN_EVENTDEV_READER:
+		return &rte_port_eventdev_reader_ops;
+#endif
 	default:
 		return NULL;
 	}
@@ -148,6 +163,8 @@ enum pipeline_port_out_type {
 	PIPELINE_PORT_OUT_KNI_WRITER,
 	PIPELINE_PORT_OUT_KNI_WRITER_NODROP,
 	PIPELINE_PORT_OUT_SINK,
+	PIPELINE_PORT_OUT_EVENTDEV_WRITER,
+	PIPELINE_PORT_OUT_EVENTDEV_WRITER_NODROP,
 };
 
 struct pipeline_port_out_params {
@@ -168,6 +185,10 @@ struct pipeline_port_out_params {
 		struct rte_port_kni_writer_nodrop_params kni_nodrop;
 #endif
 		struct rte_port_sink_params sink;
+#ifdef RTE_LIBRTE_EVENTDEV
+		struct rte_port_eventdev_writer_params eventdev;
+		struct rte_port_eventdev_writer_nodrop_params eventdev_nodrop;
+#endif
 	} params;
 };
 
@@ -203,6 +224,12 @@ pipeline_port_out_params_convert(struct pipeline_port_out_params  *p)
 #endif
 	case PIPELINE_PORT_OUT_SINK:
 		return (void *) &p->params.sink;
+#ifdef RTE_LIBRTE_EVENTDEV
+	case PIPELINE_PORT_OUT_EVENTDEV_WRITER:
+		return (void *) &p->params.eventdev;
+	case PIPELINE_PORT_OUT_EVENTDEV_WRITER_NODROP:
+		return (void *) &p->params.eventdev_nodrop;
+#endif
 	default:
 		return NULL;
 	}
@@ -240,6 +267,12 @@ pipeline_port_out_params_get_ops(struct pipeline_port_out_params  *p)
 #endif
 	case PIPELINE_PORT_OUT_SINK:
 		return &rte_port_sink_ops;
+#ifdef RTE_LIBRTE_EVENTDEV
+	case PIPELINE_PORT_OUT_EVENTDEV_WRITER:
+		return &rte_port_eventdev_writer_ops;
+	case PIPELINE_PORT_OUT_EVENTDEV_WRITER_NODROP:
+		return &rte_port_eventdev_writer_nodrop_ops;
+#endif
 	default:
 		return NULL;
 	}
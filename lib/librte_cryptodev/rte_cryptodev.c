@@ -83,6 +83,11 @@ static struct rte_cryptodev_global cryptodev_globals = {
 
 struct rte_cryptodev_global *rte_cryptodev_globals = &cryptodev_globals;
 
+RTE_TRACE_POINT_DEFINE(rte_cryptodev_trace_enqueue_burst,
+	"lib.cryptodev.enqueue_burst", "dev_id", "qp_id", "nb_ops", "nb_enq");
+RTE_TRACE_POINT_DEFINE(rte_cryptodev_trace_dequeue_burst,
+	"lib.cryptodev.dequeue_burst", "dev_id", "qp_id", "nb_ops", "nb_deq");
+
 /* spinlock for crypto device callbacks */
 static rte_spinlock_t rte_cryptodev_cb_lock = RTE_SPINLOCK_INITIALIZER;
 
@@ -49,6 +49,7 @@ extern "C" {
 #include "rte_crypto.h"
 #include "rte_dev.h"
 #include <rte_common.h>
+#include <rte_trace.h>
 
 #define CRYPTODEV_NAME_NULL_PMD		crypto_null
 /**< Null crypto PMD device name */
@@ -777,6 +778,10 @@ struct rte_cryptodev_data {
 } __rte_cache_aligned;
 
 extern struct rte_cryptodev *rte_cryptodevs;
+
+RTE_TRACE_POINT_DECLARE(rte_cryptodev_trace_enqueue_burst);
+RTE_TRACE_POINT_DECLARE(rte_cryptodev_trace_dequeue_burst);
+
 /**
  *
  * Dequeue a burst of processed crypto operations from a queue on the crypto
@@ -819,10 +824,14 @@ rte_cryptodev_dequeue_burst(uint8_t dev_id, uint16_t qp_id,
 {
 	struct rte_cryptodev *dev = &rte_cryptodevs[dev_id];
 
-	nb_ops = (*dev->dequeue_burst)
+	uint16_t nb_deq = (*dev->dequeue_burst)
 			(dev->data->queue_pairs[qp_id], ops, nb_ops);
 
-	return nb_ops;
+	if (nb_deq != 0)
+		RTE_TRACE_POINT_EMIT(rte_cryptodev_trace_dequeue_burst,
+			dev_id, qp_id, nb_ops, nb_deq);
+
+	return nb_deq;
 }
 
 /**
@@ -861,9 +870,13 @@ rte_cryptodev_enqueue_burst(uint8_t dev_id, uint16_t qp_id,
 		struct rte_crypto_op **ops, uint16_t nb_ops)
 {
 	struct rte_cryptodev *dev = &rte_cryptodevs[dev_id];
-
-	return (*dev->enqueue_burst)(
+	uint16_t nb_enq = (*dev->enqueue_burst)(
 			dev->data->queue_pairs[qp_id], ops, nb_ops);
+
+	RTE_TRACE_POINT_EMIT(rte_cryptodev_trace_enqueue_burst, dev_id, qp_id,
+		nb_ops, nb_enq);
+
+	return nb_enq;
 }
 
 
@@ -58,6 +58,26 @@ EAL_REGISTER_TAILQ(rte_dist_burst_tailq)
 
 /**** Burst Packet APIs called by workers ****/
 
+/*
+ * Load aware mode: account the cycles the worker spent on the packets of
+ * its last burst, as a moving average of its cost per packet.
+ */
+static inline void
+update_cost(struct rte_distributor_buffer *buf)
+{
+	uint64_t cost;
+
+	if (buf->poll_count == 0)
+		return;
+
+	cost = (rte_rdtsc() - buf->poll_tsc) / buf->poll_count;
+	if (buf->cost == 0)
+		buf->cost = cost;
+	else
+		buf->cost = buf->cost - (buf->cost >> 3) + (cost >> 3);
+	buf->poll_count = 0;
+}
+
 void
 rte_distributor_request_pkt_v1705(struct rte_distributor *d,
 		unsigned int worker_id, struct rte_mbuf **oldpkt,
@@ -74,6 +94,9 @@ rte_distributor_request_pkt_v1705(struct rte_distributor *d,
 		return;
 	}
 
+	if (d->alg_type == RTE_DIST_ALG_BURST_LOAD_AWARE)
+		update_cost(buf);
+
 	retptr64 = &(buf->retptr64[0]);
 	/* Spin while handshake bits are set (scheduler clears it) */
 	while (unlikely(*retptr64 & RTE_DISTRIB_GET_BUF)) {
@@ -136,6 +159,11 @@ rte_distributor_poll_pkt_v1705(struct rte_distributor *d,
 		}
 	}
 
+	if (d->alg_type == RTE_DIST_ALG_BURST_LOAD_AWARE) {
+		buf->poll_tsc = rte_rdtsc();
+		buf->poll_count = count;
+	}
+
 	/*
 	 * so now we've got the contents of the cacheline into an  array of
 	 * mbuf pointers, so toggle the bit so scheduler can start working
@@ -200,6 +228,9 @@ rte_distributor_return_pkt_v1705(struct rte_distributor *d,
 			return -EINVAL;
 	}
 
+	if (d->alg_type == RTE_DIST_ALG_BURST_LOAD_AWARE)
+		update_cost(buf);
+
 	for (i = 0; i < RTE_DIST_BURST_SIZE; i++)
 		/* Switch off the return bit first */
 		buf->retptr64[i] &= ~RTE_DISTRIB_RETURN_BUF;
@@ -312,6 +343,8 @@ handle_returns(struct rte_distributor *d, unsigned int wkr)
 		}
 		d->returns.start = ret_start;
 		d->returns.count = ret_count;
+		if (d->alg_type == RTE_DIST_ALG_BURST_LOAD_AWARE)
+			d->wkr_cost[wkr] = buf->cost;
 		/* Clear for the worker to populate with more returns */
 		buf->retptr64[0] = 0;
 	}
@@ -346,6 +379,7 @@ release(struct rte_distributor *d, unsigned int wkr)
 		d->in_flight_tags[wkr][i] = d->backlog[wkr].tags[i];
 	}
 	buf->count = i;
+	d->wkr_in_flight[wkr] = i;
 	for ( ; i < RTE_DIST_BURST_SIZE ; i++) {
 		buf->bufptr64[i] = RTE_DISTRIB_GET_BUF;
 		d->in_flight_tags[wkr][i] = 0;
@@ -360,6 +394,103 @@ release(struct rte_distributor *d, unsigned int wkr)
 }
 
 
+/*
+ * Load aware mode: estimate in cycles of the work queued on a worker, i.e.
+ * its backlog plus the last burst released to it, unless it asked for more.
+ */
+static inline uint64_t
+worker_load(const struct rte_distributor *d, unsigned int wkr)
+{
+	unsigned int pending = d->backlog[wkr].count;
+
+	if (!(d->bufs[wkr].retptr64[0] & RTE_DISTRIB_GET_BUF))
+		pending += d->wkr_in_flight[wkr];
+
+	/* workers yet to report a cost are balanced on packet counts */
+	return (uint64_t)pending * (d->wkr_cost[wkr] + 1);
+}
+
+/* Load aware mode: pick the least loaded worker, round robin on ties */
+static inline unsigned int
+least_loaded_worker(const struct rte_distributor *d, const uint64_t *load,
+		unsigned int start)
+{
+	unsigned int i, wkr, best;
+
+	if (start >= d->num_workers)
+		start = 0;
+
+	best = start;
+	for (i = 0, wkr = start; i < d->num_workers; i++, wkr++) {
+		if (wkr >= d->num_workers)
+			wkr = 0;
+		if (load[wkr] < load[best])
+			best = wkr;
+	}
+	return best;
+}
+
+/*
+ * Load aware mode: when a worker is idle, i.e. waiting for packets with
+ * none in its backlog, hand it the flows queued on the busiest worker that
+ * are not in flight there. All the packets of a flow move together, so the
+ * flow order and atomicity are kept.
+ */
+static void
+migrate_flows(struct rte_distributor *d, unsigned int wkr)
+{
+	struct rte_distributor_backlog *dst = &d->backlog[wkr];
+	struct rte_distributor_backlog *src;
+	unsigned int i, k, n, busiest = wkr;
+	uint64_t load, max_load = 0;
+
+	if (dst->count != 0 ||
+			!(d->bufs[wkr].retptr64[0] & RTE_DISTRIB_GET_BUF))
+		return;
+
+	for (i = 0; i < d->num_workers; i++) {
+		if (i == wkr || d->backlog[i].count == 0 ||
+				(d->bufs[i].retptr64[0] & RTE_DISTRIB_GET_BUF))
+			continue;
+
+		load = worker_load(d, i);
+		if (load > max_load) {
+			max_load = load;
+			busiest = i;
+		}
+	}
+	if (busiest == wkr)
+		return;
+
+	src = &d->backlog[busiest];
+	for (i = 0, n = 0; i < src->count; i++) {
+		uint16_t tag = src->tags[i];
+
+		for (k = 0; k < RTE_DIST_BURST_SIZE; k++)
+			if (d->in_flight_tags[busiest][k] == tag)
+				break;
+
+		if (k < RTE_DIST_BURST_SIZE) {
+			/* in flight on the busy worker, so it stays there */
+			src->tags[n] = tag;
+			src->pkts[n++] = src->pkts[i];
+		} else {
+			dst->tags[dst->count] = tag;
+			dst->pkts[dst->count++] = src->pkts[i];
+		}
+	}
+
+	/*
+	 * The matchers compare all the backlog tags, not only the first
+	 * count ones: clear the tags left behind, so that the next packets
+	 * of the migrated flows do not match the busy worker too.
+	 */
+	if (n != src->count)
+		for (i = n; i < RTE_DIST_BURST_SIZE; i++)
+			src->tags[i] = 0;
+	src->count = n;
+}
+
 /* process a set of packets to distribute them to workers */
 int
 rte_distributor_process_v1705(struct rte_distributor *d,
@@ -371,17 +502,23 @@ rte_distributor_process_v1705(struct rte_distributor *d,
 	int64_t next_value = 0;
 	uint16_t new_tag = 0;
 	uint16_t flows[RTE_DIST_BURST_SIZE] __rte_cache_aligned;
+	uint64_t load[RTE_DISTRIB_MAX_WORKERS];
 	unsigned int i, j, w, wid;
+	int load_aware;
 
 	if (d->alg_type == RTE_DIST_ALG_SINGLE) {
 		/* Call the old API */
 		return rte_distributor_process_v20(d->d_v20, mbufs, num_mbufs);
 	}
 
+	load_aware = (d->alg_type == RTE_DIST_ALG_BURST_LOAD_AWARE);
+
 	if (unlikely(num_mbufs == 0)) {
 		/* Flush out all non-full cache-lines to workers. */
 		for (wid = 0 ; wid < d->num_workers; wid++) {
 			if ((d->bufs[wid].bufptr64[0] & RTE_DISTRIB_GET_BUF)) {
+				if (load_aware)
+					migrate_flows(d, wid);
 				release(d, wid);
 				handle_returns(d, wid);
 			}
@@ -389,10 +526,17 @@ rte_distributor_process_v1705(struct rte_distributor *d,
 		return 0;
 	}
 
+	if (load_aware)
+		for (wid = 0; wid < d->num_workers; wid++)
+			load[wid] = worker_load(d, wid);
+
 	while (next_idx < num_mbufs) {
 		uint16_t matches[RTE_DIST_BURST_SIZE];
 		unsigned int pkts;
 
+		if (load_aware)
+			wkr = least_loaded_worker(d, load, wkr);
+
 		if (d->bufs[wkr].bufptr64[0] & RTE_DISTRIB_GET_BUF)
 			d->bufs[wkr].count = 0;
 
@@ -459,6 +603,9 @@ rte_distributor_process_v1705(struct rte_distributor *d,
 
 				bl->tags[idx] = new_tag;
 				bl->pkts[idx] = next_value;
+				if (load_aware)
+					load[matches[j]-1] +=
+						d->wkr_cost[matches[j]-1] + 1;
 
 			} else {
 				struct rte_distributor_backlog *bl =
@@ -473,6 +620,8 @@ rte_distributor_process_v1705(struct rte_distributor *d,
 
 				bl->tags[idx] = new_tag;
 				bl->pkts[idx] = next_value;
+				if (load_aware)
+					load[wkr] += d->wkr_cost[wkr] + 1;
 				/*
 				 * Now that we've just added an unpinned flow
 				 * to a worker, we need to ensure that all
@@ -491,8 +640,11 @@ rte_distributor_process_v1705(struct rte_distributor *d,
 
 	/* Flush out all non-full cache-lines to workers. */
 	for (wid = 0 ; wid < d->num_workers; wid++)
-		if ((d->bufs[wid].bufptr64[0] & RTE_DISTRIB_GET_BUF))
+		if ((d->bufs[wid].bufptr64[0] & RTE_DISTRIB_GET_BUF)) {
+			if (load_aware)
+				migrate_flows(d, wid);
 			release(d, wid);
+		}
 
 	return num_mbufs;
 }
@@ -670,6 +822,14 @@ rte_distributor_create_v1705(const char *name,
 	for (i = 0 ; i < num_workers ; i++)
 		d->backlog[i].tags = &d->in_flight_tags[i][RTE_DIST_BURST_SIZE];
 
+	/* No cost reported yet for the load aware mode */
+	for (i = 0 ; i < num_workers ; i++) {
+		d->bufs[i].cost = 0;
+		d->bufs[i].poll_count = 0;
+		d->wkr_cost[i] = 0;
+		d->wkr_in_flight[i] = 0;
+	}
+
 	dist_burst_list = RTE_TAILQ_CAST(rte_dist_burst_tailq.head,
 					  rte_dist_burst_list);
 
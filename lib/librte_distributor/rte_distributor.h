@@ -45,10 +45,11 @@
 extern "C" {
 #endif
 
-/* Type of distribution (burst/single) */
+/* Type of distribution (burst/single/burst with load aware selection) */
 enum rte_distributor_alg_type {
 	RTE_DIST_ALG_BURST = 0,
 	RTE_DIST_ALG_SINGLE,
+	RTE_DIST_ALG_BURST_LOAD_AWARE,
 	RTE_DIST_NUM_ALG_TYPES
 };
 
@@ -72,6 +73,11 @@ struct rte_mbuf;
  *   Call the legacy API, or use the new burst API. legacy uses 32-bit
  *   flow ID, and works on a single packet at a time. Latest uses 15-
  *   bit flow ID and works on up to 8 packets at a time to worers.
+ *   RTE_DIST_ALG_BURST_LOAD_AWARE is the burst API where new flows go to
+ *   the worker with the least work queued, estimated from the packets
+ *   given to it and its processing cost, measured by the worker API as
+ *   the cycles between receiving packets and returning them. Queued flows
+ *   not yet in flight on a busy worker also migrate to idle workers.
  * @return
  *   The newly created distributor instance
  */
@@ -142,7 +142,8 @@ enum rte_distributor_match_function {
  * prefetches of buffers for other workers, e.g. when worker 1's buffer is on
  * the next cache line to worker 0, we pad this out to two cache lines.
  * We can pass up to 8 mbufs at a time in one cacheline.
- * There is a separate cacheline for returns in the burst API.
+ * There is a separate cacheline for returns in the burst API, followed by
+ * the one where the worker accounts for its processing cost.
  */
 struct rte_distributor_buffer {
 	volatile int64_t bufptr64[RTE_DIST_BURST_SIZE]
@@ -153,7 +154,9 @@ struct rte_distributor_buffer {
 	volatile int64_t retptr64[RTE_DIST_BURST_SIZE]
 		__rte_cache_aligned; /* <= incoming from worker */
 
-	int64_t pad2 __rte_cache_aligned;    /* <= one cache line  */
+	volatile uint64_t cost __rte_cache_aligned; /* <= cycles per packet */
+	uint64_t poll_tsc;                   /* <= when last burst was polled */
+	unsigned int poll_count;             /* <= size of last burst polled */
 
 	int count __rte_cache_aligned;       /* <= number of current mbufs */
 };
@@ -182,6 +185,13 @@ struct rte_distributor {
 
 	enum rte_distributor_match_function dist_match_fn;
 
+	/**
+	 * Load aware mode: cost of each worker in cycles per packet, as last
+	 * reported, and number of packets of the last burst released to it.
+	 */
+	uint64_t wkr_cost[RTE_DISTRIB_MAX_WORKERS] __rte_cache_aligned;
+	unsigned int wkr_in_flight[RTE_DISTRIB_MAX_WORKERS];
+
 	struct rte_distributor_v20 *d_v20;
 };
 
@@ -567,6 +567,8 @@ rte_eal_init(int argc, char **argv)
 
 	rte_config_init();
 
+	eal_lcore_var_bind();
+
 	if (rte_eal_memory_init() < 0) {
 		rte_eal_init_alert("Cannot init memory\n");
 		rte_errno = ENOMEM;
@@ -596,6 +598,12 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
+	if (internal_config.log_async && rte_log_async_start() < 0) {
+		rte_eal_init_alert("Cannot start asynchronous log\n");
+		rte_errno = ENOMEM;
+		return -1;
+	}
+
 	if (rte_eal_timer_init() < 0) {
 		rte_eal_init_alert("Cannot init HPET or TSC timers\n");
 		rte_errno = ENOTSUP;
@@ -621,7 +629,11 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
-	RTE_LCORE_FOREACH_SLAVE(i) {
+	/* service lcores get a thread too, they run the service loop */
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (i == (int)rte_config.master_lcore ||
+				rte_config.lcore_role[i] == ROLE_OFF)
+			continue;
 
 		/*
 		 * create communication pipes between master thread
@@ -653,6 +665,18 @@ rte_eal_init(int argc, char **argv)
 	rte_eal_mp_remote_launch(sync_func, NULL, SKIP_MASTER);
 	rte_eal_mp_wait_lcore();
 
+	if (rte_trace_init() < 0) {
+		rte_eal_init_alert("Cannot init trace\n");
+		rte_errno = ENOMEM;
+		return -1;
+	}
+
+	if (rte_service_init() < 0) {
+		rte_eal_init_alert("Cannot init services\n");
+		rte_errno = ENOTSUP;
+		return -1;
+	}
+
 	/* Probe all the buses and devices/drivers on them */
 	if (rte_bus_probe()) {
 		rte_eal_init_alert("Cannot probe devices\n");
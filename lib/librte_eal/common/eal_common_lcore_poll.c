@@ -0,0 +1,102 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_lcore_var.h>
+#include <rte_lcore_poll.h>
+
+#include "eal_private.h"
+
+RTE_LCORE_VAR_HANDLE(struct rte_lcore_poll_state, rte_lcore_poll_states);
+RTE_LCORE_VAR_INIT(rte_lcore_poll_states);
+
+volatile int rte_lcore_poll_enabled;
+
+int
+rte_lcore_poll_stats_enable(int enable)
+{
+#ifdef RTE_LCORE_POLL_STATS
+	rte_lcore_poll_enabled = !!enable;
+	return 0;
+#else
+	RTE_SET_USED(enable);
+	return -ENOTSUP;
+#endif
+}
+
+int
+rte_lcore_poll_stats_get(unsigned int lcore_id,
+		struct rte_lcore_poll_stats *stats)
+{
+#ifdef RTE_LCORE_POLL_STATS
+	const struct rte_lcore_poll_state *state;
+	uint64_t last_tsc;
+
+	if (lcore_id >= RTE_MAX_LCORE || stats == NULL)
+		return -EINVAL;
+
+	state = RTE_LCORE_VAR_LCORE(lcore_id, rte_lcore_poll_states);
+	*stats = state->stats;
+	/* add the cycles since the last mark of a running loop */
+	last_tsc = state->last_tsc;
+	if (last_tsc != 0) {
+		if (state->busy)
+			stats->busy_cycles += rte_rdtsc() - last_tsc;
+		else
+			stats->idle_cycles += rte_rdtsc() - last_tsc;
+	}
+
+	return 0;
+#else
+	RTE_SET_USED(lcore_id);
+	RTE_SET_USED(stats);
+	return -ENOTSUP;
+#endif
+}
+
+void
+eal_lcore_poll_stop(unsigned int lcore_id)
+{
+	struct rte_lcore_poll_state *state =
+		RTE_LCORE_VAR_LCORE(lcore_id, rte_lcore_poll_states);
+
+	if (state->last_tsc == 0)
+		return;
+	__rte_lcore_poll_account(state, rte_rdtsc());
+	state->last_tsc = 0;
+}
@@ -0,0 +1,212 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/queue.h>
+#ifdef RTE_EXEC_ENV_LINUXAPP
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_spinlock.h>
+#include <rte_eal.h>
+#include <rte_lcore_var.h>
+
+#include "eal_private.h"
+#include "eal_thread.h"
+
+#ifndef MAP_NORESERVE
+#define MAP_NORESERVE 0
+#endif
+
+#define LCORE_VAR_BUFFER_SIZE ((size_t)RTE_MAX_LCORE_VAR * RTE_MAX_LCORE)
+
+/* a buffer allocated before the lcores are known, to bind at init */
+struct lcore_var_buffer {
+	STAILQ_ENTRY(lcore_var_buffer) next;
+	void *addr;
+};
+
+static STAILQ_HEAD(, lcore_var_buffer) unbound_buffers =
+	STAILQ_HEAD_INITIALIZER(unbound_buffers);
+
+/* the buffer where the next variables are allocated */
+static void *lcore_buffer;
+/* offset of the next free byte in each lcore block of the buffer */
+static size_t lcore_offset;
+/* set once the blocks of the new buffers can be bound at allocation */
+static int lcore_var_bound;
+static rte_spinlock_t lcore_var_lock = RTE_SPINLOCK_INITIALIZER;
+
+/*
+ * Set the memory policy of the block of each enabled lcore to prefer the
+ * NUMA socket of the lcore, moving the pages already touched. The
+ * blocks are page aligned, as RTE_MAX_LCORE_VAR is a multiple of the
+ * page size. On failure, e.g. without NUMA support in the kernel, the
+ * pages stay placed by the default first touch policy.
+ */
+static void
+lcore_var_buffer_bind(void *buffer)
+{
+#ifdef RTE_EXEC_ENV_LINUXAPP
+	struct rte_config *cfg = rte_eal_get_configuration();
+	unsigned long nodemask;
+	unsigned int lcore_id;
+	int socket_id;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (cfg->lcore_role[lcore_id] == ROLE_OFF)
+			continue;
+		socket_id = eal_cpuset_socket_id(
+			&lcore_config[lcore_id].cpuset);
+		if (socket_id < 0 ||
+				socket_id >= (int)sizeof(nodemask) * CHAR_BIT)
+			continue;
+
+		nodemask = 1UL << socket_id;
+		if (syscall(__NR_mbind,
+				RTE_PTR_ADD(buffer, lcore_id * RTE_MAX_LCORE_VAR),
+				RTE_MAX_LCORE_VAR, MPOL_PREFERRED, &nodemask,
+				sizeof(nodemask) * CHAR_BIT, MPOL_MF_MOVE) != 0) {
+			RTE_LOG(DEBUG, EAL, "Cannot bind lcore %u variables "
+				"to socket %d\n", lcore_id, socket_id);
+			return;
+		}
+	}
+#else
+	RTE_SET_USED(buffer);
+#endif
+}
+
+/*
+ * Allocate a buffer of RTE_MAX_LCORE blocks. The pages are not touched
+ * here, so that the blocks of the unused lcores are never backed. Once
+ * the lcores are known, the blocks are bound to the socket of their
+ * lcore, otherwise the buffer is recorded to be bound at init.
+ */
+static void *
+lcore_var_buffer_alloc(void)
+{
+	struct lcore_var_buffer *unbound = NULL;
+	void *buffer;
+
+	if (!lcore_var_bound) {
+		unbound = malloc(sizeof(*unbound));
+		if (unbound == NULL) {
+			RTE_LOG(ERR, EAL, "Cannot allocate lcore variables "
+				"buffer entry\n");
+			return NULL;
+		}
+	}
+
+	buffer = mmap(NULL, LCORE_VAR_BUFFER_SIZE, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (buffer == MAP_FAILED) {
+		RTE_LOG(ERR, EAL, "Cannot map %zu bytes for lcore variables\n",
+			LCORE_VAR_BUFFER_SIZE);
+		free(unbound);
+		return NULL;
+	}
+
+	if (unbound != NULL) {
+		unbound->addr = buffer;
+		STAILQ_INSERT_TAIL(&unbound_buffers, unbound, next);
+	} else {
+		lcore_var_buffer_bind(buffer);
+	}
+
+	return buffer;
+}
+
+void
+eal_lcore_var_bind(void)
+{
+	struct lcore_var_buffer *unbound;
+
+	rte_spinlock_lock(&lcore_var_lock);
+	while (!STAILQ_EMPTY(&unbound_buffers)) {
+		unbound = STAILQ_FIRST(&unbound_buffers);
+		STAILQ_REMOVE_HEAD(&unbound_buffers, next);
+		lcore_var_buffer_bind(unbound->addr);
+		free(unbound);
+	}
+	lcore_var_bound = 1;
+	rte_spinlock_unlock(&lcore_var_lock);
+}
+
+void *
+rte_lcore_var_alloc(size_t size, size_t align)
+{
+	void *handle = NULL;
+	size_t offset;
+
+	if (align == 0)
+		align = RTE_CACHE_LINE_SIZE;
+	if (size == 0 || size > RTE_MAX_LCORE_VAR ||
+			!rte_is_power_of_2(align) ||
+			align > (size_t)sysconf(_SC_PAGESIZE)) {
+		RTE_LOG(ERR, EAL, "Invalid lcore variable size %zu, align %zu\n",
+			size, align);
+		return NULL;
+	}
+
+	rte_spinlock_lock(&lcore_var_lock);
+
+	offset = RTE_ALIGN_CEIL(lcore_offset, align);
+	if (lcore_buffer == NULL || offset + size > RTE_MAX_LCORE_VAR) {
+		/* the end of the current buffer is lost */
+		void *buffer = lcore_var_buffer_alloc();
+
+		if (buffer == NULL)
+			goto out;
+		lcore_buffer = buffer;
+		offset = 0;
+	}
+	handle = RTE_PTR_ADD(lcore_buffer, offset);
+	lcore_offset = offset + size;
+
+out:
+	rte_spinlock_unlock(&lcore_var_lock);
+	if (handle != NULL)
+		RTE_LOG(DEBUG, EAL, "Allocated %zu bytes lcore variable %p\n",
+			size, handle);
+
+	return handle;
+}
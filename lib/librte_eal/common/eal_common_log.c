@@ -38,10 +38,19 @@
 #include <string.h>
 #include <errno.h>
 #include <regex.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <pthread.h>
 
 #include <rte_eal.h>
 #include <rte_log.h>
 #include <rte_per_lcore.h>
+#include <rte_lcore.h>
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_spinlock.h>
+#include <rte_branch_prediction.h>
 
 #include "eal_private.h"
 
@@ -67,8 +76,42 @@ struct log_cur_msg {
 struct rte_log_dynamic_type {
 	const char *name;
 	uint32_t loglevel;
+	uint32_t rate;             /* max messages per second, 0 if no limit */
+	rte_atomic64_t window;     /* start of the current second, TSC cycles */
+	rte_atomic32_t count;      /* messages output in the current second */
+	rte_atomic32_t missed;     /* messages dropped in the current second */
+	rte_atomic64_t suppressed; /* messages dropped by the rate limit */
 };
 
+#define LOG_ASYNC_RING_SIZE RTE_LOG_ASYNC_RING_SIZE
+#define LOG_ASYNC_RING_MASK (LOG_ASYNC_RING_SIZE - 1)
+/* sleep time of the control thread when the rings are empty */
+#define LOG_ASYNC_POLL_US 1000
+
+/* a message formatted by a lcore */
+struct log_async_record {
+	uint32_t level;
+	uint32_t logtype;
+	uint32_t len;
+	char msg[RTE_LOG_ASYNC_MSG_SIZE];
+};
+
+/* single producer (the lcore), single consumer (the control thread) */
+struct log_async_ring {
+	volatile uint32_t head __rte_cache_aligned; /* written by the lcore */
+	volatile uint64_t dropped;  /* messages dropped, ring full */
+	volatile uint32_t tail __rte_cache_aligned; /* written by the drain */
+	uint64_t reported;          /* dropped messages already reported */
+	struct log_async_record records[LOG_ASYNC_RING_SIZE];
+};
+
+static struct log_async_ring *log_async_rings[RTE_MAX_LCORE];
+static volatile int log_async_enabled;
+static volatile int log_async_running;
+static pthread_t log_async_thread;
+/* serializes the drain of the rings by the thread and the flush */
+static rte_spinlock_t log_async_lock = RTE_SPINLOCK_INITIALIZER;
+
  /* per core log */
 static RTE_DEFINE_PER_LCORE(struct log_cur_msg, log_cur_msg);
 
@@ -173,6 +216,85 @@ rte_log_set_level_regexp(const char *pattern, uint32_t level)
 	return 0;
 }
 
+int
+rte_log_set_rate_limit(uint32_t type, uint32_t rate)
+{
+	if (type >= rte_logs.dynamic_types_len)
+		return -1;
+
+	rte_logs.dynamic_types[type].rate = rate;
+
+	return 0;
+}
+
+int
+rte_log_set_rate_limit_regexp(const char *pattern, uint32_t rate)
+{
+	regex_t r;
+	size_t i;
+
+	if (regcomp(&r, pattern, 0) != 0)
+		return -1;
+
+	for (i = 0; i < rte_logs.dynamic_types_len; i++) {
+		if (rte_logs.dynamic_types[i].name == NULL)
+			continue;
+		if (regexec(&r, rte_logs.dynamic_types[i].name, 0,
+				NULL, 0) == 0)
+			rte_logs.dynamic_types[i].rate = rate;
+	}
+	regfree(&r);
+
+	return 0;
+}
+
+uint64_t
+rte_log_get_suppressed(uint32_t type)
+{
+	if (type >= rte_logs.dynamic_types_len)
+		return 0;
+
+	return rte_atomic64_read(&rte_logs.dynamic_types[type].suppressed);
+}
+
+/*
+ * Check the rate limit of a log type. Return 0 if the message must be
+ * dropped. When a new second starts, *missed is set to the number of
+ * messages dropped during the previous one.
+ */
+static int
+log_rate_allow(struct rte_log_dynamic_type *t, uint32_t *missed)
+{
+	uint64_t hz, now, window;
+
+	*missed = 0;
+	if (likely(t->rate == 0))
+		return 1;
+
+	/* no limit until the TSC frequency is known */
+	hz = rte_get_tsc_hz();
+	if (hz == 0)
+		return 1;
+
+	now = rte_get_tsc_cycles();
+	window = rte_atomic64_read(&t->window);
+	if (now - window >= hz &&
+			rte_atomic64_cmpset((volatile uint64_t *)&t->window.cnt,
+				window, now)) {
+		*missed = rte_atomic32_read(&t->missed);
+		rte_atomic32_sub(&t->missed, *missed);
+		rte_atomic32_set(&t->count, 0);
+	}
+
+	if ((uint32_t)rte_atomic32_add_return(&t->count, 1) > t->rate) {
+		rte_atomic32_inc(&t->missed);
+		rte_atomic64_inc(&t->suppressed);
+		return 0;
+	}
+
+	return 1;
+}
+
 /* get the current loglevel for the message beeing processed */
 int rte_log_cur_msg_loglevel(void)
 {
@@ -211,6 +333,8 @@ __rte_log_register(const char *name, int id)
 	if (dup_name == NULL)
 		return -ENOMEM;
 
+	memset(&rte_logs.dynamic_types[id], 0,
+		sizeof(rte_logs.dynamic_types[id]));
 	rte_logs.dynamic_types[id].name = dup_name;
 	rte_logs.dynamic_types[id].loglevel = RTE_LOG_DEBUG;
 
@@ -334,21 +458,35 @@ rte_log_dump(FILE *f)
 	for (i = 0; i < rte_logs.dynamic_types_len; i++) {
 		if (rte_logs.dynamic_types[i].name == NULL)
 			continue;
-		fprintf(f, "id %zu: %s, level is %s\n",
+		fprintf(f, "id %zu: %s, level is %s",
 			i, rte_logs.dynamic_types[i].name,
 			loglevel_to_string(rte_logs.dynamic_types[i].loglevel));
+		if (rte_logs.dynamic_types[i].rate != 0)
+			fprintf(f, ", rate limit %u/s, %"PRIu64" suppressed",
+				rte_logs.dynamic_types[i].rate,
+				rte_log_get_suppressed(i));
+		fprintf(f, "\n");
+	}
+
+	if (!log_async_enabled)
+		return;
+
+	fprintf(f, "asynchronous log is enabled\n");
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (log_async_rings[i] == NULL)
+			continue;
+		fprintf(f, "lcore %zu: %u pending, %"PRIu64" dropped\n", i,
+			log_async_rings[i]->head - log_async_rings[i]->tail,
+			log_async_rings[i]->dropped);
 	}
 }
 
-/*
- * Generates a log message The message will be sent in the stream
- * defined by the previous call to rte_openlog_stream().
- */
-int
-rte_vlog(uint32_t level, uint32_t logtype, const char *format, va_list ap)
+/* the stream where the messages are written */
+static FILE *
+log_stream(void)
 {
-	int ret;
 	FILE *f = rte_logs.file;
+
 	if (f == NULL) {
 		f = default_log_stream;
 		if (f == NULL) {
@@ -363,22 +501,263 @@ rte_vlog(uint32_t level, uint32_t logtype, const char *format, va_list ap)
 		}
 	}
 
-	if (level > rte_logs.level)
+	return f;
+}
+
+/*
+ * Format a message in the ring of the calling lcore. Return -ENOENT if
+ * the lcore has no ring, the message must then be written synchronously.
+ */
+static int
+log_async_enqueue(uint32_t level, uint32_t logtype, const char *format,
+		va_list ap)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	struct log_async_ring *ring;
+	struct log_async_record *rec;
+	uint32_t head;
+	int ret;
+
+	if (lcore_id >= RTE_MAX_LCORE)
+		return -ENOENT;
+	ring = log_async_rings[lcore_id];
+	if (ring == NULL)
+		return -ENOENT;
+
+	head = ring->head;
+	if (head - ring->tail >= LOG_ASYNC_RING_SIZE) {
+		ring->dropped++;
+		return -ENOBUFS;
+	}
+
+	rec = &ring->records[head & LOG_ASYNC_RING_MASK];
+	ret = vsnprintf(rec->msg, sizeof(rec->msg), format, ap);
+	if (ret < 0)
+		return ret;
+	rec->level = level;
+	rec->logtype = logtype;
+	rec->len = RTE_MIN((uint32_t)ret, (uint32_t)sizeof(rec->msg) - 1);
+
+	/* the record must be written before it is published */
+	rte_smp_wmb();
+	ring->head = head + 1;
+
+	return ret;
+}
+
+/* write the messages of all the rings, return their number */
+static unsigned int
+log_async_drain(void)
+{
+	struct log_async_ring *ring;
+	struct log_async_record *rec;
+	unsigned int lcore_id;
+	unsigned int count = 0;
+	uint64_t dropped;
+	uint32_t tail;
+	FILE *f;
+
+	rte_spinlock_lock(&log_async_lock);
+	f = log_stream();
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		ring = log_async_rings[lcore_id];
+		if (ring == NULL)
+			continue;
+
+		tail = ring->tail;
+		while (tail != ring->head) {
+			rte_smp_rmb();
+			rec = &ring->records[tail & LOG_ASYNC_RING_MASK];
+			/* for the stream, see rte_log_cur_msg_loglevel() */
+			RTE_PER_LCORE(log_cur_msg).loglevel = rec->level;
+			RTE_PER_LCORE(log_cur_msg).logtype = rec->logtype;
+			fwrite(rec->msg, 1, rec->len, f);
+			fflush(f);
+			/* the record must be read before it is released */
+			rte_smp_rmb();
+			ring->tail = ++tail;
+			count++;
+		}
+
+		dropped = ring->dropped;
+		if (dropped != ring->reported) {
+			RTE_PER_LCORE(log_cur_msg).loglevel = RTE_LOG_WARNING;
+			RTE_PER_LCORE(log_cur_msg).logtype = RTE_LOGTYPE_EAL;
+			fprintf(f, "EAL: %"PRIu64" log messages dropped on "
+				"lcore %u\n", dropped - ring->reported,
+				lcore_id);
+			fflush(f);
+			ring->reported = dropped;
+		}
+	}
+
+	rte_spinlock_unlock(&log_async_lock);
+	return count;
+}
+
+static void *
+log_async_thread_main(__attribute__((unused)) void *arg)
+{
+	while (log_async_running) {
+		if (log_async_drain() == 0)
+			usleep(LOG_ASYNC_POLL_US);
+	}
+
+	return NULL;
+}
+
+int
+rte_log_async_start(void)
+{
+	static int atexit_registered;
+	struct log_async_ring *ring;
+	unsigned int lcore_id;
+	int ret;
+
+	RTE_BUILD_BUG_ON((LOG_ASYNC_RING_SIZE & LOG_ASYNC_RING_MASK) != 0);
+
+	if (log_async_enabled)
 		return 0;
-	if (logtype >= rte_logs.dynamic_types_len)
-		return -1;
-	if (level > rte_logs.dynamic_types[logtype].loglevel)
+
+	/* the rings are kept when the backend is stopped */
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (log_async_rings[lcore_id] != NULL ||
+				rte_eal_lcore_role(lcore_id) == ROLE_OFF)
+			continue;
+		ring = rte_zmalloc_socket("log_async_ring", sizeof(*ring),
+			RTE_CACHE_LINE_SIZE, rte_lcore_to_socket_id(lcore_id));
+		if (ring == NULL) {
+			RTE_LOG(ERR, EAL, "Cannot allocate log ring of "
+				"lcore %u\n", lcore_id);
+			return -ENOMEM;
+		}
+		log_async_rings[lcore_id] = ring;
+	}
+
+	log_async_running = 1;
+	ret = pthread_create(&log_async_thread, NULL, log_async_thread_main,
+		NULL);
+	if (ret != 0) {
+		log_async_running = 0;
+		RTE_LOG(ERR, EAL, "Cannot create log thread\n");
+		return -ret;
+	}
+	if (rte_thread_setname(log_async_thread, "log-async") != 0)
+		RTE_LOG(DEBUG, EAL, "Cannot set name for log thread\n");
+
+	/* do not lose the pending messages on exit */
+	if (!atexit_registered) {
+		atexit(rte_log_async_flush);
+		atexit_registered = 1;
+	}
+
+	rte_smp_wmb();
+	log_async_enabled = 1;
+
+	return 0;
+}
+
+void
+rte_log_async_stop(void)
+{
+	if (!log_async_enabled)
+		return;
+
+	log_async_enabled = 0;
+	rte_smp_mb();
+	log_async_running = 0;
+	pthread_join(log_async_thread, NULL);
+
+	log_async_drain();
+}
+
+void
+rte_log_async_flush(void)
+{
+	if (log_async_enabled)
+		log_async_drain();
+}
+
+int
+rte_log_async_is_enabled(void)
+{
+	return log_async_enabled;
+}
+
+uint64_t
+rte_log_async_dropped(unsigned int lcore_id)
+{
+	if (lcore_id >= RTE_MAX_LCORE || log_async_rings[lcore_id] == NULL)
 		return 0;
 
+	return log_async_rings[lcore_id]->dropped;
+}
+
+/* write a message, in the ring of the lcore or synchronously */
+static int
+log_output(uint32_t level, uint32_t logtype, const char *format, va_list ap)
+{
+	FILE *f;
+	int ret;
+
+	/* urgent messages may precede an abort, do not defer them */
+	if (log_async_enabled && level > RTE_LOG_CRIT) {
+		ret = log_async_enqueue(level, logtype, format, ap);
+		if (ret != -ENOENT)
+			return ret;
+	}
+
 	/* save loglevel and logtype in a global per-lcore variable */
 	RTE_PER_LCORE(log_cur_msg).loglevel = level;
 	RTE_PER_LCORE(log_cur_msg).logtype = logtype;
 
+	f = log_stream();
 	ret = vfprintf(f, format, ap);
 	fflush(f);
 	return ret;
 }
 
+static int
+log_output_fmt(uint32_t level, uint32_t logtype, const char *format, ...)
+{
+	va_list ap;
+	int ret;
+
+	va_start(ap, format);
+	ret = log_output(level, logtype, format, ap);
+	va_end(ap);
+	return ret;
+}
+
+/*
+ * Generates a log message The message will be sent in the stream
+ * defined by the previous call to rte_openlog_stream().
+ */
+int
+rte_vlog(uint32_t level, uint32_t logtype, const char *format, va_list ap)
+{
+	struct rte_log_dynamic_type *t;
+	uint32_t missed;
+
+	if (level > rte_logs.level)
+		return 0;
+	if (logtype >= rte_logs.dynamic_types_len)
+		return -1;
+	t = &rte_logs.dynamic_types[logtype];
+	if (level > t->loglevel)
+		return 0;
+
+	if (!log_rate_allow(t, &missed))
+		return 0;
+	if (unlikely(missed != 0))
+		log_output_fmt(level, logtype,
+			"%u messages of log type %s suppressed\n",
+			missed, t->name);
+
+	return log_output(level, logtype, format, ap);
+}
+
 /*
  * Generates a log message The message will be sent in the stream
  * defined by the previous call to rte_openlog_stream().
@@ -54,6 +54,7 @@
 #include "eal_internal_cfg.h"
 #include "eal_options.h"
 #include "eal_filesystem.h"
+#include "eal_private.h"
 
 #define BITS_PER_HEX 4
 
@@ -67,6 +68,7 @@ eal_short_options[] =
 	"m:" /* memory size */
 	"n:" /* memory channels */
 	"r:" /* memory ranks */
+	"s:" /* service coremask */
 	"v"  /* version */
 	"w:" /* pci-whitelist */
 	;
@@ -78,9 +80,12 @@ eal_long_options[] = {
 	{OPT_FILE_PREFIX,       1, NULL, OPT_FILE_PREFIX_NUM      },
 	{OPT_HELP,              0, NULL, OPT_HELP_NUM             },
 	{OPT_HUGE_DIR,          1, NULL, OPT_HUGE_DIR_NUM         },
+	{OPT_HUGE_INIT_THREADS, 1, NULL, OPT_HUGE_INIT_THREADS_NUM},
 	{OPT_HUGE_UNLINK,       0, NULL, OPT_HUGE_UNLINK_NUM      },
 	{OPT_LCORES,            1, NULL, OPT_LCORES_NUM           },
+	{OPT_LOG_ASYNC,         0, NULL, OPT_LOG_ASYNC_NUM        },
 	{OPT_LOG_LEVEL,         1, NULL, OPT_LOG_LEVEL_NUM        },
+	{OPT_LOG_RATE,          1, NULL, OPT_LOG_RATE_NUM         },
 	{OPT_MASTER_LCORE,      1, NULL, OPT_MASTER_LCORE_NUM     },
 	{OPT_NO_HPET,           0, NULL, OPT_NO_HPET_NUM          },
 	{OPT_NO_HUGE,           0, NULL, OPT_NO_HUGE_NUM          },
@@ -91,6 +96,7 @@ eal_long_options[] = {
 	{OPT_PROC_TYPE,         1, NULL, OPT_PROC_TYPE_NUM        },
 	{OPT_SOCKET_MEM,        1, NULL, OPT_SOCKET_MEM_NUM       },
 	{OPT_SYSLOG,            1, NULL, OPT_SYSLOG_NUM           },
+	{OPT_TRACE,             1, NULL, OPT_TRACE_NUM            },
 	{OPT_VDEV,              1, NULL, OPT_VDEV_NUM             },
 	{OPT_VFIO_INTR,         1, NULL, OPT_VFIO_INTR_NUM        },
 	{OPT_VMWARE_TSC_MAP,    0, NULL, OPT_VMWARE_TSC_MAP_NUM   },
@@ -128,6 +134,9 @@ static int master_lcore_parsed;
 static int mem_parsed;
 static int core_parsed;
 
+/* lcores given with -s, their role is set once all options are parsed */
+static uint8_t service_lcores[RTE_MAX_LCORE];
+
 void
 eal_reset_internal_config(struct internal_config *internal_cfg)
 {
@@ -146,8 +155,10 @@ eal_reset_internal_config(struct internal_config *internal_cfg)
 	for (i = 0; i < MAX_HUGEPAGE_SIZES; i++)
 		internal_cfg->hugepage_info[i].lock_descriptor = -1;
 	internal_cfg->base_virtaddr = 0;
+	internal_cfg->huge_init_threads = 0;
 
 	internal_cfg->syslog_facility = LOG_DAEMON;
+	internal_cfg->log_async = 0;
 
 	internal_cfg->xen_dom0_support = 0;
 
@@ -329,6 +340,107 @@ eal_parse_coremask(const char *coremask)
 	return 0;
 }
 
+/*
+ * Parse the service coremask. The roles are only applied in
+ * eal_adjust_config(), so that -s does not depend on the order of the
+ * -c, -l and --lcores options.
+ */
+static int
+eal_parse_service_coremask(const char *coremask)
+{
+	int i, j, idx = 0;
+	unsigned int count = 0;
+	char c;
+	int val;
+
+	if (coremask == NULL)
+		return -1;
+	while (isblank(*coremask))
+		coremask++;
+	if (coremask[0] == '0' && ((coremask[1] == 'x')
+		|| (coremask[1] == 'X')))
+		coremask += 2;
+	i = strlen(coremask);
+	while ((i > 0) && isblank(coremask[i - 1]))
+		i--;
+	if (i == 0)
+		return -1;
+
+	for (i = i - 1; i >= 0 && idx < RTE_MAX_LCORE; i--) {
+		c = coremask[i];
+		if (isxdigit(c) == 0)
+			return -1;
+		val = xdigit2val(c);
+		for (j = 0; j < BITS_PER_HEX && idx < RTE_MAX_LCORE;
+				j++, idx++) {
+			if ((1 << j) & val) {
+				service_lcores[idx] = 1;
+				count++;
+			} else {
+				service_lcores[idx] = 0;
+			}
+		}
+	}
+	for (; i >= 0; i--)
+		if (coremask[i] != '0')
+			return -1;
+	for (; idx < RTE_MAX_LCORE; idx++)
+		service_lcores[idx] = 0;
+	if (count == 0)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Give the service role to the lcores requested with -s. The lcores not
+ * enabled by -c, -l or --lcores run on the cpu of the same id, like with
+ * -c, and get the next free core index.
+ */
+static int
+eal_apply_service_lcores(struct rte_config *cfg)
+{
+	unsigned int lcore_id;
+	int core_index = 0;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		if (cfg->lcore_role[lcore_id] != ROLE_OFF &&
+				lcore_config[lcore_id].core_index >= core_index)
+			core_index = lcore_config[lcore_id].core_index + 1;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (!service_lcores[lcore_id])
+			continue;
+		if (master_lcore_parsed && lcore_id == cfg->master_lcore) {
+			RTE_LOG(ERR, EAL, "Master lcore %u cannot be used "
+				"as a service lcore\n", lcore_id);
+			return -1;
+		}
+		/* the lcore may come from --lcores, or be a detected cpu */
+		if (cfg->lcore_role[lcore_id] == ROLE_OFF &&
+				!lcore_config[lcore_id].detected) {
+			RTE_LOG(ERR, EAL, "lcore %u unavailable\n", lcore_id);
+			return -1;
+		}
+		if (cfg->lcore_role[lcore_id] == ROLE_RTE) {
+			cfg->lcore_count--;
+		} else if (cfg->lcore_role[lcore_id] == ROLE_OFF) {
+			lcore_config[lcore_id].core_index = core_index++;
+			CPU_ZERO(&lcore_config[lcore_id].cpuset);
+			CPU_SET(lcore_id, &lcore_config[lcore_id].cpuset);
+		}
+		cfg->lcore_role[lcore_id] = ROLE_SERVICE;
+	}
+
+	if (cfg->lcore_count == 0) {
+		RTE_LOG(ERR, EAL, "No lcore left for the application "
+			"after reserving the service lcores\n");
+		return -1;
+	}
+
+	return 0;
+}
+
 static int
 eal_parse_corelist(const char *corelist)
 {
@@ -778,6 +890,33 @@ eal_parse_log_level(const char *arg)
 	return -1;
 }
 
+static int
+eal_parse_log_rate(const char *arg)
+{
+	char *end, *str, *type, *rate;
+	unsigned long tmp;
+	int ret = -1;
+
+	str = strdup(arg);
+	if (str == NULL)
+		return -1;
+
+	rate = str;
+	type = strsep(&rate, ",");
+	if (rate == NULL || type[0] == '\0' || rate[0] == '\0')
+		goto out;
+
+	errno = 0;
+	tmp = strtoul(rate, &end, 0);
+	if (errno != 0 || end == NULL || *end != '\0' || tmp > UINT32_MAX)
+		goto out;
+
+	ret = rte_log_set_rate_limit_regexp(type, tmp);
+out:
+	free(str);
+	return ret;
+}
+
 static enum rte_proc_type_t
 eal_parse_proc_type(const char *arg)
 {
@@ -826,6 +965,13 @@ eal_parse_common_option(int opt, const char *optarg,
 		}
 		core_parsed = 1;
 		break;
+	/* service coremask */
+	case 's':
+		if (eal_parse_service_coremask(optarg) < 0) {
+			RTE_LOG(ERR, EAL, "invalid service coremask\n");
+			return -1;
+		}
+		break;
 	/* size of memory */
 	case 'm':
 		conf->memory = atoi(optarg);
@@ -924,6 +1070,26 @@ eal_parse_common_option(int opt, const char *optarg,
 		}
 		break;
 	}
+	case OPT_LOG_RATE_NUM:
+		if (eal_parse_log_rate(optarg) < 0) {
+			RTE_LOG(ERR, EAL, "invalid parameters for --"
+				OPT_LOG_RATE "\n");
+			return -1;
+		}
+		break;
+
+	case OPT_LOG_ASYNC_NUM:
+		conf->log_async = 1;
+		break;
+
+	case OPT_TRACE_NUM:
+		if (eal_trace_args_save(optarg) < 0) {
+			RTE_LOG(ERR, EAL, "invalid parameters for --"
+				OPT_TRACE "\n");
+			return -1;
+		}
+		break;
+
 	case OPT_LCORES_NUM:
 		if (eal_parse_lcores(optarg) < 0) {
 			RTE_LOG(ERR, EAL, "invalid parameter for --"
@@ -977,6 +1143,9 @@ eal_adjust_config(struct internal_config *internal_cfg)
 	if (internal_config.process_type == RTE_PROC_AUTO)
 		internal_config.process_type = eal_proc_type_detect();
 
+	if (eal_apply_service_lcores(cfg) < 0)
+		return -1;
+
 	/* default master lcore is the first one */
 	if (!master_lcore_parsed)
 		cfg->master_lcore = rte_get_next_lcore(-1, 0, 0);
@@ -1053,6 +1222,7 @@ eal_common_usage(void)
 	       "                      '( )' can be omitted for single element group,\n"
 	       "                      '@' can be omitted if cpus and lcores have the same value\n"
 	       "  --"OPT_MASTER_LCORE" ID   Core ID that is used as master\n"
+	       "  -s SERVICE COREMASK Hexadecimal bitmask of cores to be used as service cores\n"
 	       "  -n CHANNELS         Number of memory channels\n"
 	       "  -m MB               Memory to allocate (see also --"OPT_SOCKET_MEM")\n"
 	       "  -r RANKS            Force number of memory ranks (don't detect)\n"
@@ -1075,6 +1245,12 @@ eal_common_usage(void)
 	       "  --"OPT_LOG_LEVEL"=<int>   Set global log level\n"
 	       "  --"OPT_LOG_LEVEL"=<type-regexp>,<int>\n"
 	       "                      Set specific log level\n"
+	       "  --"OPT_LOG_RATE"=<type-regexp>,<int>\n"
+	       "                      Limit the log messages per second of a type\n"
+	       "  --"OPT_LOG_ASYNC"         Write the log messages of the lcores\n"
+	       "                      from a control thread\n"
+	       "  --"OPT_TRACE"=<regexp>    Enable the trace points matching regexp\n"
+	       "                      (can be used multiple times)\n"
 	       "  -v                  Display version information on startup\n"
 	       "  -h, --help          This help\n"
 	       "\nEAL options for DEBUG use only:\n"
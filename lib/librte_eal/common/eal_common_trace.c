@@ -0,0 +1,498 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <regex.h>
+#include <limits.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <rte_trace.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_byteorder.h>
+#include <rte_malloc.h>
+#include <rte_log.h>
+#include <rte_version.h>
+
+#include "eal_private.h"
+
+#define TRACE_BUFFER_SIZE RTE_TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_MASK (TRACE_BUFFER_SIZE - 1)
+
+/* the maximum number of --trace options */
+#define TRACE_ARGS_MAX 32
+
+/* records of an lcore, only written by this lcore */
+struct trace_buffer {
+	uint64_t head; /* number of records written since the last reset */
+	struct rte_trace_record records[TRACE_BUFFER_SIZE] __rte_cache_aligned;
+};
+
+TAILQ_HEAD(rte_trace_point_list, rte_trace_point);
+
+static struct rte_trace_point_list trace_point_list =
+	TAILQ_HEAD_INITIALIZER(trace_point_list);
+static uint16_t trace_point_count;
+
+static struct trace_buffer *trace_buffers[RTE_MAX_LCORE];
+static int trace_initialized;
+
+/* regexps given with --trace, applied once the memory is available */
+static char *trace_args[TRACE_ARGS_MAX];
+static unsigned int trace_args_count;
+
+int
+rte_trace_point_register(struct rte_trace_point *tp)
+{
+	unsigned int i;
+
+	if (tp == NULL || tp->name == NULL ||
+			tp->nb_args > RTE_TRACE_POINT_ARGS_MAX)
+		return -EINVAL;
+
+	for (i = 0; i < tp->nb_args; i++) {
+		if (tp->arg_names[i] == NULL)
+			return -EINVAL;
+	}
+
+	if (rte_trace_point_lookup(tp->name) != NULL)
+		return -EEXIST;
+
+	tp->id = trace_point_count++;
+	tp->enabled = 0;
+	TAILQ_INSERT_TAIL(&trace_point_list, tp, next);
+
+	return 0;
+}
+
+void
+__rte_trace_point_emit(const struct rte_trace_point *tp,
+		const uint64_t *args, unsigned int nb_args)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	struct trace_buffer *buf;
+	struct rte_trace_record *rec;
+	unsigned int i;
+
+	if (lcore_id >= RTE_MAX_LCORE)
+		return;
+	buf = trace_buffers[lcore_id];
+	if (unlikely(buf == NULL))
+		return;
+
+	if (nb_args > RTE_TRACE_POINT_ARGS_MAX)
+		nb_args = RTE_TRACE_POINT_ARGS_MAX;
+
+	rec = &buf->records[buf->head & TRACE_BUFFER_MASK];
+	rec->tsc = rte_rdtsc();
+	rec->id = tp->id;
+	rec->lcore_id = lcore_id;
+	rec->nb_args = nb_args;
+	for (i = 0; i < nb_args; i++)
+		rec->args[i] = args[i];
+	buf->head++;
+}
+
+struct rte_trace_point *
+rte_trace_point_lookup(const char *name)
+{
+	struct rte_trace_point *tp;
+
+	if (name == NULL)
+		return NULL;
+
+	TAILQ_FOREACH(tp, &trace_point_list, next) {
+		if (strcmp(tp->name, name) == 0)
+			return tp;
+	}
+
+	return NULL;
+}
+
+/* allocate the buffers of all the lcores, on their socket */
+static int
+trace_buffers_alloc(void)
+{
+	struct trace_buffer *buf;
+	unsigned int lcore_id;
+
+	/* buffers are allocated by rte_trace_init() */
+	if (!trace_initialized)
+		return 0;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (trace_buffers[lcore_id] != NULL ||
+				rte_eal_lcore_role(lcore_id) == ROLE_OFF)
+			continue;
+		buf = rte_zmalloc_socket("trace_buffer", sizeof(*buf),
+			RTE_CACHE_LINE_SIZE, rte_lcore_to_socket_id(lcore_id));
+		if (buf == NULL) {
+			RTE_LOG(ERR, EAL, "Cannot allocate trace buffer "
+				"of lcore %u\n", lcore_id);
+			return -ENOMEM;
+		}
+		/* the lcore can use the buffer once it is initialized */
+		rte_smp_wmb();
+		trace_buffers[lcore_id] = buf;
+	}
+
+	return 0;
+}
+
+int
+rte_trace_point_enable(struct rte_trace_point *tp)
+{
+	int ret;
+
+	if (tp == NULL)
+		return -EINVAL;
+
+	ret = trace_buffers_alloc();
+	if (ret < 0)
+		return ret;
+
+	tp->enabled = 1;
+	return 0;
+}
+
+void
+rte_trace_point_disable(struct rte_trace_point *tp)
+{
+	if (tp != NULL)
+		tp->enabled = 0;
+}
+
+int
+rte_trace_point_is_enabled(const struct rte_trace_point *tp)
+{
+	return tp != NULL && tp->enabled;
+}
+
+int
+rte_trace_regexp(const char *regex, int enable)
+{
+	struct rte_trace_point *tp;
+	regex_t r;
+	int count = 0;
+	int ret = 0;
+
+	if (regex == NULL || regcomp(&r, regex, REG_NOSUB) != 0)
+		return -EINVAL;
+
+	TAILQ_FOREACH(tp, &trace_point_list, next) {
+		if (regexec(&r, tp->name, 0, NULL, 0) != 0)
+			continue;
+		if (enable)
+			ret = rte_trace_point_enable(tp);
+		else
+			rte_trace_point_disable(tp);
+		if (ret < 0)
+			break;
+		count++;
+	}
+	regfree(&r);
+
+	return ret < 0 ? ret : count;
+}
+
+int
+rte_trace_pattern(const char *pattern, int enable)
+{
+	struct rte_trace_point *tp;
+	int count = 0;
+	int ret;
+
+	if (pattern == NULL)
+		return -EINVAL;
+
+	TAILQ_FOREACH(tp, &trace_point_list, next) {
+		if (fnmatch(pattern, tp->name, 0) != 0)
+			continue;
+		if (enable) {
+			ret = rte_trace_point_enable(tp);
+			if (ret < 0)
+				return ret;
+		} else
+			rte_trace_point_disable(tp);
+		count++;
+	}
+
+	return count;
+}
+
+int
+rte_trace_is_enabled(void)
+{
+	struct rte_trace_point *tp;
+
+	TAILQ_FOREACH(tp, &trace_point_list, next) {
+		if (tp->enabled)
+			return 1;
+	}
+
+	return 0;
+}
+
+void
+rte_trace_reset(void)
+{
+	unsigned int lcore_id;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (trace_buffers[lcore_id] != NULL)
+			trace_buffers[lcore_id]->head = 0;
+	}
+}
+
+/* write the CTF metadata describing the records */
+static int
+trace_save_metadata(const char *dir)
+{
+	char path[PATH_MAX];
+	struct rte_trace_point *tp;
+	unsigned int i;
+	FILE *f;
+
+	snprintf(path, sizeof(path), "%s/metadata", dir);
+	f = fopen(path, "w");
+	if (f == NULL)
+		return -errno;
+
+	fprintf(f, "/* CTF 1.8 */\n\n"
+		"typealias integer { size = 8; align = 8; signed = false; } "
+		":= uint8_t;\n"
+		"typealias integer { size = 16; align = 8; signed = false; } "
+		":= uint16_t;\n"
+		"typealias integer { size = 64; align = 8; signed = false; } "
+		":= uint64_t;\n\n"
+		"trace {\n"
+		"\tmajor = 1;\n"
+		"\tminor = 8;\n"
+		"\tbyte_order = %s;\n"
+		"};\n\n"
+		"env {\n"
+		"\tdomain = \"dpdk\";\n"
+		"\tversion = \"%s\";\n"
+		"};\n\n"
+		"clock {\n"
+		"\tname = \"tsc\";\n"
+		"\tfreq = %"PRIu64";\n"
+		"\toffset = 0;\n"
+		"};\n\n"
+		"typealias integer { size = 64; align = 8; signed = false; "
+		"map = clock.tsc.value; } := tsc_t;\n\n"
+		"stream {\n"
+		"\tevent.header := struct {\n"
+		"\t\ttsc_t timestamp;\n"
+		"\t\tuint16_t id;\n"
+		"\t\tuint16_t lcore_id;\n"
+		"\t\tuint8_t nb_args;\n"
+		"\t\tuint8_t reserved[3];\n"
+		"\t};\n"
+		"};\n",
+		RTE_BYTE_ORDER == RTE_LITTLE_ENDIAN ? "le" : "be",
+		rte_version(), rte_get_tsc_hz());
+
+	TAILQ_FOREACH(tp, &trace_point_list, next) {
+		fprintf(f, "\nevent {\n"
+			"\tid = %u;\n"
+			"\tname = \"%s\";\n"
+			"\tfields := struct {\n", tp->id, tp->name);
+		for (i = 0; i < tp->nb_args; i++)
+			fprintf(f, "\t\tuint64_t %s;\n", tp->arg_names[i]);
+		/* records have a fixed size */
+		if (tp->nb_args < RTE_TRACE_POINT_ARGS_MAX)
+			fprintf(f, "\t\tuint64_t _unused[%u];\n",
+				RTE_TRACE_POINT_ARGS_MAX - tp->nb_args);
+		fprintf(f, "\t};\n};\n");
+	}
+
+	if (fclose(f) != 0)
+		return -errno;
+	return 0;
+}
+
+/* write the records of an lcore, from the oldest to the newest */
+static int
+trace_save_stream(const char *dir, unsigned int lcore_id,
+		const struct trace_buffer *buf)
+{
+	char path[PATH_MAX];
+	uint64_t head = buf->head;
+	uint64_t first, count;
+	FILE *f;
+
+	rte_smp_rmb();
+	count = RTE_MIN(head, (uint64_t)TRACE_BUFFER_SIZE);
+	first = (head - count) & TRACE_BUFFER_MASK;
+
+	snprintf(path, sizeof(path), "%s/channel0_%u", dir, lcore_id);
+	f = fopen(path, "w");
+	if (f == NULL)
+		return -errno;
+
+	/* the buffer may wrap */
+	if (first + count > TRACE_BUFFER_SIZE) {
+		uint64_t n = TRACE_BUFFER_SIZE - first;
+
+		if (fwrite(&buf->records[first], sizeof(buf->records[0]), n,
+				f) != n ||
+				fwrite(&buf->records[0], sizeof(buf->records[0]),
+				count - n, f) != count - n)
+			goto fail;
+	} else if (fwrite(&buf->records[first], sizeof(buf->records[0]),
+			count, f) != count)
+		goto fail;
+
+	if (fclose(f) != 0)
+		return -errno;
+	return count;
+
+fail:
+	fclose(f);
+	return -EIO;
+}
+
+int
+rte_trace_save(const char *dir)
+{
+	unsigned int lcore_id;
+	int total = 0;
+	int ret;
+
+	if (dir == NULL)
+		return -EINVAL;
+
+	if (mkdir(dir, 0700) < 0 && errno != EEXIST) {
+		RTE_LOG(ERR, EAL, "Cannot create trace directory %s: %s\n",
+			dir, strerror(errno));
+		return -errno;
+	}
+
+	ret = trace_save_metadata(dir);
+	if (ret < 0)
+		return ret;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (trace_buffers[lcore_id] == NULL)
+			continue;
+		ret = trace_save_stream(dir, lcore_id,
+			trace_buffers[lcore_id]);
+		if (ret < 0)
+			return ret;
+		total += ret;
+	}
+
+	return total;
+}
+
+void
+rte_trace_dump(FILE *f)
+{
+	struct rte_trace_point *tp;
+	unsigned int lcore_id;
+	uint64_t head;
+
+	fprintf(f, "Trace points (%u registered):\n", trace_point_count);
+	TAILQ_FOREACH(tp, &trace_point_list, next)
+		fprintf(f, "  id %u: %s %s\n", tp->id, tp->name,
+			tp->enabled ? "enabled" : "disabled");
+
+	fprintf(f, "Trace buffers (%u records per lcore):\n",
+		TRACE_BUFFER_SIZE);
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (trace_buffers[lcore_id] == NULL)
+			continue;
+		head = trace_buffers[lcore_id]->head;
+		fprintf(f, "  lcore %u: %"PRIu64" records, %"PRIu64
+			" overwritten\n", lcore_id, head,
+			head > TRACE_BUFFER_SIZE ?
+				head - TRACE_BUFFER_SIZE : 0);
+	}
+}
+
+int
+eal_trace_args_save(const char *regex)
+{
+	if (trace_args_count == TRACE_ARGS_MAX) {
+		RTE_LOG(ERR, EAL, "Too many --trace options\n");
+		return -1;
+	}
+
+	trace_args[trace_args_count] = strdup(regex);
+	if (trace_args[trace_args_count] == NULL)
+		return -1;
+	trace_args_count++;
+
+	return 0;
+}
+
+int
+rte_trace_init(void)
+{
+	unsigned int i;
+	int ret;
+
+	RTE_BUILD_BUG_ON((TRACE_BUFFER_SIZE & TRACE_BUFFER_MASK) != 0);
+	RTE_BUILD_BUG_ON(sizeof(struct rte_trace_record) != 64);
+
+	trace_initialized = 1;
+
+	for (i = 0; i < trace_args_count; i++) {
+		ret = rte_trace_regexp(trace_args[i], 1);
+		if (ret < 0) {
+			RTE_LOG(ERR, EAL, "Cannot enable trace points "
+				"matching %s\n", trace_args[i]);
+			return -1;
+		}
+		RTE_LOG(DEBUG, EAL, "%d trace point(s) match %s\n",
+			ret, trace_args[i]);
+		free(trace_args[i]);
+		trace_args[i] = NULL;
+	}
+	trace_args_count = 0;
+
+	/* trace points enabled before the memory was available */
+	if (rte_trace_is_enabled())
+		return trace_buffers_alloc();
+
+	return 0;
+}
@@ -77,7 +77,9 @@ struct internal_config {
 	volatile unsigned force_sockets;
 	volatile uint64_t socket_mem[RTE_MAX_NUMA_NODES]; /**< amount of memory per socket */
 	uintptr_t base_virtaddr;          /**< base address to try and reserve memory from */
+	unsigned huge_init_threads;       /**< threads mapping hugepages at init, 0 for auto */
 	volatile int syslog_facility;	  /**< facility passed to openlog() */
+	volatile unsigned log_async;      /**< true to start the async log */
 	/** default interrupt mode for VFIO */
 	volatile enum rte_intr_mode vfio_intr_mode;
 	const char *hugefile_prefix;      /**< the base filename of hugetlbfs files */
@@ -295,6 +295,56 @@ unsigned eal_cpu_core_id(unsigned lcore_id);
  */
 int eal_cpu_detected(unsigned lcore_id);
 
+/**
+ * Initialize the services and add the service lcores requested on the
+ * command line.
+ *
+ * This function is private to the EAL.
+ *
+ * @return
+ *   0 on success, negative on error
+ */
+int rte_service_init(void);
+
+/**
+ * Save a regular expression given with --trace, the matching trace
+ * points are enabled by rte_trace_init().
+ *
+ * This function is private to the EAL.
+ *
+ * @return
+ *   0 on success, negative on error
+ */
+int eal_trace_args_save(const char *regex);
+
+/**
+ * Enable the trace points requested on the command line and allocate
+ * the trace buffers if needed.
+ *
+ * This function is private to the EAL.
+ *
+ * @return
+ *   0 on success, negative on error
+ */
+int rte_trace_init(void);
+
+/**
+ * Bind the values of each enabled lcore in the lcore variables to the
+ * NUMA socket of the lcore. Called once the lcores are configured; the
+ * buffers allocated afterwards are bound at allocation.
+ *
+ * This function is private to the EAL.
+ */
+void eal_lcore_var_bind(void);
+
+/**
+ * Stop the poll accounting of an lcore, after the launched function
+ * returned.
+ *
+ * This function is private to the EAL.
+ */
+void eal_lcore_poll_stop(unsigned int lcore_id);
+
 /**
  * Set TSC frequency from precise value or estimation
  *
@@ -0,0 +1,282 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Arm Limited
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Arm Limited nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_MCSLOCK_H_
+#define _RTE_MCSLOCK_H_
+
+/**
+ * @file
+ *
+ * RTE MCS locks
+ *
+ * This file defines an API for MCS queue locks (Mellor-Crummey and
+ * Scott). The waiters are queued in FIFO order, each one spinning on a
+ * flag in its own queue node rather than on the shared lock word, so that
+ * under contention the release of the lock only touches the cache line of
+ * the next waiter instead of all of them.
+ *
+ * The lock itself is a pointer to the tail of the queue, initialised to
+ * NULL. Each locker provides a node, which must stay valid and must not
+ * be reused until the lock is released with the same node. The node is
+ * typically allocated on the stack of the locker.
+ *
+ * As the lock is handed over in order, a waiter which is preempted delays
+ * all the following ones: the lock should not be shared by threads
+ * running on the same physical core.
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_branch_prediction.h>
+
+/**
+ * The rte_mcslock_t type, a node of the queue of an MCS lock.
+ */
+typedef struct rte_mcslock {
+	struct rte_mcslock *next; /**< next waiter in the queue */
+	int locked; /**< 1 while the owner of the node waits for the lock */
+} rte_mcslock_t;
+
+/**
+ * Take the MCS lock.
+ *
+ * @param msl
+ *   A pointer to the MCS lock, i.e. the tail of its queue.
+ * @param me
+ *   A pointer to the queue node of the caller.
+ */
+static inline void
+rte_mcslock_lock(rte_mcslock_t **msl, rte_mcslock_t *me)
+{
+	rte_mcslock_t *prev;
+
+	/* Init me node */
+	__atomic_store_n(&me->locked, 1, __ATOMIC_RELAXED);
+	__atomic_store_n(&me->next, NULL, __ATOMIC_RELAXED);
+
+	/*
+	 * Append the node to the queue. The release ordering makes the
+	 * initialisation of the node visible to the previous waiter, the
+	 * acquire ordering synchronizes with its release of the lock.
+	 */
+	prev = __atomic_exchange_n(msl, me, __ATOMIC_ACQ_REL);
+	if (likely(prev == NULL)) {
+		/* Queue was empty, no further action required,
+		 * proceed with lock taken.
+		 */
+		return;
+	}
+	__atomic_store_n(&prev->next, me, __ATOMIC_RELEASE);
+
+	/* Spin on our own node until the previous waiter hands the lock */
+	while (__atomic_load_n(&me->locked, __ATOMIC_ACQUIRE))
+		rte_pause();
+}
+
+/**
+ * Release the MCS lock.
+ *
+ * @param msl
+ *   A pointer to the MCS lock, i.e. the tail of its queue.
+ * @param me
+ *   A pointer to the queue node used to take the lock.
+ */
+static inline void
+rte_mcslock_unlock(rte_mcslock_t **msl, rte_mcslock_t *me)
+{
+	/* Check if there are more nodes in the queue. */
+	if (likely(__atomic_load_n(&me->next, __ATOMIC_RELAXED) == NULL)) {
+		/* No, last member in the queue. */
+		rte_mcslock_t *save_me = me;
+
+		/* Release the lock by setting it to NULL */
+		if (likely(__atomic_compare_exchange_n(msl, &save_me, NULL, 0,
+				__ATOMIC_RELEASE, __ATOMIC_RELAXED)))
+			return;
+
+		/* A new waiter swapped the tail but has not linked itself
+		 * to our node yet: wait for it.
+		 */
+		while (__atomic_load_n(&me->next, __ATOMIC_ACQUIRE) == NULL)
+			rte_pause();
+	}
+
+	/* Pass the lock to the next waiter. */
+	__atomic_store_n(&me->next->locked, 0, __ATOMIC_RELEASE);
+}
+
+/**
+ * Try to take the MCS lock.
+ *
+ * @param msl
+ *   A pointer to the MCS lock, i.e. the tail of its queue.
+ * @param me
+ *   A pointer to the queue node of the caller.
+ * @return
+ *   1 if the lock is successfully taken; 0 otherwise.
+ */
+static inline int
+rte_mcslock_trylock(rte_mcslock_t **msl, rte_mcslock_t *me)
+{
+	rte_mcslock_t *expected = NULL;
+
+	/* Init me node */
+	__atomic_store_n(&me->next, NULL, __ATOMIC_RELAXED);
+
+	/* Take the lock only if the queue is empty. */
+	return __atomic_compare_exchange_n(msl, &expected, me, 0,
+			__ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+}
+
+/**
+ * Test if the MCS lock is taken.
+ *
+ * @param msl
+ *   A pointer to the MCS lock, i.e. the tail of its queue.
+ * @return
+ *   1 if the lock is currently taken; 0 otherwise.
+ */
+static inline int
+rte_mcslock_is_locked(rte_mcslock_t **msl)
+{
+	return __atomic_load_n(msl, __ATOMIC_RELAXED) != NULL;
+}
+
+/**
+ * The rte_mcslock_recursive_t type.
+ */
+typedef struct {
+	rte_mcslock_t *msl; /**< the actual MCS lock */
+	rte_mcslock_t *node; /**< queue node of the owner */
+	int user; /**< thread id using lock, -1 for unused */
+	unsigned int count; /**< count of time this lock has been called */
+} rte_mcslock_recursive_t;
+
+/**
+ * A static recursive MCS lock initializer.
+ */
+#define RTE_MCSLOCK_RECURSIVE_INITIALIZER { NULL, NULL, -1, 0 }
+
+/**
+ * Initialize the recursive MCS lock to an unlocked state.
+ *
+ * @param mlr
+ *   A pointer to the recursive MCS lock.
+ */
+static inline void
+rte_mcslock_recursive_init(rte_mcslock_recursive_t *mlr)
+{
+	__atomic_store_n(&mlr->msl, NULL, __ATOMIC_RELAXED);
+	mlr->node = NULL;
+	__atomic_store_n(&mlr->user, -1, __ATOMIC_RELAXED);
+	mlr->count = 0;
+}
+
+/**
+ * Take the recursive MCS lock.
+ *
+ * The node is only used if the caller does not own the lock yet; it must
+ * stay valid until the outermost rte_mcslock_recursive_unlock().
+ *
+ * @param mlr
+ *   A pointer to the recursive MCS lock.
+ * @param me
+ *   A pointer to the queue node of the caller.
+ */
+static inline void
+rte_mcslock_recursive_lock(rte_mcslock_recursive_t *mlr, rte_mcslock_t *me)
+{
+	int id = rte_gettid();
+
+	if (__atomic_load_n(&mlr->user, __ATOMIC_RELAXED) != id) {
+		rte_mcslock_lock(&mlr->msl, me);
+		mlr->node = me;
+		__atomic_store_n(&mlr->user, id, __ATOMIC_RELAXED);
+	}
+	mlr->count++;
+}
+
+/**
+ * Release the recursive MCS lock.
+ *
+ * @param mlr
+ *   A pointer to the recursive MCS lock.
+ */
+static inline void
+rte_mcslock_recursive_unlock(rte_mcslock_recursive_t *mlr)
+{
+	if (--(mlr->count) == 0) {
+		rte_mcslock_t *node = mlr->node;
+
+		mlr->node = NULL;
+		__atomic_store_n(&mlr->user, -1, __ATOMIC_RELAXED);
+		rte_mcslock_unlock(&mlr->msl, node);
+	}
+}
+
+/**
+ * Try to take the recursive MCS lock.
+ *
+ * @param mlr
+ *   A pointer to the recursive MCS lock.
+ * @param me
+ *   A pointer to the queue node of the caller, see
+ *   rte_mcslock_recursive_lock().
+ * @return
+ *   1 if the lock is successfully taken; 0 otherwise.
+ */
+static inline int
+rte_mcslock_recursive_trylock(rte_mcslock_recursive_t *mlr, rte_mcslock_t *me)
+{
+	int id = rte_gettid();
+
+	if (__atomic_load_n(&mlr->user, __ATOMIC_RELAXED) != id) {
+		if (rte_mcslock_trylock(&mlr->msl, me) == 0)
+			return 0;
+		mlr->node = me;
+		__atomic_store_n(&mlr->user, id, __ATOMIC_RELAXED);
+	}
+	mlr->count++;
+	return 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_MCSLOCK_H_ */
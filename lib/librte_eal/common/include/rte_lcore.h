@@ -163,6 +163,10 @@ rte_lcore_to_socket_id(unsigned lcore_id)
 /**
  * Test if an lcore is enabled.
  *
+ * The lcores reserved to run services are not considered enabled: they
+ * are not browsed by RTE_LCORE_FOREACH() and the application cannot
+ * launch functions on them with rte_eal_mp_remote_launch().
+ *
  * @param lcore_id
  *   The identifier of the lcore, which MUST be between 0 and
  *   RTE_MAX_LCORE-1.
@@ -175,7 +179,7 @@ rte_lcore_is_enabled(unsigned lcore_id)
 	struct rte_config *cfg = rte_eal_get_configuration();
 	if (lcore_id >= RTE_MAX_LCORE)
 		return 0;
-	return cfg->lcore_role[lcore_id] != ROLE_OFF;
+	return cfg->lcore_role[lcore_id] == ROLE_RTE;
 }
 
 /**
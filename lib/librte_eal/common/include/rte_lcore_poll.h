@@ -0,0 +1,194 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_LCORE_POLL_H_
+#define _RTE_LCORE_POLL_H_
+
+/**
+ * @file
+ *
+ * RTE Lcore poll statistics
+ *
+ * A polling lcore always looks 100% busy to the operating system. These
+ * statistics split its cycles between busy and idle: a poll loop calls
+ * rte_lcore_poll_mark() after each poll (for instance each Rx burst) with
+ * the number of items it got, and the cycles until the next mark are
+ * accounted as busy if there were items to process, or idle otherwise.
+ * The Rx burst functions of ethdev and the dequeue functions of eventdev
+ * already mark their polls.
+ *
+ * The accounting starts at the first mark after a function is launched
+ * on an lcore, and stops when the function returns. It is done when the
+ * build option CONFIG_RTE_LCORE_POLL_STATS is enabled, and after it is
+ * enabled at runtime with rte_lcore_poll_stats_enable(), which should be
+ * done before launching the poll loops. The marks are ignored in non-EAL
+ * threads.
+ *
+ * The master lcore is accounted the same way when it runs a function
+ * with rte_eal_mp_remote_launch() and CALL_MASTER. When it polls outside
+ * of a launched function, e.g. directly from main(), its accounting is
+ * never stopped: the cycles after its last mark keep being accounted as
+ * busy or idle, depending on that mark.
+ *
+ * The statistics of an lcore are only updated by the lcore itself. They
+ * are cumulative and read without synchronization: the users compute the
+ * busy ratio over an interval from the difference of two readings.
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_branch_prediction.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_lcore_var.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Poll statistics of an lcore.
+ */
+struct rte_lcore_poll_stats {
+	uint64_t busy_cycles; /**< Cycles following a poll with items. */
+	uint64_t idle_cycles; /**< Cycles following an empty poll. */
+	uint64_t busy_polls;  /**< Number of polls with items. */
+	uint64_t idle_polls;  /**< Number of empty polls. */
+};
+
+/**
+ * @internal Poll accounting state of an lcore.
+ */
+struct rte_lcore_poll_state {
+	struct rte_lcore_poll_stats stats;
+	uint64_t last_tsc; /**< TSC of the last mark, 0 if not started. */
+	int busy;          /**< Whether the last mark had items. */
+};
+
+/** @internal Poll accounting state of the lcores. */
+extern RTE_LCORE_VAR_HANDLE(struct rte_lcore_poll_state, rte_lcore_poll_states);
+
+/** @internal Non-zero if the poll accounting is enabled. */
+extern volatile int rte_lcore_poll_enabled;
+
+/**
+ * @internal Account the cycles since the previous mark of an lcore.
+ */
+static inline void
+__rte_lcore_poll_account(struct rte_lcore_poll_state *state, uint64_t tsc)
+{
+	uint64_t cycles = tsc - state->last_tsc;
+
+	if (unlikely(state->last_tsc == 0))
+		return;
+	if (state->busy)
+		state->stats.busy_cycles += cycles;
+	else
+		state->stats.idle_cycles += cycles;
+}
+
+/**
+ * Mark the end of a poll of the calling lcore.
+ *
+ * The cycles since the previous mark are accounted as busy or idle,
+ * depending on the previous mark, and the cycles until the next mark
+ * will be accounted depending on @p nb_items.
+ *
+ * It does nothing if the poll statistics are disabled at build time or at
+ * runtime, or if the caller is not an EAL thread.
+ *
+ * @param nb_items
+ *   The number of items returned by the poll, 0 if it was empty.
+ */
+static inline void
+rte_lcore_poll_mark(unsigned int nb_items)
+{
+#ifdef RTE_LCORE_POLL_STATS
+	struct rte_lcore_poll_state *state;
+	unsigned int lcore_id;
+	uint64_t tsc;
+
+	if (likely(rte_lcore_poll_enabled == 0))
+		return;
+	lcore_id = rte_lcore_id();
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return;
+
+	state = RTE_LCORE_VAR_LCORE(lcore_id, rte_lcore_poll_states);
+	tsc = rte_rdtsc();
+	__rte_lcore_poll_account(state, tsc);
+	state->last_tsc = tsc;
+	state->busy = nb_items != 0;
+	if (nb_items != 0)
+		state->stats.busy_polls++;
+	else
+		state->stats.idle_polls++;
+#else
+	RTE_SET_USED(nb_items);
+#endif
+}
+
+/**
+ * Enable or disable the poll statistics at runtime. They are disabled
+ * by default.
+ *
+ * @param enable
+ *   Non-zero to enable the statistics, zero to disable them.
+ * @return
+ *   0 on success, -ENOTSUP if disabled at build time.
+ */
+int rte_lcore_poll_stats_enable(int enable);
+
+/**
+ * Get the poll statistics of an lcore.
+ *
+ * When the lcore is running a poll loop, the cycles since its last mark
+ * are included, as busy or idle depending on this mark.
+ *
+ * @param lcore_id
+ *   The lcore id.
+ * @param stats
+ *   The structure filled with the statistics.
+ * @return
+ *   0 on success, -EINVAL if the lcore id is invalid, -ENOTSUP if the
+ *   statistics are disabled at build time.
+ */
+int rte_lcore_poll_stats_get(unsigned int lcore_id,
+		struct rte_lcore_poll_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_LCORE_POLL_H_ */
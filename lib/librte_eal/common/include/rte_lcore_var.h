@@ -0,0 +1,227 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_LCORE_VAR_H_
+#define _RTE_LCORE_VAR_H_
+
+/**
+ * @file
+ *
+ * RTE Lcore variables
+ *
+ * An lcore variable has one value per lcore id, like a
+ * [RTE_MAX_LCORE] array, but it is allocated at runtime and the values
+ * of an lcore are stored next to the values of the other variables of
+ * the same lcore, rather than next to the values of the other lcores.
+ * The values do not need to be padded to a cache line to avoid false
+ * sharing, and several small variables share the same cache lines.
+ *
+ * The values are stored in buffers made of RTE_MAX_LCORE contiguous
+ * blocks of RTE_MAX_LCORE_VAR bytes (a build time option), one block per
+ * lcore. A variable is
+ * accessed through a handle, which points to the value of lcore 0: the
+ * value of an lcore is at a constant offset from it.
+ *
+ * The buffers are anonymous mappings, whose pages are only backed by
+ * memory on first write, so the blocks of the unused lcores do not
+ * consume memory. On Linux, the memory policy of the block of each
+ * enabled lcore prefers the NUMA socket of the lcore: the values of an
+ * lcore are NUMA-local whichever thread writes them first. The buffers
+ * allocated before rte_eal_init() are bound when the lcores are known.
+ *
+ * The values are zeroed at allocation. Lcore variables cannot be freed.
+ *
+ * Example:
+ *
+ * @code
+ * struct foo_lcore_state {
+ *         int a;
+ *         long b;
+ * };
+ *
+ * static RTE_LCORE_VAR_HANDLE(struct foo_lcore_state, lcore_states);
+ *
+ * RTE_LCORE_VAR_INIT(lcore_states);
+ *
+ * long foo_get_a_plus_b(void)
+ * {
+ *         const struct foo_lcore_state *state = RTE_LCORE_VAR(lcore_states);
+ *
+ *         return state->a + state->b;
+ * }
+ * @endcode
+ */
+
+#include <stddef.h>
+
+#include <rte_common.h>
+#include <rte_debug.h>
+#include <rte_lcore.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * The type of the handle of an lcore variable of type @p type.
+ */
+#define RTE_LCORE_VAR_HANDLE_TYPE(type) type *
+
+/**
+ * Define an lcore variable handle.
+ *
+ * @param type
+ *   The type of the value of each lcore.
+ * @param name
+ *   The name of the handle.
+ */
+#define RTE_LCORE_VAR_HANDLE(type, name) \
+	RTE_LCORE_VAR_HANDLE_TYPE(type) name
+
+/**
+ * Allocate an lcore variable, with an explicit value size and
+ * alignment. The handle is set to NULL on failure.
+ */
+#define RTE_LCORE_VAR_ALLOC_SIZE_ALIGN(handle, size, align) \
+	handle = rte_lcore_var_alloc(size, align)
+
+/**
+ * Allocate an lcore variable, with an explicit value size and the
+ * alignment of the handle type.
+ */
+#define RTE_LCORE_VAR_ALLOC_SIZE(handle, size) \
+	RTE_LCORE_VAR_ALLOC_SIZE_ALIGN(handle, size, __alignof__(*(handle)))
+
+/**
+ * Allocate an lcore variable, with the size and alignment of the handle
+ * type.
+ */
+#define RTE_LCORE_VAR_ALLOC(handle) \
+	RTE_LCORE_VAR_ALLOC_SIZE(handle, sizeof(*(handle)))
+
+/**
+ * Allocate an lcore variable at startup, in a constructor. The process
+ * exits if there is not enough memory.
+ */
+#define RTE_LCORE_VAR_INIT(name)					\
+RTE_INIT(rte_lcore_var_init_ ## name);					\
+static void								\
+rte_lcore_var_init_ ## name(void)					\
+{									\
+	RTE_LCORE_VAR_ALLOC(name);					\
+	if (name == NULL)						\
+		rte_panic("cannot allocate lcore variable " #name "\n");	\
+}
+
+/**
+ * Get a pointer to the value of an lcore.
+ *
+ * @param lcore_id
+ *   The lcore id, lower than RTE_MAX_LCORE.
+ * @param handle
+ *   The handle of the variable.
+ * @return
+ *   The value of the lcore.
+ */
+static inline void *
+rte_lcore_var_lcore(unsigned int lcore_id, void *handle)
+{
+	return RTE_PTR_ADD(handle, lcore_id * RTE_MAX_LCORE_VAR);
+}
+
+/**
+ * Get a pointer to the value of the calling lcore.
+ *
+ * The calling thread must be an EAL thread, or have a valid lcore id.
+ *
+ * @param handle
+ *   The handle of the variable.
+ * @return
+ *   The value of the calling lcore.
+ */
+static inline void *
+rte_lcore_var_value(void *handle)
+{
+	return rte_lcore_var_lcore(rte_lcore_id(), handle);
+}
+
+/**
+ * Get a typed pointer to the value of an lcore.
+ */
+#define RTE_LCORE_VAR_LCORE(lcore_id, handle)				\
+	((__typeof__(handle))rte_lcore_var_lcore(lcore_id, handle))
+
+/**
+ * Get a typed pointer to the value of the calling lcore.
+ */
+#define RTE_LCORE_VAR(handle)						\
+	((__typeof__(handle))rte_lcore_var_value(handle))
+
+/**
+ * Iterate over the values of all the lcores, enabled or not.
+ *
+ * @param lcore_id
+ *   An unsigned int, set to the lcore id at each iteration.
+ * @param value
+ *   A pointer of the handle type, set to the value of the lcore.
+ * @param handle
+ *   The handle of the variable.
+ */
+#define RTE_LCORE_VAR_FOREACH(lcore_id, value, handle)			\
+	for (lcore_id = 0;						\
+	     (value = RTE_LCORE_VAR_LCORE(lcore_id, handle)),		\
+		     lcore_id < RTE_MAX_LCORE;				\
+	     lcore_id++)
+
+/**
+ * Allocate an lcore variable.
+ *
+ * It is usually called through RTE_LCORE_VAR_ALLOC() or
+ * RTE_LCORE_VAR_INIT(). It can be called before rte_eal_init().
+ *
+ * @param size
+ *   The size of the value of each lcore, at most RTE_MAX_LCORE_VAR.
+ * @param align
+ *   The alignment of the values, a power of 2, at most the page size.
+ *   If 0, the values are aligned on a cache line.
+ * @return
+ *   The handle of the variable, pointing to the zeroed value of lcore 0,
+ *   or NULL on error (invalid size or alignment, out of memory).
+ */
+void *rte_lcore_var_alloc(size_t size, size_t align);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_LCORE_VAR_H_ */
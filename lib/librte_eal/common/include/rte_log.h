@@ -240,6 +240,101 @@ int rte_log_cur_msg_logtype(void);
  */
 int rte_log_register(const char *name);
 
+/**
+ * Limit the number of messages of a log type.
+ *
+ * At most rate messages of the log type are output per second; the
+ * following ones are dropped, and their number is reported by a notice
+ * once the second has elapsed. The limit is approximate when several
+ * lcores log messages of the same type at the same time.
+ *
+ * @param logtype
+ *   The log type identifier.
+ * @param rate
+ *   The maximum number of messages per second, 0 to remove the limit.
+ * @return
+ *   0 on success, a negative value if logtype is invalid.
+ */
+int rte_log_set_rate_limit(uint32_t logtype, uint32_t rate);
+
+/**
+ * Limit the number of messages of the log types matching a regexp.
+ *
+ * @param pattern
+ *   The regexp identifying the log types.
+ * @param rate
+ *   The maximum number of messages per second, 0 to remove the limit.
+ * @return
+ *   0 on success, a negative value if the regexp is invalid.
+ */
+int rte_log_set_rate_limit_regexp(const char *pattern, uint32_t rate);
+
+/**
+ * Get the number of messages of a log type dropped by its rate limit.
+ *
+ * @param logtype
+ *   The log type identifier.
+ * @return
+ *   The number of dropped messages, 0 if logtype is invalid.
+ */
+uint64_t rte_log_get_suppressed(uint32_t logtype);
+
+/**
+ * Start the asynchronous log backend.
+ *
+ * Once started, the messages logged by the EAL lcores are formatted in a
+ * ring private to each lcore, instead of being written to the log
+ * stream. A control thread drains the rings and writes the messages to
+ * the stream, so that a lcore never blocks on the stream. When the ring
+ * of a lcore is full, its messages are dropped and counted.
+ *
+ * The messages logged by non-EAL threads and the messages of level
+ * RTE_LOG_CRIT or more urgent are still written synchronously.
+ * The messages longer than RTE_LOG_ASYNC_MSG_SIZE are truncated.
+ *
+ * It is started by the EAL with the --log-async option.
+ *
+ * @return
+ *   0 on success, a negative value on error (memory or thread creation).
+ */
+int rte_log_async_start(void);
+
+/**
+ * Stop the asynchronous log backend.
+ *
+ * The pending messages are written, the control thread is stopped and
+ * the messages are written synchronously again. It must not be called
+ * while the lcores log messages.
+ */
+void rte_log_async_stop(void);
+
+/**
+ * Write the pending messages of the asynchronous log backend.
+ *
+ * This function is called at exit. It does nothing if the backend is
+ * stopped.
+ */
+void rte_log_async_flush(void);
+
+/**
+ * Check if the asynchronous log backend is started.
+ *
+ * @return
+ *   1 if started, 0 otherwise.
+ */
+int rte_log_async_is_enabled(void);
+
+/**
+ * Get the number of messages of a lcore dropped by the asynchronous log
+ * backend because its ring was full.
+ *
+ * @param lcore_id
+ *   The lcore identifier.
+ * @return
+ *   The number of dropped messages.
+ */
+uint64_t rte_log_async_dropped(unsigned int lcore_id);
+
 /**
  * Dump log information.
  *
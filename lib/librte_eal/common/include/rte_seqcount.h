@@ -0,0 +1,192 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Arm Limited
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Arm Limited nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_SEQCOUNT_H_
+#define _RTE_SEQCOUNT_H_
+
+/**
+ * @file
+ *
+ * RTE Sequence Counter
+ *
+ * The sequence counter protects data which is read often and written
+ * rarely by a single writer. The writer makes the counter odd while it
+ * updates the data, and even again when it is done. A reader samples the
+ * counter before reading the data and retries if, after reading, the
+ * counter was odd or has changed.
+ *
+ * Readers never write to shared memory, so that they do not bounce the
+ * cache line of the counter between cores, and never block the writer.
+ * Since a reader may see a partial update before retrying, it must only
+ * copy the data during the read section, and must not dereference
+ * pointers read from it.
+ *
+ * A sequence counter does not serialize the writers: when there are
+ * several writers, use the sequence lock, see rte_seqlock.h.
+ *
+ * Example:
+ *
+ * @code{.c}
+ * uint32_t sn;
+ *
+ * do {
+ *         sn = rte_seqcount_read_begin(&config->sc);
+ *         mtu = config->mtu;
+ *         rte_memcpy(mac, config->mac, sizeof(mac));
+ * } while (rte_seqcount_read_retry(&config->sc, sn));
+ * @endcode
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_branch_prediction.h>
+
+/**
+ * The rte_seqcount_t type.
+ */
+typedef struct {
+	uint32_t sn; /**< sequence number, odd while a write is in progress */
+} rte_seqcount_t;
+
+/**
+ * A static seqcount initializer.
+ */
+#define RTE_SEQCOUNT_INITIALIZER { 0 }
+
+/**
+ * Initialize the sequence counter.
+ *
+ * @param seqcount
+ *   A pointer to the sequence counter.
+ */
+static inline void
+rte_seqcount_init(rte_seqcount_t *seqcount)
+{
+	seqcount->sn = 0;
+}
+
+/**
+ * Begin a read-side critical section.
+ *
+ * @param seqcount
+ *   A pointer to the sequence counter.
+ * @return
+ *   The sequence number to pass to rte_seqcount_read_retry().
+ */
+static inline uint32_t
+rte_seqcount_read_begin(const rte_seqcount_t *seqcount)
+{
+	/* The acquire load orders the loads of the protected data after
+	 * the load of the sequence number.
+	 */
+	return __atomic_load_n(&seqcount->sn, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * End a read-side critical section.
+ *
+ * @param seqcount
+ *   A pointer to the sequence counter.
+ * @param begin_sn
+ *   The sequence number returned by rte_seqcount_read_begin().
+ * @return
+ *   1 if the data read may be inconsistent and the read section must be
+ *   retried; 0 otherwise.
+ */
+static inline int
+rte_seqcount_read_retry(const rte_seqcount_t *seqcount, uint32_t begin_sn)
+{
+	uint32_t end_sn;
+
+	/* A write was in progress when the read section started. */
+	if (unlikely(begin_sn & 1))
+		return 1;
+
+	/* Order the loads of the protected data before the load of the
+	 * sequence number.
+	 */
+	__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+	end_sn = __atomic_load_n(&seqcount->sn, __ATOMIC_RELAXED);
+
+	return begin_sn != end_sn;
+}
+
+/**
+ * Begin a write-side critical section.
+ *
+ * Only one writer may be in a write section at a time.
+ *
+ * @param seqcount
+ *   A pointer to the sequence counter.
+ */
+static inline void
+rte_seqcount_write_begin(rte_seqcount_t *seqcount)
+{
+	uint32_t sn = seqcount->sn + 1;
+
+	__atomic_store_n(&seqcount->sn, sn, __ATOMIC_RELAXED);
+
+	/* Order the store of the sequence number before the stores of the
+	 * protected data.
+	 */
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+/**
+ * End a write-side critical section.
+ *
+ * @param seqcount
+ *   A pointer to the sequence counter.
+ */
+static inline void
+rte_seqcount_write_end(rte_seqcount_t *seqcount)
+{
+	uint32_t sn = seqcount->sn + 1;
+
+	/* The release store orders the stores of the protected data
+	 * before the store of the sequence number.
+	 */
+	__atomic_store_n(&seqcount->sn, sn, __ATOMIC_RELEASE);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_SEQCOUNT_H_ */
@@ -0,0 +1,148 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Arm Limited
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Arm Limited nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_SEQLOCK_H_
+#define _RTE_SEQLOCK_H_
+
+/**
+ * @file
+ *
+ * RTE Sequence Lock
+ *
+ * The sequence lock is a sequence counter (see rte_seqcount.h) whose
+ * writers are serialized by a spinlock, for data which is read often and
+ * written rarely, possibly by several threads.
+ *
+ * Readers do not take the spinlock nor write to shared memory: they
+ * retry their read section when a write happened concurrently. Writers
+ * are never blocked by readers.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+#include <rte_seqcount.h>
+#include <rte_spinlock.h>
+
+/**
+ * The rte_seqlock_t type.
+ */
+typedef struct {
+	rte_seqcount_t count; /**< sequence counter of the protected data */
+	rte_spinlock_t lock; /**< spinlock serializing the writers */
+} rte_seqlock_t;
+
+/**
+ * A static seqlock initializer.
+ */
+#define RTE_SEQLOCK_INITIALIZER \
+	{ RTE_SEQCOUNT_INITIALIZER, RTE_SPINLOCK_INITIALIZER }
+
+/**
+ * Initialize the sequence lock.
+ *
+ * @param seqlock
+ *   A pointer to the sequence lock.
+ */
+static inline void
+rte_seqlock_init(rte_seqlock_t *seqlock)
+{
+	rte_seqcount_init(&seqlock->count);
+	rte_spinlock_init(&seqlock->lock);
+}
+
+/**
+ * Begin a read-side critical section.
+ *
+ * @param seqlock
+ *   A pointer to the sequence lock.
+ * @return
+ *   The sequence number to pass to rte_seqlock_read_retry().
+ */
+static inline uint32_t
+rte_seqlock_read_begin(const rte_seqlock_t *seqlock)
+{
+	return rte_seqcount_read_begin(&seqlock->count);
+}
+
+/**
+ * End a read-side critical section.
+ *
+ * @param seqlock
+ *   A pointer to the sequence lock.
+ * @param begin_sn
+ *   The sequence number returned by rte_seqlock_read_begin().
+ * @return
+ *   1 if the data read may be inconsistent and the read section must be
+ *   retried; 0 otherwise.
+ */
+static inline int
+rte_seqlock_read_retry(const rte_seqlock_t *seqlock, uint32_t begin_sn)
+{
+	return rte_seqcount_read_retry(&seqlock->count, begin_sn);
+}
+
+/**
+ * Begin a write-side critical section, waiting for the other writers.
+ *
+ * @param seqlock
+ *   A pointer to the sequence lock.
+ */
+static inline void
+rte_seqlock_write_lock(rte_seqlock_t *seqlock)
+{
+	rte_spinlock_lock(&seqlock->lock);
+	rte_seqcount_write_begin(&seqlock->count);
+}
+
+/**
+ * End a write-side critical section.
+ *
+ * @param seqlock
+ *   A pointer to the sequence lock.
+ */
+static inline void
+rte_seqlock_write_unlock(rte_seqlock_t *seqlock)
+{
+	rte_seqcount_write_end(&seqlock->count);
+	rte_spinlock_unlock(&seqlock->lock);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_SEQLOCK_H_ */
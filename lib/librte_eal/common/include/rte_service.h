@@ -0,0 +1,377 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_SERVICE_H_
+#define _RTE_SERVICE_H_
+
+/**
+ * @file
+ *
+ * Service functions
+ *
+ * The service functionality provided by this header allows a DPDK
+ * component to indicate that it requires a function call in order for
+ * it to perform its processing, for instance a software eventdev
+ * scheduler that needs to be called regularly to schedule events.
+ *
+ * An example usage of this functionality would be a component that
+ * registers a service to perform a particular packet processing
+ * duty: for example the eventdev software PMD. At startup the
+ * application requests all services that have been registered, and the
+ * service cores which are available, then maps the services to the
+ * service cores. Several services can be mapped to the same service
+ * core, in which case the core calls them one after the other, and a
+ * service can be mapped to several cores if it is multi-thread safe.
+ *
+ * The service cores are lcores given to the EAL with the -s option (a
+ * coremask) or added at runtime with rte_service_lcore_add(). They are
+ * not part of the lcores browsed by RTE_LCORE_FOREACH(), and the
+ * application cannot launch its own functions on them.
+ *
+ * The functions of this header are not thread-safe: they are meant to
+ * be called from the control plane, except
+ * rte_service_run_iter_on_app_lcore().
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum length of a service name, including '\0'. */
+#define RTE_SERVICE_NAME_MAX 32
+
+/** Maximum number of services that can be registered. */
+#define RTE_SERVICE_NUM_MAX 64
+
+/* Capabilities of a service.
+ *
+ * Use the *rte_service_probe_capability* function to check if a service
+ * is capable of a specific capability.
+ */
+/** When set, the service is capable of having multiple threads run it at
+ *  the same time.
+ */
+#define RTE_SERVICE_CAP_MT_SAFE (1 << 0)
+
+/** Cycles spent in the service callback, summed over all the lcores. */
+#define RTE_SERVICE_ATTR_CYCLES 0
+/** Number of calls to the service callback, summed over all the lcores. */
+#define RTE_SERVICE_ATTR_CALLS 1
+
+/**
+ * Return the number of services registered.
+ *
+ * The service ids are lower than RTE_SERVICE_NUM_MAX, and
+ * rte_service_get_name() returns NULL for an id that is not registered,
+ * so the application can browse the registered services.
+ *
+ * @return The number of services registered.
+ */
+uint32_t rte_service_get_count(void);
+
+/**
+ * Return the id of a service by name.
+ *
+ * @param name The name of the service to retrieve.
+ * @param[out] service_id A pointer to a uint32_t, to be filled in with
+ *   the id.
+ * @retval 0 Success. The service id is provided in *service_id*.
+ * @retval -EINVAL Null *service_id* pointer provided.
+ * @retval -ENODEV No such service registered.
+ */
+int32_t rte_service_get_by_name(const char *name, uint32_t *service_id);
+
+/**
+ * Return the name of the service.
+ *
+ * @return A pointer to the name of the service, or NULL if the id is
+ *   invalid.
+ */
+const char *rte_service_get_name(uint32_t id);
+
+/**
+ * Check if a service has a specific capability.
+ *
+ * This function returns if *service* implements *capability*.
+ * See RTE_SERVICE_CAP_* defines for a list of valid capabilities.
+ *
+ * @retval 1 Capability supported by this service instance.
+ * @retval 0 Capability not supported by this service instance.
+ */
+int32_t rte_service_probe_capability(uint32_t id, uint32_t capability);
+
+/**
+ * Map or unmap a service to a service lcore.
+ *
+ * Each service core runs the services mapped to it, one after the
+ * other. A service that is not multi-thread safe can be mapped to
+ * several lcores: in that case an atomic lock is taken around its
+ * callback so that a single lcore runs it at a time.
+ *
+ * @param service_id The service to map or unmap.
+ * @param lcore The lcore that will be mapped or unmapped to the service.
+ * @param enable Zero to unmap the service from the lcore, non-zero to
+ *   map it.
+ *
+ * @retval 0 lcore map updated successfully
+ * @retval -EINVAL An invalid service or lcore was provided.
+ */
+int32_t rte_service_map_lcore_set(uint32_t service_id, uint32_t lcore,
+		uint32_t enable);
+
+/**
+ * Retrieve the mapping of an lcore to a service.
+ *
+ * @param service_id The service to query.
+ * @param lcore The lcore to query.
+ *
+ * @retval 1 lcore is mapped to service
+ * @retval 0 lcore is not mapped to service
+ * @retval -EINVAL An invalid service or lcore was provided.
+ */
+int32_t rte_service_map_lcore_get(uint32_t service_id, uint32_t lcore);
+
+/**
+ * Set the runstate of the service.
+ *
+ * Each service is either running or stopped. Setting a non-zero
+ * runstate enables the service to run, while setting zero runstate
+ * disables it. The service is actually run only if its component also
+ * reports it running (see rte_service_component_runstate_set()).
+ *
+ * @param id The id of the service
+ * @param runstate The run state to apply to the service
+ *
+ * @retval 0 The service was successfully started
+ * @retval -EINVAL Invalid service id
+ */
+int32_t rte_service_runstate_set(uint32_t id, uint32_t runstate);
+
+/**
+ * Get the runstate for the service with *id*.
+ *
+ * @param id The id of the service
+ *
+ * @retval 1 Service is running
+ * @retval 0 Service is stopped
+ * @retval -EINVAL Invalid service id
+ */
+int32_t rte_service_runstate_get(uint32_t id);
+
+/**
+ * Enable or disable the statistics of a service.
+ *
+ * When enabled, the number of calls to the service callback and the
+ * number of TSC cycles spent in it are accounted, see
+ * rte_service_attr_get(). The accounting costs two rte_rdtsc() per
+ * call, so it is disabled by default.
+ *
+ * @retval 0 Success
+ * @retval -EINVAL Invalid service id
+ */
+int32_t rte_service_set_stats_enable(uint32_t id, int32_t enable);
+
+/**
+ * Run one iteration of a service on the calling lcore.
+ *
+ * This function allows an application to run a service on an
+ * application lcore (or a non-EAL thread) instead of a service lcore,
+ * for instance at a time where the application knows it has spare
+ * cycles.
+ *
+ * @param id The service to run.
+ * @param serialize_mt_unsafe If non-zero, a service that is not
+ *   multi-thread safe is run under its atomic lock, so that it does not
+ *   race with the service lcores or other application lcores running
+ *   it. It must be set if the service is also mapped to a service lcore.
+ *
+ * @retval 0 Service was run on the calling thread successfully
+ * @retval -EBUSY Another lcore is executing the service, and it is not a
+ *   multi-thread safe service, so the service was not run on this lcore
+ * @retval -ENOEXEC Service is not in a run-able state
+ * @retval -EINVAL Invalid service id
+ */
+int32_t rte_service_run_iter_on_app_lcore(uint32_t id,
+		uint32_t serialize_mt_unsafe);
+
+/**
+ * Start a service core.
+ *
+ * Starting a core makes the core begin polling the services mapped to
+ * it. Any services that are not running (by the application or by
+ * their component) are skipped.
+ *
+ * @retval 0 Success
+ * @retval -EINVAL Failed to start core. The *lcore_id* passed in is not
+ *   currently assigned to be a service core.
+ * @retval -EALREADY The core is already running.
+ */
+int32_t rte_service_lcore_start(uint32_t lcore_id);
+
+/**
+ * Stop a service core.
+ *
+ * Stopping a core makes the core become idle, but remain assigned as a
+ * service core. The service loop exits at the end of its current
+ * iteration; rte_eal_wait_lcore() can be used to wait for it.
+ *
+ * @retval 0 Success
+ * @retval -EINVAL Invalid *lcore_id* provided
+ * @retval -EALREADY Already stopped core
+ * @retval -EBUSY Failed to stop core, as it would cause a service to not
+ *   be run, as this is the only core currently running the service.
+ *   The application must stop the service first, and then stop the
+ *   lcore.
+ */
+int32_t rte_service_lcore_stop(uint32_t lcore_id);
+
+/**
+ * Add an lcore to the list of service lcores.
+ *
+ * The lcore must be an idle application lcore, other than the master
+ * lcore. Once added, it is no longer browsed by RTE_LCORE_FOREACH().
+ *
+ * @retval 0 Success
+ * @retval -EINVAL The lcore cannot be used as a service lcore.
+ * @retval -EALREADY The lcore is already a service lcore.
+ * @retval -EBUSY The lcore is running an application function.
+ */
+int32_t rte_service_lcore_add(uint32_t lcore);
+
+/**
+ * Remove an lcore from the list of service lcores.
+ *
+ * The lcore must be stopped, it becomes an application lcore again.
+ *
+ * @retval 0 Success
+ * @retval -EINVAL The lcore is not a service lcore.
+ * @retval -EBUSY The lcore is not stopped.
+ */
+int32_t rte_service_lcore_del(uint32_t lcore);
+
+/**
+ * Retrieve the number of service cores currently available.
+ *
+ * @return The number of service cores currently available.
+ */
+int32_t rte_service_lcore_count(void);
+
+/**
+ * Reset all service core mappings, and return the service cores to
+ * application lcores.
+ *
+ * The service cores that are running are stopped, and this function
+ * waits for them to exit their service loop.
+ *
+ * @retval 0 Success
+ */
+int32_t rte_service_lcore_reset_all(void);
+
+/**
+ * Retrieve the list of currently enabled service cores.
+ *
+ * @param array An array of at least rte_service_lcore_count() items.
+ *   If statically allocating the buffer, use RTE_MAX_LCORE.
+ * @param n The size of *array*.
+ * @retval >=0 Number of service cores that have been populated in the
+ *   array
+ * @retval -ENOMEM The provided array is not large enough to fill in the
+ *   service core list. No items have been populated.
+ */
+int32_t rte_service_lcore_list(uint32_t array[], uint32_t n);
+
+/**
+ * Get the number of services mapped to a service core.
+ *
+ * @param lcore The service core to query.
+ * @retval >=0 Number of services mapped to the core.
+ * @retval -EINVAL Invalid lcore provided
+ */
+int32_t rte_service_lcore_count_services(uint32_t lcore);
+
+/**
+ * Start all the services with a default mapping.
+ *
+ * Each registered service is mapped to one of the service cores, in a
+ * round-robin fashion, its runstate is set to running, and all the
+ * service cores are started. This is a convenience for applications
+ * that do not need a specific mapping.
+ *
+ * @retval 0 Success
+ * @retval -ENOTSUP No service lcore is available.
+ */
+int32_t rte_service_start_with_defaults(void);
+
+/**
+ * Get an attribute value of a service.
+ *
+ * The statistics must have been enabled with
+ * rte_service_set_stats_enable().
+ *
+ * @param id The service to query.
+ * @param attr_id The attribute, one of RTE_SERVICE_ATTR_*.
+ * @param[out] attr_value The value of the attribute.
+ * @retval 0 Success, *attr_value* is filled in.
+ * @retval -EINVAL Invalid service id, attribute or *attr_value* pointer.
+ */
+int32_t rte_service_attr_get(uint32_t id, uint32_t attr_id,
+		uint64_t *attr_value);
+
+/**
+ * Reset all the attributes of a service.
+ *
+ * @param id The service to reset.
+ * @retval 0 Success
+ * @retval -EINVAL Invalid service id
+ */
+int32_t rte_service_attr_reset_all(uint32_t id);
+
+/**
+ * Dump the statistics of a service, or of all services.
+ *
+ * @param f The file to write to.
+ * @param id The service to dump, or UINT32_MAX to dump all the services
+ *   and service cores.
+ * @retval 0 Success
+ * @retval -EINVAL Invalid service id
+ */
+int32_t rte_service_dump(FILE *f, uint32_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_SERVICE_H_ */
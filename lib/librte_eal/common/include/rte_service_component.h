@@ -0,0 +1,150 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_SERVICE_COMPONENT_H_
+#define _RTE_SERVICE_COMPONENT_H_
+
+/**
+ * @file
+ *
+ * Service component functions
+ *
+ * Include this file if you are writing a component that requires CPU
+ * cycles to operate, and you wish to run the component using service
+ * cores. Applications only use rte_service.h.
+ */
+
+#include <rte_service.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Signature of a callback function that can be registered as a
+ * service.
+ */
+typedef int32_t (*rte_service_func)(void *args);
+
+/**
+ * The specification of a service to register.
+ */
+struct rte_service_spec {
+	/** The name of the service. */
+	char name[RTE_SERVICE_NAME_MAX];
+	/** The callback to invoke to run one iteration of the service. */
+	rte_service_func callback;
+	/** The userdata pointer provided to the service callback. */
+	void *callback_userdata;
+	/** Flags to indicate the capabilities of this service, see
+	 *  RTE_SERVICE_CAP_*.
+	 */
+	uint32_t capabilities;
+	/** NUMA socket ID that this service is affinitized to. */
+	int socket_id;
+};
+
+/**
+ * Register a new service.
+ *
+ * A service represents a component that requires CPU time periodically
+ * to achieve its purpose.
+ *
+ * For example the eventdev SW PMD requires CPU cycles to perform its
+ * scheduling. This can be achieved by registering it as a service, and
+ * the application can then assign CPU resources to that service.
+ *
+ * Note that when a service component registers itself, it is not
+ * permitted to add or remove service-core threads, or modify
+ * lcore-to-service mappings. The only API that may be called by the
+ * service-component is *rte_service_component_runstate_set*, which
+ * indicates that the service component is ready to be executed.
+ *
+ * @param spec The specification of the service to register.
+ * @param[out] service_id A pointer to a uint32_t, which will be filled
+ *   in during registration of the service. It is set to the integer
+ *   representing the service number. If NULL, the id is not provided.
+ * @retval 0 Successfully registered the service.
+ * @retval -EINVAL Attempted to register an invalid service (eg, no
+ *   callback set, or name already registered).
+ * @retval -ENOSPC No space available to register the service.
+ */
+int32_t rte_service_component_register(const struct rte_service_spec *spec,
+		uint32_t *service_id);
+
+/**
+ * Unregister a service.
+ *
+ * The service is unmapped from all the service lcores. The component
+ * must make sure the service is no longer running, for instance by
+ * setting its runstate to stopped and waiting for
+ * rte_service_may_be_active() to return 0.
+ *
+ * @retval 0 The service was successfully unregistered.
+ * @retval -EINVAL Invalid service id.
+ */
+int32_t rte_service_component_unregister(uint32_t id);
+
+/**
+ * Set the runstate of a service from the component.
+ *
+ * A service is run only if both the component and the application set
+ * its runstate to running. The component uses this function to
+ * indicate whether it is ready to be run, for instance when the device
+ * is started or stopped.
+ *
+ * @param id The service to set the runstate of.
+ * @param runstate The state to apply, non-zero for running.
+ * @retval 0 The runstate was set.
+ * @retval -EINVAL Invalid service id.
+ */
+int32_t rte_service_component_runstate_set(uint32_t id, uint32_t runstate);
+
+/**
+ * Check whether a service may be running on a service lcore.
+ *
+ * Once the runstate of a service is set to stopped, the service lcores
+ * notice it at their next iteration. This function returns 0 once no
+ * service lcore can be executing the service callback anymore.
+ *
+ * @retval 1 The service may be executing on a service lcore.
+ * @retval 0 The service is not executing on any service lcore.
+ * @retval -EINVAL Invalid service id.
+ */
+int32_t rte_service_may_be_active(uint32_t id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_SERVICE_COMPONENT_H_ */
@@ -0,0 +1,282 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_TRACE_H_
+#define _RTE_TRACE_H_
+
+/**
+ * @file
+ *
+ * RTE Trace
+ *
+ * Low overhead tracing of the fast path. A trace point is declared at
+ * compile time with a name and the names of its arguments (up to
+ * RTE_TRACE_POINT_ARGS_MAX 64-bit integers). When a trace point is
+ * enabled, each call to RTE_TRACE_POINT_EMIT() writes a fixed size binary
+ * record (TSC, trace point id, lcore id and arguments) in a buffer private
+ * to the calling lcore, without any lock nor string formatting. When it
+ * is disabled, the cost is a load and a predicted branch.
+ *
+ * The per-lcore buffers are circular: the newest records overwrite the
+ * oldest ones. They are saved on demand with rte_trace_save() in a
+ * directory, as a CTF (Common Trace Format) metadata file and one binary
+ * stream per lcore, which can be read offline.
+ *
+ * Records emitted from non-EAL threads are dropped.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <sys/queue.h>
+
+#include <rte_common.h>
+#include <rte_eal.h>
+#include <rte_branch_prediction.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of arguments of a trace point. */
+#define RTE_TRACE_POINT_ARGS_MAX 6
+
+/**
+ * A trace point.
+ *
+ * Trace points are defined with RTE_TRACE_POINT_DEFINE() and are
+ * registered at startup.
+ */
+struct rte_trace_point {
+	volatile uint32_t enabled; /**< Checked on each emit. */
+	uint16_t id;               /**< Id of the trace point in the records. */
+	uint8_t nb_args;           /**< Number of arguments. */
+	const char *name;          /**< Name, e.g. "lib.ethdev.rx_burst". */
+	/** Names of the arguments, used in the trace metadata. */
+	const char *arg_names[RTE_TRACE_POINT_ARGS_MAX];
+	TAILQ_ENTRY(rte_trace_point) next; /**< Next in registered list. */
+};
+
+/**
+ * A trace record, as written in the per-lcore buffers and in the saved
+ * streams. Its size is 64 bytes.
+ */
+struct rte_trace_record {
+	uint64_t tsc;       /**< Timestamp, from rte_rdtsc(). */
+	uint16_t id;        /**< Id of the trace point. */
+	uint16_t lcore_id;  /**< Lcore which emitted the record. */
+	uint8_t nb_args;    /**< Number of valid arguments. */
+	uint8_t reserved[3];
+	uint64_t args[RTE_TRACE_POINT_ARGS_MAX]; /**< Arguments. */
+};
+
+/**
+ * Define a trace point. This must be done once, in a .c file; the
+ * headers that emit it declare it with RTE_TRACE_POINT_DECLARE().
+ *
+ * @param tp
+ *   The name of the trace point variable.
+ * @param tp_name
+ *   The name of the trace point, used to enable it and in the metadata.
+ * @param ...
+ *   The names of the arguments, as strings.
+ */
+#define RTE_TRACE_POINT_DEFINE(tp, tp_name, ...)			\
+struct rte_trace_point tp = {						\
+	.name = tp_name,						\
+	.nb_args = sizeof((const char *[]){ __VA_ARGS__ }) /		\
+		sizeof(const char *),					\
+	.arg_names = { __VA_ARGS__ },					\
+};									\
+RTE_INIT(tp##_register);						\
+static void tp##_register(void)						\
+{									\
+	rte_trace_point_register(&tp);					\
+}
+
+/**
+ * Declare a trace point defined in another file.
+ */
+#define RTE_TRACE_POINT_DECLARE(tp) extern struct rte_trace_point tp
+
+#ifdef RTE_ENABLE_TRACE
+/**
+ * Emit a trace point, if it is enabled.
+ *
+ * @param tp
+ *   The trace point variable.
+ * @param ...
+ *   The arguments, converted to uint64_t. Pointers must be cast to
+ *   uintptr_t. The arguments are not evaluated if the trace point is
+ *   disabled.
+ */
+#define RTE_TRACE_POINT_EMIT(tp, ...) do {				\
+	if (unlikely((tp).enabled)) {					\
+		const uint64_t __rte_trace_args[] = { __VA_ARGS__ };	\
+		__rte_trace_point_emit(&(tp), __rte_trace_args,		\
+			RTE_DIM(__rte_trace_args));			\
+	}								\
+} while (0)
+#else
+#define RTE_TRACE_POINT_EMIT(tp, ...) do { } while (0)
+#endif
+
+/**
+ * @internal Register a trace point, see RTE_TRACE_POINT_DEFINE().
+ *
+ * @param tp
+ *   The trace point.
+ * @return
+ *   0 on success, negative on error.
+ */
+int rte_trace_point_register(struct rte_trace_point *tp);
+
+/**
+ * @internal Write a record in the buffer of the calling lcore, see
+ * RTE_TRACE_POINT_EMIT().
+ */
+void __rte_trace_point_emit(const struct rte_trace_point *tp,
+		const uint64_t *args, unsigned int nb_args);
+
+/**
+ * Find a trace point by name.
+ *
+ * @param name
+ *   The name of the trace point.
+ * @return
+ *   The trace point, or NULL if not found.
+ */
+struct rte_trace_point *rte_trace_point_lookup(const char *name);
+
+/**
+ * Enable a trace point.
+ *
+ * The per-lcore buffers are allocated when the first trace point is
+ * enabled.
+ *
+ * @param tp
+ *   The trace point.
+ * @return
+ *   0 on success, negative on error (buffer allocation failure).
+ */
+int rte_trace_point_enable(struct rte_trace_point *tp);
+
+/**
+ * Disable a trace point.
+ *
+ * @param tp
+ *   The trace point.
+ */
+void rte_trace_point_disable(struct rte_trace_point *tp);
+
+/**
+ * Check if a trace point is enabled.
+ *
+ * @param tp
+ *   The trace point.
+ * @return
+ *   1 if enabled, 0 otherwise.
+ */
+int rte_trace_point_is_enabled(const struct rte_trace_point *tp);
+
+/**
+ * Enable or disable the trace points whose name matches a regular
+ * expression.
+ *
+ * @param regex
+ *   The regular expression (POSIX basic), e.g. "lib\.ethdev\..*".
+ * @param enable
+ *   Non-zero to enable the trace points, zero to disable them.
+ * @return
+ *   The number of matching trace points, or negative on error.
+ */
+int rte_trace_regexp(const char *regex, int enable);
+
+/**
+ * Enable or disable the trace points whose name matches a shell
+ * wildcard pattern, see fnmatch(3).
+ *
+ * @param pattern
+ *   The pattern, e.g. "lib.mempool.*".
+ * @param enable
+ *   Non-zero to enable the trace points, zero to disable them.
+ * @return
+ *   The number of matching trace points, or negative on error.
+ */
+int rte_trace_pattern(const char *pattern, int enable);
+
+/**
+ * Check if at least one trace point is enabled.
+ *
+ * @return
+ *   1 if a trace point is enabled, 0 otherwise.
+ */
+int rte_trace_is_enabled(void);
+
+/**
+ * Drop all the records in the per-lcore buffers.
+ *
+ * It must not be called while trace points are emitted.
+ */
+void rte_trace_reset(void);
+
+/**
+ * Save the trace in a directory.
+ *
+ * The directory is created if needed. It contains a "metadata" file
+ * describing the records in the CTF TSDL language, and a
+ * "channel0_<lcore>" binary stream per lcore, holding its records from
+ * the oldest to the newest. The buffers are not reset.
+ *
+ * It should not be called while trace points are emitted, or the
+ * newest records of the streams may be inconsistent.
+ *
+ * @param dir
+ *   The directory in which the trace is saved.
+ * @return
+ *   The number of records saved, or negative on error.
+ */
+int rte_trace_save(const char *dir);
+
+/**
+ * Dump the trace points and the state of the per-lcore buffers.
+ *
+ * @param f
+ *   The stream where the state is displayed.
+ */
+void rte_trace_dump(FILE *f);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_TRACE_H_ */
@@ -0,0 +1,781 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_service.h>
+#include <rte_service_component.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_memory.h>
+#include <rte_log.h>
+
+#include "eal_private.h"
+
+#define SERVICE_F_REGISTERED    (1 << 0)
+#define SERVICE_F_STATS_ENABLED (1 << 1)
+
+#define RUNSTATE_STOPPED 0
+#define RUNSTATE_RUNNING 1
+
+/* internal representation of a service */
+struct rte_service_spec_impl {
+	/* public part of the struct */
+	struct rte_service_spec spec;
+
+	/* internal flags, SERVICE_F_* */
+	uint8_t internal_flags;
+
+	/* per service runstates, both must be running for the service
+	 * to be called
+	 */
+	volatile uint8_t comp_runstate;
+	volatile uint8_t app_runstate;
+
+	/* number of lcores the service is mapped to */
+	rte_atomic32_t num_mapped_cores;
+	/* serializes the calls to a service which is not MT safe */
+	rte_atomic32_t execute_lock;
+} __rte_cache_aligned;
+
+/* the internal values of a service core */
+struct core_state {
+	/* map of the service IDs run on this core */
+	volatile uint64_t service_mask;
+	volatile uint8_t runstate;
+	uint8_t is_service_core;
+	volatile uint8_t service_active_on_lcore[RTE_SERVICE_NUM_MAX];
+	uint64_t loops;
+	/* statistics, only written by the lcore itself */
+	uint64_t calls_per_service[RTE_SERVICE_NUM_MAX];
+	uint64_t cycles_per_service[RTE_SERVICE_NUM_MAX];
+} __rte_cache_aligned;
+
+static struct rte_service_spec_impl rte_services[RTE_SERVICE_NUM_MAX];
+static struct core_state lcore_states[RTE_MAX_LCORE];
+static uint32_t rte_service_count;
+
+static inline int
+service_valid(uint32_t id)
+{
+	return id < RTE_SERVICE_NUM_MAX &&
+		(rte_services[id].internal_flags & SERVICE_F_REGISTERED);
+}
+
+static inline int
+service_mt_safe(const struct rte_service_spec_impl *s)
+{
+	return !!(s->spec.capabilities & RTE_SERVICE_CAP_MT_SAFE);
+}
+
+static inline int
+service_stats_enabled(const struct rte_service_spec_impl *s)
+{
+	return !!(s->internal_flags & SERVICE_F_STATS_ENABLED);
+}
+
+static inline int
+service_runnable(const struct rte_service_spec_impl *s)
+{
+	return s->comp_runstate == RUNSTATE_RUNNING &&
+		s->app_runstate == RUNSTATE_RUNNING;
+}
+
+int
+rte_service_init(void)
+{
+	struct rte_config *cfg = rte_eal_get_configuration();
+	uint32_t i;
+	int ret;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (cfg->lcore_role[i] != ROLE_SERVICE)
+			continue;
+		/* the lcore already has the service role, only set up
+		 * its state
+		 */
+		lcore_states[i].is_service_core = 1;
+		lcore_states[i].service_mask = 0;
+		lcore_states[i].runstate = RUNSTATE_STOPPED;
+	}
+
+	ret = rte_service_lcore_count();
+	if (ret > 0)
+		RTE_LOG(DEBUG, EAL, "%d service lcore(s) available\n", ret);
+
+	return 0;
+}
+
+uint32_t
+rte_service_get_count(void)
+{
+	return rte_service_count;
+}
+
+int32_t
+rte_service_get_by_name(const char *name, uint32_t *service_id)
+{
+	uint32_t i;
+
+	if (name == NULL || service_id == NULL)
+		return -EINVAL;
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		if (service_valid(i) &&
+				strcmp(name, rte_services[i].spec.name) == 0) {
+			*service_id = i;
+			return 0;
+		}
+	}
+
+	return -ENODEV;
+}
+
+const char *
+rte_service_get_name(uint32_t id)
+{
+	if (!service_valid(id))
+		return NULL;
+	return rte_services[id].spec.name;
+}
+
+int32_t
+rte_service_probe_capability(uint32_t id, uint32_t capability)
+{
+	if (!service_valid(id))
+		return -EINVAL;
+	return !!(rte_services[id].spec.capabilities & capability);
+}
+
+int32_t
+rte_service_component_register(const struct rte_service_spec *spec,
+		uint32_t *id_ptr)
+{
+	struct rte_service_spec_impl *s;
+	uint32_t id;
+	uint32_t i;
+
+	if (spec == NULL || spec->callback == NULL ||
+			spec->name[0] == '\0' ||
+			strnlen(spec->name, RTE_SERVICE_NAME_MAX) ==
+				RTE_SERVICE_NAME_MAX)
+		return -EINVAL;
+
+	if (rte_service_get_by_name(spec->name, &id) == 0)
+		return -EINVAL;
+
+	for (id = 0; id < RTE_SERVICE_NUM_MAX; id++) {
+		if (!service_valid(id))
+			break;
+	}
+	if (id == RTE_SERVICE_NUM_MAX)
+		return -ENOSPC;
+
+	s = &rte_services[id];
+	memset(s, 0, sizeof(*s));
+	s->spec = *spec;
+	s->comp_runstate = RUNSTATE_STOPPED;
+	s->app_runstate = RUNSTATE_STOPPED;
+	rte_atomic32_init(&s->num_mapped_cores);
+	rte_atomic32_init(&s->execute_lock);
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		lcore_states[i].calls_per_service[id] = 0;
+		lcore_states[i].cycles_per_service[id] = 0;
+		lcore_states[i].service_active_on_lcore[id] = 0;
+	}
+
+	rte_smp_wmb();
+	s->internal_flags |= SERVICE_F_REGISTERED;
+	rte_service_count++;
+
+	if (id_ptr != NULL)
+		*id_ptr = id;
+
+	return 0;
+}
+
+int32_t
+rte_service_component_unregister(uint32_t id)
+{
+	uint64_t service_mask;
+	uint32_t i;
+
+	if (!service_valid(id))
+		return -EINVAL;
+
+	service_mask = UINT64_C(1) << id;
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		lcore_states[i].service_mask &= ~service_mask;
+	rte_atomic32_set(&rte_services[id].num_mapped_cores, 0);
+
+	rte_services[id].internal_flags &= ~SERVICE_F_REGISTERED;
+	rte_smp_wmb();
+	rte_service_count--;
+
+	return 0;
+}
+
+int32_t
+rte_service_component_runstate_set(uint32_t id, uint32_t runstate)
+{
+	if (!service_valid(id))
+		return -EINVAL;
+
+	rte_services[id].comp_runstate =
+		runstate ? RUNSTATE_RUNNING : RUNSTATE_STOPPED;
+	rte_smp_wmb();
+
+	return 0;
+}
+
+int32_t
+rte_service_runstate_set(uint32_t id, uint32_t runstate)
+{
+	if (!service_valid(id))
+		return -EINVAL;
+
+	rte_services[id].app_runstate =
+		runstate ? RUNSTATE_RUNNING : RUNSTATE_STOPPED;
+	rte_smp_wmb();
+
+	return 0;
+}
+
+int32_t
+rte_service_runstate_get(uint32_t id)
+{
+	if (!service_valid(id))
+		return -EINVAL;
+
+	rte_smp_rmb();
+	return service_runnable(&rte_services[id]);
+}
+
+int32_t
+rte_service_may_be_active(uint32_t id)
+{
+	uint32_t i;
+
+	if (!service_valid(id))
+		return -EINVAL;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (lcore_states[i].is_service_core &&
+				lcore_states[i].service_active_on_lcore[id])
+			return 1;
+	}
+
+	return 0;
+}
+
+int32_t
+rte_service_set_stats_enable(uint32_t id, int32_t enable)
+{
+	if (!service_valid(id))
+		return -EINVAL;
+
+	if (enable)
+		rte_services[id].internal_flags |= SERVICE_F_STATS_ENABLED;
+	else
+		rte_services[id].internal_flags &= ~SERVICE_F_STATS_ENABLED;
+
+	return 0;
+}
+
+static inline void
+service_runner_do_callback(struct rte_service_spec_impl *s,
+		struct core_state *cs, uint32_t id)
+{
+	void *userdata = s->spec.callback_userdata;
+	uint64_t start;
+
+	if (cs == NULL || !service_stats_enabled(s)) {
+		s->spec.callback(userdata);
+		return;
+	}
+
+	start = rte_rdtsc();
+	s->spec.callback(userdata);
+	cs->cycles_per_service[id] += rte_rdtsc() - start;
+	cs->calls_per_service[id]++;
+}
+
+/* Run one iteration of a service, taking its lock if it is not MT safe
+ * and may run on another lcore at the same time.
+ */
+static inline int32_t
+service_run(uint32_t id, struct core_state *cs, int serialize)
+{
+	struct rte_service_spec_impl *s = &rte_services[id];
+
+	if (!service_runnable(s))
+		return -ENOEXEC;
+
+	if (serialize && !service_mt_safe(s)) {
+		if (!rte_atomic32_test_and_set(&s->execute_lock))
+			return -EBUSY;
+		service_runner_do_callback(s, cs, id);
+		rte_atomic32_clear(&s->execute_lock);
+	} else
+		service_runner_do_callback(s, cs, id);
+
+	return 0;
+}
+
+int32_t
+rte_service_run_iter_on_app_lcore(uint32_t id, uint32_t serialize_mt_unsafe)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	struct core_state *cs = NULL;
+
+	if (!service_valid(id))
+		return -EINVAL;
+
+	/* statistics are kept per lcore, non-EAL threads are not
+	 * accounted
+	 */
+	if (lcore_id < RTE_MAX_LCORE)
+		cs = &lcore_states[lcore_id];
+
+	return service_run(id, cs, serialize_mt_unsafe);
+}
+
+static int32_t
+rte_service_runner_func(void *arg)
+{
+	const unsigned int lcore = rte_lcore_id();
+	struct core_state *cs = &lcore_states[lcore];
+	uint64_t service_mask;
+	uint32_t i;
+
+	RTE_SET_USED(arg);
+
+	while (cs->runstate == RUNSTATE_RUNNING) {
+		service_mask = cs->service_mask;
+
+		for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+			if (!(service_mask & (UINT64_C(1) << i))) {
+				cs->service_active_on_lcore[i] = 0;
+				continue;
+			}
+			if (!service_runnable(&rte_services[i])) {
+				cs->service_active_on_lcore[i] = 0;
+				continue;
+			}
+			cs->service_active_on_lcore[i] = 1;
+
+			/* always take the lock of an MT unsafe service: an
+			 * application lcore may run it at the same time, and
+			 * the lock is not contended otherwise
+			 */
+			service_run(i, cs, 1);
+		}
+
+		cs->loops++;
+		rte_smp_rmb();
+	}
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++)
+		cs->service_active_on_lcore[i] = 0;
+
+	return 0;
+}
+
+int32_t
+rte_service_lcore_count(void)
+{
+	int32_t count = 0;
+	uint32_t i;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		count += lcore_states[i].is_service_core;
+
+	return count;
+}
+
+int32_t
+rte_service_lcore_list(uint32_t array[], uint32_t n)
+{
+	uint32_t count = rte_service_lcore_count();
+	uint32_t i, idx = 0;
+
+	if (count > n)
+		return -ENOMEM;
+
+	if (array == NULL)
+		return -EINVAL;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (lcore_states[i].is_service_core)
+			array[idx++] = i;
+	}
+
+	return count;
+}
+
+int32_t
+rte_service_lcore_count_services(uint32_t lcore)
+{
+	if (lcore >= RTE_MAX_LCORE || !lcore_states[lcore].is_service_core)
+		return -EINVAL;
+
+	return __builtin_popcountll(lcore_states[lcore].service_mask);
+}
+
+int32_t
+rte_service_start_with_defaults(void)
+{
+	uint32_t ids[RTE_MAX_LCORE];
+	int32_t lcore_count;
+	uint32_t lcore_iter = 0;
+	uint32_t i;
+	int32_t ret;
+
+	lcore_count = rte_service_lcore_list(ids, RTE_MAX_LCORE);
+	if (lcore_count <= 0)
+		return -ENOTSUP;
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		if (!service_valid(i))
+			continue;
+		rte_service_map_lcore_set(i, ids[lcore_iter], 1);
+		lcore_iter = (lcore_iter + 1) % lcore_count;
+		rte_service_runstate_set(i, 1);
+	}
+
+	for (i = 0; i < (uint32_t)lcore_count; i++) {
+		ret = rte_service_lcore_start(ids[i]);
+		if (ret != 0 && ret != -EALREADY)
+			return ret;
+	}
+
+	return 0;
+}
+
+int32_t
+rte_service_map_lcore_set(uint32_t id, uint32_t lcore, uint32_t enable)
+{
+	struct rte_service_spec_impl *s;
+	uint64_t sid_mask;
+	int mapped;
+
+	if (!service_valid(id) || lcore >= RTE_MAX_LCORE ||
+			!lcore_states[lcore].is_service_core)
+		return -EINVAL;
+
+	s = &rte_services[id];
+	sid_mask = UINT64_C(1) << id;
+	mapped = !!(lcore_states[lcore].service_mask & sid_mask);
+
+	if (enable && !mapped) {
+		rte_atomic32_inc(&s->num_mapped_cores);
+		lcore_states[lcore].service_mask |= sid_mask;
+	} else if (!enable && mapped) {
+		lcore_states[lcore].service_mask &= ~sid_mask;
+		rte_atomic32_dec(&s->num_mapped_cores);
+	}
+
+	return 0;
+}
+
+int32_t
+rte_service_map_lcore_get(uint32_t id, uint32_t lcore)
+{
+	if (!service_valid(id) || lcore >= RTE_MAX_LCORE ||
+			!lcore_states[lcore].is_service_core)
+		return -EINVAL;
+
+	return !!(lcore_states[lcore].service_mask & (UINT64_C(1) << id));
+}
+
+static void
+service_lcore_set_role(uint32_t lcore, enum rte_lcore_role_t role)
+{
+	struct rte_config *cfg = rte_eal_get_configuration();
+
+	if (cfg->lcore_role[lcore] == ROLE_RTE && role != ROLE_RTE)
+		cfg->lcore_count--;
+	else if (cfg->lcore_role[lcore] != ROLE_RTE && role == ROLE_RTE)
+		cfg->lcore_count++;
+	cfg->lcore_role[lcore] = role;
+}
+
+int32_t
+rte_service_lcore_add(uint32_t lcore)
+{
+	struct core_state *cs;
+
+	if (lcore >= RTE_MAX_LCORE)
+		return -EINVAL;
+
+	cs = &lcore_states[lcore];
+	if (cs->is_service_core)
+		return -EALREADY;
+
+	/* only an lcore with an EAL thread, other than the master, can
+	 * run services
+	 */
+	if (rte_eal_lcore_role(lcore) != ROLE_RTE ||
+			lcore == rte_get_master_lcore())
+		return -EINVAL;
+
+	if (rte_eal_get_lcore_state(lcore) == RUNNING)
+		return -EBUSY;
+
+	/* collect the FINISHED state of a previous application function */
+	rte_eal_wait_lcore(lcore);
+
+	service_lcore_set_role(lcore, ROLE_SERVICE);
+	cs->service_mask = 0;
+	cs->runstate = RUNSTATE_STOPPED;
+	cs->is_service_core = 1;
+
+	return 0;
+}
+
+int32_t
+rte_service_lcore_del(uint32_t lcore)
+{
+	struct core_state *cs;
+	uint32_t i;
+
+	if (lcore >= RTE_MAX_LCORE)
+		return -EINVAL;
+
+	cs = &lcore_states[lcore];
+	if (!cs->is_service_core)
+		return -EINVAL;
+
+	if (cs->runstate != RUNSTATE_STOPPED ||
+			rte_eal_get_lcore_state(lcore) == RUNNING)
+		return -EBUSY;
+
+	rte_eal_wait_lcore(lcore);
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		if (cs->service_mask & (UINT64_C(1) << i))
+			rte_atomic32_dec(&rte_services[i].num_mapped_cores);
+	}
+	cs->service_mask = 0;
+	cs->is_service_core = 0;
+	service_lcore_set_role(lcore, ROLE_RTE);
+
+	return 0;
+}
+
+int32_t
+rte_service_lcore_start(uint32_t lcore)
+{
+	struct core_state *cs;
+	int ret;
+
+	if (lcore >= RTE_MAX_LCORE)
+		return -EINVAL;
+
+	cs = &lcore_states[lcore];
+	if (!cs->is_service_core)
+		return -EINVAL;
+
+	if (cs->runstate == RUNSTATE_RUNNING)
+		return -EALREADY;
+
+	/* the service loop of a previous start may not be collected yet */
+	rte_eal_wait_lcore(lcore);
+
+	cs->runstate = RUNSTATE_RUNNING;
+	rte_smp_wmb();
+
+	ret = rte_eal_remote_launch(rte_service_runner_func, NULL, lcore);
+	if (ret < 0)
+		cs->runstate = RUNSTATE_STOPPED;
+
+	return ret;
+}
+
+int32_t
+rte_service_lcore_stop(uint32_t lcore)
+{
+	struct core_state *cs;
+	uint64_t service_mask;
+	uint32_t i;
+
+	if (lcore >= RTE_MAX_LCORE)
+		return -EINVAL;
+
+	cs = &lcore_states[lcore];
+	if (!cs->is_service_core)
+		return -EINVAL;
+
+	if (cs->runstate == RUNSTATE_STOPPED)
+		return -EALREADY;
+
+	/* refuse to stop the last lcore running a running service */
+	service_mask = cs->service_mask;
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		if (!(service_mask & (UINT64_C(1) << i)) ||
+				!service_runnable(&rte_services[i]))
+			continue;
+		if (rte_atomic32_read(&rte_services[i].num_mapped_cores) == 1)
+			return -EBUSY;
+	}
+
+	cs->runstate = RUNSTATE_STOPPED;
+	rte_smp_wmb();
+
+	return 0;
+}
+
+int32_t
+rte_service_lcore_reset_all(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (!lcore_states[i].is_service_core)
+			continue;
+		lcore_states[i].runstate = RUNSTATE_STOPPED;
+		rte_smp_wmb();
+		rte_eal_wait_lcore(i);
+		lcore_states[i].service_mask = 0;
+		lcore_states[i].is_service_core = 0;
+		service_lcore_set_role(i, ROLE_RTE);
+	}
+
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++)
+		rte_atomic32_set(&rte_services[i].num_mapped_cores, 0);
+
+	return 0;
+}
+
+int32_t
+rte_service_attr_get(uint32_t id, uint32_t attr_id, uint64_t *attr_value)
+{
+	uint64_t sum = 0;
+	uint32_t i;
+
+	if (!service_valid(id) || attr_value == NULL)
+		return -EINVAL;
+
+	switch (attr_id) {
+	case RTE_SERVICE_ATTR_CYCLES:
+		for (i = 0; i < RTE_MAX_LCORE; i++)
+			sum += lcore_states[i].cycles_per_service[id];
+		break;
+	case RTE_SERVICE_ATTR_CALLS:
+		for (i = 0; i < RTE_MAX_LCORE; i++)
+			sum += lcore_states[i].calls_per_service[id];
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	*attr_value = sum;
+	return 0;
+}
+
+int32_t
+rte_service_attr_reset_all(uint32_t id)
+{
+	uint32_t i;
+
+	if (!service_valid(id))
+		return -EINVAL;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		lcore_states[i].calls_per_service[id] = 0;
+		lcore_states[i].cycles_per_service[id] = 0;
+	}
+
+	return 0;
+}
+
+static void
+service_dump_one(FILE *f, uint32_t id)
+{
+	struct rte_service_spec_impl *s = &rte_services[id];
+	uint64_t calls = 0, cycles = 0;
+
+	rte_service_attr_get(id, RTE_SERVICE_ATTR_CALLS, &calls);
+	rte_service_attr_get(id, RTE_SERVICE_ATTR_CYCLES, &cycles);
+
+	fprintf(f, "  %s: id=%u runstate=%s/%s mt_safe=%d mapped_cores=%d "
+		"stats=%s\n", s->spec.name, id,
+		s->comp_runstate == RUNSTATE_RUNNING ? "running" : "stopped",
+		s->app_runstate == RUNSTATE_RUNNING ? "running" : "stopped",
+		service_mt_safe(s), rte_atomic32_read(&s->num_mapped_cores),
+		service_stats_enabled(s) ? "on" : "off");
+	fprintf(f, "    calls=%"PRIu64" cycles=%"PRIu64
+		" avg_cycles_per_call=%"PRIu64"\n", calls, cycles,
+		calls == 0 ? 0 : cycles / calls);
+}
+
+int32_t
+rte_service_dump(FILE *f, uint32_t id)
+{
+	uint32_t i;
+
+	if (id != UINT32_MAX) {
+		if (!service_valid(id))
+			return -EINVAL;
+		fprintf(f, "Service:\n");
+		service_dump_one(f, id);
+		return 0;
+	}
+
+	fprintf(f, "Services (%u registered):\n", rte_service_count);
+	for (i = 0; i < RTE_SERVICE_NUM_MAX; i++) {
+		if (service_valid(i))
+			service_dump_one(f, i);
+	}
+
+	fprintf(f, "Service cores (%d):\n", rte_service_lcore_count());
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (!lcore_states[i].is_service_core)
+			continue;
+		fprintf(f, "  lcore %u: %s service_mask=0x%"PRIx64
+			" loops=%"PRIu64"\n", i,
+			lcore_states[i].runstate == RUNSTATE_RUNNING ?
+				"running" : "stopped",
+			lcore_states[i].service_mask, lcore_states[i].loops);
+	}
+
+	return 0;
+}
@@ -353,6 +353,7 @@ eal_usage(const char *prgname)
 	       "  --"OPT_HUGE_DIR"          Directory where hugetlbfs is mounted\n"
 	       "  --"OPT_FILE_PREFIX"       Prefix for hugepage filenames\n"
 	       "  --"OPT_BASE_VIRTADDR"     Base virtual address\n"
+	       "  --"OPT_HUGE_INIT_THREADS" Number of threads mapping hugepages at init\n"
 	       "  --"OPT_CREATE_UIO_DEV"    Create /dev/uioX (usually done by hotplug)\n"
 	       "  --"OPT_VFIO_INTR"         Interrupt mode for VFIO (legacy|msi|msix)\n"
 	       "  --"OPT_XEN_DOM0"          Support running on Xen dom0 without hugetlbfs\n"
@@ -456,6 +457,26 @@ eal_parse_base_virtaddr(const char *arg)
 	return 0;
 }
 
+static int
+eal_parse_huge_init_threads(const char *arg)
+{
+	char *end;
+	unsigned long num;
+
+	errno = 0;
+	num = strtoul(arg, &end, 0);
+
+	/* check for errors */
+	if ((errno != 0) || (arg[0] == '\0') || end == NULL || (*end != '\0'))
+		return -1;
+	if (num == 0 || num > RTE_MAX_LCORE)
+		return -1;
+
+	internal_config.huge_init_threads = num;
+
+	return 0;
+}
+
 static int
 eal_parse_vfio_intr(const char *mode)
 {
@@ -597,6 +618,16 @@ eal_parse_args(int argc, char **argv)
 			}
 			break;
 
+		case OPT_HUGE_INIT_THREADS_NUM:
+			if (eal_parse_huge_init_threads(optarg) < 0) {
+				RTE_LOG(ERR, EAL, "invalid parameter for --"
+						OPT_HUGE_INIT_THREADS "\n");
+				eal_usage(prgname);
+				ret = -1;
+				goto out;
+			}
+			break;
+
 		case OPT_VFIO_INTR_NUM:
 			if (eal_parse_vfio_intr(optarg) < 0) {
 				RTE_LOG(ERR, EAL, "invalid parameters for --"
@@ -830,6 +861,8 @@ rte_eal_init(int argc, char **argv)
 
 	rte_config_init();
 
+	eal_lcore_var_bind();
+
 	if (rte_eal_log_init(logid, internal_config.syslog_facility) < 0) {
 		rte_eal_init_alert("Cannot init logging.");
 		rte_errno = ENOMEM;
@@ -897,13 +930,23 @@ rte_eal_init(int argc, char **argv)
 		return -1;
 	}
 
+	if (internal_config.log_async && rte_log_async_start() < 0) {
+		rte_eal_init_alert("Cannot start asynchronous log\n");
+		rte_errno = ENOMEM;
+		return -1;
+	}
+
 	if (rte_bus_scan()) {
 		rte_eal_init_alert("Cannot scan the buses for devices\n");
 		rte_errno = ENODEV;
 		return -1;
 	}
 
-	RTE_LCORE_FOREACH_SLAVE(i) {
+	/* service lcores get a thread too, they run the service loop */
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (i == (int)rte_config.master_lcore ||
+				rte_config.lcore_role[i] == ROLE_OFF)
+			continue;
 
 		/*
 		 * create communication pipes between master thread
@@ -939,6 +982,18 @@ rte_eal_init(int argc, char **argv)
 	rte_eal_mp_remote_launch(sync_func, NULL, SKIP_MASTER);
 	rte_eal_mp_wait_lcore();
 
+	if (rte_trace_init() < 0) {
+		rte_eal_init_alert("Cannot init trace\n");
+		rte_errno = ENOMEM;
+		return -1;
+	}
+
+	if (rte_service_init() < 0) {
+		rte_eal_init_alert("Cannot init services\n");
+		rte_errno = ENOTSUP;
+		return -1;
+	}
+
 	/* Probe all the buses and devices/drivers on them */
 	if (rte_bus_probe()) {
 		rte_eal_init_alert("Cannot probe devices\n");
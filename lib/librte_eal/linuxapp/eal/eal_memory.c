@@ -83,6 +83,7 @@
 #include <sys/time.h>
 #include <signal.h>
 #include <setjmp.h>
+#include <pthread.h>
 
 #include <rte_log.h>
 #include <rte_memory.h>
@@ -96,6 +97,7 @@
 #include <rte_string_fns.h>
 
 #include "eal_private.h"
+#include "eal_thread.h"
 #include "eal_internal_cfg.h"
 #include "eal_filesystem.h"
 #include "eal_hugepages.h"
@@ -242,16 +244,16 @@ rte_mem_virt2phy(const void *virtaddr)
 }
 
 /*
- * For each hugepage in hugepg_tbl, fill the physaddr value. We find
- * it by browsing the /proc/self/pagemap special file.
+ * For each of the nb_pages first hugepages in hugepg_tbl, fill the physaddr
+ * value. We find it by browsing the /proc/self/pagemap special file.
  */
 static int
-find_physaddrs(struct hugepage_file *hugepg_tbl, struct hugepage_info *hpi)
+find_physaddrs(struct hugepage_file *hugepg_tbl, unsigned int nb_pages)
 {
 	unsigned int i;
 	phys_addr_t addr;
 
-	for (i = 0; i < hpi->num_pages[0]; i++) {
+	for (i = 0; i < nb_pages; i++) {
 		addr = rte_mem_virt2phy(hugepg_tbl[i].orig_va);
 		if (addr == RTE_BAD_PHYS_ADDR)
 			return -1;
@@ -371,11 +373,17 @@ get_virtual_area(size_t *size, size_t hugepage_sz)
 	return addr;
 }
 
-static sigjmp_buf huge_jmpenv;
+/* Maximum number of threads faulting hugepages in on each NUMA socket */
+#define HUGEPAGE_INIT_THREADS_PER_SOCKET 4
+
+/* SIGBUS is delivered to the thread faulting the page in, so each
+ * mapping thread needs its own jump buffer.
+ */
+static RTE_DEFINE_PER_LCORE(sigjmp_buf, huge_jmpenv);
 
 static void huge_sigbus_handler(int signo __rte_unused)
 {
-	siglongjmp(huge_jmpenv, 1);
+	siglongjmp(RTE_PER_LCORE(huge_jmpenv), 1);
 }
 
 /* Put setjmp into a wrap method to avoid compiling error. Any non-volatile,
@@ -384,19 +392,345 @@ static void huge_sigbus_handler(int signo __rte_unused)
  */
 static int huge_wrap_sigsetjmp(void)
 {
-	return sigsetjmp(huge_jmpenv, 1);
+	return sigsetjmp(RTE_PER_LCORE(huge_jmpenv), 1);
+}
+
+/*
+ * Reserve a virtual area of *size bytes aligned on hugepage_sz. Unlike
+ * get_virtual_area(), the area is kept mapped with PROT_NONE, so that
+ * nothing else (thread stacks for instance) can be placed in it while
+ * hugepages are mapped over it with MAP_FIXED. If it fails, retry with a
+ * smaller zone; *size is 0 and NULL is returned if nothing can be reserved.
+ */
+static void *
+reserve_virtual_area(size_t *size, size_t hugepage_sz)
+{
+	void *hint = NULL, *addr, *aligned;
+
+	if (internal_config.base_virtaddr != 0)
+		hint = (void *)(uintptr_t)(internal_config.base_virtaddr +
+				baseaddr_offset);
+
+	do {
+		addr = mmap(hint, (*size) + hugepage_sz, PROT_NONE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+				-1, 0);
+		if (addr == MAP_FAILED)
+			*size -= hugepage_sz;
+	} while (addr == MAP_FAILED && *size > 0);
+
+	if (addr == MAP_FAILED) {
+		RTE_LOG(DEBUG, EAL, "Cannot reserve a virtual area: %s\n",
+			strerror(errno));
+		*size = 0;
+		return NULL;
+	}
+
+	/* give back the unaligned head and the unused tail */
+	aligned = RTE_PTR_ALIGN_CEIL(addr, hugepage_sz);
+	if (aligned != addr)
+		munmap(addr, RTE_PTR_DIFF(aligned, addr));
+	munmap(RTE_PTR_ADD(aligned, *size),
+		hugepage_sz - RTE_PTR_DIFF(aligned, addr));
+
+	RTE_LOG(DEBUG, EAL, "Virtual area reserved at %p (size = 0x%zx)\n",
+		aligned, *size);
+
+	/* increment offset */
+	baseaddr_offset += *size;
+
+	return aligned;
+}
+
+/*
+ * Create the file backing a hugepage in hugetlbfs, and mmap() it at addr
+ * (anywhere if addr is NULL), storing the virtual address in
+ * hf->orig_va. The page is faulted in, hence zeroed by the kernel,
+ * before returning.
+ */
+static int
+map_hugepage_orig(struct hugepage_file *hf, uint64_t hugepage_sz, void *addr)
+{
+	int fd, flags = MAP_SHARED | MAP_POPULATE;
+	void *virtaddr;
+
+	/* try to create hugepage file */
+	fd = open(hf->filepath, O_CREAT | O_RDWR, 0600);
+	if (fd < 0) {
+		RTE_LOG(DEBUG, EAL, "%s(): open failed: %s\n", __func__,
+				strerror(errno));
+		return -1;
+	}
+
+	if (addr != NULL)
+		flags |= MAP_FIXED;
+
+	/* map the segment, and populate page tables,
+	 * the kernel fills this segment with zeros */
+	virtaddr = mmap(addr, hugepage_sz, PROT_READ | PROT_WRITE, flags, fd, 0);
+	if (virtaddr == MAP_FAILED) {
+		RTE_LOG(DEBUG, EAL, "%s(): mmap failed: %s\n", __func__,
+				strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	/* In linux, hugetlb limitations, like cgroup, are
+	 * enforced at fault time instead of mmap(), even
+	 * with the option of MAP_POPULATE. Kernel will send
+	 * a SIGBUS signal. To avoid to be killed, save stack
+	 * environment here, if SIGBUS happens, we can jump
+	 * back here.
+	 */
+	if (huge_wrap_sigsetjmp()) {
+		RTE_LOG(DEBUG, EAL, "SIGBUS: Cannot mmap more "
+			"hugepages of size %u MB\n",
+			(unsigned)(hugepage_sz / 0x100000));
+		munmap(virtaddr, hugepage_sz);
+		close(fd);
+		unlink(hf->filepath);
+		return -1;
+	}
+	*(int *)virtaddr = 0;
+
+	/* set shared flock on the file. */
+	if (flock(fd, LOCK_SH | LOCK_NB) == -1) {
+		RTE_LOG(DEBUG, EAL, "%s(): Locking file failed:%s \n",
+			__func__, strerror(errno));
+		munmap(virtaddr, hugepage_sz);
+		close(fd);
+		return -1;
+	}
+
+	close(fd);
+
+	hf->orig_va = virtaddr;
+	return 0;
+}
+
+/* Slice of the hugepage table mapped by one thread at init */
+struct hugepage_map_worker {
+	struct hugepage_file *hugepg_tbl; /**< first page of the slice */
+	uint64_t hugepage_sz;             /**< size of the pages */
+	void *va;                 /**< reserved area for the slice, or NULL */
+	unsigned int nb_reserved; /**< number of pages fitting in va */
+	unsigned int nb_pages;    /**< number of pages in the slice */
+	unsigned int nb_mapped;   /**< number of pages actually mapped */
+	int find_phys;            /**< true to look up physical addresses */
+	int cpu;                  /**< cpu to run on, or -1 to not pin */
+	int started;              /**< true if run in its own thread */
+	int ret;                  /**< 0 on success, -1 on error */
+	pthread_t tid;
+};
+
+static void *
+hugepage_map_worker_main(void *arg)
+{
+	struct hugepage_map_worker *w = arg;
+	unsigned int i;
+
+	if (w->cpu >= 0) {
+		rte_cpuset_t cpuset;
+
+		/* not fatal, the pages may just come from a remote socket */
+		CPU_ZERO(&cpuset);
+		CPU_SET(w->cpu, &cpuset);
+		if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset),
+				&cpuset) != 0)
+			RTE_LOG(DEBUG, EAL, "Cannot pin hugepage mapping "
+				"thread on cpu %d\n", w->cpu);
+	}
+
+	for (i = 0; i < w->nb_pages; i++) {
+		void *addr = NULL;
+
+		if (i < w->nb_reserved)
+			addr = RTE_PTR_ADD(w->va, i * w->hugepage_sz);
+		if (map_hugepage_orig(&w->hugepg_tbl[i], w->hugepage_sz,
+				addr) < 0)
+			break;
+	}
+	w->nb_mapped = i;
+
+	/* release the part of the reserved area left unused */
+	if (i < w->nb_reserved)
+		munmap(RTE_PTR_ADD(w->va, i * w->hugepage_sz),
+			(w->nb_reserved - i) * w->hugepage_sz);
+
+	w->ret = 0;
+	if (w->find_phys && find_physaddrs(w->hugepg_tbl, w->nb_mapped) < 0)
+		w->ret = -1;
+
+	return NULL;
+}
+
+/*
+ * Fill cpus[] with up to max cpus to map hugepages from, taking at most
+ * max_per_socket cpus on each NUMA socket, and interleaving sockets so
+ * that each of them gets its share when max is the limiting factor.
+ * Return the number of cpus found.
+ */
+static unsigned int
+hugepage_init_cpus(int *cpus, unsigned int max, unsigned int max_per_socket)
+{
+	int cpu_socket[RTE_MAX_LCORE];
+	unsigned int cpu, socket, rank, seen, found, n = 0;
+
+	for (cpu = 0; cpu < RTE_MAX_LCORE; cpu++)
+		cpu_socket[cpu] = eal_cpu_detected(cpu) ?
+			(int)eal_cpu_socket_id(cpu) : -1;
+
+	for (rank = 0; rank < max_per_socket && n < max; rank++) {
+		found = 0;
+		for (socket = 0; socket < RTE_MAX_NUMA_NODES && n < max;
+				socket++) {
+			seen = 0;
+			for (cpu = 0; cpu < RTE_MAX_LCORE; cpu++) {
+				if (cpu_socket[cpu] != (int)socket)
+					continue;
+				if (seen++ == rank) {
+					cpus[n++] = cpu;
+					found = 1;
+					break;
+				}
+			}
+		}
+		if (!found)
+			break;
+	}
+
+	return n;
+}
+
+/*
+ * Mmap all hugepages of hugepage table for the first time: for each page,
+ * open a file in hugetlbfs, then mmap() hugepage_sz data in it and store
+ * the virtual address in hugepg_tbl[i].orig_va. Physical addresses are
+ * looked up as well when available.
+ *
+ * Faulting the pages in (and having the kernel zero them) dominates init
+ * time with large amounts of memory, so the table is split in slices
+ * mapped by threads pinned on each NUMA socket. All pages are mapped in
+ * one reserved virtual area when possible, so that remapping them may
+ * not be needed once sorted by physical address.
+ *
+ * On success, the mapped pages are moved to the beginning of the table
+ * and their number is returned. On error, -1 is returned.
+ */
+static int
+map_all_hugepages_orig(struct hugepage_file *hugepg_tbl,
+		struct hugepage_info *hpi)
+{
+	struct hugepage_map_worker *workers, *w;
+	int cpus[RTE_MAX_LCORE];
+	unsigned int i, first, last, nb_cpus, nb_workers, nb_reserved;
+	unsigned int nb_mapped;
+	unsigned int nb_pages = hpi->num_pages[0];
+	size_t va_len = 0;
+	void *va = NULL;
+	int ret = 0;
+
+	for (i = 0; i < nb_pages; i++) {
+		hugepg_tbl[i].file_id = i;
+		hugepg_tbl[i].size = hpi->hugepage_sz;
+		eal_get_hugefile_path(hugepg_tbl[i].filepath,
+				sizeof(hugepg_tbl[i].filepath), hpi->hugedir,
+				hugepg_tbl[i].file_id);
+		hugepg_tbl[i].filepath[sizeof(hugepg_tbl[i].filepath) - 1] = '\0';
+	}
+
+#ifndef RTE_ARCH_PPC_64
+	/* hugepages can't be mapped over a reservation of normal pages on
+	 * PPC64, let the kernel choose the addresses there */
+	va_len = (size_t)nb_pages * hpi->hugepage_sz;
+	va = reserve_virtual_area(&va_len, hpi->hugepage_sz);
+#endif
+	nb_reserved = va_len / hpi->hugepage_sz;
+
+	/* by default, use a few threads per socket; if the number of
+	 * threads is forced, spread them on as many cpus as possible */
+	if (internal_config.huge_init_threads == 0) {
+		nb_cpus = hugepage_init_cpus(cpus, RTE_MAX_LCORE,
+				HUGEPAGE_INIT_THREADS_PER_SOCKET);
+		nb_workers = nb_cpus;
+	} else {
+		nb_cpus = hugepage_init_cpus(cpus,
+				internal_config.huge_init_threads, UINT_MAX);
+		nb_workers = internal_config.huge_init_threads;
+	}
+	nb_workers = RTE_MAX(RTE_MIN(nb_workers, nb_pages), 1U);
+
+	workers = calloc(nb_workers, sizeof(*workers));
+	if (workers == NULL) {
+		if (va != NULL)
+			munmap(va, va_len);
+		return -1;
+	}
+
+	first = 0;
+	for (i = 0; i < nb_workers; i++) {
+		w = &workers[i];
+		last = (uint64_t)nb_pages * (i + 1) / nb_workers;
+		w->hugepg_tbl = &hugepg_tbl[first];
+		w->hugepage_sz = hpi->hugepage_sz;
+		w->nb_pages = last - first;
+		if (first < nb_reserved) {
+			w->va = RTE_PTR_ADD(va, first * hpi->hugepage_sz);
+			w->nb_reserved = RTE_MIN(nb_reserved - first,
+					w->nb_pages);
+		}
+		w->find_phys = phys_addrs_available;
+		w->cpu = (nb_workers > 1 && nb_cpus > 0) ?
+			cpus[i % nb_cpus] : -1;
+		first = last;
+	}
+
+	RTE_LOG(DEBUG, EAL, "Mapping %u hugepages of size %u MB "
+		"with %u thread(s)\n", nb_pages,
+		(unsigned int)(hpi->hugepage_sz / 0x100000), nb_workers);
+
+	for (i = 0; i < nb_workers; i++) {
+		w = &workers[i];
+		if (nb_workers > 1 && pthread_create(&w->tid, NULL,
+				hugepage_map_worker_main, w) == 0) {
+			w->started = 1;
+			continue;
+		}
+		/* map the slice from the calling thread */
+		w->cpu = -1;
+		hugepage_map_worker_main(w);
+	}
+
+	/* wait for all slices, and compact the mapped pages at the
+	 * beginning of the table */
+	nb_mapped = 0;
+	for (i = 0; i < nb_workers; i++) {
+		w = &workers[i];
+		if (w->started)
+			pthread_join(w->tid, NULL);
+		if (w->ret < 0)
+			ret = -1;
+		if (w->hugepg_tbl != &hugepg_tbl[nb_mapped])
+			memmove(&hugepg_tbl[nb_mapped], w->hugepg_tbl,
+				w->nb_mapped * sizeof(*hugepg_tbl));
+		nb_mapped += w->nb_mapped;
+	}
+	memset(&hugepg_tbl[nb_mapped], 0,
+		(nb_pages - nb_mapped) * sizeof(*hugepg_tbl));
+
+	free(workers);
+
+	return ret < 0 ? -1 : (int)nb_mapped;
 }
 
 /*
- * Mmap all hugepages of hugepage table: it first open a file in
- * hugetlbfs, then mmap() hugepage_sz data in it. If orig is set, the
- * virtual address is stored in hugepg_tbl[i].orig_va, else it is stored
- * in hugepg_tbl[i].final_va. The second mapping (when orig is 0) tries to
- * map continguous physical blocks in contiguous virtual blocks.
+ * Remap all hugepages of hugepage table, storing the virtual address in
+ * hugepg_tbl[i].final_va. This mapping tries to map contiguous physical
+ * blocks in contiguous virtual blocks.
  */
 static unsigned
 map_all_hugepages(struct hugepage_file *hugepg_tbl,
-		struct hugepage_info *hpi, int orig)
+		struct hugepage_info *hpi)
 {
 	int fd;
 	unsigned i;
@@ -407,26 +741,18 @@ map_all_hugepages(struct hugepage_file *hugepg_tbl,
 	for (i = 0; i < hpi->num_pages[0]; i++) {
 		uint64_t hugepage_sz = hpi->hugepage_sz;
 
-		if (orig) {
-			hugepg_tbl[i].file_id = i;
-			hugepg_tbl[i].size = hugepage_sz;
-			eal_get_hugefile_path(hugepg_tbl[i].filepath,
-					sizeof(hugepg_tbl[i].filepath), hpi->hugedir,
-					hugepg_tbl[i].file_id);
-			hugepg_tbl[i].filepath[sizeof(hugepg_tbl[i].filepath) - 1] = '\0';
-		}
 #ifndef RTE_ARCH_64
 		/* for 32-bit systems, don't remap 1G and 16G pages, just reuse
 		 * original map address as final map address.
 		 */
-		else if ((hugepage_sz == RTE_PGSIZE_1G)
+		if ((hugepage_sz == RTE_PGSIZE_1G)
 			|| (hugepage_sz == RTE_PGSIZE_16G)) {
 			hugepg_tbl[i].final_va = hugepg_tbl[i].orig_va;
 			hugepg_tbl[i].orig_va = NULL;
 			continue;
 		}
 #endif
-		else if (vma_len == 0) {
+		if (vma_len == 0) {
 			unsigned j, num_pages;
 
 			/* reserve a virtual area for next contiguous
@@ -464,8 +790,7 @@ map_all_hugepages(struct hugepage_file *hugepg_tbl,
 			return i;
 		}
 
-		/* map the segment, and populate page tables,
-		 * the kernel fills this segment with zeros */
+		/* map the segment, and populate page tables */
 		virtaddr = mmap(vma_addr, hugepage_sz, PROT_READ | PROT_WRITE,
 				MAP_SHARED | MAP_POPULATE, fd, 0);
 		if (virtaddr == MAP_FAILED) {
@@ -475,33 +800,7 @@ map_all_hugepages(struct hugepage_file *hugepg_tbl,
 			return i;
 		}
 
-		if (orig) {
-			hugepg_tbl[i].orig_va = virtaddr;
-		}
-		else {
-			hugepg_tbl[i].final_va = virtaddr;
-		}
-
-		if (orig) {
-			/* In linux, hugetlb limitations, like cgroup, are
-			 * enforced at fault time instead of mmap(), even
-			 * with the option of MAP_POPULATE. Kernel will send
-			 * a SIGBUS signal. To avoid to be killed, save stack
-			 * environment here, if SIGBUS happens, we can jump
-			 * back here.
-			 */
-			if (huge_wrap_sigsetjmp()) {
-				RTE_LOG(DEBUG, EAL, "SIGBUS: Cannot mmap more "
-					"hugepages of size %u MB\n",
-					(unsigned)(hugepage_sz / 0x100000));
-				munmap(virtaddr, hugepage_sz);
-				close(fd);
-				unlink(hugepg_tbl[i].filepath);
-				return i;
-			}
-			*(int *)virtaddr = 0;
-		}
-
+		hugepg_tbl[i].final_va = virtaddr;
 
 		/* set shared flock on the file. */
 		if (flock(fd, LOCK_SH | LOCK_NB) == -1) {
@@ -520,6 +819,38 @@ map_all_hugepages(struct hugepage_file *hugepg_tbl,
 	return i;
 }
 
+/*
+ * Once hugepg_tbl is sorted by physical address, check whether the
+ * original mapping already has physically contiguous pages virtually
+ * contiguous as well, in which case remapping them is useless.
+ */
+static int
+hugepages_va_contiguous(const struct hugepage_file *hugepg_tbl,
+		struct hugepage_info *hpi)
+{
+	unsigned int i;
+	uint64_t hugepage_sz = hpi->hugepage_sz;
+
+	for (i = 1; i < hpi->num_pages[0]; i++) {
+		const struct hugepage_file *prev = &hugepg_tbl[i - 1];
+		const struct hugepage_file *hp = &hugepg_tbl[i];
+
+#ifdef RTE_ARCH_PPC_64
+		/* both addresses are in descending order on PPC64 */
+		if (hp->physaddr == prev->physaddr - hugepage_sz &&
+				hp->orig_va != RTE_PTR_SUB(prev->orig_va,
+					hugepage_sz))
+			return 0;
+#else
+		if (hp->physaddr == prev->physaddr + hugepage_sz &&
+				hp->orig_va != RTE_PTR_ADD(prev->orig_va,
+					hugepage_sz))
+			return 0;
+#endif
+	}
+	return 1;
+}
+
 /* Unmap all hugepages from original mapping */
 static int
 unmap_all_hugepages_orig(struct hugepage_file *hugepg_tbl, struct hugepage_info *hpi)
@@ -534,19 +865,35 @@ unmap_all_hugepages_orig(struct hugepage_file *hugepg_tbl, struct hugepage_info
         return 0;
 }
 
+static int
+cmp_orig_va(const void *a, const void *b)
+{
+	const struct hugepage_file *p1 = a;
+	const struct hugepage_file *p2 = b;
+
+	if (p1->orig_va < p2->orig_va)
+		return -1;
+	else if (p1->orig_va > p2->orig_va)
+		return 1;
+	else
+		return 0;
+}
+
 /*
  * Parse /proc/self/numa_maps to get the NUMA socket ID for each huge
- * page.
+ * page. The table is sorted by original virtual address, so that each
+ * mapping can be looked up without scanning all pages.
  */
 static int
 find_numasocket(struct hugepage_file *hugepg_tbl, struct hugepage_info *hpi)
 {
 	int socket_id;
 	char *end, *nodestr;
-	unsigned i, hp_count = 0;
+	unsigned hp_count = 0;
 	uint64_t virt_addr;
 	char buf[BUFSIZ];
 	char hugedir_str[PATH_MAX];
+	struct hugepage_file key, *hp;
 	FILE *f;
 
 	f = fopen("/proc/self/numa_maps", "r");
@@ -556,6 +903,9 @@ find_numasocket(struct hugepage_file *hugepg_tbl, struct hugepage_info *hpi)
 		return 0;
 	}
 
+	qsort(hugepg_tbl, hpi->num_pages[0], sizeof(struct hugepage_file),
+		cmp_orig_va);
+
 	snprintf(hugedir_str, sizeof(hugedir_str),
 			"%s/%s", hpi->hugedir, internal_config.hugefile_prefix);
 
@@ -596,12 +946,12 @@ find_numasocket(struct hugepage_file *hugepg_tbl, struct hugepage_info *hpi)
 		}
 
 		/* if we find this page in our mappings, set socket_id */
-		for (i = 0; i < hpi->num_pages[0]; i++) {
-			void *va = (void *)(unsigned long)virt_addr;
-			if (hugepg_tbl[i].orig_va == va) {
-				hugepg_tbl[i].socket_id = socket_id;
-				hp_count++;
-			}
+		key.orig_va = (void *)(unsigned long)virt_addr;
+		hp = bsearch(&key, hugepg_tbl, hpi->num_pages[0],
+				sizeof(struct hugepage_file), cmp_orig_va);
+		if (hp != NULL) {
+			hp->socket_id = socket_id;
+			hp_count++;
 		}
 	}
 
@@ -957,11 +1307,12 @@ huge_recover_sigbus(void)
 /*
  * Prepare physical memory mapping: fill configuration structure with
  * these infos, return 0 on success.
- *  1. map N huge pages in separate files in hugetlbfs
+ *  1. map N huge pages in separate files in hugetlbfs, in parallel
  *  2. find associated physical addr
  *  3. find associated NUMA socket ID
  *  4. sort all huge pages by physical address
- *  5. remap these N huge pages in the correct order
+ *  5. remap these N huge pages in the correct order, unless the first
+ *     mapping already is
  *  6. unmap the first mapping
  *  7. fill memsegs in configuration with contiguous zones
  */
@@ -975,7 +1326,7 @@ rte_eal_hugepage_init(void)
 	uint64_t memory[RTE_MAX_NUMA_NODES];
 
 	unsigned hp_offset;
-	int i, j, new_memseg;
+	int i, j, ret, new_memseg;
 	int nr_hugefiles, nr_hugepages = 0;
 	void *addr;
 
@@ -1054,9 +1405,17 @@ rte_eal_hugepage_init(void)
 		if (hpi->num_pages[0] == 0)
 			continue;
 
-		/* map all hugepages available */
+		/* map all hugepages available, and find their physical
+		 * addresses if possible */
 		pages_old = hpi->num_pages[0];
-		pages_new = map_all_hugepages(&tmp_hp[hp_offset], hpi, 1);
+		ret = map_all_hugepages_orig(&tmp_hp[hp_offset], hpi);
+		if (ret < 0) {
+			RTE_LOG(DEBUG, EAL, "Failed to map and find phys addr "
+				"for %u MB pages\n",
+				(unsigned int)(hpi->hugepage_sz / 0x100000));
+			goto fail;
+		}
+		pages_new = ret;
 		if (pages_new < pages_old) {
 			RTE_LOG(DEBUG, EAL,
 				"%d not %d hugepages of size %u MB allocated\n",
@@ -1071,15 +1430,7 @@ rte_eal_hugepage_init(void)
 				continue;
 		}
 
-		if (phys_addrs_available) {
-			/* find physical addresses for each hugepage */
-			if (find_physaddrs(&tmp_hp[hp_offset], hpi) < 0) {
-				RTE_LOG(DEBUG, EAL, "Failed to find phys addr "
-					"for %u MB pages\n",
-					(unsigned int)(hpi->hugepage_sz / 0x100000));
-				goto fail;
-			}
-		} else {
+		if (!phys_addrs_available) {
 			/* set physical addresses for each hugepage */
 			if (set_physaddrs(&tmp_hp[hp_offset], hpi) < 0) {
 				RTE_LOG(DEBUG, EAL, "Failed to set phys addr "
@@ -1098,17 +1449,27 @@ rte_eal_hugepage_init(void)
 		qsort(&tmp_hp[hp_offset], hpi->num_pages[0],
 		      sizeof(struct hugepage_file), cmp_physaddr);
 
-		/* remap all hugepages */
-		if (map_all_hugepages(&tmp_hp[hp_offset], hpi, 0) !=
-		    hpi->num_pages[0]) {
-			RTE_LOG(ERR, EAL, "Failed to remap %u MB pages\n",
+		if (hugepages_va_contiguous(&tmp_hp[hp_offset], hpi)) {
+			/* the original mapping is as contiguous as a
+			 * remapping would make it, keep it */
+			for (j = 0; j < (int)hpi->num_pages[0]; j++) {
+				tmp_hp[hp_offset + j].final_va =
+					tmp_hp[hp_offset + j].orig_va;
+				tmp_hp[hp_offset + j].orig_va = NULL;
+			}
+		} else {
+			/* remap all hugepages */
+			if (map_all_hugepages(&tmp_hp[hp_offset], hpi) !=
+			    hpi->num_pages[0]) {
+				RTE_LOG(ERR, EAL, "Failed to remap %u MB pages\n",
 					(unsigned)(hpi->hugepage_sz / 0x100000));
-			goto fail;
-		}
+				goto fail;
+			}
 
-		/* unmap original mappings */
-		if (unmap_all_hugepages_orig(&tmp_hp[hp_offset], hpi) < 0)
-			goto fail;
+			/* unmap original mappings */
+			if (unmap_all_hugepages_orig(&tmp_hp[hp_offset], hpi) < 0)
+				goto fail;
+		}
 
 		/* we have processed a num of hugepages of this size, so inc offset */
 		hp_offset += hpi->num_pages[0];
@@ -132,8 +132,13 @@ eal_thread_loop(__attribute__((unused)) void *arg)
 
 	thread_id = pthread_self();
 
-	/* retrieve our lcore_id from the configuration structure */
-	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+	/* retrieve our lcore_id from the configuration structure, service
+	 * lcores are not browsed by RTE_LCORE_FOREACH_SLAVE()
+	 */
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (lcore_id == rte_get_master_lcore() ||
+				rte_eal_lcore_role(lcore_id) == ROLE_OFF)
+			continue;
 		if (thread_id == lcore_config[lcore_id].thread_id)
 			break;
 	}
@@ -182,6 +187,7 @@ eal_thread_loop(__attribute__((unused)) void *arg)
 		/* call the function and store the return value */
 		fct_arg = lcore_config[lcore_id].arg;
 		ret = lcore_config[lcore_id].f(fct_arg);
+		eal_lcore_poll_stop(lcore_id);
 		lcore_config[lcore_id].ret = ret;
 		rte_wmb();
 		lcore_config[lcore_id].state = FINISHED;
@@ -83,6 +83,11 @@ static rte_spinlock_t rte_eth_rx_cb_lock = RTE_SPINLOCK_INITIALIZER;
 /* spinlock for add/remove tx callbacks */
 static rte_spinlock_t rte_eth_tx_cb_lock = RTE_SPINLOCK_INITIALIZER;
 
+RTE_TRACE_POINT_DEFINE(rte_eth_trace_rx_burst, "lib.ethdev.rx_burst",
+	"port_id", "queue_id", "nb_pkts", "nb_rx");
+RTE_TRACE_POINT_DEFINE(rte_eth_trace_tx_burst, "lib.ethdev.tx_burst",
+	"port_id", "queue_id", "nb_pkts", "nb_tx");
+
 /* store statistics names and its offset in stats structure  */
 struct rte_eth_xstats_name_off {
 	char name[RTE_ETH_XSTATS_NAME_SIZE];
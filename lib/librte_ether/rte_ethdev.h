@@ -182,12 +182,19 @@ extern "C" {
 #include <rte_dev.h>
 #include <rte_devargs.h>
 #include <rte_errno.h>
+#include <rte_trace.h>
+#include <rte_lcore_poll.h>
 #include "rte_ether.h"
 #include "rte_eth_ctrl.h"
 #include "rte_dev_info.h"
 
 struct rte_mbuf;
 
+/** Trace point "lib.ethdev.rx_burst", emitted by rte_eth_rx_burst(). */
+RTE_TRACE_POINT_DECLARE(rte_eth_trace_rx_burst);
+/** Trace point "lib.ethdev.tx_burst", emitted by rte_eth_tx_burst(). */
+RTE_TRACE_POINT_DECLARE(rte_eth_trace_tx_burst);
+
 /**
  * A structure used to retrieve statistics for an Ethernet port.
  * Not all statistics fields in struct rte_eth_stats are supported
@@ -2786,6 +2793,11 @@ rte_eth_rx_burst(uint8_t port_id, uint16_t queue_id,
 	}
 #endif
 
+	if (nb_rx != 0)
+		RTE_TRACE_POINT_EMIT(rte_eth_trace_rx_burst, port_id, queue_id,
+			nb_pkts, nb_rx);
+	rte_lcore_poll_mark(nb_rx);
+
 	return nb_rx;
 }
 
@@ -3042,7 +3054,13 @@ rte_eth_tx_burst(uint8_t port_id, uint16_t queue_id,
 	}
 #endif
 
-	return (*dev->tx_pkt_burst)(dev->data->tx_queues[queue_id], tx_pkts, nb_pkts);
+	uint16_t nb_tx = (*dev->tx_pkt_burst)(dev->data->tx_queues[queue_id],
+		tx_pkts, nb_pkts);
+
+	RTE_TRACE_POINT_EMIT(rte_eth_trace_tx_burst, port_id, queue_id,
+		nb_pkts, nb_tx);
+
+	return nb_tx;
 }
 
 /**
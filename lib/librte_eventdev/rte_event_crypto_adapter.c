@@ -0,0 +1,712 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_malloc.h>
+#include <rte_spinlock.h>
+#include <rte_service_component.h>
+#include <rte_mbuf.h>
+#include <rte_cryptodev.h>
+#include <rte_cryptodev_pmd.h>
+
+#include "rte_eventdev.h"
+#include "rte_eventdev_pmd.h"
+#include "rte_event_crypto_adapter.h"
+
+#define BATCH_SIZE		32
+#define CRYPTO_EVENT_BUFFER_SIZE (4 * BATCH_SIZE)
+#define CRYPTO_OP_BUFFER_SIZE	(2 * BATCH_SIZE)
+#define DEFAULT_MAX_NB		128
+
+struct crypto_qp_info {
+	int enabled;
+	uint16_t len;
+	/* requests not yet accepted by the queue pair */
+	struct rte_crypto_op *op_buffer[CRYPTO_OP_BUFFER_SIZE];
+};
+
+struct crypto_device_info {
+	struct crypto_qp_info *qpairs;
+	uint16_t nb_qpairs;    /* size of qpairs */
+	uint16_t nb_qps_added;
+};
+
+/* an added queue pair, in the dequeue round robin */
+struct crypto_poll_entry {
+	uint8_t cdev_id;
+	uint16_t qp_id;
+};
+
+struct rte_event_crypto_adapter {
+	/* response events not yet accepted by the event device */
+	struct rte_event events[CRYPTO_EVENT_BUFFER_SIZE];
+	uint16_t nb_events;
+	uint8_t eventdev_id;
+	uint8_t event_port_id;
+	enum rte_event_crypto_adapter_mode mode;
+	uint32_t max_nb;
+	uint32_t max_inflight;
+	/* requests dequeued and not yet completed */
+	uint32_t nb_inflight;
+	/* taken by the control path, tried by the service */
+	rte_spinlock_t lock;
+	struct crypto_poll_entry *qp_poll;
+	uint32_t nb_qps;
+	uint32_t next_qp;
+	struct rte_event_crypto_adapter_stats stats;
+	rte_event_crypto_adapter_conf_cb conf_cb;
+	void *conf_arg;
+	int default_cb_arg; /* conf_arg allocated by create() */
+	int configured;
+	int started;
+	uint32_t service_id;
+	struct crypto_device_info cdevs[RTE_CRYPTO_MAX_DEVS];
+} __rte_cache_aligned;
+
+static struct rte_event_crypto_adapter
+	*crypto_adapters[RTE_EVENT_CRYPTO_ADAPTER_MAX_INSTANCE];
+
+static inline struct rte_event_crypto_adapter *
+eca_id_to_adapter(uint8_t id)
+{
+	if (id >= RTE_EVENT_CRYPTO_ADAPTER_MAX_INSTANCE)
+		return NULL;
+	return crypto_adapters[id];
+}
+
+static inline void
+eca_op_free(struct rte_crypto_op *op)
+{
+	if (op->type == RTE_CRYPTO_OP_TYPE_SYMMETRIC && op->sym->m_src != NULL)
+		rte_pktmbuf_free(op->sym->m_src);
+	rte_crypto_op_free(op);
+}
+
+static inline void
+eca_flush_event_buffer(struct rte_event_crypto_adapter *eca)
+{
+	struct rte_event_crypto_adapter_stats *stats = &eca->stats;
+	uint16_t done = 0;
+	uint16_t n;
+
+	if (eca->nb_events == 0)
+		return;
+
+	/* enqueue by batches, the device may accept a part of them only */
+	do {
+		n = rte_event_enqueue_burst(eca->eventdev_id,
+				eca->event_port_id, &eca->events[done],
+				RTE_MIN(eca->nb_events - done, BATCH_SIZE));
+		done += n;
+	} while (n != 0 && done < eca->nb_events);
+	stats->event_enq_count += done;
+
+	if (done < eca->nb_events) {
+		memmove(eca->events, &eca->events[done],
+			(eca->nb_events - done) * sizeof(struct rte_event));
+		stats->event_enq_retry_count++;
+	}
+	eca->nb_events -= done;
+}
+
+/*
+ * Dequeue the completed operations of the queue pairs in round robin,
+ * until max_nb operations are dequeued or the event buffer cannot take
+ * a full burst.
+ */
+static void
+eca_crypto_dequeue(struct rte_event_crypto_adapter *eca)
+{
+	struct rte_event_crypto_adapter_stats *stats = &eca->stats;
+	struct rte_crypto_op *ops[BATCH_SIZE];
+	uint32_t nb_deq = 0;
+	uint32_t i;
+
+	for (i = 0; i < eca->nb_qps; i++) {
+		const struct crypto_poll_entry *entry;
+		struct rte_event *ev;
+		uint16_t n, j;
+
+		if (eca->nb_events > CRYPTO_EVENT_BUFFER_SIZE - BATCH_SIZE) {
+			eca_flush_event_buffer(eca);
+			if (eca->nb_events >
+					CRYPTO_EVENT_BUFFER_SIZE - BATCH_SIZE)
+				break;
+		}
+
+		entry = &eca->qp_poll[eca->next_qp];
+		if (++eca->next_qp == eca->nb_qps)
+			eca->next_qp = 0;
+
+		n = rte_cryptodev_dequeue_burst(entry->cdev_id, entry->qp_id,
+				ops, BATCH_SIZE);
+		if (n == 0)
+			continue;
+		stats->crypto_deq_count += n;
+		if (eca->mode == RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD)
+			eca->nb_inflight -= RTE_MIN(eca->nb_inflight,
+					(uint32_t)n);
+
+		ev = &eca->events[eca->nb_events];
+		for (j = 0; j < n; j++) {
+			union rte_event_crypto_metadata *md =
+				rte_event_crypto_adapter_metadata(ops[j]);
+
+			if (unlikely(md == NULL)) {
+				eca_op_free(ops[j]);
+				stats->crypto_enq_fail++;
+				continue;
+			}
+			ev->event = md->response_info.event;
+			ev->event_type = RTE_EVENT_TYPE_CRYPTODEV;
+			ev->op = RTE_EVENT_OP_NEW;
+			ev->event_ptr = ops[j];
+			ev++;
+		}
+		eca->nb_events = ev - eca->events;
+
+		nb_deq += n;
+		if (eca->max_nb != 0 && nb_deq >= eca->max_nb)
+			break;
+	}
+}
+
+/*
+ * Submit the buffered requests. Return 0 if every queue pair buffer can
+ * take a full burst of new requests.
+ */
+static int
+eca_flush_op_buffers(struct rte_event_crypto_adapter *eca)
+{
+	struct rte_event_crypto_adapter_stats *stats = &eca->stats;
+	int blocked = 0;
+	uint32_t i;
+
+	for (i = 0; i < eca->nb_qps; i++) {
+		const struct crypto_poll_entry *entry = &eca->qp_poll[i];
+		struct crypto_qp_info *qp_info =
+			&eca->cdevs[entry->cdev_id].qpairs[entry->qp_id];
+		uint16_t n;
+
+		if (qp_info->len == 0)
+			continue;
+		n = rte_cryptodev_enqueue_burst(entry->cdev_id, entry->qp_id,
+				qp_info->op_buffer, qp_info->len);
+		stats->crypto_enq_count += n;
+		if (n < qp_info->len)
+			memmove(qp_info->op_buffer, &qp_info->op_buffer[n],
+				(qp_info->len - n) * sizeof(qp_info->op_buffer[0]));
+		qp_info->len -= n;
+		if (qp_info->len > CRYPTO_OP_BUFFER_SIZE - BATCH_SIZE)
+			blocked = 1;
+	}
+	return blocked;
+}
+
+/*
+ * Dequeue the request events and submit their operations, until max_nb
+ * requests are dequeued, the in-flight limit is reached or a queue pair
+ * does not accept more.
+ */
+static void
+eca_event_dequeue(struct rte_event_crypto_adapter *eca)
+{
+	struct rte_event_crypto_adapter_stats *stats = &eca->stats;
+	struct rte_event ev[BATCH_SIZE];
+	uint32_t nb_deq = 0;
+	uint16_t n, i;
+
+	while (eca->max_nb == 0 || nb_deq < eca->max_nb) {
+		uint16_t nb = BATCH_SIZE;
+
+		if (eca_flush_op_buffers(eca) != 0)
+			return;
+		if (eca->max_inflight != 0) {
+			if (eca->nb_inflight >= eca->max_inflight)
+				return;
+			nb = RTE_MIN((uint32_t)nb,
+					eca->max_inflight - eca->nb_inflight);
+		}
+
+		n = rte_event_dequeue_burst(eca->eventdev_id,
+				eca->event_port_id, ev, nb, 0);
+		stats->event_poll_count++;
+		if (n == 0)
+			break;
+		stats->event_deq_count += n;
+		nb_deq += n;
+
+		for (i = 0; i < n; i++) {
+			struct rte_crypto_op *op = ev[i].event_ptr;
+			union rte_event_crypto_metadata *md =
+				rte_event_crypto_adapter_metadata(op);
+			const struct crypto_device_info *dev_info;
+			struct crypto_qp_info *qp_info;
+			uint8_t cdev_id;
+			uint16_t qp_id;
+
+			if (unlikely(md == NULL))
+				goto drop;
+			cdev_id = md->request_info.cdev_id;
+			qp_id = md->request_info.queue_pair_id;
+			if (unlikely(cdev_id >= RTE_CRYPTO_MAX_DEVS))
+				goto drop;
+			dev_info = &eca->cdevs[cdev_id];
+			if (unlikely(qp_id >= dev_info->nb_qpairs ||
+					!dev_info->qpairs[qp_id].enabled))
+				goto drop;
+
+			qp_info = &dev_info->qpairs[qp_id];
+			qp_info->op_buffer[qp_info->len++] = op;
+			eca->nb_inflight++;
+			continue;
+drop:
+			eca_op_free(op);
+			stats->crypto_enq_fail++;
+		}
+	}
+
+	eca_flush_op_buffers(eca);
+}
+
+static int32_t
+eca_service_func(void *args)
+{
+	struct rte_event_crypto_adapter *eca = args;
+
+	/* the control path is updating the queue pairs */
+	if (rte_spinlock_trylock(&eca->lock) == 0)
+		return 0;
+
+	eca_flush_event_buffer(eca);
+	eca_crypto_dequeue(eca);
+	eca_flush_event_buffer(eca);
+	if (eca->mode == RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD)
+		eca_event_dequeue(eca);
+
+	rte_spinlock_unlock(&eca->lock);
+	return 0;
+}
+
+/* Rebuild the round robin of the added queue pairs. */
+static int
+eca_calc_poll(struct rte_event_crypto_adapter *eca)
+{
+	struct crypto_poll_entry *poll = NULL;
+	uint32_t nb_poll = 0;
+	unsigned int d;
+	uint16_t q;
+
+	if (eca->nb_qps != 0) {
+		poll = rte_zmalloc("eca_poll", eca->nb_qps * sizeof(*poll),
+				RTE_CACHE_LINE_SIZE);
+		if (poll == NULL)
+			return -ENOMEM;
+	}
+
+	for (d = 0; d < RTE_CRYPTO_MAX_DEVS; d++) {
+		const struct crypto_device_info *dev_info = &eca->cdevs[d];
+
+		if (dev_info->qpairs == NULL)
+			continue;
+		for (q = 0; q < dev_info->nb_qpairs; q++) {
+			if (!dev_info->qpairs[q].enabled)
+				continue;
+			poll[nb_poll].cdev_id = d;
+			poll[nb_poll].qp_id = q;
+			nb_poll++;
+		}
+	}
+
+	rte_free(eca->qp_poll);
+	eca->qp_poll = poll;
+	eca->next_qp = 0;
+	return 0;
+}
+
+/* Add an event port to the device for the adapter. */
+static int
+eca_default_conf_cb(uint8_t id, uint8_t dev_id,
+		struct rte_event_crypto_adapter_conf *conf, void *arg)
+{
+	struct rte_eventdev *dev = &rte_eventdevs[dev_id];
+	struct rte_event_port_conf *port_conf = arg;
+	struct rte_event_dev_config dev_conf;
+	uint8_t port_id;
+	int started;
+	int ret;
+
+	dev_conf = dev->data->dev_conf;
+	started = dev->data->dev_started;
+	if (started)
+		rte_event_dev_stop(dev_id);
+
+	port_id = dev_conf.nb_event_ports;
+	dev_conf.nb_event_ports += 1;
+	ret = rte_event_dev_configure(dev_id, &dev_conf);
+	if (ret < 0) {
+		RTE_EDEV_LOG_ERR("failed to configure event dev %u for adapter %u",
+				dev_id, id);
+		goto restart;
+	}
+
+	ret = rte_event_port_setup(dev_id, port_id, port_conf);
+	if (ret < 0) {
+		RTE_EDEV_LOG_ERR("failed to setup event port %u for adapter %u",
+				port_id, id);
+		goto restart;
+	}
+
+	conf->event_port_id = port_id;
+	conf->max_nb = DEFAULT_MAX_NB;
+	conf->max_inflight = port_conf->new_event_threshold;
+
+restart:
+	if (started) {
+		int err = rte_event_dev_start(dev_id);
+
+		if (ret == 0)
+			ret = err;
+	}
+	return ret;
+}
+
+int
+rte_event_crypto_adapter_create_ext(uint8_t id, uint8_t dev_id,
+		rte_event_crypto_adapter_conf_cb conf_cb,
+		enum rte_event_crypto_adapter_mode mode, void *conf_arg)
+{
+	struct rte_event_crypto_adapter *eca;
+	struct rte_service_spec service;
+	int socket_id;
+	int ret;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	if (id >= RTE_EVENT_CRYPTO_ADAPTER_MAX_INSTANCE || conf_cb == NULL)
+		return -EINVAL;
+	if (mode != RTE_EVENT_CRYPTO_ADAPTER_OP_NEW &&
+			mode != RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD)
+		return -EINVAL;
+	if (crypto_adapters[id] != NULL)
+		return -EEXIST;
+
+	socket_id = rte_event_dev_socket_id(dev_id);
+	eca = rte_zmalloc_socket("rte_event_crypto_adapter", sizeof(*eca),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (eca == NULL) {
+		RTE_EDEV_LOG_ERR("failed to allocate crypto adapter %u", id);
+		return -ENOMEM;
+	}
+
+	eca->eventdev_id = dev_id;
+	eca->mode = mode;
+	eca->conf_cb = conf_cb;
+	eca->conf_arg = conf_arg;
+	rte_spinlock_init(&eca->lock);
+
+	memset(&service, 0, sizeof(service));
+	snprintf(service.name, sizeof(service.name),
+			"rte_event_crypto_adapter_%u", id);
+	service.socket_id = socket_id;
+	service.callback = eca_service_func;
+	service.callback_userdata = eca;
+	/* the service serializes itself on lock */
+	service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
+	ret = rte_service_component_register(&service, &eca->service_id);
+	if (ret < 0) {
+		RTE_EDEV_LOG_ERR("failed to register service %s: %d",
+				service.name, ret);
+		rte_free(eca);
+		return -ENOMEM;
+	}
+
+	crypto_adapters[id] = eca;
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_create(uint8_t id, uint8_t dev_id,
+		struct rte_event_port_conf *port_config,
+		enum rte_event_crypto_adapter_mode mode)
+{
+	struct rte_event_port_conf *pc;
+	int ret;
+
+	if (port_config == NULL)
+		return -EINVAL;
+
+	pc = rte_malloc(NULL, sizeof(*pc), 0);
+	if (pc == NULL)
+		return -ENOMEM;
+	*pc = *port_config;
+
+	ret = rte_event_crypto_adapter_create_ext(id, dev_id,
+			eca_default_conf_cb, mode, pc);
+	if (ret < 0) {
+		rte_free(pc);
+		return ret;
+	}
+	crypto_adapters[id]->default_cb_arg = 1;
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_free(uint8_t id)
+{
+	struct rte_event_crypto_adapter *eca = eca_id_to_adapter(id);
+	uint16_t i;
+
+	if (eca == NULL)
+		return -EINVAL;
+	if (eca->nb_qps != 0 || eca->started)
+		return -EBUSY;
+
+	rte_service_component_unregister(eca->service_id);
+
+	/* responses the device never accepted */
+	for (i = 0; i < eca->nb_events; i++)
+		eca_op_free(eca->events[i].event_ptr);
+
+	if (eca->default_cb_arg)
+		rte_free(eca->conf_arg);
+	rte_free(eca);
+	crypto_adapters[id] = NULL;
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_queue_pair_add(uint8_t id, uint8_t cdev_id,
+		int32_t queue_pair_id)
+{
+	struct rte_event_crypto_adapter *eca = eca_id_to_adapter(id);
+	struct crypto_device_info *dev_info;
+	uint16_t nb_qpairs;
+	uint16_t first, last, q;
+	int ret;
+
+	if (eca == NULL || !rte_cryptodev_pmd_is_valid_dev(cdev_id))
+		return -EINVAL;
+
+	nb_qpairs = rte_cryptodev_queue_pair_count(cdev_id);
+	if (queue_pair_id >= (int32_t)nb_qpairs || queue_pair_id < -1 ||
+			nb_qpairs == 0) {
+		RTE_EDEV_LOG_ERR("invalid queue pair %" PRId32 " of cryptodev %u",
+				queue_pair_id, cdev_id);
+		return -EINVAL;
+	}
+
+	if (!eca->configured) {
+		struct rte_event_crypto_adapter_conf conf;
+
+		memset(&conf, 0, sizeof(conf));
+		ret = eca->conf_cb(id, eca->eventdev_id, &conf, eca->conf_arg);
+		if (ret < 0) {
+			RTE_EDEV_LOG_ERR("configuration of adapter %u failed: %d",
+					id, ret);
+			return ret;
+		}
+		eca->event_port_id = conf.event_port_id;
+		eca->max_nb = conf.max_nb;
+		eca->max_inflight = conf.max_inflight;
+		eca->configured = 1;
+	}
+
+	rte_spinlock_lock(&eca->lock);
+
+	dev_info = &eca->cdevs[cdev_id];
+	if (dev_info->qpairs == NULL) {
+		dev_info->qpairs = rte_zmalloc_socket("eca_qpairs",
+				nb_qpairs * sizeof(*dev_info->qpairs),
+				RTE_CACHE_LINE_SIZE,
+				rte_cryptodev_socket_id(cdev_id));
+		if (dev_info->qpairs == NULL) {
+			rte_spinlock_unlock(&eca->lock);
+			return -ENOMEM;
+		}
+		dev_info->nb_qpairs = nb_qpairs;
+	}
+
+	first = queue_pair_id == -1 ? 0 : queue_pair_id;
+	last = queue_pair_id == -1 ? dev_info->nb_qpairs - 1 : queue_pair_id;
+	for (q = first; q <= last; q++) {
+		struct crypto_qp_info *qp_info = &dev_info->qpairs[q];
+
+		if (!qp_info->enabled) {
+			qp_info->enabled = 1;
+			dev_info->nb_qps_added++;
+			eca->nb_qps++;
+		}
+	}
+
+	ret = eca_calc_poll(eca);
+	rte_spinlock_unlock(&eca->lock);
+	return ret;
+}
+
+int
+rte_event_crypto_adapter_queue_pair_del(uint8_t id, uint8_t cdev_id,
+		int32_t queue_pair_id)
+{
+	struct rte_event_crypto_adapter *eca = eca_id_to_adapter(id);
+	struct crypto_device_info *dev_info;
+	uint16_t first, last, q;
+	int ret;
+
+	if (eca == NULL || cdev_id >= RTE_CRYPTO_MAX_DEVS)
+		return -EINVAL;
+
+	dev_info = &eca->cdevs[cdev_id];
+	if (dev_info->qpairs == NULL ||
+			queue_pair_id >= (int32_t)dev_info->nb_qpairs ||
+			queue_pair_id < -1)
+		return -EINVAL;
+	if (queue_pair_id != -1 && !dev_info->qpairs[queue_pair_id].enabled)
+		return -EINVAL;
+
+	rte_spinlock_lock(&eca->lock);
+
+	first = queue_pair_id == -1 ? 0 : queue_pair_id;
+	last = queue_pair_id == -1 ? dev_info->nb_qpairs - 1 : queue_pair_id;
+	for (q = first; q <= last; q++) {
+		if (dev_info->qpairs[q].len != 0) {
+			rte_spinlock_unlock(&eca->lock);
+			return -EBUSY;
+		}
+	}
+	for (q = first; q <= last; q++) {
+		struct crypto_qp_info *qp_info = &dev_info->qpairs[q];
+
+		if (qp_info->enabled) {
+			qp_info->enabled = 0;
+			dev_info->nb_qps_added--;
+			eca->nb_qps--;
+		}
+	}
+
+	ret = eca_calc_poll(eca);
+	if (ret == 0 && dev_info->nb_qps_added == 0) {
+		rte_free(dev_info->qpairs);
+		dev_info->qpairs = NULL;
+		dev_info->nb_qpairs = 0;
+	}
+
+	rte_spinlock_unlock(&eca->lock);
+	return ret;
+}
+
+int
+rte_event_crypto_adapter_start(uint8_t id)
+{
+	struct rte_event_crypto_adapter *eca = eca_id_to_adapter(id);
+
+	if (eca == NULL)
+		return -EINVAL;
+
+	eca->started = 1;
+	rte_service_component_runstate_set(eca->service_id, 1);
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_stop(uint8_t id)
+{
+	struct rte_event_crypto_adapter *eca = eca_id_to_adapter(id);
+
+	if (eca == NULL)
+		return -EINVAL;
+
+	rte_service_component_runstate_set(eca->service_id, 0);
+	while (rte_service_may_be_active(eca->service_id) == 1)
+		rte_pause();
+	/* an application lcore may still be in the service */
+	rte_spinlock_lock(&eca->lock);
+	eca->started = 0;
+	rte_spinlock_unlock(&eca->lock);
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_stats_get(uint8_t id,
+		struct rte_event_crypto_adapter_stats *stats)
+{
+	struct rte_event_crypto_adapter *eca = eca_id_to_adapter(id);
+
+	if (eca == NULL || stats == NULL)
+		return -EINVAL;
+
+	*stats = eca->stats;
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_stats_reset(uint8_t id)
+{
+	struct rte_event_crypto_adapter *eca = eca_id_to_adapter(id);
+
+	if (eca == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&eca->lock);
+	memset(&eca->stats, 0, sizeof(eca->stats));
+	rte_spinlock_unlock(&eca->lock);
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_service_id_get(uint8_t id, uint32_t *service_id)
+{
+	struct rte_event_crypto_adapter *eca = eca_id_to_adapter(id);
+
+	if (eca == NULL || service_id == NULL)
+		return -EINVAL;
+
+	*service_id = eca->service_id;
+	return 0;
+}
+
+int
+rte_event_crypto_adapter_event_port_get(uint8_t id, uint8_t *event_port_id)
+{
+	struct rte_event_crypto_adapter *eca = eca_id_to_adapter(id);
+
+	if (eca == NULL || event_port_id == NULL || !eca->configured)
+		return -EINVAL;
+
+	*event_port_id = eca->event_port_id;
+	return 0;
+}
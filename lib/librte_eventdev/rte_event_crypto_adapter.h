@@ -0,0 +1,375 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_EVENT_CRYPTO_ADAPTER_H_
+#define _RTE_EVENT_CRYPTO_ADAPTER_H_
+
+/**
+ * @file
+ *
+ * RTE Event Crypto Adapter
+ *
+ * A crypto adapter moves crypto operations between an event device and
+ * cryptodev queue pairs, so that the workers do not poll the cryptodevs.
+ * Each crypto operation carries its event metadata (union
+ * rte_event_crypto_metadata) in its private data, which must be
+ * reserved when creating the operation pool:
+ *
+ * - the request: the cryptodev and queue pair to submit the operation to;
+ * - the response: the event queue, scheduling type, flow id, priority and
+ *   sub event type of the event enqueued when the operation completes.
+ *
+ * In the RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD mode, the workers forward
+ * events whose event_ptr is a crypto operation to an event queue linked
+ * to the event port of the adapter (rte_event_crypto_adapter_event_port_get()).
+ * The adapter dequeues them, submits the operations to the queue pairs
+ * and, on completion, enqueues the response events.
+ *
+ * In the RTE_EVENT_CRYPTO_ADAPTER_OP_NEW mode, the application submits
+ * the operations to the queue pairs itself, and the adapter only enqueues
+ * the response events of the completed operations.
+ *
+ * The response events are new events of type RTE_EVENT_TYPE_CRYPTODEV,
+ * whose event_ptr is the crypto operation; its status must be checked.
+ *
+ * The number of operations submitted by the adapter and not yet completed
+ * is limited: when the limit is reached, or when the event device or the
+ * queue pairs do not accept more, the adapter stops dequeuing, so that the
+ * backpressure reaches the workers instead of dropping operations.
+ *
+ * The adapter runs as a service (see rte_service.h), whose id is returned
+ * by rte_event_crypto_adapter_service_id_get().
+ */
+
+#include <stdint.h>
+
+#include <rte_crypto.h>
+
+#include "rte_eventdev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of crypto adapter instances. */
+#define RTE_EVENT_CRYPTO_ADAPTER_MAX_INSTANCE 32
+
+/** Mode of a crypto adapter. */
+enum rte_event_crypto_adapter_mode {
+	RTE_EVENT_CRYPTO_ADAPTER_OP_NEW,
+	/**< The application submits the crypto operations. */
+	RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD,
+	/**< The application forwards the crypto operations as events to
+	 * the adapter, which submits them.
+	 */
+};
+
+/**
+ * Request information of a crypto operation, used in the
+ * RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD mode.
+ */
+struct rte_event_crypto_request {
+	uint8_t resv[8];
+	/**< Overlaps the first 8 bytes of the response event. */
+	uint8_t cdev_id;
+	/**< Cryptodev to submit the operation to. */
+	uint8_t resv1;
+	uint16_t queue_pair_id;
+	/**< Queue pair to submit the operation to. */
+	uint32_t resv2;
+};
+
+/**
+ * Event metadata of a crypto operation, at the start of the private data
+ * of the operation. The request overlaps the second half of the response
+ * event, whose event_ptr is set by the adapter.
+ */
+union rte_event_crypto_metadata {
+	struct rte_event_crypto_request request_info;
+	/**< Request information. */
+	struct rte_event response_info;
+	/**< Response event: queue_id, sched_type, flow_id, priority and
+	 * sub_event_type are used.
+	 */
+};
+
+/**
+ * Get the event metadata of a crypto operation.
+ *
+ * @param op
+ *   The crypto operation.
+ * @return
+ *   The metadata, or NULL if the private data of the operation is too
+ *   small to hold it.
+ */
+static inline union rte_event_crypto_metadata *
+rte_event_crypto_adapter_metadata(struct rte_crypto_op *op)
+{
+	return __rte_crypto_op_get_priv_data(op,
+			sizeof(union rte_event_crypto_metadata));
+}
+
+/**
+ * Adapter configuration, returned by the configuration callback.
+ */
+struct rte_event_crypto_adapter_conf {
+	uint8_t event_port_id;
+	/**< Event port of the adapter. */
+	uint32_t max_nb;
+	/**< Maximum number of operations handled in each direction by an
+	 * iteration of the service.
+	 */
+	uint32_t max_inflight;
+	/**< Maximum number of operations submitted by the adapter to the
+	 * queue pairs and not yet completed, 0 for no limit.
+	 */
+};
+
+/**
+ * Configuration callback, called by the adapter when the first queue
+ * pair is added, to get the event port it must use.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @param dev_id
+ *   Event device identifier.
+ * @param[out] conf
+ *   Adapter configuration to fill.
+ * @param arg
+ *   Argument given to rte_event_crypto_adapter_create_ext().
+ * @return
+ *   0 on success, negative on error.
+ */
+typedef int (*rte_event_crypto_adapter_conf_cb) (uint8_t id, uint8_t dev_id,
+			struct rte_event_crypto_adapter_conf *conf,
+			void *arg);
+
+/**
+ * Adapter statistics.
+ */
+struct rte_event_crypto_adapter_stats {
+	uint64_t event_poll_count;
+	/**< Number of event dequeue calls. */
+	uint64_t event_deq_count;
+	/**< Number of request events dequeued. */
+	uint64_t crypto_enq_count;
+	/**< Number of operations submitted to the queue pairs. */
+	uint64_t crypto_enq_fail;
+	/**< Number of operations dropped because they have no metadata or,
+	 * for the requests, target a queue pair not added to the adapter.
+	 */
+	uint64_t crypto_deq_count;
+	/**< Number of operations completed. */
+	uint64_t event_enq_count;
+	/**< Number of response events enqueued. */
+	uint64_t event_enq_retry_count;
+	/**< Number of response enqueue attempts which did not enqueue all
+	 * the buffered events.
+	 */
+};
+
+/**
+ * Create a crypto adapter with a configuration callback.
+ *
+ * @param id
+ *   Adapter identifier, lower than RTE_EVENT_CRYPTO_ADAPTER_MAX_INSTANCE.
+ * @param dev_id
+ *   Event device identifier.
+ * @param conf_cb
+ *   Configuration callback.
+ * @param mode
+ *   Mode of the adapter.
+ * @param conf_arg
+ *   Argument of the configuration callback.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameter.
+ *   - -EEXIST: An adapter with this identifier already exists.
+ *   - -ENOMEM: Memory allocation or service registration failure.
+ */
+int rte_event_crypto_adapter_create_ext(uint8_t id, uint8_t dev_id,
+		rte_event_crypto_adapter_conf_cb conf_cb,
+		enum rte_event_crypto_adapter_mode mode, void *conf_arg);
+
+/**
+ * Create a crypto adapter with the default configuration callback, which
+ * adds an event port configured with *port_config* to the event device,
+ * stopping and restarting a started device. The in-flight limit is the
+ * new_event_threshold of the port configuration.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @param dev_id
+ *   Event device identifier.
+ * @param port_config
+ *   Configuration of the event port of the adapter, copied.
+ * @param mode
+ *   Mode of the adapter.
+ * @return
+ *   See rte_event_crypto_adapter_create_ext().
+ */
+int rte_event_crypto_adapter_create(uint8_t id, uint8_t dev_id,
+		struct rte_event_port_conf *port_config,
+		enum rte_event_crypto_adapter_mode mode);
+
+/**
+ * Free a crypto adapter. All its queue pairs must have been deleted and
+ * it must be stopped.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid identifier.
+ *   - -EBUSY: The adapter still has queue pairs, or is started.
+ */
+int rte_event_crypto_adapter_free(uint8_t id);
+
+/**
+ * Add a queue pair, or all the queue pairs of a cryptodev, to an adapter.
+ * The completed operations of the queue pairs are dequeued by the adapter
+ * and, in the RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD mode, the requests
+ * targeting them are submitted.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @param cdev_id
+ *   Cryptodev identifier.
+ * @param queue_pair_id
+ *   Queue pair index, or -1 for all the queue pairs of the cryptodev.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameter.
+ *   - -ENOMEM: Memory allocation failure.
+ *   - Other negative values: Error returned by the configuration callback.
+ */
+int rte_event_crypto_adapter_queue_pair_add(uint8_t id, uint8_t cdev_id,
+		int32_t queue_pair_id);
+
+/**
+ * Delete a queue pair, or all the queue pairs of a cryptodev, from an
+ * adapter. The operations in flight on the queue pair are not dequeued
+ * by the adapter anymore.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @param cdev_id
+ *   Cryptodev identifier.
+ * @param queue_pair_id
+ *   Queue pair index, or -1 for all the queue pairs of the cryptodev.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameter, or the queue pair was not added.
+ *   - -EBUSY: Requests for the queue pair are not submitted yet.
+ */
+int rte_event_crypto_adapter_queue_pair_del(uint8_t id, uint8_t cdev_id,
+		int32_t queue_pair_id);
+
+/**
+ * Start a crypto adapter: its service is allowed to run.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @return
+ *   0 on success, -EINVAL if the identifier is invalid.
+ */
+int rte_event_crypto_adapter_start(uint8_t id);
+
+/**
+ * Stop a crypto adapter. When the function returns, the service is not
+ * running anymore.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @return
+ *   0 on success, -EINVAL if the identifier is invalid.
+ */
+int rte_event_crypto_adapter_stop(uint8_t id);
+
+/**
+ * Get the statistics of a crypto adapter.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @param[out] stats
+ *   Statistics.
+ * @return
+ *   0 on success, -EINVAL if a parameter is invalid.
+ */
+int rte_event_crypto_adapter_stats_get(uint8_t id,
+		struct rte_event_crypto_adapter_stats *stats);
+
+/**
+ * Reset the statistics of a crypto adapter.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @return
+ *   0 on success, -EINVAL if the identifier is invalid.
+ */
+int rte_event_crypto_adapter_stats_reset(uint8_t id);
+
+/**
+ * Get the service id of a crypto adapter.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @param[out] service_id
+ *   Service identifier.
+ * @return
+ *   0 on success, -EINVAL if a parameter is invalid.
+ */
+int rte_event_crypto_adapter_service_id_get(uint8_t id, uint32_t *service_id);
+
+/**
+ * Get the event port of a crypto adapter, which the application links to
+ * the event queue of the requests in the
+ * RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD mode. The port is known once a
+ * queue pair is added.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @param[out] event_port_id
+ *   Event port identifier.
+ * @return
+ *   0 on success, -EINVAL if a parameter is invalid or the adapter has no
+ *   port yet.
+ */
+int rte_event_crypto_adapter_event_port_get(uint8_t id,
+		uint8_t *event_port_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_EVENT_CRYPTO_ADAPTER_H_ */
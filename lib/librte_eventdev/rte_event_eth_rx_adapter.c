@@ -0,0 +1,877 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_spinlock.h>
+#include <rte_service_component.h>
+#include <rte_mbuf.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_ethdev.h>
+#include <rte_thash.h>
+
+#include "rte_eventdev.h"
+#include "rte_eventdev_pmd.h"
+#include "rte_event_eth_rx_adapter.h"
+
+#define BATCH_SIZE		32
+#define ETH_EVENT_BUFFER_SIZE	(4 * BATCH_SIZE)
+#define DEFAULT_MAX_NB_RX	128
+#define RSS_KEY_SIZE		40
+#define VECTOR_SLOTS		8	/* vectors aggregated at once per queue */
+/* events added to the buffer by a burst, in the worst case */
+#define RX_BUFFER_ROOM		(BATCH_SIZE + VECTOR_SLOTS)
+
+/* Default Toeplitz key, as programmed by most NIC drivers. */
+static const uint8_t rxa_rss_key[RSS_KEY_SIZE] __rte_aligned(4) = {
+	0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2,
+	0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3, 0x8f, 0xb0,
+	0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4,
+	0x77, 0xcb, 0x2d, 0xa3, 0x80, 0x30, 0xf2, 0x0c,
+	0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa,
+};
+
+/* a vector being filled with the packets of a flow */
+struct eth_rx_vector_slot {
+	struct rte_event_vector *vec;
+	uint32_t flow_id;
+	uint64_t ts;         /* TSC of its first packet */
+};
+
+struct eth_rx_queue_info {
+	int enabled;
+	int flow_id_valid;   /* use the flow id of the template */
+	uint16_t wt;         /* polling weight */
+	struct rte_event ev; /* template of the events */
+	/* aggregation of the packets in vectors, if vector_mp is set */
+	struct rte_mempool *vector_mp;
+	uint16_t vector_sz;
+	uint64_t vector_tmo_ticks;
+	struct eth_rx_vector_slot vec_slots[VECTOR_SLOTS];
+};
+
+struct eth_device_info {
+	struct eth_rx_queue_info *rx_queue;
+	uint16_t nb_dev_queues;   /* size of rx_queue */
+	uint16_t nb_queues_added;
+};
+
+/* an Rx queue in the polling schedule */
+struct eth_rx_poll_entry {
+	uint8_t eth_dev_id;
+	uint16_t eth_rx_qid;
+};
+
+struct rte_event_eth_rx_adapter {
+	/* events not yet accepted by the event device */
+	struct rte_event events[ETH_EVENT_BUFFER_SIZE];
+	uint16_t nb_events;
+	uint8_t eventdev_id;
+	uint8_t event_port_id;
+	uint32_t max_nb_rx;
+	/* taken by the control path, tried by the service */
+	rte_spinlock_t rx_lock;
+	/* polled queues, and weighted round robin sequence of their
+	 * indexes
+	 */
+	struct eth_rx_poll_entry *eth_rx_poll;
+	uint32_t *wrr_sched;
+	uint32_t wrr_len;
+	uint32_t wrr_pos;
+	uint32_t nb_queues;
+	uint32_t nb_vector_queues;
+	uint64_t block_start_ts;
+	struct rte_event_eth_rx_adapter_stats stats;
+	uint32_t rss_key_be[RSS_KEY_SIZE / 4];
+	rte_event_eth_rx_adapter_conf_cb conf_cb;
+	void *conf_arg;
+	int default_cb_arg; /* conf_arg allocated by create() */
+	int configured;
+	int started;
+	uint32_t service_id;
+	struct eth_device_info eth_devices[RTE_MAX_ETHPORTS];
+} __rte_cache_aligned;
+
+static struct rte_event_eth_rx_adapter
+	*rx_adapters[RTE_EVENT_ETH_RX_ADAPTER_MAX_INSTANCE];
+
+static inline struct rte_event_eth_rx_adapter *
+rxa_id_to_adapter(uint8_t id)
+{
+	if (id >= RTE_EVENT_ETH_RX_ADAPTER_MAX_INSTANCE)
+		return NULL;
+	return rx_adapters[id];
+}
+
+/* Compute the flow id of a packet without RSS hash from the NIC. */
+static inline uint32_t
+rxa_softrss(struct rte_mbuf *m, const uint8_t *rss_key_be)
+{
+	struct ether_hdr *eth_hdr = rte_pktmbuf_mtod(m, struct ether_hdr *);
+	uint16_t ether_type = eth_hdr->ether_type;
+	void *l3 = eth_hdr + 1;
+	union rte_thash_tuple tuple;
+
+	if (ether_type == rte_cpu_to_be_16(ETHER_TYPE_VLAN)) {
+		struct vlan_hdr *vlan_hdr = l3;
+
+		ether_type = vlan_hdr->eth_proto;
+		l3 = vlan_hdr + 1;
+	}
+
+	if (ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv4)) {
+		struct ipv4_hdr *ipv4_hdr = l3;
+
+		tuple.v4.src_addr = rte_be_to_cpu_32(ipv4_hdr->src_addr);
+		tuple.v4.dst_addr = rte_be_to_cpu_32(ipv4_hdr->dst_addr);
+		return rte_softrss_be((uint32_t *)&tuple,
+				RTE_THASH_V4_L3_LEN, rss_key_be);
+	}
+	if (ether_type == rte_cpu_to_be_16(ETHER_TYPE_IPv6)) {
+		struct ipv6_hdr *ipv6_hdr = l3;
+
+		rte_thash_load_v6_addrs(ipv6_hdr, &tuple);
+		return rte_softrss_be((uint32_t *)&tuple,
+				RTE_THASH_V6_L3_LEN, rss_key_be);
+	}
+	return 0;
+}
+
+static inline void
+rxa_flush_event_buffer(struct rte_event_eth_rx_adapter *rxa)
+{
+	struct rte_event_eth_rx_adapter_stats *stats = &rxa->stats;
+	uint16_t done = 0;
+	uint16_t n;
+
+	if (rxa->nb_events == 0)
+		return;
+
+	/* enqueue by batches, the device may accept a part of them only */
+	do {
+		n = rte_event_enqueue_burst(rxa->eventdev_id,
+				rxa->event_port_id, &rxa->events[done],
+				RTE_MIN(rxa->nb_events - done, BATCH_SIZE));
+		done += n;
+	} while (n != 0 && done < rxa->nb_events);
+	stats->rx_enq_count += done;
+
+	if (done < rxa->nb_events) {
+		memmove(rxa->events, &rxa->events[done],
+			(rxa->nb_events - done) * sizeof(struct rte_event));
+		rxa->nb_events -= done;
+		stats->rx_enq_retry++;
+		if (rxa->block_start_ts == 0)
+			rxa->block_start_ts = rte_get_tsc_cycles();
+		return;
+	}
+
+	rxa->nb_events = 0;
+	if (rxa->block_start_ts != 0) {
+		stats->rx_enq_block_cycles +=
+			rte_get_tsc_cycles() - rxa->block_start_ts;
+		rxa->block_start_ts = 0;
+	}
+}
+
+static inline uint32_t
+rxa_flow_id(const struct rte_event_eth_rx_adapter *rxa,
+		const struct eth_rx_queue_info *queue_info,
+		struct rte_mbuf *m)
+{
+	if (queue_info->flow_id_valid)
+		return queue_info->ev.flow_id;
+	return (m->ol_flags & PKT_RX_RSS_HASH) ?
+		m->hash.rss :
+		rxa_softrss(m, (const uint8_t *)rxa->rss_key_be);
+}
+
+/* Move the vector of a slot to the event buffer. */
+static inline void
+rxa_vector_enq(struct rte_event_eth_rx_adapter *rxa,
+		const struct eth_rx_queue_info *queue_info,
+		struct eth_rx_vector_slot *slot)
+{
+	struct rte_event *ev = &rxa->events[rxa->nb_events++];
+
+	*ev = queue_info->ev;
+	ev->event_type = RTE_EVENT_TYPE_ETHDEV_VECTOR;
+	ev->flow_id = slot->flow_id;
+	ev->vec = slot->vec;
+	slot->vec = NULL;
+}
+
+/*
+ * Aggregate the packets in the vectors of their flows. A packet may add
+ * two events to the buffer: the vector of another flow it evicts from its
+ * slot, then itself when no vector can be allocated. Every vector
+ * enqueued either was in a slot before the burst or holds a packet of the
+ * burst, so a burst of n packets adds at most n + VECTOR_SLOTS events.
+ */
+static inline void
+rxa_buffer_mbufs_vector(struct rte_event_eth_rx_adapter *rxa,
+		struct eth_rx_queue_info *queue_info, uint8_t eth_dev_id,
+		uint16_t rx_queue_id, struct rte_mbuf **mbufs, uint16_t n)
+{
+	uint64_t now = rte_get_tsc_cycles();
+	uint16_t i;
+
+	for (i = 0; i < n; i++) {
+		struct rte_mbuf *m = mbufs[i];
+		uint32_t flow_id = rxa_flow_id(rxa, queue_info, m) & 0xfffff;
+		struct eth_rx_vector_slot *slot =
+			&queue_info->vec_slots[flow_id % VECTOR_SLOTS];
+		struct rte_event_vector *vec = slot->vec;
+
+		if (vec != NULL && slot->flow_id != flow_id) {
+			rxa_vector_enq(rxa, queue_info, slot);
+			vec = NULL;
+		}
+		if (vec == NULL) {
+			if (unlikely(rte_mempool_get(queue_info->vector_mp,
+					(void **)&vec) != 0)) {
+				struct rte_event *ev =
+					&rxa->events[rxa->nb_events++];
+
+				*ev = queue_info->ev;
+				ev->flow_id = flow_id;
+				ev->mbuf = m;
+				continue;
+			}
+			vec->nb_elem = 0;
+			vec->port = eth_dev_id;
+			vec->queue = rx_queue_id;
+			slot->vec = vec;
+			slot->flow_id = flow_id;
+			slot->ts = now;
+		}
+
+		vec->mbufs[vec->nb_elem++] = m;
+		if (vec->nb_elem == queue_info->vector_sz)
+			rxa_vector_enq(rxa, queue_info, slot);
+	}
+}
+
+/* Enqueue the vectors whose first packet timed out. */
+static void
+rxa_vector_expire(struct rte_event_eth_rx_adapter *rxa)
+{
+	uint64_t now = rte_get_tsc_cycles();
+	uint32_t i;
+	unsigned int j;
+
+	for (i = 0; i < rxa->nb_queues; i++) {
+		const struct eth_rx_poll_entry *entry = &rxa->eth_rx_poll[i];
+		struct eth_rx_queue_info *queue_info =
+			&rxa->eth_devices[entry->eth_dev_id].rx_queue[
+				entry->eth_rx_qid];
+
+		if (queue_info->vector_mp == NULL)
+			continue;
+		for (j = 0; j < VECTOR_SLOTS; j++) {
+			struct eth_rx_vector_slot *slot =
+				&queue_info->vec_slots[j];
+
+			if (slot->vec == NULL ||
+					now - slot->ts < queue_info->vector_tmo_ticks)
+				continue;
+			if (rxa->nb_events == ETH_EVENT_BUFFER_SIZE)
+				return;
+			rxa_vector_enq(rxa, queue_info, slot);
+		}
+	}
+}
+
+/* Free the packets of the incomplete vectors of a queue. */
+static void
+rxa_vector_free(struct eth_rx_queue_info *queue_info)
+{
+	unsigned int i;
+
+	for (i = 0; i < VECTOR_SLOTS; i++) {
+		struct rte_event_vector *vec = queue_info->vec_slots[i].vec;
+
+		if (vec == NULL)
+			continue;
+		rte_pktmbuf_free_bulk(vec->mbufs, vec->nb_elem);
+		rte_mempool_put(queue_info->vector_mp, vec);
+		queue_info->vec_slots[i].vec = NULL;
+	}
+}
+
+static inline void
+rxa_buffer_mbufs(struct rte_event_eth_rx_adapter *rxa,
+		const struct eth_rx_queue_info *queue_info,
+		struct rte_mbuf **mbufs, uint16_t n)
+{
+	struct rte_event *ev = &rxa->events[rxa->nb_events];
+	const uint8_t *rss_key_be = (const uint8_t *)rxa->rss_key_be;
+	uint16_t i;
+
+	for (i = 0; i < n; i++) {
+		struct rte_mbuf *m = mbufs[i];
+
+		ev[i] = queue_info->ev;
+		if (!queue_info->flow_id_valid)
+			ev[i].flow_id = (m->ol_flags & PKT_RX_RSS_HASH) ?
+				m->hash.rss : rxa_softrss(m, rss_key_be);
+		ev[i].mbuf = m;
+	}
+	rxa->nb_events += n;
+}
+
+/*
+ * Poll the Rx queues in the weighted round robin order, until max_nb_rx
+ * packets are received or the whole sequence is done. The packets are
+ * left in the Rx queues when the event buffer cannot take a full burst.
+ */
+static void
+rxa_poll(struct rte_event_eth_rx_adapter *rxa)
+{
+	struct rte_event_eth_rx_adapter_stats *stats = &rxa->stats;
+	struct rte_mbuf *mbufs[BATCH_SIZE];
+	uint32_t nb_rx = 0;
+	uint32_t i;
+
+	rxa_flush_event_buffer(rxa);
+
+	for (i = 0; i < rxa->wrr_len; i++) {
+		const struct eth_rx_poll_entry *entry;
+		struct eth_rx_queue_info *queue_info;
+		uint16_t n;
+
+		if (rxa->nb_events > ETH_EVENT_BUFFER_SIZE - RX_BUFFER_ROOM) {
+			rxa_flush_event_buffer(rxa);
+			if (rxa->nb_events > ETH_EVENT_BUFFER_SIZE -
+					RX_BUFFER_ROOM)
+				break;
+		}
+
+		entry = &rxa->eth_rx_poll[rxa->wrr_sched[rxa->wrr_pos]];
+		if (++rxa->wrr_pos == rxa->wrr_len)
+			rxa->wrr_pos = 0;
+
+		n = rte_eth_rx_burst(entry->eth_dev_id, entry->eth_rx_qid,
+				mbufs, BATCH_SIZE);
+		stats->rx_poll_count++;
+		if (n == 0)
+			continue;
+		stats->rx_packets += n;
+
+		queue_info = &rxa->eth_devices[entry->eth_dev_id].rx_queue[
+				entry->eth_rx_qid];
+		if (queue_info->vector_mp != NULL)
+			rxa_buffer_mbufs_vector(rxa, queue_info,
+					entry->eth_dev_id, entry->eth_rx_qid,
+					mbufs, n);
+		else
+			rxa_buffer_mbufs(rxa, queue_info, mbufs, n);
+
+		nb_rx += n;
+		if (rxa->max_nb_rx != 0 && nb_rx >= rxa->max_nb_rx)
+			break;
+	}
+
+	if (rxa->nb_vector_queues != 0)
+		rxa_vector_expire(rxa);
+	rxa_flush_event_buffer(rxa);
+}
+
+static int32_t
+rxa_service_func(void *args)
+{
+	struct rte_event_eth_rx_adapter *rxa = args;
+
+	/* the control path is updating the schedule */
+	if (rte_spinlock_trylock(&rxa->rx_lock) == 0)
+		return 0;
+	rxa_poll(rxa);
+	rte_spinlock_unlock(&rxa->rx_lock);
+	return 0;
+}
+
+/*
+ * Rebuild the polling schedule from the added queues. A queue of weight
+ * w appears in the first w rounds of the sequence, so that the polls of
+ * the heaviest queues are interleaved with the others.
+ */
+static int
+rxa_calc_wrr(struct rte_event_eth_rx_adapter *rxa)
+{
+	struct eth_rx_poll_entry *poll = NULL;
+	uint32_t *sched = NULL;
+	uint32_t nb_poll = 0, len = 0, max_wt = 0, total_wt = 0;
+	uint32_t r, i;
+	unsigned int d;
+	uint16_t q;
+
+	if (rxa->nb_queues != 0) {
+		poll = rte_zmalloc("rxa_poll", rxa->nb_queues * sizeof(*poll),
+				RTE_CACHE_LINE_SIZE);
+		if (poll == NULL)
+			return -ENOMEM;
+	}
+
+	for (d = 0; d < RTE_MAX_ETHPORTS; d++) {
+		struct eth_device_info *dev_info = &rxa->eth_devices[d];
+
+		if (dev_info->rx_queue == NULL)
+			continue;
+		for (q = 0; q < dev_info->nb_dev_queues; q++) {
+			struct eth_rx_queue_info *qi = &dev_info->rx_queue[q];
+
+			if (!qi->enabled)
+				continue;
+			poll[nb_poll].eth_dev_id = d;
+			poll[nb_poll].eth_rx_qid = q;
+			nb_poll++;
+			total_wt += qi->wt;
+			max_wt = RTE_MAX(max_wt, (uint32_t)qi->wt);
+		}
+	}
+
+	if (total_wt != 0) {
+		sched = rte_zmalloc("rxa_wrr", total_wt * sizeof(*sched),
+				RTE_CACHE_LINE_SIZE);
+		if (sched == NULL) {
+			rte_free(poll);
+			return -ENOMEM;
+		}
+	}
+
+	for (r = 0; r < max_wt; r++) {
+		for (i = 0; i < nb_poll; i++) {
+			const struct eth_rx_poll_entry *e = &poll[i];
+
+			if (rxa->eth_devices[e->eth_dev_id].rx_queue[
+					e->eth_rx_qid].wt > r)
+				sched[len++] = i;
+		}
+	}
+
+	rte_free(rxa->eth_rx_poll);
+	rte_free(rxa->wrr_sched);
+	rxa->eth_rx_poll = poll;
+	rxa->wrr_sched = sched;
+	rxa->wrr_len = len;
+	rxa->wrr_pos = 0;
+	return 0;
+}
+
+/* Add an event port to the device for the adapter. */
+static int
+rxa_default_conf_cb(uint8_t id, uint8_t dev_id,
+		struct rte_event_eth_rx_adapter_conf *conf, void *arg)
+{
+	struct rte_eventdev *dev = &rte_eventdevs[dev_id];
+	struct rte_event_port_conf *port_conf = arg;
+	struct rte_event_dev_config dev_conf;
+	uint8_t port_id;
+	int started;
+	int ret;
+
+	dev_conf = dev->data->dev_conf;
+	started = dev->data->dev_started;
+	if (started)
+		rte_event_dev_stop(dev_id);
+
+	port_id = dev_conf.nb_event_ports;
+	dev_conf.nb_event_ports += 1;
+	ret = rte_event_dev_configure(dev_id, &dev_conf);
+	if (ret < 0) {
+		RTE_EDEV_LOG_ERR("failed to configure event dev %u for adapter %u",
+				dev_id, id);
+		goto restart;
+	}
+
+	ret = rte_event_port_setup(dev_id, port_id, port_conf);
+	if (ret < 0) {
+		RTE_EDEV_LOG_ERR("failed to setup event port %u for adapter %u",
+				port_id, id);
+		goto restart;
+	}
+
+	conf->event_port_id = port_id;
+	conf->max_nb_rx = DEFAULT_MAX_NB_RX;
+
+restart:
+	if (started) {
+		int err = rte_event_dev_start(dev_id);
+
+		if (ret == 0)
+			ret = err;
+	}
+	return ret;
+}
+
+int
+rte_event_eth_rx_adapter_create_ext(uint8_t id, uint8_t dev_id,
+		rte_event_eth_rx_adapter_conf_cb conf_cb, void *conf_arg)
+{
+	struct rte_event_eth_rx_adapter *rxa;
+	struct rte_service_spec service;
+	int socket_id;
+	int ret;
+
+	RTE_EVENTDEV_VALID_DEVID_OR_ERR_RET(dev_id, -EINVAL);
+	if (id >= RTE_EVENT_ETH_RX_ADAPTER_MAX_INSTANCE || conf_cb == NULL)
+		return -EINVAL;
+	if (rx_adapters[id] != NULL)
+		return -EEXIST;
+
+	socket_id = rte_event_dev_socket_id(dev_id);
+	rxa = rte_zmalloc_socket("rte_event_eth_rx_adapter", sizeof(*rxa),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (rxa == NULL) {
+		RTE_EDEV_LOG_ERR("failed to allocate Rx adapter %u", id);
+		return -ENOMEM;
+	}
+
+	rxa->eventdev_id = dev_id;
+	rxa->conf_cb = conf_cb;
+	rxa->conf_arg = conf_arg;
+	rte_spinlock_init(&rxa->rx_lock);
+	rte_convert_rss_key((const uint32_t *)rxa_rss_key, rxa->rss_key_be,
+			RSS_KEY_SIZE);
+
+	memset(&service, 0, sizeof(service));
+	snprintf(service.name, sizeof(service.name),
+			"rte_event_eth_rx_adapter_%u", id);
+	service.socket_id = socket_id;
+	service.callback = rxa_service_func;
+	service.callback_userdata = rxa;
+	/* the service serializes itself on rx_lock */
+	service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
+	ret = rte_service_component_register(&service, &rxa->service_id);
+	if (ret < 0) {
+		RTE_EDEV_LOG_ERR("failed to register service %s: %d",
+				service.name, ret);
+		rte_free(rxa);
+		return -ENOMEM;
+	}
+
+	rx_adapters[id] = rxa;
+	return 0;
+}
+
+int
+rte_event_eth_rx_adapter_create(uint8_t id, uint8_t dev_id,
+		struct rte_event_port_conf *port_config)
+{
+	struct rte_event_port_conf *pc;
+	int ret;
+
+	if (port_config == NULL)
+		return -EINVAL;
+
+	pc = rte_malloc(NULL, sizeof(*pc), 0);
+	if (pc == NULL)
+		return -ENOMEM;
+	*pc = *port_config;
+
+	ret = rte_event_eth_rx_adapter_create_ext(id, dev_id,
+			rxa_default_conf_cb, pc);
+	if (ret < 0) {
+		rte_free(pc);
+		return ret;
+	}
+	rx_adapters[id]->default_cb_arg = 1;
+	return 0;
+}
+
+int
+rte_event_eth_rx_adapter_free(uint8_t id)
+{
+	struct rte_event_eth_rx_adapter *rxa = rxa_id_to_adapter(id);
+	uint16_t i;
+
+	if (rxa == NULL)
+		return -EINVAL;
+	if (rxa->nb_queues != 0 || rxa->started)
+		return -EBUSY;
+
+	rte_service_component_unregister(rxa->service_id);
+
+	/* events the device never accepted */
+	for (i = 0; i < rxa->nb_events; i++) {
+		struct rte_event *ev = &rxa->events[i];
+
+		if (ev->event_type & RTE_EVENT_TYPE_VECTOR) {
+			rte_pktmbuf_free_bulk(ev->vec->mbufs,
+					ev->vec->nb_elem);
+			rte_mempool_put(rte_mempool_from_obj(ev->vec),
+					ev->vec);
+		} else {
+			rte_pktmbuf_free(ev->mbuf);
+		}
+	}
+
+	if (rxa->default_cb_arg)
+		rte_free(rxa->conf_arg);
+	rte_free(rxa);
+	rx_adapters[id] = NULL;
+	return 0;
+}
+
+int
+rte_event_eth_rx_adapter_queue_add(uint8_t id, uint8_t eth_dev_id,
+		int32_t rx_queue_id,
+		const struct rte_event_eth_rx_adapter_queue_conf *queue_conf)
+{
+	struct rte_event_eth_rx_adapter *rxa = rxa_id_to_adapter(id);
+	struct eth_device_info *dev_info;
+	uint16_t nb_rx_queues;
+	uint16_t first, last, q;
+	int ret;
+
+	if (rxa == NULL || queue_conf == NULL ||
+			!rte_eth_dev_is_valid_port(eth_dev_id))
+		return -EINVAL;
+
+	nb_rx_queues = rte_eth_devices[eth_dev_id].data->nb_rx_queues;
+	if (rx_queue_id >= (int32_t)nb_rx_queues || rx_queue_id < -1 ||
+			nb_rx_queues == 0) {
+		RTE_EDEV_LOG_ERR("invalid Rx queue %" PRId32 " of port %u",
+				rx_queue_id, eth_dev_id);
+		return -EINVAL;
+	}
+
+	if ((queue_conf->rx_queue_flags &
+			RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR) &&
+			(queue_conf->vector_mp == NULL ||
+			 queue_conf->vector_sz == 0 ||
+			 queue_conf->vector_sz > rte_event_vector_pool_nb_elem(
+				 queue_conf->vector_mp))) {
+		RTE_EDEV_LOG_ERR("invalid vector configuration of Rx queue %"
+				PRId32 " of port %u", rx_queue_id, eth_dev_id);
+		return -EINVAL;
+	}
+
+	if (!rxa->configured) {
+		struct rte_event_eth_rx_adapter_conf conf;
+
+		memset(&conf, 0, sizeof(conf));
+		ret = rxa->conf_cb(id, rxa->eventdev_id, &conf, rxa->conf_arg);
+		if (ret < 0) {
+			RTE_EDEV_LOG_ERR("configuration of adapter %u failed: %d",
+					id, ret);
+			return ret;
+		}
+		rxa->event_port_id = conf.event_port_id;
+		rxa->max_nb_rx = conf.max_nb_rx;
+		rxa->configured = 1;
+	}
+
+	rte_spinlock_lock(&rxa->rx_lock);
+
+	dev_info = &rxa->eth_devices[eth_dev_id];
+	if (dev_info->rx_queue == NULL) {
+		dev_info->rx_queue = rte_zmalloc("rxa_rx_queue",
+				nb_rx_queues * sizeof(*dev_info->rx_queue),
+				RTE_CACHE_LINE_SIZE);
+		if (dev_info->rx_queue == NULL) {
+			rte_spinlock_unlock(&rxa->rx_lock);
+			return -ENOMEM;
+		}
+		dev_info->nb_dev_queues = nb_rx_queues;
+	}
+
+	first = rx_queue_id == -1 ? 0 : rx_queue_id;
+	last = rx_queue_id == -1 ? dev_info->nb_dev_queues - 1 : rx_queue_id;
+	for (q = first; q <= last; q++) {
+		struct eth_rx_queue_info *qi = &dev_info->rx_queue[q];
+
+		if (!qi->enabled) {
+			qi->enabled = 1;
+			dev_info->nb_queues_added++;
+			rxa->nb_queues++;
+		}
+		qi->wt = queue_conf->servicing_weight == 0 ?
+			1 : queue_conf->servicing_weight;
+		qi->flow_id_valid = !!(queue_conf->rx_queue_flags &
+				RTE_EVENT_ETH_RX_ADAPTER_QUEUE_FLOW_ID_VALID);
+		qi->ev.event = 0;
+		qi->ev.flow_id = queue_conf->ev.flow_id;
+		qi->ev.sub_event_type = queue_conf->ev.sub_event_type;
+		qi->ev.event_type = RTE_EVENT_TYPE_ETHDEV;
+		qi->ev.op = RTE_EVENT_OP_NEW;
+		qi->ev.sched_type = queue_conf->ev.sched_type;
+		qi->ev.queue_id = queue_conf->ev.queue_id;
+		qi->ev.priority = queue_conf->ev.priority;
+
+		if (qi->vector_mp != NULL) {
+			rxa_vector_free(qi);
+			qi->vector_mp = NULL;
+			rxa->nb_vector_queues--;
+		}
+		if (queue_conf->rx_queue_flags &
+				RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR) {
+			qi->vector_mp = queue_conf->vector_mp;
+			qi->vector_sz = queue_conf->vector_sz;
+			qi->vector_tmo_ticks = queue_conf->vector_timeout_ns *
+				(rte_get_tsc_hz() / 1E9);
+			rxa->nb_vector_queues++;
+		}
+	}
+
+	ret = rxa_calc_wrr(rxa);
+	rte_spinlock_unlock(&rxa->rx_lock);
+	return ret;
+}
+
+int
+rte_event_eth_rx_adapter_queue_del(uint8_t id, uint8_t eth_dev_id,
+		int32_t rx_queue_id)
+{
+	struct rte_event_eth_rx_adapter *rxa = rxa_id_to_adapter(id);
+	struct eth_device_info *dev_info;
+	uint16_t first, last, q;
+	int ret;
+
+	if (rxa == NULL || eth_dev_id >= RTE_MAX_ETHPORTS)
+		return -EINVAL;
+
+	dev_info = &rxa->eth_devices[eth_dev_id];
+	if (dev_info->rx_queue == NULL ||
+			rx_queue_id >= (int32_t)dev_info->nb_dev_queues ||
+			rx_queue_id < -1)
+		return -EINVAL;
+	if (rx_queue_id != -1 && !dev_info->rx_queue[rx_queue_id].enabled)
+		return -EINVAL;
+
+	rte_spinlock_lock(&rxa->rx_lock);
+
+	first = rx_queue_id == -1 ? 0 : rx_queue_id;
+	last = rx_queue_id == -1 ? dev_info->nb_dev_queues - 1 : rx_queue_id;
+	for (q = first; q <= last; q++) {
+		struct eth_rx_queue_info *qi = &dev_info->rx_queue[q];
+
+		if (qi->enabled) {
+			qi->enabled = 0;
+			dev_info->nb_queues_added--;
+			rxa->nb_queues--;
+		}
+		if (qi->vector_mp != NULL) {
+			rxa_vector_free(qi);
+			qi->vector_mp = NULL;
+			rxa->nb_vector_queues--;
+		}
+	}
+
+	ret = rxa_calc_wrr(rxa);
+	if (ret == 0 && dev_info->nb_queues_added == 0) {
+		rte_free(dev_info->rx_queue);
+		dev_info->rx_queue = NULL;
+		dev_info->nb_dev_queues = 0;
+	}
+
+	rte_spinlock_unlock(&rxa->rx_lock);
+	return ret;
+}
+
+int
+rte_event_eth_rx_adapter_start(uint8_t id)
+{
+	struct rte_event_eth_rx_adapter *rxa = rxa_id_to_adapter(id);
+
+	if (rxa == NULL)
+		return -EINVAL;
+
+	rxa->started = 1;
+	rte_service_component_runstate_set(rxa->service_id, 1);
+	return 0;
+}
+
+int
+rte_event_eth_rx_adapter_stop(uint8_t id)
+{
+	struct rte_event_eth_rx_adapter *rxa = rxa_id_to_adapter(id);
+
+	if (rxa == NULL)
+		return -EINVAL;
+
+	rte_service_component_runstate_set(rxa->service_id, 0);
+	while (rte_service_may_be_active(rxa->service_id) == 1)
+		rte_pause();
+	/* an application lcore may still be in the service */
+	rte_spinlock_lock(&rxa->rx_lock);
+	rxa->started = 0;
+	rte_spinlock_unlock(&rxa->rx_lock);
+	return 0;
+}
+
+int
+rte_event_eth_rx_adapter_stats_get(uint8_t id,
+		struct rte_event_eth_rx_adapter_stats *stats)
+{
+	struct rte_event_eth_rx_adapter *rxa = rxa_id_to_adapter(id);
+
+	if (rxa == NULL || stats == NULL)
+		return -EINVAL;
+
+	*stats = rxa->stats;
+	return 0;
+}
+
+int
+rte_event_eth_rx_adapter_stats_reset(uint8_t id)
+{
+	struct rte_event_eth_rx_adapter *rxa = rxa_id_to_adapter(id);
+
+	if (rxa == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&rxa->rx_lock);
+	memset(&rxa->stats, 0, sizeof(rxa->stats));
+	rte_spinlock_unlock(&rxa->rx_lock);
+	return 0;
+}
+
+int
+rte_event_eth_rx_adapter_service_id_get(uint8_t id, uint32_t *service_id)
+{
+	struct rte_event_eth_rx_adapter *rxa = rxa_id_to_adapter(id);
+
+	if (rxa == NULL || service_id == NULL)
+		return -EINVAL;
+
+	*service_id = rxa->service_id;
+	return 0;
+}
@@ -0,0 +1,339 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_EVENT_ETH_RX_ADAPTER_H_
+#define _RTE_EVENT_ETH_RX_ADAPTER_H_
+
+/**
+ * @file
+ *
+ * RTE Event Ethernet Rx Adapter
+ *
+ * An Rx adapter moves packets received on ethdev Rx queues into an event
+ * device. It polls the Rx queues added to it, converts each received
+ * mbuf into a new event (RTE_EVENT_TYPE_ETHDEV) according to the
+ * configuration of the queue, and enqueues the events in batches through
+ * an event port of its own.
+ *
+ * The Rx queues are polled in a weighted round robin order, the
+ * servicing weight of a queue being the number of times it is polled in
+ * a round. The flow id of the events is the RSS hash of the packets,
+ * computed in software when the NIC did not provide it, unless the
+ * application sets a fixed flow id for the queue.
+ *
+ * The adapter registers a service (see rte_service.h). The service is
+ * either mapped to a service lcore by the application, or run from an
+ * application lcore with rte_service_run_iter_on_app_lcore(); its id is
+ * returned by rte_event_eth_rx_adapter_service_id_get().
+ *
+ * When the event device does not accept all the events, they are kept
+ * by the adapter and no Rx queue is polled until they are enqueued, so
+ * that the backpressure is propagated to the Rx queues instead of
+ * dropping packets.
+ *
+ * The control path functions are not thread safe with each other, but
+ * they can be called while the service is running.
+ */
+
+#include <stdint.h>
+
+#include "rte_eventdev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of Rx adapter instances. */
+#define RTE_EVENT_ETH_RX_ADAPTER_MAX_INSTANCE 32
+
+/**
+ * This flag indicates that the flow id of the event template of the
+ * queue configuration must be used, instead of the RSS hash of the
+ * packets.
+ *
+ * @see struct rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
+ */
+#define RTE_EVENT_ETH_RX_ADAPTER_QUEUE_FLOW_ID_VALID	0x1
+/**
+ * This flag indicates that the packets of the queue are aggregated in
+ * vectors (RTE_EVENT_TYPE_ETHDEV_VECTOR events), each vector holding
+ * packets of a single flow. A vector is enqueued when it holds
+ * *vector_sz* packets, when its first packet is older than
+ * *vector_timeout_ns*, or when a packet of another flow needs its slot
+ * (a small number of vectors are aggregated at once per queue). When the
+ * vector pool is empty, the packets are enqueued as single mbuf events
+ * (RTE_EVENT_TYPE_ETHDEV).
+ *
+ * @see struct rte_event_eth_rx_adapter_queue_conf::rx_queue_flags
+ */
+#define RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR	0x2
+
+/**
+ * Adapter configuration, returned by the configuration callback.
+ */
+struct rte_event_eth_rx_adapter_conf {
+	uint8_t event_port_id;
+	/**< Event port used by the adapter to enqueue the events. */
+	uint32_t max_nb_rx;
+	/**< Maximum number of packets received by an iteration of the
+	 * service; the Rx queues are polled until this number is reached or
+	 * a full round of the queues is done. Zero means no limit other than
+	 * the round.
+	 */
+};
+
+/**
+ * Configuration callback, called by the adapter when the first Rx queue
+ * is added, to get the event port it must use. The callback can set up a
+ * new event port, which may require to stop and reconfigure the event
+ * device.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @param dev_id
+ *   Event device identifier.
+ * @param[out] conf
+ *   Adapter configuration to fill.
+ * @param arg
+ *   Argument given to rte_event_eth_rx_adapter_create_ext().
+ * @return
+ *   0 on success, negative on error.
+ */
+typedef int (*rte_event_eth_rx_adapter_conf_cb) (uint8_t id, uint8_t dev_id,
+			struct rte_event_eth_rx_adapter_conf *conf,
+			void *arg);
+
+/**
+ * Rx queue configuration.
+ */
+struct rte_event_eth_rx_adapter_queue_conf {
+	uint32_t rx_queue_flags;
+	/**< Flags (RTE_EVENT_ETH_RX_ADAPTER_QUEUE_*) of the queue. */
+	uint16_t servicing_weight;
+	/**< Relative polling frequency of the queue; 0 is taken as 1. */
+	struct rte_event ev;
+	/**< Template of the events of the queue. The queue_id, sched_type,
+	 * priority and sub_event_type are copied in each event; flow_id
+	 * too when RTE_EVENT_ETH_RX_ADAPTER_QUEUE_FLOW_ID_VALID is set. The
+	 * other fields are set by the adapter.
+	 */
+	uint16_t vector_sz;
+	/**< Maximum number of packets of a vector, with
+	 * RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR. It must not be higher
+	 * than the number of elements of the vectors of *vector_mp*.
+	 */
+	uint64_t vector_timeout_ns;
+	/**< Maximum time a packet waits in an incomplete vector, with
+	 * RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR. The timeout is
+	 * checked by each iteration of the service.
+	 */
+	struct rte_mempool *vector_mp;
+	/**< Pool of the vectors, created with rte_event_vector_pool_create(),
+	 * with RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR.
+	 */
+};
+
+/**
+ * Adapter statistics.
+ */
+struct rte_event_eth_rx_adapter_stats {
+	uint64_t rx_poll_count;
+	/**< Number of Rx burst calls. */
+	uint64_t rx_packets;
+	/**< Number of packets received. */
+	uint64_t rx_enq_count;
+	/**< Number of events enqueued to the event device. */
+	uint64_t rx_enq_retry;
+	/**< Number of enqueue attempts that did not enqueue all the
+	 * buffered events.
+	 */
+	uint64_t rx_enq_block_cycles;
+	/**< TSC cycles during which the event device did not accept all
+	 * the buffered events.
+	 */
+};
+
+/**
+ * Create an Rx adapter with a configuration callback.
+ *
+ * @param id
+ *   Adapter identifier, lower than RTE_EVENT_ETH_RX_ADAPTER_MAX_INSTANCE.
+ * @param dev_id
+ *   Event device identifier.
+ * @param conf_cb
+ *   Configuration callback.
+ * @param conf_arg
+ *   Argument passed to the configuration callback.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid identifier or callback.
+ *   - -EEXIST: An adapter with this identifier already exists.
+ *   - -ENOMEM: Memory allocation or service registration failure.
+ */
+int rte_event_eth_rx_adapter_create_ext(uint8_t id, uint8_t dev_id,
+		rte_event_eth_rx_adapter_conf_cb conf_cb, void *conf_arg);
+
+/**
+ * Create an Rx adapter with the default configuration callback, which
+ * adds an event port configured with *port_config* to the event device.
+ * If the device is started, it is stopped while it is reconfigured and
+ * then restarted.
+ *
+ * @param id
+ *   Adapter identifier, lower than RTE_EVENT_ETH_RX_ADAPTER_MAX_INSTANCE.
+ * @param dev_id
+ *   Event device identifier.
+ * @param port_config
+ *   Configuration of the event port of the adapter, copied.
+ * @return
+ *   See rte_event_eth_rx_adapter_create_ext().
+ */
+int rte_event_eth_rx_adapter_create(uint8_t id, uint8_t dev_id,
+		struct rte_event_port_conf *port_config);
+
+/**
+ * Free an Rx adapter. All its Rx queues must have been deleted and it
+ * must be stopped.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid identifier.
+ *   - -EBUSY: The adapter still has Rx queues, or is started.
+ */
+int rte_event_eth_rx_adapter_free(uint8_t id);
+
+/**
+ * Add an Rx queue, or all the Rx queues of a device, to an adapter. If
+ * the queue was already added, its configuration is updated and the
+ * packets of its incomplete vectors are freed.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @param eth_dev_id
+ *   Ethernet device identifier.
+ * @param rx_queue_id
+ *   Rx queue index, or -1 for all the Rx queues of the device.
+ * @param conf
+ *   Queue configuration.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameter.
+ *   - -ENOMEM: Memory allocation failure.
+ *   - Other negative values: Error returned by the configuration callback.
+ */
+int rte_event_eth_rx_adapter_queue_add(uint8_t id, uint8_t eth_dev_id,
+		int32_t rx_queue_id,
+		const struct rte_event_eth_rx_adapter_queue_conf *conf);
+
+/**
+ * Delete an Rx queue, or all the Rx queues of a device, from an adapter.
+ * The packets of the incomplete vectors of the queues are freed.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @param eth_dev_id
+ *   Ethernet device identifier.
+ * @param rx_queue_id
+ *   Rx queue index, or -1 for all the Rx queues of the device.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameter, or the queue was not added.
+ *   - -ENOMEM: Memory allocation failure.
+ */
+int rte_event_eth_rx_adapter_queue_del(uint8_t id, uint8_t eth_dev_id,
+		int32_t rx_queue_id);
+
+/**
+ * Start an Rx adapter: its service is allowed to run.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @return
+ *   0 on success, -EINVAL if the identifier is invalid.
+ */
+int rte_event_eth_rx_adapter_start(uint8_t id);
+
+/**
+ * Stop an Rx adapter. When the function returns, the service is not
+ * running anymore.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @return
+ *   0 on success, -EINVAL if the identifier is invalid.
+ */
+int rte_event_eth_rx_adapter_stop(uint8_t id);
+
+/**
+ * Get the statistics of an Rx adapter.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @param[out] stats
+ *   Statistics.
+ * @return
+ *   0 on success, -EINVAL if a parameter is invalid.
+ */
+int rte_event_eth_rx_adapter_stats_get(uint8_t id,
+		struct rte_event_eth_rx_adapter_stats *stats);
+
+/**
+ * Reset the statistics of an Rx adapter.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @return
+ *   0 on success, -EINVAL if the identifier is invalid.
+ */
+int rte_event_eth_rx_adapter_stats_reset(uint8_t id);
+
+/**
+ * Get the service id of an Rx adapter, to map it to a service lcore or
+ * to run it with rte_service_run_iter_on_app_lcore().
+ *
+ * @param id
+ *   Adapter identifier.
+ * @param[out] service_id
+ *   Service identifier.
+ * @return
+ *   0 on success, -EINVAL if a parameter is invalid.
+ */
+int rte_event_eth_rx_adapter_service_id_get(uint8_t id, uint32_t *service_id);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_EVENT_ETH_RX_ADAPTER_H_ */
@@ -0,0 +1,602 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_atomic.h>
+#include <rte_cycles.h>
+#include <rte_malloc.h>
+#include <rte_spinlock.h>
+#include <rte_service_component.h>
+
+#include "rte_eventdev.h"
+#include "rte_eventdev_pmd.h"
+#include "rte_event_timer_adapter.h"
+
+#define NSEC_PER_SEC		1000000000ULL
+#define BATCH_SIZE		32
+#define EVENT_BUFFER_SIZE	(4 * BATCH_SIZE)
+#define MAX_WHEEL_SLOTS		(1 << 20)
+
+/*
+ * A slot of the timing wheel holds the armed timers whose expiry tick
+ * modulo the number of slots is the slot index, in a doubly linked list
+ * chained through impl_opaque[0] (next) and impl_opaque[1] (prev).
+ * impl_opaque[2] is the expiry tick.
+ */
+struct wheel_slot {
+	rte_spinlock_t lock;
+	struct rte_event_timer *head;
+};
+
+struct rte_event_timer_adapter {
+	struct wheel_slot *slots;
+	uint64_t slot_mask;
+	uint64_t start_cycles;    /* timer cycles of tick 0 */
+	uint64_t cycles_per_tick;
+	uint64_t max_tmo_ticks;
+	/* next tick processed by the service, written with the lock of
+	 * the slot of the processed tick held
+	 */
+	volatile uint64_t cur_tick;
+	rte_atomic64_t nb_armed;
+	uint64_t nb_timers;
+	uint16_t id;
+	uint8_t event_dev_id;
+	uint8_t event_port_id;
+	uint32_t service_id;
+	int started;
+	/* events of expired timers not yet accepted by the device */
+	struct rte_event events[EVENT_BUFFER_SIZE];
+	uint16_t nb_events;
+	struct rte_event_timer_adapter_stats stats;
+} __rte_cache_aligned;
+
+static struct rte_event_timer_adapter
+	*timer_adapters[RTE_EVENT_TIMER_ADAPTER_MAX_INSTANCE];
+
+static inline struct rte_event_timer *
+tim_next(const struct rte_event_timer *tim)
+{
+	return (struct rte_event_timer *)(uintptr_t)tim->impl_opaque[0];
+}
+
+static inline struct rte_event_timer *
+tim_prev(const struct rte_event_timer *tim)
+{
+	return (struct rte_event_timer *)(uintptr_t)tim->impl_opaque[1];
+}
+
+static inline void
+tim_set_next(struct rte_event_timer *tim, struct rte_event_timer *next)
+{
+	tim->impl_opaque[0] = (uintptr_t)next;
+}
+
+static inline void
+tim_set_prev(struct rte_event_timer *tim, struct rte_event_timer *prev)
+{
+	tim->impl_opaque[1] = (uintptr_t)prev;
+}
+
+static inline struct wheel_slot *
+tim_slot(const struct rte_event_timer_adapter *adapter, uint64_t tick)
+{
+	return &adapter->slots[tick & adapter->slot_mask];
+}
+
+static inline uint64_t
+tim_now_tick(const struct rte_event_timer_adapter *adapter)
+{
+	return (rte_get_timer_cycles() - adapter->start_cycles) /
+		adapter->cycles_per_tick;
+}
+
+/* called with the slot lock held */
+static inline void
+tim_link(struct wheel_slot *slot, struct rte_event_timer *tim)
+{
+	struct rte_event_timer *head = slot->head;
+
+	tim_set_next(tim, head);
+	tim_set_prev(tim, NULL);
+	if (head != NULL)
+		tim_set_prev(head, tim);
+	slot->head = tim;
+}
+
+/* called with the slot lock held */
+static inline void
+tim_unlink(struct wheel_slot *slot, struct rte_event_timer *tim)
+{
+	struct rte_event_timer *next = tim_next(tim);
+	struct rte_event_timer *prev = tim_prev(tim);
+
+	if (prev != NULL)
+		tim_set_next(prev, next);
+	else
+		slot->head = next;
+	if (next != NULL)
+		tim_set_prev(next, prev);
+}
+
+static inline int
+tim_arm(struct rte_event_timer_adapter *adapter, struct rte_event_timer *tim,
+		uint64_t now_tick, uint64_t timeout_ticks)
+{
+	struct wheel_slot *slot;
+	uint64_t expiry;
+	uint64_t cur_tick;
+
+	if (tim->state == RTE_EVENT_TIMER_ARMED)
+		return -EALREADY;
+	if (unlikely(timeout_ticks == 0)) {
+		tim->state = RTE_EVENT_TIMER_ERROR_TOOEARLY;
+		return -EINVAL;
+	}
+	if (unlikely(timeout_ticks > adapter->max_tmo_ticks)) {
+		tim->state = RTE_EVENT_TIMER_ERROR_TOOLATE;
+		return -EINVAL;
+	}
+
+	tim->ev.op = RTE_EVENT_OP_NEW;
+	tim->ev.event_type = RTE_EVENT_TYPE_TIMERDEV;
+
+	/* if the service already processed the expiry tick, the timer
+	 * goes in the slot of the tick being processed
+	 */
+	expiry = now_tick + timeout_ticks;
+	for (;;) {
+		slot = tim_slot(adapter, expiry);
+		rte_spinlock_lock(&slot->lock);
+		cur_tick = adapter->cur_tick;
+		if (likely(expiry >= cur_tick))
+			break;
+		rte_spinlock_unlock(&slot->lock);
+		expiry = cur_tick;
+	}
+
+	tim->impl_opaque[2] = expiry;
+	tim_link(slot, tim);
+	tim->state = RTE_EVENT_TIMER_ARMED;
+	rte_spinlock_unlock(&slot->lock);
+	return 0;
+}
+
+static inline uint16_t
+tim_arm_burst(struct rte_event_timer_adapter *adapter,
+		struct rte_event_timer **tims, uint16_t nb_tims,
+		const uint64_t *timeout_ticks)
+{
+	uint64_t now_tick;
+	uint64_t nb_armed;
+	uint16_t nb_avail = nb_tims;
+	uint16_t i;
+	int ret = 0;
+
+	if (unlikely(adapter == NULL || tims == NULL)) {
+		rte_errno = EINVAL;
+		return 0;
+	}
+
+	/* reserve room for the whole burst, give back the rest */
+	nb_armed = rte_atomic64_add_return(&adapter->nb_armed, nb_tims);
+	if (unlikely(nb_armed > adapter->nb_timers))
+		nb_avail -= RTE_MIN(nb_armed - adapter->nb_timers,
+				(uint64_t)nb_tims);
+
+	now_tick = tim_now_tick(adapter);
+	for (i = 0; i < nb_avail; i++) {
+		ret = tim_arm(adapter, tims[i], now_tick,
+			timeout_ticks != NULL ? *timeout_ticks :
+			tims[i]->timeout_ticks);
+		if (unlikely(ret < 0))
+			break;
+	}
+
+	if (i < nb_tims) {
+		rte_atomic64_sub(&adapter->nb_armed, nb_tims - i);
+		rte_errno = i < nb_avail ? -ret : ENOSPC;
+	}
+	return i;
+}
+
+uint16_t
+rte_event_timer_arm_burst(struct rte_event_timer_adapter *adapter,
+		struct rte_event_timer **tims, uint16_t nb_tims)
+{
+	return tim_arm_burst(adapter, tims, nb_tims, NULL);
+}
+
+uint16_t
+rte_event_timer_arm_tmo_tick_burst(struct rte_event_timer_adapter *adapter,
+		struct rte_event_timer **tims, uint64_t timeout_ticks,
+		uint16_t nb_tims)
+{
+	uint16_t i;
+
+	if (tims != NULL)
+		for (i = 0; i < nb_tims; i++)
+			tims[i]->timeout_ticks = timeout_ticks;
+
+	return tim_arm_burst(adapter, tims, nb_tims, &timeout_ticks);
+}
+
+uint16_t
+rte_event_timer_cancel_burst(struct rte_event_timer_adapter *adapter,
+		struct rte_event_timer **tims, uint16_t nb_tims)
+{
+	uint16_t i;
+
+	if (unlikely(adapter == NULL || tims == NULL)) {
+		rte_errno = EINVAL;
+		return 0;
+	}
+
+	for (i = 0; i < nb_tims; i++) {
+		struct rte_event_timer *tim = tims[i];
+		struct wheel_slot *slot;
+
+		if (tim->state != RTE_EVENT_TIMER_ARMED) {
+			rte_errno = EALREADY;
+			break;
+		}
+
+		/* the expiry tick is stable while the timer is armed */
+		slot = tim_slot(adapter, tim->impl_opaque[2]);
+		rte_spinlock_lock(&slot->lock);
+		if (tim->state != RTE_EVENT_TIMER_ARMED) {
+			/* expired meanwhile */
+			rte_spinlock_unlock(&slot->lock);
+			rte_errno = EALREADY;
+			break;
+		}
+		tim_unlink(slot, tim);
+		tim->state = RTE_EVENT_TIMER_CANCELED;
+		rte_spinlock_unlock(&slot->lock);
+	}
+
+	rte_atomic64_sub(&adapter->nb_armed, i);
+	return i;
+}
+
+static inline void
+tim_flush_events(struct rte_event_timer_adapter *adapter)
+{
+	struct rte_event_timer_adapter_stats *stats = &adapter->stats;
+	uint16_t done = 0;
+	uint16_t n;
+
+	if (adapter->nb_events == 0)
+		return;
+
+	do {
+		n = rte_event_enqueue_burst(adapter->event_dev_id,
+				adapter->event_port_id, &adapter->events[done],
+				RTE_MIN(adapter->nb_events - done, BATCH_SIZE));
+		done += n;
+	} while (n != 0 && done < adapter->nb_events);
+	stats->ev_enq_count += done;
+
+	if (done < adapter->nb_events) {
+		memmove(adapter->events, &adapter->events[done],
+			(adapter->nb_events - done) * sizeof(struct rte_event));
+		stats->evtim_retry_count++;
+	}
+	adapter->nb_events -= done;
+}
+
+/*
+ * Expire the timers of the ticks up to the current one, at most a wheel
+ * revolution per call. When the event buffer is full and the device does
+ * not accept the events, the current slot is resumed at the next call.
+ */
+static int32_t
+tim_service_func(void *args)
+{
+	struct rte_event_timer_adapter *adapter = args;
+	uint64_t now_tick = tim_now_tick(adapter);
+	uint64_t nb_ticks = adapter->slot_mask + 1;
+	uint64_t nb_expired = 0;
+
+	tim_flush_events(adapter);
+
+	while (adapter->cur_tick <= now_tick && nb_ticks-- > 0) {
+		uint64_t tick = adapter->cur_tick;
+		struct wheel_slot *slot = tim_slot(adapter, tick);
+		struct rte_event_timer *tim, *next;
+
+		rte_spinlock_lock(&slot->lock);
+		for (tim = slot->head; tim != NULL; tim = next) {
+			next = tim_next(tim);
+			/* armed for a later revolution */
+			if (tim->impl_opaque[2] > tick)
+				continue;
+
+			if (adapter->nb_events == EVENT_BUFFER_SIZE) {
+				tim_flush_events(adapter);
+				if (adapter->nb_events == EVENT_BUFFER_SIZE) {
+					rte_spinlock_unlock(&slot->lock);
+					goto out;
+				}
+			}
+			tim_unlink(slot, tim);
+			adapter->events[adapter->nb_events++] = tim->ev;
+			tim->state = RTE_EVENT_TIMER_NOT_ARMED;
+			nb_expired++;
+		}
+		adapter->cur_tick = tick + 1;
+		rte_spinlock_unlock(&slot->lock);
+		adapter->stats.adapter_tick_count++;
+	}
+
+	tim_flush_events(adapter);
+out:
+	adapter->stats.evtim_exp_count += nb_expired;
+	rte_atomic64_sub(&adapter->nb_armed, nb_expired);
+	return 0;
+}
+
+/* Add an event port to the device for the adapter. */
+static int
+tim_default_port_conf_cb(uint16_t id, uint8_t event_dev_id,
+		uint8_t *event_port_id, void *arg)
+{
+	struct rte_eventdev *dev = &rte_eventdevs[event_dev_id];
+	struct rte_event_port_conf *port_conf = arg;
+	struct rte_event_port_conf def_conf;
+	struct rte_event_dev_config dev_conf;
+	uint8_t port_id;
+	int started;
+	int ret;
+
+	dev_conf = dev->data->dev_conf;
+	started = dev->data->dev_started;
+	if (started)
+		rte_event_dev_stop(event_dev_id);
+
+	port_id = dev_conf.nb_event_ports;
+	dev_conf.nb_event_ports += 1;
+	ret = rte_event_dev_configure(event_dev_id, &dev_conf);
+	if (ret < 0) {
+		RTE_EDEV_LOG_ERR("failed to configure event dev %u for timer adapter %u",
+				event_dev_id, id);
+		goto restart;
+	}
+
+	if (port_conf == NULL) {
+		ret = rte_event_port_default_conf_get(event_dev_id, port_id,
+				&def_conf);
+		if (ret < 0)
+			goto restart;
+		port_conf = &def_conf;
+	}
+	ret = rte_event_port_setup(event_dev_id, port_id, port_conf);
+	if (ret < 0) {
+		RTE_EDEV_LOG_ERR("failed to setup event port %u for timer adapter %u",
+				port_id, id);
+		goto restart;
+	}
+
+	*event_port_id = port_id;
+
+restart:
+	if (started) {
+		int err = rte_event_dev_start(event_dev_id);
+
+		if (ret == 0)
+			ret = err;
+	}
+	return ret;
+}
+
+struct rte_event_timer_adapter *
+rte_event_timer_adapter_create_ext(
+		const struct rte_event_timer_adapter_conf *conf,
+		rte_event_timer_adapter_port_conf_cb_t conf_cb,
+		void *conf_arg)
+{
+	struct rte_event_timer_adapter *adapter;
+	struct rte_service_spec service;
+	uint64_t cycles_per_tick, max_tmo_ticks, nb_slots;
+	int ret;
+
+	if (conf == NULL || conf_cb == NULL ||
+			conf->timer_adapter_id >=
+				RTE_EVENT_TIMER_ADAPTER_MAX_INSTANCE ||
+			!rte_event_pmd_is_valid_dev(conf->event_dev_id) ||
+			conf->timer_tick_ns == 0 || conf->nb_timers == 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	if (timer_adapters[conf->timer_adapter_id] != NULL) {
+		rte_errno = EEXIST;
+		return NULL;
+	}
+
+	cycles_per_tick = (uint64_t)((double)conf->timer_tick_ns *
+			rte_get_timer_hz() / NSEC_PER_SEC);
+	max_tmo_ticks = conf->max_tmo_ns / conf->timer_tick_ns;
+	if (cycles_per_tick == 0 || max_tmo_ticks == 0) {
+		RTE_EDEV_LOG_ERR("invalid timer resolution %" PRIu64
+				" ns or maximum timeout %" PRIu64 " ns",
+				conf->timer_tick_ns, conf->max_tmo_ns);
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	/* longer timeouts wait for several revolutions */
+	nb_slots = rte_align64pow2(RTE_MIN(max_tmo_ticks + 1,
+				(uint64_t)MAX_WHEEL_SLOTS));
+
+	adapter = rte_zmalloc_socket("rte_event_timer_adapter",
+			sizeof(*adapter), RTE_CACHE_LINE_SIZE, conf->socket_id);
+	if (adapter == NULL) {
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+	adapter->slots = rte_zmalloc_socket("rte_event_timer_adapter_wheel",
+			nb_slots * sizeof(*adapter->slots), RTE_CACHE_LINE_SIZE,
+			conf->socket_id);
+	if (adapter->slots == NULL) {
+		RTE_EDEV_LOG_ERR("failed to allocate %" PRIu64 " wheel slots",
+				nb_slots);
+		rte_free(adapter);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	adapter->id = conf->timer_adapter_id;
+	adapter->event_dev_id = conf->event_dev_id;
+	adapter->slot_mask = nb_slots - 1;
+	adapter->cycles_per_tick = cycles_per_tick;
+	adapter->max_tmo_ticks = max_tmo_ticks;
+	adapter->nb_timers = conf->nb_timers;
+	rte_atomic64_init(&adapter->nb_armed);
+
+	ret = conf_cb(adapter->id, adapter->event_dev_id,
+			&adapter->event_port_id, conf_arg);
+	if (ret < 0) {
+		RTE_EDEV_LOG_ERR("configuration of timer adapter %u failed: %d",
+				adapter->id, ret);
+		rte_errno = -ret;
+		goto free;
+	}
+
+	memset(&service, 0, sizeof(service));
+	snprintf(service.name, sizeof(service.name),
+			"rte_event_timer_adapter_%u", adapter->id);
+	service.socket_id = conf->socket_id;
+	service.callback = tim_service_func;
+	service.callback_userdata = adapter;
+	ret = rte_service_component_register(&service, &adapter->service_id);
+	if (ret < 0) {
+		RTE_EDEV_LOG_ERR("failed to register service %s: %d",
+				service.name, ret);
+		rte_errno = ENOMEM;
+		goto free;
+	}
+
+	adapter->start_cycles = rte_get_timer_cycles();
+	timer_adapters[adapter->id] = adapter;
+	return adapter;
+
+free:
+	rte_free(adapter->slots);
+	rte_free(adapter);
+	return NULL;
+}
+
+struct rte_event_timer_adapter *
+rte_event_timer_adapter_create(const struct rte_event_timer_adapter_conf *conf,
+		const struct rte_event_port_conf *port_conf)
+{
+	return rte_event_timer_adapter_create_ext(conf,
+			tim_default_port_conf_cb, (void *)(uintptr_t)port_conf);
+}
+
+int
+rte_event_timer_adapter_free(struct rte_event_timer_adapter *adapter)
+{
+	if (adapter == NULL || timer_adapters[adapter->id] != adapter)
+		return -EINVAL;
+	if (adapter->started)
+		return -EBUSY;
+
+	rte_service_component_unregister(adapter->service_id);
+
+	timer_adapters[adapter->id] = NULL;
+	rte_free(adapter->slots);
+	rte_free(adapter);
+	return 0;
+}
+
+int
+rte_event_timer_adapter_start(struct rte_event_timer_adapter *adapter)
+{
+	if (adapter == NULL)
+		return -EINVAL;
+
+	adapter->started = 1;
+	rte_service_component_runstate_set(adapter->service_id, 1);
+	return 0;
+}
+
+int
+rte_event_timer_adapter_stop(struct rte_event_timer_adapter *adapter)
+{
+	if (adapter == NULL)
+		return -EINVAL;
+
+	rte_service_component_runstate_set(adapter->service_id, 0);
+	while (rte_service_may_be_active(adapter->service_id) == 1)
+		rte_pause();
+	adapter->started = 0;
+	return 0;
+}
+
+int
+rte_event_timer_adapter_service_id_get(struct rte_event_timer_adapter *adapter,
+		uint32_t *service_id)
+{
+	if (adapter == NULL || service_id == NULL)
+		return -EINVAL;
+
+	*service_id = adapter->service_id;
+	return 0;
+}
+
+int
+rte_event_timer_adapter_stats_get(struct rte_event_timer_adapter *adapter,
+		struct rte_event_timer_adapter_stats *stats)
+{
+	if (adapter == NULL || stats == NULL)
+		return -EINVAL;
+
+	*stats = adapter->stats;
+	return 0;
+}
+
+int
+rte_event_timer_adapter_stats_reset(struct rte_event_timer_adapter *adapter)
+{
+	if (adapter == NULL)
+		return -EINVAL;
+
+	memset(&adapter->stats, 0, sizeof(adapter->stats));
+	return 0;
+}
@@ -0,0 +1,351 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_EVENT_TIMER_ADAPTER_H_
+#define _RTE_EVENT_TIMER_ADAPTER_H_
+
+/**
+ * @file
+ *
+ * RTE Event Timer Adapter
+ *
+ * An event timer is an event (struct rte_event) enqueued to an event
+ * device when a timeout expires, so that timeouts are scheduled to the
+ * workers like any other event, instead of running as callbacks on the
+ * lcore managing the timers as with librte_timer.
+ *
+ * The application arms and cancels its event timers by bursts. The timeout
+ * is a number of adapter ticks, whose duration (the resolution) is set in
+ * nanoseconds in the adapter configuration. The armed timers are kept in a
+ * hashed timing wheel with one lock per slot, so that arming and cancelling
+ * from several lcores rarely contend, and the cost of arming, cancelling
+ * and expiring a timer does not depend on the number of outstanding
+ * timers.
+ *
+ * The wheel is advanced by a service (see rte_service.h), which enqueues
+ * the events of the expired timers through an event port of the adapter.
+ * The service is mapped to a service lcore by the application, or run from
+ * an application lcore with rte_service_run_iter_on_app_lcore(). When the
+ * event device does not accept the events, the expiry is delayed until it
+ * does; no timer is lost.
+ *
+ * The event timers are allocated by the application and must not be
+ * modified nor freed while they are armed.
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+
+#include "rte_eventdev.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of timer adapter instances. */
+#define RTE_EVENT_TIMER_ADAPTER_MAX_INSTANCE 32
+
+/**
+ * Timer adapter configuration.
+ */
+struct rte_event_timer_adapter_conf {
+	uint8_t event_dev_id;
+	/**< Event device identifier. */
+	uint16_t timer_adapter_id;
+	/**< Adapter identifier, lower than
+	 * RTE_EVENT_TIMER_ADAPTER_MAX_INSTANCE.
+	 */
+	int socket_id;
+	/**< Socket of the adapter memory. */
+	uint64_t timer_tick_ns;
+	/**< Duration of a tick, the resolution of the timers. */
+	uint64_t max_tmo_ns;
+	/**< Maximum timeout. */
+	uint64_t nb_timers;
+	/**< Maximum number of armed timers. */
+};
+
+/**
+ * Configuration callback of the adapter, called at creation to get the
+ * event port the adapter must use.
+ *
+ * @param id
+ *   Adapter identifier.
+ * @param event_dev_id
+ *   Event device identifier.
+ * @param[out] event_port_id
+ *   Event port to use.
+ * @param arg
+ *   Argument given to rte_event_timer_adapter_create_ext().
+ * @return
+ *   0 on success, negative on error.
+ */
+typedef int (*rte_event_timer_adapter_port_conf_cb_t)(uint16_t id,
+		uint8_t event_dev_id, uint8_t *event_port_id, void *arg);
+
+/**
+ * Adapter statistics.
+ */
+struct rte_event_timer_adapter_stats {
+	uint64_t evtim_exp_count;
+	/**< Number of expired timers. */
+	uint64_t ev_enq_count;
+	/**< Number of timer events enqueued to the event device. */
+	uint64_t evtim_retry_count;
+	/**< Number of enqueue attempts which did not enqueue all the events
+	 * of the expired timers.
+	 */
+	uint64_t adapter_tick_count;
+	/**< Number of ticks processed by the service. */
+};
+
+/** State of an event timer. */
+enum rte_event_timer_state {
+	RTE_EVENT_TIMER_NOT_ARMED = 0,
+	/**< Not armed, or expired: its event was given to the device. */
+	RTE_EVENT_TIMER_ARMED = 1,
+	/**< Armed. */
+	RTE_EVENT_TIMER_CANCELED = 2,
+	/**< Canceled before it expired. */
+	RTE_EVENT_TIMER_ERROR = -1,
+	/**< Arm failed. */
+	RTE_EVENT_TIMER_ERROR_TOOEARLY = -2,
+	/**< Arm failed: the timeout is shorter than a tick. */
+	RTE_EVENT_TIMER_ERROR_TOOLATE = -3,
+	/**< Arm failed: the timeout is longer than the maximum timeout. */
+};
+
+/**
+ * An event timer, allocated by the application.
+ */
+struct rte_event_timer {
+	struct rte_event ev;
+	/**< Event enqueued on expiry. The queue_id, sched_type, priority,
+	 * flow_id, sub_event_type and event pointer are set by the
+	 * application; the op and event_type are set by the adapter
+	 * (RTE_EVENT_OP_NEW, RTE_EVENT_TYPE_TIMERDEV).
+	 */
+	volatile enum rte_event_timer_state state;
+	/**< State, updated by the adapter. */
+	uint64_t timeout_ticks;
+	/**< Timeout in adapter ticks, set by the application. The timer
+	 * expires when the timeout_ticks-th tick after the current one
+	 * starts, i.e. after timeout_ticks - 1 to timeout_ticks ticks, plus
+	 * the latency of the service.
+	 */
+	uint64_t impl_opaque[3];
+	/**< Used by the adapter while the timer is armed. */
+	uint8_t user_meta[0];
+	/**< Application data following the timer. */
+} __rte_cache_aligned;
+
+struct rte_event_timer_adapter;
+
+/**
+ * Create a timer adapter with a configuration callback.
+ *
+ * @param conf
+ *   Adapter configuration.
+ * @param conf_cb
+ *   Configuration callback.
+ * @param conf_arg
+ *   Argument of the configuration callback.
+ * @return
+ *   The adapter, or NULL on error with rte_errno set:
+ *   - EINVAL: Invalid configuration.
+ *   - EEXIST: An adapter with this identifier already exists.
+ *   - ENOMEM: Memory allocation or service registration failure.
+ *   - Other values: Error returned by the configuration callback.
+ */
+struct rte_event_timer_adapter *
+rte_event_timer_adapter_create_ext(
+		const struct rte_event_timer_adapter_conf *conf,
+		rte_event_timer_adapter_port_conf_cb_t conf_cb,
+		void *conf_arg);
+
+/**
+ * Create a timer adapter with the default configuration callback, which
+ * adds an event port to the event device, with the configuration given
+ * by *port_conf* if not NULL. If the device is started, it is stopped
+ * while it is reconfigured and then restarted.
+ *
+ * @param conf
+ *   Adapter configuration.
+ * @param port_conf
+ *   Configuration of the event port of the adapter, or NULL for the
+ *   default port configuration of the device.
+ * @return
+ *   See rte_event_timer_adapter_create_ext().
+ */
+struct rte_event_timer_adapter *
+rte_event_timer_adapter_create(const struct rte_event_timer_adapter_conf *conf,
+		const struct rte_event_port_conf *port_conf);
+
+/**
+ * Free a timer adapter. It must be stopped; the timers still armed are
+ * not expired.
+ *
+ * @param adapter
+ *   The adapter.
+ * @return
+ *   0 on success, -EINVAL if the adapter is invalid, -EBUSY if it is
+ *   started.
+ */
+int rte_event_timer_adapter_free(struct rte_event_timer_adapter *adapter);
+
+/**
+ * Start a timer adapter: its service is allowed to run.
+ *
+ * @param adapter
+ *   The adapter.
+ * @return
+ *   0 on success, -EINVAL if the adapter is invalid.
+ */
+int rte_event_timer_adapter_start(struct rte_event_timer_adapter *adapter);
+
+/**
+ * Stop a timer adapter. When the function returns, the service is not
+ * running on a service lcore anymore. The armed timers remain armed.
+ *
+ * @param adapter
+ *   The adapter.
+ * @return
+ *   0 on success, -EINVAL if the adapter is invalid.
+ */
+int rte_event_timer_adapter_stop(struct rte_event_timer_adapter *adapter);
+
+/**
+ * Get the service id of a timer adapter.
+ *
+ * @param adapter
+ *   The adapter.
+ * @param[out] service_id
+ *   Service identifier.
+ * @return
+ *   0 on success, -EINVAL if a parameter is invalid.
+ */
+int rte_event_timer_adapter_service_id_get(
+		struct rte_event_timer_adapter *adapter, uint32_t *service_id);
+
+/**
+ * Get the statistics of a timer adapter.
+ *
+ * @param adapter
+ *   The adapter.
+ * @param[out] stats
+ *   Statistics.
+ * @return
+ *   0 on success, -EINVAL if a parameter is invalid.
+ */
+int rte_event_timer_adapter_stats_get(struct rte_event_timer_adapter *adapter,
+		struct rte_event_timer_adapter_stats *stats);
+
+/**
+ * Reset the statistics of a timer adapter.
+ *
+ * @param adapter
+ *   The adapter.
+ * @return
+ *   0 on success, -EINVAL if the adapter is invalid.
+ */
+int rte_event_timer_adapter_stats_reset(
+		struct rte_event_timer_adapter *adapter);
+
+/**
+ * Arm a burst of event timers, each with its own timeout_ticks.
+ *
+ * The state of each armed timer becomes RTE_EVENT_TIMER_ARMED. The
+ * function stops at the first timer which cannot be armed, and sets
+ * rte_errno.
+ *
+ * @param adapter
+ *   The adapter.
+ * @param tims
+ *   Array of timers.
+ * @param nb_tims
+ *   Number of timers.
+ * @return
+ *   The number of timers armed. If lower than *nb_tims*, rte_errno is:
+ *   - EINVAL: Invalid timeout; the state of the timer is set to
+ *     RTE_EVENT_TIMER_ERROR_TOOEARLY or RTE_EVENT_TIMER_ERROR_TOOLATE.
+ *   - EALREADY: The timer is already armed.
+ *   - ENOSPC: The adapter has nb_timers armed timers.
+ */
+uint16_t rte_event_timer_arm_burst(struct rte_event_timer_adapter *adapter,
+		struct rte_event_timer **tims, uint16_t nb_tims);
+
+/**
+ * Arm a burst of event timers with the same timeout, ignoring their
+ * timeout_ticks field, which is set to *timeout_ticks*.
+ *
+ * @param adapter
+ *   The adapter.
+ * @param tims
+ *   Array of timers.
+ * @param timeout_ticks
+ *   Timeout in adapter ticks.
+ * @param nb_tims
+ *   Number of timers.
+ * @return
+ *   See rte_event_timer_arm_burst().
+ */
+uint16_t rte_event_timer_arm_tmo_tick_burst(
+		struct rte_event_timer_adapter *adapter,
+		struct rte_event_timer **tims, uint64_t timeout_ticks,
+		uint16_t nb_tims);
+
+/**
+ * Cancel a burst of armed event timers. The state of each canceled timer
+ * becomes RTE_EVENT_TIMER_CANCELED and its event is not enqueued. The
+ * function stops at the first timer which cannot be canceled, and sets
+ * rte_errno.
+ *
+ * @param adapter
+ *   The adapter.
+ * @param tims
+ *   Array of timers.
+ * @param nb_tims
+ *   Number of timers.
+ * @return
+ *   The number of timers canceled. If lower than *nb_tims*, rte_errno is
+ *   EALREADY: the timer is not armed, it may have expired meanwhile.
+ */
+uint16_t rte_event_timer_cancel_burst(struct rte_event_timer_adapter *adapter,
+		struct rte_event_timer **tims, uint16_t nb_tims);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_EVENT_TIMER_ADAPTER_H_ */
@@ -56,6 +56,7 @@
 #include <rte_branch_prediction.h>
 #include <rte_common.h>
 #include <rte_malloc.h>
+#include <rte_mempool.h>
 #include <rte_errno.h>
 
 #include "rte_eventdev.h"
@@ -1075,6 +1076,58 @@ rte_event_dev_close(uint8_t dev_id)
 	return (*dev->dev_ops->dev_close)(dev);
 }
 
+/* private data of the event vector pools */
+struct event_vector_pool_priv {
+	uint16_t nb_elem;
+};
+
+static void
+event_vector_init(struct rte_mempool *mp, void *arg, void *obj,
+		unsigned int idx)
+{
+	struct rte_event_vector *vec = obj;
+
+	RTE_SET_USED(mp);
+	RTE_SET_USED(arg);
+	RTE_SET_USED(idx);
+	memset(vec, 0, sizeof(*vec));
+}
+
+struct rte_mempool *
+rte_event_vector_pool_create(const char *name, unsigned int n,
+		unsigned int cache_size, uint16_t nb_elem, int socket_id)
+{
+	struct event_vector_pool_priv *priv;
+	struct rte_mempool *mp;
+	unsigned int elt_size;
+
+	if (nb_elem == 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	elt_size = sizeof(struct rte_event_vector) +
+		nb_elem * sizeof(uint64_t);
+	mp = rte_mempool_create(name, n, elt_size, cache_size,
+			sizeof(*priv), NULL, NULL, event_vector_init, NULL,
+			socket_id, 0);
+	if (mp == NULL)
+		return NULL;
+
+	priv = rte_mempool_get_priv(mp);
+	priv->nb_elem = nb_elem;
+	return mp;
+}
+
+uint16_t
+rte_event_vector_pool_nb_elem(const struct rte_mempool *mp)
+{
+	const struct event_vector_pool_priv *priv =
+		rte_mempool_get_priv((struct rte_mempool *)(uintptr_t)mp);
+
+	return priv->nb_elem;
+}
+
 static inline int
 rte_eventdev_data_alloc(uint8_t dev_id, struct rte_eventdev_data **data,
 		int socket_id)
@@ -246,6 +246,7 @@ extern "C" {
 #include <rte_common.h>
 #include <rte_memory.h>
 #include <rte_errno.h>
+#include <rte_lcore_poll.h>
 
 struct rte_mbuf; /* we just use mbuf pointers; no need to include rte_mbuf.h */
 
@@ -858,6 +859,18 @@ rte_event_dev_close(uint8_t dev_id);
 /**< The event generated from cpu for pipelining.
  * Application may use *sub_event_type* to further classify the event
  */
+#define RTE_EVENT_TYPE_VECTOR           0x8
+/**< The event carries a vector of objects (struct rte_event_vector)
+ * instead of a single one. This bit is combined with the type of the
+ * event source, see RTE_EVENT_TYPE_ETHDEV_VECTOR and
+ * RTE_EVENT_TYPE_CPU_VECTOR.
+ */
+#define RTE_EVENT_TYPE_ETHDEV_VECTOR \
+	(RTE_EVENT_TYPE_VECTOR | RTE_EVENT_TYPE_ETHDEV)
+/**< The event carries a vector of mbufs received by an ethdev */
+#define RTE_EVENT_TYPE_CPU_VECTOR \
+	(RTE_EVENT_TYPE_VECTOR | RTE_EVENT_TYPE_CPU)
+/**< The event carries a vector of objects generated from cpu */
 #define RTE_EVENT_TYPE_MAX              0x10
 /**< Maximum number of event types */
 
@@ -901,6 +914,40 @@ rte_event_dev_close(uint8_t dev_id);
  *
  */
 
+/**
+ * A vector of objects carried by a single event, whose *event_type* has
+ * the RTE_EVENT_TYPE_VECTOR bit set. All the objects of a vector belong
+ * to the flow of the event, so that the scheduling cost is paid once for
+ * the whole vector and the consumer processes the objects as a burst.
+ *
+ * The vectors are allocated from a pool created with
+ * rte_event_vector_pool_create(). The consumer of the last stage frees
+ * the objects and puts the vector back to its pool.
+ */
+RTE_STD_C11
+struct rte_event_vector {
+	uint16_t nb_elem;
+	/**< Number of valid elements in the vector */
+	uint16_t port;
+	/**< Ethernet port of the mbufs of a RTE_EVENT_TYPE_ETHDEV_VECTOR
+	 * event.
+	 */
+	uint16_t queue;
+	/**< Ethernet Rx queue of the mbufs of a RTE_EVENT_TYPE_ETHDEV_VECTOR
+	 * event.
+	 */
+	uint16_t rsvd;
+	/**< Reserved for future use */
+	union {
+		struct rte_mbuf *mbufs[0];
+		/**< mbufs of a RTE_EVENT_TYPE_ETHDEV_VECTOR event */
+		void *ptrs[0];
+		/**< Opaque pointers */
+		uint64_t u64s[0];
+		/**< Opaque 64-bit values */
+	};
+};
+
 /**
  * The generic *rte_event* structure to hold the event attributes
  * for dequeue and enqueue operation
@@ -974,6 +1021,10 @@ struct rte_event {
 		/**< Opaque event pointer */
 		struct rte_mbuf *mbuf;
 		/**< mbuf pointer if dequeued event is associated with mbuf */
+		struct rte_event_vector *vec;
+		/**< Vector of objects if the event type has the
+		 * RTE_EVENT_TYPE_VECTOR bit set.
+		 */
 	};
 };
 
@@ -1258,6 +1309,7 @@ rte_event_dequeue_burst(uint8_t dev_id, uint8_t port_id, struct rte_event ev[],
 			uint16_t nb_events, uint64_t timeout_ticks)
 {
 	struct rte_eventdev *dev = &rte_eventdevs[dev_id];
+	uint16_t nb_deq;
 
 #ifdef RTE_LIBRTE_EVENTDEV_DEBUG
 	if (dev_id >= RTE_EVENT_MAX_DEVS || !rte_eventdevs[dev_id].attached) {
@@ -1276,12 +1328,16 @@ rte_event_dequeue_burst(uint8_t dev_id, uint8_t port_id, struct rte_event ev[],
 	 * requests nb_events as const one
 	 */
 	if (nb_events == 1)
-		return (*dev->dequeue)(
+		nb_deq = (*dev->dequeue)(
 			dev->data->ports[port_id], ev, timeout_ticks);
 	else
-		return (*dev->dequeue_burst)(
+		nb_deq = (*dev->dequeue_burst)(
 			dev->data->ports[port_id], ev, nb_events,
 				timeout_ticks);
+
+	rte_lcore_poll_mark(nb_deq);
+
+	return nb_deq;
 }
 
 /**
@@ -1581,6 +1637,42 @@ rte_event_dev_xstats_reset(uint8_t dev_id,
 			   const uint32_t ids[],
 			   uint32_t nb_ids);
 
+struct rte_mempool;
+
+/**
+ * Create a pool of event vectors.
+ *
+ * @param name
+ *   The name of the pool.
+ * @param n
+ *   The number of vectors in the pool.
+ * @param cache_size
+ *   The size of the per-lcore caches of the pool, see rte_mempool_create().
+ * @param nb_elem
+ *   The maximum number of elements of a vector.
+ * @param socket_id
+ *   The socket on which the pool is allocated, or SOCKET_ID_ANY.
+ * @return
+ *   The pool, or NULL on error with rte_errno set:
+ *   - EINVAL: zero *nb_elem*.
+ *   - the errors of rte_mempool_create().
+ */
+struct rte_mempool *
+rte_event_vector_pool_create(const char *name, unsigned int n,
+			     unsigned int cache_size, uint16_t nb_elem,
+			     int socket_id);
+
+/**
+ * Get the maximum number of elements of the vectors of a pool.
+ *
+ * @param mp
+ *   A pool created with rte_event_vector_pool_create().
+ * @return
+ *   The *nb_elem* given when the pool was created.
+ */
+uint16_t
+rte_event_vector_pool_nb_elem(const struct rte_mempool *mp);
+
 #ifdef __cplusplus
 }
 #endif
@@ -285,6 +285,120 @@ rte_pktmbuf_dump(FILE *f, const struct rte_mbuf *m, unsigned dump_len)
 	}
 }
 
+/* size of the per-mempool arrays used by rte_pktmbuf_free_bulk() */
+#define MBUF_FREE_BULK_SZ 64
+/* number of mempools rte_pktmbuf_free_bulk() accumulates mbufs for */
+#define MBUF_FREE_BULK_NB_POOLS 4
+
+struct mbuf_free_bulk {
+	struct rte_mempool *mp;
+	unsigned int nb;
+	void *objs[MBUF_FREE_BULK_SZ];
+};
+
+static inline void
+mbuf_free_bulk_flush(struct mbuf_free_bulk *pending)
+{
+	rte_mempool_put_bulk(pending->mp, pending->objs, pending->nb);
+	pending->nb = 0;
+}
+
+/* find or allocate the array of a mempool, flushing another if needed */
+static struct mbuf_free_bulk *
+mbuf_free_bulk_get(struct rte_mempool *mp, struct mbuf_free_bulk *pending,
+	unsigned int *nb_pools)
+{
+	unsigned int i, max;
+
+	for (i = 0; i < *nb_pools; i++) {
+		if (pending[i].mp == mp)
+			return &pending[i];
+	}
+
+	if (i < MBUF_FREE_BULK_NB_POOLS) {
+		(*nb_pools)++;
+	} else {
+		/* no room for a new pool, flush the largest array */
+		for (max = 0, i = 1; i < MBUF_FREE_BULK_NB_POOLS; i++) {
+			if (pending[i].nb > pending[max].nb)
+				max = i;
+		}
+		i = max;
+		mbuf_free_bulk_flush(&pending[i]);
+	}
+	pending[i].mp = mp;
+	pending[i].nb = 0;
+
+	return &pending[i];
+}
+
+/* free a bulk of packet mbufs back into their original mempools */
+void
+rte_pktmbuf_free_bulk(struct rte_mbuf **mbufs, unsigned int count)
+{
+	struct mbuf_free_bulk pending[MBUF_FREE_BULK_NB_POOLS];
+	struct mbuf_free_bulk *p, *prev, *tmp;
+	struct rte_mbuf *m, *m_next;
+	unsigned int idx, nb_pools = 0;
+
+	/* no pool yet, the first mbuf gets an array */
+	pending[0].mp = NULL;
+	p = prev = &pending[0];
+
+	for (idx = 0; idx < count; idx++) {
+		m = mbufs[idx];
+		if (unlikely(m == NULL))
+			continue;
+
+		__rte_mbuf_sanity_check(m, 1);
+
+		/*
+		 * Most of the time, the mbuf is a direct single segment one
+		 * that is not shared: rte_pktmbuf_prefree_seg() would not
+		 * change it.
+		 */
+		if (likely(m->next == NULL && RTE_MBUF_DIRECT(m) &&
+				rte_mbuf_refcnt_read(m) == 1)) {
+			m_next = NULL;
+		} else {
+			m_next = m->next;
+			m = rte_pktmbuf_prefree_seg(m);
+		}
+
+		for (;;) {
+			if (likely(m != NULL)) {
+				/*
+				 * The mbufs usually come from the pool of
+				 * the previous one, or alternate between two
+				 * pools, e.g. for headers and payloads.
+				 */
+				if (unlikely(m->pool != p->mp)) {
+					tmp = p;
+					if (m->pool == prev->mp)
+						p = prev;
+					else
+						p = mbuf_free_bulk_get(m->pool,
+							pending, &nb_pools);
+					prev = tmp;
+				}
+				if (unlikely(p->nb == MBUF_FREE_BULK_SZ))
+					mbuf_free_bulk_flush(p);
+				p->objs[p->nb++] = m;
+			}
+			if (likely(m_next == NULL))
+				break;
+			m = m_next;
+			m_next = m->next;
+			m = rte_pktmbuf_prefree_seg(m);
+		}
+	}
+
+	for (idx = 0; idx < nb_pools; idx++) {
+		if (pending[idx].nb > 0)
+			mbuf_free_bulk_flush(&pending[idx]);
+	}
+}
+
 /* read len data bytes in a mbuf at specified offset (internal) */
 const void *__rte_pktmbuf_read(const struct rte_mbuf *m, uint32_t off,
 	uint32_t len, void *buf)
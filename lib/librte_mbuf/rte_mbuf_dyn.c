@@ -0,0 +1,446 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <limits.h>
+#include <inttypes.h>
+#include <errno.h>
+#include <sys/queue.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_eal.h>
+#include <rte_eal_memconfig.h>
+#include <rte_memzone.h>
+#include <rte_rwlock.h>
+#include <rte_errno.h>
+#include <rte_string_fns.h>
+#include <rte_mbuf.h>
+#include <rte_mbuf_dyn.h>
+
+#define RTE_MBUF_DYN_MZNAME "rte_mbuf_dyn"
+
+/* room reserved for dynamic fields, at most one field per byte */
+#define MBUF_DYN_SPACE (sizeof(((struct rte_mbuf *)0)->dynfield1))
+#define MBUF_DYN_MAX_FLAGS 64
+
+struct mbuf_dynfield_elt {
+	struct rte_mbuf_dynfield params;
+	size_t offset;
+};
+
+struct mbuf_dynflag_elt {
+	struct rte_mbuf_dynflag params;
+	unsigned int bitnum;
+};
+
+/*
+ * The registry, stored in a memzone so that it is shared between the
+ * primary and secondary processes. It is protected by the EAL tailq
+ * lock, like the other shared objects lists.
+ */
+struct mbuf_dyn_shm {
+	/* for each byte of the mbuf, 1 if it can be used by a field */
+	uint8_t free_space[sizeof(struct rte_mbuf)];
+	/* a bit is set if it can be used by a dynamic flag */
+	uint64_t free_flags;
+	unsigned int nb_fields;
+	struct mbuf_dynfield_elt fields[MBUF_DYN_SPACE];
+	unsigned int nb_flags;
+	struct mbuf_dynflag_elt flags[MBUF_DYN_MAX_FLAGS];
+};
+
+static struct mbuf_dyn_shm *shm;
+
+/* mark the bits of ol_flags that are not used by a static flag */
+static uint64_t
+mbuf_dyn_free_flags(void)
+{
+	uint64_t free_flags = 0;
+	unsigned int bit;
+
+	/* Rx flags are allocated from bit 0, Tx flags from bit 63 down to
+	 * PKT_TX_MACSEC: the bits in between are free. */
+	for (bit = 0; bit < MBUF_DYN_MAX_FLAGS; bit++) {
+		uint64_t flag = 1ULL << bit;
+
+		if (flag > PKT_RX_TIMESTAMP && flag < PKT_TX_MACSEC)
+			free_flags |= flag;
+	}
+
+	return free_flags;
+}
+
+/* attach or create the shared registry, called with the lock held */
+static int
+init_shared_mem(void)
+{
+	const struct rte_memzone *mz;
+
+	if (shm != NULL)
+		return 0;
+
+	mz = rte_memzone_lookup(RTE_MBUF_DYN_MZNAME);
+	if (mz != NULL) {
+		shm = mz->addr;
+		return 0;
+	}
+
+	mz = rte_memzone_reserve_aligned(RTE_MBUF_DYN_MZNAME,
+		sizeof(struct mbuf_dyn_shm), SOCKET_ID_ANY, 0,
+		RTE_CACHE_LINE_SIZE);
+	if (mz == NULL) {
+		RTE_LOG(ERR, MBUF,
+			"Failed to reserve memory for mbuf dynamic fields\n");
+		rte_errno = ENOMEM;
+		return -1;
+	}
+
+	shm = mz->addr;
+	memset(shm, 0, sizeof(*shm));
+	memset(&shm->free_space[offsetof(struct rte_mbuf, dynfield1)], 1,
+		MBUF_DYN_SPACE);
+	shm->free_flags = mbuf_dyn_free_flags();
+
+	return 0;
+}
+
+/* called with the lock held */
+static struct mbuf_dynfield_elt *
+dynfield_find(const char *name)
+{
+	unsigned int i;
+
+	if (shm == NULL)
+		return NULL;
+
+	for (i = 0; i < shm->nb_fields; i++) {
+		if (strcmp(name, shm->fields[i].params.name) == 0)
+			return &shm->fields[i];
+	}
+
+	return NULL;
+}
+
+/* called with the lock held */
+static struct mbuf_dynflag_elt *
+dynflag_find(const char *name)
+{
+	unsigned int i;
+
+	if (shm == NULL)
+		return NULL;
+
+	for (i = 0; i < shm->nb_flags; i++) {
+		if (strcmp(name, shm->flags[i].params.name) == 0)
+			return &shm->flags[i];
+	}
+
+	return NULL;
+}
+
+/* check if a field can be stored at this offset */
+static int
+dynfield_offset_is_free(const struct rte_mbuf_dynfield *params,
+	size_t offset)
+{
+	size_t i;
+
+	if (offset % params->align != 0)
+		return 0;
+	if (offset + params->size > sizeof(struct rte_mbuf))
+		return 0;
+
+	for (i = 0; i < params->size; i++) {
+		if (!shm->free_space[offset + i])
+			return 0;
+	}
+
+	return 1;
+}
+
+int
+rte_mbuf_dynfield_lookup(const char *name, struct rte_mbuf_dynfield *params)
+{
+	struct mbuf_dynfield_elt *elt;
+	int ret = -1;
+
+	rte_rwlock_read_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (shm == NULL) {
+		const struct rte_memzone *mz;
+
+		mz = rte_memzone_lookup(RTE_MBUF_DYN_MZNAME);
+		if (mz != NULL)
+			shm = mz->addr;
+	}
+
+	elt = dynfield_find(name);
+	if (elt != NULL) {
+		if (params != NULL)
+			*params = elt->params;
+		ret = (int)elt->offset;
+	}
+
+	rte_rwlock_read_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (ret < 0)
+		rte_errno = ENOENT;
+	return ret;
+}
+
+int
+rte_mbuf_dynfield_register_offset(const struct rte_mbuf_dynfield *params,
+	size_t req)
+{
+	struct mbuf_dynfield_elt *elt;
+	size_t offset;
+	int ret = -1;
+
+	if (strnlen(params->name, RTE_MBUF_DYN_NAMESIZE) ==
+			RTE_MBUF_DYN_NAMESIZE) {
+		rte_errno = ENAMETOOLONG;
+		return -1;
+	}
+	if (params->size == 0 || params->align == 0 ||
+			!rte_is_power_of_2(params->align) ||
+			params->size > MBUF_DYN_SPACE ||
+			params->flags != 0) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (init_shared_mem() < 0)
+		goto out;
+
+	elt = dynfield_find(params->name);
+	if (elt != NULL) {
+		if (elt->params.size != params->size ||
+				elt->params.align != params->align ||
+				elt->params.flags != params->flags ||
+				(req != SIZE_MAX && req != elt->offset)) {
+			rte_errno = EEXIST;
+			goto out;
+		}
+		ret = (int)elt->offset;
+		goto out;
+	}
+
+	if (req != SIZE_MAX) {
+		if (!dynfield_offset_is_free(params, req)) {
+			rte_errno = EBUSY;
+			goto out;
+		}
+		offset = req;
+	} else {
+		for (offset = 0; offset < sizeof(struct rte_mbuf); offset++) {
+			if (dynfield_offset_is_free(params, offset))
+				break;
+		}
+		if (offset == sizeof(struct rte_mbuf)) {
+			rte_errno = ENOENT;
+			goto out;
+		}
+	}
+
+	elt = &shm->fields[shm->nb_fields++];
+	elt->params = *params;
+	elt->offset = offset;
+	memset(&shm->free_space[offset], 0, params->size);
+
+	RTE_LOG(DEBUG, MBUF, "Registered dynamic field %s (sz=%zu, al=%zu, "
+		"fl=0x%x) -> %zu\n", params->name, params->size,
+		params->align, params->flags, offset);
+	ret = (int)offset;
+
+out:
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+	return ret;
+}
+
+int
+rte_mbuf_dynfield_register(const struct rte_mbuf_dynfield *params)
+{
+	return rte_mbuf_dynfield_register_offset(params, SIZE_MAX);
+}
+
+int
+rte_mbuf_dynflag_lookup(const char *name, struct rte_mbuf_dynflag *params)
+{
+	struct mbuf_dynflag_elt *elt;
+	int ret = -1;
+
+	rte_rwlock_read_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (shm == NULL) {
+		const struct rte_memzone *mz;
+
+		mz = rte_memzone_lookup(RTE_MBUF_DYN_MZNAME);
+		if (mz != NULL)
+			shm = mz->addr;
+	}
+
+	elt = dynflag_find(name);
+	if (elt != NULL) {
+		if (params != NULL)
+			*params = elt->params;
+		ret = (int)elt->bitnum;
+	}
+
+	rte_rwlock_read_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (ret < 0)
+		rte_errno = ENOENT;
+	return ret;
+}
+
+int
+rte_mbuf_dynflag_register_bitnum(const struct rte_mbuf_dynflag *params,
+	unsigned int req)
+{
+	struct mbuf_dynflag_elt *elt;
+	unsigned int bitnum;
+	int ret = -1;
+
+	if (strnlen(params->name, RTE_MBUF_DYN_NAMESIZE) ==
+			RTE_MBUF_DYN_NAMESIZE) {
+		rte_errno = ENAMETOOLONG;
+		return -1;
+	}
+	if (params->flags != 0 ||
+			(req != UINT_MAX && req >= MBUF_DYN_MAX_FLAGS)) {
+		rte_errno = EINVAL;
+		return -1;
+	}
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (init_shared_mem() < 0)
+		goto out;
+
+	elt = dynflag_find(params->name);
+	if (elt != NULL) {
+		if (elt->params.flags != params->flags ||
+				(req != UINT_MAX && req != elt->bitnum)) {
+			rte_errno = EEXIST;
+			goto out;
+		}
+		ret = (int)elt->bitnum;
+		goto out;
+	}
+
+	if (req != UINT_MAX) {
+		if ((shm->free_flags & (1ULL << req)) == 0) {
+			rte_errno = EBUSY;
+			goto out;
+		}
+		bitnum = req;
+	} else {
+		if (shm->free_flags == 0) {
+			rte_errno = ENOENT;
+			goto out;
+		}
+		bitnum = __builtin_ctzll(shm->free_flags);
+	}
+
+	elt = &shm->flags[shm->nb_flags++];
+	elt->params = *params;
+	elt->bitnum = bitnum;
+	shm->free_flags &= ~(1ULL << bitnum);
+
+	RTE_LOG(DEBUG, MBUF, "Registered dynamic flag %s (fl=0x%x) -> %u\n",
+		params->name, params->flags, bitnum);
+	ret = (int)bitnum;
+
+out:
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+	return ret;
+}
+
+int
+rte_mbuf_dynflag_register(const struct rte_mbuf_dynflag *params)
+{
+	return rte_mbuf_dynflag_register_bitnum(params, UINT_MAX);
+}
+
+void
+rte_mbuf_dyn_dump(FILE *out)
+{
+	const struct mbuf_dynfield_elt *field;
+	const struct mbuf_dynflag_elt *flag;
+	unsigned int i;
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	if (init_shared_mem() < 0) {
+		rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+		return;
+	}
+
+	fprintf(out, "Reserved fields:\n");
+	for (i = 0; i < shm->nb_fields; i++) {
+		field = &shm->fields[i];
+		fprintf(out, "  name=%s offset=%zu size=%zu align=%zu flags=%x\n",
+			field->params.name, field->offset,
+			field->params.size, field->params.align,
+			field->params.flags);
+	}
+	fprintf(out, "Reserved flags:\n");
+	for (i = 0; i < shm->nb_flags; i++) {
+		flag = &shm->flags[i];
+		fprintf(out, "  name=%s bitnum=%u flags=%x\n",
+			flag->params.name, flag->bitnum, flag->params.flags);
+	}
+	fprintf(out, "Free space in mbuf (0 = free):\n");
+	for (i = 0; i < sizeof(struct rte_mbuf); i++) {
+		if ((i % 8) == 0)
+			fprintf(out, "  %4.4x: ", i);
+		fprintf(out, "%c", shm->free_space[i] ? '0' : '-');
+		if ((i % 8) == 7)
+			fprintf(out, "\n");
+	}
+	fprintf(out, "Free bit in mbuf->ol_flags (0 = free):\n");
+	for (i = 0; i < MBUF_DYN_MAX_FLAGS; i++) {
+		if ((i % 8) == 0)
+			fprintf(out, "  %4.4x: ", i);
+		fprintf(out, "%c", (shm->free_flags & (1ULL << i)) ? '0' : '-');
+		if ((i % 8) == 7)
+			fprintf(out, "\n");
+	}
+
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+}
@@ -68,10 +68,24 @@ static struct rte_tailq_elem rte_mempool_tailq = {
 };
 EAL_REGISTER_TAILQ(rte_mempool_tailq)
 
+RTE_TRACE_POINT_DEFINE(rte_mempool_trace_get, "lib.mempool.get",
+	"mempool", "nb_objs", "ret");
+RTE_TRACE_POINT_DEFINE(rte_mempool_trace_put, "lib.mempool.put",
+	"mempool", "nb_objs");
+
 #define CACHE_FLUSHTHRESH_MULTIPLIER 1.5
 #define CALC_CACHE_FLUSHTHRESH(c)	\
 	((typeof(c))((c) * CACHE_FLUSHTHRESH_MULTIPLIER))
 
+/*
+ * An adaptive cache grows when more than 1/8 of its operations access
+ * the common pool. It shrinks when less than 1/128 of them do and its
+ * fill level varied by less than a quarter of its size, so that a cache
+ * which is right-sized is not shrunk because it does not miss.
+ */
+#define CACHE_ADAPT_GROW_MISSES   (RTE_MEMPOOL_CACHE_ADAPT_PERIOD / 8)
+#define CACHE_ADAPT_SHRINK_MISSES (RTE_MEMPOOL_CACHE_ADAPT_PERIOD / 128)
+
 /*
  * return the greatest common divisor between a and b (fast algorithm)
  *
@@ -689,6 +703,50 @@ mempool_cache_init(struct rte_mempool_cache *cache, uint32_t size)
 	cache->size = size;
 	cache->flushthresh = CALC_CACHE_FLUSHTHRESH(size);
 	cache->len = 0;
+	cache->adapt_left = 0;
+	cache->adapt_misses = 0;
+	cache->adapt_len_min = 0;
+	cache->adapt_len_max = 0;
+#ifdef RTE_LIBRTE_MEMPOOL_CACHE_STATS
+	memset(&cache->stats, 0, sizeof(cache->stats));
+#endif
+}
+
+/* adjust the size of a cache to its recent miss rate */
+void
+rte_mempool_cache_adapt(struct rte_mempool *mp,
+	struct rte_mempool_cache *cache)
+{
+	uint32_t size = cache->size;
+	uint32_t min_size, max_size;
+
+	/* keep the flush threshold below the pool size */
+	max_size = RTE_MIN((uint32_t)RTE_MEMPOOL_CACHE_MAX_SIZE,
+		(uint32_t)(mp->size / CACHE_FLUSHTHRESH_MULTIPLIER));
+	min_size = RTE_MAX(mp->cache_size / 4, 1U);
+
+	if (cache->adapt_misses > CACHE_ADAPT_GROW_MISSES && size < max_size) {
+		size = RTE_MIN(size * 2, max_size);
+		__MEMPOOL_CACHE_STAT_INC(cache, grow);
+	} else if (cache->adapt_misses < CACHE_ADAPT_SHRINK_MISSES &&
+			cache->adapt_len_max - cache->adapt_len_min < size / 4 &&
+			size > min_size) {
+		size = RTE_MAX(size / 2, min_size);
+		__MEMPOOL_CACHE_STAT_INC(cache, shrink);
+		/* give the objects above the new size back to the pool */
+		if (cache->len > size) {
+			rte_mempool_ops_enqueue_bulk(mp, &cache->objs[size],
+				cache->len - size);
+			cache->len = size;
+		}
+	}
+
+	cache->size = size;
+	cache->flushthresh = CALC_CACHE_FLUSHTHRESH(size);
+	cache->adapt_misses = 0;
+	cache->adapt_len_min = cache->len;
+	cache->adapt_len_max = cache->len;
+	cache->adapt_left = RTE_MEMPOOL_CACHE_ADAPT_PERIOD;
 }
 
 /*
@@ -839,9 +897,13 @@ rte_mempool_create_empty(const char *name, unsigned n, unsigned elt_size,
 
 	/* Init all default caches. */
 	if (cache_size != 0) {
-		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
 			mempool_cache_init(&mp->local_cache[lcore_id],
 					   cache_size);
+			if (flags & MEMPOOL_F_CACHE_ADAPTIVE)
+				mp->local_cache[lcore_id].adapt_left =
+					RTE_MEMPOOL_CACHE_ADAPT_PERIOD;
+		}
 	}
 
 	te->data = mp;
@@ -1001,10 +1063,66 @@ rte_mempool_in_use_count(const struct rte_mempool *mp)
 	return mp->size - rte_mempool_avail_count(mp);
 }
 
+/* get the statistics of one or all the default caches of a mempool */
+int
+rte_mempool_cache_stats_get(const struct rte_mempool *mp,
+	unsigned int lcore_id, struct rte_mempool_cache_stats *stats)
+{
+#ifdef RTE_LIBRTE_MEMPOOL_CACHE_STATS
+	const struct rte_mempool_cache_stats *cs;
+	unsigned int i;
+
+	if (mp->cache_size == 0 ||
+			(lcore_id != LCORE_ID_ANY && lcore_id >= RTE_MAX_LCORE))
+		return -EINVAL;
+
+	if (lcore_id != LCORE_ID_ANY) {
+		*stats = mp->local_cache[lcore_id].stats;
+		return 0;
+	}
+
+	memset(stats, 0, sizeof(*stats));
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		cs = &mp->local_cache[i].stats;
+		stats->get_hit += cs->get_hit;
+		stats->get_miss += cs->get_miss;
+		stats->put += cs->put;
+		stats->put_flush += cs->put_flush;
+		stats->grow += cs->grow;
+		stats->shrink += cs->shrink;
+	}
+	return 0;
+#else
+	RTE_SET_USED(mp);
+	RTE_SET_USED(lcore_id);
+	RTE_SET_USED(stats);
+	return -ENOTSUP;
+#endif
+}
+
+/* reset the statistics of the default caches of a mempool */
+void
+rte_mempool_cache_stats_reset(struct rte_mempool *mp)
+{
+#ifdef RTE_LIBRTE_MEMPOOL_CACHE_STATS
+	unsigned int lcore_id;
+
+	if (mp->cache_size == 0)
+		return;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		memset(&mp->local_cache[lcore_id].stats, 0,
+			sizeof(mp->local_cache[lcore_id].stats));
+#else
+	RTE_SET_USED(mp);
+#endif
+}
+
 /* dump the cache status */
 static unsigned
 rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 {
+	const struct rte_mempool_cache *cache;
 	unsigned lcore_id;
 	unsigned count = 0;
 	unsigned cache_count;
@@ -1016,10 +1134,23 @@ rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 		return count;
 
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
-		cache_count = mp->local_cache[lcore_id].len;
+		cache = &mp->local_cache[lcore_id];
+		cache_count = cache->len;
 		fprintf(f, "    cache_count[%u]=%"PRIu32"\n",
 			lcore_id, cache_count);
 		count += cache_count;
+#ifdef RTE_LIBRTE_MEMPOOL_CACHE_STATS
+		if (cache->stats.get_hit == 0 && cache->stats.get_miss == 0 &&
+				cache->stats.put == 0)
+			continue;
+		fprintf(f, "    cache[%u]: size=%"PRIu32" get_hit=%"PRIu64
+			" get_miss=%"PRIu64" put=%"PRIu64" put_flush=%"PRIu64
+			" grow=%"PRIu64" shrink=%"PRIu64"\n",
+			lcore_id, cache->size, cache->stats.get_hit,
+			cache->stats.get_miss, cache->stats.put,
+			cache->stats.put_flush, cache->stats.grow,
+			cache->stats.shrink);
+#endif
 	}
 	fprintf(f, "    total_cache_count=%u\n", count);
 	return count;
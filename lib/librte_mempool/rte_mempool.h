@@ -78,6 +78,7 @@
 #include <rte_ring.h>
 #include <rte_memcpy.h>
 #include <rte_common.h>
+#include <rte_trace.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -87,6 +88,9 @@ extern "C" {
 #define RTE_MEMPOOL_HEADER_COOKIE2  0xf2eef2eedadd2e55ULL /**< Header cookie. */
 #define RTE_MEMPOOL_TRAILER_COOKIE  0xadd2e55badbadbadULL /**< Trailer cookie.*/
 
+RTE_TRACE_POINT_DECLARE(rte_mempool_trace_get);
+RTE_TRACE_POINT_DECLARE(rte_mempool_trace_put);
+
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
 /**
  * A structure that stores the mempool statistics (per-lcore).
@@ -101,6 +105,24 @@ struct rte_mempool_debug_stats {
 } __rte_cache_aligned;
 #endif
 
+/**
+ * A structure that stores the statistics of a per-core object cache.
+ */
+struct rte_mempool_cache_stats {
+	uint64_t get_hit;   /**< Gets served from the cache only. */
+	uint64_t get_miss;  /**< Gets that had to dequeue from the pool. */
+	uint64_t put;       /**< Puts done in the cache. */
+	uint64_t put_flush; /**< Puts that flushed objects to the pool. */
+	uint64_t grow;      /**< Number of adaptive cache size increases. */
+	uint64_t shrink;    /**< Number of adaptive cache size decreases. */
+};
+
+/**
+ * Number of get/put operations on a cache between two adjustments of
+ * its size, for mempools created with MEMPOOL_F_CACHE_ADAPTIVE.
+ */
+#define RTE_MEMPOOL_CACHE_ADAPT_PERIOD 1024
+
 /**
  * A structure that stores a per-core object cache.
  */
@@ -108,6 +130,18 @@ struct rte_mempool_cache {
 	uint32_t size;	      /**< Size of the cache */
 	uint32_t flushthresh; /**< Threshold before we flush excess elements */
 	uint32_t len;	      /**< Current cache count */
+	/**
+	 * Operations left before the cache size is adjusted, or 0 if the
+	 * cache size is fixed. See MEMPOOL_F_CACHE_ADAPTIVE.
+	 */
+	uint32_t adapt_left;
+	/** Accesses to the common pool since the last size adjustment. */
+	uint32_t adapt_misses;
+	uint32_t adapt_len_min; /**< Lowest len since the last adjustment. */
+	uint32_t adapt_len_max; /**< Highest len since the last adjustment. */
+#ifdef RTE_LIBRTE_MEMPOOL_CACHE_STATS
+	struct rte_mempool_cache_stats stats; /**< Cache statistics. */
+#endif
 	/*
 	 * Cache is allocated to this size to allow it to overflow in certain
 	 * cases to avoid needless emptying of cache.
@@ -265,6 +299,14 @@ struct rte_mempool {
 #define MEMPOOL_F_SC_GET         0x0008 /**< Default get is "single-consumer".*/
 #define MEMPOOL_F_POOL_CREATED   0x0010 /**< Internal: pool is created. */
 #define MEMPOOL_F_NO_PHYS_CONTIG 0x0020 /**< Don't need physically contiguous objs. */
+/**
+ * Adjust the size of the per-lcore default caches to their miss rate:
+ * a cache that often accesses the common pool grows (up to
+ * RTE_MEMPOOL_CACHE_MAX_SIZE), and a cache that rarely does shrinks
+ * (down to a quarter of the cache size given at creation), giving its
+ * excess objects back to the common pool.
+ */
+#define MEMPOOL_F_CACHE_ADAPTIVE 0x0040
 
 /**
  * @internal When debug is enabled, store some statistics.
@@ -288,6 +330,20 @@ struct rte_mempool {
 #define __MEMPOOL_STAT_ADD(mp, name, n) do {} while(0)
 #endif
 
+/**
+ * @internal Increment a statistics counter of a mempool cache.
+ *
+ * @param cache
+ *   Pointer to the mempool cache.
+ * @param name
+ *   Name of the statistics field to increment in the cache.
+ */
+#ifdef RTE_LIBRTE_MEMPOOL_CACHE_STATS
+#define __MEMPOOL_CACHE_STAT_INC(cache, name) ((cache)->stats.name++)
+#else
+#define __MEMPOOL_CACHE_STAT_INC(cache, name) do {} while (0)
+#endif
+
 /**
  * Calculate the size of the mempool header.
  *
@@ -1025,6 +1081,75 @@ rte_mempool_cache_flush(struct rte_mempool_cache *cache,
 	cache->len = 0;
 }
 
+/**
+ * @warning
+ * @b EXPERIMENTAL: this API may change without prior notice
+ *
+ * @internal Adjust the size of a mempool cache to its recent miss rate.
+ * Called every RTE_MEMPOOL_CACHE_ADAPT_PERIOD operations on the default
+ * caches of a mempool created with MEMPOOL_F_CACHE_ADAPTIVE.
+ *
+ * This function is not part of the public API: applications must not
+ * call it. It is only exported because the inline get and put functions
+ * call it from the application objects.
+ *
+ * @param mp
+ *   A pointer to the mempool.
+ * @param cache
+ *   A pointer to the mempool cache.
+ */
+void rte_mempool_cache_adapt(struct rte_mempool *mp,
+	struct rte_mempool_cache *cache);
+
+/**
+ * @internal Account an operation on an adaptive cache, and adjust the
+ * cache size at the end of the period.
+ */
+static inline void __attribute__((always_inline))
+__mempool_cache_adapt_check(struct rte_mempool *mp,
+	struct rte_mempool_cache *cache)
+{
+	if (likely(cache->adapt_left == 0))
+		return;
+
+	if (cache->len < cache->adapt_len_min)
+		cache->adapt_len_min = cache->len;
+	else if (cache->len > cache->adapt_len_max)
+		cache->adapt_len_max = cache->len;
+
+	if (unlikely(--cache->adapt_left == 0))
+		rte_mempool_cache_adapt(mp, cache);
+}
+
+/**
+ * Get the statistics of the default cache of a mempool.
+ *
+ * The statistics are only available when CONFIG_RTE_LIBRTE_MEMPOOL_CACHE_STATS
+ * is enabled.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param lcore_id
+ *   The lcore whose cache statistics are retrieved, or LCORE_ID_ANY to
+ *   get the sum of the statistics of all the lcores.
+ * @param stats
+ *   A pointer to a structure filled with the statistics.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: the mempool has no cache or lcore_id is invalid.
+ *   - -ENOTSUP: statistics are not compiled in.
+ */
+int rte_mempool_cache_stats_get(const struct rte_mempool *mp,
+	unsigned int lcore_id, struct rte_mempool_cache_stats *stats);
+
+/**
+ * Reset the statistics of all the default caches of a mempool.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ */
+void rte_mempool_cache_stats_reset(struct rte_mempool *mp);
+
 /**
  * Get a pointer to the per-lcore default mempool cache.
  *
@@ -1088,13 +1213,18 @@ __mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
 	rte_memcpy(&cache_objs[0], obj_table, sizeof(void *) * n);
 
 	cache->len += n;
+	__MEMPOOL_CACHE_STAT_INC(cache, put);
 
 	if (cache->len >= cache->flushthresh) {
 		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[cache->size],
 				cache->len - cache->size);
 		cache->len = cache->size;
+		cache->adapt_misses++;
+		__MEMPOOL_CACHE_STAT_INC(cache, put_flush);
 	}
 
+	__mempool_cache_adapt_check(mp, cache);
+
 	return;
 
 ring_enqueue:
@@ -1131,6 +1261,7 @@ rte_mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
 {
 	__mempool_check_cookies(mp, obj_table, n, 0);
 	__mempool_generic_put(mp, obj_table, n, cache);
+	RTE_TRACE_POINT_EMIT(rte_mempool_trace_put, (uintptr_t)mp, n);
 }
 
 /**
@@ -1199,10 +1330,18 @@ __mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 	uint32_t index, len;
 	void **cache_objs;
 
-	/* No cache provided or cannot be satisfied from cache */
-	if (unlikely(cache == NULL || n >= cache->size))
+	/* No cache provided */
+	if (unlikely(cache == NULL))
 		goto ring_dequeue;
 
+	/* Cannot be satisfied from cache */
+	if (unlikely(n >= cache->size)) {
+		cache->adapt_misses++;
+		__MEMPOOL_CACHE_STAT_INC(cache, get_miss);
+		__mempool_cache_adapt_check(mp, cache);
+		goto ring_dequeue;
+	}
+
 	cache_objs = cache->objs;
 
 	/* Can this be satisfied from the cache? */
@@ -1210,6 +1349,9 @@ __mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 		/* No. Backfill the cache first, and then fill from it */
 		uint32_t req = n + (cache->size - cache->len);
 
+		cache->adapt_misses++;
+		__MEMPOOL_CACHE_STAT_INC(cache, get_miss);
+
 		/* How many do we require i.e. number to fill the cache + the request */
 		ret = rte_mempool_ops_dequeue_bulk(mp,
 			&cache->objs[cache->len], req);
@@ -1224,6 +1366,8 @@ __mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 		}
 
 		cache->len += req;
+	} else {
+		__MEMPOOL_CACHE_STAT_INC(cache, get_hit);
 	}
 
 	/* Now fill in the response ... */
@@ -1232,6 +1376,8 @@ __mempool_generic_get(struct rte_mempool *mp, void **obj_table,
 
 	cache->len -= n;
 
+	__mempool_cache_adapt_check(mp, cache);
+
 	__MEMPOOL_STAT_ADD(mp, get_success, n);
 
 	return 0;
@@ -1280,6 +1426,8 @@ rte_mempool_generic_get(struct rte_mempool *mp, void **obj_table, unsigned n,
 	ret = __mempool_generic_get(mp, obj_table, n, cache);
 	if (ret == 0)
 		__mempool_check_cookies(mp, obj_table, n, 1);
+	RTE_TRACE_POINT_EMIT(rte_mempool_trace_get, (uintptr_t)mp, n,
+		(int64_t)ret);
 	return ret;
 }
 
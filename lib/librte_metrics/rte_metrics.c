@@ -31,19 +31,30 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <errno.h>
 #include <sys/queue.h>
 
 #include <rte_common.h>
 #include <rte_malloc.h>
 #include <rte_metrics.h>
 #include <rte_lcore.h>
+#include <rte_atomic.h>
 #include <rte_memzone.h>
 #include <rte_spinlock.h>
+#include <rte_seqlock.h>
+#include <rte_lcore_poll.h>
 
-#define RTE_METRICS_MAX_METRICS 256
 #define RTE_METRICS_MEMZONE_NAME "RTE_METRICS"
 
+/* index of the global values in the per-port arrays */
+#define RTE_METRICS_GLOBAL_IDX RTE_MAX_ETHPORTS
+
+/* number of poll metrics of each lcore */
+#define LCORE_POLL_METRICS 3
+
 /**
  * Internal stats metadata and value entry.
  *
@@ -52,14 +63,20 @@
 struct rte_metrics_meta_s {
 	/** Name of metric */
 	char name[RTE_METRICS_MAX_NAME_LEN];
-	/** Current value for metric */
-	uint64_t value[RTE_MAX_ETHPORTS];
-	/** Used for global metrics */
-	uint64_t global_value;
+	/** Current value for metric, per port then global */
+	uint64_t value[RTE_MAX_ETHPORTS + 1];
+	/**
+	 * Per port then global sequence lock of the set. Only used in
+	 * the first metric of a set: writers of the same set and port
+	 * are serialized, and readers retry when a write happened.
+	 */
+	rte_seqlock_t lock[RTE_MAX_ETHPORTS + 1];
 	/** Index of next root element (zero for none) */
 	uint16_t idx_next_set;
 	/** Index of next metric in set (zero for none) */
 	uint16_t idx_next_stat;
+	/** Index of the first metric of the set */
+	uint16_t idx_set_root;
 };
 
 /**
@@ -79,10 +96,43 @@ struct rte_metrics_data_s {
 	uint16_t cnt_stats;
 	/** Metric data memory block. */
 	struct rte_metrics_meta_s metadata[RTE_METRICS_MAX_METRICS];
-	/** Metric data access lock */
+	/**
+	 * Metric registration lock. The values are updated without
+	 * taking it, see the sequence locks of the sets.
+	 */
 	rte_spinlock_t lock;
 };
 
+/* key of the first lcore poll metric, negative if not registered */
+static int lcore_poll_key = -1;
+/* poll statistics of each enabled lcore at the previous update */
+static struct rte_lcore_poll_stats *lcore_poll_prev;
+
+/* convert a port id to an index in the value and lock arrays */
+static inline int
+metrics_port_idx(int port_id)
+{
+	if (port_id == RTE_METRICS_GLOBAL)
+		return RTE_METRICS_GLOBAL_IDX;
+	if (port_id < 0 || port_id >= RTE_MAX_ETHPORTS)
+		return -EINVAL;
+	return port_id;
+}
+
+/*
+ * Number of published metrics. The entries below it are never modified,
+ * except the idx_next_set of the last set, so they can be read without
+ * the registration lock.
+ */
+static inline uint16_t
+metrics_count(const struct rte_metrics_data_s *stats)
+{
+	uint16_t cnt_stats = stats->cnt_stats;
+
+	rte_smp_rmb();
+	return cnt_stats;
+}
+
 void
 rte_metrics_init(int socket_id)
 {
@@ -120,6 +170,7 @@ rte_metrics_reg_names(const char * const *names, uint16_t cnt_names)
 	const struct rte_memzone *memzone;
 	uint16_t idx_name;
 	uint16_t idx_base;
+	uint16_t idx_port;
 
 	/* Some sanity checks */
 	if (cnt_names < 1 || names == NULL)
@@ -130,11 +181,13 @@ rte_metrics_reg_names(const char * const *names, uint16_t cnt_names)
 		return -EIO;
 	stats = memzone->addr;
 
-	if (stats->cnt_stats + cnt_names >= RTE_METRICS_MAX_METRICS)
-		return -ENOMEM;
-
 	rte_spinlock_lock(&stats->lock);
 
+	if (stats->cnt_stats + cnt_names >= RTE_METRICS_MAX_METRICS) {
+		rte_spinlock_unlock(&stats->lock);
+		return -ENOMEM;
+	}
+
 	/* Overwritten later if this is actually first set.. */
 	stats->metadata[stats->idx_last_set].idx_next_set = stats->cnt_stats;
 
@@ -145,10 +198,16 @@ rte_metrics_reg_names(const char * const *names, uint16_t cnt_names)
 		strncpy(entry->name, names[idx_name],
 			RTE_METRICS_MAX_NAME_LEN);
 		memset(entry->value, 0, sizeof(entry->value));
+		for (idx_port = 0; idx_port <= RTE_MAX_ETHPORTS; idx_port++)
+			rte_seqlock_init(&entry->lock[idx_port]);
 		entry->idx_next_stat = idx_name + stats->cnt_stats + 1;
+		entry->idx_set_root = idx_base;
 	}
 	entry->idx_next_stat = 0;
 	entry->idx_next_set = 0;
+
+	/* publish the new entries to the lock-free readers and writers */
+	rte_smp_wmb();
 	stats->cnt_stats += cnt_names;
 
 	rte_spinlock_unlock(&stats->lock);
@@ -171,12 +230,15 @@ rte_metrics_update_values(int port_id,
 	struct rte_metrics_meta_s *entry;
 	struct rte_metrics_data_s *stats;
 	const struct rte_memzone *memzone;
+	rte_seqlock_t *set_lock;
 	uint16_t idx_metric;
 	uint16_t idx_value;
 	uint16_t cnt_setsize;
+	uint16_t cnt_stats;
+	int idx_port;
 
-	if (port_id != RTE_METRICS_GLOBAL &&
-			(port_id < 0 || port_id > RTE_MAX_ETHPORTS))
+	idx_port = metrics_port_idx(port_id);
+	if (idx_port < 0)
 		return -EINVAL;
 
 	if (values == NULL)
@@ -187,10 +249,13 @@ rte_metrics_update_values(int port_id,
 		return -EIO;
 	stats = memzone->addr;
 
-	rte_spinlock_lock(&stats->lock);
+	cnt_stats = metrics_count(stats);
+	if (key >= cnt_stats)
+		return -EINVAL;
+
 	idx_metric = key;
 	cnt_setsize = 1;
-	while (idx_metric < stats->cnt_stats) {
+	while (idx_metric < cnt_stats) {
 		entry = &stats->metadata[idx_metric];
 		if (entry->idx_next_stat == 0)
 			break;
@@ -198,24 +263,20 @@ rte_metrics_update_values(int port_id,
 		idx_metric++;
 	}
 	/* Check update does not cross set border */
-	if (count > cnt_setsize) {
-		rte_spinlock_unlock(&stats->lock);
+	if (count > cnt_setsize)
 		return -ERANGE;
+
+	/* Only the writers of the same set and port are serialized. */
+	set_lock = &stats->metadata[stats->metadata[key].idx_set_root].lock[
+		idx_port];
+	rte_seqlock_write_lock(set_lock);
+	for (idx_value = 0; idx_value < count; idx_value++) {
+		idx_metric = key + idx_value;
+		stats->metadata[idx_metric].value[idx_port] =
+			values[idx_value];
 	}
+	rte_seqlock_write_unlock(set_lock);
 
-	if (port_id == RTE_METRICS_GLOBAL)
-		for (idx_value = 0; idx_value < count; idx_value++) {
-			idx_metric = key + idx_value;
-			stats->metadata[idx_metric].global_value =
-				values[idx_value];
-		}
-	else
-		for (idx_value = 0; idx_value < count; idx_value++) {
-			idx_metric = key + idx_value;
-			stats->metadata[idx_metric].value[port_id] =
-				values[idx_value];
-		}
-	rte_spinlock_unlock(&stats->lock);
 	return 0;
 }
 
@@ -256,14 +317,17 @@ rte_metrics_get_values(int port_id,
 	struct rte_metric_value *values,
 	uint16_t capacity)
 {
-	struct rte_metrics_meta_s *entry;
 	struct rte_metrics_data_s *stats;
 	const struct rte_memzone *memzone;
+	const rte_seqlock_t *set_lock;
 	uint16_t idx_name;
-	int return_value;
+	uint16_t idx_root;
+	uint16_t cnt_stats;
+	uint32_t sn;
+	int idx_port;
 
-	if (port_id != RTE_METRICS_GLOBAL &&
-			(port_id < 0 || port_id > RTE_MAX_ETHPORTS))
+	idx_port = metrics_port_idx(port_id);
+	if (idx_port < 0)
 		return -EINVAL;
 
 	memzone = rte_memzone_lookup(RTE_METRICS_MEMZONE_NAME);
@@ -271,32 +335,118 @@ rte_metrics_get_values(int port_id,
 	if (memzone == NULL)
 		return 0;
 	stats = memzone->addr;
-	rte_spinlock_lock(&stats->lock);
 
-	if (values != NULL) {
-		if (capacity < stats->cnt_stats) {
-			return_value = stats->cnt_stats;
-			rte_spinlock_unlock(&stats->lock);
-			return return_value;
-		}
-		if (port_id == RTE_METRICS_GLOBAL)
-			for (idx_name = 0;
-					idx_name < stats->cnt_stats;
-					idx_name++) {
-				entry = &stats->metadata[idx_name];
-				values[idx_name].key = idx_name;
-				values[idx_name].value = entry->global_value;
-			}
-		else
-			for (idx_name = 0;
-					idx_name < stats->cnt_stats;
-					idx_name++) {
-				entry = &stats->metadata[idx_name];
+	cnt_stats = metrics_count(stats);
+	if (values == NULL || capacity < cnt_stats)
+		return cnt_stats;
+
+	/* Copy each set under its sequence lock, without blocking the
+	 * writers.
+	 */
+	for (idx_root = 0; idx_root < cnt_stats; idx_root = idx_name) {
+		set_lock = &stats->metadata[idx_root].lock[idx_port];
+		do {
+			sn = rte_seqlock_read_begin(set_lock);
+			idx_name = idx_root;
+			do {
 				values[idx_name].key = idx_name;
-				values[idx_name].value = entry->value[port_id];
-			}
+				values[idx_name].value =
+					stats->metadata[idx_name].value[
+						idx_port];
+			} while (stats->metadata[idx_name++].idx_next_stat
+				 != 0 && idx_name < cnt_stats);
+		} while (rte_seqlock_read_retry(set_lock, sn));
 	}
-	return_value = stats->cnt_stats;
-	rte_spinlock_unlock(&stats->lock);
-	return return_value;
+
+	return cnt_stats;
+}
+
+int
+rte_metrics_lcore_poll_reg(void)
+{
+	static const char * const suffixes[LCORE_POLL_METRICS] = {
+		"busy_cycles", "idle_cycles", "busy_percent",
+	};
+	struct rte_lcore_poll_stats stats;
+	char (*names)[RTE_METRICS_MAX_NAME_LEN];
+	const char **name_ptrs;
+	unsigned int lcore_id;
+	unsigned int cnt_names;
+	unsigned int i, n = 0;
+	int ret;
+
+	if (rte_lcore_poll_stats_get(rte_get_master_lcore(), &stats) ==
+			-ENOTSUP)
+		return -ENOTSUP;
+	if (lcore_poll_key >= 0)
+		return -EEXIST;
+
+	cnt_names = rte_lcore_count() * LCORE_POLL_METRICS;
+	names = malloc(cnt_names * sizeof(*names));
+	name_ptrs = malloc(cnt_names * sizeof(*name_ptrs));
+	lcore_poll_prev = calloc(rte_lcore_count(), sizeof(*lcore_poll_prev));
+	if (names == NULL || name_ptrs == NULL || lcore_poll_prev == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	RTE_LCORE_FOREACH(lcore_id) {
+		for (i = 0; i < LCORE_POLL_METRICS; i++, n++) {
+			snprintf(names[n], sizeof(names[n]), "lcore%u_%s",
+				lcore_id, suffixes[i]);
+			name_ptrs[n] = names[n];
+		}
+	}
+
+	ret = rte_metrics_reg_names(name_ptrs, cnt_names);
+	if (ret >= 0)
+		lcore_poll_key = ret;
+	else if (ret == -ENOMEM)
+		ret = -ENOSPC;
+
+out:
+	if (ret < 0) {
+		free(lcore_poll_prev);
+		lcore_poll_prev = NULL;
+	}
+	free(name_ptrs);
+	free(names);
+	return ret;
+}
+
+int
+rte_metrics_lcore_poll_update(void)
+{
+	struct rte_lcore_poll_stats stats, *prev;
+	uint64_t values[LCORE_POLL_METRICS];
+	uint64_t busy, idle;
+	unsigned int lcore_id;
+	unsigned int n = 0;
+	int ret;
+
+	if (lcore_poll_key < 0)
+		return -EINVAL;
+
+	RTE_LCORE_FOREACH(lcore_id) {
+		ret = rte_lcore_poll_stats_get(lcore_id, &stats);
+		if (ret < 0)
+			return ret;
+
+		prev = &lcore_poll_prev[n];
+		busy = stats.busy_cycles - prev->busy_cycles;
+		idle = stats.idle_cycles - prev->idle_cycles;
+		*prev = stats;
+
+		values[0] = stats.busy_cycles;
+		values[1] = stats.idle_cycles;
+		values[2] = busy + idle != 0 ? busy * 100 / (busy + idle) : 0;
+		ret = rte_metrics_update_values(RTE_METRICS_GLOBAL,
+			lcore_poll_key + n * LCORE_POLL_METRICS, values,
+			LCORE_POLL_METRICS);
+		if (ret < 0)
+			return ret;
+		n++;
+	}
+
+	return 0;
 }
@@ -61,6 +61,9 @@ extern "C" {
 /** Maximum length of metric name (including null-terminator) */
 #define RTE_METRICS_MAX_NAME_LEN 64
 
+/** Maximum number of metrics, shared by all the producers */
+#define RTE_METRICS_MAX_METRICS 256
+
 /**
  * Global metric special id.
  *
@@ -243,6 +246,43 @@ int rte_metrics_update_values(
 	const uint64_t *values,
 	uint32_t count);
 
+/**
+ * Register the poll statistics of the enabled lcores, see
+ * rte_lcore_poll.h, as global metrics. Each lcore has 3 metrics:
+ *
+ * - lcore<id>_busy_cycles: cycles following a poll with items;
+ * - lcore<id>_idle_cycles: cycles following an empty poll;
+ * - lcore<id>_busy_percent: busy ratio since the previous update.
+ *
+ * It must be called once, after rte_eal_init(), by the process which
+ * updates them with rte_metrics_lcore_poll_update().
+ *
+ * The metrics of all the lcores are registered at once, and count in the
+ * RTE_METRICS_MAX_METRICS metrics shared with the other producers: the
+ * registration fails with -ENOSPC beyond about 85 lcores, or fewer if
+ * other metrics are already registered.
+ *
+ * @return
+ *   - Zero or positive: success, the key of the first metric
+ *   - -ENOTSUP if the poll statistics are disabled at build time
+ *   - -EEXIST if already registered
+ *   - -ENOSPC if there is no room for the metrics of all the lcores
+ *   - Negative: other errors
+ */
+int rte_metrics_lcore_poll_reg(void);
+
+/**
+ * Update the lcore poll metrics registered by
+ * rte_metrics_lcore_poll_reg(). It should be called periodically, for
+ * instance once per second, by a single thread.
+ *
+ * @return
+ *   - Zero on success
+ *   - -EINVAL if the metrics are not registered
+ *   - Negative: other errors
+ */
+int rte_metrics_lcore_poll_update(void);
+
 #ifdef __cplusplus
 }
 #endif
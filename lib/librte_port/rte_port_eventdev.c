@@ -0,0 +1,568 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include <string.h>
+#include <stdint.h>
+
+#include <rte_mbuf.h>
+#include <rte_eventdev.h>
+#include <rte_malloc.h>
+
+#include "rte_port_eventdev.h"
+
+/*
+ * Port EVENTDEV Reader
+ */
+#ifdef RTE_PORT_STATS_COLLECT
+
+#define RTE_PORT_EVENTDEV_READER_STATS_PKTS_IN_ADD(port, val) \
+	port->stats.n_pkts_in += val
+#define RTE_PORT_EVENTDEV_READER_STATS_PKTS_DROP_ADD(port, val) \
+	port->stats.n_pkts_drop += val
+
+#else
+
+#define RTE_PORT_EVENTDEV_READER_STATS_PKTS_IN_ADD(port, val)
+#define RTE_PORT_EVENTDEV_READER_STATS_PKTS_DROP_ADD(port, val)
+
+#endif
+
+struct rte_port_eventdev_reader {
+	struct rte_port_in_stats stats;
+
+	uint8_t eventdev_id;
+	uint8_t port_id;
+};
+
+static void *
+rte_port_eventdev_reader_create(void *params, int socket_id)
+{
+	struct rte_port_eventdev_reader_params *conf =
+			params;
+	struct rte_port_eventdev_reader *port;
+
+	/* Check input parameters */
+	if (conf == NULL) {
+		RTE_LOG(ERR, PORT, "%s: params is NULL\n", __func__);
+		return NULL;
+	}
+
+	/* Memory allocation */
+	port = rte_zmalloc_socket("PORT", sizeof(*port),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (port == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Failed to allocate port\n", __func__);
+		return NULL;
+	}
+
+	/* Initialization */
+	port->eventdev_id = conf->eventdev_id;
+	port->port_id = conf->port_id;
+
+	return port;
+}
+
+static int
+rte_port_eventdev_reader_rx(void *port, struct rte_mbuf **pkts, uint32_t n_pkts)
+{
+	struct rte_port_eventdev_reader *p =
+		port;
+	struct rte_event ev[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint16_t rx_evts_cnt, i;
+
+	if (n_pkts > RTE_PORT_IN_BURST_SIZE_MAX)
+		n_pkts = RTE_PORT_IN_BURST_SIZE_MAX;
+
+	rx_evts_cnt = rte_event_dequeue_burst(p->eventdev_id, p->port_id,
+			ev, n_pkts, 0);
+
+	for (i = 0; i < rx_evts_cnt; i++)
+		pkts[i] = ev[i].mbuf;
+
+	RTE_PORT_EVENTDEV_READER_STATS_PKTS_IN_ADD(p, rx_evts_cnt);
+
+	return rx_evts_cnt;
+}
+
+static int
+rte_port_eventdev_reader_free(void *port)
+{
+	if (port == NULL) {
+		RTE_LOG(ERR, PORT, "%s: port is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	rte_free(port);
+
+	return 0;
+}
+
+static int rte_port_eventdev_reader_stats_read(void *port,
+		struct rte_port_in_stats *stats, int clear)
+{
+	struct rte_port_eventdev_reader *p =
+			port;
+
+	if (stats != NULL)
+		memcpy(stats, &p->stats, sizeof(p->stats));
+
+	if (clear)
+		memset(&p->stats, 0, sizeof(p->stats));
+
+	return 0;
+}
+
+/*
+ * Port EVENTDEV Writer
+ */
+#ifdef RTE_PORT_STATS_COLLECT
+
+#define RTE_PORT_EVENTDEV_WRITER_STATS_PKTS_IN_ADD(port, val) \
+	port->stats.n_pkts_in += val
+#define RTE_PORT_EVENTDEV_WRITER_STATS_PKTS_DROP_ADD(port, val) \
+	port->stats.n_pkts_drop += val
+
+#else
+
+#define RTE_PORT_EVENTDEV_WRITER_STATS_PKTS_IN_ADD(port, val)
+#define RTE_PORT_EVENTDEV_WRITER_STATS_PKTS_DROP_ADD(port, val)
+
+#endif
+
+struct rte_port_eventdev_writer {
+	struct rte_port_out_stats stats;
+
+	/* events pre-filled at creation, only mbuf and flow_id are set */
+	struct rte_event ev[2 * RTE_PORT_IN_BURST_SIZE_MAX];
+	uint32_t enq_burst_sz;
+	uint32_t enq_buf_count;
+	uint32_t flow_id;
+	uint8_t flow_id_rss;
+	uint8_t eventdev_id;
+	uint8_t port_id;
+};
+
+/* Check the parameters shared by the writer and writer_nodrop ports. */
+static int
+eventdev_writer_check_params(uint8_t sched_type, uint8_t evt_op,
+		uint32_t enq_burst_sz)
+{
+	if ((enq_burst_sz == 0) ||
+		(enq_burst_sz > RTE_PORT_IN_BURST_SIZE_MAX) ||
+		(sched_type > RTE_SCHED_TYPE_PARALLEL) ||
+		((evt_op != RTE_EVENT_OP_NEW) &&
+		 (evt_op != RTE_EVENT_OP_FORWARD)))
+		return -EINVAL;
+
+	return 0;
+}
+
+static void
+eventdev_writer_init_events(struct rte_event *ev, uint32_t n_ev,
+		uint8_t queue_id, uint8_t sched_type, uint8_t evt_op)
+{
+	uint32_t i;
+
+	for (i = 0; i < n_ev; i++) {
+		ev[i].event = 0;
+		ev[i].queue_id = queue_id;
+		ev[i].sched_type = sched_type;
+		ev[i].op = evt_op;
+		ev[i].event_type = RTE_EVENT_TYPE_CPU;
+		ev[i].priority = RTE_EVENT_DEV_PRIORITY_NORMAL;
+	}
+}
+
+static void *
+rte_port_eventdev_writer_create(void *params, int socket_id)
+{
+	struct rte_port_eventdev_writer_params *conf =
+			params;
+	struct rte_port_eventdev_writer *port;
+
+	/* Check input parameters */
+	if ((conf == NULL) ||
+		eventdev_writer_check_params(conf->sched_type, conf->evt_op,
+			conf->enq_burst_sz)) {
+		RTE_LOG(ERR, PORT, "%s: Invalid input parameters\n", __func__);
+		return NULL;
+	}
+
+	/* Memory allocation */
+	port = rte_zmalloc_socket("PORT", sizeof(*port),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (port == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Failed to allocate port\n", __func__);
+		return NULL;
+	}
+
+	/* Initialization */
+	port->eventdev_id = conf->eventdev_id;
+	port->port_id = conf->port_id;
+	port->enq_burst_sz = conf->enq_burst_sz;
+	port->enq_buf_count = 0;
+	port->flow_id = conf->flow_id;
+	port->flow_id_rss = conf->flow_id_rss;
+	eventdev_writer_init_events(port->ev, RTE_DIM(port->ev),
+			conf->queue_id, conf->sched_type, conf->evt_op);
+
+	return port;
+}
+
+static inline void
+send_burst(struct rte_port_eventdev_writer *p)
+{
+	uint32_t nb_enq = 0, n;
+
+	/* the event port may accept a burst in several parts */
+	do {
+		n = rte_event_enqueue_burst(p->eventdev_id, p->port_id,
+				p->ev + nb_enq, p->enq_buf_count - nb_enq);
+		nb_enq += n;
+	} while (n != 0 && nb_enq < p->enq_buf_count);
+
+	RTE_PORT_EVENTDEV_WRITER_STATS_PKTS_DROP_ADD(p,
+			p->enq_buf_count - nb_enq);
+	for ( ; nb_enq < p->enq_buf_count; nb_enq++)
+		rte_pktmbuf_free(p->ev[nb_enq].mbuf);
+
+	p->enq_buf_count = 0;
+}
+
+static inline void
+eventdev_writer_buffer(struct rte_event *ev, struct rte_mbuf *pkt,
+		uint8_t flow_id_rss, uint32_t flow_id)
+{
+	ev->mbuf = pkt;
+	ev->flow_id = flow_id_rss ? pkt->hash.rss : flow_id;
+}
+
+static int
+rte_port_eventdev_writer_tx(void *port, struct rte_mbuf *pkt)
+{
+	struct rte_port_eventdev_writer *p =
+		port;
+
+	eventdev_writer_buffer(&p->ev[p->enq_buf_count++], pkt,
+			p->flow_id_rss, p->flow_id);
+	RTE_PORT_EVENTDEV_WRITER_STATS_PKTS_IN_ADD(p, 1);
+	if (p->enq_buf_count >= p->enq_burst_sz)
+		send_burst(p);
+
+	return 0;
+}
+
+static int
+rte_port_eventdev_writer_tx_bulk(void *port,
+		struct rte_mbuf **pkts,
+		uint64_t pkts_mask)
+{
+	struct rte_port_eventdev_writer *p =
+		port;
+	uint32_t enq_buf_count = p->enq_buf_count;
+
+	for ( ; pkts_mask; ) {
+		uint32_t pkt_index = __builtin_ctzll(pkts_mask);
+		uint64_t pkt_mask = 1LLU << pkt_index;
+
+		eventdev_writer_buffer(&p->ev[enq_buf_count++],
+				pkts[pkt_index], p->flow_id_rss, p->flow_id);
+		RTE_PORT_EVENTDEV_WRITER_STATS_PKTS_IN_ADD(p, 1);
+		pkts_mask &= ~pkt_mask;
+	}
+
+	p->enq_buf_count = enq_buf_count;
+	if (enq_buf_count >= p->enq_burst_sz)
+		send_burst(p);
+
+	return 0;
+}
+
+static int
+rte_port_eventdev_writer_flush(void *port)
+{
+	struct rte_port_eventdev_writer *p =
+		port;
+
+	if (p->enq_buf_count > 0)
+		send_burst(p);
+
+	return 0;
+}
+
+static int
+rte_port_eventdev_writer_free(void *port)
+{
+	if (port == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Port is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	rte_port_eventdev_writer_flush(port);
+	rte_free(port);
+
+	return 0;
+}
+
+static int rte_port_eventdev_writer_stats_read(void *port,
+		struct rte_port_out_stats *stats, int clear)
+{
+	struct rte_port_eventdev_writer *p =
+		port;
+
+	if (stats != NULL)
+		memcpy(stats, &p->stats, sizeof(p->stats));
+
+	if (clear)
+		memset(&p->stats, 0, sizeof(p->stats));
+
+	return 0;
+}
+
+/*
+ * Port EVENTDEV Writer Nodrop
+ */
+#ifdef RTE_PORT_STATS_COLLECT
+
+#define RTE_PORT_EVENTDEV_WRITER_NODROP_STATS_PKTS_IN_ADD(port, val) \
+	port->stats.n_pkts_in += val
+#define RTE_PORT_EVENTDEV_WRITER_NODROP_STATS_PKTS_DROP_ADD(port, val) \
+	port->stats.n_pkts_drop += val
+
+#else
+
+#define RTE_PORT_EVENTDEV_WRITER_NODROP_STATS_PKTS_IN_ADD(port, val)
+#define RTE_PORT_EVENTDEV_WRITER_NODROP_STATS_PKTS_DROP_ADD(port, val)
+
+#endif
+
+struct rte_port_eventdev_writer_nodrop {
+	struct rte_port_out_stats stats;
+
+	/* events pre-filled at creation, only mbuf and flow_id are set */
+	struct rte_event ev[2 * RTE_PORT_IN_BURST_SIZE_MAX];
+	uint32_t enq_burst_sz;
+	uint32_t enq_buf_count;
+	uint64_t n_retries;
+	uint32_t flow_id;
+	uint8_t flow_id_rss;
+	uint8_t eventdev_id;
+	uint8_t port_id;
+};
+
+static void *
+rte_port_eventdev_writer_nodrop_create(void *params, int socket_id)
+{
+	struct rte_port_eventdev_writer_nodrop_params *conf =
+			params;
+	struct rte_port_eventdev_writer_nodrop *port;
+
+	/* Check input parameters */
+	if ((conf == NULL) ||
+		eventdev_writer_check_params(conf->sched_type, conf->evt_op,
+			conf->enq_burst_sz)) {
+		RTE_LOG(ERR, PORT, "%s: Invalid input parameters\n", __func__);
+		return NULL;
+	}
+
+	/* Memory allocation */
+	port = rte_zmalloc_socket("PORT", sizeof(*port),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (port == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Failed to allocate port\n", __func__);
+		return NULL;
+	}
+
+	/* Initialization */
+	port->eventdev_id = conf->eventdev_id;
+	port->port_id = conf->port_id;
+	port->enq_burst_sz = conf->enq_burst_sz;
+	port->enq_buf_count = 0;
+	port->flow_id = conf->flow_id;
+	port->flow_id_rss = conf->flow_id_rss;
+	eventdev_writer_init_events(port->ev, RTE_DIM(port->ev),
+			conf->queue_id, conf->sched_type, conf->evt_op);
+
+	/*
+	 * When n_retries is 0 it means that we should wait for every packet to
+	 * send no matter how many retries should it take. To limit number of
+	 * branches in fast path, we use UINT64_MAX instead of branching.
+	 */
+	port->n_retries = (conf->n_retries == 0) ? UINT64_MAX : conf->n_retries;
+
+	return port;
+}
+
+static inline void
+send_burst_nodrop(struct rte_port_eventdev_writer_nodrop *p)
+{
+	uint32_t nb_enq = 0;
+	uint64_t i;
+
+	nb_enq = rte_event_enqueue_burst(p->eventdev_id, p->port_id,
+			p->ev, p->enq_buf_count);
+
+	/* We sent all the packets in a first try */
+	if (nb_enq >= p->enq_buf_count) {
+		p->enq_buf_count = 0;
+		return;
+	}
+
+	for (i = 0; i < p->n_retries; i++) {
+		nb_enq += rte_event_enqueue_burst(p->eventdev_id, p->port_id,
+				p->ev + nb_enq, p->enq_buf_count - nb_enq);
+
+		/* We sent all the packets in more than one try */
+		if (nb_enq >= p->enq_buf_count) {
+			p->enq_buf_count = 0;
+			return;
+		}
+	}
+
+	/* We didn't send the packets in maximum allowed attempts */
+	RTE_PORT_EVENTDEV_WRITER_NODROP_STATS_PKTS_DROP_ADD(p,
+			p->enq_buf_count - nb_enq);
+	for ( ; nb_enq < p->enq_buf_count; nb_enq++)
+		rte_pktmbuf_free(p->ev[nb_enq].mbuf);
+
+	p->enq_buf_count = 0;
+}
+
+static int
+rte_port_eventdev_writer_nodrop_tx(void *port, struct rte_mbuf *pkt)
+{
+	struct rte_port_eventdev_writer_nodrop *p =
+		port;
+
+	eventdev_writer_buffer(&p->ev[p->enq_buf_count++], pkt,
+			p->flow_id_rss, p->flow_id);
+	RTE_PORT_EVENTDEV_WRITER_NODROP_STATS_PKTS_IN_ADD(p, 1);
+	if (p->enq_buf_count >= p->enq_burst_sz)
+		send_burst_nodrop(p);
+
+	return 0;
+}
+
+static int
+rte_port_eventdev_writer_nodrop_tx_bulk(void *port,
+		struct rte_mbuf **pkts,
+		uint64_t pkts_mask)
+{
+	struct rte_port_eventdev_writer_nodrop *p =
+		port;
+	uint32_t enq_buf_count = p->enq_buf_count;
+
+	for ( ; pkts_mask; ) {
+		uint32_t pkt_index = __builtin_ctzll(pkts_mask);
+		uint64_t pkt_mask = 1LLU << pkt_index;
+
+		eventdev_writer_buffer(&p->ev[enq_buf_count++],
+				pkts[pkt_index], p->flow_id_rss, p->flow_id);
+		RTE_PORT_EVENTDEV_WRITER_NODROP_STATS_PKTS_IN_ADD(p, 1);
+		pkts_mask &= ~pkt_mask;
+	}
+
+	p->enq_buf_count = enq_buf_count;
+	if (enq_buf_count >= p->enq_burst_sz)
+		send_burst_nodrop(p);
+
+	return 0;
+}
+
+static int
+rte_port_eventdev_writer_nodrop_flush(void *port)
+{
+	struct rte_port_eventdev_writer_nodrop *p =
+		port;
+
+	if (p->enq_buf_count > 0)
+		send_burst_nodrop(p);
+
+	return 0;
+}
+
+static int
+rte_port_eventdev_writer_nodrop_free(void *port)
+{
+	if (port == NULL) {
+		RTE_LOG(ERR, PORT, "%s: Port is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	rte_port_eventdev_writer_nodrop_flush(port);
+	rte_free(port);
+
+	return 0;
+}
+
+static int rte_port_eventdev_writer_nodrop_stats_read(void *port,
+		struct rte_port_out_stats *stats, int clear)
+{
+	struct rte_port_eventdev_writer_nodrop *p =
+		port;
+
+	if (stats != NULL)
+		memcpy(stats, &p->stats, sizeof(p->stats));
+
+	if (clear)
+		memset(&p->stats, 0, sizeof(p->stats));
+
+	return 0;
+}
+
+/*
+ * Summary of port operations
+ */
+struct rte_port_in_ops rte_port_eventdev_reader_ops = {
+	.f_create = rte_port_eventdev_reader_create,
+	.f_free = rte_port_eventdev_reader_free,
+	.f_rx = rte_port_eventdev_reader_rx,
+	.f_stats = rte_port_eventdev_reader_stats_read,
+};
+
+struct rte_port_out_ops rte_port_eventdev_writer_ops = {
+	.f_create = rte_port_eventdev_writer_create,
+	.f_free = rte_port_eventdev_writer_free,
+	.f_tx = rte_port_eventdev_writer_tx,
+	.f_tx_bulk = rte_port_eventdev_writer_tx_bulk,
+	.f_flush = rte_port_eventdev_writer_flush,
+	.f_stats = rte_port_eventdev_writer_stats_read,
+};
+
+struct rte_port_out_ops rte_port_eventdev_writer_nodrop_ops = {
+	.f_create = rte_port_eventdev_writer_nodrop_create,
+	.f_free = rte_port_eventdev_writer_nodrop_free,
+	.f_tx = rte_port_eventdev_writer_nodrop_tx,
+	.f_tx_bulk = rte_port_eventdev_writer_nodrop_tx_bulk,
+	.f_flush = rte_port_eventdev_writer_nodrop_flush,
+	.f_stats = rte_port_eventdev_writer_nodrop_stats_read,
+};
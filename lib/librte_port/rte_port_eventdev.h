@@ -0,0 +1,143 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __INCLUDE_RTE_PORT_EVENTDEV_H__
+#define __INCLUDE_RTE_PORT_EVENTDEV_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * RTE Port Event Device
+ *
+ * eventdev_reader: input port built on top of pre-initialized event port,
+ * dequeuing events carrying one packet each
+ * eventdev_writer: output port built on top of pre-initialized event port,
+ * enqueuing each packet as an event to a configured event queue
+ *
+ ***/
+
+#include <stdint.h>
+
+#include <rte_eventdev.h>
+
+#include "rte_port.h"
+
+/** eventdev_reader port parameters */
+struct rte_port_eventdev_reader_params {
+	/** Event device ID */
+	uint8_t eventdev_id;
+
+	/** Event port ID */
+	uint8_t port_id;
+};
+
+/** eventdev_reader port operations */
+extern struct rte_port_in_ops rte_port_eventdev_reader_ops;
+
+/** eventdev_writer port parameters */
+struct rte_port_eventdev_writer_params {
+	/** Event device ID */
+	uint8_t eventdev_id;
+
+	/** Event port ID */
+	uint8_t port_id;
+
+	/** Destination event queue ID */
+	uint8_t queue_id;
+
+	/** Scheduling type of the events (RTE_SCHED_TYPE_*) */
+	uint8_t sched_type;
+
+	/** Operation of the events: RTE_EVENT_OP_NEW, or RTE_EVENT_OP_FORWARD
+	when the packets were read from the same event port. In the latter
+	case, the port must be flushed before it is read again. */
+	uint8_t evt_op;
+
+	/** When non-zero, the flow ID of each event is the RSS hash of its
+	packet (mbuf hash.rss), otherwise it is flow_id. */
+	uint8_t flow_id_rss;
+
+	/** Flow ID of the events */
+	uint32_t flow_id;
+
+	/** Recommended burst size to event port. The actual burst size can
+	be bigger or smaller than this value. */
+	uint32_t enq_burst_sz;
+};
+
+/** eventdev_writer port operations */
+extern struct rte_port_out_ops rte_port_eventdev_writer_ops;
+
+/** eventdev_writer_nodrop port parameters */
+struct rte_port_eventdev_writer_nodrop_params {
+	/** Event device ID */
+	uint8_t eventdev_id;
+
+	/** Event port ID */
+	uint8_t port_id;
+
+	/** Destination event queue ID */
+	uint8_t queue_id;
+
+	/** Scheduling type of the events (RTE_SCHED_TYPE_*) */
+	uint8_t sched_type;
+
+	/** Operation of the events, see rte_port_eventdev_writer_params */
+	uint8_t evt_op;
+
+	/** When non-zero, the flow ID of each event is the RSS hash of its
+	packet (mbuf hash.rss), otherwise it is flow_id. */
+	uint8_t flow_id_rss;
+
+	/** Flow ID of the events */
+	uint32_t flow_id;
+
+	/** Recommended burst size to event port. The actual burst size can
+	be bigger or smaller than this value. */
+	uint32_t enq_burst_sz;
+
+	/** Maximum number of retries, 0 for no limit */
+	uint32_t n_retries;
+};
+
+/** eventdev_writer_nodrop port operations */
+extern struct rte_port_out_ops rte_port_eventdev_writer_nodrop_ops;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
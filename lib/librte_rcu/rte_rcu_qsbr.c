@@ -0,0 +1,345 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Arm Limited
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Arm Limited nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_eal.h>
+#include <rte_errno.h>
+#include <rte_malloc.h>
+#include <rte_atomic.h>
+#include <rte_spinlock.h>
+
+#include "rte_rcu_qsbr.h"
+
+static int rcu_log_type;
+
+#define RCU_LOG(level, fmt, args...) \
+	rte_log(RTE_LOG_ ## level, rcu_log_type, "%s(): " fmt "\n", \
+		__func__, ## args)
+
+/* an element waiting for the end of its grace period */
+struct rcu_qsbr_dq_elem {
+	uint64_t token;
+	void *e;
+};
+
+struct rte_rcu_qsbr_dq {
+	char name[RTE_RCU_QSBR_DQ_NAMESIZE];
+	struct rte_rcu_qsbr *v;
+	rte_rcu_qsbr_free_resource_t free_fn;
+	void *p;
+	uint32_t size;  /* number of slots, power of 2 */
+	uint32_t mask;
+	uint32_t capacity; /* maximum number of elements */
+	uint32_t trigger_reclaim_limit;
+	uint32_t max_reclaim_size;
+	rte_spinlock_t lock; /* serializes the writers */
+	uint32_t head;  /* next slot to fill */
+	uint32_t tail;  /* oldest element */
+	struct rcu_qsbr_dq_elem elems[0] __rte_cache_aligned;
+};
+
+size_t
+rte_rcu_qsbr_get_memsize(uint32_t max_threads)
+{
+	if (max_threads == 0)
+		return 0;
+
+	return sizeof(struct rte_rcu_qsbr) +
+		sizeof(struct rte_rcu_qsbr_cnt) * max_threads +
+		__RTE_QSBR_THRID_ARRAY_SIZE(max_threads);
+}
+
+int
+rte_rcu_qsbr_init(struct rte_rcu_qsbr *v, uint32_t max_threads)
+{
+	if (v == NULL || max_threads == 0) {
+		RCU_LOG(ERR, "Invalid input parameter");
+		return -EINVAL;
+	}
+
+	memset(v, 0, rte_rcu_qsbr_get_memsize(max_threads));
+	v->max_threads = max_threads;
+	v->num_elems = RTE_ALIGN_CEIL(max_threads,
+		__RTE_QSBR_THRID_ARRAY_ELM_SIZE) /
+		__RTE_QSBR_THRID_ARRAY_ELM_SIZE;
+	rte_atomic64_set(&v->token, RTE_QSBR_CNT_INIT);
+	v->acked_token = RTE_QSBR_CNT_INIT - 1;
+	rte_atomic32_init(&v->num_threads);
+
+	return 0;
+}
+
+int
+rte_rcu_qsbr_thread_register(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	volatile uint64_t *elm;
+	uint64_t mask, old;
+
+	if (v == NULL || thread_id >= v->max_threads) {
+		RCU_LOG(ERR, "Invalid input parameter");
+		return -EINVAL;
+	}
+
+	elm = __RTE_QSBR_THRID_ARRAY_ELM(v,
+		thread_id >> __RTE_QSBR_THRID_INDEX_SHIFT);
+	mask = 1ULL << (thread_id & __RTE_QSBR_THRID_MASK);
+
+	do {
+		old = *elm;
+		/* already registered */
+		if (old & mask)
+			return 0;
+	} while (rte_atomic64_cmpset(elm, old, old | mask) == 0);
+
+	rte_atomic32_inc(&v->num_threads);
+	return 0;
+}
+
+int
+rte_rcu_qsbr_thread_unregister(struct rte_rcu_qsbr *v,
+		unsigned int thread_id)
+{
+	volatile uint64_t *elm;
+	uint64_t mask, old;
+
+	if (v == NULL || thread_id >= v->max_threads) {
+		RCU_LOG(ERR, "Invalid input parameter");
+		return -EINVAL;
+	}
+
+	elm = __RTE_QSBR_THRID_ARRAY_ELM(v,
+		thread_id >> __RTE_QSBR_THRID_INDEX_SHIFT);
+	mask = 1ULL << (thread_id & __RTE_QSBR_THRID_MASK);
+
+	do {
+		old = *elm;
+		/* not registered */
+		if (!(old & mask))
+			return 0;
+	} while (rte_atomic64_cmpset(elm, old, old & ~mask) == 0);
+
+	rte_atomic32_dec(&v->num_threads);
+	return 0;
+}
+
+void
+rte_rcu_qsbr_synchronize(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	uint64_t t;
+
+	RTE_ASSERT(v != NULL);
+
+	t = rte_rcu_qsbr_start(v);
+
+	/* the caller cannot wait for itself */
+	if (thread_id != RTE_QSBR_THRID_INVALID)
+		rte_rcu_qsbr_quiescent(v, thread_id);
+
+	rte_rcu_qsbr_check(v, t, 1);
+}
+
+int
+rte_rcu_qsbr_dump(FILE *f, struct rte_rcu_qsbr *v)
+{
+	uint64_t bmap;
+	uint32_t i, j;
+
+	if (f == NULL || v == NULL) {
+		RCU_LOG(ERR, "Invalid input parameter");
+		return -EINVAL;
+	}
+
+	fprintf(f, "\nQuiescent State Variable @%p\n", v);
+	fprintf(f, "  QS variable memory size = %zu\n",
+		rte_rcu_qsbr_get_memsize(v->max_threads));
+	fprintf(f, "  Given # max threads = %u\n", v->max_threads);
+	fprintf(f, "  Current # threads = %d\n",
+		rte_atomic32_read(&v->num_threads));
+	fprintf(f, "  Token = %"PRIu64"\n", rte_atomic64_read(&v->token));
+	fprintf(f, "  Least Acknowledged Token = %"PRIu64"\n",
+		v->acked_token);
+
+	fprintf(f, "Quiescent State Counts for readers:\n");
+	for (i = 0; i < v->num_elems; i++) {
+		bmap = *__RTE_QSBR_THRID_ARRAY_ELM(v, i);
+		while (bmap) {
+			j = __builtin_ctzll(bmap);
+			fprintf(f, "  thread ID = %u, count = %"PRIu64"\n",
+				(i << __RTE_QSBR_THRID_INDEX_SHIFT) + j,
+				v->qsbr_cnt[(i << __RTE_QSBR_THRID_INDEX_SHIFT)
+					+ j].cnt);
+			bmap &= ~(1ULL << j);
+		}
+	}
+
+	return 0;
+}
+
+struct rte_rcu_qsbr_dq *
+rte_rcu_qsbr_dq_create(const struct rte_rcu_qsbr_dq_parameters *params)
+{
+	struct rte_rcu_qsbr_dq *dq;
+	uint32_t size;
+
+	if (params == NULL || params->name == NULL || params->v == NULL ||
+			params->free_fn == NULL || params->size == 0 ||
+			params->trigger_reclaim_limit > params->size ||
+			params->max_reclaim_size == 0) {
+		RCU_LOG(ERR, "Invalid input parameter");
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	size = rte_align32pow2(params->size);
+	dq = rte_zmalloc_socket(params->name, sizeof(*dq) +
+		size * sizeof(dq->elems[0]), RTE_CACHE_LINE_SIZE,
+		params->socket_id);
+	if (dq == NULL) {
+		RCU_LOG(ERR, "Cannot allocate deferred queue %s",
+			params->name);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	snprintf(dq->name, sizeof(dq->name), "%s", params->name);
+	dq->v = params->v;
+	dq->free_fn = params->free_fn;
+	dq->p = params->p;
+	dq->size = size;
+	dq->mask = size - 1;
+	dq->capacity = params->size;
+	dq->trigger_reclaim_limit = params->trigger_reclaim_limit;
+	dq->max_reclaim_size = params->max_reclaim_size;
+	rte_spinlock_init(&dq->lock);
+
+	return dq;
+}
+
+/* free up to n elements, the lock is held */
+static unsigned int
+rcu_qsbr_dq_reclaim(struct rte_rcu_qsbr_dq *dq, unsigned int n, int wait)
+{
+	struct rcu_qsbr_dq_elem *elem;
+	unsigned int cnt = 0;
+
+	while (cnt < n && dq->tail != dq->head) {
+		elem = &dq->elems[dq->tail & dq->mask];
+		/* the elements are queued in token order */
+		if (rte_rcu_qsbr_check(dq->v, elem->token, wait) == 0)
+			break;
+		dq->free_fn(dq->p, elem->e);
+		dq->tail++;
+		cnt++;
+	}
+
+	return cnt;
+}
+
+int
+rte_rcu_qsbr_dq_enqueue(struct rte_rcu_qsbr_dq *dq, void *e)
+{
+	struct rcu_qsbr_dq_elem *elem;
+	uint32_t count;
+
+	if (dq == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&dq->lock);
+
+	count = dq->head - dq->tail;
+	if ((dq->trigger_reclaim_limit != 0 &&
+			count >= dq->trigger_reclaim_limit) ||
+			count >= dq->capacity)
+		rcu_qsbr_dq_reclaim(dq, dq->max_reclaim_size, 0);
+
+	if (dq->head - dq->tail >= dq->capacity) {
+		rte_spinlock_unlock(&dq->lock);
+		return -ENOSPC;
+	}
+
+	elem = &dq->elems[dq->head & dq->mask];
+	elem->token = rte_rcu_qsbr_start(dq->v);
+	elem->e = e;
+	dq->head++;
+
+	rte_spinlock_unlock(&dq->lock);
+	return 0;
+}
+
+int
+rte_rcu_qsbr_dq_reclaim(struct rte_rcu_qsbr_dq *dq, unsigned int n,
+		unsigned int *freed, unsigned int *pending)
+{
+	unsigned int cnt;
+
+	if (dq == NULL || n == 0)
+		return -EINVAL;
+
+	rte_spinlock_lock(&dq->lock);
+	cnt = rcu_qsbr_dq_reclaim(dq, n, 0);
+	if (pending != NULL)
+		*pending = dq->head - dq->tail;
+	rte_spinlock_unlock(&dq->lock);
+
+	if (freed != NULL)
+		*freed = cnt;
+
+	return 0;
+}
+
+void
+rte_rcu_qsbr_dq_delete(struct rte_rcu_qsbr_dq *dq)
+{
+	if (dq == NULL)
+		return;
+
+	rte_spinlock_lock(&dq->lock);
+	rcu_qsbr_dq_reclaim(dq, UINT32_MAX, 1);
+	rte_spinlock_unlock(&dq->lock);
+
+	rte_free(dq);
+}
+
+RTE_INIT(rte_rcu_register_logtype);
+static void
+rte_rcu_register_logtype(void)
+{
+	rcu_log_type = rte_log_register("lib.rcu");
+}
@@ -0,0 +1,464 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Arm Limited
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Arm Limited nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_RCU_QSBR_H_
+#define _RTE_RCU_QSBR_H_
+
+/**
+ * @file
+ *
+ * RTE Quiescent State Based Reclamation (QSBR)
+ *
+ * A lock-free data structure shared by reader and writer threads cannot
+ * free an element as soon as it is removed, since readers may still
+ * hold a reference to it. QSBR tells the writer when it is safe.
+ *
+ * A quiescent state is a point in the execution of a reader thread
+ * where it holds no reference to the shared data structure, typically
+ * the end of an iteration of its polling loop. The reader reports it
+ * with rte_rcu_qsbr_quiescent(), which is a load and a store on a cache
+ * line private to the thread.
+ *
+ * After removing an element, the writer gets a token with
+ * rte_rcu_qsbr_start(). Once rte_rcu_qsbr_check() returns 1 for this
+ * token, every registered reader has gone through a quiescent state (or
+ * is offline), and the element can be freed. rte_rcu_qsbr_synchronize()
+ * does both and blocks. The deferred queue helpers (rte_rcu_qsbr_dq_*)
+ * store the removed elements with their token and free them once
+ * reclaimable, so that the writer never blocks.
+ *
+ * The readers register with rte_rcu_qsbr_thread_register() and must be
+ * online (rte_rcu_qsbr_thread_online()) to access the shared data.
+ * A reader which blocks, for instance in a system call, should go
+ * offline so that the writers do not wait for it.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_atomic.h>
+#include <rte_debug.h>
+#include <rte_branch_prediction.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Thread id meaning "not a reader", see rte_rcu_qsbr_synchronize(). */
+#define RTE_QSBR_THRID_INVALID 0xffffffff
+
+/** Counter of an offline thread. */
+#define RTE_QSBR_CNT_THR_OFFLINE 0
+/** Initial value of the token. */
+#define RTE_QSBR_CNT_INIT 1
+
+/* the registered thread ids are stored in a bitmap of 64-bit words */
+#define __RTE_QSBR_THRID_ARRAY_ELM_SIZE (sizeof(uint64_t) * 8)
+#define __RTE_QSBR_THRID_ARRAY_SIZE(max_threads) \
+	RTE_ALIGN(RTE_ALIGN_CEIL(max_threads, \
+		__RTE_QSBR_THRID_ARRAY_ELM_SIZE) >> 3, RTE_CACHE_LINE_SIZE)
+#define __RTE_QSBR_THRID_ARRAY_ELM(v, i) \
+	((uint64_t *)&(v)->qsbr_cnt[(v)->max_threads] + (i))
+#define __RTE_QSBR_THRID_INDEX_SHIFT 6
+#define __RTE_QSBR_THRID_MASK 0x3f
+
+/**
+ * Quiescent state counter of a reader thread, on its own cache line.
+ */
+struct rte_rcu_qsbr_cnt {
+	/** Last token seen by the thread, 0 if offline. */
+	volatile uint64_t cnt;
+} __rte_cache_aligned;
+
+/**
+ * A QSBR variable, shared by the readers and the writers of a data
+ * structure. Its size depends on the maximum number of readers, see
+ * rte_rcu_qsbr_get_memsize().
+ */
+struct rte_rcu_qsbr {
+	/** Counter allocating the tokens of the writers. */
+	rte_atomic64_t token __rte_cache_aligned;
+	/** Smallest token seen by all the readers at the last check. */
+	volatile uint64_t acked_token;
+
+	/** Number of 64-bit words of the registered thread bitmap. */
+	uint32_t num_elems __rte_cache_aligned;
+	/** Number of registered threads. */
+	rte_atomic32_t num_threads;
+	/** Maximum number of threads. */
+	uint32_t max_threads;
+
+	/** Counters of the threads, followed by the bitmap. */
+	struct rte_rcu_qsbr_cnt qsbr_cnt[0] __rte_cache_aligned;
+} __rte_cache_aligned;
+
+/**
+ * Return the size of the memory occupied by a QSBR variable.
+ *
+ * @param max_threads
+ *   Maximum number of reader threads.
+ * @return
+ *   The size in bytes, or 0 if max_threads is 0.
+ */
+size_t rte_rcu_qsbr_get_memsize(uint32_t max_threads);
+
+/**
+ * Initialize a QSBR variable.
+ *
+ * @param v
+ *   QSBR variable, of rte_rcu_qsbr_get_memsize() bytes, aligned on a
+ *   cache line.
+ * @param max_threads
+ *   Maximum number of reader threads.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+int rte_rcu_qsbr_init(struct rte_rcu_qsbr *v, uint32_t max_threads);
+
+/**
+ * Register a reader thread.
+ *
+ * The thread is offline after registration. Thread ids are chosen by
+ * the application, e.g. the lcore id, and must be lower than
+ * max_threads.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Reader thread id.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+int rte_rcu_qsbr_thread_register(struct rte_rcu_qsbr *v,
+		unsigned int thread_id);
+
+/**
+ * Unregister a reader thread. It must be offline.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Reader thread id.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+int rte_rcu_qsbr_thread_unregister(struct rte_rcu_qsbr *v,
+		unsigned int thread_id);
+
+/**
+ * Set a registered reader thread online.
+ *
+ * The writers wait for the online threads. The thread may access the
+ * shared data structure once this function returns.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Reader thread id.
+ */
+static inline void
+rte_rcu_qsbr_thread_online(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	uint64_t t;
+
+	RTE_ASSERT(v != NULL && thread_id < v->max_threads);
+
+	t = rte_atomic64_read(&v->token);
+	v->qsbr_cnt[thread_id].cnt = t;
+
+	/*
+	 * The writers must see the thread online before it reads the
+	 * shared data structure: the store must not be reordered with
+	 * the following loads.
+	 */
+	rte_smp_mb();
+}
+
+/**
+ * Set a registered reader thread offline.
+ *
+ * The writers do not wait for offline threads. The thread must not
+ * access the shared data structure until it is online again.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Reader thread id.
+ */
+static inline void
+rte_rcu_qsbr_thread_offline(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	RTE_ASSERT(v != NULL && thread_id < v->max_threads);
+
+	/* the accesses to the shared data complete before the store */
+	rte_smp_rmb();
+	rte_smp_wmb();
+	v->qsbr_cnt[thread_id].cnt = RTE_QSBR_CNT_THR_OFFLINE;
+}
+
+/**
+ * Report a quiescent state of an online reader thread.
+ *
+ * The thread must hold no reference to the shared data structure.
+ * This is meant to be called at each iteration of a polling loop.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Reader thread id.
+ */
+static inline void
+rte_rcu_qsbr_quiescent(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	uint64_t t;
+
+	RTE_ASSERT(v != NULL && thread_id < v->max_threads);
+
+	t = rte_atomic64_read(&v->token);
+
+	/* the accesses to the shared data complete before the store */
+	rte_smp_rmb();
+	rte_smp_wmb();
+	v->qsbr_cnt[thread_id].cnt = t;
+}
+
+/**
+ * Start a grace period.
+ *
+ * It is called by a writer after removing elements from the shared data
+ * structure. The removal is visible to the readers before the token is
+ * allocated.
+ *
+ * @param v
+ *   QSBR variable.
+ * @return
+ *   The token to give to rte_rcu_qsbr_check().
+ */
+static inline uint64_t
+rte_rcu_qsbr_start(struct rte_rcu_qsbr *v)
+{
+	RTE_ASSERT(v != NULL);
+
+	/* full barrier: the removal is visible before the new token */
+	return rte_atomic64_add_return(&v->token, 1);
+}
+
+/**
+ * Check if the grace period of a token is over.
+ *
+ * The grace period is over when every registered reader has reported a
+ * quiescent state after the token was allocated, or is offline. The
+ * elements removed before rte_rcu_qsbr_start() can then be freed.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param t
+ *   Token returned by rte_rcu_qsbr_start().
+ * @param wait
+ *   If non-zero, block until the grace period is over.
+ * @return
+ *   1 if the grace period is over, 0 otherwise.
+ */
+static inline int
+rte_rcu_qsbr_check(struct rte_rcu_qsbr *v, uint64_t t, int wait)
+{
+	uint64_t acked = UINT64_MAX;
+	uint64_t *reg_thread_id;
+	uint64_t bmap, c;
+	uint32_t i, j, id;
+
+	RTE_ASSERT(v != NULL);
+
+	/* the readers may have acknowledged it at a previous check */
+	if (likely(t <= v->acked_token))
+		return 1;
+
+	reg_thread_id = __RTE_QSBR_THRID_ARRAY_ELM(v, 0);
+	for (i = 0; i < v->num_elems; i++, reg_thread_id++) {
+		bmap = *(volatile uint64_t *)reg_thread_id;
+		id = i << __RTE_QSBR_THRID_INDEX_SHIFT;
+		while (bmap) {
+			j = __builtin_ctzll(bmap);
+			c = v->qsbr_cnt[id + j].cnt;
+			if (unlikely(c != RTE_QSBR_CNT_THR_OFFLINE && c < t)) {
+				if (!wait)
+					return 0;
+				rte_pause();
+				/* the thread may have unregistered */
+				bmap = *(volatile uint64_t *)reg_thread_id;
+				continue;
+			}
+			if (c != RTE_QSBR_CNT_THR_OFFLINE && c < acked)
+				acked = c;
+			bmap &= ~(1ULL << j);
+		}
+	}
+
+	/* the counters are read before the caller frees the elements */
+	rte_smp_rmb();
+
+	/* all the threads are offline */
+	if (acked == UINT64_MAX)
+		acked = t;
+	if (acked > v->acked_token)
+		v->acked_token = acked;
+
+	return 1;
+}
+
+/**
+ * Wait for the readers to go through a quiescent state.
+ *
+ * This starts a grace period and waits for its end. If the caller is a
+ * registered reader, it reports its own quiescent state first.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Reader thread id of the caller, or RTE_QSBR_THRID_INVALID.
+ */
+void rte_rcu_qsbr_synchronize(struct rte_rcu_qsbr *v, unsigned int thread_id);
+
+/**
+ * Dump the state of a QSBR variable.
+ *
+ * @param f
+ *   Output stream.
+ * @param v
+ *   QSBR variable.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+int rte_rcu_qsbr_dump(FILE *f, struct rte_rcu_qsbr *v);
+
+/**
+ * Function freeing an element of a deferred queue.
+ *
+ * @param p
+ *   Pointer given at the creation of the queue.
+ * @param e
+ *   Element to free.
+ */
+typedef void (*rte_rcu_qsbr_free_resource_t)(void *p, void *e);
+
+/** Maximum size of the name of a deferred queue. */
+#define RTE_RCU_QSBR_DQ_NAMESIZE 32
+
+/** Deferred queue of elements waiting for the end of a grace period. */
+struct rte_rcu_qsbr_dq;
+
+/**
+ * Parameters of a deferred queue.
+ */
+struct rte_rcu_qsbr_dq_parameters {
+	const char *name;     /**< Name of the queue. */
+	uint32_t size;        /**< Number of elements it can hold. */
+	int socket_id;        /**< NUMA socket of the memory. */
+	/**
+	 * When more elements are queued, rte_rcu_qsbr_dq_enqueue()
+	 * reclaims up to max_reclaim_size of them. 0 to reclaim only when
+	 * the queue is full.
+	 */
+	uint32_t trigger_reclaim_limit;
+	uint32_t max_reclaim_size; /**< Elements reclaimed at once. */
+	rte_rcu_qsbr_free_resource_t free_fn; /**< Frees an element. */
+	void *p;              /**< Pointer given to free_fn. */
+	struct rte_rcu_qsbr *v; /**< QSBR variable of the readers. */
+};
+
+/**
+ * Create a deferred queue.
+ *
+ * The queue is safe for multiple writers.
+ *
+ * @param params
+ *   Parameters of the queue.
+ * @return
+ *   The queue, or NULL on error (invalid parameters or no memory).
+ */
+struct rte_rcu_qsbr_dq *
+rte_rcu_qsbr_dq_create(const struct rte_rcu_qsbr_dq_parameters *params);
+
+/**
+ * Queue an element removed from the shared data structure.
+ *
+ * A grace period is started for the element. If the queue is full, or
+ * above the trigger limit, the elements whose grace period is over are
+ * freed first.
+ *
+ * @param dq
+ *   Deferred queue.
+ * @param e
+ *   Element to free once the readers do not reference it anymore.
+ * @return
+ *   0 on success, -ENOSPC if the queue is full and no element could be
+ *   reclaimed.
+ */
+int rte_rcu_qsbr_dq_enqueue(struct rte_rcu_qsbr_dq *dq, void *e);
+
+/**
+ * Free the queued elements whose grace period is over, in queue order.
+ *
+ * @param dq
+ *   Deferred queue.
+ * @param n
+ *   Maximum number of elements to free.
+ * @param freed
+ *   If not NULL, set to the number of elements freed.
+ * @param pending
+ *   If not NULL, set to the number of elements still queued.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters.
+ */
+int rte_rcu_qsbr_dq_reclaim(struct rte_rcu_qsbr_dq *dq, unsigned int n,
+		unsigned int *freed, unsigned int *pending);
+
+/**
+ * Delete a deferred queue.
+ *
+ * The queued elements are freed once their grace period is over, which
+ * may block.
+ *
+ * @param dq
+ *   Deferred queue, NULL is ignored.
+ */
+void rte_rcu_qsbr_dq_delete(struct rte_rcu_qsbr_dq *dq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RCU_QSBR_H_ */
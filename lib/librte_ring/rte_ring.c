@@ -96,6 +96,11 @@ static struct rte_tailq_elem rte_ring_tailq = {
 };
 EAL_REGISTER_TAILQ(rte_ring_tailq)
 
+RTE_TRACE_POINT_DEFINE(rte_ring_trace_enqueue, "lib.ring.enqueue",
+	"ring", "nb_objs");
+RTE_TRACE_POINT_DEFINE(rte_ring_trace_dequeue, "lib.ring.dequeue",
+	"ring", "nb_objs");
+
 /* true if x is a power of 2 */
 #define POWEROF2(x) ((((x)-1) & (x)) == 0)
 
@@ -101,6 +101,7 @@ extern "C" {
 #include <rte_atomic.h>
 #include <rte_branch_prediction.h>
 #include <rte_memzone.h>
+#include <rte_trace.h>
 
 #define RTE_TAILQ_RING_NAME "RTE_RING"
 
@@ -116,6 +117,9 @@ enum rte_ring_queue_behavior {
 
 struct rte_memzone; /* forward declaration, so as not to require memzone.h */
 
+RTE_TRACE_POINT_DECLARE(rte_ring_trace_enqueue);
+RTE_TRACE_POINT_DECLARE(rte_ring_trace_dequeue);
+
 #if RTE_CACHE_LINE_SIZE < 128
 #define PROD_ALIGN (RTE_CACHE_LINE_SIZE * 2)
 #define CONS_ALIGN (RTE_CACHE_LINE_SIZE * 2)
@@ -460,6 +464,7 @@ __rte_ring_do_enqueue(struct rte_ring *r, void * const *obj_table,
 	rte_smp_wmb();
 
 	update_tail(&r->prod, prod_head, prod_next, is_sp);
+	RTE_TRACE_POINT_EMIT(rte_ring_trace_enqueue, (uintptr_t)r, n);
 end:
 	if (free_space != NULL)
 		*free_space = free_entries - n;
@@ -565,6 +570,7 @@ __rte_ring_do_dequeue(struct rte_ring *r, void **obj_table,
 	rte_smp_rmb();
 
 	update_tail(&r->cons, cons_head, cons_next, is_sc);
+	RTE_TRACE_POINT_EMIT(rte_ring_trace_dequeue, (uintptr_t)r, n);
 
 end:
 	if (available != NULL)
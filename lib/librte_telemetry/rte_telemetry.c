@@ -0,0 +1,879 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/queue.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_version.h>
+#include <rte_spinlock.h>
+#include <rte_atomic.h>
+#include <rte_tailq.h>
+#include <rte_rwlock.h>
+#include <rte_eal_memconfig.h>
+#include <rte_memzone.h>
+#include <rte_ethdev.h>
+#include <rte_metrics.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+
+#include "rte_telemetry.h"
+
+static int telemetry_log_type;
+
+#define TELEMETRY_LOG(level, fmt, args...) \
+	rte_log(RTE_LOG_ ## level, telemetry_log_type, "%s(): " fmt "\n", \
+		__func__, ## args)
+
+/* period at which the server thread checks if it must stop */
+#define TELEMETRY_POLL_MS 100
+
+struct telemetry_cmd {
+	char cmd[RTE_TELEMETRY_CMD_LEN];
+	rte_telemetry_cb fn;
+	const char *help;
+};
+
+static struct telemetry_cmd telemetry_cmds[RTE_TELEMETRY_MAX_CMDS];
+static unsigned int telemetry_nb_cmds;
+static rte_spinlock_t telemetry_cmds_lock = RTE_SPINLOCK_INITIALIZER;
+
+static struct {
+	int running;
+	int listen_fd;
+	int client_fds[RTE_TELEMETRY_MAX_CLIENTS];
+	struct sockaddr_un addr;
+	pthread_t thread;
+	rte_atomic32_t stop;
+} telemetry = {
+	.listen_fd = -1,
+};
+
+/* a JSON output buffer, which records overflows */
+struct json_buf {
+	char *buf;
+	size_t len;
+	size_t pos;
+	int overflow;
+};
+
+static void __attribute__((format(printf, 2, 3)))
+json_printf(struct json_buf *jb, const char *fmt, ...)
+{
+	va_list ap;
+	int ret;
+
+	if (jb->overflow)
+		return;
+
+	va_start(ap, fmt);
+	ret = vsnprintf(jb->buf + jb->pos, jb->len - jb->pos, fmt, ap);
+	va_end(ap);
+
+	if (ret < 0 || (size_t)ret >= jb->len - jb->pos)
+		jb->overflow = 1;
+	else
+		jb->pos += ret;
+}
+
+/* write a quoted and escaped JSON string */
+static void
+json_str(struct json_buf *jb, const char *s)
+{
+	json_printf(jb, "\"");
+	for (; *s != '\0'; s++) {
+		if (*s == '"' || *s == '\\')
+			json_printf(jb, "\\%c", *s);
+		else if ((unsigned char)*s < 0x20)
+			json_printf(jb, "\\u%04x", (unsigned char)*s);
+		else
+			json_printf(jb, "%c", *s);
+	}
+	json_printf(jb, "\"");
+}
+
+/* write a "key": value pair of an object, with a separator if needed */
+static void
+json_u64(struct json_buf *jb, int *first, const char *key, uint64_t val)
+{
+	json_printf(jb, "%s", *first ? "" : ", ");
+	json_str(jb, key);
+	json_printf(jb, ": %"PRIu64, val);
+	*first = 0;
+}
+
+static int
+json_end(struct json_buf *jb)
+{
+	if (jb->overflow)
+		return -ENOBUFS;
+	return jb->pos;
+}
+
+static int
+parse_port(const char *params, uint8_t *port_id)
+{
+	unsigned long port;
+	char *end;
+
+	if (params == NULL)
+		return -EINVAL;
+
+	errno = 0;
+	port = strtoul(params, &end, 0);
+	if (errno != 0 || end == params || (*end != '\0' && *end != ',') ||
+			port >= RTE_MAX_ETHPORTS ||
+			!rte_eth_dev_is_valid_port(port))
+		return -EINVAL;
+
+	*port_id = port;
+	return 0;
+}
+
+static int
+telemetry_cmd_list(const char *cmd __rte_unused,
+		const char *params __rte_unused, char *buf, size_t len)
+{
+	struct json_buf jb = { buf, len, 0, 0 };
+	unsigned int i;
+
+	json_printf(&jb, "[");
+	rte_spinlock_lock(&telemetry_cmds_lock);
+	for (i = 0; i < telemetry_nb_cmds; i++) {
+		json_printf(&jb, "%s", i == 0 ? "" : ", ");
+		json_str(&jb, telemetry_cmds[i].cmd);
+	}
+	rte_spinlock_unlock(&telemetry_cmds_lock);
+	json_printf(&jb, "]");
+
+	return json_end(&jb);
+}
+
+static int
+telemetry_cmd_help(const char *cmd __rte_unused, const char *params,
+		char *buf, size_t len)
+{
+	struct json_buf jb = { buf, len, 0, 0 };
+	const char *help = NULL;
+	unsigned int i;
+
+	if (params == NULL)
+		return -EINVAL;
+
+	rte_spinlock_lock(&telemetry_cmds_lock);
+	for (i = 0; i < telemetry_nb_cmds; i++) {
+		if (strcmp(telemetry_cmds[i].cmd, params) == 0) {
+			help = telemetry_cmds[i].help;
+			break;
+		}
+	}
+	rte_spinlock_unlock(&telemetry_cmds_lock);
+	if (help == NULL)
+		return -ENOENT;
+
+	json_str(&jb, help);
+
+	return json_end(&jb);
+}
+
+static int
+telemetry_cmd_info(const char *cmd __rte_unused,
+		const char *params __rte_unused, char *buf, size_t len)
+{
+	struct json_buf jb = { buf, len, 0, 0 };
+
+	json_printf(&jb, "{\"version\": ");
+	json_str(&jb, rte_version());
+	json_printf(&jb, ", \"pid\": %d, \"max_output_len\": %u}",
+		    (int)getpid(), RTE_TELEMETRY_REPLY_LEN);
+
+	return json_end(&jb);
+}
+
+static int
+telemetry_cmd_ethdev_list(const char *cmd __rte_unused,
+		const char *params __rte_unused, char *buf, size_t len)
+{
+	struct json_buf jb = { buf, len, 0, 0 };
+	unsigned int port_id;
+	int first = 1;
+
+	json_printf(&jb, "[");
+	for (port_id = 0; port_id < RTE_MAX_ETHPORTS; port_id++) {
+		if (!rte_eth_dev_is_valid_port(port_id))
+			continue;
+		json_printf(&jb, "%s%u", first ? "" : ", ", port_id);
+		first = 0;
+	}
+	json_printf(&jb, "]");
+
+	return json_end(&jb);
+}
+
+static void
+json_queue_stats(struct json_buf *jb, const char *key, const uint64_t *q,
+		unsigned int nb_queues)
+{
+	unsigned int i;
+
+	json_printf(jb, ", ");
+	json_str(jb, key);
+	json_printf(jb, ": [");
+	for (i = 0; i < nb_queues; i++)
+		json_printf(jb, "%s%"PRIu64, i == 0 ? "" : ", ", q[i]);
+	json_printf(jb, "]");
+}
+
+static int
+telemetry_cmd_ethdev_stats(const char *cmd __rte_unused, const char *params,
+		char *buf, size_t len)
+{
+	struct json_buf jb = { buf, len, 0, 0 };
+	struct rte_eth_stats stats;
+	unsigned int nb_rxq, nb_txq;
+	uint8_t port_id;
+	int first = 1;
+	int ret;
+
+	if (parse_port(params, &port_id) < 0)
+		return -EINVAL;
+
+	ret = rte_eth_stats_get(port_id, &stats);
+	if (ret < 0)
+		return ret;
+
+	nb_rxq = RTE_MIN(rte_eth_devices[port_id].data->nb_rx_queues,
+			 RTE_ETHDEV_QUEUE_STAT_CNTRS);
+	nb_txq = RTE_MIN(rte_eth_devices[port_id].data->nb_tx_queues,
+			 RTE_ETHDEV_QUEUE_STAT_CNTRS);
+
+	json_printf(&jb, "{");
+	json_u64(&jb, &first, "ipackets", stats.ipackets);
+	json_u64(&jb, &first, "opackets", stats.opackets);
+	json_u64(&jb, &first, "ibytes", stats.ibytes);
+	json_u64(&jb, &first, "obytes", stats.obytes);
+	json_u64(&jb, &first, "imissed", stats.imissed);
+	json_u64(&jb, &first, "ierrors", stats.ierrors);
+	json_u64(&jb, &first, "oerrors", stats.oerrors);
+	json_u64(&jb, &first, "rx_nombuf", stats.rx_nombuf);
+	json_queue_stats(&jb, "q_ipackets", stats.q_ipackets, nb_rxq);
+	json_queue_stats(&jb, "q_opackets", stats.q_opackets, nb_txq);
+	json_queue_stats(&jb, "q_ibytes", stats.q_ibytes, nb_rxq);
+	json_queue_stats(&jb, "q_obytes", stats.q_obytes, nb_txq);
+	json_queue_stats(&jb, "q_errors", stats.q_errors, nb_rxq);
+	json_printf(&jb, "}");
+
+	return json_end(&jb);
+}
+
+/* parse the list of ids following the port id, if any */
+static int
+parse_xstats_ids(const char *params, uint64_t **ids)
+{
+	const char *p = strchr(params, ',');
+	unsigned int nb_ids = 0;
+	char *end;
+
+	*ids = NULL;
+	if (p == NULL)
+		return 0;
+
+	*ids = malloc(sizeof(uint64_t) * strlen(p));
+	if (*ids == NULL)
+		return -ENOMEM;
+
+	while (p != NULL && *p == ',') {
+		p++;
+		errno = 0;
+		(*ids)[nb_ids] = strtoull(p, &end, 0);
+		if (errno != 0 || end == p || (*end != '\0' && *end != ',')) {
+			free(*ids);
+			*ids = NULL;
+			return -EINVAL;
+		}
+		nb_ids++;
+		p = end;
+	}
+
+	return nb_ids;
+}
+
+static int
+telemetry_cmd_ethdev_xstats(const char *cmd __rte_unused, const char *params,
+		char *buf, size_t len)
+{
+	struct json_buf jb = { buf, len, 0, 0 };
+	struct rte_eth_xstat_name *names = NULL;
+	uint64_t *values = NULL;
+	uint64_t *ids = NULL;
+	uint8_t port_id;
+	int first = 1;
+	int nb, i, ret;
+
+	if (parse_port(params, &port_id) < 0)
+		return -EINVAL;
+
+	nb = parse_xstats_ids(params, &ids);
+	if (nb < 0)
+		return nb;
+	if (nb == 0) {
+		nb = rte_eth_xstats_get_names_by_id(port_id, NULL, 0, NULL);
+		if (nb < 0) {
+			ret = nb;
+			goto out;
+		}
+	}
+
+	names = malloc(sizeof(*names) * (nb + 1));
+	values = malloc(sizeof(*values) * (nb + 1));
+	if (names == NULL || values == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	ret = rte_eth_xstats_get_names_by_id(port_id, names, nb, ids);
+	if (ret < 0 || ret > nb) {
+		ret = -EINVAL;
+		goto out;
+	}
+	ret = rte_eth_xstats_get_by_id(port_id, ids, values, nb);
+	if (ret < 0 || ret > nb) {
+		ret = -EINVAL;
+		goto out;
+	}
+	nb = ret;
+
+	json_printf(&jb, "{");
+	for (i = 0; i < nb; i++)
+		json_u64(&jb, &first, names[i].name, values[i]);
+	json_printf(&jb, "}");
+	ret = json_end(&jb);
+
+out:
+	free(ids);
+	free(names);
+	free(values);
+	return ret;
+}
+
+static int
+telemetry_cmd_metrics(const char *cmd __rte_unused, const char *params,
+		char *buf, size_t len)
+{
+	struct json_buf jb = { buf, len, 0, 0 };
+	struct rte_metric_name *names = NULL;
+	struct rte_metric_value *values = NULL;
+	int port_id = RTE_METRICS_GLOBAL;
+	int nb_names, nb_values, i, ret;
+	int first = 1;
+	uint8_t port;
+
+	if (params != NULL && strcmp(params, "global") != 0) {
+		if (parse_port(params, &port) < 0)
+			return -EINVAL;
+		port_id = port;
+	}
+
+	nb_names = rte_metrics_get_names(NULL, 0);
+	nb_values = rte_metrics_get_values(port_id, NULL, 0);
+	if (nb_names < 0 || nb_values < 0)
+		return -ENOENT;
+
+	names = malloc(sizeof(*names) * (nb_names + 1));
+	values = malloc(sizeof(*values) * (nb_values + 1));
+	if (names == NULL || values == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	/* metrics registered meanwhile are ignored */
+	nb_names = rte_metrics_get_names(names, nb_names);
+	nb_values = rte_metrics_get_values(port_id, values, nb_values);
+	if (nb_names < 0 || nb_values < 0) {
+		ret = -ENOENT;
+		goto out;
+	}
+
+	json_printf(&jb, "{");
+	for (i = 0; i < nb_values; i++) {
+		if (values[i].key >= nb_names)
+			continue;
+		json_u64(&jb, &first, names[values[i].key].name,
+			 values[i].value);
+	}
+	json_printf(&jb, "}");
+	ret = json_end(&jb);
+
+out:
+	free(names);
+	free(values);
+	return ret;
+}
+
+struct mempool_walk_arg {
+	struct json_buf *jb;
+	int first;
+};
+
+static void
+mempool_list_cb(struct rte_mempool *mp, void *arg)
+{
+	struct mempool_walk_arg *walk = arg;
+
+	json_printf(walk->jb, "%s", walk->first ? "" : ", ");
+	json_str(walk->jb, mp->name);
+	walk->first = 0;
+}
+
+static int
+telemetry_cmd_mempool_list(const char *cmd __rte_unused,
+		const char *params __rte_unused, char *buf, size_t len)
+{
+	struct json_buf jb = { buf, len, 0, 0 };
+	struct mempool_walk_arg walk = { &jb, 1 };
+
+	json_printf(&jb, "[");
+	rte_mempool_walk(mempool_list_cb, &walk);
+	json_printf(&jb, "]");
+
+	return json_end(&jb);
+}
+
+static int
+telemetry_cmd_mempool_info(const char *cmd __rte_unused, const char *params,
+		char *buf, size_t len)
+{
+	struct json_buf jb = { buf, len, 0, 0 };
+	struct rte_mempool *mp;
+	int first = 0;
+
+	if (params == NULL)
+		return -EINVAL;
+
+	mp = rte_mempool_lookup(params);
+	if (mp == NULL)
+		return -ENOENT;
+
+	json_printf(&jb, "{\"name\": ");
+	json_str(&jb, mp->name);
+	json_printf(&jb, ", \"socket_id\": %d", mp->socket_id);
+	json_u64(&jb, &first, "flags", mp->flags);
+	json_u64(&jb, &first, "size", mp->size);
+	json_u64(&jb, &first, "populated_size", mp->populated_size);
+	json_u64(&jb, &first, "cache_size", mp->cache_size);
+	json_u64(&jb, &first, "elt_size", mp->elt_size);
+	json_u64(&jb, &first, "header_size", mp->header_size);
+	json_u64(&jb, &first, "trailer_size", mp->trailer_size);
+	json_u64(&jb, &first, "private_data_size", mp->private_data_size);
+	json_u64(&jb, &first, "avail_count", rte_mempool_avail_count(mp));
+	json_u64(&jb, &first, "in_use_count", rte_mempool_in_use_count(mp));
+	json_printf(&jb, "}");
+
+	return json_end(&jb);
+}
+
+TAILQ_HEAD(telemetry_ring_list, rte_tailq_entry);
+
+static int
+telemetry_cmd_ring_list(const char *cmd __rte_unused,
+		const char *params __rte_unused, char *buf, size_t len)
+{
+	struct json_buf jb = { buf, len, 0, 0 };
+	struct telemetry_ring_list *ring_list;
+	struct rte_tailq_head *head;
+	const struct rte_tailq_entry *te;
+	int first = 1;
+
+	head = rte_eal_tailq_lookup(RTE_TAILQ_RING_NAME);
+	if (head == NULL)
+		return -ENOENT;
+	ring_list = RTE_TAILQ_CAST(head, telemetry_ring_list);
+
+	json_printf(&jb, "[");
+	rte_rwlock_read_lock(RTE_EAL_TAILQ_RWLOCK);
+	TAILQ_FOREACH(te, ring_list, next) {
+		json_printf(&jb, "%s", first ? "" : ", ");
+		json_str(&jb, ((const struct rte_ring *)te->data)->name);
+		first = 0;
+	}
+	rte_rwlock_read_unlock(RTE_EAL_TAILQ_RWLOCK);
+	json_printf(&jb, "]");
+
+	return json_end(&jb);
+}
+
+static int
+telemetry_cmd_ring_info(const char *cmd __rte_unused, const char *params,
+		char *buf, size_t len)
+{
+	struct json_buf jb = { buf, len, 0, 0 };
+	struct rte_ring *r;
+	int first = 0;
+
+	if (params == NULL)
+		return -EINVAL;
+
+	r = rte_ring_lookup(params);
+	if (r == NULL)
+		return -ENOENT;
+
+	json_printf(&jb, "{\"name\": ");
+	json_str(&jb, r->name);
+	json_printf(&jb, ", \"socket_id\": %d",
+		    r->memzone != NULL ? r->memzone->socket_id : SOCKET_ID_ANY);
+	json_u64(&jb, &first, "flags", r->flags);
+	json_u64(&jb, &first, "size", r->size);
+	json_u64(&jb, &first, "count", rte_ring_count(r));
+	json_u64(&jb, &first, "free_count", rte_ring_free_count(r));
+	json_printf(&jb, "}");
+
+	return json_end(&jb);
+}
+
+int
+rte_telemetry_register_cmd(const char *cmd, rte_telemetry_cb fn,
+		const char *help)
+{
+	unsigned int i;
+
+	if (cmd == NULL || fn == NULL || cmd[0] != '/' ||
+			strchr(cmd, ',') != NULL ||
+			strlen(cmd) >= RTE_TELEMETRY_CMD_LEN)
+		return -EINVAL;
+
+	rte_spinlock_lock(&telemetry_cmds_lock);
+	for (i = 0; i < telemetry_nb_cmds; i++) {
+		if (strcmp(telemetry_cmds[i].cmd, cmd) == 0) {
+			rte_spinlock_unlock(&telemetry_cmds_lock);
+			return -EEXIST;
+		}
+	}
+	if (telemetry_nb_cmds == RTE_TELEMETRY_MAX_CMDS) {
+		rte_spinlock_unlock(&telemetry_cmds_lock);
+		return -ENOSPC;
+	}
+
+	snprintf(telemetry_cmds[i].cmd, sizeof(telemetry_cmds[i].cmd),
+		 "%s", cmd);
+	telemetry_cmds[i].fn = fn;
+	telemetry_cmds[i].help = help != NULL ? help : "";
+	telemetry_nb_cmds++;
+	rte_spinlock_unlock(&telemetry_cmds_lock);
+
+	return 0;
+}
+
+/* run a request and write the JSON reply, return its length */
+static int
+telemetry_process(char *msg, char *reply, size_t len)
+{
+	struct json_buf jb = { reply, len, 0, 0 };
+	rte_telemetry_cb fn = NULL;
+	char *params;
+	unsigned int i;
+	int ret;
+
+	/* strip the trailing new lines sent by interactive clients */
+	i = strlen(msg);
+	while (i > 0 && (msg[i - 1] == '\n' || msg[i - 1] == '\r' ||
+			msg[i - 1] == ' '))
+		msg[--i] = '\0';
+
+	params = strchr(msg, ',');
+	if (params != NULL) {
+		*params = '\0';
+		params++;
+		if (*params == '\0')
+			params = NULL;
+	}
+
+	rte_spinlock_lock(&telemetry_cmds_lock);
+	for (i = 0; i < telemetry_nb_cmds; i++) {
+		if (strcmp(telemetry_cmds[i].cmd, msg) == 0) {
+			fn = telemetry_cmds[i].fn;
+			break;
+		}
+	}
+	rte_spinlock_unlock(&telemetry_cmds_lock);
+
+	json_printf(&jb, "{");
+	json_str(&jb, msg);
+	json_printf(&jb, ": ");
+	if (jb.overflow)
+		return -ENOBUFS;
+
+	/* leave room for the closing brace */
+	ret = -ENOENT;
+	if (fn != NULL)
+		ret = fn(msg, params, reply + jb.pos, len - jb.pos - 1);
+	if (ret < 0 || (size_t)ret >= len - jb.pos - 1) {
+		TELEMETRY_LOG(DEBUG, "command %s failed: %s", msg,
+			      strerror(ret < 0 ? -ret : ENOBUFS));
+		json_printf(&jb, "null");
+	} else {
+		jb.pos += ret;
+	}
+	json_printf(&jb, "}");
+
+	return json_end(&jb);
+}
+
+static void
+telemetry_client_add(int fd)
+{
+	char reply[RTE_TELEMETRY_MSG_LEN];
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < RTE_TELEMETRY_MAX_CLIENTS; i++) {
+		if (telemetry.client_fds[i] < 0)
+			break;
+	}
+	if (i == RTE_TELEMETRY_MAX_CLIENTS) {
+		TELEMETRY_LOG(WARNING, "too many clients");
+		close(fd);
+		return;
+	}
+	telemetry.client_fds[i] = fd;
+
+	ret = telemetry_cmd_info(NULL, NULL, reply, sizeof(reply));
+	if (ret > 0 && send(fd, reply, ret, MSG_NOSIGNAL) < 0) {
+		close(fd);
+		telemetry.client_fds[i] = -1;
+	}
+}
+
+static void
+telemetry_client_handle(unsigned int idx)
+{
+	char msg[RTE_TELEMETRY_MSG_LEN];
+	char reply[RTE_TELEMETRY_REPLY_LEN];
+	int fd = telemetry.client_fds[idx];
+	ssize_t n;
+	int ret;
+
+	n = recv(fd, msg, sizeof(msg) - 1, 0);
+	if (n <= 0) {
+		close(fd);
+		telemetry.client_fds[idx] = -1;
+		return;
+	}
+	msg[n] = '\0';
+
+	ret = telemetry_process(msg, reply, sizeof(reply));
+	if (ret < 0)
+		ret = snprintf(reply, sizeof(reply), "{}");
+
+	if (send(fd, reply, ret, MSG_NOSIGNAL) < 0) {
+		close(fd);
+		telemetry.client_fds[idx] = -1;
+	}
+}
+
+static void *
+telemetry_thread_main(void *arg __rte_unused)
+{
+	struct pollfd fds[RTE_TELEMETRY_MAX_CLIENTS + 1];
+	unsigned int i, nfds;
+	int fd, ret;
+
+	while (rte_atomic32_read(&telemetry.stop) == 0) {
+		fds[0].fd = telemetry.listen_fd;
+		fds[0].events = POLLIN;
+		nfds = 1;
+		for (i = 0; i < RTE_TELEMETRY_MAX_CLIENTS; i++) {
+			fds[nfds].fd = telemetry.client_fds[i];
+			fds[nfds].events = POLLIN;
+			fds[nfds].revents = 0;
+			nfds++;
+		}
+
+		ret = poll(fds, nfds, TELEMETRY_POLL_MS);
+		if (ret <= 0)
+			continue;
+
+		for (i = 0; i < RTE_TELEMETRY_MAX_CLIENTS; i++) {
+			if (fds[i + 1].fd >= 0 && fds[i + 1].revents != 0)
+				telemetry_client_handle(i);
+		}
+
+		if (fds[0].revents & POLLIN) {
+			fd = accept(telemetry.listen_fd, NULL, NULL);
+			if (fd >= 0)
+				telemetry_client_add(fd);
+		}
+	}
+
+	return NULL;
+}
+
+int
+rte_telemetry_init(const char *path)
+{
+	unsigned int i;
+	int ret;
+
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY)
+		return -EPERM;
+	if (telemetry.running)
+		return -EBUSY;
+
+	if (path == NULL)
+		path = RTE_TELEMETRY_DEFAULT_PATH;
+
+	memset(&telemetry.addr, 0, sizeof(telemetry.addr));
+	telemetry.addr.sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(telemetry.addr.sun_path)) {
+		TELEMETRY_LOG(ERR, "socket path too long: %s", path);
+		return -ENAMETOOLONG;
+	}
+	snprintf(telemetry.addr.sun_path, sizeof(telemetry.addr.sun_path),
+		 "%s", path);
+
+	telemetry.listen_fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	if (telemetry.listen_fd < 0) {
+		ret = -errno;
+		TELEMETRY_LOG(ERR, "cannot create socket: %s", strerror(errno));
+		return ret;
+	}
+
+	unlink(telemetry.addr.sun_path);
+	if (bind(telemetry.listen_fd, (struct sockaddr *)&telemetry.addr,
+			sizeof(telemetry.addr)) < 0 ||
+			listen(telemetry.listen_fd, 1) < 0) {
+		ret = -errno;
+		TELEMETRY_LOG(ERR, "cannot listen on %s: %s", path,
+			      strerror(errno));
+		goto fail;
+	}
+
+	for (i = 0; i < RTE_TELEMETRY_MAX_CLIENTS; i++)
+		telemetry.client_fds[i] = -1;
+	rte_atomic32_clear(&telemetry.stop);
+
+	ret = -pthread_create(&telemetry.thread, NULL, telemetry_thread_main,
+			      NULL);
+	if (ret != 0) {
+		TELEMETRY_LOG(ERR, "cannot create thread: %s", strerror(-ret));
+		unlink(telemetry.addr.sun_path);
+		goto fail;
+	}
+	if (rte_thread_setname(telemetry.thread, "telemetry") != 0)
+		TELEMETRY_LOG(DEBUG, "cannot set thread name");
+
+	telemetry.running = 1;
+	TELEMETRY_LOG(INFO, "listening on %s", path);
+
+	return 0;
+
+fail:
+	close(telemetry.listen_fd);
+	telemetry.listen_fd = -1;
+	return ret;
+}
+
+int
+rte_telemetry_cleanup(void)
+{
+	unsigned int i;
+
+	if (!telemetry.running)
+		return -EINVAL;
+
+	rte_atomic32_set(&telemetry.stop, 1);
+	pthread_join(telemetry.thread, NULL);
+
+	for (i = 0; i < RTE_TELEMETRY_MAX_CLIENTS; i++) {
+		if (telemetry.client_fds[i] >= 0)
+			close(telemetry.client_fds[i]);
+		telemetry.client_fds[i] = -1;
+	}
+	close(telemetry.listen_fd);
+	telemetry.listen_fd = -1;
+	unlink(telemetry.addr.sun_path);
+	telemetry.running = 0;
+
+	return 0;
+}
+
+RTE_INIT(rte_telemetry_register_builtin);
+static void
+rte_telemetry_register_builtin(void)
+{
+	telemetry_log_type = rte_log_register("lib.telemetry");
+	if (telemetry_log_type >= 0)
+		rte_log_set_level(telemetry_log_type, RTE_LOG_INFO);
+
+	rte_telemetry_register_cmd("/", telemetry_cmd_list,
+		"Returns the list of the commands. Takes no parameters");
+	rte_telemetry_register_cmd("/help", telemetry_cmd_help,
+		"Returns the help text of a command. Parameter: command");
+	rte_telemetry_register_cmd("/info", telemetry_cmd_info,
+		"Returns the DPDK version, the process id and the maximum "
+		"reply length. Takes no parameters");
+	rte_telemetry_register_cmd("/ethdev/list", telemetry_cmd_ethdev_list,
+		"Returns the list of the port ids. Takes no parameters");
+	rte_telemetry_register_cmd("/ethdev/stats", telemetry_cmd_ethdev_stats,
+		"Returns the basic statistics of a port. Parameter: port id");
+	rte_telemetry_register_cmd("/ethdev/xstats",
+		telemetry_cmd_ethdev_xstats,
+		"Returns the extended statistics of a port. Parameters: "
+		"port id, optionally followed by statistic ids");
+	rte_telemetry_register_cmd("/metrics", telemetry_cmd_metrics,
+		"Returns the metrics of a port, or the global metrics. "
+		"Parameter: port id or \"global\" (default)");
+	rte_telemetry_register_cmd("/mempool/list",
+		telemetry_cmd_mempool_list,
+		"Returns the list of the mempool names. Takes no parameters");
+	rte_telemetry_register_cmd("/mempool/info",
+		telemetry_cmd_mempool_info,
+		"Returns the state of a mempool. Parameter: mempool name");
+	rte_telemetry_register_cmd("/ring/list", telemetry_cmd_ring_list,
+		"Returns the list of the ring names. Takes no parameters");
+	rte_telemetry_register_cmd("/ring/info", telemetry_cmd_ring_info,
+		"Returns the state of a ring. Parameter: ring name");
+}
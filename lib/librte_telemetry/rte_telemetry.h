@@ -0,0 +1,165 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_TELEMETRY_H_
+#define _RTE_TELEMETRY_H_
+
+/**
+ * @file
+ *
+ * RTE Telemetry
+ *
+ * The telemetry library serves a Unix socket in the primary process, so
+ * that monitoring agents can query statistics without attaching as a
+ * secondary process. The socket is of type SOCK_SEQPACKET: each message
+ * sent by a client is a command, and each message sent back is a JSON
+ * object.
+ *
+ * A command is a path, optionally followed by a comma and parameters,
+ * e.g. "/ethdev/stats,0". The reply is a JSON object whose only key is
+ * the command and whose value is the result, or null on error. When a
+ * client connects, it first receives an object giving the DPDK version,
+ * the process id and the maximum length of a reply.
+ *
+ * The built-in commands are:
+ *
+ * - "/": list of the commands.
+ * - "/help,<command>": help text of a command.
+ * - "/info": version, process id and maximum reply length.
+ * - "/ethdev/list": list of the valid port ids.
+ * - "/ethdev/stats,<port>": basic statistics of a port (rte_eth_stats).
+ * - "/ethdev/xstats,<port>[,<id>...]": extended statistics of a port, all
+ *   of them or only the given ids.
+ * - "/metrics[,<port>]": metrics of a port, or the global metrics if no
+ *   port is given, see rte_metrics.h.
+ * - "/mempool/list", "/mempool/info,<name>": mempool names and state.
+ * - "/ring/list", "/ring/info,<name>": ring names and state.
+ *
+ * The commands only read the state of the objects, from a control thread:
+ * the data path is never stopped nor locked.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Default path of the telemetry socket. */
+#define RTE_TELEMETRY_DEFAULT_PATH "/var/run/dpdk_telemetry"
+
+/** Maximum length of a command, including the null terminator. */
+#define RTE_TELEMETRY_CMD_LEN 64
+
+/** Maximum length of a message received from a client. */
+#define RTE_TELEMETRY_MSG_LEN 1024
+
+/** Maximum length of a reply sent to a client. */
+#define RTE_TELEMETRY_REPLY_LEN 16384
+
+/** Maximum number of commands. */
+#define RTE_TELEMETRY_MAX_CMDS 64
+
+/** Maximum number of clients connected at the same time. */
+#define RTE_TELEMETRY_MAX_CLIENTS 8
+
+/**
+ * Callback of a telemetry command.
+ *
+ * @param cmd
+ *   The command, e.g. "/ethdev/stats".
+ * @param params
+ *   The parameters following the first comma of the request, or NULL.
+ * @param buf
+ *   The buffer where the JSON value of the result is written, e.g. an
+ *   object or an array. It is inserted as is in the reply.
+ * @param len
+ *   The size of the buffer.
+ * @return
+ *   The number of characters written in the buffer, not including the
+ *   null terminator, or a negative errno value on error.
+ */
+typedef int (*rte_telemetry_cb)(const char *cmd, const char *params,
+		char *buf, size_t len);
+
+/**
+ * Start the telemetry server.
+ *
+ * A control thread is created, which serves the telemetry socket. If a
+ * file exists at the path of the socket, it is removed. The function
+ * must be called from the primary process, after rte_eal_init().
+ *
+ * @param path
+ *   The path of the Unix socket, or NULL to use
+ *   RTE_TELEMETRY_DEFAULT_PATH.
+ * @return
+ *   0 on success, negative errno value on error.
+ */
+int rte_telemetry_init(const char *path);
+
+/**
+ * Stop the telemetry server.
+ *
+ * The control thread is stopped, the clients are disconnected and the
+ * socket file is removed.
+ *
+ * @return
+ *   0 on success, -EINVAL if the server is not running.
+ */
+int rte_telemetry_cleanup(void);
+
+/**
+ * Register a telemetry command.
+ *
+ * Commands can be registered before or after rte_telemetry_init(). The
+ * callback is called from the telemetry control thread.
+ *
+ * @param cmd
+ *   The command, starting with '/' and not containing ','.
+ * @param fn
+ *   The callback generating the result.
+ * @param help
+ *   A help text, returned by the "/help" command. The string is not
+ *   copied and must stay valid.
+ * @return
+ *   0 on success, -EINVAL on invalid parameters, -EEXIST if the command
+ *   is already registered, -ENOSPC if there are too many commands.
+ */
+int rte_telemetry_register_cmd(const char *cmd, rte_telemetry_cb fn,
+		const char *help);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_TELEMETRY_H_ */
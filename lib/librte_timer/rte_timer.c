@@ -51,6 +51,7 @@
 #include <rte_branch_prediction.h>
 #include <rte_spinlock.h>
 #include <rte_random.h>
+#include <rte_lcore_var.h>
 
 #include "rte_timer.h"
 
@@ -76,17 +77,27 @@ struct priv_timer {
 	/** per-lcore statistics */
 	struct rte_timer_debug_stats stats;
 #endif
-} __rte_cache_aligned;
+};
 
-/** per-lcore private info for timers */
-static struct priv_timer priv_timer[RTE_MAX_LCORE];
+/**
+ * per-lcore private info for timers, it does not need to be cache
+ * aligned as the values of the lcores are in distinct blocks
+ */
+static RTE_LCORE_VAR_HANDLE(struct priv_timer, priv_timer);
+RTE_LCORE_VAR_INIT(priv_timer);
+
+static inline struct priv_timer *
+lcore_priv_timer(unsigned int lcore_id)
+{
+	return RTE_LCORE_VAR_LCORE(lcore_id, priv_timer);
+}
 
 /* when debug is enabled, store some statistics */
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 #define __TIMER_STAT_ADD(name, n) do {					\
 		unsigned __lcore_id = rte_lcore_id();			\
 		if (__lcore_id < RTE_MAX_LCORE)				\
-			priv_timer[__lcore_id].stats.name += (n);	\
+			lcore_priv_timer(__lcore_id)->stats.name += (n); \
 	} while(0)
 #else
 #define __TIMER_STAT_ADD(name, n) do {} while(0)
@@ -96,14 +107,19 @@ static struct priv_timer priv_timer[RTE_MAX_LCORE];
 void
 rte_timer_subsystem_init(void)
 {
+	struct priv_timer *priv_tim;
 	unsigned lcore_id;
 
-	/* since priv_timer is static, it's zeroed by default, so only init some
-	 * fields.
+	/* since priv_timer is zeroed at allocation, only init some fields.
+	 * The values of the disabled lcores are never used, do not touch
+	 * their memory. The values of each enabled lcore stay on its NUMA
+	 * socket although they are written here by the master lcore, as
+	 * the EAL binds the lcore variable blocks to the lcore sockets.
 	 */
-	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id ++) {
-		rte_spinlock_init(&priv_timer[lcore_id].list_lock);
-		priv_timer[lcore_id].prev_lcore = lcore_id;
+	RTE_LCORE_FOREACH(lcore_id) {
+		priv_tim = lcore_priv_timer(lcore_id);
+		rte_spinlock_init(&priv_tim->list_lock);
+		priv_tim->prev_lcore = lcore_id;
 	}
 }
 
@@ -143,7 +159,7 @@ timer_set_config_state(struct rte_timer *tim,
 		 */
 		if (prev_status.state == RTE_TIMER_RUNNING &&
 		    (prev_status.owner != (uint16_t)lcore_id ||
-		     tim != priv_timer[lcore_id].running_tim))
+		     tim != lcore_priv_timer(lcore_id)->running_tim))
 			return -1;
 
 		/* timer is being configured on another core */
@@ -239,8 +255,9 @@ static void
 timer_get_prev_entries(uint64_t time_val, unsigned tim_lcore,
 		struct rte_timer **prev)
 {
-	unsigned lvl = priv_timer[tim_lcore].curr_skiplist_depth;
-	prev[lvl] = &priv_timer[tim_lcore].pending_head;
+	struct priv_timer *priv_tim = lcore_priv_timer(tim_lcore);
+	unsigned lvl = priv_tim->curr_skiplist_depth;
+	prev[lvl] = &priv_tim->pending_head;
 	while(lvl != 0) {
 		lvl--;
 		prev[lvl] = prev[lvl+1];
@@ -258,12 +275,13 @@ static void
 timer_get_prev_entries_for_node(struct rte_timer *tim, unsigned tim_lcore,
 		struct rte_timer **prev)
 {
+	struct priv_timer *priv_tim = lcore_priv_timer(tim_lcore);
 	int i;
 	/* to get a specific entry in the list, look for just lower than the time
 	 * values, and then increment on each level individually if necessary
 	 */
 	timer_get_prev_entries(tim->expire - 1, tim_lcore, prev);
-	for (i = priv_timer[tim_lcore].curr_skiplist_depth - 1; i >= 0; i--) {
+	for (i = priv_tim->curr_skiplist_depth - 1; i >= 0; i--) {
 		while (prev[i]->sl_next[i] != NULL &&
 				prev[i]->sl_next[i] != tim &&
 				prev[i]->sl_next[i]->expire <= tim->expire)
@@ -280,6 +298,7 @@ static void
 timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
 {
 	unsigned lcore_id = rte_lcore_id();
+	struct priv_timer *priv_tim = lcore_priv_timer(tim_lcore);
 	unsigned lvl;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
@@ -287,7 +306,7 @@ timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
 	 * lock the list; if it is on local core, we need to lock if
 	 * we are not called from rte_timer_manage() */
 	if (tim_lcore != lcore_id || !local_is_locked)
-		rte_spinlock_lock(&priv_timer[tim_lcore].list_lock);
+		rte_spinlock_lock(&priv_tim->list_lock);
 
 	/* find where exactly this element goes in the list of elements
 	 * for each depth. */
@@ -295,9 +314,9 @@ timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
 
 	/* now assign it a new level and add at that level */
 	const unsigned tim_level = timer_get_skiplist_level(
-			priv_timer[tim_lcore].curr_skiplist_depth);
-	if (tim_level == priv_timer[tim_lcore].curr_skiplist_depth)
-		priv_timer[tim_lcore].curr_skiplist_depth++;
+			priv_tim->curr_skiplist_depth);
+	if (tim_level == priv_tim->curr_skiplist_depth)
+		priv_tim->curr_skiplist_depth++;
 
 	lvl = tim_level;
 	while (lvl > 0) {
@@ -310,11 +329,11 @@ timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
 
 	/* save the lowest list entry into the expire field of the dummy hdr
 	 * NOTE: this is not atomic on 32-bit*/
-	priv_timer[tim_lcore].pending_head.expire = priv_timer[tim_lcore].\
-			pending_head.sl_next[0]->expire;
+	priv_tim->pending_head.expire =
+			priv_tim->pending_head.sl_next[0]->expire;
 
 	if (tim_lcore != lcore_id || !local_is_locked)
-		rte_spinlock_unlock(&priv_timer[tim_lcore].list_lock);
+		rte_spinlock_unlock(&priv_tim->list_lock);
 }
 
 /*
@@ -328,6 +347,7 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 {
 	unsigned lcore_id = rte_lcore_id();
 	unsigned prev_owner = prev_status.owner;
+	struct priv_timer *priv_tim = lcore_priv_timer(prev_owner);
 	int i;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
@@ -335,30 +355,30 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 	 * list; if it is on local core, we need to lock if we are not
 	 * called from rte_timer_manage() */
 	if (prev_owner != lcore_id || !local_is_locked)
-		rte_spinlock_lock(&priv_timer[prev_owner].list_lock);
+		rte_spinlock_lock(&priv_tim->list_lock);
 
 	/* save the lowest list entry into the expire field of the dummy hdr.
 	 * NOTE: this is not atomic on 32-bit */
-	if (tim == priv_timer[prev_owner].pending_head.sl_next[0])
-		priv_timer[prev_owner].pending_head.expire =
+	if (tim == priv_tim->pending_head.sl_next[0])
+		priv_tim->pending_head.expire =
 				((tim->sl_next[0] == NULL) ? 0 : tim->sl_next[0]->expire);
 
 	/* adjust pointers from previous entries to point past this */
 	timer_get_prev_entries_for_node(tim, prev_owner, prev);
-	for (i = priv_timer[prev_owner].curr_skiplist_depth - 1; i >= 0; i--) {
+	for (i = priv_tim->curr_skiplist_depth - 1; i >= 0; i--) {
 		if (prev[i]->sl_next[i] == tim)
 			prev[i]->sl_next[i] = tim->sl_next[i];
 	}
 
 	/* in case we deleted last entry at a level, adjust down max level */
-	for (i = priv_timer[prev_owner].curr_skiplist_depth - 1; i >= 0; i--)
-		if (priv_timer[prev_owner].pending_head.sl_next[i] == NULL)
-			priv_timer[prev_owner].curr_skiplist_depth --;
+	for (i = priv_tim->curr_skiplist_depth - 1; i >= 0; i--)
+		if (priv_tim->pending_head.sl_next[i] == NULL)
+			priv_tim->curr_skiplist_depth --;
 		else
 			break;
 
 	if (prev_owner != lcore_id || !local_is_locked)
-		rte_spinlock_unlock(&priv_timer[prev_owner].list_lock);
+		rte_spinlock_unlock(&priv_tim->list_lock);
 }
 
 /* Reset and start the timer associated with the timer handle (private func) */
@@ -377,9 +397,9 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 		if (lcore_id < RTE_MAX_LCORE) {
 			/* EAL thread with valid lcore_id */
 			tim_lcore = rte_get_next_lcore(
-				priv_timer[lcore_id].prev_lcore,
+				lcore_priv_timer(lcore_id)->prev_lcore,
 				0, 1);
-			priv_timer[lcore_id].prev_lcore = tim_lcore;
+			lcore_priv_timer(lcore_id)->prev_lcore = tim_lcore;
 		} else
 			/* non-EAL thread do not run rte_timer_manage(),
 			 * so schedule the timer on the first enabled lcore. */
@@ -395,7 +415,7 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 	__TIMER_STAT_ADD(reset, 1);
 	if (prev_status.state == RTE_TIMER_RUNNING &&
 	    lcore_id < RTE_MAX_LCORE) {
-		priv_timer[lcore_id].updated = 1;
+		lcore_priv_timer(lcore_id)->updated = 1;
 	}
 
 	/* remove it from list */
@@ -472,7 +492,7 @@ rte_timer_stop(struct rte_timer *tim)
 	__TIMER_STAT_ADD(stop, 1);
 	if (prev_status.state == RTE_TIMER_RUNNING &&
 	    lcore_id < RTE_MAX_LCORE) {
-		priv_timer[lcore_id].updated = 1;
+		lcore_priv_timer(lcore_id)->updated = 1;
 	}
 
 	/* remove it from list */
@@ -512,16 +532,18 @@ void rte_timer_manage(void)
 	struct rte_timer *tim, *next_tim;
 	struct rte_timer *run_first_tim, **pprev;
 	unsigned lcore_id = rte_lcore_id();
+	struct priv_timer *priv_tim;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH + 1];
 	uint64_t cur_time;
 	int i, ret;
 
 	/* timer manager only runs on EAL thread with valid lcore_id */
 	assert(lcore_id < RTE_MAX_LCORE);
+	priv_tim = lcore_priv_timer(lcore_id);
 
 	__TIMER_STAT_ADD(manage, 1);
 	/* optimize for the case where per-cpu list is empty */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL)
+	if (priv_tim->pending_head.sl_next[0] == NULL)
 		return;
 	cur_time = rte_get_timer_cycles();
 
@@ -529,32 +551,32 @@ void rte_timer_manage(void)
 	/* on 64-bit the value cached in the pending_head.expired will be
 	 * updated atomically, so we can consult that for a quick check here
 	 * outside the lock */
-	if (likely(priv_timer[lcore_id].pending_head.expire > cur_time))
+	if (likely(priv_tim->pending_head.expire > cur_time))
 		return;
 #endif
 
 	/* browse ordered list, add expired timers in 'expired' list */
-	rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+	rte_spinlock_lock(&priv_tim->list_lock);
 
 	/* if nothing to do just unlock and return */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL ||
-	    priv_timer[lcore_id].pending_head.sl_next[0]->expire > cur_time) {
-		rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+	if (priv_tim->pending_head.sl_next[0] == NULL ||
+	    priv_tim->pending_head.sl_next[0]->expire > cur_time) {
+		rte_spinlock_unlock(&priv_tim->list_lock);
 		return;
 	}
 
 	/* save start of list of expired timers */
-	tim = priv_timer[lcore_id].pending_head.sl_next[0];
+	tim = priv_tim->pending_head.sl_next[0];
 
 	/* break the existing list at current time point */
 	timer_get_prev_entries(cur_time, lcore_id, prev);
-	for (i = priv_timer[lcore_id].curr_skiplist_depth -1; i >= 0; i--) {
-		if (prev[i] == &priv_timer[lcore_id].pending_head)
+	for (i = priv_tim->curr_skiplist_depth -1; i >= 0; i--) {
+		if (prev[i] == &priv_tim->pending_head)
 			continue;
-		priv_timer[lcore_id].pending_head.sl_next[i] =
+		priv_tim->pending_head.sl_next[i] =
 		    prev[i]->sl_next[i];
 		if (prev[i]->sl_next[i] == NULL)
-			priv_timer[lcore_id].curr_skiplist_depth--;
+			priv_tim->curr_skiplist_depth--;
 		prev[i] ->sl_next[i] = NULL;
 	}
 
@@ -577,17 +599,17 @@ void rte_timer_manage(void)
 	}
 
 	/* update the next to expire timer value */
-	priv_timer[lcore_id].pending_head.expire =
-	    (priv_timer[lcore_id].pending_head.sl_next[0] == NULL) ? 0 :
-		priv_timer[lcore_id].pending_head.sl_next[0]->expire;
+	priv_tim->pending_head.expire =
+	    (priv_tim->pending_head.sl_next[0] == NULL) ? 0 :
+		priv_tim->pending_head.sl_next[0]->expire;
 
-	rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+	rte_spinlock_unlock(&priv_tim->list_lock);
 
 	/* now scan expired list and call callbacks */
 	for (tim = run_first_tim; tim != NULL; tim = next_tim) {
 		next_tim = tim->sl_next[0];
-		priv_timer[lcore_id].updated = 0;
-		priv_timer[lcore_id].running_tim = tim;
+		priv_tim->updated = 0;
+		priv_tim->running_tim = tim;
 
 		/* execute callback function with list unlocked */
 		tim->f(tim, tim->arg);
@@ -595,7 +617,7 @@ void rte_timer_manage(void)
 		__TIMER_STAT_ADD(pending, -1);
 		/* the timer was stopped or reloaded by the callback
 		 * function, we have nothing to do here */
-		if (priv_timer[lcore_id].updated == 1)
+		if (priv_tim->updated == 1)
 			continue;
 
 		if (tim->period == 0) {
@@ -607,7 +629,7 @@ void rte_timer_manage(void)
 		}
 		else {
 			/* keep it in list and mark timer as pending */
-			rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+			rte_spinlock_lock(&priv_tim->list_lock);
 			status.state = RTE_TIMER_PENDING;
 			__TIMER_STAT_ADD(pending, 1);
 			status.owner = (int16_t)lcore_id;
@@ -615,10 +637,10 @@ void rte_timer_manage(void)
 			tim->status.u32 = status.u32;
 			__rte_timer_reset(tim, tim->expire + tim->period,
 				tim->period, lcore_id, tim->f, tim->arg, 1);
-			rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+			rte_spinlock_unlock(&priv_tim->list_lock);
 		}
 	}
-	priv_timer[lcore_id].running_tim = NULL;
+	priv_tim->running_tim = NULL;
 }
 
 /* dump statistics about timers */
@@ -626,14 +648,15 @@ void rte_timer_dump_stats(FILE *f)
 {
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 	struct rte_timer_debug_stats sum;
+	const struct priv_timer *priv_tim;
 	unsigned lcore_id;
 
 	memset(&sum, 0, sizeof(sum));
-	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
-		sum.reset += priv_timer[lcore_id].stats.reset;
-		sum.stop += priv_timer[lcore_id].stats.stop;
-		sum.manage += priv_timer[lcore_id].stats.manage;
-		sum.pending += priv_timer[lcore_id].stats.pending;
+	RTE_LCORE_VAR_FOREACH(lcore_id, priv_tim, priv_timer) {
+		sum.reset += priv_tim->stats.reset;
+		sum.stop += priv_tim->stats.stop;
+		sum.manage += priv_tim->stats.manage;
+		sum.pending += priv_tim->stats.pending;
 	}
 	fprintf(f, "Timer statistics:\n");
 	fprintf(f, "  reset = %"PRIu64"\n", sum.reset);
@@ -95,6 +95,7 @@ do_recursive_call(void)
 			{ "test_memory_flags", no_action },
 			{ "test_file_prefix", no_action },
 			{ "test_no_huge_flag", no_action },
+			{ "test_eal_init_perf", no_action },
 	};
 
 	if (recursive_call == NULL)
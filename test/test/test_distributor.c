@@ -587,6 +587,110 @@ int test_error_distributor_create_numworkers(void)
 }
 
 
+#define MIGRATE_FLOWS 8 /* one burst of flows */
+
+/* Poll a burst on a worker and check it holds the expected packets. */
+static int
+poll_and_check(struct rte_distributor *d, unsigned int worker_id,
+		struct rte_mbuf **pkts, struct rte_mbuf **expected,
+		int nb_expected)
+{
+	int i, n;
+
+	n = rte_distributor_poll_pkt(d, worker_id, pkts);
+	if (n != nb_expected) {
+		printf("Worker %u got %d packets, expected %d\n",
+				worker_id, n, nb_expected);
+		return -1;
+	}
+	for (i = 0; i < n && expected != NULL; i++)
+		if (pkts[i] != expected[i]) {
+			printf("Worker %u got an unexpected packet\n",
+					worker_id);
+			return -1;
+		}
+	return 0;
+}
+
+/*
+ * Drive the two workers of a load aware distributor from this thread.
+ * Worker 1 does not poll, so that the flows queued on it migrate to
+ * worker 0 once it is idle. The next packets of these flows must follow
+ * them, and not go to worker 1 where they were queued first.
+ */
+static int
+test_flow_migration(struct rte_mempool *p)
+{
+	static struct rte_distributor *d;
+	static unsigned int run;
+	struct rte_mbuf *bufs[3 * MIGRATE_FLOWS];
+	struct rte_mbuf *pkts[MIGRATE_FLOWS];
+	struct rte_mbuf **migrated;
+	unsigned int i;
+	int ret = -1;
+
+	printf("=== Flow migration test (load aware burst) ===\n");
+	if (d == NULL) {
+		d = rte_distributor_create("Test_dist_migrate",
+				rte_socket_id(), 2,
+				RTE_DIST_ALG_BURST_LOAD_AWARE);
+		if (d == NULL) {
+			printf("Error creating load aware burst distributor\n");
+			return -1;
+		}
+	}
+
+	if (rte_mempool_get_bulk(p, (void *)bufs, 3 * MIGRATE_FLOWS) != 0) {
+		printf("line %d: Error getting mbufs from pool\n", __LINE__);
+		return -1;
+	}
+	/* new flows on each run, the tags of the last one may be cached */
+	for (i = 0; i < 2 * MIGRATE_FLOWS; i++)
+		bufs[i]->hash.usr = (run * 2 * MIGRATE_FLOWS + i) << 1;
+	run++;
+
+	/* one burst of new flows for each worker, queued on worker 1 */
+	if (poll_and_check(d, 0, pkts, NULL, 0) < 0)
+		goto out;
+	rte_distributor_process(d, bufs, 2 * MIGRATE_FLOWS);
+	if (poll_and_check(d, 0, pkts, NULL, MIGRATE_FLOWS) < 0)
+		goto out;
+	migrated = (pkts[0] == bufs[0]) ? &bufs[MIGRATE_FLOWS] : &bufs[0];
+	rte_distributor_request_pkt(d, 0, pkts, MIGRATE_FLOWS);
+
+	/* worker 0 is idle: it takes the flows of worker 1 */
+	rte_distributor_process(d, NULL, 0);
+
+	/* more packets of the migrated flows */
+	for (i = 0; i < MIGRATE_FLOWS; i++)
+		bufs[2 * MIGRATE_FLOWS + i]->hash.usr = migrated[i]->hash.usr;
+	rte_distributor_process(d, &bufs[2 * MIGRATE_FLOWS], MIGRATE_FLOWS);
+
+	if (poll_and_check(d, 0, pkts, migrated, MIGRATE_FLOWS) < 0 ||
+			poll_and_check(d, 1, pkts, NULL, 0) < 0)
+		goto out;
+	rte_distributor_request_pkt(d, 0, migrated, MIGRATE_FLOWS);
+	rte_distributor_request_pkt(d, 1, NULL, 0);
+	rte_distributor_process(d, NULL, 0);
+
+	if (poll_and_check(d, 0, pkts, &bufs[2 * MIGRATE_FLOWS],
+				MIGRATE_FLOWS) < 0 ||
+			poll_and_check(d, 1, pkts, NULL, 0) < 0)
+		goto out;
+
+	printf("Flow migration test passed\n\n");
+	ret = 0;
+out:
+	/* leave both workers with an empty burst to poll */
+	rte_distributor_request_pkt(d, 0, NULL, 0);
+	rte_distributor_request_pkt(d, 1, NULL, 0);
+	rte_distributor_process(d, NULL, 0);
+	while (rte_distributor_returned_pkts(d, pkts, MIGRATE_FLOWS) > 0)
+		;
+	rte_mempool_put_bulk(p, (void *)bufs, 3 * MIGRATE_FLOWS);
+	return ret;
+}
+
 /* Useful function which ensures that all worker functions terminate */
 static void
 quit_workers(struct worker_params *wp, struct rte_mempool *p)
@@ -617,7 +721,8 @@ test_distributor(void)
 {
 	static struct rte_distributor *ds;
 	static struct rte_distributor *db;
-	static struct rte_distributor *dist[2];
+	static struct rte_distributor *dl;
+	static struct rte_distributor *dist[3];
 	static struct rte_mempool *p;
 	int i;
 
@@ -639,6 +744,19 @@ test_distributor(void)
 		rte_distributor_clear_returns(db);
 	}
 
+	if (dl == NULL) {
+		dl = rte_distributor_create("Test_dist_load", rte_socket_id(),
+				rte_lcore_count() - 1,
+				RTE_DIST_ALG_BURST_LOAD_AWARE);
+		if (dl == NULL) {
+			printf("Error creating load aware burst distributor\n");
+			return -1;
+		}
+	} else {
+		rte_distributor_flush(dl);
+		rte_distributor_clear_returns(dl);
+	}
+
 	if (ds == NULL) {
 		ds = rte_distributor_create("Test_dist_single",
 				rte_socket_id(),
@@ -666,11 +784,14 @@ test_distributor(void)
 
 	dist[0] = ds;
 	dist[1] = db;
+	dist[2] = dl;
 
-	for (i = 0; i < 2; i++) {
+	for (i = 0; i < 3; i++) {
 
 		worker_params.dist = dist[i];
-		if (i)
+		if (i == 2)
+			sprintf(worker_params.name, "load aware burst");
+		else if (i)
 			sprintf(worker_params.name, "burst");
 		else
 			sprintf(worker_params.name, "single");
@@ -710,6 +831,9 @@ test_distributor(void)
 
 	}
 
+	if (test_flow_migration(p) < 0)
+		return -1;
+
 	if (test_error_distributor_create_numworkers() == -1 ||
 			test_error_distributor_create_name() == -1) {
 		printf("rte_distributor_create parameter check tests failed");
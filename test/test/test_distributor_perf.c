@@ -43,6 +43,9 @@
 
 #define ITER_POWER_CL 25 /* log 2 of how many iterations  for Cache Line test */
 #define ITER_POWER 21 /* log 2 of how many iterations we do when timing. */
+#define ITER_POWER_SKEWED 15 /* log 2 of iterations for skewed cost test */
+#define FAST_WORKER_COST 200 /* cycles per packet, skewed cost test */
+#define SLOW_WORKER_COST (10 * FAST_WORKER_COST)
 #define BURST 64
 #define BIG_BATCH 1024
 
@@ -156,6 +159,37 @@ handle_work(void *arg)
 	return 0;
 }
 
+/*
+ * Worker function for the skewed cost test: each packet takes some cycles
+ * to process, and worker 0 is ten times slower than the other ones.
+ */
+static int
+handle_work_skewed(void *arg)
+{
+	struct rte_distributor *d = arg;
+	unsigned int num = 0;
+	int i;
+	unsigned int id = __sync_fetch_and_add(&worker_idx, 1);
+	const uint64_t cost = (id == 0) ? SLOW_WORKER_COST : FAST_WORKER_COST;
+	struct rte_mbuf *buf[8] __rte_cache_aligned;
+
+	for (i = 0; i < 8; i++)
+		buf[i] = NULL;
+
+	num = rte_distributor_get_pkt(d, id, buf, buf, num);
+	while (!quit) {
+		const uint64_t end = rte_rdtsc() + cost * num;
+
+		while (rte_rdtsc() < end)
+			rte_pause();
+		worker_stats[id].handled_packets += num;
+		num = rte_distributor_get_pkt(d, id, buf, buf, num);
+	}
+	worker_stats[id].handled_packets += num;
+	rte_distributor_return_pkt(d, id, buf, num);
+	return 0;
+}
+
 /*
  * This basic performance test just repeatedly sends in 32 packets at a time
  * to the distributor and verifies at the end that we got them all in the worker
@@ -204,6 +238,54 @@ perf_test(struct rte_distributor *d, struct rte_mempool *p)
 	return 0;
 }
 
+/*
+ * Performance test with skewed processing costs (see handle_work_skewed).
+ * As the time is dominated by the workers, it is measured until all the
+ * packets have been handled rather than only while they are distributed.
+ */
+static inline int
+perf_test_skewed(struct rte_distributor *d, struct rte_mempool *p)
+{
+	unsigned int i;
+	uint64_t start, end;
+	struct rte_mbuf *bufs[BURST];
+
+	clear_packet_count();
+	if (rte_mempool_get_bulk(p, (void *)bufs, BURST) != 0) {
+		printf("Error getting mbufs from pool\n");
+		return -1;
+	}
+	/* ensure we have different hash value for each pkt */
+	for (i = 0; i < BURST; i++)
+		bufs[i]->hash.usr = i;
+
+	start = rte_rdtsc();
+	for (i = 0; i < (1<<ITER_POWER_SKEWED); i++)
+		rte_distributor_process(d, bufs, BURST);
+
+	do {
+		rte_distributor_process(d, NULL, 0);
+	} while (total_packet_count() < (BURST << ITER_POWER_SKEWED));
+	end = rte_rdtsc();
+
+	rte_distributor_clear_returns(d);
+
+	printf("Time per burst:  %"PRIu64"\n",
+			(end - start) >> ITER_POWER_SKEWED);
+	printf("Time per packet: %"PRIu64"\n\n",
+			((end - start) >> ITER_POWER_SKEWED)/BURST);
+	rte_mempool_put_bulk(p, (void *)bufs, BURST);
+
+	for (i = 0; i < rte_lcore_count() - 1; i++)
+		printf("Worker %u handled %u packets\n", i,
+				worker_stats[i].handled_packets);
+	printf("Total packets: %u (%x)\n", total_packet_count(),
+			total_packet_count());
+	printf("=== Perf test done ===\n\n");
+
+	return 0;
+}
+
 /* Useful function which ensures that all worker functions terminate */
 static void
 quit_workers(struct rte_distributor *d, struct rte_mempool *p)
@@ -232,6 +314,7 @@ test_distributor_perf(void)
 {
 	static struct rte_distributor *ds;
 	static struct rte_distributor *db;
+	static struct rte_distributor *dl;
 	static struct rte_mempool *p;
 
 	if (rte_lcore_count() < 2) {
@@ -266,6 +349,18 @@ test_distributor_perf(void)
 		rte_distributor_clear_returns(db);
 	}
 
+	if (dl == NULL) {
+		dl = rte_distributor_create("Test_burst_load", rte_socket_id(),
+				rte_lcore_count() - 1,
+				RTE_DIST_ALG_BURST_LOAD_AWARE);
+		if (dl == NULL) {
+			printf("Error creating load aware burst distributor\n");
+			return -1;
+		}
+	} else {
+		rte_distributor_clear_returns(dl);
+	}
+
 	const unsigned nb_bufs = (511 * rte_lcore_count()) < BIG_BATCH ?
 			(BIG_BATCH * 2) - 1 : (511 * rte_lcore_count());
 	if (p == NULL) {
@@ -289,6 +384,24 @@ test_distributor_perf(void)
 		return -1;
 	quit_workers(db, p);
 
+	printf("=== Performance test of distributor (load aware mode) ===\n");
+	rte_eal_mp_remote_launch(handle_work, dl, SKIP_MASTER);
+	if (perf_test(dl, p) < 0)
+		return -1;
+	quit_workers(dl, p);
+
+	printf("=== Skewed cost test of distributor (burst mode) ===\n");
+	rte_eal_mp_remote_launch(handle_work_skewed, db, SKIP_MASTER);
+	if (perf_test_skewed(db, p) < 0)
+		return -1;
+	quit_workers(db, p);
+
+	printf("=== Skewed cost test of distributor (load aware mode) ===\n");
+	rte_eal_mp_remote_launch(handle_work_skewed, dl, SKIP_MASTER);
+	if (perf_test_skewed(dl, p) < 0)
+		return -1;
+	quit_workers(dl, p);
+
 	return 0;
 }
 
@@ -0,0 +1,201 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_debug.h>
+
+#include "test.h"
+#include "process.h"
+
+/*
+ * EAL init
+ * ========
+ *
+ * Measures the time taken by a primary process to initialize the EAL,
+ * hugepage mapping included, for increasing amounts of memory, with a
+ * single thread and with the default number of threads mapping hugepages
+ * (see --huge-init-threads).
+ *
+ * All free hugepages are mapped at init before the unneeded ones are
+ * released, so init time depends on the number of free hugepages in the
+ * system rather than on the amount of memory requested. For each memory
+ * size, the test keeps all the other free hugepages busy while the
+ * process is launched, so that the EAL finds and maps exactly the amount
+ * of memory requested.
+ */
+
+#define INIT_PERF_PREFIX "--file-prefix=initperf"
+
+/* memory sizes to request, in MB, as long as enough hugepages are free */
+static const unsigned int mem_sizes[] = {
+	16, 64, 256, 1024, 4096, 16384, 65536
+};
+
+/*
+ * Get the amount of free hugepage memory of the default size, in MB, and
+ * the default hugepage size, in kB.
+ */
+static uint64_t
+get_free_hugepage_mem(uint64_t *hugepage_kb)
+{
+	char line[256];
+	uint64_t nr_free = 0, page_kb = 0;
+	FILE *f;
+
+	f = fopen("/proc/meminfo", "r");
+	if (f == NULL)
+		return 0;
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (sscanf(line, "HugePages_Free: %" SCNu64, &nr_free) == 1)
+			continue;
+		sscanf(line, "Hugepagesize: %" SCNu64, &page_kb);
+	}
+	fclose(f);
+
+	*hugepage_kb = page_kb;
+	return nr_free * page_kb / 1024;
+}
+
+/*
+ * Map and fault in len bytes of hugepages of the default size, so that
+ * they are not free anymore. Return the mapping, or MAP_FAILED on error.
+ */
+static void *
+hold_hugepage_mem(size_t len)
+{
+#ifdef RTE_EXEC_ENV_BSDAPP
+	RTE_SET_USED(len);
+	return MAP_FAILED;
+#else
+	return mmap(NULL, len, PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE,
+		-1, 0);
+#endif
+}
+
+/*
+ * Launch a primary process requesting mem_mb MB with the given hugepage
+ * mapping options, with only mem_mb MB (rounded up to hugepages of
+ * page_kb kB) of the free_mb MB of free hugepage memory left free, and
+ * return the time it took to init and exit, in ms, or -1 on error.
+ */
+static double
+eal_init_time(unsigned int mem_mb, uint64_t free_mb, uint64_t page_kb,
+	const char *threads_opt)
+{
+	char mem[16];
+	const char *argv[] = {prgname, "-c", "1", "-n", "2", "-m", mem,
+			INIT_PERF_PREFIX, "--huge-unlink", threads_opt};
+	int nb_args = RTE_DIM(argv);
+	size_t hold_len = RTE_ALIGN_FLOOR((free_mb - mem_mb) << 20,
+		page_kb << 10);
+	void *hold = NULL;
+	uint64_t start, end;
+	int ret;
+
+	snprintf(mem, sizeof(mem), "%u", mem_mb);
+	if (threads_opt == NULL)
+		nb_args--;
+
+	if (hold_len != 0) {
+		hold = hold_hugepage_mem(hold_len);
+		if (hold == MAP_FAILED) {
+			printf("Cannot hold %zu MB of hugepages\n",
+				hold_len >> 20);
+			return -1;
+		}
+	}
+
+	start = rte_get_timer_cycles();
+	ret = process_dup(argv, nb_args, "test_eal_init_perf");
+	end = rte_get_timer_cycles();
+
+	if (hold != NULL)
+		munmap(hold, hold_len);
+	if (ret != 0)
+		return -1;
+
+	return (double)(end - start) * 1000 / rte_get_timer_hz();
+}
+
+static int
+test_eal_init_perf(void)
+{
+	double serial, parallel;
+	uint64_t free_mem, page_kb;
+	unsigned int i;
+
+#ifdef RTE_EXEC_ENV_BSDAPP
+	printf("EAL init performance test is not supported on BSD\n");
+	return 0;
+#endif
+
+	free_mem = get_free_hugepage_mem(&page_kb);
+	printf("Free hugepage memory: %" PRIu64 " MB\n", free_mem);
+
+	printf("\n### EAL init time (ms) ###\n");
+	printf("%-12s%-16s%-16s\n", "memory (MB)", "1 thread", "default");
+	for (i = 0; i < RTE_DIM(mem_sizes); i++) {
+		if (mem_sizes[i] > free_mem)
+			break;
+
+		serial = eal_init_time(mem_sizes[i], free_mem, page_kb,
+			"--huge-init-threads=1");
+		parallel = eal_init_time(mem_sizes[i], free_mem, page_kb,
+			NULL);
+		if (serial < 0 || parallel < 0) {
+			printf("Error - EAL init failed with %u MB\n",
+				mem_sizes[i]);
+			return -1;
+		}
+		printf("%-12u%-16.1f%-16.1f\n", mem_sizes[i], serial, parallel);
+	}
+
+	if (i == 0) {
+		printf("Not enough free hugepages to run the test\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(eal_init_perf_autotest, test_eal_init_perf);
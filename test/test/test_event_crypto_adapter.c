@@ -0,0 +1,586 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_vdev.h>
+#include <rte_service.h>
+#include <rte_crypto.h>
+#include <rte_cryptodev.h>
+#include <rte_eventdev.h>
+#include <rte_event_crypto_adapter.h>
+
+#include "test.h"
+
+#define TEST_ADAPTER_ID 0
+#define NB_QPS 2
+#define NB_DESC 128
+#define NB_OPS 256
+#define NB_REQS 64
+#define BURST_SIZE 32
+#define APP_QUEUE 0     /* responses, linked to the worker port 0 */
+#define REQ_QUEUE 1     /* requests, linked to the adapter port */
+#define RUN_MS 1000
+
+static int evdev;
+static int cdev;
+static struct rte_mempool *op_pool;
+static struct rte_mempool *mbuf_pool;
+static struct rte_cryptodev_sym_session *sess;
+static struct rte_crypto_op *ops[NB_REQS];
+static unsigned int received[NB_REQS];
+
+static const struct rte_event_port_conf adapter_port_conf = {
+	.new_event_threshold = 4096,
+	.dequeue_depth = 32,
+	.enqueue_depth = 64,
+};
+
+static int
+testsuite_setup(void)
+{
+	struct rte_cryptodev_config conf = {
+		.socket_id = SOCKET_ID_ANY,
+		.nb_queue_pairs = NB_QPS,
+		.session_mp = {
+			.nb_objs = 16,
+			.cache_size = 0,
+		},
+	};
+	struct rte_cryptodev_qp_conf qp_conf = {
+		.nb_descriptors = NB_DESC,
+	};
+	struct rte_crypto_sym_xform auth_xform = {
+		.type = RTE_CRYPTO_SYM_XFORM_AUTH,
+		.auth = {
+			.algo = RTE_CRYPTO_AUTH_NULL,
+			.op = RTE_CRYPTO_AUTH_OP_GENERATE,
+		},
+	};
+	struct rte_crypto_sym_xform cipher_xform = {
+		.type = RTE_CRYPTO_SYM_XFORM_CIPHER,
+		.next = &auth_xform,
+		.cipher = {
+			.algo = RTE_CRYPTO_CIPHER_NULL,
+			.op = RTE_CRYPTO_CIPHER_OP_ENCRYPT,
+		},
+	};
+	uint16_t qp;
+
+	if (rte_vdev_init("event_sw_eca", NULL) < 0 ||
+			rte_vdev_init("crypto_null_eca", NULL) < 0) {
+		printf("Cannot create event_sw or crypto_null device\n");
+		return -1;
+	}
+	evdev = rte_event_dev_get_dev_id("event_sw_eca");
+	cdev = rte_cryptodev_get_dev_id("crypto_null_eca");
+	if (evdev < 0 || cdev < 0) {
+		printf("Cannot find event_sw or crypto_null device\n");
+		return -1;
+	}
+
+	if (rte_cryptodev_configure(cdev, &conf) < 0) {
+		printf("Cannot configure crypto_null device\n");
+		return -1;
+	}
+	for (qp = 0; qp < NB_QPS; qp++) {
+		if (rte_cryptodev_queue_pair_setup(cdev, qp, &qp_conf,
+				SOCKET_ID_ANY) < 0) {
+			printf("Cannot setup queue pair %u\n", qp);
+			return -1;
+		}
+	}
+	if (rte_cryptodev_start(cdev) < 0) {
+		printf("Cannot start crypto_null device\n");
+		return -1;
+	}
+
+	sess = rte_cryptodev_sym_session_create(cdev, &cipher_xform);
+	op_pool = rte_crypto_op_pool_create("eca_op_pool",
+			RTE_CRYPTO_OP_TYPE_SYMMETRIC, NB_OPS, 0,
+			sizeof(union rte_event_crypto_metadata),
+			rte_socket_id());
+	mbuf_pool = rte_pktmbuf_pool_create("eca_mbuf_pool", NB_OPS, 0, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (sess == NULL || op_pool == NULL || mbuf_pool == NULL) {
+		printf("Cannot create crypto session or pools\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static void
+testsuite_teardown(void)
+{
+	rte_cryptodev_sym_session_free(cdev, sess);
+	rte_cryptodev_stop(cdev);
+	rte_mempool_free(op_pool);
+	rte_mempool_free(mbuf_pool);
+}
+
+/*
+ * The response queue linked to the worker port 0, and the request queue
+ * which the tests in forward mode link to the adapter port. The device is
+ * started by the tests, once the adapter has added its port.
+ */
+static int
+ut_setup(void)
+{
+	const struct rte_event_dev_config config = {
+		.nb_event_queues = 2,
+		.nb_event_ports = 1,
+		.nb_event_queue_flows = 1024,
+		.nb_events_limit = 4096,
+		.nb_event_port_dequeue_depth = 128,
+		.nb_event_port_enqueue_depth = 128,
+	};
+	const struct rte_event_queue_conf queue_conf = {
+		.event_queue_cfg = RTE_EVENT_QUEUE_CFG_ATOMIC_ONLY,
+		.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+		.nb_atomic_flows = 1024,
+		.nb_atomic_order_sequences = 1024,
+	};
+	const struct rte_event_port_conf port_conf = {
+		.new_event_threshold = 4096,
+		.dequeue_depth = 32,
+		.enqueue_depth = 64,
+	};
+	uint8_t queue = APP_QUEUE;
+
+	if (rte_event_dev_configure(evdev, &config) < 0 ||
+			rte_event_queue_setup(evdev, APP_QUEUE,
+				&queue_conf) < 0 ||
+			rte_event_queue_setup(evdev, REQ_QUEUE,
+				&queue_conf) < 0 ||
+			rte_event_port_setup(evdev, 0, &port_conf) < 0 ||
+			rte_event_port_link(evdev, 0, &queue, NULL, 1) != 1) {
+		printf("Cannot setup event device\n");
+		return -1;
+	}
+
+	memset(ops, 0, sizeof(ops));
+	memset(received, 0, sizeof(received));
+	return 0;
+}
+
+static void
+ut_teardown(void)
+{
+	unsigned int i;
+
+	rte_event_crypto_adapter_stop(TEST_ADAPTER_ID);
+	rte_event_crypto_adapter_queue_pair_del(TEST_ADAPTER_ID, cdev, -1);
+	rte_event_crypto_adapter_free(TEST_ADAPTER_ID);
+	rte_event_dev_stop(evdev);
+	rte_event_dev_close(evdev);
+
+	for (i = 0; i < NB_REQS; i++) {
+		if (ops[i] == NULL)
+			continue;
+		rte_pktmbuf_free(ops[i]->sym->m_src);
+		rte_crypto_op_free(ops[i]);
+	}
+}
+
+/* Add the queue pairs and start the adapter and the event device. */
+static int
+adapter_start(int32_t queue_pair_id)
+{
+	uint32_t service_id;
+	uint8_t port_id;
+	uint8_t queue = REQ_QUEUE;
+
+	if (rte_event_crypto_adapter_queue_pair_add(TEST_ADAPTER_ID, cdev,
+				queue_pair_id) < 0 ||
+			rte_event_crypto_adapter_event_port_get(TEST_ADAPTER_ID,
+				&port_id) < 0 ||
+			rte_event_port_link(evdev, port_id, &queue, NULL,
+				1) != 1 ||
+			rte_event_dev_start(evdev) < 0)
+		return -1;
+
+	if (rte_event_crypto_adapter_service_id_get(TEST_ADAPTER_ID,
+				&service_id) < 0 ||
+			rte_service_runstate_set(service_id, 1) < 0)
+		return -1;
+	return rte_event_crypto_adapter_start(TEST_ADAPTER_ID);
+}
+
+/*
+ * Allocate the operations, each one carrying the flow id of its response
+ * event and targeting the queue pairs in turn.
+ */
+static int
+alloc_ops(uint16_t nb_qps)
+{
+	unsigned int i;
+
+	if (rte_crypto_op_bulk_alloc(op_pool, RTE_CRYPTO_OP_TYPE_SYMMETRIC,
+			ops, NB_REQS) != NB_REQS)
+		return -1;
+
+	for (i = 0; i < NB_REQS; i++) {
+		union rte_event_crypto_metadata *md =
+			rte_event_crypto_adapter_metadata(ops[i]);
+		struct rte_mbuf *m = rte_pktmbuf_alloc(mbuf_pool);
+
+		if (md == NULL || m == NULL)
+			return -1;
+		rte_pktmbuf_append(m, 64);
+		ops[i]->sym->m_src = m;
+		rte_crypto_op_attach_sym_session(ops[i], sess);
+
+		memset(md, 0, sizeof(*md));
+		md->response_info.queue_id = APP_QUEUE;
+		md->response_info.sched_type = RTE_SCHED_TYPE_ATOMIC;
+		md->response_info.flow_id = i;
+		md->response_info.sub_event_type = 1;
+		/* overwrites event_ptr of the response */
+		md->request_info.cdev_id = cdev;
+		md->request_info.queue_pair_id = i % nb_qps;
+	}
+	return 0;
+}
+
+/* Enqueue the operations as request events from the worker port. */
+static int
+enqueue_requests(void)
+{
+	struct rte_event ev[BURST_SIZE];
+	unsigned int i, j;
+
+	for (i = 0; i < NB_REQS; i += BURST_SIZE) {
+		for (j = 0; j < BURST_SIZE; j++) {
+			memset(&ev[j], 0, sizeof(ev[j]));
+			ev[j].queue_id = REQ_QUEUE;
+			ev[j].sched_type = RTE_SCHED_TYPE_ATOMIC;
+			ev[j].flow_id = i + j;
+			ev[j].event_type = RTE_EVENT_TYPE_CPU;
+			ev[j].op = RTE_EVENT_OP_NEW;
+			ev[j].event_ptr = ops[i + j];
+		}
+		if (rte_event_enqueue_burst(evdev, 0, ev, BURST_SIZE) !=
+				BURST_SIZE)
+			return -1;
+	}
+	return 0;
+}
+
+/*
+ * Run the adapter service and the event scheduler until the responses of
+ * the NB_REQS operations are received, checking them. Returns the number
+ * of responses received, or -1 if a response is unexpected.
+ */
+static int
+run_until_done(void)
+{
+	uint64_t end = rte_get_timer_cycles() +
+		RUN_MS * rte_get_timer_hz() / 1000;
+	struct rte_event ev[BURST_SIZE];
+	uint32_t service_id;
+	int nb = 0;
+	uint16_t i, n;
+
+	rte_event_crypto_adapter_service_id_get(TEST_ADAPTER_ID, &service_id);
+	while (nb < NB_REQS && rte_get_timer_cycles() < end) {
+		rte_event_schedule(evdev);
+		rte_service_run_iter_on_app_lcore(service_id, 1);
+		n = rte_event_dequeue_burst(evdev, 0, ev, BURST_SIZE, 0);
+		for (i = 0; i < n; i++) {
+			struct rte_crypto_op *op = ev[i].event_ptr;
+			unsigned int idx = ev[i].flow_id;
+
+			if (ev[i].event_type != RTE_EVENT_TYPE_CRYPTODEV ||
+					ev[i].sub_event_type != 1 ||
+					idx >= NB_REQS || op != ops[idx] ||
+					received[idx] != 0 ||
+					op->status !=
+					RTE_CRYPTO_OP_STATUS_SUCCESS)
+				return -1;
+			received[idx] = 1;
+		}
+		nb += n;
+	}
+
+	return nb;
+}
+
+static int
+test_crypto_adapter_create_free(void)
+{
+	struct rte_event_port_conf port_conf = adapter_port_conf;
+	uint8_t port_id;
+
+	TEST_ASSERT(rte_event_crypto_adapter_create(TEST_ADAPTER_ID, evdev,
+			&port_conf, RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD + 1) ==
+			-EINVAL, "Invalid mode accepted");
+	TEST_ASSERT(rte_event_crypto_adapter_create(TEST_ADAPTER_ID, evdev,
+			NULL, RTE_EVENT_CRYPTO_ADAPTER_OP_NEW) == -EINVAL,
+			"NULL port configuration accepted");
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_create(TEST_ADAPTER_ID,
+			evdev, &port_conf, RTE_EVENT_CRYPTO_ADAPTER_OP_NEW),
+			"Cannot create adapter");
+	TEST_ASSERT(rte_event_crypto_adapter_create(TEST_ADAPTER_ID, evdev,
+			&port_conf, RTE_EVENT_CRYPTO_ADAPTER_OP_NEW) ==
+			-EEXIST, "Duplicate adapter created");
+	TEST_ASSERT(rte_event_crypto_adapter_event_port_get(TEST_ADAPTER_ID,
+			&port_id) == -EINVAL,
+			"Event port of an unconfigured adapter");
+
+	TEST_ASSERT(rte_event_crypto_adapter_queue_pair_add(TEST_ADAPTER_ID,
+			cdev, NB_QPS) == -EINVAL,
+			"Invalid queue pair added");
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_queue_pair_add(
+			TEST_ADAPTER_ID, cdev, -1),
+			"Cannot add the queue pairs");
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_event_port_get(
+			TEST_ADAPTER_ID, &port_id), "Cannot get event port");
+	TEST_ASSERT_EQUAL(port_id, 1, "Unexpected event port %u", port_id);
+
+	TEST_ASSERT(rte_event_crypto_adapter_free(TEST_ADAPTER_ID) == -EBUSY,
+			"Adapter with queue pairs freed");
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_queue_pair_del(
+			TEST_ADAPTER_ID, cdev, 0),
+			"Cannot delete queue pair 0");
+	TEST_ASSERT(rte_event_crypto_adapter_queue_pair_del(TEST_ADAPTER_ID,
+			cdev, 0) == -EINVAL, "Queue pair 0 deleted twice");
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_queue_pair_del(
+			TEST_ADAPTER_ID, cdev, -1),
+			"Cannot delete the queue pairs");
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_free(TEST_ADAPTER_ID),
+			"Cannot free adapter");
+	TEST_ASSERT(rte_event_crypto_adapter_free(TEST_ADAPTER_ID) == -EINVAL,
+			"Adapter freed twice");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_crypto_adapter_op_new(void)
+{
+	struct rte_event_port_conf port_conf = adapter_port_conf;
+	struct rte_event_crypto_adapter_stats stats;
+	unsigned int i;
+
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_create(TEST_ADAPTER_ID,
+			evdev, &port_conf, RTE_EVENT_CRYPTO_ADAPTER_OP_NEW),
+			"Cannot create adapter");
+	TEST_ASSERT_SUCCESS(adapter_start(-1), "Cannot start adapter");
+	TEST_ASSERT_SUCCESS(alloc_ops(NB_QPS), "Cannot allocate operations");
+
+	/* the application submits the operations */
+	for (i = 0; i < NB_REQS; i++)
+		TEST_ASSERT_EQUAL(rte_cryptodev_enqueue_burst(cdev,
+				i % NB_QPS, &ops[i], 1), 1,
+				"Cannot enqueue operation %u", i);
+
+	TEST_ASSERT_EQUAL(run_until_done(), NB_REQS,
+			"Unexpected responses");
+
+	rte_event_crypto_adapter_stats_get(TEST_ADAPTER_ID, &stats);
+	TEST_ASSERT_EQUAL(stats.crypto_deq_count, NB_REQS,
+			"Unexpected crypto dequeue count");
+	TEST_ASSERT_EQUAL(stats.event_enq_count, NB_REQS,
+			"Unexpected event enqueue count");
+	TEST_ASSERT_EQUAL(stats.crypto_enq_count, 0,
+			"Operations submitted in new mode");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_crypto_adapter_op_forward(void)
+{
+	struct rte_event_port_conf port_conf = adapter_port_conf;
+	struct rte_event_crypto_adapter_stats stats;
+
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_create(TEST_ADAPTER_ID,
+			evdev, &port_conf, RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD),
+			"Cannot create adapter");
+	TEST_ASSERT_SUCCESS(adapter_start(-1), "Cannot start adapter");
+	TEST_ASSERT_SUCCESS(alloc_ops(NB_QPS), "Cannot allocate operations");
+	TEST_ASSERT_SUCCESS(enqueue_requests(), "Cannot enqueue requests");
+
+	TEST_ASSERT_EQUAL(run_until_done(), NB_REQS,
+			"Unexpected responses");
+
+	rte_event_crypto_adapter_stats_get(TEST_ADAPTER_ID, &stats);
+	TEST_ASSERT_EQUAL(stats.event_deq_count, NB_REQS,
+			"Unexpected event dequeue count");
+	TEST_ASSERT_EQUAL(stats.crypto_enq_count, NB_REQS,
+			"Unexpected crypto enqueue count");
+	TEST_ASSERT_EQUAL(stats.crypto_deq_count, NB_REQS,
+			"Unexpected crypto dequeue count");
+	TEST_ASSERT_EQUAL(stats.event_enq_count, NB_REQS,
+			"Unexpected event enqueue count");
+	TEST_ASSERT_EQUAL(stats.crypto_enq_fail, 0, "Unexpected failures");
+
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_stats_reset(
+			TEST_ADAPTER_ID), "Cannot reset stats");
+	rte_event_crypto_adapter_stats_get(TEST_ADAPTER_ID, &stats);
+	TEST_ASSERT_EQUAL(stats.event_enq_count, 0, "Stats not reset");
+
+	return TEST_SUCCESS;
+}
+
+#define MAX_INFLIGHT 16
+
+/* Use the port 1 set up by the test, with an in-flight limit. */
+static int
+inflight_conf_cb(uint8_t id __rte_unused, uint8_t dev_id,
+		struct rte_event_crypto_adapter_conf *conf,
+		void *arg __rte_unused)
+{
+	struct rte_event_dev_config dev_conf = {
+		.nb_event_queues = 2,
+		.nb_event_ports = 2,
+		.nb_event_queue_flows = 1024,
+		.nb_events_limit = 4096,
+		.nb_event_port_dequeue_depth = 128,
+		.nb_event_port_enqueue_depth = 128,
+	};
+	struct rte_event_port_conf port_conf = adapter_port_conf;
+
+	if (rte_event_dev_configure(dev_id, &dev_conf) < 0 ||
+			rte_event_port_setup(dev_id, 1, &port_conf) < 0)
+		return -1;
+
+	conf->event_port_id = 1;
+	conf->max_nb = 0;
+	conf->max_inflight = MAX_INFLIGHT;
+	return 0;
+}
+
+static int
+test_crypto_adapter_inflight(void)
+{
+	struct rte_event_crypto_adapter_stats stats;
+	uint32_t service_id;
+
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_create_ext(
+			TEST_ADAPTER_ID, evdev, inflight_conf_cb,
+			RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD, NULL),
+			"Cannot create adapter");
+	TEST_ASSERT_SUCCESS(adapter_start(-1), "Cannot start adapter");
+	TEST_ASSERT_SUCCESS(alloc_ops(NB_QPS), "Cannot allocate operations");
+	TEST_ASSERT_SUCCESS(enqueue_requests(), "Cannot enqueue requests");
+
+	/* a single iteration submits up to the limit only */
+	rte_event_schedule(evdev);
+	rte_event_crypto_adapter_service_id_get(TEST_ADAPTER_ID, &service_id);
+	rte_service_run_iter_on_app_lcore(service_id, 1);
+	rte_event_crypto_adapter_stats_get(TEST_ADAPTER_ID, &stats);
+	TEST_ASSERT_EQUAL(stats.crypto_enq_count, MAX_INFLIGHT,
+			"In-flight limit not enforced: %" PRIu64 " submitted",
+			stats.crypto_enq_count);
+
+	TEST_ASSERT_EQUAL(run_until_done(), NB_REQS,
+			"Unexpected responses");
+
+	rte_event_crypto_adapter_stats_get(TEST_ADAPTER_ID, &stats);
+	TEST_ASSERT_EQUAL(stats.crypto_enq_count, NB_REQS,
+			"Unexpected crypto enqueue count");
+
+	return TEST_SUCCESS;
+}
+
+static int
+test_crypto_adapter_invalid_request(void)
+{
+	struct rte_event_port_conf port_conf = adapter_port_conf;
+	struct rte_event_crypto_adapter_stats stats;
+	unsigned int nb_avail;
+	unsigned int i;
+
+	TEST_ASSERT_SUCCESS(rte_event_crypto_adapter_create(TEST_ADAPTER_ID,
+			evdev, &port_conf, RTE_EVENT_CRYPTO_ADAPTER_OP_FORWARD),
+			"Cannot create adapter");
+	/* the requests for the queue pair 1 are dropped */
+	TEST_ASSERT_SUCCESS(adapter_start(0), "Cannot start adapter");
+	nb_avail = rte_mempool_avail_count(op_pool);
+	TEST_ASSERT_SUCCESS(alloc_ops(NB_QPS), "Cannot allocate operations");
+	TEST_ASSERT_SUCCESS(enqueue_requests(), "Cannot enqueue requests");
+
+	TEST_ASSERT_EQUAL(run_until_done(), NB_REQS / 2,
+			"Unexpected responses");
+	for (i = 0; i < NB_REQS; i++) {
+		TEST_ASSERT_EQUAL(received[i], (unsigned int)(i % NB_QPS == 0),
+				"Unexpected response of operation %u", i);
+		/* freed by the adapter */
+		if (i % NB_QPS != 0)
+			ops[i] = NULL;
+	}
+
+	rte_event_crypto_adapter_stats_get(TEST_ADAPTER_ID, &stats);
+	TEST_ASSERT_EQUAL(stats.crypto_enq_fail, NB_REQS / 2,
+			"Unexpected failure count");
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(op_pool),
+			nb_avail - NB_REQS / 2, "Dropped operations not freed");
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite event_crypto_adapter_testsuite = {
+	.suite_name = "event crypto adapter test suite",
+	.setup = testsuite_setup,
+	.teardown = testsuite_teardown,
+	.unit_test_cases = {
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_crypto_adapter_create_free),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_crypto_adapter_op_new),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_crypto_adapter_op_forward),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_crypto_adapter_inflight),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_crypto_adapter_invalid_request),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_event_crypto_adapter(void)
+{
+	return unit_test_suite_runner(&event_crypto_adapter_testsuite);
+}
+
+REGISTER_TEST_COMMAND(event_crypto_adapter_autotest, test_event_crypto_adapter);
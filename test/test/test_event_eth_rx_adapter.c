@@ -0,0 +1,863 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_byteorder.h>
+#include <rte_ethdev.h>
+#include <rte_eth_ring.h>
+#include <rte_thash.h>
+#include <rte_vdev.h>
+#include <rte_service.h>
+#include <rte_eventdev.h>
+#include <rte_event_eth_rx_adapter.h>
+
+#include "test.h"
+
+#define TEST_ADAPTER_ID 0
+#define NB_RX_QUEUES 2
+#define RX_RING_SIZE 1024
+#define NB_MBUFS 4096
+#define TEST_FLOW_ID 7
+#define TEST_RSS_HASH 0x12345
+#define BURST_SIZE 32
+
+static int evdev;
+static uint8_t eth_port;
+static struct rte_ring *rx_rings[NB_RX_QUEUES];
+static struct rte_ring *tx_ring;
+static struct rte_mempool *mbuf_pool;
+
+/* same default key as the adapter */
+static const uint8_t rss_key[40] = {
+	0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2,
+	0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3, 0x8f, 0xb0,
+	0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4,
+	0x77, 0xcb, 0x2d, 0xa3, 0x80, 0x30, 0xf2, 0x0c,
+	0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa,
+};
+
+static int
+testsuite_setup(void)
+{
+	unsigned int i;
+	int ret;
+
+	mbuf_pool = rte_pktmbuf_pool_create("rxa_test_pool", NB_MBUFS, 0, 0,
+			RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (mbuf_pool == NULL) {
+		printf("Cannot create mbuf pool\n");
+		return -1;
+	}
+
+	if (rte_vdev_init("event_sw_rxa", NULL) < 0) {
+		printf("Cannot create event_sw device\n");
+		return -1;
+	}
+	evdev = rte_event_dev_get_dev_id("event_sw_rxa");
+	if (evdev < 0) {
+		printf("Cannot find event_sw device\n");
+		return -1;
+	}
+
+	for (i = 0; i < NB_RX_QUEUES; i++) {
+		char name[RTE_RING_NAMESIZE];
+
+		snprintf(name, sizeof(name), "rxa_rx%u", i);
+		rx_rings[i] = rte_ring_create(name, RX_RING_SIZE,
+				rte_socket_id(), RING_F_SP_ENQ | RING_F_SC_DEQ);
+		if (rx_rings[i] == NULL) {
+			printf("Cannot create ring %s\n", name);
+			return -1;
+		}
+	}
+	tx_ring = rte_ring_create("rxa_tx", RX_RING_SIZE, rte_socket_id(),
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (tx_ring == NULL) {
+		printf("Cannot create Tx ring\n");
+		return -1;
+	}
+
+	ret = rte_eth_from_rings("net_ring_rxa", rx_rings, NB_RX_QUEUES,
+			&tx_ring, 1, rte_socket_id());
+	if (ret < 0) {
+		printf("Cannot create ring port\n");
+		return -1;
+	}
+	eth_port = ret;
+
+	return 0;
+}
+
+/* one load balanced queue linked to one worker port */
+static int
+ut_setup(void)
+{
+	const struct rte_event_dev_config config = {
+		.nb_event_queues = 1,
+		.nb_event_ports = 1,
+		.nb_event_queue_flows = 1024,
+		.nb_events_limit = 4096,
+		.nb_event_port_dequeue_depth = 128,
+		.nb_event_port_enqueue_depth = 128,
+	};
+	const struct rte_event_queue_conf queue_conf = {
+		.event_queue_cfg = RTE_EVENT_QUEUE_CFG_ATOMIC_ONLY,
+		.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+		.nb_atomic_flows = 1024,
+		.nb_atomic_order_sequences = 1024,
+	};
+	const struct rte_event_port_conf port_conf = {
+		.new_event_threshold = 4096,
+		.dequeue_depth = 32,
+		.enqueue_depth = 64,
+	};
+	uint8_t queue = 0;
+
+	if (rte_event_dev_configure(evdev, &config) < 0 ||
+			rte_event_queue_setup(evdev, 0, &queue_conf) < 0 ||
+			rte_event_port_setup(evdev, 0, &port_conf) < 0 ||
+			rte_event_port_link(evdev, 0, &queue, NULL, 1) != 1) {
+		printf("Cannot setup event device\n");
+		return -1;
+	}
+
+	return rte_event_dev_start(evdev);
+}
+
+static void
+ut_teardown(void)
+{
+	struct rte_mbuf *m;
+	unsigned int i;
+
+	rte_event_eth_rx_adapter_stop(TEST_ADAPTER_ID);
+	rte_event_eth_rx_adapter_queue_del(TEST_ADAPTER_ID, eth_port, -1);
+	rte_event_eth_rx_adapter_free(TEST_ADAPTER_ID);
+
+	rte_event_dev_stop(evdev);
+	rte_event_dev_close(evdev);
+
+	for (i = 0; i < NB_RX_QUEUES; i++)
+		while (rte_ring_dequeue(rx_rings[i], (void **)&m) == 0)
+			rte_pktmbuf_free(m);
+}
+
+/* Put IPv4 packets with source addresses src, src + 1, ... in a queue. */
+static int
+inject_packets(unsigned int queue, unsigned int n, uint32_t src,
+		int with_rss)
+{
+	unsigned int i;
+
+	for (i = 0; i < n; i++) {
+		struct rte_mbuf *m = rte_pktmbuf_alloc(mbuf_pool);
+		struct ether_hdr *eth_hdr;
+		struct ipv4_hdr *ipv4_hdr;
+
+		if (m == NULL)
+			return -1;
+
+		eth_hdr = (struct ether_hdr *)rte_pktmbuf_append(m,
+				sizeof(*eth_hdr) + sizeof(*ipv4_hdr));
+		memset(eth_hdr, 0, sizeof(*eth_hdr) + sizeof(*ipv4_hdr));
+		eth_hdr->ether_type = rte_cpu_to_be_16(ETHER_TYPE_IPv4);
+		ipv4_hdr = (struct ipv4_hdr *)(eth_hdr + 1);
+		ipv4_hdr->version_ihl = 0x45;
+		ipv4_hdr->src_addr = rte_cpu_to_be_32(src + i);
+		ipv4_hdr->dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+
+		m->udata64 = queue;
+		if (with_rss) {
+			m->ol_flags |= PKT_RX_RSS_HASH;
+			m->hash.rss = TEST_RSS_HASH;
+		}
+
+		if (rte_ring_enqueue(rx_rings[queue], m) != 0) {
+			rte_pktmbuf_free(m);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/* Run the event scheduler and the worker port until no event comes. */
+static unsigned int
+drain_events(int (*check)(const struct rte_event *ev))
+{
+	struct rte_event ev[BURST_SIZE];
+	unsigned int total = 0;
+	unsigned int idle = 0;
+	uint16_t i, n;
+
+	while (idle < 10) {
+		rte_event_schedule(evdev);
+		n = rte_event_dequeue_burst(evdev, 0, ev, BURST_SIZE, 0);
+		if (n == 0) {
+			idle++;
+			continue;
+		}
+		idle = 0;
+		for (i = 0; i < n; i++) {
+			if (check != NULL && check(&ev[i]) != 0)
+				total |= 1u << 31;
+			rte_pktmbuf_free(ev[i].mbuf);
+		}
+		total += n;
+	}
+
+	return total;
+}
+
+static int
+run_adapter(unsigned int iterations)
+{
+	uint32_t service_id;
+	unsigned int i;
+
+	if (rte_event_eth_rx_adapter_service_id_get(TEST_ADAPTER_ID,
+			&service_id) < 0)
+		return -1;
+	for (i = 0; i < iterations; i++)
+		if (rte_service_run_iter_on_app_lcore(service_id, 1) < 0)
+			return -1;
+	return 0;
+}
+
+static int
+test_rx_adapter_create_free(void)
+{
+	struct rte_event_port_conf port_conf = {
+		.new_event_threshold = 1024,
+		.dequeue_depth = 32,
+		.enqueue_depth = 64,
+	};
+	uint32_t service_id;
+	int ret;
+
+	ret = rte_event_eth_rx_adapter_create(
+			RTE_EVENT_ETH_RX_ADAPTER_MAX_INSTANCE, evdev, &port_conf);
+	TEST_ASSERT(ret == -EINVAL, "Adapter created with invalid id");
+	ret = rte_event_eth_rx_adapter_create(TEST_ADAPTER_ID, evdev, NULL);
+	TEST_ASSERT(ret == -EINVAL, "Adapter created without port conf");
+
+	ret = rte_event_eth_rx_adapter_create(TEST_ADAPTER_ID, evdev,
+			&port_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot create adapter: %d", ret);
+	ret = rte_event_eth_rx_adapter_create(TEST_ADAPTER_ID, evdev,
+			&port_conf);
+	TEST_ASSERT(ret == -EEXIST, "Adapter created twice");
+
+	ret = rte_event_eth_rx_adapter_service_id_get(TEST_ADAPTER_ID,
+			&service_id);
+	TEST_ASSERT_SUCCESS(ret, "Cannot get service id");
+	TEST_ASSERT(rte_service_get_count() > service_id, "Invalid service id");
+
+	ret = rte_event_eth_rx_adapter_free(TEST_ADAPTER_ID);
+	TEST_ASSERT_SUCCESS(ret, "Cannot free adapter: %d", ret);
+	ret = rte_event_eth_rx_adapter_free(TEST_ADAPTER_ID);
+	TEST_ASSERT(ret == -EINVAL, "Adapter freed twice");
+
+	return 0;
+}
+
+static int
+test_rx_adapter_queue_add_del(void)
+{
+	struct rte_event_port_conf port_conf = {
+		.new_event_threshold = 1024,
+		.dequeue_depth = 32,
+		.enqueue_depth = 64,
+	};
+	struct rte_event_eth_rx_adapter_queue_conf queue_conf;
+	int ret;
+
+	memset(&queue_conf, 0, sizeof(queue_conf));
+	queue_conf.ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+
+	ret = rte_event_eth_rx_adapter_queue_add(TEST_ADAPTER_ID, eth_port,
+			-1, &queue_conf);
+	TEST_ASSERT(ret == -EINVAL, "Queue added to missing adapter");
+
+	ret = rte_event_eth_rx_adapter_create(TEST_ADAPTER_ID, evdev,
+			&port_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot create adapter: %d", ret);
+
+	ret = rte_event_eth_rx_adapter_queue_add(TEST_ADAPTER_ID, eth_port,
+			NB_RX_QUEUES, &queue_conf);
+	TEST_ASSERT(ret == -EINVAL, "Invalid queue added");
+	ret = rte_event_eth_rx_adapter_queue_add(TEST_ADAPTER_ID,
+			RTE_MAX_ETHPORTS - 1, -1, &queue_conf);
+	TEST_ASSERT(ret == -EINVAL, "Queue of invalid port added");
+
+	/* the default callback adds a port to the started device */
+	ret = rte_event_eth_rx_adapter_queue_add(TEST_ADAPTER_ID, eth_port,
+			0, &queue_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot add queue: %d", ret);
+	TEST_ASSERT_EQUAL(rte_event_port_count(evdev), 2,
+			"Adapter port not added");
+	TEST_ASSERT(rte_eventdevs[evdev].data->dev_started,
+			"Event device not restarted");
+
+	ret = rte_event_eth_rx_adapter_queue_add(TEST_ADAPTER_ID, eth_port,
+			-1, &queue_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot add all queues: %d", ret);
+	TEST_ASSERT_EQUAL(rte_event_port_count(evdev), 2,
+			"Adapter port added twice");
+
+	ret = rte_event_eth_rx_adapter_free(TEST_ADAPTER_ID);
+	TEST_ASSERT(ret == -EBUSY, "Adapter with queues freed");
+
+	ret = rte_event_eth_rx_adapter_queue_del(TEST_ADAPTER_ID, eth_port, 1);
+	TEST_ASSERT_SUCCESS(ret, "Cannot delete queue: %d", ret);
+	ret = rte_event_eth_rx_adapter_queue_del(TEST_ADAPTER_ID, eth_port, 1);
+	TEST_ASSERT(ret == -EINVAL, "Queue deleted twice");
+	ret = rte_event_eth_rx_adapter_queue_del(TEST_ADAPTER_ID, eth_port, -1);
+	TEST_ASSERT_SUCCESS(ret, "Cannot delete all queues: %d", ret);
+
+	ret = rte_event_eth_rx_adapter_free(TEST_ADAPTER_ID);
+	TEST_ASSERT_SUCCESS(ret, "Cannot free adapter: %d", ret);
+
+	return 0;
+}
+
+static int
+check_event(const struct rte_event *ev)
+{
+	const struct rte_mbuf *m = ev->mbuf;
+	const struct ipv4_hdr *ipv4_hdr;
+	union rte_thash_tuple tuple;
+	uint32_t flow_id;
+
+	if (ev->event_type != RTE_EVENT_TYPE_ETHDEV || ev->queue_id != 0 ||
+			ev->sched_type != RTE_SCHED_TYPE_ATOMIC)
+		return -1;
+
+	switch (m->udata64) {
+	case 0:
+		/* fixed flow id */
+		flow_id = TEST_FLOW_ID;
+		break;
+	case 1:
+		if (m->ol_flags & PKT_RX_RSS_HASH) {
+			flow_id = TEST_RSS_HASH;
+			break;
+		}
+		/* computed by the adapter */
+		ipv4_hdr = rte_pktmbuf_mtod_offset(m, const struct ipv4_hdr *,
+				sizeof(struct ether_hdr));
+		tuple.v4.src_addr = rte_be_to_cpu_32(ipv4_hdr->src_addr);
+		tuple.v4.dst_addr = rte_be_to_cpu_32(ipv4_hdr->dst_addr);
+		flow_id = rte_softrss((uint32_t *)&tuple, RTE_THASH_V4_L3_LEN,
+				rss_key);
+		break;
+	default:
+		return -1;
+	}
+
+	return ev->flow_id == (flow_id & 0xfffff) ? 0 : -1;
+}
+
+static int
+test_rx_adapter_events(void)
+{
+	struct rte_event_port_conf port_conf = {
+		.new_event_threshold = 1024,
+		.dequeue_depth = 32,
+		.enqueue_depth = 64,
+	};
+	struct rte_event_eth_rx_adapter_queue_conf queue_conf;
+	struct rte_event_eth_rx_adapter_stats stats;
+	uint32_t service_id;
+	unsigned int n;
+	int ret;
+
+	ret = rte_event_eth_rx_adapter_create(TEST_ADAPTER_ID, evdev,
+			&port_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot create adapter: %d", ret);
+
+	memset(&queue_conf, 0, sizeof(queue_conf));
+	queue_conf.ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	queue_conf.ev.queue_id = 0;
+	queue_conf.ev.flow_id = TEST_FLOW_ID;
+	queue_conf.rx_queue_flags = RTE_EVENT_ETH_RX_ADAPTER_QUEUE_FLOW_ID_VALID;
+	ret = rte_event_eth_rx_adapter_queue_add(TEST_ADAPTER_ID, eth_port,
+			0, &queue_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot add queue 0: %d", ret);
+	queue_conf.rx_queue_flags = 0;
+	ret = rte_event_eth_rx_adapter_queue_add(TEST_ADAPTER_ID, eth_port,
+			1, &queue_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot add queue 1: %d", ret);
+
+	TEST_ASSERT_SUCCESS(inject_packets(0, 100, IPv4(192, 168, 0, 1), 0),
+			"Cannot inject packets");
+	TEST_ASSERT_SUCCESS(inject_packets(1, 100, IPv4(192, 168, 1, 1), 0),
+			"Cannot inject packets");
+	TEST_ASSERT_SUCCESS(inject_packets(1, 50, IPv4(192, 168, 2, 1), 1),
+			"Cannot inject packets");
+
+	/* not started: the service does not run */
+	TEST_ASSERT_SUCCESS(rte_event_eth_rx_adapter_service_id_get(
+			TEST_ADAPTER_ID, &service_id), "Cannot get service id");
+	TEST_ASSERT_SUCCESS(rte_service_runstate_set(service_id, 1),
+			"Cannot set service runstate");
+	TEST_ASSERT(rte_service_run_iter_on_app_lcore(service_id, 1) < 0,
+			"Service of stopped adapter run");
+
+	TEST_ASSERT_SUCCESS(rte_event_eth_rx_adapter_start(TEST_ADAPTER_ID),
+			"Cannot start adapter");
+	TEST_ASSERT_SUCCESS(run_adapter(10), "Cannot run adapter");
+
+	n = drain_events(check_event);
+	TEST_ASSERT_EQUAL(n, 250, "Unexpected events (%#x)", n);
+
+	TEST_ASSERT_SUCCESS(rte_event_eth_rx_adapter_stats_get(TEST_ADAPTER_ID,
+			&stats), "Cannot get stats");
+	TEST_ASSERT_EQUAL(stats.rx_packets, 250, "Wrong rx_packets");
+	TEST_ASSERT_EQUAL(stats.rx_enq_count, 250, "Wrong rx_enq_count");
+	TEST_ASSERT(stats.rx_poll_count >= 2, "Wrong rx_poll_count");
+
+	TEST_ASSERT_SUCCESS(rte_event_eth_rx_adapter_stats_reset(
+			TEST_ADAPTER_ID), "Cannot reset stats");
+	rte_event_eth_rx_adapter_stats_get(TEST_ADAPTER_ID, &stats);
+	TEST_ASSERT_EQUAL(stats.rx_packets, 0, "Stats not reset");
+
+	return 0;
+}
+
+static int
+set_max_nb_rx(uint8_t id, uint8_t dev_id,
+		struct rte_event_eth_rx_adapter_conf *conf, void *arg)
+{
+	RTE_SET_USED(id);
+	RTE_SET_USED(dev_id);
+	RTE_SET_USED(arg);
+
+	/* share the worker port */
+	conf->event_port_id = 0;
+	conf->max_nb_rx = 4 * BURST_SIZE;
+	return 0;
+}
+
+static int
+test_rx_adapter_weights(void)
+{
+	struct rte_event_eth_rx_adapter_queue_conf queue_conf;
+	unsigned int polled0, polled1, n;
+	uint32_t service_id;
+	int ret;
+
+	ret = rte_event_eth_rx_adapter_create_ext(TEST_ADAPTER_ID, evdev,
+			set_max_nb_rx, NULL);
+	TEST_ASSERT_SUCCESS(ret, "Cannot create adapter: %d", ret);
+
+	memset(&queue_conf, 0, sizeof(queue_conf));
+	queue_conf.ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	queue_conf.servicing_weight = 1;
+	ret = rte_event_eth_rx_adapter_queue_add(TEST_ADAPTER_ID, eth_port,
+			0, &queue_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot add queue 0: %d", ret);
+	queue_conf.servicing_weight = 3;
+	ret = rte_event_eth_rx_adapter_queue_add(TEST_ADAPTER_ID, eth_port,
+			1, &queue_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot add queue 1: %d", ret);
+	TEST_ASSERT_EQUAL(rte_event_port_count(evdev), 1,
+			"Port added by custom callback");
+
+	TEST_ASSERT_SUCCESS(inject_packets(0, 512, IPv4(192, 168, 0, 1), 0),
+			"Cannot inject packets");
+	TEST_ASSERT_SUCCESS(inject_packets(1, 512, IPv4(192, 168, 1, 1), 0),
+			"Cannot inject packets");
+
+	rte_event_eth_rx_adapter_service_id_get(TEST_ADAPTER_ID, &service_id);
+	rte_service_runstate_set(service_id, 1);
+	rte_event_eth_rx_adapter_start(TEST_ADAPTER_ID);
+
+	/* one iteration: max_nb_rx packets, in the 1:3 ratio */
+	TEST_ASSERT_SUCCESS(run_adapter(1), "Cannot run adapter");
+	polled0 = 512 - rte_ring_count(rx_rings[0]);
+	polled1 = 512 - rte_ring_count(rx_rings[1]);
+	TEST_ASSERT(polled0 == BURST_SIZE && polled1 == 3 * BURST_SIZE,
+			"Wrong polling ratio: %u/%u", polled0, polled1);
+	n = drain_events(NULL);
+	TEST_ASSERT_EQUAL(n, 4 * BURST_SIZE,
+			"Wrong number of events: %u", n);
+
+	return 0;
+}
+
+static int
+test_rx_adapter_backpressure(void)
+{
+	struct rte_event_port_conf port_conf = {
+		.new_event_threshold = 64,
+		.dequeue_depth = 32,
+		.enqueue_depth = 32,
+	};
+	struct rte_event_eth_rx_adapter_queue_conf queue_conf;
+	struct rte_event_eth_rx_adapter_stats stats;
+	uint32_t service_id;
+	uint64_t rx_packets;
+	unsigned int total = 0;
+	unsigned int i;
+	int ret;
+
+	ret = rte_event_eth_rx_adapter_create(TEST_ADAPTER_ID, evdev,
+			&port_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot create adapter: %d", ret);
+
+	memset(&queue_conf, 0, sizeof(queue_conf));
+	queue_conf.ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	ret = rte_event_eth_rx_adapter_queue_add(TEST_ADAPTER_ID, eth_port,
+			-1, &queue_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot add queues: %d", ret);
+
+	for (i = 0; i < NB_RX_QUEUES; i++)
+		TEST_ASSERT_SUCCESS(inject_packets(i, 512,
+				IPv4(192, 168, i, 1), 0),
+				"Cannot inject packets");
+
+	rte_event_eth_rx_adapter_service_id_get(TEST_ADAPTER_ID, &service_id);
+	rte_service_runstate_set(service_id, 1);
+	rte_event_eth_rx_adapter_start(TEST_ADAPTER_ID);
+
+	/* nothing is scheduled: the adapter port runs out of credits */
+	TEST_ASSERT_SUCCESS(run_adapter(10), "Cannot run adapter");
+	rte_event_eth_rx_adapter_stats_get(TEST_ADAPTER_ID, &stats);
+	TEST_ASSERT(stats.rx_enq_retry > 0, "No backpressure");
+	TEST_ASSERT(stats.rx_packets < 2 * 512, "Rx queues not backpressured");
+	rx_packets = stats.rx_packets;
+
+	TEST_ASSERT_SUCCESS(run_adapter(10), "Cannot run adapter");
+	rte_event_eth_rx_adapter_stats_get(TEST_ADAPTER_ID, &stats);
+	TEST_ASSERT_EQUAL(stats.rx_packets, rx_packets,
+			"Rx queues polled under backpressure");
+
+	/* no packet is lost once the events are consumed */
+	for (i = 0; i < 1000 && total < 2 * 512; i++) {
+		TEST_ASSERT_SUCCESS(run_adapter(1), "Cannot run adapter");
+		total += drain_events(NULL);
+	}
+	TEST_ASSERT_EQUAL(total, 2 * 512, "Events lost: %u", total);
+
+	rte_event_eth_rx_adapter_stats_get(TEST_ADAPTER_ID, &stats);
+	TEST_ASSERT_EQUAL(stats.rx_enq_count, 2 * 512, "Wrong rx_enq_count");
+	TEST_ASSERT(stats.rx_enq_block_cycles > 0, "No blocked cycles");
+
+	return 0;
+}
+
+/* Dequeue the vectors until no event comes, and count their packets. */
+static unsigned int
+drain_vectors(unsigned int *nb_vectors)
+{
+	struct rte_event ev[BURST_SIZE];
+	unsigned int total = 0;
+	unsigned int idle = 0;
+	uint16_t i, n;
+
+	*nb_vectors = 0;
+	while (idle < 10) {
+		rte_event_schedule(evdev);
+		n = rte_event_dequeue_burst(evdev, 0, ev, BURST_SIZE, 0);
+		if (n == 0) {
+			idle++;
+			continue;
+		}
+		idle = 0;
+		for (i = 0; i < n; i++) {
+			struct rte_event_vector *vec = ev[i].vec;
+			uint32_t flow_id;
+
+			flow_id = vec->queue == 0 ? TEST_FLOW_ID : TEST_RSS_HASH;
+			if (ev[i].event_type != RTE_EVENT_TYPE_ETHDEV_VECTOR ||
+					ev[i].flow_id != flow_id ||
+					vec->port != eth_port ||
+					vec->nb_elem == 0 || vec->nb_elem > 8)
+				total |= 1u << 31;
+			total += vec->nb_elem;
+			rte_pktmbuf_free_bulk(vec->mbufs, vec->nb_elem);
+			rte_mempool_put(rte_mempool_from_obj(vec), vec);
+		}
+		*nb_vectors += n;
+	}
+
+	return total;
+}
+
+static int
+test_rx_adapter_vector(void)
+{
+	struct rte_event_port_conf port_conf = {
+		.new_event_threshold = 1024,
+		.dequeue_depth = 32,
+		.enqueue_depth = 64,
+	};
+	struct rte_event_eth_rx_adapter_queue_conf queue_conf;
+	struct rte_event_eth_rx_adapter_stats stats;
+	struct rte_mempool *vector_pool;
+	unsigned int n, nb_vectors;
+	uint32_t service_id;
+	int ret;
+
+	vector_pool = rte_event_vector_pool_create("rxa_test_vec", 64, 0, 8,
+			rte_socket_id());
+	TEST_ASSERT_NOT_NULL(vector_pool, "Cannot create vector pool");
+	TEST_ASSERT_EQUAL(rte_event_vector_pool_nb_elem(vector_pool), 8,
+			"Wrong number of elements of the vectors");
+
+	ret = rte_event_eth_rx_adapter_create(TEST_ADAPTER_ID, evdev,
+			&port_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot create adapter: %d", ret);
+
+	memset(&queue_conf, 0, sizeof(queue_conf));
+	queue_conf.ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	queue_conf.ev.flow_id = TEST_FLOW_ID;
+	queue_conf.rx_queue_flags = RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR;
+	queue_conf.vector_sz = 8;
+	ret = rte_event_eth_rx_adapter_queue_add(TEST_ADAPTER_ID, eth_port,
+			0, &queue_conf);
+	TEST_ASSERT(ret == -EINVAL, "Vector queue added without pool");
+	queue_conf.vector_mp = vector_pool;
+	queue_conf.vector_sz = 16;
+	ret = rte_event_eth_rx_adapter_queue_add(TEST_ADAPTER_ID, eth_port,
+			0, &queue_conf);
+	TEST_ASSERT(ret == -EINVAL, "Vector queue added with too big vectors");
+
+	/* queue 0: full vectors only; queue 1: flushed on each iteration */
+	queue_conf.vector_sz = 8;
+	queue_conf.vector_timeout_ns = UINT32_MAX;
+	queue_conf.rx_queue_flags |=
+		RTE_EVENT_ETH_RX_ADAPTER_QUEUE_FLOW_ID_VALID;
+	ret = rte_event_eth_rx_adapter_queue_add(TEST_ADAPTER_ID, eth_port,
+			0, &queue_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot add queue 0: %d", ret);
+	queue_conf.vector_timeout_ns = 0;
+	queue_conf.rx_queue_flags = RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR;
+	ret = rte_event_eth_rx_adapter_queue_add(TEST_ADAPTER_ID, eth_port,
+			1, &queue_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot add queue 1: %d", ret);
+
+	TEST_ASSERT_SUCCESS(inject_packets(0, 20, IPv4(192, 168, 0, 1), 0),
+			"Cannot inject packets");
+	TEST_ASSERT_SUCCESS(inject_packets(1, 20, IPv4(192, 168, 1, 1), 1),
+			"Cannot inject packets");
+
+	rte_event_eth_rx_adapter_service_id_get(TEST_ADAPTER_ID, &service_id);
+	rte_service_runstate_set(service_id, 1);
+	rte_event_eth_rx_adapter_start(TEST_ADAPTER_ID);
+	TEST_ASSERT_SUCCESS(run_adapter(1), "Cannot run adapter");
+
+	/* 8 + 8 packets of queue 0, 8 + 8 + 4 of queue 1 */
+	n = drain_vectors(&nb_vectors);
+	TEST_ASSERT_EQUAL(n, 36, "Unexpected packets (%#x)", n);
+	TEST_ASSERT_EQUAL(nb_vectors, 5, "Unexpected vectors: %u",
+			nb_vectors);
+
+	rte_event_eth_rx_adapter_stats_get(TEST_ADAPTER_ID, &stats);
+	TEST_ASSERT_EQUAL(stats.rx_packets, 40, "Wrong rx_packets");
+	TEST_ASSERT_EQUAL(stats.rx_enq_count, 5, "Wrong rx_enq_count");
+
+	/* the incomplete vector of queue 0 is freed */
+	rte_event_eth_rx_adapter_stop(TEST_ADAPTER_ID);
+	ret = rte_event_eth_rx_adapter_queue_del(TEST_ADAPTER_ID, eth_port, -1);
+	TEST_ASSERT_SUCCESS(ret, "Cannot delete queues: %d", ret);
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(vector_pool), 64,
+			"Vectors leaked");
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(mbuf_pool), NB_MBUFS,
+			"Packets leaked");
+
+	rte_mempool_free(vector_pool);
+	return 0;
+}
+
+/*
+ * Dequeue the events of the vector queues until no event comes, and count
+ * their packets. The packets that did not get a vector come as single
+ * events.
+ */
+static unsigned int
+drain_vector_fallback(unsigned int *nb_single)
+{
+	struct rte_event ev[BURST_SIZE];
+	unsigned int total = 0;
+	unsigned int idle = 0;
+	uint16_t i, n;
+
+	while (idle < 10) {
+		rte_event_schedule(evdev);
+		n = rte_event_dequeue_burst(evdev, 0, ev, BURST_SIZE, 0);
+		if (n == 0) {
+			idle++;
+			continue;
+		}
+		idle = 0;
+		for (i = 0; i < n; i++) {
+			struct rte_event_vector *vec = ev[i].vec;
+
+			if (ev[i].event_type == RTE_EVENT_TYPE_ETHDEV) {
+				rte_pktmbuf_free(ev[i].mbuf);
+				(*nb_single)++;
+				total++;
+				continue;
+			}
+			if (ev[i].event_type != RTE_EVENT_TYPE_ETHDEV_VECTOR ||
+					vec->nb_elem == 0 || vec->nb_elem > 8)
+				total |= 1u << 31;
+			total += vec->nb_elem;
+			rte_pktmbuf_free_bulk(vec->mbufs, vec->nb_elem);
+			rte_mempool_put(rte_mempool_from_obj(vec), vec);
+		}
+	}
+
+	return total;
+}
+
+static int
+test_rx_adapter_vector_fallback(void)
+{
+	struct rte_event_port_conf port_conf = {
+		.new_event_threshold = 1024,
+		.dequeue_depth = 32,
+		.enqueue_depth = 64,
+	};
+	struct rte_event_eth_rx_adapter_queue_conf queue_conf;
+	struct rte_event_eth_rx_adapter_stats stats;
+	struct rte_mempool *vector_pool;
+	unsigned int nb_single = 0;
+	unsigned int total = 0;
+	uint32_t service_id;
+	unsigned int i;
+	int ret;
+
+	/* fewer vectors than the slots of the two queues */
+	vector_pool = rte_event_vector_pool_create("rxa_test_vec_fb", 4, 0, 8,
+			rte_socket_id());
+	TEST_ASSERT_NOT_NULL(vector_pool, "Cannot create vector pool");
+
+	ret = rte_event_eth_rx_adapter_create(TEST_ADAPTER_ID, evdev,
+			&port_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot create adapter: %d", ret);
+
+	/* one flow per packet: most packets evict the vector of their slot */
+	memset(&queue_conf, 0, sizeof(queue_conf));
+	queue_conf.ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+	queue_conf.rx_queue_flags = RTE_EVENT_ETH_RX_ADAPTER_QUEUE_EVENT_VECTOR;
+	queue_conf.vector_mp = vector_pool;
+	queue_conf.vector_sz = 8;
+	queue_conf.vector_timeout_ns = UINT32_MAX;
+	ret = rte_event_eth_rx_adapter_queue_add(TEST_ADAPTER_ID, eth_port,
+			-1, &queue_conf);
+	TEST_ASSERT_SUCCESS(ret, "Cannot add queues: %d", ret);
+
+	for (i = 0; i < NB_RX_QUEUES; i++)
+		TEST_ASSERT_SUCCESS(inject_packets(i, 512,
+				IPv4(192, 168, i, 1), 0),
+				"Cannot inject packets");
+
+	rte_event_eth_rx_adapter_service_id_get(TEST_ADAPTER_ID, &service_id);
+	rte_service_runstate_set(service_id, 1);
+	rte_event_eth_rx_adapter_start(TEST_ADAPTER_ID);
+
+	/* the vectors are only freed when drained: the pool runs out */
+	for (i = 0; i < 5; i++)
+		TEST_ASSERT_SUCCESS(run_adapter(1), "Cannot run adapter");
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(vector_pool), 0,
+			"Vector pool not exhausted");
+
+	for (i = 0; i < 1000; i++) {
+		TEST_ASSERT_SUCCESS(run_adapter(1), "Cannot run adapter");
+		total += drain_vector_fallback(&nb_single);
+		if (rte_ring_count(rx_rings[0]) == 0 &&
+				rte_ring_count(rx_rings[1]) == 0)
+			break;
+	}
+	TEST_ASSERT(nb_single > 0, "No packet enqueued without vector");
+
+	/* the packets left in the slots are freed */
+	rte_event_eth_rx_adapter_stop(TEST_ADAPTER_ID);
+	rte_event_eth_rx_adapter_stats_get(TEST_ADAPTER_ID, &stats);
+	TEST_ASSERT_EQUAL(stats.rx_packets, 2 * 512, "Wrong rx_packets");
+	ret = rte_event_eth_rx_adapter_queue_del(TEST_ADAPTER_ID, eth_port, -1);
+	TEST_ASSERT_SUCCESS(ret, "Cannot delete queues: %d", ret);
+	TEST_ASSERT(total <= 2 * 512, "Unexpected packets (%#x)", total);
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(vector_pool), 4,
+			"Vectors leaked");
+	TEST_ASSERT_EQUAL(rte_mempool_avail_count(mbuf_pool), NB_MBUFS,
+			"Packets leaked");
+
+	rte_mempool_free(vector_pool);
+	return 0;
+}
+
+static struct unit_test_suite event_eth_rx_adapter_tests = {
+	.suite_name = "event eth rx adapter autotest",
+	.setup = testsuite_setup,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_rx_adapter_create_free),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_rx_adapter_queue_add_del),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_rx_adapter_events),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_rx_adapter_weights),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_rx_adapter_backpressure),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_rx_adapter_vector),
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_rx_adapter_vector_fallback),
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_event_eth_rx_adapter(void)
+{
+	return unit_test_suite_runner(&event_eth_rx_adapter_tests);
+}
+
+REGISTER_TEST_COMMAND(event_eth_rx_adapter_autotest, test_event_eth_rx_adapter);
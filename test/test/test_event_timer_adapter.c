@@ -0,0 +1,408 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_vdev.h>
+#include <rte_service.h>
+#include <rte_eventdev.h>
+#include <rte_event_timer_adapter.h>
+
+#include "test.h"
+
+#define TEST_ADAPTER_ID 0
+#define NSEC_PER_SEC 1000000000ULL
+#define TICK_NS 100000          /* 100 us */
+#define MAX_TMO_NS 100000000    /* 100 ms */
+#define NB_TIMERS 64
+#define BURST_SIZE 32
+
+static int evdev;
+static struct rte_event_timer_adapter *adapter;
+static struct rte_event_timer timers[NB_TIMERS];
+static uint64_t arm_cycles;
+static uint64_t expiry_cycles[NB_TIMERS];
+
+static const struct rte_event_timer_adapter_conf default_conf = {
+	.timer_adapter_id = TEST_ADAPTER_ID,
+	.socket_id = SOCKET_ID_ANY,
+	.timer_tick_ns = TICK_NS,
+	.max_tmo_ns = MAX_TMO_NS,
+	.nb_timers = NB_TIMERS,
+};
+
+static int
+testsuite_setup(void)
+{
+	if (rte_vdev_init("event_sw_tim", NULL) < 0) {
+		printf("Cannot create event_sw device\n");
+		return -1;
+	}
+	evdev = rte_event_dev_get_dev_id("event_sw_tim");
+	if (evdev < 0) {
+		printf("Cannot find event_sw device\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/* one load balanced queue linked to one worker port */
+static int
+ut_setup(void)
+{
+	const struct rte_event_dev_config config = {
+		.nb_event_queues = 1,
+		.nb_event_ports = 1,
+		.nb_event_queue_flows = 1024,
+		.nb_events_limit = 4096,
+		.nb_event_port_dequeue_depth = 128,
+		.nb_event_port_enqueue_depth = 128,
+	};
+	const struct rte_event_queue_conf queue_conf = {
+		.event_queue_cfg = RTE_EVENT_QUEUE_CFG_ATOMIC_ONLY,
+		.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+		.nb_atomic_flows = 1024,
+		.nb_atomic_order_sequences = 1024,
+	};
+	const struct rte_event_port_conf port_conf = {
+		.new_event_threshold = 4096,
+		.dequeue_depth = 32,
+		.enqueue_depth = 64,
+	};
+	uint8_t queue = 0;
+	unsigned int i;
+
+	if (rte_event_dev_configure(evdev, &config) < 0 ||
+			rte_event_queue_setup(evdev, 0, &queue_conf) < 0 ||
+			rte_event_port_setup(evdev, 0, &port_conf) < 0 ||
+			rte_event_port_link(evdev, 0, &queue, NULL, 1) != 1) {
+		printf("Cannot setup event device\n");
+		return -1;
+	}
+
+	memset(timers, 0, sizeof(timers));
+	for (i = 0; i < NB_TIMERS; i++) {
+		timers[i].ev.queue_id = 0;
+		timers[i].ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+		timers[i].ev.flow_id = i;
+		timers[i].ev.event_ptr = &timers[i];
+	}
+
+	return rte_event_dev_start(evdev);
+}
+
+static void
+ut_teardown(void)
+{
+	if (adapter != NULL) {
+		rte_event_timer_adapter_stop(adapter);
+		rte_event_timer_adapter_free(adapter);
+		adapter = NULL;
+	}
+	rte_event_dev_stop(evdev);
+	rte_event_dev_close(evdev);
+}
+
+static int
+adapter_create(const struct rte_event_timer_adapter_conf *conf)
+{
+	uint32_t service_id;
+
+	adapter = rte_event_timer_adapter_create(conf, NULL);
+	if (adapter == NULL)
+		return -1;
+	if (rte_event_timer_adapter_service_id_get(adapter, &service_id) < 0 ||
+			rte_service_runstate_set(service_id, 1) < 0)
+		return -1;
+	return rte_event_timer_adapter_start(adapter);
+}
+
+/*
+ * Run the adapter service and the event scheduler for a duration,
+ * recording when the event of each timer is received. Returns the number
+ * of events received, or -1 if an event is unexpected.
+ */
+static int
+run_for_ms(unsigned int ms)
+{
+	uint64_t end = rte_get_timer_cycles() + ms * rte_get_timer_hz() / 1000;
+	struct rte_event ev[BURST_SIZE];
+	uint32_t service_id;
+	int received = 0;
+	uint16_t i, n;
+
+	rte_event_timer_adapter_service_id_get(adapter, &service_id);
+	while (rte_get_timer_cycles() < end) {
+		rte_service_run_iter_on_app_lcore(service_id, 1);
+		rte_event_schedule(evdev);
+		n = rte_event_dequeue_burst(evdev, 0, ev, BURST_SIZE, 0);
+		for (i = 0; i < n; i++) {
+			struct rte_event_timer *tim = ev[i].event_ptr;
+			unsigned int idx = tim - timers;
+
+			if (ev[i].event_type != RTE_EVENT_TYPE_TIMERDEV ||
+					idx >= NB_TIMERS ||
+					expiry_cycles[idx] != 0 ||
+					tim->state != RTE_EVENT_TIMER_NOT_ARMED)
+				return -1;
+			expiry_cycles[idx] = rte_get_timer_cycles();
+		}
+		received += n;
+	}
+
+	return received;
+}
+
+static int
+test_timer_adapter_create_free(void)
+{
+	struct rte_event_timer_adapter_conf conf = default_conf;
+	struct rte_event_timer_adapter *dup;
+
+	conf.timer_adapter_id = RTE_EVENT_TIMER_ADAPTER_MAX_INSTANCE;
+	TEST_ASSERT(rte_event_timer_adapter_create(&conf, NULL) == NULL &&
+			rte_errno == EINVAL, "Adapter created with invalid id");
+	conf = default_conf;
+	conf.timer_tick_ns = 0;
+	TEST_ASSERT(rte_event_timer_adapter_create(&conf, NULL) == NULL &&
+			rte_errno == EINVAL, "Adapter created without tick");
+	conf = default_conf;
+	conf.max_tmo_ns = TICK_NS - 1;
+	TEST_ASSERT(rte_event_timer_adapter_create(&conf, NULL) == NULL &&
+			rte_errno == EINVAL,
+			"Adapter created with timeout shorter than a tick");
+
+	adapter = rte_event_timer_adapter_create(&default_conf, NULL);
+	TEST_ASSERT_NOT_NULL(adapter, "Cannot create adapter: %d", rte_errno);
+	TEST_ASSERT_EQUAL(rte_event_port_count(evdev), 2,
+			"Adapter port not added");
+	TEST_ASSERT(rte_eventdevs[evdev].data->dev_started,
+			"Event device not restarted");
+
+	dup = rte_event_timer_adapter_create(&default_conf, NULL);
+	TEST_ASSERT(dup == NULL && rte_errno == EEXIST,
+			"Adapter created twice");
+
+	TEST_ASSERT_SUCCESS(rte_event_timer_adapter_start(adapter),
+			"Cannot start adapter");
+	TEST_ASSERT(rte_event_timer_adapter_free(adapter) == -EBUSY,
+			"Started adapter freed");
+	TEST_ASSERT_SUCCESS(rte_event_timer_adapter_stop(adapter),
+			"Cannot stop adapter");
+	TEST_ASSERT_SUCCESS(rte_event_timer_adapter_free(adapter),
+			"Cannot free adapter");
+	adapter = NULL;
+
+	return 0;
+}
+
+static int
+test_timer_arm_errors(void)
+{
+	struct rte_event_timer *tims[NB_TIMERS];
+	struct rte_event_timer_adapter_conf conf = default_conf;
+	unsigned int i;
+	uint16_t n;
+
+	conf.nb_timers = 4;
+	TEST_ASSERT_SUCCESS(adapter_create(&conf), "Cannot create adapter");
+	for (i = 0; i < NB_TIMERS; i++)
+		tims[i] = &timers[i];
+
+	timers[0].timeout_ticks = 0;
+	n = rte_event_timer_arm_burst(adapter, tims, 1);
+	TEST_ASSERT(n == 0 && rte_errno == EINVAL &&
+			timers[0].state == RTE_EVENT_TIMER_ERROR_TOOEARLY,
+			"Timer armed without timeout");
+	timers[0].timeout_ticks = MAX_TMO_NS / TICK_NS + 1;
+	n = rte_event_timer_arm_burst(adapter, tims, 1);
+	TEST_ASSERT(n == 0 && rte_errno == EINVAL &&
+			timers[0].state == RTE_EVENT_TIMER_ERROR_TOOLATE,
+			"Timer armed beyond the maximum timeout");
+
+	/* stops at the first already armed timer */
+	n = rte_event_timer_arm_tmo_tick_burst(adapter, tims, 100, 2);
+	TEST_ASSERT_EQUAL(n, 2, "Cannot arm timers");
+	n = rte_event_timer_arm_tmo_tick_burst(adapter, &tims[1], 100, 2);
+	TEST_ASSERT(n == 0 && rte_errno == EALREADY,
+			"Timer armed twice");
+	TEST_ASSERT(timers[2].state == RTE_EVENT_TIMER_NOT_ARMED,
+			"Timer armed after error");
+
+	/* nb_timers */
+	n = rte_event_timer_arm_tmo_tick_burst(adapter, &tims[2], 100, 3);
+	TEST_ASSERT(n == 2 && rte_errno == ENOSPC,
+			"More timers than nb_timers armed: %u", n);
+	n = rte_event_timer_cancel_burst(adapter, tims, 1);
+	TEST_ASSERT_EQUAL(n, 1, "Cannot cancel timer");
+	n = rte_event_timer_arm_tmo_tick_burst(adapter, &tims[4], 100, 1);
+	TEST_ASSERT_EQUAL(n, 1, "Cannot arm timer after cancel");
+
+	n = rte_event_timer_cancel_burst(adapter, &tims[1], 4);
+	TEST_ASSERT_EQUAL(n, 4, "Cannot cancel timers");
+
+	return 0;
+}
+
+static int
+test_timer_expiry(void)
+{
+	struct rte_event_timer_adapter_stats stats;
+	struct rte_event_timer *tims[NB_TIMERS];
+	uint64_t tick_cycles = rte_get_timer_hz() / (NSEC_PER_SEC / TICK_NS);
+	unsigned int i;
+	uint16_t n;
+	int received;
+
+	TEST_ASSERT_SUCCESS(adapter_create(&default_conf),
+			"Cannot create adapter");
+
+	memset(expiry_cycles, 0, sizeof(expiry_cycles));
+	for (i = 0; i < NB_TIMERS; i++) {
+		timers[i].timeout_ticks = 1 + (i % 16) * 4;
+		tims[i] = &timers[i];
+	}
+	arm_cycles = rte_get_timer_cycles();
+	n = rte_event_timer_arm_burst(adapter, tims, NB_TIMERS);
+	TEST_ASSERT_EQUAL(n, NB_TIMERS, "Cannot arm timers: %d", rte_errno);
+	for (i = 0; i < NB_TIMERS; i++)
+		TEST_ASSERT(timers[i].state == RTE_EVENT_TIMER_ARMED,
+				"Timer %u not armed", i);
+
+	/* the longest timeout is 61 ticks */
+	received = run_for_ms(20);
+	TEST_ASSERT_EQUAL(received, NB_TIMERS,
+			"Wrong number of timer events: %d", received);
+
+	for (i = 0; i < NB_TIMERS; i++) {
+		uint64_t elapsed = expiry_cycles[i] - arm_cycles;
+
+		TEST_ASSERT(elapsed >= (timers[i].timeout_ticks - 1) *
+				tick_cycles,
+				"Timer %u expired early: %" PRIu64 " cycles",
+				i, elapsed);
+	}
+
+	rte_event_timer_adapter_stats_get(adapter, &stats);
+	TEST_ASSERT_EQUAL(stats.evtim_exp_count, NB_TIMERS,
+			"Wrong evtim_exp_count");
+	TEST_ASSERT_EQUAL(stats.ev_enq_count, NB_TIMERS,
+			"Wrong ev_enq_count");
+	TEST_ASSERT(stats.adapter_tick_count > 0, "No tick processed");
+
+	/* expired timers can be armed again */
+	n = rte_event_timer_arm_burst(adapter, tims, NB_TIMERS);
+	TEST_ASSERT_EQUAL(n, NB_TIMERS, "Cannot rearm timers: %d", rte_errno);
+	n = rte_event_timer_cancel_burst(adapter, tims, NB_TIMERS);
+	TEST_ASSERT_EQUAL(n, NB_TIMERS, "Cannot cancel timers");
+
+	return 0;
+}
+
+static int
+test_timer_cancel(void)
+{
+	struct rte_event_timer *tims[NB_TIMERS];
+	unsigned int i;
+	uint16_t n;
+	int received;
+
+	TEST_ASSERT_SUCCESS(adapter_create(&default_conf),
+			"Cannot create adapter");
+
+	memset(expiry_cycles, 0, sizeof(expiry_cycles));
+	for (i = 0; i < NB_TIMERS; i++)
+		tims[i] = &timers[i];
+	n = rte_event_timer_arm_tmo_tick_burst(adapter, tims, 10, NB_TIMERS);
+	TEST_ASSERT_EQUAL(n, NB_TIMERS, "Cannot arm timers: %d", rte_errno);
+
+	/* cancel the even timers */
+	for (i = 0; i < NB_TIMERS / 2; i++)
+		tims[i] = &timers[2 * i];
+	n = rte_event_timer_cancel_burst(adapter, tims, NB_TIMERS / 2);
+	TEST_ASSERT_EQUAL(n, NB_TIMERS / 2, "Cannot cancel timers");
+	n = rte_event_timer_cancel_burst(adapter, tims, 1);
+	TEST_ASSERT(n == 0 && rte_errno == EALREADY,
+			"Timer canceled twice");
+
+	received = run_for_ms(5);
+	TEST_ASSERT_EQUAL(received, NB_TIMERS / 2,
+			"Wrong number of timer events: %d", received);
+	for (i = 0; i < NB_TIMERS; i++) {
+		if (i % 2 == 0)
+			TEST_ASSERT(expiry_cycles[i] == 0 &&
+				timers[i].state == RTE_EVENT_TIMER_CANCELED,
+				"Canceled timer %u expired", i);
+		else
+			TEST_ASSERT(expiry_cycles[i] != 0,
+				"Timer %u did not expire", i);
+	}
+
+	/* expired timers cannot be canceled */
+	tims[0] = &timers[1];
+	n = rte_event_timer_cancel_burst(adapter, tims, 1);
+	TEST_ASSERT(n == 0 && rte_errno == EALREADY, "Expired timer canceled");
+
+	return 0;
+}
+
+static struct unit_test_suite event_timer_adapter_tests = {
+	.suite_name = "event timer adapter autotest",
+	.setup = testsuite_setup,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE_ST(ut_setup, ut_teardown,
+				test_timer_adapter_create_free),
+		TEST_CASE_ST(ut_setup, ut_teardown, test_timer_arm_errors),
+		TEST_CASE_ST(ut_setup, ut_teardown, test_timer_expiry),
+		TEST_CASE_ST(ut_setup, ut_teardown, test_timer_cancel),
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_event_timer_adapter(void)
+{
+	return unit_test_suite_runner(&event_timer_adapter_tests);
+}
+
+REGISTER_TEST_COMMAND(event_timer_adapter_autotest, test_event_timer_adapter);
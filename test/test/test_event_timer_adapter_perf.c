@@ -0,0 +1,251 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_cycles.h>
+#include <rte_random.h>
+#include <rte_vdev.h>
+#include <rte_service.h>
+#include <rte_eventdev.h>
+#include <rte_event_timer_adapter.h>
+
+#include "test.h"
+
+/*
+ * Event timer adapter performance test
+ * ====================================
+ *
+ * 1M event timers are armed by bursts of 32 with timeouts spread over
+ * half a second to one second, then cancelled, then armed again with
+ * timeouts spread over the first 100 ticks and expired through an
+ * event_sw device, whose worker port is drained by the same lcore. The
+ * number of cycles per timer of each phase is reported; with a timing
+ * wheel, it does not depend on the number of outstanding timers.
+ */
+
+#define NB_PERF_TIMERS (1 << 20)
+#define BURST_SIZE 32
+#define TICK_NS 10000            /* 10 us */
+#define MAX_TMO_NS 1000000000ULL /* 1 s */
+#define MAX_TMO_TICKS (MAX_TMO_NS / TICK_NS)
+
+static int evdev;
+
+static int
+setup_eventdev(void)
+{
+	const struct rte_event_dev_config config = {
+		.nb_event_queues = 1,
+		.nb_event_ports = 1,
+		.nb_event_queue_flows = 1024,
+		.nb_events_limit = 4096,
+		.nb_event_port_dequeue_depth = 128,
+		.nb_event_port_enqueue_depth = 128,
+	};
+	const struct rte_event_queue_conf queue_conf = {
+		.event_queue_cfg = RTE_EVENT_QUEUE_CFG_PARALLEL_ONLY,
+		.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+		.nb_atomic_flows = 1024,
+		.nb_atomic_order_sequences = 1024,
+	};
+	const struct rte_event_port_conf port_conf = {
+		.new_event_threshold = 4096,
+		.dequeue_depth = 32,
+		.enqueue_depth = 64,
+	};
+	uint8_t queue = 0;
+
+	if (rte_vdev_init("event_sw_timperf", NULL) < 0)
+		return -1;
+	evdev = rte_event_dev_get_dev_id("event_sw_timperf");
+	if (evdev < 0)
+		return -1;
+
+	if (rte_event_dev_configure(evdev, &config) < 0 ||
+			rte_event_queue_setup(evdev, 0, &queue_conf) < 0 ||
+			rte_event_port_setup(evdev, 0, &port_conf) < 0 ||
+			rte_event_port_link(evdev, 0, &queue, NULL, 1) != 1)
+		return -1;
+	return 0;
+}
+
+static int
+arm_all(struct rte_event_timer_adapter *adapter,
+		struct rte_event_timer **tims, uint64_t *cycles)
+{
+	uint64_t start = rte_rdtsc();
+	unsigned int i;
+
+	for (i = 0; i < NB_PERF_TIMERS; i += BURST_SIZE)
+		if (rte_event_timer_arm_burst(adapter, &tims[i], BURST_SIZE) !=
+				BURST_SIZE) {
+			printf("Cannot arm timers: %d\n", rte_errno);
+			return -1;
+		}
+	if (cycles != NULL)
+		*cycles = rte_rdtsc() - start;
+	return 0;
+}
+
+static int
+test_event_timer_adapter_perf(void)
+{
+	struct rte_event_timer_adapter_conf adapter_conf = {
+		.timer_adapter_id = 0,
+		.socket_id = SOCKET_ID_ANY,
+		.timer_tick_ns = TICK_NS,
+		.max_tmo_ns = MAX_TMO_NS,
+		.nb_timers = NB_PERF_TIMERS,
+	};
+	struct rte_event_timer_adapter_stats stats;
+	struct rte_event_timer_adapter *adapter = NULL;
+	struct rte_event_timer *timers = NULL;
+	struct rte_event_timer **tims = NULL;
+	struct rte_event ev[BURST_SIZE];
+	uint64_t arm_cycles, cancel_cycles, expiry_cycles;
+	uint64_t start;
+	uint32_t service_id;
+	unsigned int received;
+	unsigned int i;
+	int ret = -1;
+
+	if (setup_eventdev() < 0) {
+		printf("Cannot setup event device\n");
+		return -1;
+	}
+
+	if (posix_memalign((void **)&timers, RTE_CACHE_LINE_SIZE,
+			NB_PERF_TIMERS * sizeof(*timers)) != 0) {
+		printf("Cannot allocate timers\n");
+		timers = NULL;
+		goto out;
+	}
+	tims = malloc(NB_PERF_TIMERS * sizeof(*tims));
+	if (tims == NULL) {
+		printf("Cannot allocate timers\n");
+		goto out;
+	}
+	memset(timers, 0, NB_PERF_TIMERS * sizeof(*timers));
+	for (i = 0; i < NB_PERF_TIMERS; i++) {
+		timers[i].ev.queue_id = 0;
+		timers[i].ev.sched_type = RTE_SCHED_TYPE_PARALLEL;
+		timers[i].ev.event_ptr = &timers[i];
+		timers[i].timeout_ticks = MAX_TMO_TICKS / 2 +
+			rte_rand() % (MAX_TMO_TICKS / 2);
+		tims[i] = &timers[i];
+	}
+
+	adapter_conf.event_dev_id = evdev;
+	adapter = rte_event_timer_adapter_create(&adapter_conf, NULL);
+	if (adapter == NULL) {
+		printf("Cannot create adapter: %d\n", rte_errno);
+		goto out;
+	}
+	rte_event_timer_adapter_service_id_get(adapter, &service_id);
+	rte_service_runstate_set(service_id, 1);
+	rte_event_timer_adapter_start(adapter);
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("Cannot start event device\n");
+		goto out;
+	}
+
+	/* arm and cancel, the service is not running */
+	if (arm_all(adapter, tims, &arm_cycles) < 0)
+		goto out;
+	start = rte_rdtsc();
+	for (i = 0; i < NB_PERF_TIMERS; i += BURST_SIZE)
+		if (rte_event_timer_cancel_burst(adapter, &tims[i],
+				BURST_SIZE) != BURST_SIZE) {
+			printf("Cannot cancel timers: %d\n", rte_errno);
+			goto out;
+		}
+	cancel_cycles = rte_rdtsc() - start;
+
+	/* expiry of the whole set within 100 ticks */
+	for (i = 0; i < NB_PERF_TIMERS; i++)
+		timers[i].timeout_ticks = 1 + i % 100;
+	if (arm_all(adapter, tims, NULL) < 0)
+		goto out;
+	rte_event_timer_adapter_stats_reset(adapter);
+	received = 0;
+	start = rte_rdtsc();
+	while (received < NB_PERF_TIMERS &&
+			rte_rdtsc() - start < 30 * rte_get_tsc_hz()) {
+		rte_service_run_iter_on_app_lcore(service_id, 1);
+		rte_event_schedule(evdev);
+		received += rte_event_dequeue_burst(evdev, 0, ev, BURST_SIZE,
+				0);
+	}
+	expiry_cycles = rte_rdtsc() - start;
+	if (received != NB_PERF_TIMERS) {
+		printf("Only %u timer events received\n", received);
+		goto out;
+	}
+	rte_event_timer_adapter_stats_get(adapter, &stats);
+
+	printf("\n### Event timer adapter, %u timers, bursts of %u ###\n",
+			NB_PERF_TIMERS, BURST_SIZE);
+	printf("arm:    %" PRIu64 " cycles/timer\n",
+			arm_cycles / NB_PERF_TIMERS);
+	printf("cancel: %" PRIu64 " cycles/timer\n",
+			cancel_cycles / NB_PERF_TIMERS);
+	printf("expiry: %" PRIu64 " cycles/timer, %" PRIu64
+			" timers/ms, including the event device "
+			"(%" PRIu64 " enqueue retries)\n",
+			expiry_cycles / NB_PERF_TIMERS,
+			(uint64_t)NB_PERF_TIMERS * rte_get_tsc_hz() / 1000 /
+				expiry_cycles,
+			stats.evtim_retry_count);
+	ret = 0;
+
+out:
+	if (adapter != NULL) {
+		rte_event_timer_adapter_stop(adapter);
+		rte_event_timer_adapter_free(adapter);
+	}
+	rte_event_dev_stop(evdev);
+	rte_event_dev_close(evdev);
+	free(tims);
+	free(timers);
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(event_timer_adapter_perf_autotest,
+		test_event_timer_adapter_perf);
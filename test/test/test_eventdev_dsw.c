@@ -0,0 +1,901 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_dev.h>
+#include <rte_eventdev.h>
+
+#include "test.h"
+
+#define MAX_PORTS 16
+#define MAX_QIDS 16
+
+static int evdev;
+
+struct test {
+	uint8_t port[MAX_PORTS];
+	uint8_t qid[MAX_QIDS];
+	int nb_qids;
+};
+
+/* initialization and config */
+static inline int
+init_limit(struct test *t, int nb_queues, int nb_ports,
+		uint32_t nb_events_limit)
+{
+	struct rte_event_dev_config config = {
+			.nb_event_queues = nb_queues,
+			.nb_event_ports = nb_ports,
+			.nb_event_queue_flows = 1024,
+			.nb_events_limit = nb_events_limit,
+			.nb_event_port_dequeue_depth = 128,
+			.nb_event_port_enqueue_depth = 128,
+	};
+	int ret;
+
+	memset(t, 0, sizeof(*t));
+
+	ret = rte_event_dev_configure(evdev, &config);
+	if (ret < 0)
+		printf("%d: Error configuring device\n", __LINE__);
+	return ret;
+}
+
+static inline int
+init(struct test *t, int nb_queues, int nb_ports)
+{
+	return init_limit(t, nb_queues, nb_ports, 4096);
+}
+
+static inline int
+create_ports_threshold(struct test *t, int num_ports,
+		int32_t new_event_threshold)
+{
+	const struct rte_event_port_conf conf = {
+			.new_event_threshold = new_event_threshold,
+			.dequeue_depth = 32,
+			.enqueue_depth = 64,
+	};
+	int i;
+
+	if (num_ports > MAX_PORTS)
+		return -1;
+
+	for (i = 0; i < num_ports; i++) {
+		if (rte_event_port_setup(evdev, i, &conf) < 0) {
+			printf("Error setting up port %d\n", i);
+			return -1;
+		}
+		t->port[i] = i;
+	}
+
+	return 0;
+}
+
+static inline int
+create_ports(struct test *t, int num_ports)
+{
+	return create_ports_threshold(t, num_ports, 1024);
+}
+
+static inline int
+create_qids(struct test *t, int num_qids, uint32_t flags)
+{
+	const struct rte_event_queue_conf conf = {
+			.event_queue_cfg = flags,
+			.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+			.nb_atomic_flows = 1024,
+			.nb_atomic_order_sequences = 1024,
+	};
+	int i;
+
+	if (t->nb_qids + num_qids > MAX_QIDS)
+		return -1;
+
+	for (i = t->nb_qids; i < t->nb_qids + num_qids; i++) {
+		if (rte_event_queue_setup(evdev, i, &conf) < 0) {
+			printf("%d: error creating qid %d\n", __LINE__, i);
+			return -1;
+		}
+		t->qid[i] = i;
+	}
+	t->nb_qids += num_qids;
+
+	return 0;
+}
+
+static inline int
+create_atomic_qids(struct test *t, int num_qids)
+{
+	return create_qids(t, num_qids, RTE_EVENT_QUEUE_CFG_ATOMIC_ONLY);
+}
+
+static inline int
+create_parallel_qids(struct test *t, int num_qids)
+{
+	return create_qids(t, num_qids, RTE_EVENT_QUEUE_CFG_PARALLEL_ONLY);
+}
+
+static inline int
+link_port(struct test *t, int port, int qid)
+{
+	if (rte_event_port_link(evdev, t->port[port], &t->qid[qid],
+				NULL, 1) != 1) {
+		printf("%d: error linking port %d to qid %d\n", __LINE__,
+				port, qid);
+		return -1;
+	}
+	return 0;
+}
+
+/* destruction */
+static inline int
+cleanup(struct test *t __rte_unused)
+{
+	rte_event_dev_stop(evdev);
+	rte_event_dev_close(evdev);
+	return 0;
+}
+
+static uint64_t
+port_stat(int port, const char *stat)
+{
+	char name[RTE_EVENT_DEV_XSTATS_NAME_SIZE];
+
+	snprintf(name, sizeof(name), "port_%d_%s", port, stat);
+	return rte_event_dev_xstats_by_name_get(evdev, name, NULL);
+}
+
+static int
+enqueue_new(struct test *t, int port, int qid, uint32_t flow_id,
+		uint64_t data)
+{
+	struct rte_event ev = {
+			.op = RTE_EVENT_OP_NEW,
+			.queue_id = t->qid[qid],
+			.flow_id = flow_id,
+			.u64 = data,
+	};
+
+	return rte_event_enqueue_burst(evdev, t->port[port], &ev, 1);
+}
+
+static int
+test_info(void)
+{
+	struct rte_event_dev_info info;
+
+	if (rte_event_dev_info_get(evdev, &info) < 0) {
+		printf("%d: Error getting device info\n", __LINE__);
+		return -1;
+	}
+	if (strcmp(info.driver_name, "event_dsw") != 0) {
+		printf("%d: Unexpected driver name %s\n", __LINE__,
+				info.driver_name);
+		return -1;
+	}
+	if (!(info.event_dev_cap & RTE_EVENT_DEV_CAP_DISTRIBUTED_SCHED)) {
+		printf("%d: Distributed scheduling not reported\n", __LINE__);
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_queue_types(struct test *t)
+{
+	if (init(t, 1, 1) < 0 || create_ports(t, 1) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+
+	/* no reorder support, nor mixed types */
+	if (create_qids(t, 1, RTE_EVENT_QUEUE_CFG_ORDERED_ONLY) == 0) {
+		printf("%d: Ordered queue accepted\n", __LINE__);
+		return -1;
+	}
+	if (create_qids(t, 1, RTE_EVENT_QUEUE_CFG_ALL_TYPES) == 0) {
+		printf("%d: All types queue accepted\n", __LINE__);
+		return -1;
+	}
+	if (create_parallel_qids(t, 1) < 0) {
+		printf("%d: Parallel queue refused\n", __LINE__);
+		return -1;
+	}
+
+	cleanup(t);
+	return 0;
+}
+
+static int
+test_unlinked_queue(struct test *t)
+{
+	if (init(t, 2, 1) < 0 ||
+			create_ports(t, 1) < 0 ||
+			create_atomic_qids(t, 2) < 0 ||
+			link_port(t, 0, 0) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+
+	if (rte_event_dev_start(evdev) == 0) {
+		printf("%d: Start with an unlinked queue succeeded\n",
+				__LINE__);
+		cleanup(t);
+		return -1;
+	}
+
+	cleanup(t);
+	return 0;
+}
+
+static int
+test_single_link(struct test *t)
+{
+	struct rte_event ev;
+
+	if (init(t, 1, 2) < 0 ||
+			create_ports(t, 2) < 0 ||
+			create_qids(t, 1, RTE_EVENT_QUEUE_CFG_SINGLE_LINK) < 0 ||
+			link_port(t, 1, 0) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+
+	if (rte_event_port_link(evdev, t->port[0], &t->qid[0], NULL, 1) != 0) {
+		printf("%d: Second link of single-link queue accepted\n",
+				__LINE__);
+		return -1;
+	}
+
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		return -1;
+	}
+
+	if (enqueue_new(t, 0, 0, 0, 42) != 1) {
+		printf("%d: Failed to enqueue\n", __LINE__);
+		return -1;
+	}
+	if (rte_event_dequeue_burst(evdev, t->port[1], &ev, 1, 0) != 1 ||
+			ev.u64 != 42) {
+		printf("%d: Event not received on linked port\n", __LINE__);
+		return -1;
+	}
+
+	cleanup(t);
+	return 0;
+}
+
+static int
+test_single_event(struct test *t)
+{
+	struct rte_event ev;
+
+	if (init(t, 1, 1) < 0 ||
+			create_ports(t, 1) < 0 ||
+			create_atomic_qids(t, 1) < 0 ||
+			link_port(t, 0, 0) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		return -1;
+	}
+
+	if (enqueue_new(t, 0, 0, 1234, 0xdeadbeef) != 1) {
+		printf("%d: Failed to enqueue\n", __LINE__);
+		return -1;
+	}
+
+	if (rte_event_dequeue_burst(evdev, t->port[0], &ev, 1, 0) != 1) {
+		printf("%d: Failed to dequeue\n", __LINE__);
+		return -1;
+	}
+	if (ev.queue_id != t->qid[0] || ev.flow_id != 1234 ||
+			ev.u64 != 0xdeadbeef) {
+		printf("%d: Event modified\n", __LINE__);
+		return -1;
+	}
+	if (rte_event_dequeue_burst(evdev, t->port[0], &ev, 1, 0) != 0) {
+		printf("%d: Event dequeued twice\n", __LINE__);
+		return -1;
+	}
+
+	if (port_stat(0, "new_enqueued") != 1 ||
+			port_stat(0, "dequeued") != 1 ||
+			port_stat(0, "pending_releases") != 0) {
+		printf("%d: Port stats not correct\n", __LINE__);
+		rte_event_dev_dump(evdev, stdout);
+		return -1;
+	}
+
+	cleanup(t);
+	return 0;
+}
+
+static int
+test_invalid_qid(struct test *t)
+{
+	struct rte_event ev;
+
+	if (init(t, 1, 1) < 0 ||
+			create_ports(t, 1) < 0 ||
+			create_atomic_qids(t, 1) < 0 ||
+			link_port(t, 0, 0) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		return -1;
+	}
+
+	t->qid[1] = MAX_QIDS - 1;
+	if (enqueue_new(t, 0, 1, 0, 0) != 1) {
+		printf("%d: Failed to enqueue\n", __LINE__);
+		return -1;
+	}
+
+	if (rte_event_dequeue_burst(evdev, t->port[0], &ev, 1, 0) != 0) {
+		printf("%d: Event to invalid qid dequeued\n", __LINE__);
+		return -1;
+	}
+	if (port_stat(0, "dropped") != 1) {
+		printf("%d: Drop not counted\n", __LINE__);
+		return -1;
+	}
+
+	cleanup(t);
+	return 0;
+}
+
+/*
+ * The events of a flow of an atomic queue all go to the same port, in
+ * order. The ports are served with the events of several flows.
+ */
+#define ATOMIC_FLOWS 16
+#define ATOMIC_EVENTS_PER_FLOW 32
+#define ATOMIC_WORKERS 4
+
+static int
+test_atomic_flows(struct test *t)
+{
+	const int rx_port = 0;
+	int flow_port[ATOMIC_FLOWS];
+	uint64_t next_seq[ATOMIC_FLOWS] = { 0 };
+	unsigned int received = 0, i, w;
+	int ports_used = 0;
+
+	if (init(t, 1, ATOMIC_WORKERS + 1) < 0 ||
+			create_ports(t, ATOMIC_WORKERS + 1) < 0 ||
+			create_atomic_qids(t, 1) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+	for (w = 1; w <= ATOMIC_WORKERS; w++)
+		if (link_port(t, w, 0) < 0)
+			return -1;
+
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		return -1;
+	}
+
+	for (i = 0; i < ATOMIC_FLOWS * ATOMIC_EVENTS_PER_FLOW; i++) {
+		if (enqueue_new(t, rx_port, 0, i % ATOMIC_FLOWS,
+					i / ATOMIC_FLOWS) != 1) {
+			printf("%d: Failed to enqueue\n", __LINE__);
+			return -1;
+		}
+	}
+
+	for (i = 0; i < ATOMIC_FLOWS; i++)
+		flow_port[i] = -1;
+
+	for (w = 1; w <= ATOMIC_WORKERS; w++) {
+		struct rte_event ev[32];
+		uint16_t n, j;
+		int got_events = 0;
+
+		while ((n = rte_event_dequeue_burst(evdev, t->port[w], ev,
+						RTE_DIM(ev), 0)) > 0) {
+			for (j = 0; j < n; j++) {
+				const uint32_t flow = ev[j].flow_id;
+
+				if (flow_port[flow] == -1)
+					flow_port[flow] = w;
+				if (flow_port[flow] != (int)w) {
+					printf("%d: Flow %u on ports %d and %u\n",
+							__LINE__, flow,
+							flow_port[flow], w);
+					return -1;
+				}
+				if (ev[j].u64 != next_seq[flow]++) {
+					printf("%d: Flow %u out of order\n",
+							__LINE__, flow);
+					return -1;
+				}
+			}
+			received += n;
+			got_events = 1;
+		}
+		ports_used += got_events;
+	}
+
+	if (received != ATOMIC_FLOWS * ATOMIC_EVENTS_PER_FLOW) {
+		printf("%d: Received %u events\n", __LINE__, received);
+		return -1;
+	}
+	if (ports_used != ATOMIC_WORKERS) {
+		printf("%d: Flows not spread over the ports\n", __LINE__);
+		return -1;
+	}
+
+	cleanup(t);
+	return 0;
+}
+
+/* The events of a parallel queue are spread evenly over its ports. */
+static int
+test_parallel_spread(struct test *t)
+{
+	const unsigned int nb_events = 30;
+	unsigned int i, w;
+
+	if (init(t, 1, 4) < 0 ||
+			create_ports(t, 4) < 0 ||
+			create_parallel_qids(t, 1) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+	for (w = 1; w <= 3; w++)
+		if (link_port(t, w, 0) < 0)
+			return -1;
+
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		return -1;
+	}
+
+	for (i = 0; i < nb_events; i++) {
+		if (enqueue_new(t, 0, 0, 0, i) != 1) {
+			printf("%d: Failed to enqueue\n", __LINE__);
+			return -1;
+		}
+	}
+
+	for (w = 1; w <= 3; w++) {
+		struct rte_event ev[32];
+		uint16_t n;
+
+		n = rte_event_dequeue_burst(evdev, t->port[w], ev,
+				RTE_DIM(ev), 0);
+		if (n != nb_events / 3) {
+			printf("%d: Port %u received %u events\n", __LINE__,
+					w, n);
+			return -1;
+		}
+	}
+
+	cleanup(t);
+	return 0;
+}
+
+/* Events forwarded through a pipeline of atomic queues. */
+static int
+test_pipeline(struct test *t)
+{
+	const unsigned int nb_events = 64;
+	struct rte_event ev[32];
+	unsigned int i, received = 0;
+	uint16_t n, j;
+
+	if (init(t, 2, 3) < 0 ||
+			create_ports(t, 3) < 0 ||
+			create_atomic_qids(t, 2) < 0 ||
+			link_port(t, 1, 0) < 0 ||
+			link_port(t, 2, 1) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		return -1;
+	}
+
+	for (i = 0; i < nb_events; i++) {
+		if (enqueue_new(t, 0, 0, i % 4, i) != 1) {
+			printf("%d: Failed to enqueue\n", __LINE__);
+			return -1;
+		}
+	}
+
+	/* stage 1: forward to queue 1 */
+	while ((n = rte_event_dequeue_burst(evdev, t->port[1], ev,
+					RTE_DIM(ev), 0)) > 0) {
+		for (j = 0; j < n; j++) {
+			ev[j].queue_id = t->qid[1];
+			ev[j].op = RTE_EVENT_OP_FORWARD;
+		}
+		if (rte_event_enqueue_burst(evdev, t->port[1], ev, n) != n) {
+			printf("%d: Failed to forward\n", __LINE__);
+			return -1;
+		}
+	}
+
+	/* stage 2: release */
+	while ((n = rte_event_dequeue_burst(evdev, t->port[2], ev,
+					RTE_DIM(ev), 0)) > 0) {
+		for (j = 0; j < n; j++) {
+			if (ev[j].u64 != received++) {
+				printf("%d: Event out of order\n", __LINE__);
+				return -1;
+			}
+			ev[j].op = RTE_EVENT_OP_RELEASE;
+		}
+		rte_event_enqueue_burst(evdev, t->port[2], ev, n);
+	}
+
+	if (received != nb_events ||
+			port_stat(1, "forward_enqueued") != nb_events ||
+			port_stat(2, "release_enqueued") != nb_events ||
+			port_stat(2, "pending_releases") != 0) {
+		printf("%d: Pipeline stats not correct\n", __LINE__);
+		rte_event_dev_dump(evdev, stdout);
+		return -1;
+	}
+
+	cleanup(t);
+	return 0;
+}
+
+/* New events are refused beyond the instance and port limits, and
+ * accepted again once released, explicitly or by the next dequeue.
+ */
+static int
+test_inflight_limit(struct test *t, uint32_t nb_events_limit,
+		int32_t new_event_threshold, unsigned int expected)
+{
+	struct rte_event ev[32];
+	unsigned int accepted = 0, i;
+	uint16_t n;
+
+	if (init_limit(t, 1, 2, nb_events_limit) < 0 ||
+			create_ports_threshold(t, 2, new_event_threshold) < 0 ||
+			create_atomic_qids(t, 1) < 0 ||
+			link_port(t, 1, 0) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		return -1;
+	}
+
+	for (i = 0; i < 2 * expected; i++)
+		accepted += enqueue_new(t, 0, 0, i, i);
+	if (accepted != expected) {
+		printf("%d: %u events accepted, expected %u\n", __LINE__,
+				accepted, expected);
+		return -1;
+	}
+
+	/* release the first burst explicitly, the others on dequeue */
+	n = rte_event_dequeue_burst(evdev, t->port[1], ev, RTE_DIM(ev), 0);
+	for (i = 0; i < n; i++)
+		ev[i].op = RTE_EVENT_OP_RELEASE;
+	rte_event_enqueue_burst(evdev, t->port[1], ev, n);
+	while (rte_event_dequeue_burst(evdev, t->port[1], ev,
+				RTE_DIM(ev), 0) > 0)
+		;
+
+	if (enqueue_new(t, 0, 0, 0, 0) != 1) {
+		printf("%d: Event refused after release\n", __LINE__);
+		return -1;
+	}
+
+	cleanup(t);
+	return 0;
+}
+
+/*
+ * Flow migration: all the flows served by port 0, port 1 idle. Both ports
+ * forward the events they dequeue back to the queue, checking the order
+ * of each flow, until flows are moved to port 1.
+ */
+#define MIGRATION_PROBE_FLOWS 64
+#define MIGRATION_EVENTS_PER_FLOW 4
+
+static int
+forward_all(struct test *t, int port, struct rte_event *ev, uint16_t n)
+{
+	uint16_t sent = 0;
+	uint64_t timeout = rte_get_timer_cycles() + rte_get_timer_hz();
+
+	while (sent < n) {
+		sent += rte_event_enqueue_burst(evdev, t->port[port],
+				&ev[sent], n - sent);
+		if (rte_get_timer_cycles() > timeout)
+			return -1;
+	}
+	return 0;
+}
+
+static int
+test_migration(struct test *t)
+{
+	uint32_t flows[MIGRATION_PROBE_FLOWS];
+	uint64_t next_seq[MIGRATION_PROBE_FLOWS] = { 0 };
+	unsigned int nb_flows = 0, drained = 0, i, f, p;
+	struct rte_event ev[32];
+	uint64_t end;
+	uint16_t n, j;
+
+	if (init(t, 1, 2) < 0 ||
+			create_ports(t, 2) < 0 ||
+			create_atomic_qids(t, 1) < 0 ||
+			link_port(t, 0, 0) < 0 ||
+			link_port(t, 1, 0) < 0) {
+		printf("%d: Error initializing device\n", __LINE__);
+		return -1;
+	}
+
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%d: Error with start call\n", __LINE__);
+		return -1;
+	}
+
+	/* find the flows initially served by port 0 */
+	for (f = 0; f < MIGRATION_PROBE_FLOWS; f++)
+		if (enqueue_new(t, 0, 0, f, 0) != 1) {
+			printf("%d: Failed to enqueue\n", __LINE__);
+			return -1;
+		}
+	while ((n = rte_event_dequeue_burst(evdev, t->port[0], ev,
+					RTE_DIM(ev), 0)) > 0)
+		for (j = 0; j < n; j++)
+			flows[nb_flows++] = ev[j].flow_id;
+	while (rte_event_dequeue_burst(evdev, t->port[1], ev,
+				RTE_DIM(ev), 0) > 0)
+		;
+	if (nb_flows < 2) {
+		printf("%d: Only %u flows on port 0\n", __LINE__, nb_flows);
+		return -1;
+	}
+
+	/* the data of the events is the index in flows[] and a sequence */
+	for (i = 0; i < MIGRATION_EVENTS_PER_FLOW; i++)
+		for (f = 0; f < nb_flows; f++)
+			if (enqueue_new(t, 0, 0, flows[f],
+					f * 1000000 + i) != 1) {
+				printf("%d: Failed to enqueue\n", __LINE__);
+				return -1;
+			}
+
+	end = rte_get_timer_cycles() + rte_get_timer_hz();
+	while (rte_get_timer_cycles() < end &&
+			port_stat(1, "dequeued") < 10000) {
+		for (p = 0; p < 2; p++) {
+			n = rte_event_dequeue_burst(evdev, t->port[p], ev,
+					RTE_DIM(ev), 0);
+			for (j = 0; j < n; j++) {
+				f = ev[j].u64 / 1000000;
+				if (ev[j].u64 % 1000000 != next_seq[f]) {
+					printf("%d: Flow %u out of order\n",
+							__LINE__, flows[f]);
+					return -1;
+				}
+				next_seq[f]++;
+				ev[j].u64 += MIGRATION_EVENTS_PER_FLOW;
+				ev[j].op = RTE_EVENT_OP_FORWARD;
+			}
+			if (forward_all(t, p, ev, n) < 0) {
+				printf("%d: Failed to forward\n", __LINE__);
+				return -1;
+			}
+		}
+	}
+
+	if (port_stat(0, "emigrations") == 0 ||
+			port_stat(1, "immigrations") == 0 ||
+			port_stat(1, "dequeued") == 0) {
+		printf("%d: No flow migrated\n", __LINE__);
+		rte_event_dev_dump(evdev, stdout);
+		return -1;
+	}
+
+	/* all the events are still there */
+	end = rte_get_timer_cycles() + rte_get_timer_hz() / 10;
+	while (rte_get_timer_cycles() < end)
+		for (p = 0; p < 2; p++)
+			drained += rte_event_dequeue_burst(evdev, t->port[p],
+					ev, RTE_DIM(ev), 0);
+	if (drained != nb_flows * MIGRATION_EVENTS_PER_FLOW) {
+		printf("%d: %u events drained, expected %u\n", __LINE__,
+				drained, nb_flows * MIGRATION_EVENTS_PER_FLOW);
+		return -1;
+	}
+
+	cleanup(t);
+	return 0;
+}
+
+/* Reconfiguring the device gives the credits of the ports back. */
+static int
+test_reconfig(struct test *t)
+{
+	struct rte_event ev;
+	int i;
+
+	for (i = 0; i < 32; i++) {
+		if (init_limit(t, 1, 1, 64) < 0 ||
+				create_ports_threshold(t, 1, 64) < 0 ||
+				create_atomic_qids(t, 1) < 0 ||
+				link_port(t, 0, 0) < 0) {
+			printf("%d: Error initializing device\n", __LINE__);
+			return -1;
+		}
+		if (rte_event_dev_start(evdev) < 0) {
+			printf("%d: Error with start call\n", __LINE__);
+			return -1;
+		}
+		if (enqueue_new(t, 0, 0, 0, i) != 1 ||
+				rte_event_dequeue_burst(evdev, t->port[0],
+					&ev, 1, 0) != 1) {
+			printf("%d: Iteration %d failed\n", __LINE__, i);
+			return -1;
+		}
+		rte_event_dev_stop(evdev);
+	}
+
+	cleanup(t);
+	return 0;
+}
+
+static int
+test_dsw_eventdev(void)
+{
+	struct test t;
+	int ret;
+
+	const char *eventdev_name = "event_dsw0";
+	evdev = rte_event_dev_get_dev_id(eventdev_name);
+	if (evdev < 0) {
+		printf("%d: Eventdev %s not found - creating.\n",
+				__LINE__, eventdev_name);
+		if (rte_vdev_init(eventdev_name, NULL) < 0) {
+			printf("Error creating eventdev\n");
+			return -1;
+		}
+		evdev = rte_event_dev_get_dev_id(eventdev_name);
+		if (evdev < 0) {
+			printf("Error finding newly created eventdev\n");
+			return -1;
+		}
+	}
+
+	printf("*** Running Info test...\n");
+	ret = test_info();
+	if (ret != 0) {
+		printf("ERROR - Info test FAILED.\n");
+		return ret;
+	}
+	printf("*** Running Queue Types test...\n");
+	ret = test_queue_types(&t);
+	if (ret != 0) {
+		printf("ERROR - Queue Types test FAILED.\n");
+		return ret;
+	}
+	printf("*** Running Unlinked Queue test...\n");
+	ret = test_unlinked_queue(&t);
+	if (ret != 0) {
+		printf("ERROR - Unlinked Queue test FAILED.\n");
+		return ret;
+	}
+	printf("*** Running Single Link test...\n");
+	ret = test_single_link(&t);
+	if (ret != 0) {
+		printf("ERROR - Single Link test FAILED.\n");
+		return ret;
+	}
+	printf("*** Running Single Event test...\n");
+	ret = test_single_event(&t);
+	if (ret != 0) {
+		printf("ERROR - Single Event test FAILED.\n");
+		return ret;
+	}
+	printf("*** Running Invalid QID test...\n");
+	ret = test_invalid_qid(&t);
+	if (ret != 0) {
+		printf("ERROR - Invalid QID test FAILED.\n");
+		return ret;
+	}
+	printf("*** Running Atomic Flows test...\n");
+	ret = test_atomic_flows(&t);
+	if (ret != 0) {
+		printf("ERROR - Atomic Flows test FAILED.\n");
+		return ret;
+	}
+	printf("*** Running Parallel Spread test...\n");
+	ret = test_parallel_spread(&t);
+	if (ret != 0) {
+		printf("ERROR - Parallel Spread test FAILED.\n");
+		return ret;
+	}
+	printf("*** Running Pipeline test...\n");
+	ret = test_pipeline(&t);
+	if (ret != 0) {
+		printf("ERROR - Pipeline test FAILED.\n");
+		return ret;
+	}
+	printf("*** Running Inflight Limit test...\n");
+	ret = test_inflight_limit(&t, 64, 64, 64);
+	if (ret != 0) {
+		printf("ERROR - Inflight Limit test FAILED.\n");
+		return ret;
+	}
+	printf("*** Running New Event Threshold test...\n");
+	ret = test_inflight_limit(&t, 4096, 16, 16);
+	if (ret != 0) {
+		printf("ERROR - New Event Threshold test FAILED.\n");
+		return ret;
+	}
+	printf("*** Running Migration test...\n");
+	ret = test_migration(&t);
+	if (ret != 0) {
+		printf("ERROR - Migration test FAILED.\n");
+		return ret;
+	}
+	printf("*** Running Reconfig test...\n");
+	ret = test_reconfig(&t);
+	if (ret != 0) {
+		printf("ERROR - Reconfig test FAILED.\n");
+		return ret;
+	}
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(eventdev_dsw_autotest, test_dsw_eventdev);
@@ -0,0 +1,326 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_dev.h>
+#include <rte_service.h>
+#include <rte_eventdev.h>
+
+#include "test.h"
+
+/*
+ * Distributed software eventdev performance test
+ * ==============================================
+ *
+ * The same pipeline runs on an event_sw and on an event_dsw device:
+ * NB_WORKERS ports, all linked to NB_STAGES atomic queues, and events
+ * circulating from each queue to the next one. The events/s dequeued by
+ * the workers during RUN_MS are reported for both devices.
+ *
+ * The event_sw scheduler service and the workers are spread over the
+ * available lcores, each lcore running its share in turn; event_dsw needs
+ * no scheduler. At the end of each run, the events are drained and counted
+ * to check none is lost.
+ *
+ * The lcores must run on distinct CPUs for the results to be meaningful.
+ * When they share a CPU, the event_sw scheduler only moves a port ring of
+ * events per time slice, and its result drops by orders of magnitude. On
+ * such a host, run the test on a single lcore, which then runs all the
+ * tasks in turn.
+ */
+
+#define NB_STAGES 4
+#define NB_WORKERS 4
+#define NB_FLOWS 256
+#define NB_EVENTS 1024
+#define BURST_SIZE 32
+#define RUN_MS 500
+#define DRAIN_MS 1000
+
+struct perf_worker {
+	uint8_t port_id;
+	uint16_t nb_pending;
+	struct rte_event pending[BURST_SIZE];
+	uint64_t nb_events;
+} __rte_cache_aligned;
+
+struct perf_lcore_tasks {
+	int run_sched;
+	unsigned int nb_workers;
+	struct perf_worker *workers[NB_WORKERS];
+} __rte_cache_aligned;
+
+static int evdev;
+static uint32_t sched_service_id;
+static struct perf_worker workers[NB_WORKERS];
+static struct perf_lcore_tasks lcore_tasks[RTE_MAX_LCORE];
+static volatile uint64_t end_cycles;
+/* forward the events to the next stage, or release them */
+static volatile int forward;
+
+static void
+worker_run(struct perf_worker *w)
+{
+	uint16_t i, n;
+
+	if (w->nb_pending != 0) {
+		n = rte_event_enqueue_burst(evdev, w->port_id, w->pending,
+				w->nb_pending);
+		if (n != w->nb_pending) {
+			memmove(w->pending, &w->pending[n],
+				(w->nb_pending - n) * sizeof(w->pending[0]));
+			w->nb_pending -= n;
+			return;
+		}
+		w->nb_pending = 0;
+	}
+
+	n = rte_event_dequeue_burst(evdev, w->port_id, w->pending,
+			BURST_SIZE, 0);
+	if (n == 0)
+		return;
+	w->nb_events += n;
+
+	if (!forward)
+		return;
+	for (i = 0; i < n; i++) {
+		w->pending[i].queue_id =
+			(w->pending[i].queue_id + 1) % NB_STAGES;
+		w->pending[i].op = RTE_EVENT_OP_FORWARD;
+	}
+	w->nb_pending = n;
+}
+
+static int
+perf_lcore_loop(void *arg)
+{
+	const struct perf_lcore_tasks *t = arg;
+	unsigned int i;
+
+	while (rte_get_timer_cycles() < end_cycles) {
+		if (t->run_sched)
+			rte_service_run_iter_on_app_lcore(sched_service_id, 1);
+		for (i = 0; i < t->nb_workers; i++)
+			worker_run(t->workers[i]);
+	}
+	return 0;
+}
+
+static void
+run_tasks(unsigned int ms)
+{
+	unsigned int lcore_id, idx = 1;
+
+	end_cycles = rte_get_timer_cycles() + ms * rte_get_timer_hz() / 1000;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		rte_eal_remote_launch(perf_lcore_loop, &lcore_tasks[idx++],
+				lcore_id);
+	perf_lcore_loop(&lcore_tasks[0]);
+	rte_eal_mp_wait_lcore();
+}
+
+static uint64_t
+worker_events(void)
+{
+	uint64_t total = 0;
+	unsigned int i;
+
+	for (i = 0; i < NB_WORKERS; i++)
+		total += workers[i].nb_events;
+	return total;
+}
+
+/* Spread the scheduler, if any, then the workers over the lcores. */
+static void
+assign_tasks(int has_sched)
+{
+	const unsigned int nb_lcores = rte_lcore_count();
+	unsigned int i, idx = 0;
+
+	memset(lcore_tasks, 0, sizeof(lcore_tasks));
+	if (has_sched)
+		lcore_tasks[idx++ % nb_lcores].run_sched = 1;
+	for (i = 0; i < NB_WORKERS; i++) {
+		struct perf_lcore_tasks *t = &lcore_tasks[idx++ % nb_lcores];
+
+		t->workers[t->nb_workers++] = &workers[i];
+	}
+}
+
+static int
+setup_device(void)
+{
+	const struct rte_event_dev_config config = {
+		.nb_event_queues = NB_STAGES,
+		.nb_event_ports = NB_WORKERS,
+		.nb_event_queue_flows = 1024,
+		.nb_events_limit = 4096,
+		.nb_event_port_dequeue_depth = BURST_SIZE,
+		.nb_event_port_enqueue_depth = 2 * BURST_SIZE,
+	};
+	const struct rte_event_queue_conf queue_conf = {
+		.event_queue_cfg = RTE_EVENT_QUEUE_CFG_ATOMIC_ONLY,
+		.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+		.nb_atomic_flows = 1024,
+		.nb_atomic_order_sequences = 1024,
+	};
+	const struct rte_event_port_conf port_conf = {
+		.new_event_threshold = 4096,
+		.dequeue_depth = BURST_SIZE,
+		.enqueue_depth = 2 * BURST_SIZE,
+	};
+	uint8_t i;
+
+	if (rte_event_dev_configure(evdev, &config) < 0)
+		return -1;
+	for (i = 0; i < NB_STAGES; i++)
+		if (rte_event_queue_setup(evdev, i, &queue_conf) < 0)
+			return -1;
+	for (i = 0; i < NB_WORKERS; i++) {
+		if (rte_event_port_setup(evdev, i, &port_conf) < 0 ||
+				rte_event_port_link(evdev, i, NULL, NULL, 0) !=
+				NB_STAGES)
+			return -1;
+		memset(&workers[i], 0, sizeof(workers[i]));
+		workers[i].port_id = i;
+	}
+
+	return rte_event_dev_start(evdev);
+}
+
+static int
+inject_events(void)
+{
+	struct rte_event ev[BURST_SIZE];
+	unsigned int i, j;
+
+	for (i = 0; i < NB_EVENTS; i += BURST_SIZE) {
+		for (j = 0; j < BURST_SIZE; j++) {
+			memset(&ev[j], 0, sizeof(ev[j]));
+			ev[j].queue_id = (i + j) % NB_STAGES;
+			ev[j].sched_type = RTE_SCHED_TYPE_ATOMIC;
+			ev[j].flow_id = (i + j) % NB_FLOWS;
+			ev[j].op = RTE_EVENT_OP_NEW;
+		}
+		if (rte_event_enqueue_burst(evdev,
+				(i / BURST_SIZE) % NB_WORKERS, ev,
+				BURST_SIZE) != BURST_SIZE)
+			return -1;
+	}
+	return 0;
+}
+
+static int
+perf_run(const char *name, int has_sched)
+{
+	char service_name[RTE_SERVICE_NAME_MAX];
+	uint64_t start, cycles, received;
+	int ret = -1;
+
+	if (rte_vdev_init(name, NULL) < 0) {
+		printf("Cannot create %s\n", name);
+		return -1;
+	}
+	evdev = rte_event_dev_get_dev_id(name);
+	if (evdev < 0)
+		goto uninit;
+
+	if (setup_device() < 0) {
+		printf("%s: cannot setup device\n", name);
+		goto close;
+	}
+	if (has_sched) {
+		snprintf(service_name, sizeof(service_name), "%s_service",
+				name);
+		if (rte_service_get_by_name(service_name,
+					&sched_service_id) < 0 ||
+				rte_service_runstate_set(sched_service_id,
+					1) < 0) {
+			printf("%s: cannot start scheduler\n", name);
+			goto stop;
+		}
+	}
+	if (inject_events() < 0) {
+		printf("%s: cannot inject events\n", name);
+		goto stop;
+	}
+	assign_tasks(has_sched);
+
+	forward = 1;
+	start = rte_get_timer_cycles();
+	run_tasks(RUN_MS);
+	cycles = rte_get_timer_cycles() - start;
+	received = worker_events();
+
+	printf("%s on %u lcore(s): %.2f Mev/s\n", name, rte_lcore_count(),
+			(double)received * rte_get_timer_hz() / cycles / 1e6);
+
+	/* drain: the events forwarded last are received once more */
+	forward = 0;
+	run_tasks(DRAIN_MS);
+	received = worker_events() - received;
+	if (received != NB_EVENTS) {
+		printf("%s: %"PRIu64" events drained, %u injected\n",
+				name, received, NB_EVENTS);
+		goto stop;
+	}
+	ret = 0;
+
+stop:
+	rte_event_dev_stop(evdev);
+close:
+	rte_event_dev_close(evdev);
+uninit:
+	rte_vdev_uninit(name);
+	return ret;
+}
+
+static int
+test_eventdev_dsw_perf(void)
+{
+	if (perf_run("event_sw_dswperf", 1) < 0 ||
+			perf_run("event_dsw_perf", 0) < 0)
+		return TEST_FAILED;
+
+	return TEST_SUCCESS;
+}
+
+REGISTER_TEST_COMMAND(eventdev_dsw_perf_autotest, test_eventdev_dsw_perf);
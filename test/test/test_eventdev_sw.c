@@ -1057,7 +1057,7 @@ xstats_tests(struct test *t)
 		3 /* tx */,
 		0 /* drop */,
 		3 /* inflights */,
-		512 /* iq size */,
+		4096 /* iq size */,
 		0, 0, 0, 0, /* iq 0, 1, 2, 3 used */
 		0, 0, 1, 0, /* qid_0_port_X_pinned_flows */
 	};
@@ -1084,7 +1084,7 @@ xstats_tests(struct test *t)
 		0 /* tx */,
 		0 /* drop */,
 		3 /* inflight */,
-		512 /* iq size */,
+		4096 /* iq size */,
 		0, 0, 0, 0, /* 4 iq used */
 		0, 0, 1, 0, /* qid to port pinned flows */
 	};
@@ -1674,7 +1674,7 @@ xstats_id_reset_tests(struct test *t)
 		7, /* tx */
 		0, /* drop */
 		7, /* inflight */
-		512, /* iq size */
+		4096, /* iq size */
 		0, /* iq 0 used */
 		0, /* iq 1 used */
 		0, /* iq 2 used */
@@ -1689,7 +1689,7 @@ xstats_id_reset_tests(struct test *t)
 		0, /* tx */
 		0, /* drop */
 		7, /* inflight */
-		512, /* iq size */
+		4096, /* iq size */
 		0, /* iq 0 used */
 		0, /* iq 1 used */
 		0, /* iq 2 used */
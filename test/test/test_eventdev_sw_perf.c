@@ -0,0 +1,418 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_vdev.h>
+#include <rte_service.h>
+#include <rte_eventdev.h>
+
+#include "test.h"
+
+/*
+ * Software eventdev multi-scheduler performance test
+ * ==================================================
+ *
+ * An event_sw device is created with 1, 2 and 4 schedulers (sched_cores
+ * parameter). NB_QIDS atomic queues each feed a worker port, and each
+ * worker forwards the events to the next queue, so that the events
+ * circulate through all the schedulers. The events/s received by the
+ * workers during RUN_MS are reported. A last run adds NB_IDLE_QIDS queues
+ * never receiving events, which the scheduler should not pay for.
+ *
+ * The scheduler services and the workers are spread over the available
+ * lcores, each lcore running its share in turn: with fewer lcores than
+ * schedulers plus workers, the figures do not show the scaling. At the
+ * end of each run, the events are drained and counted to check none is
+ * lost or duplicated.
+ */
+
+#define NB_QIDS 4
+#define NB_WORKERS NB_QIDS
+#define NB_IDLE_QIDS (RTE_EVENT_MAX_QUEUES_PER_DEV - NB_QIDS)
+#define MAX_SCHEDS 4
+#define EVENTS_PER_QID 256
+#define BURST_SIZE 32
+#define RUN_MS 500
+#define DRAIN_MS 1000
+
+struct perf_worker {
+	uint8_t port_id;
+	uint8_t next_qid;
+	uint16_t nb_pending;
+	struct rte_event pending[BURST_SIZE];
+	uint64_t nb_events;
+} __rte_cache_aligned;
+
+struct perf_lcore_tasks {
+	unsigned int nb_scheds;
+	uint32_t service_ids[MAX_SCHEDS];
+	unsigned int nb_workers;
+	struct perf_worker *workers[NB_WORKERS];
+} __rte_cache_aligned;
+
+static int evdev;
+static uint32_t service_ids[MAX_SCHEDS];
+static struct perf_worker workers[NB_WORKERS];
+static struct perf_lcore_tasks lcore_tasks[RTE_MAX_LCORE];
+static volatile uint64_t end_cycles;
+/* forward the events to the next queue, or release them */
+static volatile int forward;
+
+static void
+worker_run(struct perf_worker *w)
+{
+	uint16_t i, n;
+
+	/* events the device did not accept yet */
+	if (w->nb_pending != 0) {
+		n = rte_event_enqueue_burst(evdev, w->port_id, w->pending,
+				w->nb_pending);
+		if (n != w->nb_pending) {
+			memmove(w->pending, &w->pending[n],
+				(w->nb_pending - n) * sizeof(w->pending[0]));
+			w->nb_pending -= n;
+			return;
+		}
+		w->nb_pending = 0;
+	}
+
+	n = rte_event_dequeue_burst(evdev, w->port_id, w->pending,
+			BURST_SIZE, 0);
+	if (n == 0)
+		return;
+	w->nb_events += n;
+
+	if (!forward) {
+		/* the dequeue released the events */
+		return;
+	}
+	for (i = 0; i < n; i++) {
+		w->pending[i].queue_id = w->next_qid;
+		w->pending[i].op = RTE_EVENT_OP_FORWARD;
+	}
+	w->nb_pending = n;
+}
+
+static int
+perf_lcore_loop(void *arg)
+{
+	const struct perf_lcore_tasks *t = arg;
+	unsigned int i;
+
+	while (rte_get_timer_cycles() < end_cycles) {
+		for (i = 0; i < t->nb_scheds; i++)
+			rte_service_run_iter_on_app_lcore(t->service_ids[i], 1);
+		for (i = 0; i < t->nb_workers; i++)
+			worker_run(t->workers[i]);
+	}
+	return 0;
+}
+
+/* Run the tasks on the lcores until ms elapsed. */
+static void
+run_tasks(unsigned int ms)
+{
+	unsigned int lcore_id, idx = 1;
+
+	end_cycles = rte_get_timer_cycles() + ms * rte_get_timer_hz() / 1000;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		rte_eal_remote_launch(perf_lcore_loop, &lcore_tasks[idx++],
+				lcore_id);
+	perf_lcore_loop(&lcore_tasks[0]);
+	rte_eal_mp_wait_lcore();
+}
+
+static uint64_t
+worker_events(void)
+{
+	uint64_t total = 0;
+	unsigned int i;
+
+	for (i = 0; i < NB_WORKERS; i++)
+		total += workers[i].nb_events;
+	return total;
+}
+
+/* Spread the schedulers, then the workers over the lcores. */
+static void
+assign_tasks(unsigned int nb_scheds)
+{
+	const unsigned int nb_lcores = rte_lcore_count();
+	unsigned int i, idx = 0;
+
+	memset(lcore_tasks, 0, sizeof(lcore_tasks));
+	for (i = 0; i < nb_scheds; i++) {
+		struct perf_lcore_tasks *t = &lcore_tasks[idx++ % nb_lcores];
+
+		t->service_ids[t->nb_scheds++] = service_ids[i];
+	}
+	for (i = 0; i < NB_WORKERS; i++) {
+		struct perf_lcore_tasks *t = &lcore_tasks[idx++ % nb_lcores];
+
+		t->workers[t->nb_workers++] = &workers[i];
+	}
+}
+
+static int
+setup_device(const char *name, unsigned int nb_scheds,
+		unsigned int nb_idle_qids)
+{
+	const struct rte_event_dev_config config = {
+		.nb_event_queues = NB_QIDS + nb_idle_qids,
+		.nb_event_ports = NB_WORKERS,
+		.nb_event_queue_flows = 1024,
+		.nb_events_limit = 4096,
+		.nb_event_port_dequeue_depth = BURST_SIZE,
+		.nb_event_port_enqueue_depth = 2 * BURST_SIZE,
+	};
+	const struct rte_event_queue_conf queue_conf = {
+		.event_queue_cfg = RTE_EVENT_QUEUE_CFG_ATOMIC_ONLY,
+		.priority = RTE_EVENT_DEV_PRIORITY_NORMAL,
+		.nb_atomic_flows = 1024,
+		.nb_atomic_order_sequences = 1024,
+	};
+	const struct rte_event_port_conf port_conf = {
+		.new_event_threshold = 4096,
+		.dequeue_depth = BURST_SIZE,
+		.enqueue_depth = 2 * BURST_SIZE,
+	};
+	char service_name[RTE_SERVICE_NAME_MAX];
+	uint8_t qids[RTE_EVENT_MAX_QUEUES_PER_DEV];
+	uint8_t i, q;
+
+	if (rte_event_dev_configure(evdev, &config) < 0)
+		return -1;
+	for (i = 0; i < NB_QIDS + nb_idle_qids; i++)
+		if (rte_event_queue_setup(evdev, i, &queue_conf) < 0)
+			return -1;
+	for (i = 0; i < NB_QIDS; i++) {
+		/* idle queues go to the worker of a queue of their scheduler */
+		uint16_t nb_qids = 0;
+
+		for (q = i; q < NB_QIDS + nb_idle_qids; q += NB_QIDS)
+			qids[nb_qids++] = q;
+		if (rte_event_port_setup(evdev, i, &port_conf) < 0 ||
+				rte_event_port_link(evdev, i, qids, NULL,
+					nb_qids) != nb_qids)
+			return -1;
+		memset(&workers[i], 0, sizeof(workers[i]));
+		workers[i].port_id = i;
+		workers[i].next_qid = (i + 1) % NB_QIDS;
+	}
+	if (rte_event_dev_start(evdev) < 0)
+		return -1;
+
+	for (i = 0; i < nb_scheds; i++) {
+		if (nb_scheds == 1)
+			snprintf(service_name, sizeof(service_name),
+					"%s_service", name);
+		else
+			snprintf(service_name, sizeof(service_name),
+					"%s_service_%u", name, i);
+		if (rte_service_get_by_name(service_name,
+					&service_ids[i]) < 0 ||
+				rte_service_runstate_set(service_ids[i], 1) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
+/* Inject the events, EVENTS_PER_QID flows in each queue. */
+static int
+inject_events(void)
+{
+	struct rte_event ev[BURST_SIZE];
+	unsigned int q, i, j;
+
+	for (q = 0; q < NB_QIDS; q++) {
+		for (i = 0; i < EVENTS_PER_QID; i += BURST_SIZE) {
+			for (j = 0; j < BURST_SIZE; j++) {
+				memset(&ev[j], 0, sizeof(ev[j]));
+				ev[j].queue_id = q;
+				ev[j].sched_type = RTE_SCHED_TYPE_ATOMIC;
+				ev[j].flow_id = i + j;
+				ev[j].op = RTE_EVENT_OP_NEW;
+				ev[j].u64 = q * EVENTS_PER_QID + i + j;
+			}
+			if (rte_event_enqueue_burst(evdev, q, ev,
+					BURST_SIZE) != BURST_SIZE)
+				return -1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * A port linked to two queues, which would otherwise go to two
+ * schedulers, keeps them on the same one: the device starts and the
+ * events of both queues reach the port.
+ */
+static int
+check_shared_port(const char *name)
+{
+	const struct rte_event_dev_config config = {
+		.nb_event_queues = 2,
+		.nb_event_ports = 1,
+		.nb_event_queue_flows = 1024,
+		.nb_events_limit = 4096,
+		.nb_event_port_dequeue_depth = BURST_SIZE,
+		.nb_event_port_enqueue_depth = 2 * BURST_SIZE,
+	};
+	struct rte_event ev;
+	unsigned int q, i;
+	int ret = -1;
+
+	if (rte_event_dev_configure(evdev, &config) < 0 ||
+			rte_event_queue_setup(evdev, 0, NULL) < 0 ||
+			rte_event_queue_setup(evdev, 1, NULL) < 0 ||
+			rte_event_port_setup(evdev, 0, NULL) < 0 ||
+			rte_event_port_link(evdev, 0, NULL, NULL, 0) != 2) {
+		printf("%s: cannot setup device\n", name);
+		return -1;
+	}
+	if (rte_event_dev_start(evdev) < 0) {
+		printf("%s: port linked to two queues refused\n", name);
+		goto close;
+	}
+
+	for (q = 0; q < config.nb_event_queues; q++) {
+		memset(&ev, 0, sizeof(ev));
+		ev.queue_id = q;
+		ev.sched_type = RTE_SCHED_TYPE_ATOMIC;
+		ev.op = RTE_EVENT_OP_NEW;
+		if (rte_event_enqueue_burst(evdev, 0, &ev, 1) != 1)
+			goto stop;
+		for (i = 0; i < 100; i++) {
+			rte_event_schedule(evdev);
+			if (rte_event_dequeue_burst(evdev, 0, &ev, 1, 0) == 1)
+				break;
+		}
+		if (i == 100 || ev.queue_id != q) {
+			printf("%s: event of queue %u not received\n", name, q);
+			goto stop;
+		}
+		ev.op = RTE_EVENT_OP_RELEASE;
+		rte_event_enqueue_burst(evdev, 0, &ev, 1);
+	}
+	ret = 0;
+
+stop:
+	rte_event_dev_stop(evdev);
+close:
+	rte_event_dev_close(evdev);
+	return ret;
+}
+
+static int
+perf_run(unsigned int nb_scheds, unsigned int nb_idle_qids)
+{
+	const uint64_t nb_injected = NB_QIDS * EVENTS_PER_QID;
+	char name[32], args[32];
+	uint64_t start, cycles, received;
+	int ret = -1;
+
+	snprintf(name, sizeof(name), "event_sw_perf%u", nb_scheds);
+	snprintf(args, sizeof(args), "sched_cores=%u", nb_scheds);
+	if (rte_vdev_init(name, args) < 0) {
+		printf("Cannot create %s\n", name);
+		return -1;
+	}
+	evdev = rte_event_dev_get_dev_id(name);
+	if (evdev < 0)
+		goto uninit;
+
+	if (nb_scheds > 1 && check_shared_port(name) < 0)
+		goto uninit;
+
+	if (setup_device(name, nb_scheds, nb_idle_qids) < 0 ||
+			inject_events() < 0) {
+		printf("%s: cannot setup device\n", name);
+		goto close;
+	}
+	assign_tasks(nb_scheds);
+
+	forward = 1;
+	start = rte_get_timer_cycles();
+	run_tasks(RUN_MS);
+	cycles = rte_get_timer_cycles() - start;
+	received = worker_events();
+
+	printf("%u scheduler(s) on %u lcore(s), %u idle queues: %.2f Mev/s\n",
+			nb_scheds, rte_lcore_count(), nb_idle_qids,
+			(double)received * rte_get_timer_hz() / cycles / 1e6);
+
+	/* drain: the events forwarded last are received once more */
+	forward = 0;
+	run_tasks(DRAIN_MS);
+	received = worker_events() - received;
+	if (received != nb_injected) {
+		printf("%s: %"PRIu64" events drained, %"PRIu64" injected\n",
+				name, received, nb_injected);
+		goto stop;
+	}
+	ret = 0;
+
+stop:
+	rte_event_dev_stop(evdev);
+close:
+	rte_event_dev_close(evdev);
+uninit:
+	rte_vdev_uninit(name);
+	return ret;
+}
+
+static int
+test_eventdev_sw_perf(void)
+{
+	static const unsigned int nb_scheds[] = { 1, 2, MAX_SCHEDS };
+	unsigned int i;
+
+	for (i = 0; i < RTE_DIM(nb_scheds); i++)
+		if (perf_run(nb_scheds[i], 0) < 0)
+			return TEST_FAILED;
+	if (perf_run(1, NB_IDLE_QIDS) < 0)
+		return TEST_FAILED;
+
+	return TEST_SUCCESS;
+}
+
+REGISTER_TEST_COMMAND(eventdev_sw_perf_autotest, test_eventdev_sw_perf);
@@ -0,0 +1,184 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_cycles.h>
+#include <rte_lcore_poll.h>
+
+#include "test.h"
+
+/*
+ * One poll out of BUSY_PERIOD gets items and is followed by BUSY_US of
+ * processing; the empty polls are followed by IDLE_US. The busy ratio is
+ * about 50%, the loop measures it to compare with the statistics, as the
+ * lcore may be preempted.
+ */
+#define NB_POLLS 1000
+#define BUSY_PERIOD 4
+#define BUSY_US 60
+#define IDLE_US 20
+
+static uint64_t measured_busy;
+static uint64_t measured_idle;
+
+static int
+poll_loop(void *arg __rte_unused)
+{
+	uint64_t start, end;
+	unsigned int i;
+
+	measured_busy = 0;
+	measured_idle = 0;
+	for (i = 0; i < NB_POLLS; i++) {
+		if (i % BUSY_PERIOD == 0) {
+			rte_lcore_poll_mark(32);
+			start = rte_rdtsc();
+			rte_delay_us(BUSY_US);
+			end = rte_rdtsc();
+			measured_busy += end - start;
+		} else {
+			rte_lcore_poll_mark(0);
+			start = rte_rdtsc();
+			rte_delay_us(IDLE_US);
+			end = rte_rdtsc();
+			measured_idle += end - start;
+		}
+	}
+
+	return 0;
+}
+
+/* mark polls on the master lcore only */
+static int
+master_poll_loop(void *arg __rte_unused)
+{
+	unsigned int i;
+
+	if (rte_lcore_id() != rte_get_master_lcore())
+		return 0;
+	for (i = 0; i < NB_POLLS; i++)
+		rte_lcore_poll_mark(i % BUSY_PERIOD == 0 ? 32 : 0);
+
+	return 0;
+}
+
+static int
+run_poll_loop(unsigned int lcore_id, struct rte_lcore_poll_stats *delta)
+{
+	struct rte_lcore_poll_stats before, after;
+
+	if (rte_lcore_poll_stats_get(lcore_id, &before) != 0)
+		return -1;
+	rte_eal_remote_launch(poll_loop, NULL, lcore_id);
+	rte_eal_wait_lcore(lcore_id);
+	if (rte_lcore_poll_stats_get(lcore_id, &after) != 0)
+		return -1;
+
+	delta->busy_cycles = after.busy_cycles - before.busy_cycles;
+	delta->idle_cycles = after.idle_cycles - before.idle_cycles;
+	delta->busy_polls = after.busy_polls - before.busy_polls;
+	delta->idle_polls = after.idle_polls - before.idle_polls;
+
+	return 0;
+}
+
+static int
+test_lcore_poll(void)
+{
+	struct rte_lcore_poll_stats delta, before, after;
+	unsigned int lcore_id;
+	uint64_t percent, expected;
+
+	if (rte_lcore_poll_stats_enable(1) == -ENOTSUP) {
+		printf("Lcore poll statistics disabled at build time, "
+		       "skipping\n");
+		return 0;
+	}
+	if (rte_lcore_count() < 2) {
+		printf("Not enough lcores, skipping\n");
+		rte_lcore_poll_stats_enable(0);
+		return 0;
+	}
+
+	TEST_ASSERT(rte_lcore_poll_stats_get(RTE_MAX_LCORE, &delta) ==
+		    -EINVAL, "Invalid lcore accepted");
+
+	lcore_id = rte_get_next_lcore(-1, 1, 0);
+	TEST_ASSERT_SUCCESS(run_poll_loop(lcore_id, &delta),
+			    "Cannot get the statistics");
+	rte_lcore_poll_stats_enable(0);
+
+	percent = delta.busy_cycles * 100 /
+		(delta.busy_cycles + delta.idle_cycles);
+	expected = measured_busy * 100 / (measured_busy + measured_idle);
+	printf("lcore %u: %"PRIu64" busy cycles, %"PRIu64" idle cycles "
+	       "(%"PRIu64"%% busy, %"PRIu64"%% measured), %"PRIu64
+	       " busy polls, %"PRIu64" idle polls\n", lcore_id,
+	       delta.busy_cycles, delta.idle_cycles, percent, expected,
+	       delta.busy_polls, delta.idle_polls);
+	TEST_ASSERT(delta.busy_polls == NB_POLLS / BUSY_PERIOD &&
+		    delta.idle_polls == NB_POLLS - NB_POLLS / BUSY_PERIOD,
+		    "Wrong poll counts");
+	TEST_ASSERT(percent + 5 >= expected && percent <= expected + 5,
+		    "Busy ratio %"PRIu64"%% instead of %"PRIu64"%%",
+		    percent, expected);
+
+	/* the accounting of the master lcore stops with its function */
+	rte_lcore_poll_stats_enable(1);
+	rte_eal_mp_remote_launch(master_poll_loop, NULL, CALL_MASTER);
+	rte_eal_mp_wait_lcore();
+	rte_lcore_poll_stats_enable(0);
+	rte_lcore_poll_stats_get(rte_get_master_lcore(), &before);
+	rte_delay_us(IDLE_US);
+	rte_lcore_poll_stats_get(rte_get_master_lcore(), &after);
+	TEST_ASSERT(after.busy_cycles == before.busy_cycles &&
+		    after.idle_cycles == before.idle_cycles,
+		    "Master lcore still accounted after its function");
+
+	TEST_ASSERT_SUCCESS(run_poll_loop(lcore_id, &delta),
+			    "Cannot get the statistics");
+	TEST_ASSERT(delta.busy_cycles == 0 && delta.idle_cycles == 0 &&
+		    delta.busy_polls == 0 && delta.idle_polls == 0,
+		    "Statistics updated while disabled");
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(lcore_poll_autotest, test_lcore_poll);
@@ -0,0 +1,260 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef RTE_EXEC_ENV_LINUXAPP
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_memory.h>
+#include <rte_launch.h>
+#include <rte_lcore_var.h>
+
+#include "test.h"
+
+#define NB_SMALL_VARS 1000
+#define BIG_VAR_SIZE (RTE_MAX_LCORE_VAR / 2)
+
+struct lcore_state {
+	uint64_t lcore_id;
+	uint32_t count;
+	uint8_t flag;
+};
+
+static RTE_LCORE_VAR_HANDLE(struct lcore_state, test_state);
+RTE_LCORE_VAR_INIT(test_state);
+
+static int
+test_lcore_var_alloc(void)
+{
+	RTE_LCORE_VAR_HANDLE(uint8_t, small);
+	RTE_LCORE_VAR_HANDLE(uint64_t, aligned);
+	RTE_LCORE_VAR_HANDLE(char, big);
+	unsigned int lcore_id;
+	uint64_t *value;
+	int i;
+
+	TEST_ASSERT_NOT_NULL(test_state, "Lcore variable not allocated at init");
+	TEST_ASSERT(rte_lcore_var_alloc(0, 8) == NULL, "Empty value accepted");
+	TEST_ASSERT(rte_lcore_var_alloc(RTE_MAX_LCORE_VAR + 1, 8) == NULL,
+		    "Too big value accepted");
+	TEST_ASSERT(rte_lcore_var_alloc(8, 3) == NULL,
+		    "Invalid alignment accepted");
+
+	RTE_LCORE_VAR_ALLOC(small);
+	TEST_ASSERT_NOT_NULL(small, "Cannot allocate a small variable");
+	RTE_LCORE_VAR_ALLOC_SIZE_ALIGN(aligned, sizeof(*aligned), 64);
+	TEST_ASSERT_NOT_NULL(aligned, "Cannot allocate an aligned variable");
+	TEST_ASSERT(((uintptr_t)aligned & 63) == 0, "Wrong alignment");
+
+	RTE_LCORE_VAR_FOREACH(lcore_id, value, aligned) {
+		TEST_ASSERT(*value == 0, "Value of lcore %u not zeroed",
+			    lcore_id);
+		TEST_ASSERT(RTE_PTR_DIFF(value, aligned) ==
+			    lcore_id * RTE_MAX_LCORE_VAR,
+			    "Wrong value address for lcore %u", lcore_id);
+	}
+
+	/* fill several buffers */
+	for (i = 0; i < NB_SMALL_VARS; i++) {
+		RTE_LCORE_VAR_ALLOC_SIZE(big, RTE_MAX_LCORE_VAR / 16);
+		TEST_ASSERT_NOT_NULL(big, "Cannot allocate variable %d", i);
+		TEST_ASSERT(big[0] == 0 &&
+			    big[RTE_MAX_LCORE_VAR / 16 - 1] == 0,
+			    "Variable %d not zeroed", i);
+		/* the next variables are checked not to overlap */
+		big[0] = 1;
+		big[RTE_MAX_LCORE_VAR / 16 - 1] = 1;
+	}
+
+	return 0;
+}
+
+static int
+lcore_fn(void *arg __rte_unused)
+{
+	struct lcore_state *state = RTE_LCORE_VAR(test_state);
+
+	state->lcore_id = rte_lcore_id();
+	state->count++;
+	state->flag = 1;
+
+	return 0;
+}
+
+static int
+test_lcore_var_access(void)
+{
+	const struct lcore_state *state;
+	unsigned int lcore_id;
+
+	memset(RTE_LCORE_VAR(test_state), 0, sizeof(struct lcore_state));
+	rte_eal_mp_remote_launch(lcore_fn, NULL, CALL_MASTER);
+	rte_eal_mp_wait_lcore();
+
+	RTE_LCORE_VAR_FOREACH(lcore_id, state, test_state) {
+		if (!rte_lcore_is_enabled(lcore_id))
+			continue;
+		TEST_ASSERT(state->lcore_id == lcore_id && state->flag == 1 &&
+			    state->count >= 1,
+			    "Wrong value for lcore %u", lcore_id);
+	}
+
+	return 0;
+}
+
+/* resident memory of the process, in bytes */
+static uint64_t
+get_rss(void)
+{
+	unsigned long size, rss = 0;
+	FILE *f;
+
+	f = fopen("/proc/self/statm", "r");
+	if (f == NULL)
+		return 0;
+	if (fscanf(f, "%lu %lu", &size, &rss) != 2)
+		rss = 0;
+	fclose(f);
+
+	return (uint64_t)rss * getpagesize();
+}
+
+static int
+test_lcore_var_memory(void)
+{
+	RTE_LCORE_VAR_HANDLE(char, big);
+	unsigned int lcore_id;
+	uint64_t rss;
+
+	rss = get_rss();
+	RTE_LCORE_VAR_ALLOC_SIZE(big, BIG_VAR_SIZE);
+	TEST_ASSERT_NOT_NULL(big, "Cannot allocate a big variable");
+	RTE_LCORE_FOREACH(lcore_id)
+		memset(RTE_LCORE_VAR_LCORE(lcore_id, big), 1, BIG_VAR_SIZE);
+	rss = get_rss() - rss;
+
+	printf("%u bytes per lcore, %u lcores: %"PRIu64" bytes resident, "
+	       "%zu bytes for a [RTE_MAX_LCORE] array\n",
+	       BIG_VAR_SIZE, rte_lcore_count(), rss,
+	       (size_t)BIG_VAR_SIZE * RTE_MAX_LCORE);
+
+	return 0;
+}
+
+/* NUMA node of the page of addr, or -1 if it cannot be queried */
+static int
+get_page_node(void *addr)
+{
+#ifdef RTE_EXEC_ENV_LINUXAPP
+	int node;
+
+	if (syscall(__NR_get_mempolicy, &node, NULL, 0, addr,
+			MPOL_F_NODE | MPOL_F_ADDR) != 0)
+		return -1;
+	return node;
+#else
+	RTE_SET_USED(addr);
+	return -1;
+#endif
+}
+
+/*
+ * The values of an lcore are placed on its socket even when another lcore
+ * touches them first, for the variables allocated before EAL init (bound
+ * at init) and after (bound at allocation).
+ */
+static int
+test_lcore_var_numa(void)
+{
+	RTE_LCORE_VAR_HANDLE(uint64_t, late);
+	uint64_t *handles[2];
+	unsigned int lcore_id, i;
+	uint64_t *value;
+	int socket_id, node;
+
+	RTE_LCORE_VAR_ALLOC(late);
+	TEST_ASSERT_NOT_NULL(late, "Cannot allocate a variable");
+	handles[0] = &test_state->lcore_id;
+	handles[1] = late;
+
+	for (i = 0; i < RTE_DIM(handles); i++) {
+		RTE_LCORE_FOREACH(lcore_id) {
+			/* written by the master lcore, as at library init */
+			value = RTE_LCORE_VAR_LCORE(lcore_id, handles[i]);
+			*value = lcore_id;
+			node = get_page_node(value);
+			if (node < 0) {
+				printf("Cannot get the NUMA node of a page, "
+				       "skipping\n");
+				return 0;
+			}
+			socket_id = rte_lcore_to_socket_id(lcore_id);
+			if (socket_id == SOCKET_ID_ANY)
+				continue;
+			TEST_ASSERT(node == socket_id, "Value of lcore %u on "
+				    "node %d instead of %d", lcore_id, node,
+				    socket_id);
+		}
+	}
+
+	return 0;
+}
+
+static struct unit_test_suite lcore_var_tests = {
+	.suite_name = "lcore variable autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE(test_lcore_var_alloc),
+		TEST_CASE(test_lcore_var_access),
+		TEST_CASE(test_lcore_var_memory),
+		TEST_CASE(test_lcore_var_numa),
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_lcore_var(void)
+{
+	return unit_test_suite_runner(&lcore_var_tests);
+}
+
+REGISTER_TEST_COMMAND(lcore_var_autotest, test_lcore_var);
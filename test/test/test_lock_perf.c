@@ -0,0 +1,238 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Arm Limited
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Arm Limited nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_launch.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_spinlock.h>
+#include <rte_ticketlock.h>
+#include <rte_mcslock.h>
+
+#include "test.h"
+
+/*
+ * Lock performance test
+ * =====================
+ *
+ * Compare the spinlock, the ticketlock and the MCS lock:
+ *
+ * - the cost of an uncontended lock/unlock pair on a single core;
+ *
+ * - the throughput and the fairness when all the cores hammer the same
+ *   lock for a fixed time, with a short critical section updating shared
+ *   data and a short delay outside of it. The fairness is given as the
+ *   ratio between the least and the most served cores and as Jain's index
+ *   (1.0 when all the cores took the lock the same number of times,
+ *   1/n when a single core took it every time).
+ */
+
+#define TIME_MS 100
+#define UNCONTENDED_ITERATIONS (1 << 20)
+#define CS_WORDS 8
+
+enum lock_type {
+	LOCK_SPIN,
+	LOCK_TICKET,
+	LOCK_MCS,
+	LOCK_TYPE_MAX,
+};
+
+static const char * const lock_names[LOCK_TYPE_MAX] = {
+	[LOCK_SPIN] = "spinlock",
+	[LOCK_TICKET] = "ticketlock",
+	[LOCK_MCS] = "mcslock",
+};
+
+static rte_spinlock_t sl;
+static rte_ticketlock_t tl;
+static rte_mcslock_t *ml;
+
+/* data protected by the lock, written in the critical section */
+static volatile uint64_t cs_data[CS_WORDS] __rte_cache_aligned;
+
+static uint64_t lock_count[RTE_MAX_LCORE];
+static rte_atomic32_t synchro;
+
+static inline void
+critical_section(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < CS_WORDS; i++)
+		cs_data[i]++;
+}
+
+static inline void
+lock_and_run(enum lock_type type, rte_mcslock_t *me)
+{
+	switch (type) {
+	case LOCK_SPIN:
+		rte_spinlock_lock(&sl);
+		critical_section();
+		rte_spinlock_unlock(&sl);
+		break;
+	case LOCK_TICKET:
+		rte_ticketlock_lock(&tl);
+		critical_section();
+		rte_ticketlock_unlock(&tl);
+		break;
+	case LOCK_MCS:
+		rte_mcslock_lock(&ml, me);
+		critical_section();
+		rte_mcslock_unlock(&ml, me);
+		break;
+	default:
+		break;
+	}
+}
+
+static int
+load_loop_fn(void *arg)
+{
+	const enum lock_type type = *(const enum lock_type *)arg;
+	const unsigned int lcore = rte_lcore_id();
+	const uint64_t duration = rte_get_timer_hz() * TIME_MS / 1000;
+	uint64_t lcount = 0;
+	uint64_t begin;
+	rte_mcslock_t me;
+
+	/* wait synchro for slaves */
+	if (lcore != rte_get_master_lcore())
+		while (rte_atomic32_read(&synchro) == 0)
+			;
+
+	begin = rte_get_timer_cycles();
+	while (rte_get_timer_cycles() - begin < duration) {
+		lock_and_run(type, &me);
+		lcount++;
+		/* delay to make lock duty cycle slightly realistic */
+		rte_delay_us(1);
+	}
+	lock_count[lcore] = lcount;
+
+	return 0;
+}
+
+static void
+test_lock_uncontended(enum lock_type type)
+{
+	rte_mcslock_t me;
+	uint64_t begin, end;
+	unsigned int i;
+
+	begin = rte_rdtsc();
+	for (i = 0; i < UNCONTENDED_ITERATIONS; i++)
+		lock_and_run(type, &me);
+	end = rte_rdtsc();
+
+	printf("%-10s uncontended: %.2f cycles per lock/unlock\n",
+	       lock_names[type],
+	       (double)(end - begin) / UNCONTENDED_ITERATIONS);
+}
+
+static int
+test_lock_contended(enum lock_type type)
+{
+	uint64_t total = 0, min = UINT64_MAX, max = 0;
+	double sum_sq = 0;
+	unsigned int n = 0;
+	unsigned int i;
+
+	memset(lock_count, 0, sizeof(lock_count));
+
+	/* Clear synchro and start slaves */
+	rte_atomic32_set(&synchro, 0);
+	rte_eal_mp_remote_launch(load_loop_fn, &type, SKIP_MASTER);
+
+	/* start synchro and launch test on master */
+	rte_atomic32_set(&synchro, 1);
+	load_loop_fn(&type);
+
+	rte_eal_mp_wait_lcore();
+
+	RTE_LCORE_FOREACH(i) {
+		total += lock_count[i];
+		sum_sq += (double)lock_count[i] * lock_count[i];
+		min = RTE_MIN(min, lock_count[i]);
+		max = RTE_MAX(max, lock_count[i]);
+		n++;
+	}
+
+	printf("%-10s %u cores: total %"PRIu64" (%.0f per ms), "
+	       "min/max %.3f, Jain's index %.3f\n",
+	       lock_names[type], n, total, (double)total / TIME_MS,
+	       max != 0 ? (double)min / max : 0,
+	       sum_sq != 0 ? (double)total * total / (n * sum_sq) : 0);
+
+	return total != 0 ? 0 : -1;
+}
+
+static int
+test_lock_perf(void)
+{
+	enum lock_type type;
+
+	rte_spinlock_init(&sl);
+	rte_ticketlock_init(&tl);
+	ml = NULL;
+
+	printf("\n### Single core ###\n");
+	for (type = 0; type < LOCK_TYPE_MAX; type++)
+		test_lock_uncontended(type);
+
+	printf("\n### Contended, %u ms ###\n", TIME_MS);
+	for (type = 0; type < LOCK_TYPE_MAX; type++) {
+		if (test_lock_contended(type) < 0) {
+			printf("No lock taken with %s\n", lock_names[type]);
+			return -1;
+		}
+	}
+
+	if (cs_data[0] != cs_data[CS_WORDS - 1]) {
+		printf("Critical section data is inconsistent\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(lock_perf_autotest, test_lock_perf);
@@ -34,6 +34,8 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdarg.h>
+#include <string.h>
+#include <inttypes.h>
 #include <sys/queue.h>
 
 #include <rte_log.h>
@@ -43,6 +45,7 @@
 #include <rte_eal.h>
 #include <rte_per_lcore.h>
 #include <rte_lcore.h>
+#include <rte_cycles.h>
 
 #include "test.h"
 
@@ -56,8 +59,159 @@
  * - Enable log types.
  * - Set log level.
  * - Send logs with different types and levels, some should not be displayed.
+ * - Limit the rate of a log type and check the dropped messages.
+ * - Start the asynchronous backend, check that all messages are either
+ *   written in order or counted as dropped.
  */
 
+#define RATE_LIMIT 5
+#define RATE_MSGS 20
+#define ASYNC_MSGS 10
+#define ASYNC_BURST (RTE_LOG_ASYNC_RING_SIZE * 4)
+
+/* count the lines of f containing str */
+static unsigned int
+count_lines(FILE *f, const char *str)
+{
+	char line[RTE_LOG_ASYNC_MSG_SIZE];
+	unsigned int count = 0;
+
+	fflush(f);
+	rewind(f);
+	while (fgets(line, sizeof(line), f) != NULL) {
+		if (strstr(line, str) != NULL)
+			count++;
+	}
+	/* the next messages are appended */
+	fseek(f, 0, SEEK_END);
+
+	return count;
+}
+
+static int
+test_logs_rate_limit(FILE *f)
+{
+	int type;
+	unsigned int i;
+
+	type = rte_log_register("test.ratelimit");
+	TEST_ASSERT(type >= 0, "Cannot register log type");
+	rte_log_set_level(type, RTE_LOG_DEBUG);
+	TEST_ASSERT_SUCCESS(rte_log_set_rate_limit(type, RATE_LIMIT),
+		"Cannot set rate limit");
+	TEST_ASSERT(rte_log_set_rate_limit(UINT32_MAX, 1) < 0,
+		"Rate limit set on invalid type");
+
+	for (i = 0; i < RATE_MSGS; i++)
+		rte_log(RTE_LOG_INFO, type, "rate message %u\n", i);
+
+	TEST_ASSERT_EQUAL(count_lines(f, "rate message"), RATE_LIMIT,
+		"Rate limit not applied");
+	TEST_ASSERT_EQUAL(rte_log_get_suppressed(type),
+		RATE_MSGS - RATE_LIMIT, "Wrong suppressed count");
+
+	/* the next second reports the suppressed messages */
+	rte_delay_ms(1100);
+	rte_log(RTE_LOG_INFO, type, "rate message after\n");
+	TEST_ASSERT_EQUAL(count_lines(f, "messages of log type "
+		"test.ratelimit suppressed"), 1, "No suppressed notice");
+	TEST_ASSERT_EQUAL(count_lines(f, "rate message after"), 1,
+		"Message dropped after rate limit period");
+
+	rte_log_set_rate_limit(type, 0);
+	return 0;
+}
+
+static int
+test_logs_async(FILE *f)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	uint64_t dropped;
+	unsigned int i, written;
+	char line[32];
+	int ret;
+
+	ret = rte_log_async_start();
+	TEST_ASSERT_SUCCESS(ret, "Cannot start asynchronous log");
+	TEST_ASSERT(rte_log_async_is_enabled(), "Asynchronous log disabled");
+
+	for (i = 0; i < ASYNC_MSGS; i++)
+		RTE_LOG(INFO, USER1, "async message %u\n", i);
+	rte_log_async_flush();
+
+	/* check the order */
+	fflush(f);
+	rewind(f);
+	i = 0;
+	while (fgets(line, sizeof(line), f) != NULL) {
+		unsigned int n;
+
+		if (sscanf(line, "USER1: async message %u", &n) != 1)
+			continue;
+		TEST_ASSERT_EQUAL(n, i, "Message %u out of order", n);
+		i++;
+	}
+	fseek(f, 0, SEEK_END);
+	TEST_ASSERT_EQUAL(i, ASYNC_MSGS, "Lost messages");
+
+	/* more messages than the ring can hold */
+	dropped = rte_log_async_dropped(lcore_id);
+	for (i = 0; i < ASYNC_BURST; i++)
+		RTE_LOG(INFO, USER1, "burst message %u\n", i);
+	rte_log_async_flush();
+	dropped = rte_log_async_dropped(lcore_id) - dropped;
+	written = count_lines(f, "burst message");
+	printf("async log: %u messages written, %"PRIu64" dropped\n",
+		written, dropped);
+	TEST_ASSERT_EQUAL(written + dropped, ASYNC_BURST,
+		"Messages neither written nor dropped");
+	if (dropped != 0)
+		TEST_ASSERT(count_lines(f, "log messages dropped") > 0,
+			"Dropped messages not reported");
+
+	rte_log_async_stop();
+	TEST_ASSERT(!rte_log_async_is_enabled(), "Asynchronous log enabled");
+
+	/* synchronous again */
+	RTE_LOG(INFO, USER1, "synchronous message\n");
+	TEST_ASSERT_EQUAL(count_lines(f, "synchronous message"), 1,
+		"Synchronous message not written");
+
+	return 0;
+}
+
+static int
+test_logs_backends(void)
+{
+	uint32_t level = rte_log_get_global_level();
+	FILE *stream = rte_logs.file;
+	int async = rte_log_async_is_enabled();
+	FILE *f;
+	int ret;
+
+	/* stop the backend started with --log-async, if any */
+	rte_log_async_stop();
+
+	f = tmpfile();
+	TEST_ASSERT_NOT_NULL(f, "Cannot create log file");
+	rte_openlog_stream(f);
+	rte_log_set_global_level(RTE_LOG_DEBUG);
+	rte_log_set_level(RTE_LOGTYPE_USER1, RTE_LOG_DEBUG);
+
+	ret = test_logs_rate_limit(f);
+	if (ret == 0)
+		ret = test_logs_async(f);
+
+	rte_log_async_stop();
+	rte_openlog_stream(stream);
+	rte_log_set_global_level(level);
+	fclose(f);
+	if (async)
+		rte_log_async_start();
+
+	return ret;
+}
+
 static int
 test_logs(void)
 {
@@ -83,7 +237,7 @@ test_logs(void)
 	RTE_LOG(ERR, TESTAPP1, "error message\n");
 	RTE_LOG(ERR, TESTAPP2, "error message (not displayed)\n");
 
-	return 0;
+	return test_logs_backends();
 }
 
 REGISTER_TEST_COMMAND(logs_autotest, test_logs);
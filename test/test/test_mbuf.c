@@ -55,6 +55,8 @@
 #include <rte_branch_prediction.h>
 #include <rte_ring.h>
 #include <rte_mempool.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
 #include <rte_mbuf.h>
 #include <rte_random.h>
 #include <rte_cycles.h>
@@ -80,6 +82,11 @@
 
 #define MAGIC_DATA              0x42424242
 
+#define EXT_BUF_SIZE            4096
+#define FREE_BULK_BURST         32
+#define FREE_BULK_ITERATIONS    10000
+#define EXT_BUF_NB_SLICES       8
+
 #define MAKE_STRING(x)          # x
 
 static struct rte_mempool *pktmbuf_pool = NULL;
@@ -132,6 +139,23 @@ static unsigned refcnt_lcore[RTE_MAX_LCORE];
  *    - Clone a mbuf and verify the data
  *    - Clone the cloned mbuf and verify the data
  *    - Attach a mbuf to another that does not have the same priv_size.
+ *
+ * #. Test external buffer attachment
+ *    - Attach an external buffer to a mbuf, clone it, and check that the
+ *      buffer is freed when the last mbuf referencing it is freed.
+ *    - Attach several mbufs to slices of the same external buffer.
+ *
+ * #. Test dynamic fields and flags
+ *    - Register fields and flags, check their offsets and that invalid
+ *      or conflicting registrations are refused.
+ *    - Check a dynamic field and flag are kept in a clone.
+ *
+ * #. Test bulk free
+ *    - Free single and multi-segment packets, clones, and packets from
+ *      different pools with rte_pktmbuf_free_bulk(), and check all the
+ *      mbufs are back in their pools.
+ *    - Compare the cost of rte_pktmbuf_free_bulk() with a loop of
+ *      rte_pktmbuf_free().
  */
 
 #define GOTO_FAIL(str, ...) do {					\
@@ -536,6 +560,494 @@ test_attach_from_different_pool(void)
 		rte_pktmbuf_free(clone2);
 	return -1;
 }
+
+static unsigned int ext_buf_freed;
+
+static void
+ext_buf_free_cb(void *addr, void *opaque)
+{
+	RTE_SET_USED(addr);
+
+	ext_buf_freed++;
+	rte_free(opaque);
+}
+
+/*
+ * Attach an external buffer holding its shared info at its end, clone
+ * the mbuf and attach another one to the clone, then check the buffer
+ * is freed only once all the mbufs referencing it are.
+ */
+static int
+test_pktmbuf_ext_buf(void)
+{
+	struct rte_mbuf *m = NULL;
+	struct rte_mbuf *clone = NULL;
+	struct rte_mbuf *clone2 = NULL;
+	struct rte_mbuf_ext_shared_info *shinfo;
+	uint16_t buf_len = EXT_BUF_SIZE;
+	char *ext_buf, *data;
+
+	ext_buf_freed = 0;
+	ext_buf = rte_malloc("test_ext_buf", EXT_BUF_SIZE, 0);
+	if (ext_buf == NULL)
+		GOTO_FAIL("cannot allocate external buffer");
+
+	shinfo = rte_pktmbuf_ext_shinfo_init_helper(ext_buf, &buf_len,
+		ext_buf_free_cb, ext_buf);
+	if (shinfo == NULL) {
+		rte_free(ext_buf);
+		GOTO_FAIL("cannot init shared info");
+	}
+	if (buf_len >= EXT_BUF_SIZE ||
+			(char *)shinfo + sizeof(*shinfo) > ext_buf + EXT_BUF_SIZE)
+		GOTO_FAIL("bad buffer length after shared info init");
+	if (rte_mbuf_ext_refcnt_read(shinfo) != 1)
+		GOTO_FAIL("invalid refcnt in shared info");
+
+	m = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (m == NULL) {
+		rte_free(ext_buf);
+		GOTO_FAIL("cannot allocate mbuf");
+	}
+
+	rte_pktmbuf_attach_extbuf(m, ext_buf, rte_malloc_virt2phy(ext_buf),
+		buf_len, shinfo);
+	if (!RTE_MBUF_HAS_EXTBUF(m) || RTE_MBUF_DIRECT(m) ||
+			RTE_MBUF_INDIRECT(m))
+		GOTO_FAIL("bad flags after attaching external buffer");
+	if (m->buf_addr != ext_buf || m->buf_len != buf_len ||
+			m->shinfo != shinfo)
+		GOTO_FAIL("external buffer was not attached properly");
+	if (rte_pktmbuf_headroom(m) != 0)
+		GOTO_FAIL("bad headroom after attaching external buffer");
+
+	rte_pktmbuf_reset_headroom(m);
+	data = rte_pktmbuf_append(m, MBUF_TEST_DATA_LEN2);
+	if (data == NULL)
+		GOTO_FAIL("cannot append data to external buffer");
+	if (data != ext_buf + RTE_PKTMBUF_HEADROOM)
+		GOTO_FAIL("bad data pointer in external buffer");
+	memset(data, 0xcc, MBUF_TEST_DATA_LEN2);
+
+	/* a clone of a mbuf with an external buffer references the
+	 * external buffer too */
+	clone = rte_pktmbuf_clone(m, pktmbuf_pool);
+	if (clone == NULL)
+		GOTO_FAIL("cannot clone mbuf with external buffer");
+	if (!RTE_MBUF_HAS_EXTBUF(clone) || RTE_MBUF_INDIRECT(clone) ||
+			clone->shinfo != shinfo)
+		GOTO_FAIL("clone is not attached to the external buffer");
+	if (rte_pktmbuf_mtod(clone, char *) != data)
+		GOTO_FAIL("invalid data in clone");
+	if (rte_mbuf_ext_refcnt_read(shinfo) != 2)
+		GOTO_FAIL("invalid refcnt in shared info");
+	if (rte_mbuf_refcnt_read(m) != 1)
+		GOTO_FAIL("invalid refcnt in m");
+
+	clone2 = rte_pktmbuf_alloc(pktmbuf_pool2);
+	if (clone2 == NULL)
+		GOTO_FAIL("cannot allocate clone2 from second pool");
+	rte_pktmbuf_attach(clone2, clone);
+	if (rte_pktmbuf_mtod(clone2, char *) != data)
+		GOTO_FAIL("invalid data in clone2");
+	if (rte_mbuf_ext_refcnt_read(shinfo) != 3)
+		GOTO_FAIL("invalid refcnt in shared info");
+
+	/* the buffer must stay until the last reference goes */
+	rte_pktmbuf_free(m);
+	m = NULL;
+	rte_pktmbuf_free(clone);
+	clone = NULL;
+	if (ext_buf_freed != 0)
+		GOTO_FAIL("external buffer freed too early");
+	if (rte_mbuf_ext_refcnt_read(shinfo) != 1)
+		GOTO_FAIL("invalid refcnt in shared info");
+	if (rte_pktmbuf_mtod(clone2, char *)[0] != (char)0xcc)
+		GOTO_FAIL("invalid data in clone2 after freeing m");
+
+	/* detaching restores the mbuf own buffer */
+	rte_pktmbuf_detach(clone2);
+	if (ext_buf_freed != 1)
+		GOTO_FAIL("external buffer not freed");
+	if (RTE_MBUF_HAS_EXTBUF(clone2) ||
+			rte_pktmbuf_mtod(clone2, char *) !=
+			(char *)clone2 + sizeof(*clone2) + MBUF2_PRIV_SIZE)
+		GOTO_FAIL("clone2 was not detached properly");
+	rte_pktmbuf_free(clone2);
+
+	printf("%s ok\n", __func__);
+	return 0;
+
+fail:
+	if (m)
+		rte_pktmbuf_free(m);
+	if (clone)
+		rte_pktmbuf_free(clone);
+	if (clone2)
+		rte_pktmbuf_free(clone2);
+	return -1;
+}
+
+/*
+ * Attach mbufs to slices of a single external buffer, with the shared
+ * info allocated apart from the buffer.
+ */
+static int
+test_pktmbuf_ext_buf_slices(void)
+{
+	struct rte_mbuf *mbufs[EXT_BUF_NB_SLICES];
+	struct rte_mbuf_ext_shared_info *shinfo;
+	uint16_t slice_len = EXT_BUF_SIZE / EXT_BUF_NB_SLICES;
+	char *ext_buf = NULL;
+	unsigned int i;
+
+	memset(mbufs, 0, sizeof(mbufs));
+	ext_buf_freed = 0;
+
+	shinfo = rte_zmalloc("test_ext_shinfo", sizeof(*shinfo), 0);
+	if (shinfo == NULL)
+		GOTO_FAIL("cannot allocate shared info");
+	ext_buf = rte_malloc("test_ext_buf", EXT_BUF_SIZE, 0);
+	if (ext_buf == NULL) {
+		rte_free(shinfo);
+		GOTO_FAIL("cannot allocate external buffer");
+	}
+	shinfo->free_cb = ext_buf_free_cb;
+	shinfo->fcb_opaque = ext_buf;
+	rte_mbuf_ext_refcnt_set(shinfo, EXT_BUF_NB_SLICES);
+
+	for (i = 0; i < EXT_BUF_NB_SLICES; i++) {
+		char *slice = ext_buf + i * slice_len;
+
+		mbufs[i] = rte_pktmbuf_alloc(pktmbuf_pool);
+		if (mbufs[i] == NULL)
+			GOTO_FAIL("cannot allocate mbuf");
+		rte_pktmbuf_attach_extbuf(mbufs[i], slice,
+			rte_malloc_virt2phy(ext_buf) + i * slice_len,
+			slice_len, shinfo);
+		if (rte_pktmbuf_append(mbufs[i], slice_len) != slice)
+			GOTO_FAIL("cannot append slice %u", i);
+		memset(slice, i, slice_len);
+	}
+
+	for (i = 0; i < EXT_BUF_NB_SLICES; i++) {
+		if (rte_pktmbuf_mtod(mbufs[i], char *)[slice_len - 1] !=
+				(char)i)
+			GOTO_FAIL("invalid data in slice %u", i);
+		if (ext_buf_freed != 0)
+			GOTO_FAIL("external buffer freed too early");
+		rte_pktmbuf_free(mbufs[i]);
+		mbufs[i] = NULL;
+	}
+	if (ext_buf_freed != 1)
+		GOTO_FAIL("external buffer not freed");
+
+	rte_free(shinfo);
+	printf("%s ok\n", __func__);
+	return 0;
+
+fail:
+	for (i = 0; i < EXT_BUF_NB_SLICES; i++) {
+		if (mbufs[i])
+			rte_pktmbuf_free(mbufs[i]);
+	}
+	return -1;
+}
+
+static int
+test_mbuf_dyn(void)
+{
+	const struct rte_mbuf_dynfield dynfield = {
+		.name = "test-dynfield",
+		.size = sizeof(uint8_t),
+		.align = __alignof__(uint8_t),
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynfield dynfield2 = {
+		.name = "test-dynfield2",
+		.size = sizeof(uint64_t),
+		.align = __alignof__(uint64_t),
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynfield dynfield_fail_big = {
+		.name = "test-dynfield-fail-big",
+		.size = 256,
+		.align = 1,
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynfield dynfield_fail_align = {
+		.name = "test-dynfield-fail-align",
+		.size = 1,
+		.align = 3,
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynflag dynflag = {
+		.name = "test-dynflag",
+		.flags = 0,
+	};
+	const struct rte_mbuf_dynflag dynflag2 = {
+		.name = "test-dynflag2",
+		.flags = 0,
+	};
+	struct rte_mbuf_dynfield dynfield_conflict = dynfield;
+	struct rte_mbuf_dynfield dynfield_busy = dynfield2;
+	struct rte_mbuf_dynfield dynfield_long;
+	struct rte_mbuf_dynfield params;
+	struct rte_mbuf *m = NULL, *clone = NULL;
+	int offset, offset2, flag, flag2;
+
+	offset = rte_mbuf_dynfield_register(&dynfield);
+	if (offset == -1)
+		GOTO_FAIL("failed to register dynamic field, offset=%d: %s",
+			offset, rte_strerror(rte_errno));
+	if (rte_mbuf_dynfield_register(&dynfield) != offset)
+		GOTO_FAIL("failed to register dynamic field again");
+
+	offset2 = rte_mbuf_dynfield_register(&dynfield2);
+	if (offset2 == -1 || offset2 == offset ||
+			(offset2 & (__alignof__(uint64_t) - 1)))
+		GOTO_FAIL("failed to register dynamic field 2, offset2=%d: %s",
+			offset2, rte_strerror(rte_errno));
+	if (offset2 < (int)offsetof(struct rte_mbuf, dynfield1) ||
+			offset2 + sizeof(uint64_t) > sizeof(struct rte_mbuf))
+		GOTO_FAIL("dynamic field 2 out of the reserved area");
+
+	printf("dynfield: offset=%d, offset2=%d\n", offset, offset2);
+
+	dynfield_conflict.size = sizeof(uint16_t);
+	if (rte_mbuf_dynfield_register(&dynfield_conflict) != -1 ||
+			rte_errno != EEXIST)
+		GOTO_FAIL("dynamic field with conflicting params registered");
+
+	snprintf(dynfield_busy.name, sizeof(dynfield_busy.name),
+		"test-dynfield-busy");
+	if (rte_mbuf_dynfield_register_offset(&dynfield_busy, offset2) != -1 ||
+			rte_errno != EBUSY)
+		GOTO_FAIL("dynamic field registered at a busy offset");
+	if (rte_mbuf_dynfield_register_offset(&dynfield_busy,
+			offsetof(struct rte_mbuf, pool)) != -1 ||
+			rte_errno != EBUSY)
+		GOTO_FAIL("dynamic field registered over a static field");
+
+	if (rte_mbuf_dynfield_register(&dynfield_fail_big) != -1 ||
+			rte_errno != EINVAL)
+		GOTO_FAIL("dynamic field with bad size registered");
+	if (rte_mbuf_dynfield_register(&dynfield_fail_align) != -1 ||
+			rte_errno != EINVAL)
+		GOTO_FAIL("dynamic field with bad alignment registered");
+
+	dynfield_long = dynfield;
+	memset(dynfield_long.name, 'x', sizeof(dynfield_long.name));
+	if (rte_mbuf_dynfield_register(&dynfield_long) != -1 ||
+			rte_errno != ENAMETOOLONG)
+		GOTO_FAIL("dynamic field with too long name registered");
+
+	if (rte_mbuf_dynfield_lookup("test-dynfield2", &params) != offset2 ||
+			params.size != dynfield2.size ||
+			params.align != dynfield2.align)
+		GOTO_FAIL("failed to lookup dynamic field 2");
+	if (rte_mbuf_dynfield_lookup("test-dynfield-dummy", NULL) != -1 ||
+			rte_errno != ENOENT)
+		GOTO_FAIL("lookup of an unknown dynamic field succeeded");
+
+	flag = rte_mbuf_dynflag_register(&dynflag);
+	if (flag == -1)
+		GOTO_FAIL("failed to register dynamic flag, flag=%d: %s",
+			flag, rte_strerror(rte_errno));
+	if (rte_mbuf_dynflag_register(&dynflag) != flag)
+		GOTO_FAIL("failed to register dynamic flag again");
+	if ((1ULL << flag) & (PKT_RX_TIMESTAMP | PKT_TX_MACSEC |
+			IND_ATTACHED_MBUF))
+		GOTO_FAIL("dynamic flag overlaps a static flag");
+
+	flag2 = rte_mbuf_dynflag_register(&dynflag2);
+	if (flag2 == -1 || flag2 == flag)
+		GOTO_FAIL("failed to register dynamic flag 2, flag2=%d: %s",
+			flag2, rte_strerror(rte_errno));
+	if (rte_mbuf_dynflag_register_bitnum(&dynflag2, flag) != -1 ||
+			rte_errno != EEXIST)
+		GOTO_FAIL("dynamic flag registered with conflicting bit");
+	if (rte_mbuf_dynflag_lookup("test-dynflag2", NULL) != flag2)
+		GOTO_FAIL("failed to lookup dynamic flag 2");
+
+	printf("dynflag: flag=%d, flag2=%d\n", flag, flag2);
+
+	/* the dynamic fields and flags follow the packet when cloned */
+	m = rte_pktmbuf_alloc(pktmbuf_pool);
+	if (m == NULL)
+		GOTO_FAIL("cannot allocate mbuf");
+	*RTE_MBUF_DYNFIELD(m, offset, uint8_t *) = 0x5a;
+	*RTE_MBUF_DYNFIELD(m, offset2, uint64_t *) = 0x0123456789abcdefULL;
+	m->ol_flags |= 1ULL << flag2;
+
+	clone = rte_pktmbuf_clone(m, pktmbuf_pool);
+	if (clone == NULL)
+		GOTO_FAIL("cannot clone mbuf");
+	if (*RTE_MBUF_DYNFIELD(clone, offset, uint8_t *) != 0x5a ||
+			*RTE_MBUF_DYNFIELD(clone, offset2, uint64_t *) !=
+			0x0123456789abcdefULL)
+		GOTO_FAIL("dynamic fields not copied to the clone");
+	if (!(clone->ol_flags & (1ULL << flag2)) ||
+			(clone->ol_flags & (1ULL << flag)))
+		GOTO_FAIL("dynamic flags not copied to the clone");
+
+	rte_pktmbuf_free(clone);
+	rte_pktmbuf_free(m);
+
+	rte_mbuf_dyn_dump(stdout);
+
+	printf("%s ok\n", __func__);
+	return 0;
+
+fail:
+	if (clone)
+		rte_pktmbuf_free(clone);
+	if (m)
+		rte_pktmbuf_free(m);
+	return -1;
+}
+
+/*
+ * Allocate a burst of packets of nb_segs segments, taken alternately
+ * from the two pools if mixed is set.
+ */
+static int
+alloc_free_bulk_burst(struct rte_mbuf **pkts, unsigned int nb_pkts,
+	unsigned int nb_segs, int mixed)
+{
+	struct rte_mempool *mp;
+	struct rte_mbuf *seg;
+	unsigned int i, j;
+
+	memset(pkts, 0, nb_pkts * sizeof(*pkts));
+
+	for (i = 0; i < nb_pkts; i++) {
+		mp = (mixed && (i & 1)) ? pktmbuf_pool2 : pktmbuf_pool;
+		pkts[i] = rte_pktmbuf_alloc(mp);
+		if (pkts[i] == NULL)
+			goto fail;
+		for (j = 1; j < nb_segs; j++) {
+			seg = rte_pktmbuf_alloc(mp);
+			if (seg == NULL)
+				goto fail;
+			if (rte_pktmbuf_chain(pkts[i], seg) != 0) {
+				rte_pktmbuf_free(seg);
+				goto fail;
+			}
+		}
+	}
+
+	return 0;
+
+fail:
+	for (i = 0; i < nb_pkts; i++)
+		rte_pktmbuf_free(pkts[i]);
+	return -1;
+}
+
+static int
+test_pktmbuf_free_bulk(void)
+{
+	struct rte_mbuf *pkts[NB_MBUF * 2];
+	struct rte_mbuf *first;
+	unsigned int i;
+
+	/* all the mbufs of a pool, with holes in the array */
+	if (alloc_free_bulk_burst(pkts, NB_MBUF, 1, 0) < 0)
+		GOTO_FAIL("cannot allocate single segment packets");
+	first = pkts[0];
+	pkts[0] = NULL;
+	rte_pktmbuf_free_bulk(pkts, NB_MBUF);
+	if (rte_mempool_avail_count(pktmbuf_pool) != NB_MBUF - 1)
+		GOTO_FAIL("single segment packets not freed");
+	rte_pktmbuf_free(first);
+
+	/* multi-segment packets */
+	if (alloc_free_bulk_burst(pkts, NB_MBUF / 4, 4, 0) < 0)
+		GOTO_FAIL("cannot allocate multi-segment packets");
+	rte_pktmbuf_free_bulk(pkts, NB_MBUF / 4);
+	if (rte_mempool_avail_count(pktmbuf_pool) != NB_MBUF)
+		GOTO_FAIL("multi-segment packets not freed");
+
+	/* packets from both pools, and clones of them in the other pool */
+	if (alloc_free_bulk_burst(pkts, NB_MBUF, 1, 1) < 0)
+		GOTO_FAIL("cannot allocate mixed pool packets");
+	for (i = NB_MBUF; i < NB_MBUF * 2; i++) {
+		struct rte_mbuf *m = pkts[i - NB_MBUF];
+
+		pkts[i] = rte_pktmbuf_clone(m, m->pool == pktmbuf_pool ?
+			pktmbuf_pool2 : pktmbuf_pool);
+		if (pkts[i] == NULL) {
+			rte_pktmbuf_free_bulk(pkts, i);
+			GOTO_FAIL("cannot clone packet %u", i - NB_MBUF);
+		}
+	}
+	rte_pktmbuf_free_bulk(pkts, NB_MBUF * 2);
+	if (rte_mempool_avail_count(pktmbuf_pool) != NB_MBUF ||
+			rte_mempool_avail_count(pktmbuf_pool2) != NB_MBUF)
+		GOTO_FAIL("mixed pool packets not freed");
+
+	printf("%s ok\n", __func__);
+	return 0;
+
+fail:
+	return -1;
+}
+
+/* measure the free cost of bursts of packets, with and without bulk */
+static int
+test_pktmbuf_free_bulk_perf(void)
+{
+	static const struct {
+		const char *name;
+		unsigned int nb_pkts;
+		unsigned int nb_segs;
+		int mixed;
+	} tests[] = {
+		{ "single segment", FREE_BULK_BURST, 1, 0 },
+		{ "multi segment", FREE_BULK_BURST / 4, 4, 0 },
+		{ "mixed pools", FREE_BULK_BURST, 1, 1 },
+	};
+	struct rte_mbuf *pkts[FREE_BULK_BURST];
+	uint64_t start, free_cycles, bulk_cycles;
+	unsigned int i, n, j;
+
+	for (i = 0; i < RTE_DIM(tests); i++) {
+		free_cycles = 0;
+		bulk_cycles = 0;
+
+		for (n = 0; n < FREE_BULK_ITERATIONS; n++) {
+			if (alloc_free_bulk_burst(pkts, tests[i].nb_pkts,
+					tests[i].nb_segs, tests[i].mixed) < 0)
+				GOTO_FAIL("cannot allocate %s burst",
+					tests[i].name);
+			start = rte_rdtsc();
+			for (j = 0; j < tests[i].nb_pkts; j++)
+				rte_pktmbuf_free(pkts[j]);
+			free_cycles += rte_rdtsc() - start;
+
+			if (alloc_free_bulk_burst(pkts, tests[i].nb_pkts,
+					tests[i].nb_segs, tests[i].mixed) < 0)
+				GOTO_FAIL("cannot allocate %s burst",
+					tests[i].name);
+			start = rte_rdtsc();
+			rte_pktmbuf_free_bulk(pkts, tests[i].nb_pkts);
+			bulk_cycles += rte_rdtsc() - start;
+		}
+
+		n = FREE_BULK_ITERATIONS * tests[i].nb_pkts *
+			tests[i].nb_segs;
+		printf("free %s bursts: %.2f cycles/mbuf, bulk: %.2f cycles/mbuf\n",
+			tests[i].name, (double)free_cycles / n,
+			(double)bulk_cycles / n);
+	}
+
+	printf("%s ok\n", __func__);
+	return 0;
+
+fail:
+	return -1;
+}
 #undef GOTO_FAIL
 
 /*
@@ -1132,6 +1644,31 @@ test_mbuf(void)
 		return -1;
 	}
 
+	if (test_mbuf_dyn() < 0) {
+		printf("test_mbuf_dyn() failed\n");
+		return -1;
+	}
+
+	if (test_pktmbuf_free_bulk() < 0) {
+		printf("test_pktmbuf_free_bulk() failed\n");
+		return -1;
+	}
+
+	if (test_pktmbuf_free_bulk_perf() < 0) {
+		printf("test_pktmbuf_free_bulk_perf() failed\n");
+		return -1;
+	}
+
+	if (test_pktmbuf_ext_buf() < 0) {
+		printf("test_pktmbuf_ext_buf() failed\n");
+		return -1;
+	}
+
+	if (test_pktmbuf_ext_buf_slices() < 0) {
+		printf("test_pktmbuf_ext_buf_slices() failed\n");
+		return -1;
+	}
+
 	if (test_refcnt_mbuf()<0){
 		printf("test_refcnt_mbuf() failed \n");
 		return -1;
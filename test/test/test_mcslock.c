@@ -0,0 +1,326 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Arm Limited
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Arm Limited nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/queue.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_per_lcore.h>
+#include <rte_launch.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_mcslock.h>
+#include <rte_atomic.h>
+
+#include "test.h"
+
+/*
+ * MCS lock test
+ * =============
+ *
+ * - There is a global MCS lock and a table of MCS locks (one per lcore).
+ *
+ * - The test function takes all of these locks and launches the
+ *   ``test_mcslock_per_core()`` function on each core (except the master).
+ *
+ *   - The function takes the global lock, display something, then releases
+ *     the global lock.
+ *   - The function takes the per-lcore lock, display something, then releases
+ *     the per-core lock.
+ *
+ * - The main function unlocks the per-lcore locks sequentially and
+ *   waits between each lock.
+ *
+ * - The recursive lock is taken several times on each core, and must be
+ *   released by the owner only after the last unlock.
+ *
+ * - A load test is carried out, with all cores incrementing a shared
+ *   counter under a single lock: the counter must not lose any update, and
+ *   the lock must be free at the end.
+ */
+
+static rte_mcslock_t *p_ml;
+static rte_mcslock_t *p_ml_try;
+static rte_mcslock_t *p_ml_tab[RTE_MAX_LCORE];
+static rte_mcslock_recursive_t mlr;
+static unsigned int count;
+
+static rte_atomic32_t synchro;
+
+static int
+test_mcslock_per_core(__attribute__((unused)) void *arg)
+{
+	/* Per core me node. */
+	rte_mcslock_t ml_me, ml_tab_me;
+
+	rte_mcslock_lock(&p_ml, &ml_me);
+	printf("Global lock taken on core %u\n", rte_lcore_id());
+	rte_mcslock_unlock(&p_ml, &ml_me);
+
+	rte_mcslock_lock(&p_ml_tab[rte_lcore_id()], &ml_tab_me);
+	printf("Hello from core %u !\n", rte_lcore_id());
+	rte_mcslock_unlock(&p_ml_tab[rte_lcore_id()], &ml_tab_me);
+
+	return 0;
+}
+
+static int
+test_mcslock_recursive_per_core(__attribute__((unused)) void *arg)
+{
+	unsigned int id = rte_lcore_id();
+	rte_mcslock_t ml_me;
+
+	rte_mcslock_recursive_lock(&mlr, &ml_me);
+	printf("Global recursive lock taken on core %u - count = %u\n",
+	       id, mlr.count);
+	rte_mcslock_recursive_lock(&mlr, &ml_me);
+	printf("Global recursive lock taken on core %u - count = %u\n",
+	       id, mlr.count);
+	rte_mcslock_recursive_lock(&mlr, &ml_me);
+	printf("Global recursive lock taken on core %u - count = %u\n",
+	       id, mlr.count);
+
+	printf("Hello from within recursive locks from core %u !\n", id);
+
+	rte_mcslock_recursive_unlock(&mlr);
+	printf("Global recursive lock released on core %u - count = %u\n",
+	       id, mlr.count);
+	rte_mcslock_recursive_unlock(&mlr);
+	printf("Global recursive lock released on core %u - count = %u\n",
+	       id, mlr.count);
+	rte_mcslock_recursive_unlock(&mlr);
+	printf("Global recursive lock released on core %u - count = %u\n",
+	       id, mlr.count);
+
+	return 0;
+}
+
+static rte_mcslock_t *p_ml_perf;
+static uint64_t shared_count;
+
+#define LOAD_ITERATIONS 100000
+
+static int
+load_loop_fn(__attribute__((unused)) void *arg)
+{
+	const unsigned int lcore = rte_lcore_id();
+	rte_mcslock_t ml_perf_me;
+	unsigned int i;
+
+	/* wait synchro for slaves */
+	if (lcore != rte_get_master_lcore())
+		while (rte_atomic32_read(&synchro) == 0)
+			;
+
+	for (i = 0; i < LOAD_ITERATIONS; i++) {
+		rte_mcslock_lock(&p_ml_perf, &ml_perf_me);
+		shared_count++;
+		rte_mcslock_unlock(&p_ml_perf, &ml_perf_me);
+	}
+
+	return 0;
+}
+
+static int
+test_mcslock_load(void)
+{
+	p_ml_perf = NULL;
+	shared_count = 0;
+
+	printf("\nTest with lock on %u cores...\n", rte_lcore_count());
+
+	/* Clear synchro and start slaves */
+	rte_atomic32_set(&synchro, 0);
+	rte_eal_mp_remote_launch(load_loop_fn, NULL, SKIP_MASTER);
+
+	/* start synchro and launch test on master */
+	rte_atomic32_set(&synchro, 1);
+	load_loop_fn(NULL);
+
+	rte_eal_mp_wait_lcore();
+
+	printf("Total count = %"PRIu64"\n", shared_count);
+
+	if (shared_count != (uint64_t)LOAD_ITERATIONS * rte_lcore_count()) {
+		printf("Lost updates under MCS lock: %"PRIu64" != %u\n",
+		       shared_count, LOAD_ITERATIONS * rte_lcore_count());
+		return -1;
+	}
+	if (rte_mcslock_is_locked(&p_ml_perf)) {
+		printf("MCS lock is locked but it should not be\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Use rte_mcslock_trylock() to trylock an MCS lock object,
+ * If it could not lock the object successfully, it would
+ * return immediately and the variable of "count" would be
+ * increased by one per times. the value of "count" could be
+ * checked as the result later.
+ */
+static int
+test_mcslock_try(__attribute__((unused)) void *arg)
+{
+	/* Per core me node. */
+	rte_mcslock_t ml_me, ml_try_me;
+
+	if (rte_mcslock_trylock(&p_ml_try, &ml_try_me) == 0) {
+		rte_mcslock_lock(&p_ml, &ml_me);
+		count++;
+		rte_mcslock_unlock(&p_ml, &ml_me);
+	}
+
+	return 0;
+}
+
+static int
+test_mcslock(void)
+{
+	int ret = 0;
+	int i;
+
+	/* Define per core me node. */
+	rte_mcslock_t ml_me, ml_try_me, mlr_me;
+	rte_mcslock_t ml_tab_me[RTE_MAX_LCORE];
+
+	p_ml = NULL;
+	p_ml_try = NULL;
+	rte_mcslock_recursive_init(&mlr);
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		p_ml_tab[i] = NULL;
+
+	rte_mcslock_lock(&p_ml, &ml_me);
+
+	RTE_LCORE_FOREACH_SLAVE(i) {
+		rte_mcslock_lock(&p_ml_tab[i], &ml_tab_me[i]);
+		rte_eal_remote_launch(test_mcslock_per_core, NULL, i);
+	}
+
+	rte_mcslock_unlock(&p_ml, &ml_me);
+
+	RTE_LCORE_FOREACH_SLAVE(i) {
+		rte_mcslock_unlock(&p_ml_tab[i], &ml_tab_me[i]);
+		rte_delay_ms(10);
+	}
+
+	rte_eal_mp_wait_lcore();
+
+	rte_mcslock_recursive_lock(&mlr, &mlr_me);
+
+	/*
+	 * Try to acquire a lock that we already own
+	 */
+	if (!rte_mcslock_recursive_trylock(&mlr, &mlr_me)) {
+		printf("rte_mcslock_recursive_trylock failed on a lock that "
+		       "we already own\n");
+		ret = -1;
+	} else
+		rte_mcslock_recursive_unlock(&mlr);
+
+	RTE_LCORE_FOREACH_SLAVE(i) {
+		rte_eal_remote_launch(test_mcslock_recursive_per_core,
+				      NULL, i);
+	}
+	rte_mcslock_recursive_unlock(&mlr);
+	rte_eal_mp_wait_lcore();
+
+	if (rte_mcslock_is_locked(&mlr.msl)) {
+		printf("recursive MCS lock is locked but it should not be\n");
+		return -1;
+	}
+
+	/*
+	 * Test if it could return immediately from try-locking a locked object.
+	 * Here it will lock the MCS lock object first, then launch all the
+	 * slave lcores to trylock the same MCS lock object.
+	 * All the slave lcores should give up try-locking a locked object and
+	 * return immediately, and then increase the "count" initialized with
+	 * zero by one per times.
+	 * We can check if the "count" is finally equal to the number of all
+	 * slave lcores to see if the behavior of try-locking a locked
+	 * MCS lock object is correct.
+	 */
+	if (rte_mcslock_trylock(&p_ml_try, &ml_try_me) == 0)
+		return -1;
+
+	count = 0;
+	RTE_LCORE_FOREACH_SLAVE(i) {
+		rte_eal_remote_launch(test_mcslock_try, NULL, i);
+	}
+	rte_eal_mp_wait_lcore();
+	rte_mcslock_unlock(&p_ml_try, &ml_try_me);
+	if (rte_mcslock_is_locked(&p_ml)) {
+		printf("MCS lock is locked but it should not be\n");
+		return -1;
+	}
+	rte_mcslock_lock(&p_ml, &ml_me);
+	if (count != (rte_lcore_count() - 1))
+		ret = -1;
+
+	rte_mcslock_unlock(&p_ml, &ml_me);
+
+	/*
+	 * Test if it can trylock recursively.
+	 * Use rte_mcslock_recursive_trylock() to check if it can lock
+	 * an MCS lock object recursively. Here it will try to lock an
+	 * MCS lock object twice.
+	 */
+	if (rte_mcslock_recursive_trylock(&mlr, &mlr_me) == 0) {
+		printf("It failed to do the first mcslock_recursive_trylock "
+		       "but it should able to do\n");
+		return -1;
+	}
+	if (rte_mcslock_recursive_trylock(&mlr, &mlr_me) == 0) {
+		printf("It failed to do the second mcslock_recursive_trylock "
+		       "but it should able to do\n");
+		return -1;
+	}
+	rte_mcslock_recursive_unlock(&mlr);
+	rte_mcslock_recursive_unlock(&mlr);
+
+	if (test_mcslock_load() < 0)
+		return -1;
+
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(mcslock_autotest, test_mcslock);
@@ -68,6 +68,12 @@
  *    - Get two objects, put two objects
  *    - Get all objects, test that their content is not modified and
  *      put them back in the pool.
+ *
+ * Cache tests: done on one core:
+ *
+ *    - Check the cache statistics account gets and puts.
+ *    - Check an adaptive cache grows when it often accesses the common
+ *      pool, and shrinks back when it does not.
  */
 
 #define MEMPOOL_ELT_SIZE 2048
@@ -500,6 +506,102 @@ test_mempool_xmem_misc(void)
 	return 0;
 }
 
+/* check the cache statistics follow the operations on the cache */
+static int
+test_mempool_cache_stats(struct rte_mempool *mp)
+{
+	struct rte_mempool_cache_stats stats, sum;
+	unsigned int lcore_id = rte_lcore_id();
+	void *obj;
+	int ret;
+
+	rte_mempool_cache_stats_reset(mp);
+	ret = rte_mempool_cache_stats_get(mp, lcore_id, &stats);
+	if (ret == -ENOTSUP) {
+		printf("mempool cache statistics not compiled in, skipped\n");
+		return 0;
+	}
+	if (ret < 0 || stats.get_hit != 0 || stats.get_miss != 0 ||
+			stats.put != 0)
+		RET_ERR();
+
+	if (rte_mempool_get(mp, &obj) < 0)
+		RET_ERR();
+	rte_mempool_put(mp, obj);
+
+	if (rte_mempool_cache_stats_get(mp, lcore_id, &stats) < 0)
+		RET_ERR();
+	if (stats.get_hit + stats.get_miss != 1 || stats.put != 1)
+		RET_ERR();
+	if (rte_mempool_cache_stats_get(mp, LCORE_ID_ANY, &sum) < 0)
+		RET_ERR();
+	if (sum.get_hit + sum.get_miss != 1 || sum.put != 1)
+		RET_ERR();
+	if (rte_mempool_cache_stats_get(mp, RTE_MAX_LCORE, &stats) != -EINVAL)
+		RET_ERR();
+
+	return 0;
+}
+
+#define ADAPT_CACHE_SIZE 32
+#define ADAPT_BURST (ADAPT_CACHE_SIZE - 1)
+
+/* check an adaptive cache grows and shrinks with its miss rate */
+static int
+test_mempool_cache_adaptive(void)
+{
+	struct rte_mempool *mp;
+	struct rte_mempool_cache *cache;
+	void *objs[ADAPT_BURST * 2];
+	uint32_t size;
+	unsigned int i;
+	int ret = 0;
+
+	mp = rte_mempool_create("test_cache_adaptive", MEMPOOL_SIZE,
+		MEMPOOL_ELT_SIZE, ADAPT_CACHE_SIZE, 0,
+		NULL, NULL, my_obj_init, NULL,
+		SOCKET_ID_ANY, MEMPOOL_F_CACHE_ADAPTIVE);
+	if (mp == NULL)
+		RET_ERR();
+
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	if (cache == NULL || cache->size != ADAPT_CACHE_SIZE)
+		GOTO_ERR(ret, out);
+
+	/* bursts larger than the cache: most operations hit the pool */
+	for (i = 0; i < RTE_MEMPOOL_CACHE_ADAPT_PERIOD * 4; i++) {
+		if (rte_mempool_get_bulk(mp, objs, ADAPT_BURST) < 0 ||
+				rte_mempool_get_bulk(mp, &objs[ADAPT_BURST],
+					ADAPT_BURST) < 0)
+			GOTO_ERR(ret, out);
+		rte_mempool_put_bulk(mp, objs, ADAPT_BURST * 2);
+	}
+	size = cache->size;
+	printf("adaptive cache grown from %u to %u\n",
+		ADAPT_CACHE_SIZE, size);
+	if (size <= ADAPT_CACHE_SIZE)
+		GOTO_ERR(ret, out);
+
+	/* small bursts: the cache is always hit */
+	for (i = 0; i < RTE_MEMPOOL_CACHE_ADAPT_PERIOD * 8; i++) {
+		if (rte_mempool_get(mp, objs) < 0)
+			GOTO_ERR(ret, out);
+		rte_mempool_put(mp, objs[0]);
+	}
+	printf("adaptive cache shrunk from %u to %u\n", size, cache->size);
+	if (cache->size >= size || cache->len > cache->flushthresh)
+		GOTO_ERR(ret, out);
+
+	rte_mempool_dump(stdout, mp);
+
+	if (rte_mempool_avail_count(mp) != MEMPOOL_SIZE)
+		GOTO_ERR(ret, out);
+
+out:
+	rte_mempool_free(mp);
+	return ret;
+}
+
 static void
 walk_cb(struct rte_mempool *mp, void *userdata __rte_unused)
 {
@@ -612,6 +714,13 @@ test_mempool(void)
 	if (test_mempool_basic(mp_nocache, 1) < 0)
 		goto err;
 
+	/* cache statistics and adaptive cache size */
+	if (test_mempool_cache_stats(mp_cache) < 0)
+		goto err;
+
+	if (test_mempool_cache_adaptive() < 0)
+		goto err;
+
 	/* more basic tests without cache */
 	if (test_mempool_basic_ex(mp_nocache) < 0)
 		goto err;
@@ -0,0 +1,314 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_metrics.h>
+
+#include "test.h"
+
+#define SET_SIZE 4
+#define STRESS_DURATION_MS 200
+
+static const char * const set_names[SET_SIZE] = {
+	"test_metrics_a", "test_metrics_b", "test_metrics_c", "test_metrics_d",
+};
+
+static int set_key;
+static rte_atomic32_t stop;
+
+static int
+test_metrics_setup(void)
+{
+	rte_metrics_init(rte_socket_id());
+	set_key = rte_metrics_reg_names(set_names, SET_SIZE);
+	if (set_key < 0) {
+		printf("Cannot register the metrics: %d\n", set_key);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* fetch the values of a port, the returned array must be freed */
+static struct rte_metric_value *
+get_values(int port_id, int *len)
+{
+	struct rte_metric_value *values;
+	int ret;
+
+	*len = rte_metrics_get_values(port_id, NULL, 0);
+	if (*len <= 0)
+		return NULL;
+	values = calloc(*len, sizeof(*values));
+	if (values == NULL)
+		return NULL;
+	ret = rte_metrics_get_values(port_id, values, *len);
+	if (ret != *len) {
+		free(values);
+		return NULL;
+	}
+
+	return values;
+}
+
+static int
+test_metrics_reg(void)
+{
+	struct rte_metric_name *names;
+	int len, ret, i;
+
+	TEST_ASSERT(rte_metrics_reg_names(NULL, 1) == -EINVAL,
+		    "NULL names accepted");
+	TEST_ASSERT(rte_metrics_reg_names(set_names, 0) == -EINVAL,
+		    "Empty set accepted");
+
+	len = rte_metrics_get_names(NULL, 0);
+	TEST_ASSERT(len >= set_key + SET_SIZE, "Wrong metric count %d", len);
+	names = calloc(len, sizeof(*names));
+	TEST_ASSERT_NOT_NULL(names, "Cannot allocate names");
+	ret = rte_metrics_get_names(names, len);
+	for (i = 0; i < SET_SIZE && ret == len; i++)
+		if (strcmp(names[set_key + i].name, set_names[i]) != 0)
+			break;
+	free(names);
+	TEST_ASSERT(ret == len, "Cannot get the names: %d", ret);
+	TEST_ASSERT(i == SET_SIZE, "Wrong name for key %d", set_key + i);
+
+	return 0;
+}
+
+static int
+test_metrics_update(void)
+{
+	const uint64_t set_values[SET_SIZE] = { 1, 2, 3, 4 };
+	struct rte_metric_value *values;
+	int len, i;
+
+	TEST_ASSERT_SUCCESS(rte_metrics_update_values(0, set_key, set_values,
+			SET_SIZE), "Cannot update the set");
+	TEST_ASSERT_SUCCESS(rte_metrics_update_value(RTE_METRICS_GLOBAL,
+			set_key + 1, 42), "Cannot update a global value");
+	TEST_ASSERT(rte_metrics_update_values(0, set_key + 1, set_values,
+			SET_SIZE) == -ERANGE, "Update crossed the set border");
+	TEST_ASSERT(rte_metrics_update_value(RTE_MAX_ETHPORTS, set_key, 1) ==
+		    -EINVAL, "Invalid port accepted");
+	TEST_ASSERT(rte_metrics_update_value(0, UINT16_MAX, 1) == -EINVAL,
+		    "Invalid key accepted");
+	TEST_ASSERT(rte_metrics_update_values(0, set_key, NULL, 1) == -EINVAL,
+		    "NULL values accepted");
+
+	values = get_values(0, &len);
+	TEST_ASSERT_NOT_NULL(values, "Cannot get the port values");
+	for (i = 0; i < SET_SIZE; i++)
+		if (values[set_key + i].key != (uint16_t)(set_key + i) ||
+				values[set_key + i].value != set_values[i])
+			break;
+	free(values);
+	TEST_ASSERT(i == SET_SIZE, "Wrong port value for key %d", set_key + i);
+
+	values = get_values(RTE_METRICS_GLOBAL, &len);
+	TEST_ASSERT_NOT_NULL(values, "Cannot get the global values");
+	i = values[set_key + 1].value == 42 && values[set_key].value == 0;
+	free(values);
+	TEST_ASSERT(i, "Wrong global values");
+
+	TEST_ASSERT(rte_metrics_get_values(0, NULL, 0) == len,
+		    "Wrong value count");
+	TEST_ASSERT(rte_metrics_get_values(RTE_MAX_ETHPORTS, NULL, 0) ==
+		    -EINVAL, "Invalid port accepted");
+
+	return 0;
+}
+
+/* update the whole set on the port of the lcore, with a single value */
+static int
+writer_fn(void *arg __rte_unused)
+{
+	const int port_id = rte_lcore_id() % RTE_MAX_ETHPORTS;
+	uint64_t values[SET_SIZE];
+	uint64_t n = 0;
+	int i;
+
+	while (rte_atomic32_read(&stop) == 0) {
+		n++;
+		for (i = 0; i < SET_SIZE; i++)
+			values[i] = n;
+		rte_metrics_update_values(port_id, set_key, values, SET_SIZE);
+		rte_metrics_update_values(RTE_METRICS_GLOBAL, set_key, values,
+			SET_SIZE);
+	}
+
+	return 0;
+}
+
+static int
+check_set(int port_id, struct rte_metric_value *values, int len)
+{
+	int i;
+
+	if (rte_metrics_get_values(port_id, values, len) != len)
+		return -1;
+	for (i = 1; i < SET_SIZE; i++)
+		if (values[set_key + i].value != values[set_key].value) {
+			printf("Inconsistent set on port %d: %"PRIu64
+			       " != %"PRIu64"\n", port_id,
+			       values[set_key + i].value,
+			       values[set_key].value);
+			return -1;
+		}
+
+	return 0;
+}
+
+static int
+test_metrics_stress(void)
+{
+	const uint64_t duration = rte_get_timer_hz() * STRESS_DURATION_MS /
+		1000;
+	struct rte_metric_value *values;
+	uint64_t set_values[SET_SIZE];
+	uint64_t begin, reads = 0;
+	unsigned int lcore;
+	int len, ret = 0;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough lcores for the stress test, skipping\n");
+		return 0;
+	}
+
+	/* the sets are consistent before the writers start */
+	memset(set_values, 0, sizeof(set_values));
+	rte_metrics_update_values(RTE_METRICS_GLOBAL, set_key, set_values,
+		SET_SIZE);
+	RTE_LCORE_FOREACH_SLAVE(lcore)
+		rte_metrics_update_values(lcore % RTE_MAX_ETHPORTS, set_key,
+			set_values, SET_SIZE);
+
+	values = get_values(RTE_METRICS_GLOBAL, &len);
+	TEST_ASSERT_NOT_NULL(values, "Cannot get the values");
+	rte_atomic32_clear(&stop);
+	rte_eal_mp_remote_launch(writer_fn, NULL, SKIP_MASTER);
+
+	begin = rte_get_timer_cycles();
+	while (ret == 0 && rte_get_timer_cycles() - begin < duration) {
+		ret = check_set(RTE_METRICS_GLOBAL, values, len);
+		RTE_LCORE_FOREACH_SLAVE(lcore) {
+			if (ret != 0)
+				break;
+			ret = check_set(lcore % RTE_MAX_ETHPORTS, values,
+					len);
+		}
+		reads++;
+	}
+
+	rte_atomic32_set(&stop, 1);
+	rte_eal_mp_wait_lcore();
+	free(values);
+
+	printf("%u writer(s), %"PRIu64" consistent reads\n",
+	       rte_lcore_count() - 1, reads);
+	TEST_ASSERT_SUCCESS(ret, "Readers got an inconsistent set");
+
+	return 0;
+}
+
+static int
+test_metrics_lcore_poll(void)
+{
+	struct rte_metric_name *names;
+	char name[RTE_METRICS_MAX_NAME_LEN];
+	int key, len, ret;
+
+	key = rte_metrics_lcore_poll_reg();
+	if (key == -ENOTSUP) {
+		printf("Lcore poll statistics disabled at build time, "
+		       "skipping\n");
+		return 0;
+	}
+	if (key == -ENOSPC) {
+		printf("Too many lcores for the lcore poll metrics, "
+		       "skipping\n");
+		return 0;
+	}
+	if (key == -EEXIST)
+		return 0;
+	TEST_ASSERT(key >= 0, "Cannot register the lcore poll metrics");
+	TEST_ASSERT(rte_metrics_lcore_poll_reg() == -EEXIST,
+		    "Lcore poll metrics registered twice");
+	TEST_ASSERT_SUCCESS(rte_metrics_lcore_poll_update(),
+			    "Cannot update the lcore poll metrics");
+
+	len = rte_metrics_get_names(NULL, 0);
+	names = calloc(len, sizeof(*names));
+	TEST_ASSERT_NOT_NULL(names, "Cannot allocate names");
+	ret = rte_metrics_get_names(names, len);
+	snprintf(name, sizeof(name), "lcore%u_busy_percent",
+		 rte_get_master_lcore());
+	ret = ret == len && strcmp(names[key + 2].name, name) == 0;
+	free(names);
+	TEST_ASSERT(ret, "Wrong lcore poll metric names");
+
+	return 0;
+}
+
+static struct unit_test_suite metrics_tests = {
+	.suite_name = "metrics autotest",
+	.setup = test_metrics_setup,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE(test_metrics_reg),
+		TEST_CASE(test_metrics_update),
+		TEST_CASE(test_metrics_stress),
+		TEST_CASE(test_metrics_lcore_poll),
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_metrics(void)
+{
+	return unit_test_suite_runner(&metrics_tests);
+}
+
+REGISTER_TEST_COMMAND(metrics_autotest, test_metrics);
@@ -0,0 +1,169 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_spinlock.h>
+#include <rte_metrics.h>
+
+#include "test.h"
+
+/*
+ * Metrics update performance test
+ * ===============================
+ *
+ * 1, 2, 4 and up to 8 writers on the slave lcores update a set of metrics
+ * in a loop, as the stats producers of a datapath would. The update
+ * throughput is measured when:
+ *
+ * - each writer updates its own port: the writers do not share any lock;
+ * - all writers update the global values: they serialize on the lock of
+ *   the set;
+ * - each writer updates its own port under a single spinlock, which is
+ *   how the library serialized all the updates before.
+ */
+
+#define MAX_WRITERS 8U
+#define DURATION_MS 100
+#define SET_SIZE 4
+
+enum writer_mode {
+	WRITER_PORT,
+	WRITER_GLOBAL,
+	WRITER_SPINLOCK,
+};
+
+static const char * const set_names[SET_SIZE] = {
+	"perf_metrics_a", "perf_metrics_b", "perf_metrics_c", "perf_metrics_d",
+};
+
+static int set_key;
+static rte_spinlock_t global_lock;
+static uint64_t writer_count[RTE_MAX_LCORE] __rte_cache_aligned;
+static rte_atomic32_t stop;
+
+static int
+writer_fn(void *arg)
+{
+	const enum writer_mode mode = *(const enum writer_mode *)arg;
+	const unsigned int lcore = rte_lcore_id();
+	const int port_id = mode == WRITER_GLOBAL ? RTE_METRICS_GLOBAL :
+		(int)(lcore % RTE_MAX_ETHPORTS);
+	uint64_t values[SET_SIZE] = { 0 };
+	uint64_t n = 0;
+
+	while (rte_atomic32_read(&stop) == 0) {
+		values[0] = n;
+		values[SET_SIZE - 1] = n;
+		if (mode == WRITER_SPINLOCK)
+			rte_spinlock_lock(&global_lock);
+		rte_metrics_update_values(port_id, set_key, values, SET_SIZE);
+		if (mode == WRITER_SPINLOCK)
+			rte_spinlock_unlock(&global_lock);
+		n++;
+	}
+	writer_count[lcore] = n;
+
+	return 0;
+}
+
+static uint64_t
+run_writers(enum writer_mode mode, unsigned int nb_writers)
+{
+	unsigned int lcore, n = 0;
+	uint64_t total = 0;
+
+	memset(writer_count, 0, sizeof(writer_count));
+	rte_atomic32_clear(&stop);
+
+	RTE_LCORE_FOREACH_SLAVE(lcore) {
+		if (n++ == nb_writers)
+			break;
+		rte_eal_remote_launch(writer_fn, &mode, lcore);
+	}
+	rte_delay_ms(DURATION_MS);
+	rte_atomic32_set(&stop, 1);
+	rte_eal_mp_wait_lcore();
+
+	RTE_LCORE_FOREACH_SLAVE(lcore)
+		total += writer_count[lcore];
+
+	return total / DURATION_MS;
+}
+
+static int
+test_metrics_perf(void)
+{
+	unsigned int nb_writers, max_writers;
+	uint64_t port, global, spinlock;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough lcores for the perf test, skipping\n");
+		return 0;
+	}
+	max_writers = RTE_MIN(rte_lcore_count() - 1, MAX_WRITERS);
+	if (max_writers < MAX_WRITERS)
+		printf("Only %u writer lcore(s), %u needed for the full test\n",
+		       max_writers, MAX_WRITERS);
+
+	rte_metrics_init(rte_socket_id());
+	set_key = rte_metrics_reg_names(set_names, SET_SIZE);
+	TEST_ASSERT(set_key >= 0, "Cannot register the metrics");
+	rte_spinlock_init(&global_lock);
+
+	printf("\n### Set updates per ms, %u metrics per set ###\n", SET_SIZE);
+	for (nb_writers = 1; nb_writers <= max_writers; nb_writers *= 2) {
+		port = run_writers(WRITER_PORT, nb_writers);
+		global = run_writers(WRITER_GLOBAL, nb_writers);
+		spinlock = run_writers(WRITER_SPINLOCK, nb_writers);
+
+		printf("%u writer(s): per port %"PRIu64", global %"PRIu64
+		       ", per port with a single lock %"PRIu64
+		       ", ratio %.2f\n",
+		       nb_writers, port, global, spinlock,
+		       spinlock != 0 ? (double)port / spinlock : 0);
+	}
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(metrics_perf_autotest, test_metrics_perf);
@@ -0,0 +1,330 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Arm Limited
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Arm Limited nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_malloc.h>
+#include <rte_cycles.h>
+#include <rte_rcu_qsbr.h>
+
+#include "test.h"
+
+/*
+ * RCU QSBR
+ * ========
+ *
+ * - Check the parameters of the API.
+ * - Check the grace period with a reader online, quiescent and offline.
+ * - Check the deferred queue: elements are freed once reclaimable.
+ * - With several lcores, readers follow a shared pointer that the writer
+ *   replaces and poisons after each grace period; a reader seeing a
+ *   poisoned element fails the test.
+ */
+
+#define TEST_RCU_MAX_THREADS 128
+#define TEST_DQ_SIZE 16
+#define TEST_STRESS_UPDATES 2000
+#define ELEM_VALID 0x600d600d
+#define ELEM_POISON 0xdeaddead
+
+struct test_elem {
+	volatile uint32_t state;
+	uint32_t value;
+};
+
+static struct rte_rcu_qsbr *v;
+static unsigned int nb_freed;
+static struct test_elem *volatile shared_elem;
+static volatile int stress_stop;
+static volatile int stress_error;
+
+static int
+test_rcu_qsbr_setup(void)
+{
+	size_t sz = rte_rcu_qsbr_get_memsize(TEST_RCU_MAX_THREADS);
+
+	v = rte_zmalloc("test_rcu", sz, RTE_CACHE_LINE_SIZE);
+	if (v == NULL)
+		return -1;
+	return rte_rcu_qsbr_init(v, TEST_RCU_MAX_THREADS);
+}
+
+static void
+test_rcu_qsbr_teardown(void)
+{
+	rte_free(v);
+	v = NULL;
+}
+
+static int
+test_rcu_qsbr_params(void)
+{
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_get_memsize(0), 0,
+		"Size of a variable without thread");
+	TEST_ASSERT(rte_rcu_qsbr_get_memsize(1) >=
+		sizeof(struct rte_rcu_qsbr) + sizeof(struct rte_rcu_qsbr_cnt),
+		"Size too small for one thread");
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_init(NULL, 1), -EINVAL,
+		"Init of NULL variable");
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_init(v, 0), -EINVAL,
+		"Init without thread");
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_thread_register(v,
+		TEST_RCU_MAX_THREADS), -EINVAL, "Register invalid thread");
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_thread_unregister(NULL, 0), -EINVAL,
+		"Unregister on NULL variable");
+
+	/* registering twice counts once */
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_register(v, 1),
+		"Cannot register thread");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_register(v, 1),
+		"Cannot register thread twice");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_register(v, 100),
+		"Cannot register thread");
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&v->num_threads), 2,
+		"Wrong number of threads");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dump(stdout, v), "Cannot dump");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_unregister(v, 1),
+		"Cannot unregister thread");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_unregister(v, 100),
+		"Cannot unregister thread");
+	TEST_ASSERT_EQUAL(rte_atomic32_read(&v->num_threads), 0,
+		"Wrong number of threads");
+
+	return 0;
+}
+
+static int
+test_rcu_qsbr_grace_period(void)
+{
+	uint64_t t;
+
+	/* no reader */
+	t = rte_rcu_qsbr_start(v);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 1,
+		"Grace period not over without reader");
+
+	/* offline reader */
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_register(v, 5),
+		"Cannot register thread");
+	t = rte_rcu_qsbr_start(v);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 1,
+		"Grace period not over with offline reader");
+
+	/* online reader, no quiescent state yet */
+	rte_rcu_qsbr_thread_online(v, 5);
+	t = rte_rcu_qsbr_start(v);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 0,
+		"Grace period over before quiescent state");
+	rte_rcu_qsbr_quiescent(v, 5);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 0), 1,
+		"Grace period not over after quiescent state");
+	/* acknowledged tokens are not checked again */
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t - 1, 0), 1,
+		"Previous grace period not over");
+
+	/* the caller is the reader */
+	rte_rcu_qsbr_synchronize(v, 5);
+
+	/* offline again */
+	t = rte_rcu_qsbr_start(v);
+	rte_rcu_qsbr_thread_offline(v, 5);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_check(v, t, 1), 1,
+		"Grace period not over after offline");
+	rte_rcu_qsbr_synchronize(v, RTE_QSBR_THRID_INVALID);
+
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_unregister(v, 5),
+		"Cannot unregister thread");
+	return 0;
+}
+
+static void
+test_free_fn(void *p, void *e)
+{
+	RTE_SET_USED(p);
+	RTE_SET_USED(e);
+	nb_freed++;
+}
+
+static int
+test_rcu_qsbr_dq(void)
+{
+	struct rte_rcu_qsbr_dq_parameters params;
+	struct rte_rcu_qsbr_dq *dq;
+	unsigned int freed, pending, i;
+	uintptr_t e;
+
+	memset(&params, 0, sizeof(params));
+	params.name = "test_dq";
+	params.size = TEST_DQ_SIZE;
+	params.socket_id = SOCKET_ID_ANY;
+	params.max_reclaim_size = 4;
+	params.free_fn = test_free_fn;
+	TEST_ASSERT_NULL(rte_rcu_qsbr_dq_create(&params),
+		"Queue created without QSBR variable");
+	params.v = v;
+	dq = rte_rcu_qsbr_dq_create(&params);
+	TEST_ASSERT_NOT_NULL(dq, "Cannot create queue");
+
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_register(v, 3),
+		"Cannot register thread");
+	rte_rcu_qsbr_thread_online(v, 3);
+	nb_freed = 0;
+
+	/* the reader may reference all the elements */
+	for (e = 1; e <= TEST_DQ_SIZE; e++)
+		TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dq_enqueue(dq, (void *)e),
+			"Cannot enqueue element %"PRIuPTR, e);
+	TEST_ASSERT_EQUAL(rte_rcu_qsbr_dq_enqueue(dq, (void *)e), -ENOSPC,
+		"Enqueued in a full queue");
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dq_reclaim(dq, TEST_DQ_SIZE,
+		&freed, &pending), "Cannot reclaim");
+	TEST_ASSERT(freed == 0 && pending == TEST_DQ_SIZE && nb_freed == 0,
+		"Elements freed before quiescent state");
+
+	/* the queue reclaims max_reclaim_size elements when full */
+	rte_rcu_qsbr_quiescent(v, 3);
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dq_enqueue(dq, (void *)e),
+		"Cannot enqueue in full queue after quiescent state");
+	TEST_ASSERT_EQUAL(nb_freed, params.max_reclaim_size,
+		"%u elements freed on enqueue", nb_freed);
+
+	/* the new element is not reclaimable yet */
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_dq_reclaim(dq, TEST_DQ_SIZE,
+		&freed, &pending), "Cannot reclaim");
+	TEST_ASSERT(nb_freed == TEST_DQ_SIZE && pending == 1,
+		"Wrong reclaim: %u freed, %u pending", nb_freed, pending);
+
+	rte_rcu_qsbr_quiescent(v, 3);
+	for (i = 0; i < 2; i++)
+		rte_rcu_qsbr_dq_enqueue(dq, (void *)e);
+	rte_rcu_qsbr_thread_offline(v, 3);
+	rte_rcu_qsbr_dq_delete(dq);
+	TEST_ASSERT_EQUAL(nb_freed, TEST_DQ_SIZE + 3,
+		"Elements not freed on delete");
+
+	TEST_ASSERT_SUCCESS(rte_rcu_qsbr_thread_unregister(v, 3),
+		"Cannot unregister thread");
+	return 0;
+}
+
+static int
+test_rcu_qsbr_reader(__attribute__((unused)) void *arg)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	struct test_elem *e;
+
+	rte_rcu_qsbr_thread_register(v, lcore_id);
+	rte_rcu_qsbr_thread_online(v, lcore_id);
+
+	while (!stress_stop) {
+		e = shared_elem;
+		if (e->state != ELEM_VALID)
+			stress_error = 1;
+		rte_rcu_qsbr_quiescent(v, lcore_id);
+	}
+
+	rte_rcu_qsbr_thread_offline(v, lcore_id);
+	rte_rcu_qsbr_thread_unregister(v, lcore_id);
+	return 0;
+}
+
+static int
+test_rcu_qsbr_stress(void)
+{
+	struct test_elem elems[2];
+	unsigned int i, lcore_id;
+	struct test_elem *old, *new;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough lcores for the stress test, skipping\n");
+		return 0;
+	}
+
+	elems[0].state = ELEM_VALID;
+	elems[1].state = ELEM_POISON;
+	shared_elem = &elems[0];
+	stress_stop = 0;
+	stress_error = 0;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		rte_eal_remote_launch(test_rcu_qsbr_reader, NULL, lcore_id);
+
+	for (i = 0; i < TEST_STRESS_UPDATES && !stress_error; i++) {
+		/* replace the element, then free (poison) the old one */
+		old = shared_elem;
+		new = old == &elems[0] ? &elems[1] : &elems[0];
+		new->state = ELEM_VALID;
+		rte_smp_wmb();
+		shared_elem = new;
+		rte_rcu_qsbr_synchronize(v, RTE_QSBR_THRID_INVALID);
+		old->state = ELEM_POISON;
+	}
+
+	stress_stop = 1;
+	rte_eal_mp_wait_lcore();
+
+	TEST_ASSERT_EQUAL(stress_error, 0,
+		"A reader accessed a freed element");
+	return 0;
+}
+
+static struct unit_test_suite rcu_qsbr_tests = {
+	.suite_name = "RCU QSBR test suite",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE_ST(test_rcu_qsbr_setup, test_rcu_qsbr_teardown,
+			test_rcu_qsbr_params),
+		TEST_CASE_ST(test_rcu_qsbr_setup, test_rcu_qsbr_teardown,
+			test_rcu_qsbr_grace_period),
+		TEST_CASE_ST(test_rcu_qsbr_setup, test_rcu_qsbr_teardown,
+			test_rcu_qsbr_dq),
+		TEST_CASE_ST(test_rcu_qsbr_setup, test_rcu_qsbr_teardown,
+			test_rcu_qsbr_stress),
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_rcu_qsbr(void)
+{
+	return unit_test_suite_runner(&rcu_qsbr_tests);
+}
+
+REGISTER_TEST_COMMAND(rcu_qsbr_autotest, test_rcu_qsbr);
@@ -0,0 +1,197 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Arm Limited
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Arm Limited nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_malloc.h>
+#include <rte_cycles.h>
+#include <rte_rcu_qsbr.h>
+
+#include "test.h"
+
+/*
+ * RCU QSBR performance
+ * ====================
+ *
+ * Measures, using rdtsc:
+ *  * the cost of a quiescent state report and of an online/offline pair
+ *    on a single lcore
+ *  * with 1, 2, 4, ... 64 reader lcores (as many as available), the
+ *    cycles per reader loop iteration and the writer wait time for a
+ *    grace period (rte_rcu_qsbr_start() + blocking rte_rcu_qsbr_check())
+ */
+
+#define ITERATIONS (1 << 20)
+#define WRITER_ITERATIONS 1000
+#define MAX_READERS 64U
+
+static struct rte_rcu_qsbr *v;
+static volatile int readers_stop;
+static uint64_t reader_cycles[RTE_MAX_LCORE];
+static uint64_t reader_iters[RTE_MAX_LCORE];
+
+static int
+test_rcu_qsbr_reader_perf(__attribute__((unused)) void *arg)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	uint64_t begin, iters = 0;
+
+	rte_rcu_qsbr_thread_register(v, lcore_id);
+	rte_rcu_qsbr_thread_online(v, lcore_id);
+
+	begin = rte_rdtsc_precise();
+	while (!readers_stop) {
+		rte_rcu_qsbr_quiescent(v, lcore_id);
+		iters++;
+	}
+	reader_cycles[lcore_id] = rte_rdtsc_precise() - begin;
+	reader_iters[lcore_id] = iters;
+
+	rte_rcu_qsbr_thread_offline(v, lcore_id);
+	rte_rcu_qsbr_thread_unregister(v, lcore_id);
+	return 0;
+}
+
+static void
+test_rcu_qsbr_single_perf(void)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	uint64_t begin, end;
+	unsigned int i;
+
+	rte_rcu_qsbr_thread_register(v, lcore_id);
+	rte_rcu_qsbr_thread_online(v, lcore_id);
+
+	begin = rte_rdtsc_precise();
+	for (i = 0; i < ITERATIONS; i++)
+		rte_rcu_qsbr_quiescent(v, lcore_id);
+	end = rte_rdtsc_precise();
+	printf("Quiescent state report: %.2F cycles\n",
+		(double)(end - begin) / ITERATIONS);
+
+	begin = rte_rdtsc_precise();
+	for (i = 0; i < ITERATIONS; i++) {
+		rte_rcu_qsbr_thread_offline(v, lcore_id);
+		rte_rcu_qsbr_thread_online(v, lcore_id);
+	}
+	end = rte_rdtsc_precise();
+	printf("Offline + online: %.2F cycles\n",
+		(double)(end - begin) / ITERATIONS);
+
+	rte_rcu_qsbr_thread_offline(v, lcore_id);
+	rte_rcu_qsbr_thread_unregister(v, lcore_id);
+
+	/* grace period without reader */
+	begin = rte_rdtsc_precise();
+	for (i = 0; i < ITERATIONS; i++)
+		rte_rcu_qsbr_check(v, rte_rcu_qsbr_start(v), 1);
+	end = rte_rdtsc_precise();
+	printf("Grace period without reader: %.2F cycles\n",
+		(double)(end - begin) / ITERATIONS);
+}
+
+static void
+test_rcu_qsbr_readers_perf(unsigned int nb_readers)
+{
+	uint64_t begin, end, cycles = 0, iters = 0;
+	unsigned int lcore_id, n = 0;
+	unsigned int i;
+
+	readers_stop = 0;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (n++ == nb_readers)
+			break;
+		reader_cycles[lcore_id] = 0;
+		reader_iters[lcore_id] = 0;
+		rte_eal_remote_launch(test_rcu_qsbr_reader_perf, NULL,
+			lcore_id);
+	}
+
+	/* wait for the readers to be online */
+	while ((unsigned int)rte_atomic32_read(&v->num_threads) !=
+			nb_readers)
+		rte_pause();
+
+	begin = rte_rdtsc_precise();
+	for (i = 0; i < WRITER_ITERATIONS; i++)
+		rte_rcu_qsbr_check(v, rte_rcu_qsbr_start(v), 1);
+	end = rte_rdtsc_precise();
+
+	readers_stop = 1;
+	rte_eal_mp_wait_lcore();
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		cycles += reader_cycles[lcore_id];
+		iters += reader_iters[lcore_id];
+	}
+
+	printf("%u reader(s): %.2F cycles per reader iteration, "
+		"%.2F cycles per grace period\n", nb_readers,
+		iters ? (double)cycles / iters : 0,
+		(double)(end - begin) / WRITER_ITERATIONS);
+}
+
+static int
+test_rcu_qsbr_perf(void)
+{
+	unsigned int max_readers, nb_readers;
+	size_t sz;
+
+	sz = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+	v = rte_zmalloc("test_rcu_perf", sz, RTE_CACHE_LINE_SIZE);
+	if (v == NULL) {
+		printf("Cannot allocate QSBR variable\n");
+		return -1;
+	}
+	rte_rcu_qsbr_init(v, RTE_MAX_LCORE);
+
+	printf("\n### Single lcore ###\n");
+	test_rcu_qsbr_single_perf();
+
+	max_readers = RTE_MIN(rte_lcore_count() - 1, MAX_READERS);
+	if (max_readers == 0)
+		printf("\nNot enough lcores for the reader tests\n");
+	else
+		printf("\n### Readers on slave lcores, writer on master ###\n");
+	for (nb_readers = 1; nb_readers <= max_readers; nb_readers *= 2)
+		test_rcu_qsbr_readers_perf(nb_readers);
+
+	rte_free(v);
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(rcu_qsbr_perf_autotest, test_rcu_qsbr_perf);
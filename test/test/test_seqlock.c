@@ -0,0 +1,239 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Arm Limited
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Arm Limited nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_seqcount.h>
+#include <rte_seqlock.h>
+
+#include "test.h"
+
+/*
+ * Sequence lock test
+ * ==================
+ *
+ * - Check the sequence numbers seen by a reader on a single core: no retry
+ *   without a write, a retry when a write is in progress or happened
+ *   during the read section.
+ *
+ * - Stress test: the master lcore rewrites a set of fields with the same
+ *   value, with a delay between each field to widen the race windows,
+ *   while the slave lcores read them. A reader must never see different
+ *   values once its read section is not retried.
+ */
+
+#define STRESS_DURATION_MS 200
+
+struct data {
+	rte_seqlock_t lock;
+	rte_seqcount_t count;
+	uint64_t a;
+	uint64_t b __rte_cache_aligned;
+	uint64_t c __rte_cache_aligned;
+};
+
+static struct data data;
+static rte_atomic32_t stop;
+static rte_atomic32_t errors;
+static rte_atomic64_t reads;
+
+static int
+test_seqlock_single(void)
+{
+	uint32_t sn;
+
+	rte_seqlock_init(&data.lock);
+	rte_seqcount_init(&data.count);
+
+	sn = rte_seqlock_read_begin(&data.lock);
+	TEST_ASSERT(rte_seqlock_read_retry(&data.lock, sn) == 0,
+		    "Retry without any write");
+
+	rte_seqlock_write_lock(&data.lock);
+	TEST_ASSERT(rte_seqlock_read_retry(&data.lock,
+			rte_seqlock_read_begin(&data.lock)) != 0,
+		    "No retry while a write is in progress");
+	rte_seqlock_write_unlock(&data.lock);
+	TEST_ASSERT(rte_seqlock_read_retry(&data.lock, sn) != 0,
+		    "No retry after a write");
+
+	sn = rte_seqcount_read_begin(&data.count);
+	TEST_ASSERT(rte_seqcount_read_retry(&data.count, sn) == 0,
+		    "Retry without any write");
+	rte_seqcount_write_begin(&data.count);
+	TEST_ASSERT(rte_seqcount_read_retry(&data.count,
+			rte_seqcount_read_begin(&data.count)) != 0,
+		    "No retry while a write is in progress");
+	rte_seqcount_write_end(&data.count);
+	TEST_ASSERT(rte_seqcount_read_retry(&data.count, sn) != 0,
+		    "No retry after a write");
+
+	return 0;
+}
+
+static int
+reader_fn(void *arg)
+{
+	const int use_seqcount = *(const int *)arg;
+	uint64_t a, b, c, n = 0;
+	uint32_t sn;
+
+	while (rte_atomic32_read(&stop) == 0) {
+		if (use_seqcount) {
+			do {
+				sn = rte_seqcount_read_begin(&data.count);
+				a = data.a;
+				b = data.b;
+				c = data.c;
+			} while (rte_seqcount_read_retry(&data.count, sn));
+		} else {
+			do {
+				sn = rte_seqlock_read_begin(&data.lock);
+				a = data.a;
+				b = data.b;
+				c = data.c;
+			} while (rte_seqlock_read_retry(&data.lock, sn));
+		}
+
+		if (a != b || b != c) {
+			printf("Inconsistent read on lcore %u: "
+			       "%"PRIu64" %"PRIu64" %"PRIu64"\n",
+			       rte_lcore_id(), a, b, c);
+			rte_atomic32_inc(&errors);
+			break;
+		}
+		n++;
+	}
+	rte_atomic64_add(&reads, n);
+
+	return 0;
+}
+
+static void
+write_data(int use_seqcount, uint64_t value)
+{
+	if (use_seqcount)
+		rte_seqcount_write_begin(&data.count);
+	else
+		rte_seqlock_write_lock(&data.lock);
+
+	data.a = value;
+	rte_delay_us(1);
+	data.b = value;
+	rte_delay_us(1);
+	data.c = value;
+
+	if (use_seqcount)
+		rte_seqcount_write_end(&data.count);
+	else
+		rte_seqlock_write_unlock(&data.lock);
+}
+
+static int
+test_seqlock_stress(int use_seqcount)
+{
+	const uint64_t duration = rte_get_timer_hz() * STRESS_DURATION_MS /
+		1000;
+	uint64_t begin, value = 0;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough lcores for the stress test, skipping\n");
+		return 0;
+	}
+
+	rte_seqlock_init(&data.lock);
+	rte_seqcount_init(&data.count);
+	data.a = data.b = data.c = 0;
+	rte_atomic32_clear(&stop);
+	rte_atomic32_clear(&errors);
+	rte_atomic64_clear(&reads);
+
+	rte_eal_mp_remote_launch(reader_fn, &use_seqcount, SKIP_MASTER);
+
+	begin = rte_get_timer_cycles();
+	while (rte_get_timer_cycles() - begin < duration &&
+			rte_atomic32_read(&errors) == 0)
+		write_data(use_seqcount, ++value);
+
+	rte_atomic32_set(&stop, 1);
+	rte_eal_mp_wait_lcore();
+
+	printf("%s: %"PRIu64" writes, %"PRIu64" consistent reads\n",
+	       use_seqcount ? "seqcount" : "seqlock", value,
+	       rte_atomic64_read(&reads));
+
+	TEST_ASSERT(rte_atomic32_read(&errors) == 0,
+		    "Readers got inconsistent data");
+
+	return 0;
+}
+
+static int
+test_seqlock_stress_lock(void)
+{
+	return test_seqlock_stress(0);
+}
+
+static int
+test_seqlock_stress_count(void)
+{
+	return test_seqlock_stress(1);
+}
+
+static struct unit_test_suite seqlock_tests = {
+	.suite_name = "seqlock autotest",
+	.setup = NULL,
+	.teardown = NULL,
+	.unit_test_cases = {
+		TEST_CASE(test_seqlock_single),
+		TEST_CASE(test_seqlock_stress_lock),
+		TEST_CASE(test_seqlock_stress_count),
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_seqlock(void)
+{
+	return unit_test_suite_runner(&seqlock_tests);
+}
+
+REGISTER_TEST_COMMAND(seqlock_autotest, test_seqlock);
@@ -0,0 +1,204 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Arm Limited
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Arm Limited nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_rwlock.h>
+#include <rte_seqlock.h>
+
+#include "test.h"
+
+/*
+ * Sequence lock performance test
+ * ==============================
+ *
+ * Readers on the slave lcores copy a per-port configuration blob (MAC
+ * address, MTU and next-hops) in a loop, while the master lcore rewrites
+ * it periodically, as a control thread would. The reader throughput is
+ * measured for 1, 2, 4, ... up to 32 readers, with the blob protected by
+ * a rte_rwlock and by a rte_seqlock.
+ */
+
+#define MAX_READERS 32U
+#define DURATION_MS 100
+#define WRITE_PERIOD_US 100
+#define NB_NEXT_HOPS 8
+
+struct port_conf {
+	uint8_t mac[6];
+	uint16_t mtu;
+	uint32_t next_hops[NB_NEXT_HOPS];
+};
+
+static struct {
+	rte_rwlock_t rwlock;
+	rte_seqlock_t seqlock;
+	struct port_conf conf;
+} shared __rte_cache_aligned;
+
+static uint64_t reader_count[RTE_MAX_LCORE] __rte_cache_aligned;
+static rte_atomic32_t stop;
+static rte_atomic32_t nb_started;
+
+static int
+reader_fn(void *arg)
+{
+	const int use_seqlock = *(const int *)arg;
+	struct port_conf conf;
+	uint64_t n = 0;
+	uint32_t sn;
+
+	rte_atomic32_inc(&nb_started);
+	while (rte_atomic32_read(&stop) == 0) {
+		if (use_seqlock) {
+			do {
+				sn = rte_seqlock_read_begin(&shared.seqlock);
+				conf = shared.conf;
+			} while (rte_seqlock_read_retry(&shared.seqlock, sn));
+		} else {
+			rte_rwlock_read_lock(&shared.rwlock);
+			conf = shared.conf;
+			rte_rwlock_read_unlock(&shared.rwlock);
+		}
+		/* keep the copy alive */
+		n += conf.mtu != 0;
+	}
+	reader_count[rte_lcore_id()] = n;
+
+	return 0;
+}
+
+static void
+writer_update(int use_seqlock, uint32_t value)
+{
+	unsigned int i;
+
+	if (use_seqlock)
+		rte_seqlock_write_lock(&shared.seqlock);
+	else
+		rte_rwlock_write_lock(&shared.rwlock);
+
+	memset(shared.conf.mac, value, sizeof(shared.conf.mac));
+	shared.conf.mtu = 1500 + (value & 0xff);
+	for (i = 0; i < NB_NEXT_HOPS; i++)
+		shared.conf.next_hops[i] = value + i;
+
+	if (use_seqlock)
+		rte_seqlock_write_unlock(&shared.seqlock);
+	else
+		rte_rwlock_write_unlock(&shared.rwlock);
+}
+
+static uint64_t
+run_readers(int use_seqlock, unsigned int nb_readers, uint64_t *writes)
+{
+	const uint64_t duration = rte_get_timer_hz() * DURATION_MS / 1000;
+	const uint64_t period = rte_get_timer_hz() * WRITE_PERIOD_US / 1000000;
+	uint64_t begin, now, next_write, total = 0;
+	unsigned int lcore, n = 0;
+
+	memset(reader_count, 0, sizeof(reader_count));
+	rte_atomic32_clear(&stop);
+	rte_atomic32_clear(&nb_started);
+	*writes = 0;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore) {
+		if (n++ == nb_readers)
+			break;
+		rte_eal_remote_launch(reader_fn, &use_seqlock, lcore);
+	}
+	while (rte_atomic32_read(&nb_started) != (int32_t)nb_readers)
+		;
+
+	begin = rte_get_timer_cycles();
+	next_write = begin + period;
+	do {
+		now = rte_get_timer_cycles();
+		if (now >= next_write) {
+			writer_update(use_seqlock, (uint32_t)++(*writes));
+			next_write += period;
+		}
+	} while (now - begin < duration);
+
+	rte_atomic32_set(&stop, 1);
+	rte_eal_mp_wait_lcore();
+
+	RTE_LCORE_FOREACH_SLAVE(lcore)
+		total += reader_count[lcore];
+
+	return total;
+}
+
+static int
+test_seqlock_perf(void)
+{
+	unsigned int nb_readers, max_readers;
+	uint64_t rw_reads, seq_reads, rw_writes, seq_writes;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough lcores for the perf test, skipping\n");
+		return 0;
+	}
+	max_readers = RTE_MIN(rte_lcore_count() - 1, MAX_READERS);
+
+	rte_rwlock_init(&shared.rwlock);
+	rte_seqlock_init(&shared.seqlock);
+	memset(&shared.conf, 0, sizeof(shared.conf));
+
+	printf("\n### Reader throughput, writer every %u us, %u ms ###\n",
+	       WRITE_PERIOD_US, DURATION_MS);
+	for (nb_readers = 1; nb_readers <= max_readers; nb_readers *= 2) {
+		rw_reads = run_readers(0, nb_readers, &rw_writes);
+		seq_reads = run_readers(1, nb_readers, &seq_writes);
+
+		printf("%2u reader(s): rwlock %"PRIu64" reads/ms (%"PRIu64
+		       " writes), seqlock %"PRIu64" reads/ms (%"PRIu64
+		       " writes), ratio %.2f\n",
+		       nb_readers, rw_reads / DURATION_MS, rw_writes,
+		       seq_reads / DURATION_MS, seq_writes,
+		       rw_reads != 0 ? (double)seq_reads / rw_reads : 0);
+	}
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(seqlock_perf_autotest, test_seqlock_perf);
@@ -0,0 +1,485 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_service.h>
+#include <rte_service_component.h>
+
+#include "test.h"
+
+#define DUMMY_SERVICE_NAME "dummy_service"
+#define MT_UNSAFE_SERVICE_NAME "mt_unsafe_service"
+/* how long to wait for a service core to run a service, in ms */
+#define SERVICE_WAIT_MS 1000
+
+static uint32_t slcore_id;
+static uint32_t dummy_id;
+static uint32_t unsafe_id;
+
+static volatile uint64_t dummy_calls;
+static volatile uint64_t unsafe_calls;
+static rte_atomic32_t unsafe_inflight;
+static volatile int unsafe_concurrent;
+
+static int32_t
+dummy_cb(void *args)
+{
+	RTE_SET_USED(args);
+	dummy_calls++;
+	return 0;
+}
+
+/* a service which is not MT safe: detect concurrent calls */
+static int32_t
+mt_unsafe_cb(void *args)
+{
+	RTE_SET_USED(args);
+	if (rte_atomic32_add_return(&unsafe_inflight, 1) != 1)
+		unsafe_concurrent = 1;
+	rte_delay_us(2);
+	unsafe_calls++;
+	rte_atomic32_dec(&unsafe_inflight);
+	return 0;
+}
+
+/* wait until *counter changes, return 0 if it did */
+static int
+wait_counter(volatile uint64_t *counter)
+{
+	uint64_t start = *counter;
+	unsigned int i;
+
+	for (i = 0; i < SERVICE_WAIT_MS; i++) {
+		if (*counter != start)
+			return 0;
+		rte_delay_ms(1);
+	}
+	return -1;
+}
+
+static int
+testsuite_setup(void)
+{
+	slcore_id = rte_get_next_lcore(-1, 1, 0);
+	return TEST_SUCCESS;
+}
+
+static void
+testsuite_teardown(void)
+{
+	rte_service_lcore_reset_all();
+}
+
+static int
+dummy_register(void)
+{
+	struct rte_service_spec service;
+
+	memset(&service, 0, sizeof(service));
+	snprintf(service.name, sizeof(service.name), DUMMY_SERVICE_NAME);
+	service.callback = dummy_cb;
+	service.socket_id = rte_socket_id();
+	dummy_calls = 0;
+	TEST_ASSERT_EQUAL(0, rte_service_component_register(&service,
+			&dummy_id), "Failed to register dummy service");
+
+	memset(&service, 0, sizeof(service));
+	snprintf(service.name, sizeof(service.name), MT_UNSAFE_SERVICE_NAME);
+	service.callback = mt_unsafe_cb;
+	service.socket_id = rte_socket_id();
+	unsafe_calls = 0;
+	unsafe_concurrent = 0;
+	rte_atomic32_init(&unsafe_inflight);
+	TEST_ASSERT_EQUAL(0, rte_service_component_register(&service,
+			&unsafe_id), "Failed to register MT unsafe service");
+
+	return TEST_SUCCESS;
+}
+
+static void
+dummy_unregister(void)
+{
+	rte_service_lcore_reset_all();
+	rte_service_component_unregister(dummy_id);
+	rte_service_component_unregister(unsafe_id);
+}
+
+static int
+service_register(void)
+{
+	struct rte_service_spec service;
+	uint32_t id;
+	uint32_t count = rte_service_get_count();
+
+	memset(&service, 0, sizeof(service));
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_component_register(NULL, &id),
+			"Registered NULL spec");
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_component_register(&service,
+			&id), "Registered a service without name");
+	snprintf(service.name, sizeof(service.name), "test_register");
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_component_register(&service,
+			&id), "Registered a service without callback");
+
+	service.callback = dummy_cb;
+	service.capabilities = RTE_SERVICE_CAP_MT_SAFE;
+	TEST_ASSERT_EQUAL(0, rte_service_component_register(&service, &id),
+			"Failed to register service");
+	TEST_ASSERT_EQUAL(count + 1, rte_service_get_count(),
+			"Wrong service count");
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_component_register(&service,
+			NULL), "Registered the same name twice");
+
+	TEST_ASSERT_EQUAL(0, strcmp("test_register",
+			rte_service_get_name(id)), "Wrong service name");
+	uint32_t found = UINT32_MAX;
+	TEST_ASSERT_EQUAL(0, rte_service_get_by_name("test_register", &found),
+			"Service not found by name");
+	TEST_ASSERT_EQUAL(id, found, "Wrong id found by name");
+	TEST_ASSERT_EQUAL(-ENODEV, rte_service_get_by_name("not_a_service",
+			&found), "Found a service that does not exist");
+	TEST_ASSERT_EQUAL(1, rte_service_probe_capability(id,
+			RTE_SERVICE_CAP_MT_SAFE), "MT safe capability not set");
+
+	TEST_ASSERT_EQUAL(0, rte_service_component_unregister(id),
+			"Failed to unregister service");
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_component_unregister(id),
+			"Unregistered the same service twice");
+	TEST_ASSERT_NULL(rte_service_get_name(id),
+			"Name of an unregistered service");
+	TEST_ASSERT_EQUAL(count, rte_service_get_count(),
+			"Wrong service count");
+
+	return TEST_SUCCESS;
+}
+
+static int
+service_runstate(void)
+{
+	/* both the component and the application must set running */
+	TEST_ASSERT_EQUAL(0, rte_service_runstate_get(dummy_id),
+			"Service running after registration");
+	TEST_ASSERT_EQUAL(-ENOEXEC,
+			rte_service_run_iter_on_app_lcore(dummy_id, 1),
+			"Stopped service was run");
+
+	rte_service_runstate_set(dummy_id, 1);
+	TEST_ASSERT_EQUAL(0, rte_service_runstate_get(dummy_id),
+			"Service running without its component");
+	rte_service_component_runstate_set(dummy_id, 1);
+	TEST_ASSERT_EQUAL(1, rte_service_runstate_get(dummy_id),
+			"Service not running");
+
+	TEST_ASSERT_EQUAL(0, rte_service_run_iter_on_app_lcore(dummy_id, 1),
+			"Failed to run service on app lcore");
+	TEST_ASSERT_EQUAL(1, dummy_calls, "Service callback not called");
+
+	rte_service_component_runstate_set(dummy_id, 0);
+	TEST_ASSERT_EQUAL(-ENOEXEC,
+			rte_service_run_iter_on_app_lcore(dummy_id, 1),
+			"Service run after its component stopped it");
+
+	return TEST_SUCCESS;
+}
+
+static int
+service_attr(void)
+{
+	uint64_t calls, cycles;
+	unsigned int i;
+
+	rte_service_runstate_set(dummy_id, 1);
+	rte_service_component_runstate_set(dummy_id, 1);
+
+	/* statistics are disabled by default */
+	rte_service_run_iter_on_app_lcore(dummy_id, 1);
+	TEST_ASSERT_EQUAL(0, rte_service_attr_get(dummy_id,
+			RTE_SERVICE_ATTR_CALLS, &calls), "attr_get failed");
+	TEST_ASSERT_EQUAL(0, calls, "Calls accounted with stats disabled");
+
+	rte_service_set_stats_enable(dummy_id, 1);
+	for (i = 0; i < 100; i++)
+		rte_service_run_iter_on_app_lcore(dummy_id, 1);
+	TEST_ASSERT_EQUAL(0, rte_service_attr_get(dummy_id,
+			RTE_SERVICE_ATTR_CALLS, &calls), "attr_get failed");
+	TEST_ASSERT_EQUAL(100, calls, "Wrong number of calls: %"PRIu64,
+			calls);
+	TEST_ASSERT_EQUAL(0, rte_service_attr_get(dummy_id,
+			RTE_SERVICE_ATTR_CYCLES, &cycles), "attr_get failed");
+	TEST_ASSERT(cycles > 0, "No cycles accounted");
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_attr_get(dummy_id, UINT32_MAX,
+			&cycles), "Invalid attribute accepted");
+
+	TEST_ASSERT_EQUAL(0, rte_service_attr_reset_all(dummy_id),
+			"attr_reset_all failed");
+	rte_service_attr_get(dummy_id, RTE_SERVICE_ATTR_CALLS, &calls);
+	TEST_ASSERT_EQUAL(0, calls, "Calls not reset");
+
+	rte_service_dump(stdout, UINT32_MAX);
+
+	return TEST_SUCCESS;
+}
+
+static int
+service_lcore_add_del(void)
+{
+	uint32_t lcores[RTE_MAX_LCORE];
+	unsigned int count = rte_lcore_count();
+
+	TEST_ASSERT_EQUAL(-EINVAL,
+			rte_service_lcore_add(rte_get_master_lcore()),
+			"Master lcore added as service lcore");
+
+	if (slcore_id >= RTE_MAX_LCORE) {
+		printf("%s: no slave lcore, skipping\n", __func__);
+		return TEST_SUCCESS;
+	}
+
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_add(slcore_id),
+			"Failed to add service lcore");
+	TEST_ASSERT_EQUAL(-EALREADY, rte_service_lcore_add(slcore_id),
+			"Added service lcore twice");
+	TEST_ASSERT_EQUAL(1, rte_service_lcore_count(),
+			"Wrong service lcore count");
+	TEST_ASSERT_EQUAL(1, rte_service_lcore_list(lcores, RTE_MAX_LCORE),
+			"Wrong service lcore list");
+	TEST_ASSERT_EQUAL(slcore_id, lcores[0], "Wrong service lcore");
+
+	/* a service lcore is not an application lcore anymore */
+	TEST_ASSERT_EQUAL(count - 1, rte_lcore_count(),
+			"Service lcore still counted");
+	TEST_ASSERT(!rte_lcore_is_enabled(slcore_id),
+			"Service lcore still enabled");
+
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_del(slcore_id),
+			"Failed to remove service lcore");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_count(),
+			"Wrong service lcore count");
+	TEST_ASSERT_EQUAL(count, rte_lcore_count(), "Lcore not restored");
+
+	return TEST_SUCCESS;
+}
+
+static int
+service_lcore_start_stop(void)
+{
+	if (slcore_id >= RTE_MAX_LCORE) {
+		printf("%s: no slave lcore, skipping\n", __func__);
+		return TEST_SUCCESS;
+	}
+
+	TEST_ASSERT_EQUAL(-EINVAL, rte_service_lcore_start(slcore_id),
+			"Started an lcore which is not a service lcore");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_add(slcore_id),
+			"Failed to add service lcore");
+	TEST_ASSERT_EQUAL(0, rte_service_map_lcore_set(dummy_id, slcore_id, 1),
+			"Failed to map service");
+	TEST_ASSERT_EQUAL(1, rte_service_map_lcore_get(dummy_id, slcore_id),
+			"Service not mapped");
+	TEST_ASSERT_EQUAL(1, rte_service_lcore_count_services(slcore_id),
+			"Wrong number of services mapped");
+
+	rte_service_runstate_set(dummy_id, 1);
+	rte_service_component_runstate_set(dummy_id, 1);
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_start(slcore_id),
+			"Failed to start service lcore");
+	TEST_ASSERT_EQUAL(-EALREADY, rte_service_lcore_start(slcore_id),
+			"Started service lcore twice");
+	TEST_ASSERT_EQUAL(0, wait_counter(&dummy_calls),
+			"Service not run by the service lcore");
+
+	/* the lcore is the only one running the service */
+	TEST_ASSERT_EQUAL(-EBUSY, rte_service_lcore_stop(slcore_id),
+			"Stopped the only lcore of a running service");
+	TEST_ASSERT_EQUAL(-EBUSY, rte_service_lcore_del(slcore_id),
+			"Removed a running service lcore");
+
+	rte_service_runstate_set(dummy_id, 0);
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_stop(slcore_id),
+			"Failed to stop service lcore");
+	TEST_ASSERT_EQUAL(0, rte_eal_wait_lcore(slcore_id),
+			"Service loop returned an error");
+	TEST_ASSERT_EQUAL(0, rte_service_may_be_active(dummy_id),
+			"Service still active on a stopped lcore");
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_del(slcore_id),
+			"Failed to remove service lcore");
+
+	return TEST_SUCCESS;
+}
+
+static int
+service_lcore_multiplex(void)
+{
+	if (slcore_id >= RTE_MAX_LCORE) {
+		printf("%s: no slave lcore, skipping\n", __func__);
+		return TEST_SUCCESS;
+	}
+
+	/* two services share the same service lcore */
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_add(slcore_id),
+			"Failed to add service lcore");
+	rte_service_map_lcore_set(dummy_id, slcore_id, 1);
+	rte_service_map_lcore_set(unsafe_id, slcore_id, 1);
+	TEST_ASSERT_EQUAL(2, rte_service_lcore_count_services(slcore_id),
+			"Wrong number of services mapped");
+
+	rte_service_runstate_set(dummy_id, 1);
+	rte_service_component_runstate_set(dummy_id, 1);
+	rte_service_runstate_set(unsafe_id, 1);
+	rte_service_component_runstate_set(unsafe_id, 1);
+	rte_service_set_stats_enable(unsafe_id, 1);
+
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_start(slcore_id),
+			"Failed to start service lcore");
+	TEST_ASSERT_EQUAL(0, wait_counter(&dummy_calls),
+			"First service not run");
+	TEST_ASSERT_EQUAL(0, wait_counter(&unsafe_calls),
+			"Second service not run");
+
+	rte_service_runstate_set(dummy_id, 0);
+	rte_service_runstate_set(unsafe_id, 0);
+	rte_service_lcore_stop(slcore_id);
+	rte_eal_wait_lcore(slcore_id);
+
+	uint64_t cycles = 0;
+	rte_service_attr_get(unsafe_id, RTE_SERVICE_ATTR_CYCLES, &cycles);
+	TEST_ASSERT(cycles > 0, "No cycles accounted on service lcore");
+
+	return TEST_SUCCESS;
+}
+
+static int
+service_mt_unsafe_serialized(void)
+{
+	unsigned int i;
+	int ret, run = 0;
+
+	if (slcore_id >= RTE_MAX_LCORE) {
+		printf("%s: no slave lcore, skipping\n", __func__);
+		return TEST_SUCCESS;
+	}
+
+	/* run the MT unsafe service both on a service lcore and on the
+	 * master lcore: the calls must never overlap
+	 */
+	rte_service_lcore_add(slcore_id);
+	rte_service_map_lcore_set(unsafe_id, slcore_id, 1);
+	rte_service_runstate_set(unsafe_id, 1);
+	rte_service_component_runstate_set(unsafe_id, 1);
+	TEST_ASSERT_EQUAL(0, rte_service_lcore_start(slcore_id),
+			"Failed to start service lcore");
+	TEST_ASSERT_EQUAL(0, wait_counter(&unsafe_calls),
+			"Service not run by the service lcore");
+
+	for (i = 0; i < 10000; i++) {
+		ret = rte_service_run_iter_on_app_lcore(unsafe_id, 1);
+		TEST_ASSERT(ret == 0 || ret == -EBUSY,
+			"Unexpected return %d", ret);
+		run += (ret == 0);
+	}
+
+	rte_service_runstate_set(unsafe_id, 0);
+	rte_service_lcore_stop(slcore_id);
+	rte_eal_wait_lcore(slcore_id);
+
+	TEST_ASSERT_EQUAL(0, unsafe_concurrent,
+			"MT unsafe service run concurrently");
+	printf("%s: %d of 10000 iterations run on the master lcore\n",
+		__func__, run);
+
+	return TEST_SUCCESS;
+}
+
+static int
+service_start_with_defaults(void)
+{
+	if (slcore_id >= RTE_MAX_LCORE) {
+		TEST_ASSERT_EQUAL(-ENOTSUP, rte_service_start_with_defaults(),
+			"Started services without service lcore");
+		printf("%s: no slave lcore, skipping\n", __func__);
+		return TEST_SUCCESS;
+	}
+
+	rte_service_lcore_add(slcore_id);
+	rte_service_component_runstate_set(dummy_id, 1);
+	TEST_ASSERT_EQUAL(0, rte_service_start_with_defaults(),
+			"Failed to start services with defaults");
+	TEST_ASSERT_EQUAL(1, rte_service_runstate_get(dummy_id),
+			"Service not running");
+	TEST_ASSERT_EQUAL(1, rte_service_map_lcore_get(dummy_id, slcore_id),
+			"Service not mapped");
+	TEST_ASSERT_EQUAL(0, wait_counter(&dummy_calls),
+			"Service not run by the service lcore");
+
+	return TEST_SUCCESS;
+}
+
+static struct unit_test_suite service_tests = {
+	.suite_name = "service core test suite",
+	.setup = testsuite_setup,
+	.teardown = testsuite_teardown,
+	.unit_test_cases = {
+		TEST_CASE(service_register),
+		TEST_CASE_ST(dummy_register, dummy_unregister,
+			service_runstate),
+		TEST_CASE_ST(dummy_register, dummy_unregister,
+			service_attr),
+		TEST_CASE_ST(dummy_register, dummy_unregister,
+			service_lcore_add_del),
+		TEST_CASE_ST(dummy_register, dummy_unregister,
+			service_lcore_start_stop),
+		TEST_CASE_ST(dummy_register, dummy_unregister,
+			service_lcore_multiplex),
+		TEST_CASE_ST(dummy_register, dummy_unregister,
+			service_mt_unsafe_serialized),
+		TEST_CASE_ST(dummy_register, dummy_unregister,
+			service_start_with_defaults),
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_service_common(void)
+{
+	return unit_test_suite_runner(&service_tests);
+}
+
+REGISTER_TEST_COMMAND(service_autotest, test_service_common);
@@ -0,0 +1,278 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_mempool.h>
+#include <rte_ring.h>
+#include <rte_metrics.h>
+#include <rte_ethdev.h>
+#ifdef RTE_LIBRTE_PMD_RING
+#include <rte_eth_ring.h>
+#endif
+#include <rte_telemetry.h>
+
+#include "test.h"
+
+/*
+ * Telemetry test
+ * ==============
+ *
+ * - Start the telemetry server on a temporary socket and connect to it
+ *   as a client would, checking the greeting message.
+ *
+ * - Query the built-in commands for a ring, a mempool, a global metric
+ *   and, if the ring PMD is available, an ethdev port, and check the
+ *   values in the JSON replies.
+ *
+ * - Check that invalid commands and parameters get a null result, and
+ *   that commands can be registered by the application.
+ */
+
+#define TEL_RING_NAME "tel_test_ring"
+#define TEL_PORT_RING_NAME "tel_test_port"
+#define TEL_MP_NAME "tel_test_mp"
+#define TEL_MP_SIZE 127
+#define TEL_METRIC_NAME "tel_test_metric"
+
+static char socket_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static char reply[RTE_TELEMETRY_REPLY_LEN];
+
+static int
+telemetry_connect(void)
+{
+	struct sockaddr_un addr;
+	int fd;
+
+	fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	if (fd < 0)
+		return -1;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socket_path);
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		close(fd);
+		return -1;
+	}
+
+	return fd;
+}
+
+/* send a command and wait for the reply, stored in the reply buffer */
+static int
+telemetry_query(int fd, const char *cmd)
+{
+	ssize_t n;
+
+	if (send(fd, cmd, strlen(cmd), 0) < 0)
+		return -1;
+	n = recv(fd, reply, sizeof(reply) - 1, 0);
+	if (n <= 0)
+		return -1;
+	reply[n] = '\0';
+
+	return 0;
+}
+
+#define TEST_QUERY(fd, cmd, expected) do {				\
+	TEST_ASSERT_SUCCESS(telemetry_query(fd, cmd),			\
+			    "No reply to %s", cmd);			\
+	TEST_ASSERT(strstr(reply, expected) != NULL,			\
+		    "Unexpected reply to %s: %s", cmd, reply);		\
+} while (0)
+
+static int
+test_cmd_cb(const char *cmd __rte_unused, const char *params,
+		char *buf, size_t len)
+{
+	return snprintf(buf, len, "{\"params\": \"%s\"}",
+			params != NULL ? params : "");
+}
+
+#ifdef RTE_LIBRTE_PMD_RING
+static int
+test_telemetry_ethdev(int fd)
+{
+	char cmd[RTE_TELEMETRY_MSG_LEN];
+	struct rte_ring *r;
+	uint8_t port_id;
+	int port = -1;
+
+	/* the port is never removed, nor its ring */
+	r = rte_ring_lookup(TEL_PORT_RING_NAME);
+	if (r != NULL) {
+		if (rte_eth_dev_get_port_by_name(TEL_PORT_RING_NAME,
+				&port_id) == 0)
+			port = port_id;
+	} else {
+		r = rte_ring_create(TEL_PORT_RING_NAME, 64, SOCKET_ID_ANY,
+				    RING_F_SP_ENQ | RING_F_SC_DEQ);
+		port = r != NULL ? rte_eth_from_ring(r) : -1;
+	}
+	TEST_ASSERT(port >= 0, "Cannot create ring port");
+
+	snprintf(cmd, sizeof(cmd), "/ethdev/stats,%d", port);
+	TEST_QUERY(fd, "/ethdev/list", "[");
+	TEST_QUERY(fd, cmd, "\"ipackets\": 0");
+	snprintf(cmd, sizeof(cmd), "/ethdev/xstats,%d", port);
+	TEST_QUERY(fd, cmd, "\"rx_good_packets\": 0");
+	snprintf(cmd, sizeof(cmd), "/ethdev/xstats,%d,1", port);
+	TEST_QUERY(fd, cmd, "{\"tx_good_packets\": 0}");
+
+	return 0;
+}
+#endif
+
+static int
+test_telemetry_queries(int fd, struct rte_ring *r)
+{
+	char expected[64];
+	void *objs[3] = { NULL, NULL, NULL };
+
+	TEST_QUERY(fd, "/", "\"/ethdev/xstats\"");
+	TEST_QUERY(fd, "/help,/ring/info", "Parameter: ring name");
+	TEST_QUERY(fd, "/info", "\"pid\": ");
+
+	TEST_ASSERT(rte_ring_enqueue_bulk(r, objs, RTE_DIM(objs), NULL) != 0,
+		    "Cannot enqueue in ring");
+	TEST_QUERY(fd, "/ring/list", "\"" TEL_RING_NAME "\"");
+	TEST_QUERY(fd, "/ring/info," TEL_RING_NAME, "\"count\": 3");
+
+	TEST_QUERY(fd, "/mempool/list", "\"" TEL_MP_NAME "\"");
+	snprintf(expected, sizeof(expected), "\"size\": %u", TEL_MP_SIZE);
+	TEST_QUERY(fd, "/mempool/info," TEL_MP_NAME, expected);
+	snprintf(expected, sizeof(expected), "\"avail_count\": %u",
+		 TEL_MP_SIZE);
+	TEST_QUERY(fd, "/mempool/info," TEL_MP_NAME, expected);
+
+	TEST_QUERY(fd, "/metrics", "\"" TEL_METRIC_NAME "\": 42");
+	TEST_QUERY(fd, "/metrics,global\n", "\"" TEL_METRIC_NAME "\": 42");
+
+#ifdef RTE_LIBRTE_PMD_RING
+	if (test_telemetry_ethdev(fd) < 0)
+		return -1;
+#endif
+
+	/* invalid requests */
+	TEST_QUERY(fd, "/unknown", "{\"/unknown\": null}");
+	TEST_QUERY(fd, "/ring/info,no_such_ring", "null");
+	TEST_QUERY(fd, "/ethdev/stats,255", "null");
+	TEST_QUERY(fd, "/ethdev/stats,abc", "null");
+
+	/* application command */
+	TEST_ASSERT(rte_telemetry_register_cmd("/test", test_cmd_cb, "test")
+		    == 0 || rte_telemetry_register_cmd("/test", test_cmd_cb,
+		    "test") == -EEXIST, "Cannot register command");
+	TEST_ASSERT(rte_telemetry_register_cmd("/test", test_cmd_cb, NULL)
+		    == -EEXIST, "Registered a command twice");
+	TEST_ASSERT(rte_telemetry_register_cmd("bad", test_cmd_cb, NULL)
+		    == -EINVAL, "Registered an invalid command");
+	TEST_QUERY(fd, "/test,a,b", "{\"/test\": {\"params\": \"a,b\"}}");
+
+	return 0;
+}
+
+static int
+test_telemetry(void)
+{
+	char greeting[RTE_TELEMETRY_MSG_LEN];
+	struct rte_mempool *mp = NULL;
+	struct rte_ring *r = NULL;
+	int fd, key, ret = -1;
+	ssize_t n;
+
+	snprintf(socket_path, sizeof(socket_path),
+		 "/tmp/dpdk_telemetry_test.%d", (int)getpid());
+
+	TEST_ASSERT_SUCCESS(rte_telemetry_init(socket_path),
+			    "Cannot start telemetry");
+	TEST_ASSERT(rte_telemetry_init(socket_path) == -EBUSY,
+		    "Telemetry started twice");
+
+	fd = telemetry_connect();
+	if (fd < 0) {
+		printf("Cannot connect to %s\n", socket_path);
+		rte_telemetry_cleanup();
+		return -1;
+	}
+
+	r = rte_ring_create(TEL_RING_NAME, 64, SOCKET_ID_ANY, 0);
+	mp = rte_mempool_create(TEL_MP_NAME, TEL_MP_SIZE, 64, 0, 0,
+				NULL, NULL, NULL, NULL, SOCKET_ID_ANY, 0);
+	if (r == NULL || mp == NULL) {
+		printf("Cannot create ring or mempool\n");
+		goto out;
+	}
+
+	rte_metrics_init(rte_socket_id());
+	key = rte_metrics_reg_name(TEL_METRIC_NAME);
+	if (key < 0 || rte_metrics_update_value(RTE_METRICS_GLOBAL, key,
+			42) < 0) {
+		printf("Cannot register metric\n");
+		goto out;
+	}
+
+	n = recv(fd, greeting, sizeof(greeting) - 1, 0);
+	if (n <= 0) {
+		printf("No greeting message\n");
+		goto out;
+	}
+	greeting[n] = '\0';
+	printf("Connected: %s\n", greeting);
+	if (strstr(greeting, "\"version\"") == NULL) {
+		printf("Unexpected greeting message\n");
+		goto out;
+	}
+
+	ret = test_telemetry_queries(fd, r);
+
+out:
+	rte_ring_free(r);
+	rte_mempool_free(mp);
+	close(fd);
+	TEST_ASSERT_SUCCESS(rte_telemetry_cleanup(), "Cannot stop telemetry");
+	TEST_ASSERT(access(socket_path, F_OK) != 0,
+		    "Socket not removed on cleanup");
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(telemetry_autotest, test_telemetry);
@@ -0,0 +1,277 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_mbuf.h>
+#include <rte_ring.h>
+#include <rte_ethdev.h>
+#include <rte_eth_ring.h>
+#include <rte_telemetry.h>
+
+#include "test.h"
+
+/*
+ * Telemetry latency test
+ * ======================
+ *
+ * The master lcore forwards packets on a ring port, receiving bursts and
+ * sending them back to the same port, and measures the throughput and the
+ * cycles spent in each iteration. It is run once alone, then while a
+ * client polls the port statistics, extended statistics, mempool and ring
+ * state through the telemetry socket at 10 Hz. The polling must not
+ * perturb the forwarding, since telemetry only reads the state from its
+ * control thread.
+ */
+
+#define PERF_RING_NAME "tel_perf_port"
+#define PERF_POOL_NAME "tel_perf_pool"
+#define PERF_RING_SIZE 1024
+#define PERF_NB_MBUFS 512
+#define PERF_BURST 32
+#define PERF_DURATION_MS 1000
+#define POLL_PERIOD_US 100000
+
+struct fwd_result {
+	uint64_t packets;
+	uint64_t iterations;
+	uint64_t cycles;
+	uint64_t max_cycles;
+};
+
+static char socket_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static uint8_t perf_port;
+static rte_atomic32_t client_stop;
+static unsigned int client_replies;
+static unsigned int client_errors;
+
+static void
+forward(struct fwd_result *res)
+{
+	const uint64_t duration = rte_get_timer_hz() * PERF_DURATION_MS / 1000;
+	struct rte_mbuf *pkts[PERF_BURST];
+	uint64_t begin, start, end;
+	uint16_t nb_rx, nb_tx;
+
+	memset(res, 0, sizeof(*res));
+	begin = rte_rdtsc();
+	end = begin;
+	while (end - begin < duration) {
+		start = end;
+		nb_rx = rte_eth_rx_burst(perf_port, 0, pkts, PERF_BURST);
+		nb_tx = rte_eth_tx_burst(perf_port, 0, pkts, nb_rx);
+		if (unlikely(nb_tx < nb_rx))
+			rte_pktmbuf_free_bulk(pkts + nb_tx, nb_rx - nb_tx);
+		res->packets += nb_tx;
+		res->iterations++;
+		end = rte_rdtsc();
+		res->max_cycles = RTE_MAX(res->max_cycles, end - start);
+	}
+	res->cycles = end - begin;
+}
+
+static void *
+client_main(void *arg __rte_unused)
+{
+	char buf[RTE_TELEMETRY_REPLY_LEN];
+	char cmds[4][RTE_TELEMETRY_MSG_LEN];
+	struct sockaddr_un addr;
+	unsigned int i;
+	ssize_t n;
+	int fd;
+
+	snprintf(cmds[0], sizeof(cmds[0]), "/ethdev/stats,%u", perf_port);
+	snprintf(cmds[1], sizeof(cmds[1]), "/ethdev/xstats,%u", perf_port);
+	snprintf(cmds[2], sizeof(cmds[2]), "/mempool/info,%s", PERF_POOL_NAME);
+	snprintf(cmds[3], sizeof(cmds[3]), "/ring/info,%s", PERF_RING_NAME);
+
+	fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", socket_path);
+	if (fd < 0 || connect(fd, (struct sockaddr *)&addr,
+			sizeof(addr)) < 0 ||
+			recv(fd, buf, sizeof(buf), 0) <= 0) {
+		client_errors++;
+		goto out;
+	}
+
+	while (rte_atomic32_read(&client_stop) == 0) {
+		for (i = 0; i < RTE_DIM(cmds); i++) {
+			if (send(fd, cmds[i], strlen(cmds[i]), 0) < 0) {
+				client_errors++;
+				goto out;
+			}
+			n = recv(fd, buf, sizeof(buf) - 1, 0);
+			if (n <= 0) {
+				client_errors++;
+				goto out;
+			}
+			buf[n] = '\0';
+			if (strstr(buf, "null") != NULL)
+				client_errors++;
+			client_replies++;
+		}
+		usleep(POLL_PERIOD_US);
+	}
+
+out:
+	if (fd >= 0)
+		close(fd);
+	return NULL;
+}
+
+static void
+print_result(const char *name, const struct fwd_result *res)
+{
+	double hz = rte_get_timer_hz();
+
+	printf("%-22s %8.2f Mpps, %6.1f cycles/iteration, "
+	       "max %"PRIu64" cycles (%.1f us)\n", name,
+	       res->packets / (res->cycles / hz) / 1e6,
+	       (double)res->cycles / res->iterations,
+	       res->max_cycles, res->max_cycles * 1e6 / hz);
+}
+
+static int
+setup_port(struct rte_mempool **mp)
+{
+	struct rte_mbuf *pkts[PERF_NB_MBUFS];
+	struct rte_ring *r;
+	unsigned int n;
+
+	r = rte_ring_lookup(PERF_RING_NAME);
+	if (r == NULL) {
+		r = rte_ring_create(PERF_RING_NAME, PERF_RING_SIZE,
+				    rte_socket_id(),
+				    RING_F_SP_ENQ | RING_F_SC_DEQ);
+		if (r == NULL || rte_eth_from_ring(r) < 0)
+			return -1;
+	}
+	if (rte_eth_dev_get_port_by_name(PERF_RING_NAME, &perf_port) != 0)
+		return -1;
+
+	*mp = rte_mempool_lookup(PERF_POOL_NAME);
+	if (*mp == NULL)
+		*mp = rte_pktmbuf_pool_create(PERF_POOL_NAME,
+				PERF_NB_MBUFS * 2 - 1, PERF_BURST, 0,
+				RTE_MBUF_DEFAULT_BUF_SIZE, rte_socket_id());
+	if (*mp == NULL)
+		return -1;
+
+	if (rte_pktmbuf_alloc_bulk(*mp, pkts, PERF_NB_MBUFS) != 0)
+		return -1;
+	n = rte_eth_tx_burst(perf_port, 0, pkts, PERF_NB_MBUFS);
+	if (n < PERF_NB_MBUFS)
+		rte_pktmbuf_free_bulk(pkts + n, PERF_NB_MBUFS - n);
+
+	return 0;
+}
+
+static void
+drain_port(void)
+{
+	struct rte_mbuf *pkts[PERF_BURST];
+	uint16_t n;
+
+	while ((n = rte_eth_rx_burst(perf_port, 0, pkts, PERF_BURST)) != 0)
+		rte_pktmbuf_free_bulk(pkts, n);
+}
+
+static int
+test_telemetry_perf(void)
+{
+	struct fwd_result alone, polled;
+	struct rte_mempool *mp;
+	pthread_t client;
+	int ret;
+
+	if (setup_port(&mp) < 0) {
+		printf("Cannot setup ring port\n");
+		return -1;
+	}
+
+	forward(&alone);
+
+	snprintf(socket_path, sizeof(socket_path),
+		 "/tmp/dpdk_telemetry_perf.%d", (int)getpid());
+	if (rte_telemetry_init(socket_path) < 0) {
+		printf("Cannot start telemetry\n");
+		drain_port();
+		return -1;
+	}
+
+	client_replies = 0;
+	client_errors = 0;
+	rte_atomic32_clear(&client_stop);
+	ret = pthread_create(&client, NULL, client_main, NULL);
+	if (ret != 0) {
+		printf("Cannot create client thread\n");
+		rte_telemetry_cleanup();
+		drain_port();
+		return -1;
+	}
+
+	forward(&polled);
+
+	rte_atomic32_set(&client_stop, 1);
+	pthread_join(client, NULL);
+	rte_telemetry_cleanup();
+	drain_port();
+
+	printf("\n### Forwarding on a ring port, %u ms ###\n",
+	       PERF_DURATION_MS);
+	print_result("No telemetry:", &alone);
+	print_result("Telemetry at 10 Hz:", &polled);
+	printf("Throughput ratio: %.3f, %u telemetry replies\n",
+	       ((double)polled.packets / polled.cycles) /
+	       ((double)alone.packets / alone.cycles), client_replies);
+
+	TEST_ASSERT(client_errors == 0, "Telemetry client got errors");
+	TEST_ASSERT(client_replies != 0, "Telemetry client got no reply");
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(telemetry_perf_autotest, test_telemetry_perf);
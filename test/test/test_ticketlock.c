@@ -0,0 +1,313 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2017 Arm Limited
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Arm Limited nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/queue.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_per_lcore.h>
+#include <rte_launch.h>
+#include <rte_eal.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_ticketlock.h>
+#include <rte_atomic.h>
+
+#include "test.h"
+
+/*
+ * Ticketlock test
+ * ===============
+ *
+ * - There is a global ticketlock and a table of ticketlocks (one per lcore).
+ *
+ * - The test function takes all of these locks and launches the
+ *   ``test_ticketlock_per_core()`` function on each core (except the master).
+ *
+ *   - The function takes the global lock, display something, then releases
+ *     the global lock.
+ *   - The function takes the per-lcore lock, display something, then releases
+ *     the per-core lock.
+ *
+ * - The main function unlocks the per-lcore locks sequentially and
+ *   waits between each lock.
+ *
+ * - The recursive lock is taken several times on each core, and must be
+ *   released by the owner only after the last unlock.
+ *
+ * - A load test is carried out, with all cores incrementing a shared
+ *   counter under a single lock: the counter must not lose any update, and
+ *   the lock must be free at the end.
+ */
+
+static rte_ticketlock_t tl, tl_try;
+static rte_ticketlock_t tl_tab[RTE_MAX_LCORE];
+static rte_ticketlock_recursive_t tlr;
+static unsigned int count;
+
+static rte_atomic32_t synchro;
+
+static int
+test_ticketlock_per_core(__attribute__((unused)) void *arg)
+{
+	rte_ticketlock_lock(&tl);
+	printf("Global lock taken on core %u\n", rte_lcore_id());
+	rte_ticketlock_unlock(&tl);
+
+	rte_ticketlock_lock(&tl_tab[rte_lcore_id()]);
+	printf("Hello from core %u !\n", rte_lcore_id());
+	rte_ticketlock_unlock(&tl_tab[rte_lcore_id()]);
+
+	return 0;
+}
+
+static int
+test_ticketlock_recursive_per_core(__attribute__((unused)) void *arg)
+{
+	unsigned int id = rte_lcore_id();
+
+	rte_ticketlock_recursive_lock(&tlr);
+	printf("Global recursive lock taken on core %u - count = %u\n",
+	       id, tlr.count);
+	rte_ticketlock_recursive_lock(&tlr);
+	printf("Global recursive lock taken on core %u - count = %u\n",
+	       id, tlr.count);
+	rte_ticketlock_recursive_lock(&tlr);
+	printf("Global recursive lock taken on core %u - count = %u\n",
+	       id, tlr.count);
+
+	printf("Hello from within recursive locks from core %u !\n", id);
+
+	rte_ticketlock_recursive_unlock(&tlr);
+	printf("Global recursive lock released on core %u - count = %u\n",
+	       id, tlr.count);
+	rte_ticketlock_recursive_unlock(&tlr);
+	printf("Global recursive lock released on core %u - count = %u\n",
+	       id, tlr.count);
+	rte_ticketlock_recursive_unlock(&tlr);
+	printf("Global recursive lock released on core %u - count = %u\n",
+	       id, tlr.count);
+
+	return 0;
+}
+
+static rte_ticketlock_t lk = RTE_TICKETLOCK_INITIALIZER;
+static uint64_t shared_count;
+
+#define LOAD_ITERATIONS 100000
+
+static int
+load_loop_fn(__attribute__((unused)) void *arg)
+{
+	const unsigned int lcore = rte_lcore_id();
+	unsigned int i;
+
+	/* wait synchro for slaves */
+	if (lcore != rte_get_master_lcore())
+		while (rte_atomic32_read(&synchro) == 0)
+			;
+
+	for (i = 0; i < LOAD_ITERATIONS; i++) {
+		rte_ticketlock_lock(&lk);
+		shared_count++;
+		rte_ticketlock_unlock(&lk);
+	}
+
+	return 0;
+}
+
+static int
+test_ticketlock_load(void)
+{
+	rte_ticketlock_init(&lk);
+	shared_count = 0;
+
+	printf("\nTest with lock on %u cores...\n", rte_lcore_count());
+
+	/* Clear synchro and start slaves */
+	rte_atomic32_set(&synchro, 0);
+	rte_eal_mp_remote_launch(load_loop_fn, NULL, SKIP_MASTER);
+
+	/* start synchro and launch test on master */
+	rte_atomic32_set(&synchro, 1);
+	load_loop_fn(NULL);
+
+	rte_eal_mp_wait_lcore();
+
+	printf("Total count = %"PRIu64"\n", shared_count);
+
+	if (shared_count != (uint64_t)LOAD_ITERATIONS * rte_lcore_count()) {
+		printf("Lost updates under ticketlock: %"PRIu64" != %u\n",
+		       shared_count, LOAD_ITERATIONS * rte_lcore_count());
+		return -1;
+	}
+	if (rte_ticketlock_is_locked(&lk)) {
+		printf("ticketlock is locked but it should not be\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Use rte_ticketlock_trylock() to trylock a ticketlock object,
+ * If it could not lock the object successfully, it would
+ * return immediately and the variable of "count" would be
+ * increased by one per times. the value of "count" could be
+ * checked as the result later.
+ */
+static int
+test_ticketlock_try(__attribute__((unused)) void *arg)
+{
+	if (rte_ticketlock_trylock(&tl_try) == 0) {
+		rte_ticketlock_lock(&tl);
+		count++;
+		rte_ticketlock_unlock(&tl);
+	}
+
+	return 0;
+}
+
+static int
+test_ticketlock(void)
+{
+	int ret = 0;
+	int i;
+
+	rte_ticketlock_init(&tl);
+	rte_ticketlock_init(&tl_try);
+	rte_ticketlock_recursive_init(&tlr);
+	for (i = 0; i < RTE_MAX_LCORE; i++)
+		rte_ticketlock_init(&tl_tab[i]);
+
+	rte_ticketlock_lock(&tl);
+
+	RTE_LCORE_FOREACH_SLAVE(i) {
+		rte_ticketlock_lock(&tl_tab[i]);
+		rte_eal_remote_launch(test_ticketlock_per_core, NULL, i);
+	}
+
+	rte_ticketlock_unlock(&tl);
+
+	RTE_LCORE_FOREACH_SLAVE(i) {
+		rte_ticketlock_unlock(&tl_tab[i]);
+		rte_delay_ms(10);
+	}
+
+	rte_eal_mp_wait_lcore();
+
+	rte_ticketlock_recursive_lock(&tlr);
+
+	/*
+	 * Try to acquire a lock that we already own
+	 */
+	if (!rte_ticketlock_recursive_trylock(&tlr)) {
+		printf("rte_ticketlock_recursive_trylock failed on a lock that "
+		       "we already own\n");
+		ret = -1;
+	} else
+		rte_ticketlock_recursive_unlock(&tlr);
+
+	RTE_LCORE_FOREACH_SLAVE(i) {
+		rte_eal_remote_launch(test_ticketlock_recursive_per_core,
+				      NULL, i);
+	}
+	rte_ticketlock_recursive_unlock(&tlr);
+	rte_eal_mp_wait_lcore();
+
+	if (rte_ticketlock_is_locked(&tlr.tl)) {
+		printf("recursive ticketlock is locked but it should not be\n");
+		return -1;
+	}
+
+	/*
+	 * Test if it could return immediately from try-locking a locked object.
+	 * Here it will lock the ticketlock object first, then launch all the
+	 * slave lcores to trylock the same ticketlock object.
+	 * All the slave lcores should give up try-locking a locked object and
+	 * return immediately, and then increase the "count" initialized with
+	 * zero by one per times.
+	 * We can check if the "count" is finally equal to the number of all
+	 * slave lcores to see if the behavior of try-locking a locked
+	 * ticketlock object is correct.
+	 */
+	if (rte_ticketlock_trylock(&tl_try) == 0)
+		return -1;
+
+	count = 0;
+	RTE_LCORE_FOREACH_SLAVE(i) {
+		rte_eal_remote_launch(test_ticketlock_try, NULL, i);
+	}
+	rte_eal_mp_wait_lcore();
+	rte_ticketlock_unlock(&tl_try);
+	if (rte_ticketlock_is_locked(&tl)) {
+		printf("ticketlock is locked but it should not be\n");
+		return -1;
+	}
+	rte_ticketlock_lock(&tl);
+	if (count != (rte_lcore_count() - 1))
+		ret = -1;
+
+	rte_ticketlock_unlock(&tl);
+
+	/*
+	 * Test if it can trylock recursively.
+	 * Use rte_ticketlock_recursive_trylock() to check if it can lock
+	 * a ticketlock object recursively. Here it will try to lock a
+	 * ticketlock object twice.
+	 */
+	if (rte_ticketlock_recursive_trylock(&tlr) == 0) {
+		printf("It failed to do the first ticketlock_recursive_trylock "
+		       "but it should able to do\n");
+		return -1;
+	}
+	if (rte_ticketlock_recursive_trylock(&tlr) == 0) {
+		printf("It failed to do the second ticketlock_recursive_trylock "
+		       "but it should able to do\n");
+		return -1;
+	}
+	rte_ticketlock_recursive_unlock(&tlr);
+	rte_ticketlock_recursive_unlock(&tlr);
+
+	if (test_ticketlock_load() < 0)
+		return -1;
+
+	return ret;
+}
+
+REGISTER_TEST_COMMAND(ticketlock_autotest, test_ticketlock);
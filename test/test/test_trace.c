@@ -0,0 +1,325 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#include <rte_common.h>
+#include <rte_lcore.h>
+#include <rte_ring.h>
+#include <rte_trace.h>
+
+#include "test.h"
+
+/*
+ * Trace
+ * =====
+ *
+ * - Register a trace point and look up the trace points of the libraries.
+ * - Enable trace points with a pattern and a regexp, emit records, save
+ *   them and check the content of the saved streams.
+ * - Check that the per-lcore buffer overwrites the oldest records.
+ * - Check that a disabled trace point writes nothing.
+ */
+
+#define TEST_NB_RECORDS 10
+
+RTE_TRACE_POINT_DEFINE(test_trace_tp, "test.trace.tp", "seq", "magic");
+
+#define TEST_TRACE_MAGIC 0xdeadbeefcafeULL
+
+static char trace_dir[PATH_MAX];
+
+/* read the stream of the calling lcore, return the number of records */
+static int
+trace_read_stream(struct rte_trace_record *recs, unsigned int max)
+{
+	char path[PATH_MAX];
+	size_t n;
+	FILE *f;
+
+	snprintf(path, sizeof(path), "%s/channel0_%u", trace_dir,
+		rte_lcore_id());
+	f = fopen(path, "r");
+	if (f == NULL)
+		return -1;
+	n = fread(recs, sizeof(*recs), max, f);
+	fclose(f);
+
+	return n;
+}
+
+static void
+trace_dir_remove(void)
+{
+	char path[PATH_MAX];
+	unsigned int lcore_id;
+
+	if (trace_dir[0] == '\0')
+		return;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		snprintf(path, sizeof(path), "%s/channel0_%u", trace_dir,
+			lcore_id);
+		unlink(path);
+	}
+	snprintf(path, sizeof(path), "%s/metadata", trace_dir);
+	unlink(path);
+	rmdir(trace_dir);
+	trace_dir[0] = '\0';
+}
+
+static int
+test_trace_lookup(void)
+{
+	static const char * const names[] = {
+		"test.trace.tp",
+		"lib.ethdev.rx_burst",
+		"lib.ethdev.tx_burst",
+		"lib.mempool.get",
+		"lib.mempool.put",
+		"lib.ring.enqueue",
+		"lib.ring.dequeue",
+		"lib.cryptodev.enqueue_burst",
+		"lib.cryptodev.dequeue_burst",
+	};
+	unsigned int i;
+
+	for (i = 0; i < RTE_DIM(names); i++)
+		TEST_ASSERT_NOT_NULL(rte_trace_point_lookup(names[i]),
+			"Trace point %s is not registered", names[i]);
+
+	TEST_ASSERT_NULL(rte_trace_point_lookup("test.trace.unknown"),
+		"Unknown trace point found");
+	TEST_ASSERT_EQUAL(test_trace_tp.nb_args, 2,
+		"Wrong number of arguments");
+	TEST_ASSERT_EQUAL(rte_trace_point_register(&test_trace_tp), -EEXIST,
+		"Trace point registered twice");
+	TEST_ASSERT(rte_trace_regexp("lib.[", 1) < 0,
+		"Invalid regexp accepted");
+
+	return 0;
+}
+
+static int
+test_trace_save(void)
+{
+	struct rte_trace_record recs[TEST_NB_RECORDS * 2];
+	char path[PATH_MAX];
+	struct stat st;
+	unsigned int i;
+	int ret;
+
+	rte_trace_reset();
+	ret = rte_trace_pattern("test.trace.*", 1);
+	TEST_ASSERT_EQUAL(ret, 1, "Pattern matched %d trace points", ret);
+	TEST_ASSERT(rte_trace_point_is_enabled(&test_trace_tp),
+		"Trace point not enabled");
+	TEST_ASSERT(rte_trace_is_enabled(), "Trace not enabled");
+
+	for (i = 0; i < TEST_NB_RECORDS; i++)
+		RTE_TRACE_POINT_EMIT(test_trace_tp, i, TEST_TRACE_MAGIC);
+
+	ret = rte_trace_save(trace_dir);
+	TEST_ASSERT_EQUAL(ret, TEST_NB_RECORDS, "Saved %d records", ret);
+
+	snprintf(path, sizeof(path), "%s/metadata", trace_dir);
+	TEST_ASSERT_SUCCESS(stat(path, &st), "No metadata file");
+
+	ret = trace_read_stream(recs, RTE_DIM(recs));
+	TEST_ASSERT_EQUAL(ret, TEST_NB_RECORDS, "Read %d records", ret);
+	for (i = 0; i < TEST_NB_RECORDS; i++) {
+		TEST_ASSERT_EQUAL(recs[i].id, test_trace_tp.id,
+			"Wrong trace point id in record %u", i);
+		TEST_ASSERT_EQUAL(recs[i].lcore_id, rte_lcore_id(),
+			"Wrong lcore id in record %u", i);
+		TEST_ASSERT_EQUAL(recs[i].nb_args, 2,
+			"Wrong number of arguments in record %u", i);
+		TEST_ASSERT(recs[i].args[0] == i &&
+			recs[i].args[1] == TEST_TRACE_MAGIC,
+			"Wrong arguments in record %u", i);
+		TEST_ASSERT(i == 0 || recs[i].tsc >= recs[i - 1].tsc,
+			"Timestamps are not ordered");
+	}
+
+	rte_trace_point_disable(&test_trace_tp);
+	return 0;
+}
+
+static int
+test_trace_overwrite(void)
+{
+	struct rte_trace_record rec;
+	uint64_t nb_emit = RTE_TRACE_BUFFER_SIZE + TEST_NB_RECORDS;
+	uint64_t i;
+	int ret;
+
+	rte_trace_reset();
+	TEST_ASSERT_SUCCESS(rte_trace_point_enable(&test_trace_tp),
+		"Cannot enable trace point");
+
+	for (i = 0; i < nb_emit; i++)
+		RTE_TRACE_POINT_EMIT(test_trace_tp, i, TEST_TRACE_MAGIC);
+
+	ret = rte_trace_save(trace_dir);
+	TEST_ASSERT_EQUAL(ret, RTE_TRACE_BUFFER_SIZE, "Saved %d records",
+		ret);
+
+	/* the oldest records were overwritten */
+	ret = trace_read_stream(&rec, 1);
+	TEST_ASSERT_EQUAL(ret, 1, "Cannot read stream");
+	TEST_ASSERT_EQUAL(rec.args[0], TEST_NB_RECORDS,
+		"Wrong oldest record %"PRIu64, rec.args[0]);
+
+	rte_trace_point_disable(&test_trace_tp);
+	return 0;
+}
+
+static int
+test_trace_disabled(void)
+{
+	unsigned int i;
+	int ret;
+
+	rte_trace_reset();
+	TEST_ASSERT_SUCCESS(rte_trace_point_enable(&test_trace_tp),
+		"Cannot enable trace point");
+	ret = rte_trace_regexp("^test\\.trace\\.", 0);
+	TEST_ASSERT_EQUAL(ret, 1, "Regexp matched %d trace points", ret);
+	TEST_ASSERT(!rte_trace_point_is_enabled(&test_trace_tp),
+		"Trace point still enabled");
+
+	for (i = 0; i < TEST_NB_RECORDS; i++)
+		RTE_TRACE_POINT_EMIT(test_trace_tp, i, TEST_TRACE_MAGIC);
+
+	ret = rte_trace_save(trace_dir);
+	TEST_ASSERT_EQUAL(ret, 0, "Saved %d records", ret);
+
+	return 0;
+}
+
+static int
+test_trace_ring(void)
+{
+	struct rte_trace_record recs[4];
+	struct rte_trace_point *enq, *deq;
+	struct rte_ring *r;
+	void *objs[8] = { NULL };
+	int ret;
+
+	enq = rte_trace_point_lookup("lib.ring.enqueue");
+	deq = rte_trace_point_lookup("lib.ring.dequeue");
+	TEST_ASSERT(enq != NULL && deq != NULL, "No ring trace points");
+
+	r = rte_ring_create("test_trace", 16, SOCKET_ID_ANY,
+		RING_F_SP_ENQ | RING_F_SC_DEQ);
+	TEST_ASSERT_NOT_NULL(r, "Cannot create ring");
+
+	rte_trace_reset();
+	ret = rte_trace_regexp("^lib\\.ring\\.", 1);
+	TEST_ASSERT_EQUAL(ret, 2, "Regexp matched %d trace points", ret);
+
+	rte_ring_enqueue_burst(r, objs, RTE_DIM(objs), NULL);
+	rte_ring_dequeue_burst(r, objs, 5, NULL);
+
+	rte_trace_regexp("^lib\\.ring\\.", 0);
+	rte_ring_free(r);
+
+	ret = rte_trace_save(trace_dir);
+	TEST_ASSERT_EQUAL(ret, 2, "Saved %d records", ret);
+	ret = trace_read_stream(recs, RTE_DIM(recs));
+	TEST_ASSERT_EQUAL(ret, 2, "Read %d records", ret);
+	TEST_ASSERT(recs[0].id == enq->id &&
+		recs[0].args[0] == (uintptr_t)r &&
+		recs[0].args[1] == RTE_DIM(objs),
+		"Wrong enqueue record");
+	TEST_ASSERT(recs[1].id == deq->id &&
+		recs[1].args[0] == (uintptr_t)r &&
+		recs[1].args[1] == 5,
+		"Wrong dequeue record");
+
+	return 0;
+}
+
+static int
+testsuite_setup(void)
+{
+	snprintf(trace_dir, sizeof(trace_dir), "/tmp/dpdk_trace_XXXXXX");
+	if (mkdtemp(trace_dir) == NULL) {
+		printf("Cannot create trace directory\n");
+		trace_dir[0] = '\0';
+		return TEST_FAILED;
+	}
+	return 0;
+}
+
+static void
+testsuite_teardown(void)
+{
+	trace_dir_remove();
+	rte_trace_reset();
+}
+
+static struct unit_test_suite trace_tests = {
+	.suite_name = "trace test suite",
+	.setup = testsuite_setup,
+	.teardown = testsuite_teardown,
+	.unit_test_cases = {
+		TEST_CASE(test_trace_lookup),
+		TEST_CASE(test_trace_save),
+		TEST_CASE(test_trace_overwrite),
+		TEST_CASE(test_trace_disabled),
+		TEST_CASE(test_trace_ring),
+		TEST_CASES_END() /**< NULL terminate unit test array */
+	}
+};
+
+static int
+test_trace(void)
+{
+#ifndef RTE_ENABLE_TRACE
+	printf("Trace points are compiled out, see CONFIG_RTE_ENABLE_TRACE\n");
+	RTE_SET_USED(trace_tests);
+	return 0;
+#else
+	return unit_test_suite_runner(&trace_tests);
+#endif
+}
+
+REGISTER_TEST_COMMAND(trace_autotest, test_trace);
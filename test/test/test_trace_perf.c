@@ -0,0 +1,163 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright 2017 6WIND S.A.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of 6WIND S.A. nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <inttypes.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+#include <rte_ring.h>
+#include <rte_trace.h>
+
+#include "test.h"
+
+/*
+ * Trace performance
+ * =================
+ *
+ * Measures the cost of a trace point, using rdtsc:
+ *  * function without trace point (reference)
+ *  * same function with a disabled trace point
+ *  * same function with an enabled trace point
+ *  * single object ring enqueue/dequeue, ring trace points disabled
+ *    and enabled
+ */
+
+#define ITERATIONS (1 << 20)
+
+RTE_TRACE_POINT_DEFINE(test_trace_perf_tp, "test.trace_perf.tp",
+	"count", "value");
+
+static volatile uint64_t counter;
+
+static __attribute__((noinline)) void
+func_no_trace(uint64_t value)
+{
+	counter += value;
+}
+
+static __attribute__((noinline)) void
+func_trace(uint64_t value)
+{
+	counter += value;
+	RTE_TRACE_POINT_EMIT(test_trace_perf_tp, counter, value);
+}
+
+static double
+measure(void (*f)(uint64_t))
+{
+	uint64_t start, end;
+	unsigned int i;
+
+	start = rte_rdtsc_precise();
+	for (i = 0; i < ITERATIONS; i++)
+		f(i);
+	end = rte_rdtsc_precise();
+
+	return (double)(end - start) / ITERATIONS;
+}
+
+static double
+measure_ring(struct rte_ring *r)
+{
+	uint64_t start, end;
+	unsigned int i;
+	void *obj = NULL;
+
+	start = rte_rdtsc_precise();
+	for (i = 0; i < ITERATIONS; i++) {
+		rte_ring_sp_enqueue(r, obj);
+		rte_ring_sc_dequeue(r, &obj);
+	}
+	end = rte_rdtsc_precise();
+
+	return (double)(end - start) / ITERATIONS;
+}
+
+static int
+test_trace_perf(void)
+{
+	double ref, disabled, enabled;
+	struct rte_ring *r;
+
+#ifndef RTE_ENABLE_TRACE
+	printf("Trace points are compiled out, see CONFIG_RTE_ENABLE_TRACE\n");
+#endif
+
+	/* warm up */
+	measure(func_no_trace);
+
+	rte_trace_point_disable(&test_trace_perf_tp);
+	ref = measure(func_no_trace);
+	disabled = measure(func_trace);
+	if (rte_trace_point_enable(&test_trace_perf_tp) < 0) {
+		printf("Cannot enable trace point\n");
+		return -1;
+	}
+	enabled = measure(func_trace);
+	rte_trace_point_disable(&test_trace_perf_tp);
+
+	printf("\n### Trace point cost (cycles per call) ###\n");
+	printf("No trace point: %.2F\n", ref);
+	printf("Disabled trace point: %.2F (%+.2F)\n", disabled,
+		disabled - ref);
+	printf("Enabled trace point: %.2F (%+.2F)\n", enabled, enabled - ref);
+
+	r = rte_ring_create("test_trace_perf", 64, SOCKET_ID_ANY,
+		RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (r == NULL) {
+		printf("Cannot create ring\n");
+		return -1;
+	}
+
+	rte_trace_pattern("lib.ring.*", 0);
+	disabled = measure_ring(r);
+	if (rte_trace_pattern("lib.ring.*", 1) < 0) {
+		printf("Cannot enable ring trace points\n");
+		rte_ring_free(r);
+		return -1;
+	}
+	enabled = measure_ring(r);
+	rte_trace_pattern("lib.ring.*", 0);
+	rte_ring_free(r);
+	rte_trace_reset();
+
+	printf("\n### Ring SP/SC single enqueue + dequeue (cycles) ###\n");
+	printf("Trace points disabled: %.2F\n", disabled);
+	printf("Trace points enabled: %.2F (%+.2F)\n", enabled,
+		enabled - disabled);
+
+	return 0;
+}
+
+REGISTER_TEST_COMMAND(trace_perf_autotest, test_trace_perf);
@@ -0,0 +1,146 @@
+#!/usr/bin/env python
+
+#
+#   BSD LICENSE
+#
+#   Copyright 2017 6WIND S.A.
+#   All rights reserved.
+#
+#   Redistribution and use in source and binary forms, with or without
+#   modification, are permitted provided that the following conditions
+#   are met:
+#
+#     * Redistributions of source code must retain the above copyright
+#       notice, this list of conditions and the following disclaimer.
+#     * Redistributions in binary form must reproduce the above copyright
+#       notice, this list of conditions and the following disclaimer in
+#       the documentation and/or other materials provided with the
+#       distribution.
+#     * Neither the name of 6WIND S.A. nor the names of its
+#       contributors may be used to endorse or promote products derived
+#       from this software without specific prior written permission.
+#
+#   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+#   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+#   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+#   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+#   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+#   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+#   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+#   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+#   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+#   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+#   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+
+"""
+Client of the DPDK telemetry socket.
+
+Without command, an interactive prompt reads the commands to send, e.g.
+"/ethdev/stats,0". The commands given on the command line are sent once,
+or periodically with --interval.
+"""
+
+from __future__ import print_function
+import json
+import readline  # noqa: F401, enables line editing in the prompt
+import socket
+import sys
+import time
+from optparse import OptionParser
+
+DEFAULT_PATH = "/var/run/dpdk_telemetry"
+# large enough for any reply, see RTE_TELEMETRY_REPLY_LEN
+BUFFER_SIZE = 65536
+
+
+class TelemetryClient:
+    """
+    Connection to the telemetry socket of a DPDK process.
+    """
+
+    def __init__(self, path):
+        self.sock = socket.socket(socket.AF_UNIX, socket.SOCK_SEQPACKET)
+        self.sock.connect(path)
+        self.info = json.loads(self.sock.recv(BUFFER_SIZE).decode())
+
+    def query(self, cmd):
+        """
+        Send a command and return the decoded result.
+        """
+        self.sock.send(cmd.encode())
+        reply = json.loads(self.sock.recv(BUFFER_SIZE).decode())
+        return reply.get(cmd.split(",")[0])
+
+    def close(self):
+        self.sock.close()
+
+
+def print_result(result, pretty):
+    if pretty:
+        print(json.dumps(result, indent=4, sort_keys=True))
+    else:
+        print(json.dumps(result, sort_keys=True))
+
+
+def interactive(client, pretty):
+    print("Connected to %s, pid %d" %
+          (client.info["version"], client.info["pid"]))
+    print('Type "/" for the list of commands, "/help,<command>" for help.')
+    read_line = raw_input if sys.version_info[0] < 3 else input
+    while True:
+        try:
+            cmd = read_line("--> ").strip()
+        except (EOFError, KeyboardInterrupt):
+            print()
+            return
+        if not cmd:
+            continue
+        if cmd in ("quit", "exit"):
+            return
+        print_result(client.query(cmd), pretty)
+
+
+def main():
+    parser = OptionParser(usage="usage: %prog [options] [command ...]")
+    parser.add_option("-s", "--socket", dest="path", default=DEFAULT_PATH,
+                      help="path of the telemetry socket [%default]")
+    parser.add_option("-i", "--interval", dest="interval", type="float",
+                      default=0,
+                      help="repeat the commands every INTERVAL seconds")
+    parser.add_option("-c", "--compact", dest="pretty", default=True,
+                      action="store_false",
+                      help="print each result on a single line")
+    (options, cmds) = parser.parse_args()
+
+    try:
+        client = TelemetryClient(options.path)
+    except socket.error as err:
+        print("Cannot connect to %s: %s" % (options.path, err),
+              file=sys.stderr)
+        sys.exit(1)
+
+    try:
+        if not cmds:
+            interactive(client, options.pretty)
+            return
+        while True:
+            for cmd in cmds:
+                result = client.query(cmd)
+                if options.interval:
+                    print("%.3f %s " % (time.time(), cmd), end="")
+                print_result(result, options.pretty)
+            if not options.interval:
+                break
+            time.sleep(options.interval)
+    except KeyboardInterrupt:
+        pass
+    except socket.error as err:
+        print("Connection lost: %s" % err, file=sys.stderr)
+        sys.exit(1)
+    finally:
+        client.close()
+
+
+if __name__ == "__main__":
+    main()